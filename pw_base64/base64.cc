@@ -17,6 +17,7 @@
 #include <cstdint>
 
 #include "pw_assert/check.h"
+#include "pw_base64_private/simd.h"
 
 namespace pw::base64 {
 namespace {
@@ -91,8 +92,14 @@ extern "C" void pw_Base64Encode(const void* binary_data,
                                 char* output) {
   const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
 
+  // Encode as much as possible with vector instructions, if available.
+  const size_t vector_bytes =
+      internal::EncodeSimd(bytes, binary_size_bytes, output);
+  bytes += vector_bytes;
+  output += vector_bytes / 3 * kEncodedGroupSize;
+
   // Encode groups of 3 source bytes into 4 output characters.
-  size_t remaining = binary_size_bytes;
+  size_t remaining = binary_size_bytes - vector_bytes;
   for (; remaining >= 3u; remaining -= 3u, bytes += 3) {
     *output++ = BitGroup0Char(bytes[0]);
     *output++ = BitGroup1Char(bytes[0], bytes[1]);
@@ -123,8 +130,21 @@ extern "C" size_t pw_Base64Decode(const char* base64,
     return 0;
   }
 
+  // Check the padding before decoding, since decoding in place overwrites it.
+  size_t pad = 0;
+  if (base64[base64_size_bytes - 2] == kPadding) {
+    pad = 2;
+  } else if (base64[base64_size_bytes - 1] == kPadding) {
+    pad = 1;
+  }
+
   uint8_t* binary = static_cast<uint8_t*>(output);
-  for (size_t ch = 0; ch < base64_size_bytes; ch += kEncodedGroupSize) {
+  const size_t vector_chars =
+      internal::DecodeSimd(base64, base64_size_bytes, binary);
+  binary += vector_chars / kEncodedGroupSize * 3;
+
+  for (size_t ch = vector_chars; ch < base64_size_bytes;
+       ch += kEncodedGroupSize) {
     const uint8_t char0 = CharToBits(base64[ch + 0]);
     const uint8_t char1 = CharToBits(base64[ch + 1]);
     const uint8_t char2 = CharToBits(base64[ch + 2]);
@@ -135,13 +155,6 @@ extern "C" size_t pw_Base64Decode(const char* base64,
     *binary++ = Byte2(char2, char3);
   }
 
-  size_t pad = 0;
-  if (base64[base64_size_bytes - 2] == kPadding) {
-    pad = 2;
-  } else if (base64[base64_size_bytes - 1] == kPadding) {
-    pad = 1;
-  }
-
   return static_cast<size_t>(binary - static_cast<uint8_t*>(output)) - pad;
 }
 
@@ -155,7 +168,9 @@ extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
     return false;
   }
 
-  for (size_t i = 0; i < base64_size; ++i) {
+  for (size_t i = internal::ValidPrefixSimd(base64_data, base64_size);
+       i < base64_size;
+       ++i) {
     if (!pw_Base64IsValidChar(base64_data[i])) {
       return false;
     }
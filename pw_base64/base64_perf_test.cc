@@ -0,0 +1,79 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures Base64 throughput for short and long buffers. Builds with
+// PW_BASE64_SIMD=0 give the portable baseline.
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "pw_base64/base64.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw::base64 {
+namespace {
+
+constexpr size_t kMaxSize = 3072;
+
+std::array<std::byte, kMaxSize> binary;
+std::array<char, EncodedSize(kMaxSize)> encoded;
+std::array<std::byte, kMaxSize> decoded;
+
+volatile bool is_valid;
+
+void Fill() {
+  for (size_t i = 0; i < binary.size(); ++i) {
+    binary[i] = static_cast<std::byte>(i * 167 + 13);
+  }
+  Encode(binary, encoded.data());
+}
+
+template <size_t kSize>
+void EncodeBytes(perf_test::State& state) {
+  Fill();
+  while (state.KeepRunning()) {
+    Encode(span(binary).first(kSize), encoded.data());
+  }
+}
+
+template <size_t kSize>
+void DecodeBytes(perf_test::State& state) {
+  Fill();
+  const std::string_view base64(encoded.data(), EncodedSize(kSize));
+  while (state.KeepRunning()) {
+    Decode(base64, decoded.data());
+  }
+}
+
+template <size_t kSize>
+void IsValidBytes(perf_test::State& state) {
+  Fill();
+  const std::string_view base64(encoded.data(), EncodedSize(kSize));
+  while (state.KeepRunning()) {
+    is_valid = IsValid(base64);
+  }
+}
+
+PW_PERF_TEST(Encode48, EncodeBytes<48>);
+PW_PERF_TEST(Encode3072, EncodeBytes<3072>);
+
+PW_PERF_TEST(Decode48, DecodeBytes<48>);
+PW_PERF_TEST(Decode3072, DecodeBytes<3072>);
+
+PW_PERF_TEST(IsValid48, IsValidBytes<48>);
+PW_PERF_TEST(IsValid3072, IsValidBytes<3072>);
+
+}  // namespace
+}  // namespace pw::base64
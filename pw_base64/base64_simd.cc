@@ -0,0 +1,540 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Vectorized Base64 encoding, decoding, and validation. These functions only
+// handle whole blocks of input; base64.cc handles the rest and any padding.
+//
+// Decoding and validation accept the same characters as the portable code:
+// both the standard (+/) and URL-safe (-_) alphabets, as well as '=', which
+// decodes as 0. Encoding uses the standard alphabet.
+
+#include "pw_base64_private/simd.h"
+
+#if PW_BASE64_SIMD
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif  // defined(__x86_64__)
+
+namespace pw::base64::internal {
+namespace {
+
+#if defined(__x86_64__)
+
+#define PW_BASE64_SSSE3 __attribute__((target("ssse3")))
+#define PW_BASE64_AVX2 __attribute__((target("avx2")))
+
+enum class Isa { kNone, kSsse3, kAvx2 };
+
+// AVX2 requires both CPU support and the OS saving the YMM registers.
+Isa DetectIsa() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_SSSE3) == 0) {
+    return Isa::kNone;
+  }
+  if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0) {
+    return Isa::kSsse3;
+  }
+  uint32_t xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  if ((xcr0_low & 0b110) != 0b110 ||
+      __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0 ||
+      (ebx & bit_AVX2) == 0) {
+    return Isa::kSsse3;
+  }
+  return Isa::kAvx2;
+}
+
+Isa CpuIsa() {
+  static const Isa isa = DetectIsa();
+  return isa;
+}
+
+// Encoding
+
+// The offsets from 6-bit indices to characters, indexed as in EncodeBlock.
+inline __m128i EncodeOffsets() {
+  return _mm_setr_epi8('a' - 26,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '0' - 52,
+                       '+' - 62,
+                       '/' - 63,
+                       'A',
+                       0,
+                       0);
+}
+
+// Spreads each 3 bytes of the low 12 bytes into 4 bytes holding 6-bit indices,
+// and translates the indices to characters. Based on the multiply-shift
+// unpacking and pshufb character lookup described by Wojciech Muła.
+PW_BASE64_SSSE3 inline __m128i EncodeBlock(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i hi =
+      _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                      _mm_set1_epi32(0x04000040));
+  const __m128i lo =
+      _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                      _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(hi, lo);
+
+  // Map the indices 0-25 to 13, 26-51 to 0, 52-61 to 1-10, 62 to 11, and 63 to
+  // 12, then add the offset from each index to its character.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  range = _mm_or_si128(range,
+                       _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices),
+                                     _mm_set1_epi8(13)));
+  return _mm_add_epi8(indices, _mm_shuffle_epi8(EncodeOffsets(), range));
+}
+
+PW_BASE64_AVX2 inline __m256i EncodeBlock(__m256i in) {
+  in = _mm256_shuffle_epi8(in,
+                           _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,  //
+                                           4, 5, 3, 4, 1, 2, 0, 1,     //
+                                           10, 11, 9, 10, 7, 8, 6, 7,  //
+                                           4, 5, 3, 4, 1, 2, 0, 1));
+  const __m256i hi =
+      _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                         _mm256_set1_epi32(0x04000040));
+  const __m256i lo =
+      _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                         _mm256_set1_epi32(0x01000010));
+  const __m256i indices = _mm256_or_si256(hi, lo);
+
+  __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  range = _mm256_or_si256(
+      range,
+      _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices),
+                       _mm256_set1_epi8(13)));
+  const __m256i offsets = _mm256_broadcastsi128_si256(EncodeOffsets());
+  return _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, range));
+}
+
+// Encodes 12 bytes at a time. Each load reads 16 bytes, so the loop stops
+// while at least 4 more bytes remain.
+PW_BASE64_SSSE3 size_t EncodeSsse3(const uint8_t* binary,
+                                   size_t size_bytes,
+                                   char* output) {
+  size_t i = 0;
+  for (; i + 16 <= size_bytes; i += 12, output += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(binary + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), EncodeBlock(in));
+  }
+  return i;
+}
+
+// Encodes 24 bytes at a time, as two 12-byte halves loaded into each lane.
+PW_BASE64_AVX2 size_t EncodeAvx2(const uint8_t* binary,
+                                 size_t size_bytes,
+                                 char* output) {
+  size_t i = 0;
+  for (; i + 28 <= size_bytes; i += 24, output += 32) {
+    const __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(binary + i))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(binary + i + 12)),
+        1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), EncodeBlock(in));
+  }
+  return i;
+}
+
+// Decoding and validation
+
+// Characters are classified with table lookups by their high and low nibbles,
+// as in Wojciech Muła's decoder, extended to accept both alphabets and '='.
+//
+// Each bit of the class tables stands for one or more high nibbles. HighClasses
+// gives the bit for each high nibble and LowClasses sets that bit for each low
+// nibble that is not valid with it, so ANDing the two lookups gives nonzero
+// bytes for exactly the invalid characters. Bytes of 0x80 or more have high
+// nibbles of 8-F, which are always invalid.
+inline __m128i LowClasses() {
+  return _mm_setr_epi8(0x0b,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x03,
+                       0x07,
+                       0x35,
+                       0x37,
+                       0x31,
+                       0x37,
+                       0x25);
+}
+
+inline __m128i HighClasses() {
+  return _mm_setr_epi8(
+      0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x20, 1, 1, 1, 1, 1, 1, 1, 1);
+}
+
+// Offsets from characters to 6-bit values by high nibble. '_' and '=' are
+// adjusted separately.
+inline __m128i HighOffsets() {
+  return _mm_setr_epi8(0,
+                       0,
+                       0,
+                       52 - '0',
+                       -'A',
+                       -'A',
+                       26 - 'a',
+                       26 - 'a',
+                       0,
+                       0,
+                       0,
+                       0,
+                       0,
+                       0,
+                       0,
+                       0);
+}
+
+// Offsets for '+', '-', and '/', which share the high nibble 2, by low nibble.
+inline __m128i SymbolOffsets() {
+  return _mm_setr_epi8(
+      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 62 - '+', 0, 62 - '-', 0, 63 - '/');
+}
+
+constexpr char kUnderscoreAdjustment = (63 - '_') - -'A';
+constexpr char kPaddingAdjustment = (0 - '=') - (52 - '0');
+
+// Translates 16 characters to their 6-bit values. Sets the bytes of `invalid`
+// to nonzero values for characters that are not valid Base64.
+PW_BASE64_SSSE3 inline __m128i DecodeChars(__m128i chars, __m128i& invalid) {
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  const __m128i high = _mm_and_si128(_mm_srli_epi32(chars, 4), nibble);
+  const __m128i low = _mm_and_si128(chars, nibble);
+  invalid = _mm_and_si128(_mm_shuffle_epi8(LowClasses(), low),
+                          _mm_shuffle_epi8(HighClasses(), high));
+
+  const __m128i symbols = _mm_and_si128(
+      _mm_cmpeq_epi8(high, _mm_set1_epi8(2)),
+      _mm_shuffle_epi8(SymbolOffsets(), low));
+  const __m128i adjustments = _mm_or_si128(
+      _mm_and_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('_')),
+                    _mm_set1_epi8(kUnderscoreAdjustment)),
+      _mm_and_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('=')),
+                    _mm_set1_epi8(kPaddingAdjustment)));
+  const __m128i offsets =
+      _mm_add_epi8(_mm_shuffle_epi8(HighOffsets(), high),
+                   _mm_add_epi8(symbols, adjustments));
+  return _mm_add_epi8(chars, offsets);
+}
+
+PW_BASE64_SSSE3 inline bool AllValid(__m128i invalid) {
+  return _mm_movemask_epi8(
+             _mm_cmpeq_epi8(invalid, _mm_setzero_si128())) == 0xffff;
+}
+
+// Packs groups of four 6-bit values into three bytes, in the low 12 bytes.
+PW_BASE64_SSSE3 inline __m128i PackValues(__m128i values) {
+  const __m128i pairs =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(
+      groups,
+      _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+PW_BASE64_SSSE3 size_t DecodeSsse3(const char* base64,
+                                   size_t size_bytes,
+                                   uint8_t* output) {
+  size_t i = 0;
+  for (; i + 16 <= size_bytes; i += 16, output += 12) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(base64 + i));
+    __m128i invalid;
+    const __m128i values = DecodeChars(chars, invalid);
+    if (!AllValid(invalid)) {
+      break;
+    }
+    const __m128i bytes = PackValues(values);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), bytes);
+    const uint32_t last = static_cast<uint32_t>(
+        _mm_cvtsi128_si32(_mm_srli_si128(bytes, 8)));
+    std::memcpy(output + 8, &last, sizeof(last));
+  }
+  return i;
+}
+
+PW_BASE64_SSSE3 size_t ValidPrefixSsse3(const char* base64,
+                                        size_t size_bytes) {
+  size_t i = 0;
+  for (; i + 16 <= size_bytes; i += 16) {
+    __m128i invalid;
+    DecodeChars(_mm_loadu_si128(reinterpret_cast<const __m128i*>(base64 + i)),
+                invalid);
+    if (!AllValid(invalid)) {
+      break;
+    }
+  }
+  return i;
+}
+
+PW_BASE64_AVX2 inline __m256i DecodeChars(__m256i chars, __m256i& invalid) {
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i high = _mm256_and_si256(_mm256_srli_epi32(chars, 4), nibble);
+  const __m256i low = _mm256_and_si256(chars, nibble);
+  invalid = _mm256_and_si256(
+      _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(LowClasses()), low),
+      _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(HighClasses()), high));
+
+  const __m256i symbols = _mm256_and_si256(
+      _mm256_cmpeq_epi8(high, _mm256_set1_epi8(2)),
+      _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(SymbolOffsets()), low));
+  const __m256i adjustments = _mm256_or_si256(
+      _mm256_and_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')),
+                       _mm256_set1_epi8(kUnderscoreAdjustment)),
+      _mm256_and_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('=')),
+                       _mm256_set1_epi8(kPaddingAdjustment)));
+  const __m256i offsets = _mm256_add_epi8(
+      _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(HighOffsets()), high),
+      _mm256_add_epi8(symbols, adjustments));
+  return _mm256_add_epi8(chars, offsets);
+}
+
+PW_BASE64_AVX2 size_t DecodeAvx2(const char* base64,
+                                 size_t size_bytes,
+                                 uint8_t* output) {
+  size_t i = 0;
+  for (; i + 32 <= size_bytes; i += 32, output += 24) {
+    const __m256i chars =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base64 + i));
+    __m256i invalid;
+    const __m256i values = DecodeChars(chars, invalid);
+    if (!_mm256_testz_si256(invalid, invalid)) {
+      break;
+    }
+    const __m256i pairs =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    __m256i bytes = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    bytes = _mm256_shuffle_epi8(
+        bytes,
+        _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                         2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1,
+                         -1));
+    // Move the 12 bytes from each lane together.
+    bytes = _mm256_permutevar8x32_epi32(
+        bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                     _mm256_castsi256_si128(bytes));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output + 16),
+                     _mm256_extracti128_si256(bytes, 1));
+  }
+  return i;
+}
+
+PW_BASE64_AVX2 size_t ValidPrefixAvx2(const char* base64, size_t size_bytes) {
+  size_t i = 0;
+  for (; i + 32 <= size_bytes; i += 32) {
+    __m256i invalid;
+    DecodeChars(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base64 + i)),
+        invalid);
+    if (!_mm256_testz_si256(invalid, invalid)) {
+      break;
+    }
+  }
+  return i;
+}
+
+#elif defined(__aarch64__)
+
+constexpr char kEncodeTable[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Returns a mask of the bytes of `chars` in [low, high].
+inline uint8x16_t InRange(uint8x16_t chars, uint8_t low, uint8_t high) {
+  return vandq_u8(vcgeq_u8(chars, vdupq_n_u8(low)),
+                  vcleq_u8(chars, vdupq_n_u8(high)));
+}
+
+inline uint8x16_t IsEither(uint8x16_t chars, uint8_t first, uint8_t second) {
+  return vorrq_u8(vceqq_u8(chars, vdupq_n_u8(first)),
+                  vceqq_u8(chars, vdupq_n_u8(second)));
+}
+
+// Translates 16 characters to their 6-bit values. Clears the bytes of `valid`
+// for characters that are not valid Base64.
+inline uint8x16_t DecodeChars(uint8x16_t chars, uint8x16_t& valid) {
+  const uint8x16_t upper = InRange(chars, 'A', 'Z');
+  const uint8x16_t lower = InRange(chars, 'a', 'z');
+  const uint8x16_t digit = InRange(chars, '0', '9');
+  const uint8x16_t char62 = IsEither(chars, '+', '-');
+  const uint8x16_t char63 = IsEither(chars, '/', '_');
+  const uint8x16_t padding = vceqq_u8(chars, vdupq_n_u8('='));
+
+  const uint8x16_t offset = vorrq_u8(
+      vorrq_u8(vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-'A'))),
+               vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(26 - 'a')))),
+      vandq_u8(digit, vdupq_n_u8(static_cast<uint8_t>(52 - '0'))));
+  const uint8x16_t alphanumeric = vorrq_u8(vorrq_u8(upper, lower), digit);
+  valid = vandq_u8(valid,
+                   vorrq_u8(vorrq_u8(alphanumeric, padding),
+                            vorrq_u8(char62, char63)));
+  return vorrq_u8(vandq_u8(vaddq_u8(chars, offset), alphanumeric),
+                  vorrq_u8(vandq_u8(char62, vdupq_n_u8(62)),
+                           vandq_u8(char63, vdupq_n_u8(63))));
+}
+
+#endif  // defined(__x86_64__)
+
+}  // namespace
+
+#if defined(__x86_64__)
+
+// The AVX2 functions return before the SSSE3 functions finish the
+// remaining input, so the compiler clears the upper halves of the AVX
+// registers (vzeroupper) in between. Mixing the two without that is slow.
+
+size_t EncodeSimd(const uint8_t* binary, size_t size_bytes, char* output) {
+  switch (CpuIsa()) {
+    case Isa::kAvx2: {
+      const size_t encoded = EncodeAvx2(binary, size_bytes, output);
+      return encoded + EncodeSsse3(binary + encoded,
+                                   size_bytes - encoded,
+                                   output + encoded / 3 * 4);
+    }
+    case Isa::kSsse3:
+      return EncodeSsse3(binary, size_bytes, output);
+    case Isa::kNone:
+      break;
+  }
+  return 0;
+}
+
+size_t DecodeSimd(const char* base64, size_t size_bytes, uint8_t* output) {
+  switch (CpuIsa()) {
+    case Isa::kAvx2: {
+      const size_t decoded = DecodeAvx2(base64, size_bytes, output);
+      return decoded + DecodeSsse3(base64 + decoded,
+                                   size_bytes - decoded,
+                                   output + decoded / 4 * 3);
+    }
+    case Isa::kSsse3:
+      return DecodeSsse3(base64, size_bytes, output);
+    case Isa::kNone:
+      break;
+  }
+  return 0;
+}
+
+size_t ValidPrefixSimd(const char* base64, size_t size_bytes) {
+  switch (CpuIsa()) {
+    case Isa::kAvx2: {
+      const size_t valid = ValidPrefixAvx2(base64, size_bytes);
+      return valid + ValidPrefixSsse3(base64 + valid, size_bytes - valid);
+    }
+    case Isa::kSsse3:
+      return ValidPrefixSsse3(base64, size_bytes);
+    case Isa::kNone:
+      break;
+  }
+  return 0;
+}
+
+#elif defined(__aarch64__)
+
+// Encodes 48 bytes at a time. vld3q_u8 separates the first, second, and third
+// byte of each group, and vst4q_u8 interleaves the four characters.
+size_t EncodeSimd(const uint8_t* binary, size_t size_bytes, char* output) {
+  const auto* table_bytes = reinterpret_cast<const uint8_t*>(kEncodeTable);
+  uint8x16x4_t table;
+  table.val[0] = vld1q_u8(table_bytes);
+  table.val[1] = vld1q_u8(table_bytes + 16);
+  table.val[2] = vld1q_u8(table_bytes + 32);
+  table.val[3] = vld1q_u8(table_bytes + 48);
+  const uint8x16_t low_6_bits = vdupq_n_u8(0b111111);
+
+  size_t i = 0;
+  for (; i + 48 <= size_bytes; i += 48, output += 64) {
+    const uint8x16x3_t in = vld3q_u8(binary + i);
+    uint8x16x4_t indices;
+    indices.val[0] = vshrq_n_u8(in.val[0], 2);
+    indices.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)),
+        low_6_bits);
+    indices.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)),
+        low_6_bits);
+    indices.val[3] = vandq_u8(in.val[2], low_6_bits);
+
+    uint8x16x4_t chars;
+    for (int j = 0; j < 4; ++j) {
+      chars.val[j] = vqtbl4q_u8(table, indices.val[j]);
+    }
+    vst4q_u8(reinterpret_cast<uint8_t*>(output), chars);
+  }
+  return i;
+}
+
+// Decodes 64 characters at a time, the inverse of EncodeSimd.
+size_t DecodeSimd(const char* base64, size_t size_bytes, uint8_t* output) {
+  size_t i = 0;
+  for (; i + 64 <= size_bytes; i += 64, output += 48) {
+    const uint8x16x4_t chars =
+        vld4q_u8(reinterpret_cast<const uint8_t*>(base64 + i));
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    const uint8x16_t v0 = DecodeChars(chars.val[0], valid);
+    const uint8x16_t v1 = DecodeChars(chars.val[1], valid);
+    const uint8x16_t v2 = DecodeChars(chars.val[2], valid);
+    const uint8x16_t v3 = DecodeChars(chars.val[3], valid);
+    if (vminvq_u8(valid) == 0) {
+      break;
+    }
+    uint8x16x3_t bytes;
+    bytes.val[0] = vorrq_u8(vshlq_n_u8(v0, 2), vshrq_n_u8(v1, 4));
+    bytes.val[1] = vorrq_u8(vshlq_n_u8(v1, 4), vshrq_n_u8(v2, 2));
+    bytes.val[2] = vorrq_u8(vshlq_n_u8(v2, 6), v3);
+    vst3q_u8(output, bytes);
+  }
+  return i;
+}
+
+size_t ValidPrefixSimd(const char* base64, size_t size_bytes) {
+  size_t i = 0;
+  for (; i + 16 <= size_bytes; i += 16) {
+    uint8x16_t valid = vdupq_n_u8(0xff);
+    DecodeChars(vld1q_u8(reinterpret_cast<const uint8_t*>(base64 + i)), valid);
+    if (vminvq_u8(valid) == 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+#endif  // defined(__x86_64__)
+
+}  // namespace pw::base64::internal
+
+#endif  // PW_BASE64_SIMD
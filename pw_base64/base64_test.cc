@@ -14,6 +14,8 @@
 
 #include "pw_base64/base64.h"
 
+#include <array>
+#include <cstddef>
 #include <cstring>
 
 #include "pw_unit_test/framework.h"
@@ -411,6 +413,88 @@ TEST(Base64, IsValid_InvalidCharacters) {
   EXPECT_FALSE(IsValid(std::string_view(kBase64, 12)));
 }
 
+// Long inputs are processed in blocks with vector instructions on some hosts.
+// Check them against the same data processed one group at a time, which is
+// too short for the vector paths.
+constexpr size_t kLongDataSize = 300;
+
+std::array<std::byte, kLongDataSize> LongData() {
+  std::array<std::byte, kLongDataSize> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::byte>(i * 167 + 13);
+  }
+  return data;
+}
+
+TEST(Base64, Encode_LongData_MatchesGroups) {
+  const auto data = LongData();
+  char expected[EncodedSize(kLongDataSize)];
+  for (size_t i = 0; i < kLongDataSize; i += 3) {
+    Encode(span(data).subspan(i, 3), &expected[i / 3 * 4]);
+  }
+
+  char encoded[EncodedSize(kLongDataSize)];
+  for (size_t size = 0; size <= kLongDataSize; size += 3) {
+    Encode(span(data).first(size), encoded);
+    ASSERT_EQ(0, std::memcmp(expected, encoded, EncodedSize(size)));
+  }
+}
+
+TEST(Base64, Decode_LongData_RoundTrip) {
+  const auto data = LongData();
+  char encoded[EncodedSize(kLongDataSize)];
+  std::byte decoded[kLongDataSize];
+
+  for (size_t size = 0; size <= kLongDataSize; ++size) {
+    const std::string_view base64(encoded, EncodedSize(size));
+    Encode(span(data).first(size), encoded);
+    ASSERT_TRUE(IsValid(base64));
+    ASSERT_EQ(size, Decode(base64, decoded));
+    ASSERT_EQ(0, std::memcmp(data.data(), decoded, size));
+
+    ASSERT_EQ(size, Decode(base64, encoded));
+    ASSERT_EQ(0, std::memcmp(data.data(), encoded, size));
+  }
+}
+
+TEST(Base64, Decode_LongData_UrlSafe) {
+  const auto data = LongData();
+  char encoded[EncodedSize(kLongDataSize)];
+  Encode(data, encoded);
+  for (char& c : encoded) {
+    if (c == '+') {
+      c = '-';
+    } else if (c == '/') {
+      c = '_';
+    }
+  }
+
+  std::byte decoded[kLongDataSize];
+  const std::string_view base64(encoded, sizeof(encoded));
+  EXPECT_TRUE(IsValid(base64));
+  ASSERT_EQ(kLongDataSize, Decode(base64, decoded));
+  EXPECT_EQ(0, std::memcmp(data.data(), decoded, kLongDataSize));
+}
+
+TEST(Base64, IsValid_LongData_InvalidCharacterAnywhere) {
+  const auto data = LongData();
+  char encoded[EncodedSize(kLongDataSize)];
+  Encode(data, encoded);
+  const std::string_view base64(encoded, sizeof(encoded));
+  ASSERT_TRUE(IsValid(base64));
+
+  constexpr char kInvalid[] = {
+      '\0', '#', ',', '.', ':', '@', '[', '`', '{', '\x80', '\xff'};
+  for (size_t i = 0; i < sizeof(encoded); ++i) {
+    const char original = encoded[i];
+    for (char invalid : kInvalid) {
+      encoded[i] = invalid;
+      ASSERT_FALSE(IsValid(base64));
+    }
+    encoded[i] = original;
+  }
+}
+
 TEST(Base64CLinkage, IsValid_Ok) {
   EXPECT_TRUE(pw_Base64CallIsValid(kBase64, 4));
   EXPECT_TRUE(pw_Base64CallIsValid(kBase64, 8));
@@ -0,0 +1,59 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized Base64 is used on x86-64, where SSSE3 or AVX2 is selected at
+// runtime, and on AArch64, where NEON is always present. Define this to 0 to
+// use only the portable code.
+#ifndef PW_BASE64_SIMD
+#if (defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))) || \
+    (defined(__aarch64__) && defined(__ARM_NEON))
+#define PW_BASE64_SIMD 1
+#else
+#define PW_BASE64_SIMD 0
+#endif
+#endif  // PW_BASE64_SIMD
+
+namespace pw::base64::internal {
+
+#if PW_BASE64_SIMD
+
+// Encodes a prefix of the binary data with vector instructions. Returns the
+// number of bytes encoded, which is a multiple of 3. The rest of the data is
+// left for the portable encoder.
+size_t EncodeSimd(const uint8_t* binary, size_t size_bytes, char* output);
+
+// Decodes a prefix of the Base64 data with vector instructions. Returns the
+// number of characters decoded, which is a multiple of 4. Stops before any
+// block that contains a character that is not valid Base64, so the portable
+// decoder handles it. `output` may be the same as `base64`.
+size_t DecodeSimd(const char* base64, size_t size_bytes, uint8_t* output);
+
+// Returns the length of a prefix of `base64` that has only valid characters,
+// as defined by pw_Base64IsValidChar. The prefix may be shorter than the
+// longest valid prefix.
+size_t ValidPrefixSimd(const char* base64, size_t size_bytes);
+
+#else
+
+inline size_t EncodeSimd(const uint8_t*, size_t, char*) { return 0; }
+inline size_t DecodeSimd(const char*, size_t, uint8_t*) { return 0; }
+inline size_t ValidPrefixSimd(const char*, size_t) { return 0; }
+
+#endif  // PW_BASE64_SIMD
+
+}  // namespace pw::base64::internal
@@ -834,6 +834,23 @@ Status BlobStore::BlobReader::DoSeek(ptrdiff_t offset, Whence origin) {
   return OkStatus();
 }
 
+Result<ConstByteSpan> BlobStore::BlobReader::ReadMemoryMapped(
+    size_t max_size) {
+  if (!open_) {
+    return Status::FailedPrecondition();
+  }
+
+  PW_TRY_ASSIGN(ConstByteSpan blob, store_.GetMemoryMappedBlob());
+  if (offset_ >= blob.size()) {
+    return Status::OutOfRange();
+  }
+
+  ConstByteSpan data =
+      blob.subspan(offset_, std::min(max_size, blob.size() - offset_));
+  offset_ += data.size();
+  return data;
+}
+
 StatusWithSize BlobStore::BlobReader::DoRead(ByteSpan dest) {
   if (!open_) {
     return StatusWithSize::FailedPrecondition();
@@ -0,0 +1,162 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures writing and reading a 32 KiB blob in 256-byte chunks, on a
+// FakeFlashMemoryBuffer and on a MappedFileFlashMemory.
+
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+#include "pw_assert/check.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/mapped_file_flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_span/span.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kSectorSize = 4 * 1024;
+constexpr size_t kSectors = 8;
+constexpr size_t kAlignment = 16;
+constexpr size_t kChunkSize = 256;
+constexpr size_t kBufferSize = 256;
+
+class BlobBenchmark {
+ public:
+  explicit BlobBenchmark(kvs::FlashMemory& flash)
+      : partition_(&flash),
+        blob_("Blob", partition_, &checksum_, kvs::TestKvs(), kBufferSize) {
+    for (size_t i = 0; i < data_.size(); ++i) {
+      data_[i] = static_cast<std::byte>(i);
+    }
+    PW_CHECK_OK(blob_.Init());
+  }
+
+  // Discards the blob, so that its metadata in the shared test KVS does not
+  // refer to another flash memory's contents.
+  ~BlobBenchmark() {
+    BlobStore::BlobWriter writer(blob_, metadata_buffer_);
+    PW_CHECK_OK(writer.Open());
+    PW_CHECK_OK(writer.Discard());
+    PW_CHECK_OK(writer.Close());
+  }
+
+  void Write() {
+    BlobStore::BlobWriter writer(blob_, metadata_buffer_);
+    PW_CHECK_OK(writer.Open());
+    PW_CHECK_OK(writer.Erase());
+    for (ConstByteSpan source = data_; !source.empty();
+         source = source.subspan(kChunkSize)) {
+      PW_CHECK_OK(writer.Write(source.first(kChunkSize)));
+    }
+    PW_CHECK_OK(writer.Close());
+  }
+
+  void Read() {
+    std::array<std::byte, kChunkSize> chunk;
+    BlobStore::BlobReader reader(blob_);
+    PW_CHECK_OK(reader.Open());
+    for (size_t i = 0; i < data_.size(); i += kChunkSize) {
+      PW_CHECK_OK(reader.Read(chunk).status());
+    }
+    PW_CHECK_OK(reader.Close());
+  }
+
+ private:
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  BlobStoreBuffer<kBufferSize> blob_;
+  std::array<std::byte, kSectorSize * kSectors> data_;
+  std::array<std::byte, BlobStore::BlobWriter::RequiredMetadataBufferSize(16)>
+      metadata_buffer_;
+};
+
+// A MappedFileFlashMemory backed by a temporary file.
+class TempFileFlash {
+ public:
+  TempFileFlash()
+      : flash_(kSectorSize, kSectors, kAlignment),
+        path_((std::filesystem::temp_directory_path() /
+               "pw_blob_store_perf_XXXXXX")
+                  .string()) {
+    const int fd = mkstemp(path_.data());
+    PW_CHECK_INT_GE(fd, 0);
+    close(fd);
+    PW_CHECK_OK(flash_.Open(path_.c_str()));
+  }
+
+  ~TempFileFlash() {
+    flash_.Close().IgnoreError();
+    std::filesystem::remove(path_);
+  }
+
+  kvs::FlashMemory& flash() { return flash_; }
+
+ private:
+  kvs::MappedFileFlashMemory flash_;
+  std::string path_;
+};
+
+void Write(perf_test::State& state, kvs::FlashMemory& flash) {
+  BlobBenchmark blob(flash);
+  while (state.KeepRunning()) {
+    blob.Write();
+  }
+}
+
+void Read(perf_test::State& state, kvs::FlashMemory& flash) {
+  BlobBenchmark blob(flash);
+  blob.Write();
+  while (state.KeepRunning()) {
+    blob.Read();
+  }
+}
+
+void WriteFake(perf_test::State& state) {
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectors> flash(kAlignment);
+  Write(state, flash);
+}
+
+void WriteMapped(perf_test::State& state) {
+  TempFileFlash flash;
+  Write(state, flash.flash());
+}
+
+void ReadFake(perf_test::State& state) {
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectors> flash(kAlignment);
+  Read(state, flash);
+}
+
+void ReadMapped(perf_test::State& state) {
+  TempFileFlash flash;
+  Read(state, flash.flash());
+}
+
+PW_PERF_TEST(Write32KiBFakeFlash, WriteFake);
+PW_PERF_TEST(Write32KiBMappedFile, WriteMapped);
+PW_PERF_TEST(Read32KiBFakeFlash, ReadFake);
+PW_PERF_TEST(Read32KiBMappedFile, ReadMapped);
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -700,6 +700,41 @@ TEST_F(BlobStoreTest, SeekOffsetRead) {
   VerifyFlash(read_buffer, kOffset);
 }
 
+TEST_F(BlobStoreTest, ReadMemoryMapped) {
+  InitSourceBufferToRandom(0x11309);
+  WriteTestBlock();
+
+  constexpr size_t kOffset = 10;
+  constexpr size_t kChunkSize = 1000;
+
+  kvs::ChecksumCrc16 checksum;
+
+  char name[16] = "TestBlobBlock";
+  constexpr size_t kBufferSize = 16;
+  BlobStoreBuffer<kBufferSize> blob(
+      name, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  BlobStore::BlobReader reader(blob);
+  EXPECT_EQ(Status::FailedPrecondition(),
+            reader.ReadMemoryMapped(kChunkSize).status());
+  ASSERT_EQ(OkStatus(), reader.Open(kOffset));
+
+  size_t offset = kOffset;
+  while (offset < kBlobDataSize) {
+    Result<ConstByteSpan> result = reader.ReadMemoryMapped(kChunkSize);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(result->size(), std::min(kChunkSize, kBlobDataSize - offset));
+    // The data is not copied.
+    EXPECT_EQ(result->data(), flash_.buffer().data() + offset);
+    VerifyFlash(*result, offset);
+    offset += result->size();
+    EXPECT_EQ(kBlobDataSize - offset, reader.ConservativeReadLimit());
+  }
+
+  EXPECT_EQ(Status::OutOfRange(), reader.ReadMemoryMapped(kChunkSize).status());
+  EXPECT_EQ(OkStatus(), reader.Close());
+}
+
 TEST_F(BlobStoreTest, InvalidReadOffset) {
   InitSourceBufferToRandom(0x11309);
   WriteTestBlock();
@@ -396,6 +396,17 @@ class BlobStore {
                    : Status::FailedPrecondition();
     }
 
+    // Reads up to max_size bytes from the reader's position without copying
+    // them, by returning a span of the memory-mapped blob data. Advances the
+    // position past the returned bytes, like Read. Returns:
+    //
+    //   OK with span - Valid span of the next bytes of blob data
+    //   FAILED_PRECONDITION - Reader not open.
+    //   OUT_OF_RANGE - Reader is at the end of the blob.
+    //   UNIMPLEMENTED - Memory mapped access not supported for this blob.
+    //
+    Result<ConstByteSpan> ReadMemoryMapped(size_t max_size);
+
    private:
     // Probable (not guaranteed) minimum number of bytes at this time that can
     // be read. Returns zero if, in the current state, Read would return status
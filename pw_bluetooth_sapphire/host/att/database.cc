@@ -26,34 +26,61 @@
 namespace bt::att {
 namespace {
 
-bool StartLessThan(const AttributeGrouping& grp, const Handle handle) {
-  return grp.start_handle() < handle;
+using GroupingIterator = std::list<AttributeGrouping>::iterator;
+
+bool StartLessThan(const GroupingIterator& grp, const Handle handle) {
+  return grp->start_handle() < handle;
 }
 
-bool EndLessThan(const AttributeGrouping& grp, const Handle handle) {
-  return grp.end_handle() < handle;
+bool EndLessThan(const GroupingIterator& grp, const Handle handle) {
+  return grp->end_handle() < handle;
 }
 
 }  // namespace
 
-Database::Iterator::Iterator(GroupingList* list,
+Database::Iterator::Iterator(Database* db,
                              Handle start,
                              Handle end,
                              const UUID* type,
                              bool groups_only)
     : start_(start), end_(end), grp_only_(groups_only), attr_offset_(0u) {
-  BT_DEBUG_ASSERT(list);
-  grp_end_ = list->end();
+  BT_DEBUG_ASSERT(db);
+  grp_end_ = db->groupings_.end();
 
-  if (type)
+  if (type) {
     type_filter_ = *type;
 
-  // Initialize the iterator by performing a binary search over the attributes.
+    // Visit only the attributes of this type if the database is indexed.
+    if (const TypeIndex* index = db->GetTypeIndex(); index) {
+      auto entries = index->find(*type);
+      if (entries == index->end()) {
+        MarkEnd();
+        return;
+      }
+      type_entries_ = &entries->second;
+      type_entry_ = std::lower_bound(type_entries_->begin(),
+                                     type_entries_->end(),
+                                     start_,
+                                     [](const IndexedAttribute& attr,
+                                        Handle handle) {
+                                       return attr.handle < handle;
+                                     }) -
+                    type_entries_->begin();
+      SeekIndexed();
+      return;
+    }
+  }
+
+  // Initialize the iterator by performing a binary search over the groupings.
   // If we were asked to iterate over groupings only, then look strictly within
   // the range. Otherwise we allow the first grouping to partially overlap the
   // range.
-  grp_iter_ = std::lower_bound(
-      list->begin(), grp_end_, start_, grp_only_ ? StartLessThan : EndLessThan);
+  const auto& groupings = db->grouping_index_;
+  auto first = std::lower_bound(groupings.begin(),
+                                groupings.end(),
+                                start_,
+                                grp_only_ ? StartLessThan : EndLessThan);
+  grp_iter_ = first == groupings.end() ? grp_end_ : *first;
 
   if (AtEnd())
     return;
@@ -89,6 +116,12 @@ void Database::Iterator::Advance() {
   if (AtEnd())
     return;
 
+  if (type_entries_) {
+    type_entry_++;
+    SeekIndexed();
+    return;
+  }
+
   do {
     if (!grp_only_ && grp_iter_->active()) {
       // If this grouping has more attributes to look at.
@@ -144,6 +177,28 @@ void Database::Iterator::Advance() {
   } while (true);
 }
 
+void Database::Iterator::SeekIndexed() {
+  BT_DEBUG_ASSERT(type_entries_);
+
+  for (; type_entry_ < type_entries_->size(); ++type_entry_) {
+    const IndexedAttribute& attr = (*type_entries_)[type_entry_];
+    if (attr.handle > end_)
+      break;
+
+    // When iterating over groupings only, skip attributes that are not group
+    // declarations.
+    if (!attr.grouping->active() ||
+        (grp_only_ && attr.handle != attr.grouping->start_handle()))
+      continue;
+
+    grp_iter_ = attr.grouping;
+    attr_offset_ = attr.handle - grp_iter_->start_handle();
+    return;
+  }
+
+  MarkEnd();
+}
+
 Database::Database(Handle range_start, Handle range_end)
     : WeakSelf(this), range_start_(range_start), range_end_(range_end) {
   BT_DEBUG_ASSERT(range_start_ < range_end_);
@@ -159,7 +214,7 @@ Database::Iterator Database::GetIterator(Handle start,
   BT_DEBUG_ASSERT(end <= range_end_);
   BT_DEBUG_ASSERT(start <= end);
 
-  return Iterator(&groupings_, start, end, type, groups_only);
+  return Iterator(this, start, end, type, groups_only);
 }
 
 AttributeGrouping* Database::NewGrouping(const UUID& group_type,
@@ -210,17 +265,30 @@ AttributeGrouping* Database::NewGrouping(const UUID& group_type,
       groupings_.emplace(pos, group_type, start_handle, attr_count, decl_value);
   BT_DEBUG_ASSERT(iter != groupings_.end());
 
+  grouping_index_.insert(std::lower_bound(grouping_index_.begin(),
+                                          grouping_index_.end(),
+                                          start_handle,
+                                          StartLessThan),
+                         iter);
+  type_index_.clear();
+  type_index_valid_ = false;
+
   return &*iter;
 }
 
 bool Database::RemoveGrouping(Handle start_handle) {
-  auto iter = std::lower_bound(
-      groupings_.begin(), groupings_.end(), start_handle, StartLessThan);
+  auto iter = std::lower_bound(grouping_index_.begin(),
+                               grouping_index_.end(),
+                               start_handle,
+                               StartLessThan);
 
-  if (iter == groupings_.end() || iter->start_handle() != start_handle)
+  if (iter == grouping_index_.end() || (*iter)->start_handle() != start_handle)
     return false;
 
-  groupings_.erase(iter);
+  groupings_.erase(*iter);
+  grouping_index_.erase(iter);
+  type_index_.clear();
+  type_index_valid_ = false;
   return true;
 }
 
@@ -230,17 +298,37 @@ const Attribute* Database::FindAttribute(Handle handle) {
 
   // Do a binary search to find the grouping that this handle is in.
   auto iter = std::lower_bound(
-      groupings_.begin(), groupings_.end(), handle, EndLessThan);
-  if (iter == groupings_.end() || iter->start_handle() > handle)
+      grouping_index_.begin(), grouping_index_.end(), handle, EndLessThan);
+  if (iter == grouping_index_.end() || (*iter)->start_handle() > handle)
     return nullptr;
 
-  if (!iter->active() || !iter->complete())
+  const AttributeGrouping& grouping = **iter;
+  if (!grouping.active() || !grouping.complete())
     return nullptr;
 
-  size_t index = handle - iter->start_handle();
-  BT_DEBUG_ASSERT(index < iter->attributes().size());
+  size_t index = handle - grouping.start_handle();
+  BT_DEBUG_ASSERT(index < grouping.attributes().size());
 
-  return &iter->attributes()[index];
+  return &grouping.attributes()[index];
+}
+
+const Database::TypeIndex* Database::GetTypeIndex() {
+  if (type_index_valid_)
+    return &type_index_;
+
+  if (!std::all_of(groupings_.begin(),
+                   groupings_.end(),
+                   [](const AttributeGrouping& grp) { return grp.complete(); }))
+    return nullptr;
+
+  // |groupings_| is sorted by handle, so each list of attributes is too.
+  for (auto grp = groupings_.begin(); grp != groupings_.end(); ++grp) {
+    for (const Attribute& attr : grp->attributes()) {
+      type_index_[attr.type()].push_back(IndexedAttribute{attr.handle(), grp});
+    }
+  }
+  type_index_valid_ = true;
+  return &type_index_;
 }
 
 void Database::ExecuteWriteQueue(PeerId peer_id,
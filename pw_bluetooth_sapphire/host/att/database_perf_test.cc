@@ -0,0 +1,135 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the database lookups done to handle ATT requests, for databases
+// with different numbers of services. Each service has three characteristics,
+// each with a declaration, a value, and a configuration descriptor.
+
+#include "pw_bluetooth_sapphire/internal/host/att/database.h"
+#include "pw_bluetooth_sapphire/internal/host/common/assert.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace bt::att {
+namespace {
+
+constexpr UUID kPrimaryService(uint16_t{0x2800});
+constexpr UUID kCharacteristic(uint16_t{0x2803});
+constexpr UUID kClientConfig(uint16_t{0x2902});
+
+constexpr size_t kCharacteristicsPerService = 3;
+constexpr size_t kAttributesPerService = 1 + 3 * kCharacteristicsPerService;
+
+const StaticByteBuffer kServiceValue(0x0d, 0x18);
+const StaticByteBuffer kAttributeValue(0x00, 0x00);
+
+UUID CharacteristicType(size_t service, size_t characteristic) {
+  return UUID(static_cast<uint16_t>(
+      0x8000 + service * kCharacteristicsPerService + characteristic));
+}
+
+std::unique_ptr<Database> MakeDatabase(size_t service_count) {
+  auto db = std::make_unique<Database>();
+  for (size_t i = 0; i < service_count; ++i) {
+    AttributeGrouping* grouping = db->NewGrouping(
+        kPrimaryService, kAttributesPerService - 1, kServiceValue);
+    BT_ASSERT(grouping);
+    for (size_t j = 0; j < kCharacteristicsPerService; ++j) {
+      grouping->AddAttribute(kCharacteristic)->SetValue(kAttributeValue);
+      grouping->AddAttribute(CharacteristicType(i, j))
+          ->SetValue(kAttributeValue);
+      grouping->AddAttribute(kClientConfig)->SetValue(kAttributeValue);
+    }
+    grouping->set_active(true);
+  }
+  return db;
+}
+
+// Returns the first handle of the service in the middle of the database.
+Handle MiddleService(size_t service_count) {
+  return static_cast<Handle>(kHandleMin +
+                             service_count / 2 * kAttributesPerService);
+}
+
+// Visits at most |limit| attributes, as a request handler does to fill a PDU.
+size_t Visit(Database::Iterator iter, size_t limit) {
+  size_t count = 0;
+  for (; !iter.AtEnd() && count < limit; iter.Advance()) {
+    BT_ASSERT(iter.get());
+    count++;
+  }
+  return count;
+}
+
+// Read Request: finds one attribute by handle.
+void ReadRequest(pw::perf_test::State& state, size_t service_count) {
+  std::unique_ptr<Database> db = MakeDatabase(service_count);
+  const Handle handle = MiddleService(service_count) + 2;
+  while (state.KeepRunning()) {
+    BT_ASSERT(db->FindAttribute(handle));
+  }
+}
+
+// Read By Type Request for a characteristic value with a unique type, over the
+// whole handle range, as a client does to read a characteristic by UUID.
+void ReadByTypeRequest(pw::perf_test::State& state, size_t service_count) {
+  std::unique_ptr<Database> db = MakeDatabase(service_count);
+  const UUID type = CharacteristicType(service_count - 1, 1);
+  while (state.KeepRunning()) {
+    BT_ASSERT(Visit(db->GetIterator(kHandleMin, kHandleMax, &type), 4) == 1);
+  }
+}
+
+// Read By Group Type Request for primary services, as a client does to
+// discover services.
+void ReadByGroupTypeRequest(pw::perf_test::State& state,
+                            size_t service_count) {
+  std::unique_ptr<Database> db = MakeDatabase(service_count);
+  const Handle start = MiddleService(service_count);
+  while (state.KeepRunning()) {
+    BT_ASSERT(Visit(db->GetIterator(start,
+                                    kHandleMax,
+                                    &kPrimaryService,
+                                    /*groups_only=*/true),
+                    4) > 0);
+  }
+}
+
+// Find Information Request for the descriptors of a characteristic.
+void FindInformationRequest(pw::perf_test::State& state,
+                            size_t service_count) {
+  std::unique_ptr<Database> db = MakeDatabase(service_count);
+  const Handle start = MiddleService(service_count) + 3;
+  while (state.KeepRunning()) {
+    BT_ASSERT(Visit(db->GetIterator(start, kHandleMax), 5) == 5);
+  }
+}
+
+PW_PERF_TEST(ReadRequest8Services, ReadRequest, 8);
+PW_PERF_TEST(ReadRequest64Services, ReadRequest, 64);
+PW_PERF_TEST(ReadRequest512Services, ReadRequest, 512);
+
+PW_PERF_TEST(ReadByTypeRequest8Services, ReadByTypeRequest, 8);
+PW_PERF_TEST(ReadByTypeRequest64Services, ReadByTypeRequest, 64);
+PW_PERF_TEST(ReadByTypeRequest512Services, ReadByTypeRequest, 512);
+
+PW_PERF_TEST(ReadByGroupTypeRequest8Services, ReadByGroupTypeRequest, 8);
+PW_PERF_TEST(ReadByGroupTypeRequest64Services, ReadByGroupTypeRequest, 64);
+PW_PERF_TEST(ReadByGroupTypeRequest512Services, ReadByGroupTypeRequest, 512);
+
+PW_PERF_TEST(FindInformationRequest8Services, FindInformationRequest, 8);
+PW_PERF_TEST(FindInformationRequest64Services, FindInformationRequest, 64);
+PW_PERF_TEST(FindInformationRequest512Services, FindInformationRequest, 512);
+
+}  // namespace
+}  // namespace bt::att
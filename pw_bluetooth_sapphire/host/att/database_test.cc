@@ -540,6 +540,56 @@ TEST_F(DatabaseIteratorManyTest, Range) {
   }
 }
 
+TEST_F(DatabaseIteratorManyTest, RangeWithFilter) {
+  auto iter = db()->GetIterator(2, 6, &kTestType1);
+  auto handles = IterHandles(&iter);
+  EXPECT_EQ(std::vector<Handle>({4, 6}), handles);
+
+  iter = db()->GetIterator(5, 9, &kTestType2);
+  handles = IterHandles(&iter);
+  EXPECT_EQ(std::vector<Handle>({5, 7}), handles);
+
+  iter = db()->GetIterator(2, 10, &kTestType1, /*groups_only=*/true);
+  handles = IterHandles(&iter);
+  EXPECT_EQ(std::vector<Handle>({10}), handles);
+}
+
+TEST_F(DatabaseIteratorManyTest, FilterAfterGroupingsChange) {
+  auto iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType2);
+  EXPECT_EQ(std::vector<Handle>({2, 3, 5, 7}), IterHandles(&iter));
+
+  EXPECT_TRUE(db()->RemoveGrouping(5));
+  iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType2);
+  EXPECT_EQ(std::vector<Handle>({2, 3}), IterHandles(&iter));
+
+  auto grp = db()->NewGrouping(kTestType2, 2, kTestValue1);  // 5
+  grp->AddAttribute(kTestType3);                             // 6
+  grp->AddAttribute(kTestType2);                             // 7
+  iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType2);
+  EXPECT_EQ(std::vector<Handle>({2, 3}), IterHandles(&iter));
+
+  grp->set_active(true);
+  iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType2);
+  EXPECT_EQ(std::vector<Handle>({2, 3, 5, 7}), IterHandles(&iter));
+  iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType3);
+  EXPECT_EQ(std::vector<Handle>({6}), IterHandles(&iter));
+}
+
+TEST_F(DatabaseIteratorManyTest, FilterWithIncompleteGrouping) {
+  EXPECT_TRUE(db()->RemoveGrouping(5));
+
+  // Attributes of incomplete groupings are never visited.
+  auto grp = db()->NewGrouping(kTestType2, 2, kTestValue1);  // 5
+  grp->AddAttribute(kTestType1);                             // 6
+  auto iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType1);
+  EXPECT_EQ(std::vector<Handle>({1, 4, 10}), IterHandles(&iter));
+
+  grp->AddAttribute(kTestType1);  // 7
+  grp->set_active(true);
+  iter = db()->GetIterator(kTestRangeStart, kTestRangeEnd, &kTestType1);
+  EXPECT_EQ(std::vector<Handle>({1, 4, 6, 7, 10}), IterHandles(&iter));
+}
+
 class DatabaseExecuteWriteQueueTest : public ::testing::Test {
  public:
   DatabaseExecuteWriteQueueTest() = default;
@@ -15,6 +15,8 @@
 #pragma once
 #include <list>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "pw_bluetooth_sapphire/internal/host/att/att.h"
 #include "pw_bluetooth_sapphire/internal/host/att/attribute.h"
@@ -37,6 +39,13 @@ namespace bt::att {
 class Database final : public WeakSelf<Database> {
   using GroupingList = std::list<AttributeGrouping>;
 
+  // An attribute in the type index and the grouping that contains it.
+  struct IndexedAttribute {
+    Handle handle;
+    GroupingList::iterator grouping;
+  };
+  using TypeIndex = std::unordered_map<UUID, std::vector<IndexedAttribute>>;
+
  public:
   // This type allows iteration over the attributes in a database. An iterator
   // is always initialzed with a handle range and options to skip attributes or
@@ -66,12 +75,16 @@ class Database final : public WeakSelf<Database> {
     inline void MarkEnd() { grp_iter_ = grp_end_; }
 
     friend class Database;
-    Iterator(GroupingList* list,
+    Iterator(Database* db,
              Handle start,
              Handle end,
              const UUID* type,
              bool groups_only);
 
+    // Moves to the first attribute at or after |type_entry_| that is in range
+    // and in an active grouping. Only used with a type index.
+    void SeekIndexed();
+
     Handle start_;
     Handle end_;
     bool grp_only_;
@@ -82,6 +95,11 @@ class Database final : public WeakSelf<Database> {
                       kHandleMax,
                   "attr_offset_ must be able to fit kMaxHandle!");
     std::optional<UUID> type_filter_;
+
+    // If set, the iterator visits these attributes of the filter type instead
+    // of every attribute in the range.
+    const std::vector<IndexedAttribute>* type_entries_ = nullptr;
+    size_t type_entry_ = 0u;
   };
 
   // Initializes this database to span the attribute handle range given by
@@ -164,6 +182,11 @@ class Database final : public WeakSelf<Database> {
                          WriteCallback callback);
 
  private:
+  // Returns the index of attributes by type, building it if needed. Returns
+  // nullptr if any grouping is incomplete, since attributes can still be added
+  // to it.
+  const TypeIndex* GetTypeIndex();
+
   Handle range_start_;
   Handle range_end_;
 
@@ -172,6 +195,16 @@ class Database final : public WeakSelf<Database> {
   // represent contiguous handle ranges as any grouping can be removed.
   GroupingList groupings_;
 
+  // The groupings in |groupings_|, in the same order. Unlike the list, this
+  // allows binary searches for a handle.
+  std::vector<GroupingList::iterator> grouping_index_;
+
+  // The attributes of each type, sorted by handle. ATT requests that search
+  // for a type, such as Read By Type, visit only the attributes of that type.
+  // Built on first use and cleared when a grouping is added or removed.
+  TypeIndex type_index_;
+  bool type_index_valid_ = false;
+
   BT_DISALLOW_COPY_AND_ASSIGN_ALLOW_MOVE(Database);
 };
 
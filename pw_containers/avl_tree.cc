@@ -0,0 +1,348 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/internal/avl_tree.h"
+
+#include "pw_assert/check.h"
+
+namespace pw::containers::internal {
+
+void AvlItem::unlist() {
+  if (!unlisted()) {
+    AvlTree::Erase(*this);
+  }
+}
+
+AvlItem* AvlItem::next() {
+  AvlItem* item = this;
+  if (item->right_ != nullptr) {
+    item = item->right_;
+    while (item->left_ != nullptr) {
+      item = item->left_;
+    }
+    return item;
+  }
+  // Climb until coming up from a left child. The root is the sentinel's left
+  // child, so the last item is followed by the sentinel.
+  while (item == item->parent_->right_) {
+    item = item->parent_;
+  }
+  return item->parent_;
+}
+
+AvlItem* AvlItem::previous() {
+  AvlItem* item = this;
+  if (item->left_ != nullptr) {
+    item = item->left_;
+    while (item->right_ != nullptr) {
+      item = item->right_;
+    }
+    return item;
+  }
+  while (item == item->parent_->left_) {
+    item = item->parent_;
+  }
+  return item->parent_;
+}
+
+void AvlItem::ReplaceChild(AvlItem* child, AvlItem* replacement) {
+  if (left_ == child) {
+    left_ = replacement;
+  } else {
+    right_ = replacement;
+  }
+}
+
+size_t AvlTree::size() const {
+  size_t total = 0;
+  for (const AvlItem* item = begin(); item != end(); item = item->next()) {
+    ++total;
+  }
+  return total;
+}
+
+AvlItem* AvlTree::begin() {
+  AvlItem* item = &sentinel_;
+  while (item->left_ != nullptr) {
+    item = item->left_;
+  }
+  return item;
+}
+
+void AvlTree::clear() {
+  // Unlist the items in post-order, so each item's children are unlisted
+  // before it.
+  AvlItem* item = root();
+  while (item != nullptr) {
+    if (item->left_ != nullptr) {
+      item = item->left_;
+    } else if (item->right_ != nullptr) {
+      item = item->right_;
+    } else {
+      AvlItem* parent = item->parent_;
+      parent->ReplaceChild(item, nullptr);
+      item->parent_ = nullptr;
+      item->balance_ = 0;
+      item = parent == &sentinel_ ? nullptr : parent;
+    }
+  }
+}
+
+void AvlTree::InsertAt(AvlItem& parent, bool left, AvlItem& item) {
+  PW_CHECK(item.unlisted(),
+           "Cannot add an item to a pw::IntrusiveMap or IntrusiveMultiMap that "
+           "is already in one");
+  item.parent_ = &parent;
+  item.left_ = nullptr;
+  item.right_ = nullptr;
+  item.balance_ = 0;
+  if (left) {
+    parent.left_ = &item;
+  } else {
+    parent.right_ = &item;
+  }
+
+  // Walk up the tree while subtrees grow taller, until one is rebalanced or
+  // its height does not change.
+  AvlItem* child = &item;
+  for (AvlItem* node = &parent; node != &sentinel_;
+       child = node, node = node->parent_) {
+    if (child == node->left_) {
+      if (node->balance_ > 0) {
+        node->balance_ = 0;
+        return;
+      }
+      if (node->balance_ == 0) {
+        node->balance_ = -1;
+        continue;
+      }
+      if (child->balance_ > 0) {
+        RotateLeftRight(*node);
+      } else {
+        RotateRight(*node);
+      }
+      return;
+    }
+
+    if (node->balance_ < 0) {
+      node->balance_ = 0;
+      return;
+    }
+    if (node->balance_ == 0) {
+      node->balance_ = 1;
+      continue;
+    }
+    if (child->balance_ < 0) {
+      RotateRightLeft(*node);
+    } else {
+      RotateLeft(*node);
+    }
+    return;
+  }
+}
+
+AvlItem* AvlTree::Erase(AvlItem& item) {
+  AvlItem* const next = item.next();
+  AvlItem* const parent = item.parent_;
+
+  // The subtree that shrank, given by its parent and side.
+  AvlItem* shrunk_parent;
+  bool shrunk_left;
+
+  if (item.left_ == nullptr || item.right_ == nullptr) {
+    // Replace the item with its only child, if any.
+    AvlItem* child = item.left_ != nullptr ? item.left_ : item.right_;
+    shrunk_parent = parent;
+    shrunk_left = parent->left_ == &item;
+    parent->ReplaceChild(&item, child);
+    if (child != nullptr) {
+      child->parent_ = parent;
+    }
+  } else {
+    // Replace the item with the next one, which is the leftmost item in its
+    // right subtree, and so has no left child.
+    AvlItem* const replacement = next;
+    if (replacement == item.right_) {
+      shrunk_parent = replacement;
+      shrunk_left = false;
+    } else {
+      shrunk_parent = replacement->parent_;
+      shrunk_left = true;
+      shrunk_parent->left_ = replacement->right_;
+      if (replacement->right_ != nullptr) {
+        replacement->right_->parent_ = shrunk_parent;
+      }
+      replacement->right_ = item.right_;
+      item.right_->parent_ = replacement;
+    }
+    replacement->left_ = item.left_;
+    item.left_->parent_ = replacement;
+    replacement->balance_ = item.balance_;
+    replacement->parent_ = parent;
+    parent->ReplaceChild(&item, replacement);
+  }
+
+  item.parent_ = nullptr;
+  item.left_ = nullptr;
+  item.right_ = nullptr;
+  item.balance_ = 0;
+
+  RebalanceAfterErase(shrunk_parent, shrunk_left);
+  return next;
+}
+
+void AvlTree::RebalanceAfterErase(AvlItem* node, bool left) {
+  // Walk up the tree while subtrees get shorter. The sentinel has no parent.
+  while (node->parent_ != nullptr) {
+    AvlItem* const parent = node->parent_;
+    const bool node_is_left = parent->left_ == node;
+
+    if (left) {
+      if (node->balance_ < 0) {
+        node->balance_ = 0;
+      } else if (node->balance_ == 0) {
+        node->balance_ = 1;
+        return;
+      } else {
+        const int8_t sibling_balance = node->right_->balance_;
+        if (sibling_balance < 0) {
+          RotateRightLeft(*node);
+        } else {
+          RotateLeft(*node);
+          if (sibling_balance == 0) {
+            return;  // The subtree's height did not change.
+          }
+        }
+      }
+    } else {
+      if (node->balance_ > 0) {
+        node->balance_ = 0;
+      } else if (node->balance_ == 0) {
+        node->balance_ = -1;
+        return;
+      } else {
+        const int8_t sibling_balance = node->left_->balance_;
+        if (sibling_balance > 0) {
+          RotateLeftRight(*node);
+        } else {
+          RotateRight(*node);
+          if (sibling_balance == 0) {
+            return;
+          }
+        }
+      }
+    }
+
+    node = parent;
+    left = node_is_left;
+  }
+}
+
+AvlItem* AvlTree::RotateLeft(AvlItem& item) {
+  AvlItem* const pivot = item.right_;
+  item.parent_->ReplaceChild(&item, pivot);
+  pivot->parent_ = item.parent_;
+
+  item.right_ = pivot->left_;
+  if (item.right_ != nullptr) {
+    item.right_->parent_ = &item;
+  }
+  pivot->left_ = &item;
+  item.parent_ = pivot;
+
+  // The pivot is balanced only while erasing, in which case the subtree keeps
+  // its height.
+  if (pivot->balance_ == 0) {
+    item.balance_ = 1;
+    pivot->balance_ = -1;
+  } else {
+    item.balance_ = 0;
+    pivot->balance_ = 0;
+  }
+  return pivot;
+}
+
+AvlItem* AvlTree::RotateRight(AvlItem& item) {
+  AvlItem* const pivot = item.left_;
+  item.parent_->ReplaceChild(&item, pivot);
+  pivot->parent_ = item.parent_;
+
+  item.left_ = pivot->right_;
+  if (item.left_ != nullptr) {
+    item.left_->parent_ = &item;
+  }
+  pivot->right_ = &item;
+  item.parent_ = pivot;
+
+  if (pivot->balance_ == 0) {
+    item.balance_ = -1;
+    pivot->balance_ = 1;
+  } else {
+    item.balance_ = 0;
+    pivot->balance_ = 0;
+  }
+  return pivot;
+}
+
+AvlItem* AvlTree::RotateRightLeft(AvlItem& item) {
+  AvlItem* const right = item.right_;
+  AvlItem* const pivot = right->left_;
+  item.parent_->ReplaceChild(&item, pivot);
+  pivot->parent_ = item.parent_;
+
+  right->left_ = pivot->right_;
+  if (right->left_ != nullptr) {
+    right->left_->parent_ = right;
+  }
+  item.right_ = pivot->left_;
+  if (item.right_ != nullptr) {
+    item.right_->parent_ = &item;
+  }
+  pivot->left_ = &item;
+  item.parent_ = pivot;
+  pivot->right_ = right;
+  right->parent_ = pivot;
+
+  item.balance_ = pivot->balance_ > 0 ? -1 : 0;
+  right->balance_ = pivot->balance_ < 0 ? 1 : 0;
+  pivot->balance_ = 0;
+  return pivot;
+}
+
+AvlItem* AvlTree::RotateLeftRight(AvlItem& item) {
+  AvlItem* const left = item.left_;
+  AvlItem* const pivot = left->right_;
+  item.parent_->ReplaceChild(&item, pivot);
+  pivot->parent_ = item.parent_;
+
+  left->right_ = pivot->left_;
+  if (left->right_ != nullptr) {
+    left->right_->parent_ = left;
+  }
+  item.left_ = pivot->right_;
+  if (item.left_ != nullptr) {
+    item.left_->parent_ = &item;
+  }
+  pivot->right_ = &item;
+  item.parent_ = pivot;
+  pivot->left_ = left;
+  left->parent_ = pivot;
+
+  item.balance_ = pivot->balance_ < 0 ? 1 : 0;
+  left->balance_ = pivot->balance_ > 0 ? -1 : 0;
+  pivot->balance_ = 0;
+  return pivot;
+}
+
+}  // namespace pw::containers::internal
@@ -0,0 +1,130 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares looking up every key of a ConstHashMap and a FlatMap, both
+// constructed at compile time, for integer and string keys.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pw_containers/const_hash_map.h"
+#include "pw_containers/flat_map.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw::containers {
+namespace {
+
+volatile uint32_t sum_of_values;
+
+template <size_t kSize>
+constexpr std::array<Pair<uint32_t, uint32_t>, kSize> IntPairs() {
+  std::array<Pair<uint32_t, uint32_t>, kSize> pairs{};
+  for (size_t i = 0; i < kSize; ++i) {
+    pairs[i] = {static_cast<uint32_t>(i + 1) * 2654435761u,
+                static_cast<uint32_t>(i)};
+  }
+  return pairs;
+}
+
+// Names of the form "sensor_channel_NNN", like generated table keys that share
+// a long prefix.
+template <size_t kSize>
+constexpr std::array<std::array<char, 18>, kSize> Names() {
+  std::array<std::array<char, 18>, kSize> names{};
+  for (size_t i = 0; i < kSize; ++i) {
+    constexpr std::string_view kPrefix = "sensor_channel_";
+    for (size_t c = 0; c < kPrefix.size(); ++c) {
+      names[i][c] = kPrefix[c];
+    }
+    names[i][15] = static_cast<char>('0' + i / 100 % 10);
+    names[i][16] = static_cast<char>('0' + i / 10 % 10);
+    names[i][17] = static_cast<char>('0' + i % 10);
+  }
+  return names;
+}
+
+template <size_t kSize>
+inline constexpr auto kNames = Names<kSize>();
+
+template <size_t kSize>
+constexpr std::array<Pair<std::string_view, uint32_t>, kSize> StringPairs() {
+  std::array<Pair<std::string_view, uint32_t>, kSize> pairs{};
+  for (size_t i = 0; i < kSize; ++i) {
+    pairs[i] = {std::string_view(kNames<kSize>[i].data(), 18),
+                static_cast<uint32_t>(i)};
+  }
+  return pairs;
+}
+
+template <typename Map, typename Pairs>
+void LookUpAll(perf_test::State& state, const Map& map, const Pairs& pairs) {
+  while (state.KeepRunning()) {
+    uint32_t sum = 0;
+    for (const auto& pair : pairs) {
+      sum += map.find(pair.first)->second;
+    }
+    sum_of_values = sum;
+  }
+}
+
+template <size_t kSize>
+void ConstHashMapIntLookup(perf_test::State& state) {
+  static constexpr auto kPairs = IntPairs<kSize>();
+  static constexpr ConstHashMap<uint32_t, uint32_t, kSize> kMap(kPairs);
+  LookUpAll(state, kMap, kPairs);
+}
+
+template <size_t kSize>
+void FlatMapIntLookup(perf_test::State& state) {
+  static constexpr auto kPairs = IntPairs<kSize>();
+  static constexpr FlatMap<uint32_t, uint32_t, kSize> kMap(kPairs);
+  LookUpAll(state, kMap, kPairs);
+}
+
+template <size_t kSize>
+void ConstHashMapStringLookup(perf_test::State& state) {
+  static constexpr auto kPairs = StringPairs<kSize>();
+  static constexpr ConstHashMap<std::string_view, uint32_t, kSize> kMap(kPairs);
+  LookUpAll(state, kMap, kPairs);
+}
+
+template <size_t kSize>
+void FlatMapStringLookup(perf_test::State& state) {
+  static constexpr auto kPairs = StringPairs<kSize>();
+  static constexpr FlatMap<std::string_view, uint32_t, kSize> kMap(kPairs);
+  LookUpAll(state, kMap, kPairs);
+}
+
+PW_PERF_TEST(ConstHashMapIntLookup8, ConstHashMapIntLookup<8>);
+PW_PERF_TEST(FlatMapIntLookup8, FlatMapIntLookup<8>);
+
+PW_PERF_TEST(ConstHashMapIntLookup32, ConstHashMapIntLookup<32>);
+PW_PERF_TEST(FlatMapIntLookup32, FlatMapIntLookup<32>);
+
+PW_PERF_TEST(ConstHashMapIntLookup128, ConstHashMapIntLookup<128>);
+PW_PERF_TEST(FlatMapIntLookup128, FlatMapIntLookup<128>);
+
+PW_PERF_TEST(ConstHashMapStringLookup8, ConstHashMapStringLookup<8>);
+PW_PERF_TEST(FlatMapStringLookup8, FlatMapStringLookup<8>);
+
+PW_PERF_TEST(ConstHashMapStringLookup32, ConstHashMapStringLookup<32>);
+PW_PERF_TEST(FlatMapStringLookup32, FlatMapStringLookup<32>);
+
+PW_PERF_TEST(ConstHashMapStringLookup128, ConstHashMapStringLookup<128>);
+PW_PERF_TEST(FlatMapStringLookup128, FlatMapStringLookup<128>);
+
+}  // namespace
+}  // namespace pw::containers
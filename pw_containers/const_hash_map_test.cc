@@ -0,0 +1,163 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/const_hash_map.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw::containers {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+enum class Opcode : uint8_t {
+  kRead = 0x0a,
+  kWrite = 0x12,
+  kNotify = 0x1b,
+  kIndicate = 0x1d,
+};
+
+constexpr ConstHashMap kOpcodes = {
+    Pair<Opcode, std::string_view>{Opcode::kRead, "read"},
+    Pair<Opcode, std::string_view>{Opcode::kWrite, "write"},
+    Pair<Opcode, std::string_view>{Opcode::kNotify, "notify"},
+    Pair<Opcode, std::string_view>{Opcode::kIndicate, "indicate"},
+};
+
+// Lookups work at compile time.
+static_assert(kOpcodes.size() == 4);
+static_assert(kOpcodes.at(Opcode::kNotify) == "notify"sv);
+static_assert(kOpcodes.contains(Opcode::kWrite));
+static_assert(!kOpcodes.contains(static_cast<Opcode>(0)));
+
+// Checks that every pair can be found and that every key appears once.
+template <typename Map, typename Pairs>
+void ExpectAllFound(const Map& map, const Pairs& pairs) {
+  ASSERT_EQ(map.size(), pairs.size());
+  for (const auto& pair : pairs) {
+    auto it = map.find(pair.first);
+    ASSERT_NE(it, map.end());
+    EXPECT_EQ(it->first, pair.first);
+    EXPECT_EQ(it->second, pair.second);
+    EXPECT_EQ(map.count(pair.first), 1u);
+  }
+}
+
+TEST(ConstHashMap, Empty) {
+  constexpr ConstHashMap<int, int, 0> map(std::array<Pair<int, int>, 0>{});
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_EQ(map.find(1), map.end());
+  EXPECT_FALSE(map.contains(0));
+}
+
+TEST(ConstHashMap, OneItem) {
+  constexpr ConstHashMap map = {Pair<int, char>{7, 'a'}};
+  EXPECT_EQ(map.at(7), 'a');
+  EXPECT_FALSE(map.contains(8));
+  EXPECT_EQ(map.count(8), 0u);
+}
+
+TEST(ConstHashMap, EnumKeys) {
+  EXPECT_EQ(kOpcodes.at(Opcode::kRead), "read"sv);
+  EXPECT_EQ(kOpcodes.at(Opcode::kIndicate), "indicate"sv);
+  EXPECT_EQ(kOpcodes.find(static_cast<Opcode>(0x0b)), kOpcodes.end());
+}
+
+TEST(ConstHashMap, StringKeys) {
+  constexpr std::array<Pair<std::string_view, int>, 5> kPairs = {{
+      {"", 0},
+      {"a", 1},
+      {"ab", 2},
+      {"ba", 3},
+      {"temperature", 4},
+  }};
+  constexpr ConstHashMap map(kPairs);
+  ExpectAllFound(map, kPairs);
+  EXPECT_FALSE(map.contains("b"));
+  EXPECT_FALSE(map.contains("abc"));
+  EXPECT_FALSE(map.contains("temperatur"));
+}
+
+TEST(ConstHashMap, SignedAndExtremeKeys) {
+  constexpr std::array<Pair<int64_t, int>, 5> kPairs = {{
+      {std::numeric_limits<int64_t>::min(), 0},
+      {-1, 1},
+      {0, 2},
+      {1, 3},
+      {std::numeric_limits<int64_t>::max(), 4},
+  }};
+  constexpr ConstHashMap map(kPairs);
+  ExpectAllFound(map, kPairs);
+  EXPECT_FALSE(map.contains(-2));
+  EXPECT_FALSE(map.contains(2));
+}
+
+TEST(ConstHashMap, Iterate_VisitsEachItemOnce) {
+  int visited[4] = {};
+  for (const auto& [opcode, name] : kOpcodes) {
+    EXPECT_EQ(kOpcodes.at(opcode), name);
+    switch (opcode) {
+      case Opcode::kRead:
+        ++visited[0];
+        break;
+      case Opcode::kWrite:
+        ++visited[1];
+        break;
+      case Opcode::kNotify:
+        ++visited[2];
+        break;
+      case Opcode::kIndicate:
+        ++visited[3];
+        break;
+    }
+  }
+  for (int count : visited) {
+    EXPECT_EQ(count, 1);
+  }
+}
+
+template <size_t kSize>
+constexpr std::array<Pair<uint32_t, uint32_t>, kSize> SequentialPairs() {
+  std::array<Pair<uint32_t, uint32_t>, kSize> pairs{};
+  for (uint32_t i = 0; i < kSize; ++i) {
+    pairs[i] = {i * 4, i};
+  }
+  return pairs;
+}
+
+TEST(ConstHashMap, ManySequentialKeys) {
+  constexpr auto kPairs = SequentialPairs<300>();
+  constexpr ConstHashMap map(kPairs);
+  ExpectAllFound(map, kPairs);
+  for (uint32_t key = 1; key < 1200; key += 4) {
+    EXPECT_FALSE(map.contains(key));
+  }
+}
+
+TEST(ConstHashMap, ConstructAtRuntime) {
+  std::array<Pair<uint16_t, uint16_t>, 3> pairs = {{{1, 2}, {3, 4}, {5, 6}}};
+  const ConstHashMap map(pairs);
+  ExpectAllFound(map, pairs);
+}
+
+}  // namespace
+}  // namespace pw::containers
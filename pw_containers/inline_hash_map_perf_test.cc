@@ -0,0 +1,109 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares looking up every key of an InlineHashMap, a FlatMap, and an array
+// of pairs searched linearly, for maps of several sizes.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_containers/flat_map.h"
+#include "pw_containers/inline_hash_map.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw::containers {
+namespace {
+
+volatile uint32_t sum_of_values;
+
+// Keys spread over the 32-bit range, as IDs or addresses would be.
+constexpr uint32_t Key(size_t i) {
+  return static_cast<uint32_t>(i + 1) * 2654435761u;
+}
+
+template <size_t kSize>
+constexpr std::array<Pair<uint32_t, uint32_t>, kSize> Pairs() {
+  std::array<Pair<uint32_t, uint32_t>, kSize> pairs{};
+  for (size_t i = 0; i < kSize; ++i) {
+    pairs[i] = {Key(i), static_cast<uint32_t>(i)};
+  }
+  return pairs;
+}
+
+template <size_t kSize>
+void InlineHashMapLookup(perf_test::State& state) {
+  constexpr auto kPairs = Pairs<kSize>();
+  InlineHashMap<uint32_t, uint32_t, kSize> map;
+  for (const auto& pair : kPairs) {
+    map.try_emplace(pair.first, pair.second);
+  }
+  while (state.KeepRunning()) {
+    uint32_t sum = 0;
+    for (const auto& pair : kPairs) {
+      sum += map.find(pair.first)->second;
+    }
+    sum_of_values = sum;
+  }
+}
+
+template <size_t kSize>
+void FlatMapLookup(perf_test::State& state) {
+  constexpr auto kPairs = Pairs<kSize>();
+  static constexpr FlatMap<uint32_t, uint32_t, kSize> kMap(kPairs);
+  while (state.KeepRunning()) {
+    uint32_t sum = 0;
+    for (const auto& pair : kPairs) {
+      sum += kMap.find(pair.first)->second;
+    }
+    sum_of_values = sum;
+  }
+}
+
+template <size_t kSize>
+void LinearSearchLookup(perf_test::State& state) {
+  static constexpr auto kPairs = Pairs<kSize>();
+  while (state.KeepRunning()) {
+    uint32_t sum = 0;
+    for (const auto& pair : kPairs) {
+      sum += std::find_if(kPairs.begin(),
+                          kPairs.end(),
+                          [&pair](const auto& p) {
+                            return p.first == pair.first;
+                          })
+                 ->second;
+    }
+    sum_of_values = sum;
+  }
+}
+
+PW_PERF_TEST(InlineHashMapLookup8, InlineHashMapLookup<8>);
+PW_PERF_TEST(FlatMapLookup8, FlatMapLookup<8>);
+PW_PERF_TEST(LinearSearchLookup8, LinearSearchLookup<8>);
+
+PW_PERF_TEST(InlineHashMapLookup32, InlineHashMapLookup<32>);
+PW_PERF_TEST(FlatMapLookup32, FlatMapLookup<32>);
+PW_PERF_TEST(LinearSearchLookup32, LinearSearchLookup<32>);
+
+PW_PERF_TEST(InlineHashMapLookup128, InlineHashMapLookup<128>);
+PW_PERF_TEST(FlatMapLookup128, FlatMapLookup<128>);
+PW_PERF_TEST(LinearSearchLookup128, LinearSearchLookup<128>);
+
+PW_PERF_TEST(InlineHashMapLookup512, InlineHashMapLookup<512>);
+PW_PERF_TEST(FlatMapLookup512, FlatMapLookup<512>);
+PW_PERF_TEST(LinearSearchLookup512, LinearSearchLookup<512>);
+
+}  // namespace
+}  // namespace pw::containers
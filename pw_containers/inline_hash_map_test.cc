@@ -0,0 +1,278 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/inline_hash_map.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_containers_private/test_helpers.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw {
+namespace {
+
+using containers::test::Counter;
+
+// Maps every key to the same home slot, so all entries collide.
+struct ConstantHash {
+  size_t operator()(int) const { return 42; }
+};
+
+// Checks that the map holds exactly the keys in [0, count) with values
+// key * 10, by iterating and by looking up each key.
+template <typename Map>
+void ExpectKeys(const Map& map, int count) {
+  EXPECT_EQ(map.size(), static_cast<size_t>(count));
+
+  int visited = 0;
+  int key_sum = 0;
+  for (const auto& entry : map) {
+    EXPECT_EQ(entry.second, entry.first * 10);
+    visited += 1;
+    key_sum += entry.first;
+  }
+  EXPECT_EQ(visited, count);
+  EXPECT_EQ(key_sum, count * (count - 1) / 2);
+
+  for (int key = 0; key < count; ++key) {
+    ASSERT_TRUE(map.contains(key));
+    EXPECT_EQ(map.at(key), key * 10);
+  }
+  EXPECT_FALSE(map.contains(count));
+  EXPECT_EQ(map.find(-1), map.end());
+}
+
+TEST(InlineHashMap, Construct_Sized) {
+  InlineHashMap<int, int, 10> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.full());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.capacity(), 10u);
+  EXPECT_EQ(map.max_size(), 10u);
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(InlineHashMap, Construct_GenericSized) {
+  InlineHashMap<int, int, 10> sized_map = {{1, 10}, {2, 20}};
+  InlineHashMap<int, int>& map = sized_map;
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.capacity(), 10u);
+  EXPECT_EQ(map.at(2), 20);
+}
+
+TEST(InlineHashMap, Construct_InitializerListWithDuplicates) {
+  InlineHashMap<int, int, 4> map = {{1, 10}, {2, 20}, {1, 30}};
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.at(1), 10);
+}
+
+TEST(InlineHashMap, Insert_ExistingKeyIsNotReplaced) {
+  InlineHashMap<int, int, 4> map;
+  auto [first, inserted] = map.insert({1, 10});
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(first->second, 10);
+
+  auto [second, inserted_again] = map.insert({1, 20});
+  EXPECT_FALSE(inserted_again);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(map.at(1), 10);
+}
+
+TEST(InlineHashMap, Insert_Fill) {
+  InlineHashMap<int, int, 100> map;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(map.emplace(i, i * 10).second);
+  }
+  EXPECT_TRUE(map.full());
+  ExpectKeys(map, 100);
+
+  // Existing keys may still be looked up through insertion when full.
+  EXPECT_FALSE(map.try_emplace(50, 0).second);
+  EXPECT_EQ(map[99], 990);
+}
+
+TEST(InlineHashMap, Insert_Collisions) {
+  InlineHashMap<int, int, 20, ConstantHash> map;
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(map.try_emplace(i, i * 10).second);
+  }
+  ExpectKeys(map, 20);
+}
+
+TEST(InlineHashMap, OperatorBrackets) {
+  InlineHashMap<int, int, 4> map;
+  EXPECT_EQ(map[3], 0);
+  map[3] = 30;
+  map[4] += 40;
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.at(3), 30);
+  EXPECT_EQ(map.at(4), 40);
+}
+
+TEST(InlineHashMap, InsertOrAssign) {
+  InlineHashMap<int, int, 4> map;
+  EXPECT_TRUE(map.insert_or_assign(1, 10).second);
+  EXPECT_FALSE(map.insert_or_assign(1, 20).second);
+  EXPECT_EQ(map.at(1), 20);
+}
+
+TEST(InlineHashMap, TryEmplace_DoesNotConstructForExistingKey) {
+  Counter::Reset();
+  {
+    InlineHashMap<int, Counter, 4> map;
+    ASSERT_TRUE(map.try_emplace(1, 10).second);
+    EXPECT_EQ(Counter::created, 1);
+
+    EXPECT_FALSE(map.try_emplace(1, 20).second);
+    EXPECT_EQ(Counter::created, 1);
+    EXPECT_EQ(map.at(1).value, 10);
+  }
+  EXPECT_EQ(Counter::created, Counter::destroyed);
+}
+
+TEST(InlineHashMap, Erase_ByKey) {
+  InlineHashMap<int, int, 50> map;
+  for (int i = 0; i < 50; ++i) {
+    map.try_emplace(i, i * 10);
+  }
+  for (int i = 49; i >= 25; --i) {
+    EXPECT_EQ(map.erase(i), 1u);
+    EXPECT_EQ(map.erase(i), 0u);
+  }
+  ExpectKeys(map, 25);
+}
+
+TEST(InlineHashMap, Erase_Collisions) {
+  InlineHashMap<int, int, 20, ConstantHash> map;
+  for (int i = 0; i < 20; ++i) {
+    map.try_emplace(i, i * 10);
+  }
+
+  // Erasing from the front of the run shifts the other entries back.
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(map.erase(i), 1u);
+  }
+  EXPECT_EQ(map.size(), 10u);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(map.contains(i), i >= 10);
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(map.try_emplace(i, i * 10).second);
+  }
+  ExpectKeys(map, 20);
+}
+
+TEST(InlineHashMap, Erase_ByIterator) {
+  InlineHashMap<int, int, 40> map;
+  for (int i = 0; i < 40; ++i) {
+    map.try_emplace(i, i * 10);
+  }
+
+  for (auto it = map.begin(); it != map.end();) {
+    if (it->first % 2 == 1) {
+      it = map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(map.size(), 20u);
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_EQ(map.contains(i), i % 2 == 0);
+  }
+}
+
+TEST(InlineHashMap, RandomOperations) {
+  // Mirror the map's contents in a presence array through random inserts and
+  // erases, with keys that collide often.
+  constexpr size_t kKeys = 64;
+  std::array<bool, kKeys> present{};
+  InlineHashMap<size_t, size_t, 48> map;
+
+  uint32_t state = 1;
+  for (int i = 0; i < 5000; ++i) {
+    state = state * 1664525u + 1013904223u;
+    const size_t key = (state >> 16) % kKeys;
+    if ((state >> 8) % 3 == 0 || map.full()) {
+      EXPECT_EQ(map.erase(key), present[key] ? 1u : 0u);
+      present[key] = false;
+    } else {
+      EXPECT_EQ(map.try_emplace(key, key * 10).second, !present[key]);
+      present[key] = true;
+    }
+
+    size_t count = 0;
+    for (size_t k = 0; k < kKeys; ++k) {
+      ASSERT_EQ(map.contains(k), present[k]);
+      count += present[k] ? 1u : 0u;
+    }
+    ASSERT_EQ(map.size(), count);
+  }
+}
+
+TEST(InlineHashMap, Clear) {
+  InlineHashMap<int, int, 8> map = {{1, 10}, {2, 20}, {3, 30}};
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_FALSE(map.contains(1));
+}
+
+TEST(InlineHashMap, Copy) {
+  InlineHashMap<int, int, 8> map = {{0, 0}, {1, 10}, {2, 20}};
+  InlineHashMap<int, int, 8> copy(map);
+  ExpectKeys(copy, 3);
+  ExpectKeys(map, 3);
+
+  InlineHashMap<int, int, 16> other = {{5, 50}};
+  static_cast<InlineHashMap<int, int>&>(other) = map;
+  ExpectKeys(other, 3);
+}
+
+TEST(InlineHashMap, Move) {
+  InlineHashMap<int, int, 8> map = {{0, 0}, {1, 10}, {2, 20}};
+  InlineHashMap<int, int, 8> moved(std::move(map));
+  ExpectKeys(moved, 3);
+  EXPECT_TRUE(map.empty());  // NOLINT(bugprone-use-after-move)
+}
+
+TEST(InlineHashMap, Destructor_DestroysValues) {
+  Counter::Reset();
+  {
+    InlineHashMap<int, Counter, 16> map;
+    for (int i = 0; i < 16; ++i) {
+      map.try_emplace(i, i);
+    }
+    for (int i = 0; i < 16; i += 2) {
+      map.erase(i);
+    }
+  }
+  EXPECT_EQ(Counter::created, 16);
+  EXPECT_EQ(Counter::created + Counter::moved, Counter::destroyed);
+}
+
+TEST(InlineHashMap, ConstIterator) {
+  InlineHashMap<int, int, 4> map = {{1, 10}};
+  InlineHashMap<int, int, 4>::const_iterator it = map.find(1);
+  ASSERT_NE(it, map.cend());
+  EXPECT_EQ(it->second, 10);
+
+  map.find(1)->second = 20;
+  EXPECT_EQ(it->second, 20);
+}
+
+}  // namespace
+}  // namespace pw
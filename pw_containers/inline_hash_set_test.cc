@@ -0,0 +1,152 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/inline_hash_set.h"
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+// Maps every key to the same home slot, so all entries collide.
+template <size_t kHash>
+struct ConstantHash {
+  size_t operator()(int) const { return kHash; }
+};
+
+// Erases the keys in `erase_mask` while iterating over a set with keys 0-3
+// that all collide. Checks that every key is visited exactly once.
+template <size_t kHash>
+void EraseWhileIterating(unsigned erase_mask) {
+  InlineHashSet<int, 4, ConstantHash<kHash>> set = {0, 1, 2, 3};
+
+  std::array<int, 4> visits = {};
+  for (auto it = set.begin(); it != set.end();) {
+    const int key = *it;
+    visits[static_cast<size_t>(key)] += 1;
+    if ((erase_mask & (1u << key)) != 0u) {
+      it = set.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (int key = 0; key < 4; ++key) {
+    EXPECT_EQ(visits[static_cast<size_t>(key)], 1) << "key " << key;
+    EXPECT_EQ(set.contains(key), (erase_mask & (1u << key)) == 0u);
+  }
+}
+
+TEST(InlineHashSet, Construct_Sized) {
+  InlineHashSet<int, 5> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.capacity(), 5u);
+  EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST(InlineHashSet, Construct_GenericSized) {
+  InlineHashSet<int, 5> sized_set = {1, 2, 3, 2};
+  InlineHashSet<int>& set = sized_set;
+  EXPECT_EQ(set.size(), 3u);
+  EXPECT_EQ(set.capacity(), 5u);
+  EXPECT_TRUE(set.contains(2));
+}
+
+TEST(InlineHashSet, Iterator_IsConst) {
+  using Set = InlineHashSet<int, 4>;
+  static_assert(std::is_same_v<Set::iterator, Set::const_iterator>);
+  static_assert(std::is_same_v<decltype(*Set().begin()), const int&>);
+}
+
+TEST(InlineHashSet, InsertAndErase) {
+  InlineHashSet<std::string_view, 8> set;
+  EXPECT_TRUE(set.insert("alpha"sv).second);
+  EXPECT_TRUE(set.emplace("beta").second);
+  EXPECT_FALSE(set.insert("alpha"sv).second);
+  EXPECT_EQ(set.size(), 2u);
+  EXPECT_EQ(set.count("beta"sv), 1u);
+  EXPECT_EQ(*set.find("alpha"sv), "alpha"sv);
+
+  EXPECT_EQ(set.erase("alpha"sv), 1u);
+  EXPECT_FALSE(set.contains("alpha"sv));
+  EXPECT_TRUE(set.contains("beta"sv));
+}
+
+TEST(InlineHashSet, Erase_ByIteratorVisitsEachEntryOnce) {
+  // The home slots of these hashes cover all 5 slots of the set, so the runs
+  // of colliding entries wrap around from the last slot to the first.
+  for (unsigned mask = 0; mask < 16u; ++mask) {
+    EraseWhileIterating<0>(mask);
+    EraseWhileIterating<1>(mask);
+    EraseWhileIterating<2>(mask);
+    EraseWhileIterating<3>(mask);
+    EraseWhileIterating<4>(mask);
+    EraseWhileIterating<5>(mask);
+    EraseWhileIterating<6>(mask);
+  }
+}
+
+TEST(InlineHashSet, Erase_WrappedRunEndsAtEnd) {
+  // Both entries collide in the last slot, so the second one wraps around to
+  // the first slot and is visited first. Erasing the first entry moves it
+  // back to the last slot, after the erased position.
+  InlineHashSet<int, 4, ConstantHash<3>> set = {1, 2};
+  auto it = set.begin();
+  ASSERT_EQ(*it, 2);
+  ++it;
+  ASSERT_EQ(*it, 1);
+  EXPECT_EQ(set.erase(it), set.end());
+  EXPECT_EQ(set.size(), 1u);
+  EXPECT_TRUE(set.contains(2));
+}
+
+TEST(InlineHashSet, Fill) {
+  InlineHashSet<unsigned, 200> set;
+  for (unsigned i = 0; i < 200; ++i) {
+    ASSERT_TRUE(set.insert(i * 7919u).second);
+  }
+  EXPECT_TRUE(set.full());
+
+  unsigned sum = 0;
+  for (unsigned key : set) {
+    sum += key / 7919u;
+  }
+  EXPECT_EQ(sum, 199u * 200u / 2u);
+
+  for (unsigned i = 0; i < 200; ++i) {
+    EXPECT_TRUE(set.contains(i * 7919u));
+    EXPECT_FALSE(set.contains(i * 7919u + 1));
+  }
+}
+
+TEST(InlineHashSet, CopyAndMove) {
+  InlineHashSet<int, 4> set = {1, 2};
+  InlineHashSet<int, 4> copy = set;
+  EXPECT_EQ(copy.size(), 2u);
+  EXPECT_TRUE(copy.contains(1));
+
+  InlineHashSet<int, 4> moved = std::move(set);
+  EXPECT_EQ(moved.size(), 2u);
+  EXPECT_TRUE(moved.contains(2));
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,108 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares inserting items in scrambled key order into an IntrusiveMultiMap
+// and into an IntrusiveList kept sorted by walking to each insertion point,
+// for several numbers of items.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_containers/intrusive_list.h"
+#include "pw_containers/intrusive_multimap.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw::containers {
+namespace {
+
+volatile uint32_t first_key;
+
+// Keys spread over the 32-bit range, in no particular order.
+constexpr uint32_t Key(size_t i) {
+  return static_cast<uint32_t>(i + 1) * 2654435761u;
+}
+
+class MapItem : public IntrusiveMultiMap<uint32_t, MapItem>::Item {
+ public:
+  uint32_t key() const { return key_; }
+  void set_key(uint32_t key) { key_ = key; }
+
+ private:
+  uint32_t key_ = 0;
+};
+
+class ListItem : public IntrusiveList<ListItem>::Item {
+ public:
+  uint32_t key() const { return key_; }
+  void set_key(uint32_t key) { key_ = key; }
+
+ private:
+  uint32_t key_ = 0;
+};
+
+template <typename Item, size_t kSize>
+std::array<Item, kSize>& Items() {
+  static std::array<Item, kSize> items;
+  for (size_t i = 0; i < kSize; ++i) {
+    items[i].set_key(Key(i));
+  }
+  return items;
+}
+
+template <size_t kSize>
+void IntrusiveMultiMapInsert(perf_test::State& state) {
+  auto& items = Items<MapItem, kSize>();
+  IntrusiveMultiMap<uint32_t, MapItem> map;
+  while (state.KeepRunning()) {
+    for (MapItem& item : items) {
+      map.insert(item);
+    }
+    first_key = map.begin()->key();
+    map.clear();
+  }
+}
+
+template <size_t kSize>
+void SortedIntrusiveListInsert(perf_test::State& state) {
+  auto& items = Items<ListItem, kSize>();
+  IntrusiveList<ListItem> list;
+  while (state.KeepRunning()) {
+    for (ListItem& item : items) {
+      auto prev = list.before_begin();
+      for (auto it = list.begin(); it != list.end() && it->key() < item.key();
+           ++it) {
+        prev = it;
+      }
+      list.insert_after(prev, item);
+    }
+    first_key = list.front().key();
+    list.clear();
+  }
+}
+
+PW_PERF_TEST(IntrusiveMultiMapInsert8, IntrusiveMultiMapInsert<8>);
+PW_PERF_TEST(SortedIntrusiveListInsert8, SortedIntrusiveListInsert<8>);
+
+PW_PERF_TEST(IntrusiveMultiMapInsert32, IntrusiveMultiMapInsert<32>);
+PW_PERF_TEST(SortedIntrusiveListInsert32, SortedIntrusiveListInsert<32>);
+
+PW_PERF_TEST(IntrusiveMultiMapInsert128, IntrusiveMultiMapInsert<128>);
+PW_PERF_TEST(SortedIntrusiveListInsert128, SortedIntrusiveListInsert<128>);
+
+PW_PERF_TEST(IntrusiveMultiMapInsert512, IntrusiveMultiMapInsert<512>);
+PW_PERF_TEST(SortedIntrusiveListInsert512, SortedIntrusiveListInsert<512>);
+
+}  // namespace
+}  // namespace pw::containers
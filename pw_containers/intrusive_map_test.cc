@@ -0,0 +1,294 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_map.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw {
+namespace {
+
+class TestItem : public IntrusiveMap<int, TestItem>::Item {
+ public:
+  constexpr TestItem() = default;
+  constexpr TestItem(int key) : key_(key) {}
+
+  int key() const { return key_; }
+  void set_key(int key) { key_ = key; }
+
+ private:
+  int key_ = 0;
+};
+
+using Map = IntrusiveMap<int, TestItem>;
+
+// Checks that iterating over the map visits the items in key order, both
+// forward and in reverse.
+template <typename MapType, size_t kSize>
+void ExpectKeys(const MapType& map, const std::array<int, kSize>& keys) {
+  EXPECT_EQ(map.size(), kSize);
+  auto it = map.begin();
+  for (int key : keys) {
+    ASSERT_NE(it, map.end());
+    EXPECT_EQ(it->key(), key);
+    ++it;
+  }
+  EXPECT_EQ(it, map.end());
+
+  auto rit = map.rbegin();
+  for (size_t i = kSize; i > 0; --i) {
+    ASSERT_NE(rit, map.rend());
+    EXPECT_EQ(rit->key(), keys[i - 1]);
+    ++rit;
+  }
+  EXPECT_EQ(rit, map.rend());
+}
+
+TEST(IntrusiveMap, Construct_Empty) {
+  Map map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_EQ(map.rbegin(), map.rend());
+}
+
+TEST(IntrusiveMap, Construct_InitializerList) {
+  TestItem items[] = {{3}, {1}, {2}};
+  Map map({&items[0], &items[1], &items[2]});
+  ExpectKeys(map, std::array{1, 2, 3});
+}
+
+TEST(IntrusiveMap, Construct_ObjectIterator) {
+  std::array<TestItem, 4> items{{{40}, {10}, {30}, {20}}};
+  Map map(items.begin(), items.end());
+  ExpectKeys(map, std::array{10, 20, 30, 40});
+}
+
+TEST(IntrusiveMap, Insert_KeepsKeyOrder) {
+  std::array<TestItem, 7> items{{{5}, {2}, {8}, {1}, {9}, {3}, {7}}};
+  Map map;
+  for (TestItem& item : items) {
+    auto [it, inserted] = map.insert(item);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(&*it, &item);
+  }
+  ExpectKeys(map, std::array{1, 2, 3, 5, 7, 8, 9});
+}
+
+TEST(IntrusiveMap, Insert_DuplicateKey_NotAdded) {
+  TestItem first(1);
+  TestItem duplicate(1);
+  Map map({&first});
+
+  auto [it, inserted] = map.insert(duplicate);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(&*it, &first);
+  EXPECT_TRUE(duplicate.unlisted());
+  EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(IntrusiveMap, Insert_Ascending_StaysBalanced) {
+  std::array<TestItem, 64> items;
+  Map map;
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].set_key(static_cast<int>(i));
+    map.insert(items[i]);
+  }
+  EXPECT_EQ(map.size(), items.size());
+  int expected = 0;
+  for (const TestItem& item : map) {
+    EXPECT_EQ(item.key(), expected++);
+  }
+}
+
+TEST(IntrusiveMap, Find) {
+  std::array<TestItem, 3> items{{{10}, {20}, {30}}};
+  const Map map(items.begin(), items.end());
+
+  EXPECT_EQ(&*map.find(20), &items[1]);
+  EXPECT_EQ(map.find(25), map.end());
+  EXPECT_TRUE(map.contains(30));
+  EXPECT_FALSE(map.contains(0));
+  EXPECT_EQ(map.count(10), 1u);
+  EXPECT_EQ(map.count(15), 0u);
+}
+
+TEST(IntrusiveMap, Bounds) {
+  std::array<TestItem, 3> items{{{10}, {20}, {30}}};
+  Map map(items.begin(), items.end());
+
+  EXPECT_EQ(map.lower_bound(5)->key(), 10);
+  EXPECT_EQ(map.lower_bound(10)->key(), 10);
+  EXPECT_EQ(map.lower_bound(11)->key(), 20);
+  EXPECT_EQ(map.lower_bound(31), map.end());
+
+  EXPECT_EQ(map.upper_bound(5)->key(), 10);
+  EXPECT_EQ(map.upper_bound(10)->key(), 20);
+  EXPECT_EQ(map.upper_bound(30), map.end());
+
+  auto [first, last] = map.equal_range(20);
+  EXPECT_EQ(&*first, &items[1]);
+  EXPECT_EQ(&*last, &items[2]);
+}
+
+TEST(IntrusiveMap, CustomCompare) {
+  class Reversed : public IntrusiveMap<int, Reversed, std::greater<int>>::Item {
+   public:
+    constexpr Reversed(int key) : key_(key) {}
+    int key() const { return key_; }
+
+   private:
+    int key_;
+  };
+  std::array<Reversed, 3> items{{{2}, {3}, {1}}};
+  IntrusiveMap<int, Reversed, std::greater<int>> map(items.begin(),
+                                                     items.end());
+  ExpectKeys(map, std::array{3, 2, 1});
+  EXPECT_EQ(map.lower_bound(4)->key(), 3);
+}
+
+TEST(IntrusiveMap, Erase_Iterator) {
+  std::array<TestItem, 5> items{{{1}, {2}, {3}, {4}, {5}}};
+  Map map(items.begin(), items.end());
+
+  auto it = map.erase(map.find(3));
+  EXPECT_EQ(it->key(), 4);
+  EXPECT_TRUE(items[2].unlisted());
+  ExpectKeys(map, std::array{1, 2, 4, 5});
+
+  it = map.erase(map.find(5));
+  EXPECT_EQ(it, map.end());
+  ExpectKeys(map, std::array{1, 2, 4});
+}
+
+TEST(IntrusiveMap, Erase_Item) {
+  std::array<TestItem, 3> items{{{1}, {2}, {3}}};
+  Map map(items.begin(), items.end());
+
+  map.erase(items[0]);
+  EXPECT_TRUE(items[0].unlisted());
+  ExpectKeys(map, std::array{2, 3});
+}
+
+TEST(IntrusiveMap, Erase_Key) {
+  std::array<TestItem, 3> items{{{1}, {2}, {3}}};
+  Map map(items.begin(), items.end());
+
+  EXPECT_EQ(map.erase(2), 1u);
+  EXPECT_EQ(map.erase(2), 0u);
+  ExpectKeys(map, std::array{1, 3});
+}
+
+TEST(IntrusiveMap, Erase_All) {
+  std::array<TestItem, 16> items;
+  Map map;
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].set_key(static_cast<int>(i));
+    map.insert(items[i]);
+  }
+  for (auto it = map.begin(); it != map.end();) {
+    it = map.erase(it);
+  }
+  EXPECT_TRUE(map.empty());
+  for (const TestItem& item : items) {
+    EXPECT_TRUE(item.unlisted());
+  }
+}
+
+TEST(IntrusiveMap, Clear_UnlistsItems) {
+  std::array<TestItem, 8> items{{{1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}}};
+  Map map(items.begin(), items.end());
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  for (TestItem& item : items) {
+    EXPECT_TRUE(item.unlisted());
+  }
+
+  // The items can be added to another map.
+  Map other(items.begin(), items.end());
+  EXPECT_EQ(other.size(), items.size());
+}
+
+TEST(IntrusiveMap, ItemDestructor_RemovesFromMap) {
+  TestItem one(1);
+  Map map({&one});
+  {
+    TestItem two(2);
+    map.insert(two);
+    EXPECT_EQ(map.size(), 2u);
+  }
+  ExpectKeys(map, std::array{1});
+}
+
+TEST(IntrusiveMap, MapDestructor_UnlistsItems) {
+  TestItem one(1);
+  {
+    Map map({&one});
+    EXPECT_FALSE(one.unlisted());
+  }
+  EXPECT_TRUE(one.unlisted());
+}
+
+TEST(IntrusiveMap, Unlist_RemovesFromMap) {
+  std::array<TestItem, 3> items{{{1}, {2}, {3}}};
+  Map map(items.begin(), items.end());
+  items[1].unlist();
+  ExpectKeys(map, std::array{1, 3});
+}
+
+TEST(IntrusiveMap, InsertAndErase_MatchesReference) {
+  // Exercises rebalancing by inserting and erasing keys in a scrambled order,
+  // checking the map against a bitmap of the keys it should hold.
+  constexpr size_t kNumItems = 97;
+  std::array<TestItem, kNumItems> items;
+  std::array<bool, kNumItems> present{};
+  for (size_t i = 0; i < kNumItems; ++i) {
+    items[i].set_key(static_cast<int>(i));
+  }
+
+  Map map;
+  uint32_t state = 1;
+  for (int round = 0; round < 2000; ++round) {
+    state = state * 1664525u + 1013904223u;
+    const size_t index = (state >> 8) % kNumItems;
+    if (present[index]) {
+      map.erase(items[index]);
+    } else {
+      map.insert(items[index]);
+    }
+    present[index] = !present[index];
+
+    if (round % 100 != 0) {
+      continue;
+    }
+    auto it = map.begin();
+    for (size_t i = 0; i < kNumItems; ++i) {
+      EXPECT_EQ(items[i].unlisted(), !present[i]);
+      if (present[i]) {
+        ASSERT_NE(it, map.end());
+        EXPECT_EQ(&*it, &items[i]);
+        ++it;
+      }
+    }
+    EXPECT_EQ(it, map.end());
+  }
+}
+
+}  // namespace
+}  // namespace pw
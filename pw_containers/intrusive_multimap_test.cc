@@ -0,0 +1,113 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_multimap.h"
+
+#include <array>
+#include <cstddef>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw {
+namespace {
+
+class TestItem : public IntrusiveMultiMap<int, TestItem>::Item {
+ public:
+  constexpr TestItem(int key) : key_(key) {}
+
+  int key() const { return key_; }
+
+ private:
+  int key_;
+};
+
+using MultiMap = IntrusiveMultiMap<int, TestItem>;
+
+TEST(IntrusiveMultiMap, Construct_Empty) {
+  MultiMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST(IntrusiveMultiMap, Insert_EquivalentKeys_KeepsInsertionOrder) {
+  std::array<TestItem, 6> items{{{2}, {1}, {2}, {3}, {2}, {1}}};
+  MultiMap map;
+  for (TestItem& item : items) {
+    EXPECT_EQ(&*map.insert(item), &item);
+  }
+
+  std::array<const TestItem*, 6> expected{
+      &items[1], &items[5], &items[0], &items[2], &items[4], &items[3]};
+  auto it = map.begin();
+  for (const TestItem* item : expected) {
+    ASSERT_NE(it, map.end());
+    EXPECT_EQ(&*it, item);
+    ++it;
+  }
+  EXPECT_EQ(it, map.end());
+}
+
+TEST(IntrusiveMultiMap, CountAndEqualRange) {
+  std::array<TestItem, 5> items{{{1}, {2}, {2}, {2}, {3}}};
+  MultiMap map(items.begin(), items.end());
+
+  EXPECT_EQ(map.count(1), 1u);
+  EXPECT_EQ(map.count(2), 3u);
+  EXPECT_EQ(map.count(4), 0u);
+
+  auto [first, last] = map.equal_range(2);
+  EXPECT_EQ(&*first, &items[1]);
+  EXPECT_EQ(&*last, &items[4]);
+  EXPECT_EQ(&*map.find(2), &items[1]);
+}
+
+TEST(IntrusiveMultiMap, Erase_Key_RemovesAllEquivalent) {
+  std::array<TestItem, 5> items{{{1}, {2}, {2}, {2}, {3}}};
+  MultiMap map(items.begin(), items.end());
+
+  EXPECT_EQ(map.erase(2), 3u);
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_TRUE(items[1].unlisted());
+  EXPECT_TRUE(items[2].unlisted());
+  EXPECT_TRUE(items[3].unlisted());
+  EXPECT_FALSE(map.contains(2));
+}
+
+TEST(IntrusiveMultiMap, Erase_Item_LeavesOthersWithKey) {
+  std::array<TestItem, 3> items{{{7}, {7}, {7}}};
+  MultiMap map(items.begin(), items.end());
+
+  map.erase(items[1]);
+  EXPECT_EQ(map.count(7), 2u);
+  auto it = map.begin();
+  EXPECT_EQ(&*it++, &items[0]);
+  EXPECT_EQ(&*it++, &items[2]);
+  EXPECT_EQ(it, map.end());
+}
+
+TEST(IntrusiveMultiMap, ItemDestructor_RemovesFromMap) {
+  TestItem one(1);
+  MultiMap map({&one});
+  {
+    TestItem another_one(1);
+    map.insert(another_one);
+    EXPECT_EQ(map.count(1), 2u);
+  }
+  EXPECT_EQ(map.count(1), 1u);
+  EXPECT_EQ(&*map.begin(), &one);
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,278 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_containers/flat_map.h"
+
+namespace pw::containers {
+namespace internal {
+
+// Finalizer from MurmurHash3. Spreads every input bit across the result.
+constexpr uint64_t MixHash(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdu;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53u;
+  value ^= value >> 33;
+  return value;
+}
+
+// Hashes a ConstHashMap key. Integers and enums are mixed directly; strings
+// are hashed with FNV-1a and then mixed.
+template <typename Key>
+constexpr uint64_t ConstHashMapHash(const Key& key) {
+  if constexpr (std::is_same_v<Key, std::string_view>) {
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (char c : key) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 0x100000001b3u;
+    }
+    return MixHash(hash);
+  } else {
+    return MixHash(static_cast<uint64_t>(key));
+  }
+}
+
+}  // namespace internal
+
+/// `ConstHashMap` is a fixed associative array, like `FlatMap`, that is laid
+/// out by a perfect hash function found when the map is constructed. Looking up
+/// a key hashes it once and compares it against exactly one entry, instead of
+/// the O(log n) comparisons of `FlatMap`'s binary search.
+///
+/// The map is meant to be constructed `constexpr`, in which case the search for
+/// the hash function runs in the compiler and the map needs no initialization
+/// at runtime:
+///
+/// @code{.cpp}
+///   constexpr pw::containers::ConstHashMap kErrorNames = {
+///       Pair<int, std::string_view>{-1, "EPERM"},
+///       Pair<int, std::string_view>{-2, "ENOENT"},
+///       Pair<int, std::string_view>{-5, "EIO"},
+///   };
+///   static_assert(kErrorNames.at(-2) == "ENOENT");
+/// @endcode
+///
+/// Keys must be integers, enums, or `std::string_view`. Duplicate keys fail
+/// to compile when the map is constructed `constexpr`, and crash otherwise.
+///
+/// The hash function uses the "compress, hash, and displace" (CHD) scheme:
+/// keys are grouped into buckets by one hash, and each bucket stores a seed
+/// that moves its keys to unused entries. The map stores one `uint16_t` seed
+/// for every two entries in addition to the entries themselves. Entries are
+/// iterated in hash order, not key order.
+template <typename Key, typename Value, size_t kSize>
+class ConstHashMap {
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = Pair<key_type, mapped_type>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using container_type = typename std::array<value_type, kSize>;
+  using const_iterator = typename container_type::const_iterator;
+  using iterator = const_iterator;
+
+  static_assert(std::is_integral_v<Key> || std::is_enum_v<Key> ||
+                    std::is_same_v<Key, std::string_view>,
+                "ConstHashMap keys must be integers, enums, or "
+                "std::string_view");
+
+  constexpr ConstHashMap(const std::array<value_type, kSize>& items)
+      : items_(items), seeds_{} {
+    BuildHash();
+  }
+
+  // Omits explicit here to support assignment-like syntax, which is common to
+  // initialize a container.
+  template <typename... Items,
+            typename = std::enable_if_t<
+                std::conjunction_v<std::is_same<Items, value_type>...>>>
+  constexpr ConstHashMap(const Items&... items)
+      : ConstHashMap(std::array{items...}) {}
+
+  ConstHashMap(ConstHashMap&) = delete;
+  ConstHashMap& operator=(ConstHashMap&) = delete;
+
+  // Capacity.
+  constexpr size_type size() const { return kSize; }
+  constexpr bool empty() const { return kSize == 0; }
+  constexpr size_type max_size() const { return kSize; }
+
+  // Lookup.
+
+  /// Accesses a mapped value.
+  ///
+  /// @pre The key must exist.
+  constexpr const mapped_type& at(const key_type& key) const {
+    const_iterator it = find(key);
+    PW_ASSERT(it != end());
+    return it->second;
+  }
+
+  constexpr bool contains(const key_type& key) const {
+    return find(key) != end();
+  }
+
+  constexpr size_type count(const key_type& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  constexpr const_iterator find(const key_type& key) const {
+    if constexpr (kSize == 0) {
+      return end();
+    } else {
+      const uint64_t hash = internal::ConstHashMapHash(key);
+      const size_t index = Index(hash, seeds_[Bucket(hash)]);
+      if (items_[index].first != key) {
+        return end();
+      }
+      return begin() + static_cast<difference_type>(index);
+    }
+  }
+
+  // Iterators.
+  constexpr const_iterator begin() const { return cbegin(); }
+  constexpr const_iterator cbegin() const { return items_.cbegin(); }
+  constexpr const_iterator end() const { return cend(); }
+  constexpr const_iterator cend() const { return items_.cend(); }
+
+ private:
+  // Two keys per bucket on average keeps the seed search short even as the
+  // last buckets are placed into a nearly full table.
+  static constexpr size_t kBuckets = kSize < 2 ? 1 : kSize / 2;
+
+  static constexpr uint32_t kMaxSeed = UINT16_MAX;
+
+  static constexpr size_t Bucket(uint64_t hash) {
+    return static_cast<size_t>(((hash & UINT32_MAX) * kBuckets) >> 32);
+  }
+
+  static constexpr size_t Index(uint64_t hash, uint32_t seed) {
+    const uint64_t mixed =
+        internal::MixHash(hash + seed * uint64_t{0x9e3779b97f4a7c15});
+    return static_cast<size_t>(((mixed >> 32) * kSize) >> 32);
+  }
+
+  // Finds a seed for each bucket that sends its keys to unused entries, then
+  // moves each entry to its index. Buckets are placed from largest to
+  // smallest, since large buckets are hardest to place in a full table.
+  constexpr void BuildHash() {
+    if constexpr (kSize != 0) {
+      std::array<uint64_t, kSize> hashes{};
+      std::array<size_t, kBuckets + 1> bucket_starts{};
+      for (size_t i = 0; i < kSize; ++i) {
+        hashes[i] = internal::ConstHashMapHash(items_[i].first);
+        bucket_starts[Bucket(hashes[i]) + 1] += 1;
+      }
+
+      size_t largest_bucket = 0;
+      for (size_t b = 0; b < kBuckets; ++b) {
+        if (bucket_starts[b + 1] > largest_bucket) {
+          largest_bucket = bucket_starts[b + 1];
+        }
+        bucket_starts[b + 1] += bucket_starts[b];
+      }
+
+      // Sort the item indices by bucket.
+      std::array<size_t, kSize> members{};
+      std::array<size_t, kBuckets> filled{};
+      for (size_t i = 0; i < kSize; ++i) {
+        const size_t b = Bucket(hashes[i]);
+        members[bucket_starts[b] + filled[b]++] = i;
+      }
+
+      std::array<bool, kSize> used{};
+      std::array<size_t, kSize> indices{};
+      for (size_t bucket_size = largest_bucket; bucket_size > 0;
+           --bucket_size) {
+        for (size_t b = 0; b < kBuckets; ++b) {
+          if (bucket_starts[b + 1] - bucket_starts[b] == bucket_size) {
+            PlaceBucket(b,
+                        &members[bucket_starts[b]],
+                        bucket_size,
+                        hashes,
+                        used,
+                        indices);
+          }
+        }
+      }
+
+      // Apply the permutation by swapping each entry into its index.
+      for (size_t i = 0; i < kSize; ++i) {
+        while (indices[i] != i) {
+          const size_t target = indices[i];
+          value_type temp = std::move(items_[target]);
+          items_[target] = std::move(items_[i]);
+          items_[i] = std::move(temp);
+          indices[i] = indices[target];
+          indices[target] = target;
+        }
+      }
+    }
+  }
+
+  constexpr void PlaceBucket(size_t bucket,
+                             const size_t* members,
+                             size_t bucket_size,
+                             const std::array<uint64_t, kSize>& hashes,
+                             std::array<bool, kSize>& used,
+                             std::array<size_t, kSize>& indices) {
+    // Duplicate keys hash to the same bucket and index, so no seed would
+    // place them.
+    for (size_t i = 1; i < bucket_size; ++i) {
+      for (size_t j = 0; j < i; ++j) {
+        PW_ASSERT(items_[members[i]].first != items_[members[j]].first);
+      }
+    }
+
+    for (uint32_t seed = 0; seed <= kMaxSeed; ++seed) {
+      bool fits = true;
+      for (size_t i = 0; fits && i < bucket_size; ++i) {
+        const size_t index = Index(hashes[members[i]], seed);
+        fits = !used[index];
+        // Keys in the same bucket may not share an index either.
+        for (size_t j = 0; fits && j < i; ++j) {
+          fits = indices[members[j]] != index;
+        }
+        indices[members[i]] = index;
+      }
+      if (fits) {
+        for (size_t i = 0; i < bucket_size; ++i) {
+          used[indices[members[i]]] = true;
+        }
+        seeds_[bucket] = static_cast<uint16_t>(seed);
+        return;
+      }
+    }
+    PW_ASSERT(false);  // No seed places the bucket's keys.
+  }
+
+  std::array<value_type, kSize> items_;
+  std::array<uint16_t, kBuckets> seeds_;
+};
+
+template <typename K, typename V, typename... Items>
+ConstHashMap(const Pair<K, V>& item1, const Items&... items)
+    -> ConstHashMap<K, V, 1 + sizeof...(items)>;
+
+}  // namespace pw::containers
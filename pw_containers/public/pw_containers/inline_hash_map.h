@@ -0,0 +1,239 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_containers/flat_map.h"
+#include "pw_containers/internal/hash_table.h"
+#include "pw_containers/internal/raw_storage.h"
+
+namespace pw {
+namespace containers::internal {
+
+struct PairFirst {
+  template <typename Pair>
+  constexpr const auto& operator()(const Pair& pair) const {
+    return pair.first;
+  }
+};
+
+}  // namespace containers::internal
+
+/// The `InlineHashMap` class is similar to `std::unordered_map`, except it is
+/// backed by a fixed-size buffer. Entries are stored in an open-addressing
+/// hash table with Robin Hood linear probing, so lookups are O(1) on average
+/// and no memory is allocated.
+///
+/// `InlineHashMap`s must be declared with an explicit capacity (e.g.
+/// `InlineHashMap<int, int, 10>`), but they can be used and referred to
+/// without it (e.g. `InlineHashMap<int, int>`). As with `Vector`, all
+/// `InlineHashMap` classes derive from `InlineHashMap<Key, Value>`, which
+/// stores the capacity in a variable and implements every operation, so code
+/// size is shared across capacities.
+///
+/// The table has about 1/8 more slots than its capacity. Each slot holds a
+/// `Pair<const Key, Value>` and a 16-bit probe length. Entries are moved
+/// within the table as others are inserted and erased, so keys must be
+/// copy-constructible and values move-constructible. Inserting or erasing an
+/// entry invalidates iterators and references to all entries.
+///
+/// The hash and equality function objects are default-constructed when used.
+template <typename Key,
+          typename Value,
+          size_t kCapacity = containers::internal::kGenericSized,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class InlineHashMap
+    : public containers::internal::HashTableStorage<
+          InlineHashMap<Key,
+                        Value,
+                        containers::internal::kGenericSized,
+                        Hash,
+                        KeyEqual>,
+          kCapacity,
+          std::is_trivially_destructible_v<
+              containers::Pair<const Key, Value>>> {
+ private:
+  using Base = InlineHashMap<Key,
+                             Value,
+                             containers::internal::kGenericSized,
+                             Hash,
+                             KeyEqual>;
+
+ public:
+  using typename Base::const_iterator;
+  using typename Base::const_pointer;
+  using typename Base::const_reference;
+  using typename Base::difference_type;
+  using typename Base::hasher;
+  using typename Base::iterator;
+  using typename Base::key_equal;
+  using typename Base::key_type;
+  using typename Base::mapped_type;
+  using typename Base::pointer;
+  using typename Base::reference;
+  using typename Base::size_type;
+  using typename Base::value_type;
+
+  static_assert(kCapacity > 0u, "InlineHashMap capacity must be nonzero");
+
+  InlineHashMap() = default;
+
+  InlineHashMap(std::initializer_list<value_type> list) {
+    this->insert(list);
+  }
+
+  template <typename InputIterator,
+            typename = containers::internal::EnableIfInputIterator<
+                InputIterator>>
+  InlineHashMap(InputIterator first, InputIterator last) {
+    this->insert(first, last);
+  }
+
+  InlineHashMap(const InlineHashMap& other) { *this = other; }
+
+  InlineHashMap(InlineHashMap&& other) noexcept { *this = std::move(other); }
+
+  InlineHashMap& operator=(const InlineHashMap& other) {
+    Base::operator=(other);
+    return *this;
+  }
+
+  InlineHashMap& operator=(InlineHashMap&& other) noexcept {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+
+  InlineHashMap& operator=(std::initializer_list<value_type> list) {
+    Base::operator=(list);
+    return *this;
+  }
+};
+
+/// Defines the generic-capacity `InlineHashMap<Key, Value>` specialization,
+/// which serves as the base class for `InlineHashMap`s of any capacity. Except
+/// for constructors, all methods are implemented on this class and its base.
+///
+/// This size-polymorphic base class must not be used with `std::unique_ptr`
+/// or `delete`.
+template <typename Key, typename Value, typename Hash, typename KeyEqual>
+class InlineHashMap<Key,
+                    Value,
+                    containers::internal::kGenericSized,
+                    Hash,
+                    KeyEqual>
+    : public containers::internal::HashTable<
+          InlineHashMap<Key,
+                        Value,
+                        containers::internal::kGenericSized,
+                        Hash,
+                        KeyEqual>,
+          containers::Pair<const Key, Value>,
+          Key,
+          containers::internal::PairFirst,
+          Hash,
+          KeyEqual> {
+ private:
+  using Table =
+      containers::internal::HashTable<InlineHashMap,
+                                      containers::Pair<const Key, Value>,
+                                      Key,
+                                      containers::internal::PairFirst,
+                                      Hash,
+                                      KeyEqual>;
+
+ public:
+  using mapped_type = Value;
+  using typename Table::const_iterator;
+  using typename Table::iterator;
+  using typename Table::key_type;
+  using typename Table::value_type;
+
+  // An InlineHashMap without an explicit capacity cannot be constructed
+  // directly. Instead, construct an InlineHashMap<Key, Value, kCapacity>.
+  InlineHashMap() = delete;
+
+  InlineHashMap& operator=(const InlineHashMap& other) {
+    Table::Assign(other);
+    return *this;
+  }
+
+  InlineHashMap& operator=(InlineHashMap&& other) noexcept {
+    Table::MoveFrom(other);
+    return *this;
+  }
+
+  InlineHashMap& operator=(std::initializer_list<value_type> list) {
+    this->clear();
+    this->insert(list);
+    return *this;
+  }
+
+  // Access
+
+  /// Returns a reference to the value with the key. Crashes if there is none.
+  mapped_type& at(const key_type& key) {
+    iterator it = this->find(key);
+    PW_ASSERT(it != this->end());
+    return it->second;
+  }
+
+  const mapped_type& at(const key_type& key) const {
+    const_iterator it = this->find(key);
+    PW_ASSERT(it != this->end());
+    return it->second;
+  }
+
+  /// Returns a reference to the value with the key, inserting a
+  /// value-initialized value if there is none. Crashes if the key is new and
+  /// the map is full.
+  mapped_type& operator[](const key_type& key) {
+    return try_emplace(key).first->second;
+  }
+
+  // Modify
+
+  /// Inserts a value constructed from `args` if there is no entry with the
+  /// key. Unlike `emplace`, no value is constructed if the key is present.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+    return Table::InsertWith(key, [&](void* slot) {
+      new (slot) value_type{key, Value(std::forward<Args>(args)...)};
+    });
+  }
+
+  /// Inserts the value, or assigns it to the existing entry with the key.
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) {
+    std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(value));
+    if (!result.second) {
+      result.first->second = std::forward<M>(value);
+    }
+    return result;
+  }
+
+ protected:
+  constexpr InlineHashMap(size_t capacity, size_t slot_count) noexcept
+      : Table(capacity, slot_count) {}
+
+  ~InlineHashMap() = default;
+};
+
+}  // namespace pw
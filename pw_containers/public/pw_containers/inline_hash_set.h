@@ -0,0 +1,163 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "pw_containers/internal/hash_table.h"
+#include "pw_containers/internal/raw_storage.h"
+
+namespace pw {
+namespace containers::internal {
+
+struct Identity {
+  template <typename T>
+  constexpr const T& operator()(const T& value) const {
+    return value;
+  }
+};
+
+}  // namespace containers::internal
+
+/// The `InlineHashSet` class is similar to `std::unordered_set`, except it is
+/// backed by a fixed-size buffer. It uses the same open-addressing hash table
+/// as `InlineHashMap`.
+///
+/// `InlineHashSet`s must be declared with an explicit capacity (e.g.
+/// `InlineHashSet<int, 10>`), but they can be used and referred to without it
+/// (e.g. `InlineHashSet<int>`). Keys must be copy- or move-constructible.
+/// Inserting or erasing a key invalidates iterators to all keys.
+template <typename Key,
+          size_t kCapacity = containers::internal::kGenericSized,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class InlineHashSet
+    : public containers::internal::HashTableStorage<
+          InlineHashSet<Key,
+                        containers::internal::kGenericSized,
+                        Hash,
+                        KeyEqual>,
+          kCapacity,
+          std::is_trivially_destructible_v<Key>> {
+ private:
+  using Base =
+      InlineHashSet<Key, containers::internal::kGenericSized, Hash, KeyEqual>;
+
+ public:
+  using typename Base::const_iterator;
+  using typename Base::const_pointer;
+  using typename Base::const_reference;
+  using typename Base::difference_type;
+  using typename Base::hasher;
+  using typename Base::iterator;
+  using typename Base::key_equal;
+  using typename Base::key_type;
+  using typename Base::pointer;
+  using typename Base::reference;
+  using typename Base::size_type;
+  using typename Base::value_type;
+
+  static_assert(kCapacity > 0u, "InlineHashSet capacity must be nonzero");
+
+  InlineHashSet() = default;
+
+  InlineHashSet(std::initializer_list<value_type> list) { this->insert(list); }
+
+  template <typename InputIterator,
+            typename = containers::internal::EnableIfInputIterator<
+                InputIterator>>
+  InlineHashSet(InputIterator first, InputIterator last) {
+    this->insert(first, last);
+  }
+
+  InlineHashSet(const InlineHashSet& other) { *this = other; }
+
+  InlineHashSet(InlineHashSet&& other) noexcept { *this = std::move(other); }
+
+  InlineHashSet& operator=(const InlineHashSet& other) {
+    Base::operator=(other);
+    return *this;
+  }
+
+  InlineHashSet& operator=(InlineHashSet&& other) noexcept {
+    Base::operator=(std::move(other));
+    return *this;
+  }
+
+  InlineHashSet& operator=(std::initializer_list<value_type> list) {
+    Base::operator=(list);
+    return *this;
+  }
+};
+
+/// Defines the generic-capacity `InlineHashSet<Key>` specialization, which
+/// serves as the base class for `InlineHashSet`s of any capacity.
+///
+/// This size-polymorphic base class must not be used with `std::unique_ptr`
+/// or `delete`.
+template <typename Key, typename Hash, typename KeyEqual>
+class InlineHashSet<Key, containers::internal::kGenericSized, Hash, KeyEqual>
+    : public containers::internal::HashTable<
+          InlineHashSet<Key,
+                        containers::internal::kGenericSized,
+                        Hash,
+                        KeyEqual>,
+          Key,
+          Key,
+          containers::internal::Identity,
+          Hash,
+          KeyEqual> {
+ private:
+  using Table = containers::internal::HashTable<InlineHashSet,
+                                                Key,
+                                                Key,
+                                                containers::internal::Identity,
+                                                Hash,
+                                                KeyEqual>;
+
+ public:
+  using typename Table::value_type;
+
+  // An InlineHashSet without an explicit capacity cannot be constructed
+  // directly. Instead, construct an InlineHashSet<Key, kCapacity>.
+  InlineHashSet() = delete;
+
+  InlineHashSet& operator=(const InlineHashSet& other) {
+    Table::Assign(other);
+    return *this;
+  }
+
+  InlineHashSet& operator=(InlineHashSet&& other) noexcept {
+    Table::MoveFrom(other);
+    return *this;
+  }
+
+  InlineHashSet& operator=(std::initializer_list<value_type> list) {
+    this->clear();
+    this->insert(list);
+    return *this;
+  }
+
+ protected:
+  constexpr InlineHashSet(size_t capacity, size_t slot_count) noexcept
+      : Table(capacity, slot_count) {}
+
+  ~InlineHashSet() = default;
+};
+
+}  // namespace pw
@@ -0,0 +1,320 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace pw::containers::internal {
+
+class AvlTree;
+
+// An item in an intrusive AVL tree. IntrusiveMap and IntrusiveMultiMap items
+// derive from this class.
+class AvlItem {
+ public:
+  // Items are not copyable or movable, since they are linked into a tree.
+  AvlItem(const AvlItem&) = delete;
+  AvlItem& operator=(const AvlItem&) = delete;
+
+  // Returns whether this object is not part of a tree. This is O(1).
+  bool unlisted() const { return parent_ == nullptr; }
+
+  // Removes this object from the tree it is part of, if any. This is
+  // O(log n), where "n" is the number of items in the tree.
+  void unlist();
+
+ protected:
+  constexpr AvlItem() = default;
+
+  ~AvlItem() { unlist(); }
+
+ private:
+  friend class AvlTree;
+
+  // Returns the item that follows this one in key order. The item after the
+  // last one is the tree's sentinel. This is O(log n) in the worst case, and
+  // O(1) on average over an iteration.
+  AvlItem* next();
+  const AvlItem* next() const { return const_cast<AvlItem*>(this)->next(); }
+
+  // Returns the item that precedes this one in key order. The item before the
+  // sentinel is the last one.
+  AvlItem* previous();
+  const AvlItem* previous() const {
+    return const_cast<AvlItem*>(this)->previous();
+  }
+
+  // Replaces this item's link to `child` with a link to `replacement`.
+  void ReplaceChild(AvlItem* child, AvlItem* replacement);
+
+  // The tree's sentinel is the parent of the root, which is its left child.
+  // Items that are not in a tree have no parent.
+  AvlItem* parent_ = nullptr;
+  AvlItem* left_ = nullptr;
+  AvlItem* right_ = nullptr;
+
+  // The height of the right subtree minus the height of the left subtree:
+  // -1, 0, or 1.
+  int8_t balance_ = 0;
+
+  template <typename, typename>
+  friend class AvlIterator;
+};
+
+// Bidirectional iterator over the items of an AvlTree, in key order.
+template <typename T, typename I>
+class AvlIterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::remove_cv_t<T>;
+  using pointer = T*;
+  using reference = T&;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  constexpr AvlIterator() : item_(nullptr) {}
+
+  // Allow converting an iterator to a const iterator.
+  template <typename U,
+            typename J,
+            typename = std::enable_if_t<std::is_convertible_v<J*, I*>>>
+  constexpr AvlIterator(const AvlIterator<U, J>& other) : item_(other.item_) {}
+
+  AvlIterator& operator++() {
+    item_ = item_->next();
+    return *this;
+  }
+
+  AvlIterator operator++(int) {
+    AvlIterator previous_value(item_);
+    operator++();
+    return previous_value;
+  }
+
+  AvlIterator& operator--() {
+    item_ = item_->previous();
+    return *this;
+  }
+
+  AvlIterator operator--(int) {
+    AvlIterator previous_value(item_);
+    operator--();
+    return previous_value;
+  }
+
+  T& operator*() const { return *static_cast<T*>(item_); }
+  T* operator->() const { return static_cast<T*>(item_); }
+
+  template <typename U, typename J>
+  bool operator==(const AvlIterator<U, J>& rhs) const {
+    return item_ == rhs.item_;
+  }
+
+  template <typename U, typename J>
+  bool operator!=(const AvlIterator<U, J>& rhs) const {
+    return item_ != rhs.item_;
+  }
+
+ private:
+  template <typename, typename>
+  friend class AvlIterator;
+
+  template <typename, typename, typename>
+  friend class KeyedAvlTree;
+
+  constexpr explicit AvlIterator(I* item) : item_(item) {}
+
+  I* item_;
+};
+
+// A self-balancing binary search tree of AvlItems. This class links and
+// unlinks items and rebalances the tree; KeyedAvlTree decides where items go.
+// Keeping this logic out of the templates keeps code size independent of the
+// number of item types.
+class AvlTree {
+ public:
+  constexpr AvlTree() = default;
+
+  // Trees cannot be copied or moved, since their items point to the sentinel.
+  AvlTree(const AvlTree&) = delete;
+  AvlTree& operator=(const AvlTree&) = delete;
+
+  // Unlists all items, so they do not refer to the destroyed tree.
+  ~AvlTree() { clear(); }
+
+  bool empty() const { return root() == nullptr; }
+
+  // Returns the number of items in the tree. This is O(n).
+  size_t size() const;
+
+  // Returns the first item, or the sentinel if the tree is empty. This is
+  // O(log n).
+  AvlItem* begin();
+  const AvlItem* begin() const { return const_cast<AvlTree*>(this)->begin(); }
+
+  // Returns the sentinel, which follows the last item.
+  AvlItem* end() { return &sentinel_; }
+  const AvlItem* end() const { return &sentinel_; }
+
+  // Unlists all items. This is O(n).
+  void clear();
+
+  // Links `item` as the left or right child of `parent`, which must not have
+  // a child on that side, and rebalances the tree. If the tree is empty,
+  // `parent` is the sentinel and `left` must be true. Crashes if `item` is
+  // already in a tree.
+  void InsertAt(AvlItem& parent, bool left, AvlItem& item);
+
+  // Unlinks the item from this tree and rebalances it. Returns the item that
+  // followed it.
+  static AvlItem* Erase(AvlItem& item);
+
+ protected:
+  static AvlItem* left(const AvlItem& item) { return item.left_; }
+  static AvlItem* right(const AvlItem& item) { return item.right_; }
+
+  AvlItem* root() const { return sentinel_.left_; }
+
+ private:
+  // Rotates the subtree at `item` to the left or right, updating balances.
+  // Returns the new root of the subtree.
+  static AvlItem* RotateLeft(AvlItem& item);
+  static AvlItem* RotateRight(AvlItem& item);
+  static AvlItem* RotateRightLeft(AvlItem& item);
+  static AvlItem* RotateLeftRight(AvlItem& item);
+
+  // Restores the balance of the ancestors of a subtree after it shrank.
+  static void RebalanceAfterErase(AvlItem* parent, bool left);
+
+  AvlItem sentinel_;
+};
+
+// An AvlTree ordered by the key of each item. `T` is the item type, which must
+// derive from AvlItem and provide a `key()` method.
+template <typename Key, typename T, typename Compare>
+class KeyedAvlTree : public AvlTree {
+ public:
+  using iterator = AvlIterator<T, AvlItem>;
+  using const_iterator = AvlIterator<std::add_const_t<T>, const AvlItem>;
+
+  constexpr KeyedAvlTree() = default;
+
+  iterator begin() { return iterator(AvlTree::begin()); }
+  const_iterator begin() const { return const_iterator(AvlTree::begin()); }
+
+  iterator end() { return iterator(AvlTree::end()); }
+  const_iterator end() const { return const_iterator(AvlTree::end()); }
+
+  // Inserts the item into the tree. If `unique` is true and an item with an
+  // equivalent key is in the tree, the item is not inserted and the iterator
+  // refers to the existing item. Equivalent keys are otherwise inserted after
+  // those already in the tree.
+  std::pair<iterator, bool> Insert(T& item, bool unique) {
+    AvlItem* parent = AvlTree::end();
+    AvlItem* node = root();
+    bool left = true;
+    while (node != nullptr) {
+      parent = node;
+      left = Compare()(item.key(), KeyOf(node));
+      if (unique && !left && !Compare()(KeyOf(node), item.key())) {
+        return {iterator(node), false};
+      }
+      node = left ? AvlTree::left(*node) : AvlTree::right(*node);
+    }
+    InsertAt(*parent, left, item);
+    return {iterator(&item), true};
+  }
+
+  static iterator ToIterator(T& item) { return iterator(&item); }
+
+  iterator erase(iterator pos) { return iterator(AvlTree::Erase(*pos.item_)); }
+
+  // Removes the items with keys equivalent to `key`. Returns the number of
+  // items removed.
+  size_t erase(const Key& key) {
+    size_t removed = 0;
+    for (iterator it = lower_bound(key); it != end() && !IsBefore(key, it);) {
+      it = erase(it);
+      ++removed;
+    }
+    return removed;
+  }
+
+  // Returns the first item whose key is not less than `key`.
+  iterator lower_bound(const Key& key) {
+    return iterator(const_cast<AvlItem*>(LowerBound(key)));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return const_iterator(LowerBound(key));
+  }
+
+  // Returns the first item whose key is greater than `key`.
+  iterator upper_bound(const Key& key) {
+    return iterator(const_cast<AvlItem*>(UpperBound(key)));
+  }
+  const_iterator upper_bound(const Key& key) const {
+    return const_iterator(UpperBound(key));
+  }
+
+  iterator find(const Key& key) {
+    iterator it = lower_bound(key);
+    return it == end() || IsBefore(key, it) ? end() : it;
+  }
+  const_iterator find(const Key& key) const {
+    const_iterator it = lower_bound(key);
+    return it == end() || IsBefore(key, it) ? end() : it;
+  }
+
+ private:
+  static decltype(auto) KeyOf(const AvlItem* item) {
+    return static_cast<const T*>(item)->key();
+  }
+
+  // Returns whether `key` is less than the key of the item at `it`.
+  template <typename Iterator>
+  static bool IsBefore(const Key& key, const Iterator& it) {
+    return Compare()(key, it->key());
+  }
+
+  const AvlItem* LowerBound(const Key& key) const {
+    const AvlItem* result = AvlTree::end();
+    for (const AvlItem* node = root(); node != nullptr;) {
+      if (Compare()(KeyOf(node), key)) {
+        node = AvlTree::right(*node);
+      } else {
+        result = node;
+        node = AvlTree::left(*node);
+      }
+    }
+    return result;
+  }
+
+  const AvlItem* UpperBound(const Key& key) const {
+    const AvlItem* result = AvlTree::end();
+    for (const AvlItem* node = root(); node != nullptr;) {
+      if (Compare()(key, KeyOf(node))) {
+        result = node;
+        node = AvlTree::left(*node);
+      } else {
+        node = AvlTree::right(*node);
+      }
+    }
+    return result;
+  }
+};
+
+}  // namespace pw::containers::internal
@@ -0,0 +1,521 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_containers/internal/raw_storage.h"
+
+namespace pw::containers::internal {
+
+// Returns the number of slots in a hash table that holds up to `capacity`
+// entries. Tables are never more than 8/9 full, which keeps the Robin Hood
+// probe sequences short.
+constexpr size_t HashTableSlotCount(size_t capacity) {
+  return capacity + (capacity + 7) / 8;
+}
+
+// A slot in an open-addressing hash table. The value is stored as an
+// uninitialized memory block and constructed on demand with placement new.
+template <typename T>
+struct HashSlot {
+  T& value() { return *std::launder(reinterpret_cast<T*>(&bytes)); }
+  const T& value() const {
+    return *std::launder(reinterpret_cast<const T*>(&bytes));
+  }
+
+  // 0 if the slot is empty. Otherwise, 1 + the distance from the slot that the
+  // entry's hash maps to (its "home" slot) to this slot.
+  uint16_t probe_length;
+  alignas(T) std::byte bytes[sizeof(T)];
+};
+
+// Storage for the slots of a fixed-capacity hash table. `Table` is the
+// generic-capacity class of the container, which derives from HashTable.
+template <typename Table, size_t kCapacity, bool kIsTriviallyDestructible>
+class HashTableStorage;
+
+// Specialization of HashTableStorage for trivially-destructible values. No
+// destructor is generated.
+template <typename Table, size_t kCapacity>
+class HashTableStorage<Table, kCapacity, true> : public Table {
+ protected:
+  HashTableStorage() : Table(kCapacity, kSlotCount) {
+    for (auto& slot : slots_) {
+      slot.probe_length = 0;
+    }
+  }
+
+ private:
+  template <typename, typename, typename, typename, typename, typename>
+  friend class HashTable;
+
+  using Slot = HashSlot<typename Table::value_type>;
+
+  static constexpr size_t kSlotCount = HashTableSlotCount(kCapacity);
+  static_assert(kSlotCount <= std::numeric_limits<uint16_t>::max());
+
+  // The alignas specifier ensures that a zero-length array is aligned the same
+  // as an array with slots, so the slots are at the same offset for any
+  // capacity.
+  alignas(Slot) std::array<Slot, kSlotCount> slots_;
+};
+
+// Specialization of HashTableStorage for non-trivially-destructible values.
+// The entries are destroyed before the storage is invalidated.
+template <typename Table, size_t kCapacity>
+class HashTableStorage<Table, kCapacity, false> : public Table {
+ public:
+  ~HashTableStorage() { static_cast<Table*>(this)->clear(); }
+
+ protected:
+  HashTableStorage() : Table(kCapacity, kSlotCount) {
+    for (auto& slot : slots_) {
+      slot.probe_length = 0;
+    }
+  }
+
+ private:
+  template <typename, typename, typename, typename, typename, typename>
+  friend class HashTable;
+
+  using Slot = HashSlot<typename Table::value_type>;
+
+  static constexpr size_t kSlotCount = HashTableSlotCount(kCapacity);
+  static_assert(kSlotCount <= std::numeric_limits<uint16_t>::max());
+
+  alignas(Slot) std::array<Slot, kSlotCount> slots_;
+};
+
+// Open-addressing hash table with Robin Hood linear probing, which implements
+// InlineHashMap and InlineHashSet. Entries are stored in the slots array of a
+// HashTableStorage that derives from `Derived`, the generic-capacity container
+// class. The capacity and slot count are stored in variables, so the
+// implementation is shared by tables of all capacities.
+//
+// Robin Hood probing keeps the entries of each run of occupied slots ordered
+// by their home slot. A lookup can stop as soon as it reaches an entry that
+// is closer to its home slot than the key would be, so lookups for missing
+// keys are as short as lookups for present ones. Entries are removed with
+// backward-shift deletion, so no tombstones are needed.
+//
+// `KeyOf` returns the key of a `T`. If `T` is `Key`, as in a set, the entries
+// cannot be modified through iterators.
+template <typename Derived,
+          typename T,
+          typename Key,
+          typename KeyOf,
+          typename Hash,
+          typename KeyEqual>
+class HashTable {
+ private:
+  using Slot = HashSlot<T>;
+
+  template <bool kConst>
+  class Iterator;
+
+ public:
+  using key_type = Key;
+  using value_type = T;
+
+  // Hash tables are statically allocated, so the size and capacity are limited
+  // to 65535 entries, as in Vector.
+  using size_type = uint16_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  using iterator = Iterator<std::is_same_v<T, Key>>;
+  using const_iterator = Iterator<true>;
+
+  // Iterators
+
+  iterator begin() noexcept { return iterator(slots(), slots_end()); }
+  const_iterator begin() const noexcept { return cbegin(); }
+  const_iterator cbegin() const noexcept {
+    return const_iterator(slots(), slots_end());
+  }
+
+  iterator end() noexcept { return iterator(slots_end(), slots_end()); }
+  const_iterator end() const noexcept { return cend(); }
+  const_iterator cend() const noexcept {
+    return const_iterator(slots_end(), slots_end());
+  }
+
+  // Capacity
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0u; }
+
+  bool full() const noexcept { return size() == max_size(); }
+
+  size_type size() const noexcept { return size_; }
+
+  size_type max_size() const noexcept { return capacity(); }
+
+  size_type capacity() const noexcept { return capacity_; }
+
+  // Modify
+
+  void clear() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (Slot* slot = slots(); slot != slots_end(); ++slot) {
+        if (slot->probe_length != 0u) {
+          slot->value().~T();
+        }
+      }
+    }
+    for (Slot* slot = slots(); slot != slots_end(); ++slot) {
+      slot->probe_length = 0;
+    }
+    size_ = 0;
+  }
+
+  // Inserts the value if there is no entry with its key. Returns an iterator to
+  // the entry with the key and whether the value was inserted. Crashes if the
+  // value is new and the table is full.
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return InsertWith(KeyOf()(value),
+                      [&value](void* slot) { new (slot) T(value); });
+  }
+
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return InsertWith(KeyOf()(value), [&value](void* slot) {
+      new (slot) T(std::move(value));
+    });
+  }
+
+  template <typename InputIterator,
+            typename = containers::internal::EnableIfInputIterator<
+                InputIterator>>
+  void insert(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  void insert(std::initializer_list<value_type> list) {
+    insert(list.begin(), list.end());
+  }
+
+  // Constructs a value from the arguments and inserts it if there is no entry
+  // with its key.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    return insert(T{std::forward<Args>(args)...});
+  }
+
+  // Removes the entry at `pos`. Returns an iterator to the next entry.
+  // Invalidates iterators to the erased entry and to the entries after it.
+  iterator erase(const_iterator pos) {
+    const size_type index = static_cast<size_type>(pos.slot_ - slots());
+    size_type stop = static_cast<size_type>(pos.end_ - slots());
+    const size_type last = Erase(index);
+
+    // The backward shift may wrap around, moving entries from the first slots,
+    // which were already visited, to the last ones. Every entry at or after
+    // `stop` was visited before `pos`, so the returned iterator ends before
+    // them. If the shift moved the entry at `stop` back, that entry was
+    // visited too.
+    if (last < index || stop <= last) {
+      stop -= 1;
+    }
+    return iterator(slots() + index, slots() + stop);
+  }
+
+  // Removes the entry with the key, if any. Returns the number of entries
+  // removed.
+  size_type erase(const key_type& key) {
+    const size_type index = FindIndex(key);
+    if (index == slot_count_) {
+      return 0;
+    }
+    Erase(index);
+    return 1;
+  }
+
+  // Lookup
+
+  iterator find(const key_type& key) {
+    return iterator(slots() + FindIndex(key), slots_end());
+  }
+
+  const_iterator find(const key_type& key) const {
+    return const_iterator(slots() + FindIndex(key), slots_end());
+  }
+
+  size_type count(const key_type& key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  bool contains(const key_type& key) const {
+    return FindIndex(key) != slot_count_;
+  }
+
+  // Observers
+
+  hasher hash_function() const { return hasher(); }
+
+  key_equal key_eq() const { return key_equal(); }
+
+ protected:
+  explicit constexpr HashTable(size_t capacity, size_t slot_count)
+      : capacity_(static_cast<size_type>(capacity)),
+        slot_count_(static_cast<size_type>(slot_count)),
+        size_(0) {}
+
+  // Polymorphic-sized hash tables cannot be destroyed directly, since the
+  // storage is owned by the fixed-capacity derived class.
+  ~HashTable() = default;
+
+  HashTable(const HashTable&) = delete;
+  HashTable(HashTable&&) = delete;
+  HashTable& operator=(const HashTable&) = delete;
+  HashTable& operator=(HashTable&&) = delete;
+
+  void Assign(const HashTable& other) {
+    if (&other != this) {
+      clear();
+      insert(other.begin(), other.end());
+    }
+  }
+
+  void MoveFrom(HashTable& other) {
+    if (&other != this) {
+      clear();
+      for (Slot* slot = other.slots(); slot != other.slots_end(); ++slot) {
+        if (slot->probe_length != 0u) {
+          insert(std::move(slot->value()));
+        }
+      }
+      other.clear();
+    }
+  }
+
+  // Inserts an entry with `key` if there is none, constructing the value
+  // with `construct(void* slot)`.
+  template <typename Construct>
+  std::pair<iterator, bool> InsertWith(const key_type& key,
+                                       Construct&& construct) {
+    Slot* const slots = this->slots();
+    size_type index = HomeSlot(key);
+    uint16_t probe_length = 1;
+
+    for (; probe_length <= slots[index].probe_length; ++probe_length) {
+      if (slots[index].probe_length == probe_length &&
+          KeyEqual()(KeyOf()(slots[index].value()), key)) {
+        return {iterator(&slots[index], slots_end()), false};
+      }
+      index = Next(index);
+    }
+
+    PW_ASSERT(!full());
+
+    // The new entry takes this slot from an entry that is closer to its home
+    // slot. Shift the rest of the run one slot forward to make room.
+    if (slots[index].probe_length != 0u) {
+      size_type empty = Next(index);
+      while (slots[empty].probe_length != 0u) {
+        empty = Next(empty);
+      }
+      while (empty != index) {
+        const size_type previous = Previous(empty);
+        Relocate(slots[previous],
+                 slots[empty],
+                 static_cast<uint16_t>(slots[previous].probe_length + 1));
+        empty = previous;
+      }
+    }
+
+    construct(static_cast<void*>(&slots[index].bytes));
+    slots[index].probe_length = probe_length;
+    size_ += 1;
+    return {iterator(&slots[index], slots_end()), true};
+  }
+
+ private:
+  template <bool kConst>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = std::conditional_t<kConst, const T*, T*>;
+    using reference = std::conditional_t<kConst, const T&, T&>;
+
+    constexpr Iterator() = default;
+
+    // Allow converting a non-const iterator to a const iterator.
+    template <bool kOtherConst,
+              typename = std::enable_if_t<kConst && !kOtherConst>>
+    constexpr Iterator(const Iterator<kOtherConst>& other)
+        : slot_(other.slot_), end_(other.end_) {}
+
+    reference operator*() const { return slot_->value(); }
+    pointer operator->() const { return &slot_->value(); }
+
+    Iterator& operator++() {
+      ++slot_;
+      SkipEmptySlots();
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator original = *this;
+      operator++();
+      return original;
+    }
+
+    // An iterator returned by erase() may end before the last slot, so
+    // iterators at their ends compare equal regardless of slot.
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+      return lhs.slot_ == rhs.slot_ || (lhs.at_end() && rhs.at_end());
+    }
+
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) {
+      return !(lhs == rhs);
+    }
+
+   private:
+    friend class HashTable;
+
+    template <bool>
+    friend class Iterator;
+
+    using SlotPointer = std::conditional_t<kConst, const Slot*, Slot*>;
+
+    constexpr Iterator(SlotPointer slot, SlotPointer end)
+        : slot_(slot), end_(end) {
+      SkipEmptySlots();
+    }
+
+    bool at_end() const { return slot_ == end_; }
+
+    void SkipEmptySlots() {
+      while (slot_ != end_ && slot_->probe_length == 0u) {
+        ++slot_;
+      }
+    }
+
+    SlotPointer slot_ = nullptr;
+    SlotPointer end_ = nullptr;
+  };
+
+  using Storage =
+      HashTableStorage<Derived, 0, std::is_trivially_destructible_v<T>>;
+
+  // The slots are at the same offset in the storage of every capacity, so they
+  // are accessed through the zero-capacity storage type. std::array<T, 0>
+  // does not point data() at its storage, so take the array's address.
+  Slot* slots() {
+    return reinterpret_cast<Slot*>(
+        &static_cast<Storage*>(static_cast<Derived*>(this))->slots_);
+  }
+  const Slot* slots() const {
+    return reinterpret_cast<const Slot*>(
+        &static_cast<const Storage*>(static_cast<const Derived*>(this))
+             ->slots_);
+  }
+
+  Slot* slots_end() { return slots() + slot_count_; }
+  const Slot* slots_end() const { return slots() + slot_count_; }
+
+  // Maps a key to its home slot. The hash is multiplied by 2^32 / phi
+  // (Fibonacci hashing) so that every bit of it affects the high bits, which
+  // then select the slot. This spreads out keys even for identity hashes, as
+  // std::hash is for integers, without a division.
+  size_type HomeSlot(const key_type& key) const {
+    const size_t hash = Hash()(key);
+    uint32_t bits = static_cast<uint32_t>(hash);
+    if constexpr (sizeof(size_t) > sizeof(uint32_t)) {
+      bits ^= static_cast<uint32_t>((hash >> 16) >> 16);
+    }
+    bits *= 0x9E3779B9u;
+    return static_cast<size_type>((uint64_t{bits} * slot_count_) >> 32);
+  }
+
+  size_type Next(size_type index) const {
+    return index + 1u == slot_count_ ? 0u : static_cast<size_type>(index + 1);
+  }
+
+  size_type Previous(size_type index) const {
+    return index == 0u ? static_cast<size_type>(slot_count_ - 1)
+                       : static_cast<size_type>(index - 1);
+  }
+
+  // Returns the index of the slot with the key, or slot_count_ if the key is
+  // not in the table.
+  size_type FindIndex(const key_type& key) const {
+    if (empty()) {
+      return slot_count_;
+    }
+    const Slot* const slots = this->slots();
+    size_type index = HomeSlot(key);
+
+    // Stop at the first slot whose entry is closer to its home slot than the
+    // key would be. Robin Hood insertion would have placed the key before it.
+    for (uint16_t probe_length = 1; probe_length <= slots[index].probe_length;
+         ++probe_length) {
+      if (slots[index].probe_length == probe_length &&
+          KeyEqual()(KeyOf()(slots[index].value()), key)) {
+        return index;
+      }
+      index = Next(index);
+    }
+    return slot_count_;
+  }
+
+  // Destroys the entry at `index` and shifts the entries after it back until
+  // one is in its home slot or a slot is empty. Returns the index of the slot
+  // that is left empty.
+  size_type Erase(size_type index) {
+    Slot* const slots = this->slots();
+    slots[index].value().~T();
+
+    for (size_type next = Next(index); slots[next].probe_length > 1u;
+         next = Next(next)) {
+      Relocate(slots[next],
+               slots[index],
+               static_cast<uint16_t>(slots[next].probe_length - 1));
+      index = next;
+    }
+    slots[index].probe_length = 0;
+    size_ -= 1;
+    return index;
+  }
+
+  // Moves the value from one slot to an empty slot.
+  static void Relocate(Slot& from, Slot& to, uint16_t probe_length) {
+    new (static_cast<void*>(&to.bytes)) T(std::move(from.value()));
+    from.value().~T();
+    to.probe_length = probe_length;
+  }
+
+  const size_type capacity_;
+  const size_type slot_count_;
+  size_type size_;
+};
+
+}  // namespace pw::containers::internal
@@ -0,0 +1,198 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "pw_containers/internal/avl_tree.h"
+
+namespace pw {
+
+/// `IntrusiveMap` provides an ordered, associative container of items with
+/// unique keys, similar to `std::map`. Like `IntrusiveList`, the items are not
+/// allocated or owned by the map: the map links together items that derive
+/// from `IntrusiveMap<Key, T>::Item`.
+///
+/// The items are kept in an AVL tree, so inserting, erasing and looking up an
+/// item by key are O(log n). Items must provide a `key()` method that returns
+/// their `Key`, which must not change while the item is in a map.
+///
+/// As with `IntrusiveList`:
+///
+/// - An item must remain in scope for as long as it is in a map. Destroying
+///   an item removes it from its map.
+/// - An item can only be in one map or multimap at a time.
+///
+/// @code{.cpp}
+///   class Timer : public pw::IntrusiveMap<uint32_t, Timer>::Item {
+///    public:
+///     uint32_t key() const { return id_; }
+///     // ...
+///   };
+///
+///   pw::IntrusiveMap<uint32_t, Timer> timers;
+///   timers.insert(timer);
+///   auto it = timers.find(id);
+/// @endcode
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class IntrusiveMap {
+ private:
+  using Tree = containers::internal::KeyedAvlTree<Key, T, Compare>;
+
+ public:
+  class Item : public containers::internal::AvlItem {
+   protected:
+    constexpr Item() = default;
+  };
+
+  using key_type = Key;
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using key_compare = Compare;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = typename Tree::iterator;
+  using const_iterator = typename Tree::const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  constexpr IntrusiveMap() { CheckItemType(); }
+
+  /// Constructs an `IntrusiveMap` from an iterator over items. The iterator
+  /// may dereference as either `T&` or `T*`. Items with the key of an earlier
+  /// item are not added.
+  template <typename Iterator>
+  IntrusiveMap(Iterator first, Iterator last) : IntrusiveMap() {
+    insert(first, last);
+  }
+
+  /// Constructs an `IntrusiveMap` from a `std::initializer_list` of pointers
+  /// to items.
+  IntrusiveMap(std::initializer_list<T*> items)
+      : IntrusiveMap(items.begin(), items.end()) {}
+
+  // Iterators
+
+  iterator begin() noexcept { return tree_.begin(); }
+  const_iterator begin() const noexcept { return tree_.begin(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  iterator end() noexcept { return tree_.end(); }
+  const_iterator end() const noexcept { return tree_.end(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // Capacity
+
+  [[nodiscard]] bool empty() const noexcept { return tree_.empty(); }
+
+  /// Returns the number of items in the map. This is O(n).
+  size_t size() const { return tree_.size(); }
+
+  // Modify
+
+  /// Removes all items from the map. The items themselves are not destructed.
+  void clear() { tree_.clear(); }
+
+  /// Adds the item to the map, unless an item with an equivalent key is
+  /// already in it. Returns an iterator to the item with the key and whether
+  /// the item was added. Crashes if the item is already in a map.
+  std::pair<iterator, bool> insert(T& item) {
+    return tree_.Insert(item, /*unique=*/true);
+  }
+
+  template <typename Iterator>
+  void insert(Iterator first, Iterator last) {
+    for (Iterator it = first; it != last; ++it) {
+      if constexpr (std::is_pointer_v<std::remove_reference_t<decltype(*it)>>) {
+        insert(**it);
+      } else {
+        insert(*it);
+      }
+    }
+  }
+
+  void insert(std::initializer_list<T*> items) {
+    insert(items.begin(), items.end());
+  }
+
+  /// Removes the item at `pos` from the map. Returns the item after it. The
+  /// item is not destructed.
+  iterator erase(iterator pos) { return tree_.erase(pos); }
+
+  /// Removes the item from the map, which must contain it.
+  iterator erase(T& item) { return tree_.erase(Tree::ToIterator(item)); }
+
+  /// Removes the item with the key, if any. Returns the number of items
+  /// removed.
+  size_t erase(const Key& key) { return tree_.erase(key); }
+
+  // Lookup
+
+  size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+  bool contains(const Key& key) const { return find(key) != end(); }
+
+  iterator find(const Key& key) { return tree_.find(key); }
+  const_iterator find(const Key& key) const { return tree_.find(key); }
+
+  std::pair<iterator, iterator> equal_range(const Key& key) {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  iterator lower_bound(const Key& key) { return tree_.lower_bound(key); }
+  const_iterator lower_bound(const Key& key) const {
+    return tree_.lower_bound(key);
+  }
+
+  iterator upper_bound(const Key& key) { return tree_.upper_bound(key); }
+  const_iterator upper_bound(const Key& key) const {
+    return tree_.upper_bound(key);
+  }
+
+ private:
+  // Check that T is an Item in a function, since the class T will not be fully
+  // defined when the IntrusiveMap<Key, T> class is instantiated.
+  static constexpr void CheckItemType() {
+    static_assert(std::is_base_of_v<Item, T>,
+                  "IntrusiveMap items must be derived from "
+                  "IntrusiveMap<Key, T>::Item");
+  }
+
+  Tree tree_;
+};
+
+}  // namespace pw
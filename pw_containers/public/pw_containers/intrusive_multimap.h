@@ -0,0 +1,192 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "pw_containers/internal/avl_tree.h"
+
+namespace pw {
+
+/// `IntrusiveMultiMap` is an `IntrusiveMap` that may hold several items with
+/// equivalent keys, similar to `std::multimap`. Items with equivalent keys are
+/// kept in the order they were inserted.
+///
+/// Items derive from `IntrusiveMultiMap<Key, T>::Item` and provide a `key()`
+/// method, which must return the same key while the item is in a multimap.
+///
+/// @code{.cpp}
+///   class Timer : public pw::IntrusiveMultiMap<Deadline, Timer>::Item {
+///    public:
+///     Deadline key() const { return deadline_; }
+///     // ...
+///   };
+///
+///   pw::IntrusiveMultiMap<Deadline, Timer> timers;
+///   timers.insert(timer);
+///   Timer& next = *timers.begin();
+/// @endcode
+template <typename Key, typename T, typename Compare = std::less<Key>>
+class IntrusiveMultiMap {
+ private:
+  using Tree = containers::internal::KeyedAvlTree<Key, T, Compare>;
+
+ public:
+  class Item : public containers::internal::AvlItem {
+   protected:
+    constexpr Item() = default;
+  };
+
+  using key_type = Key;
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using key_compare = Compare;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = typename Tree::iterator;
+  using const_iterator = typename Tree::const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  constexpr IntrusiveMultiMap() { CheckItemType(); }
+
+  /// Constructs an `IntrusiveMultiMap` from an iterator over items. The
+  /// iterator may dereference as either `T&` or `T*`.
+  template <typename Iterator>
+  IntrusiveMultiMap(Iterator first, Iterator last) : IntrusiveMultiMap() {
+    insert(first, last);
+  }
+
+  /// Constructs an `IntrusiveMultiMap` from a `std::initializer_list` of
+  /// pointers to items.
+  IntrusiveMultiMap(std::initializer_list<T*> items)
+      : IntrusiveMultiMap(items.begin(), items.end()) {}
+
+  // Iterators
+
+  iterator begin() noexcept { return tree_.begin(); }
+  const_iterator begin() const noexcept { return tree_.begin(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  iterator end() noexcept { return tree_.end(); }
+  const_iterator end() const noexcept { return tree_.end(); }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // Capacity
+
+  [[nodiscard]] bool empty() const noexcept { return tree_.empty(); }
+
+  /// Returns the number of items in the multimap. This is O(n).
+  size_t size() const { return tree_.size(); }
+
+  // Modify
+
+  /// Removes all items from the multimap. The items themselves are not
+  /// destructed.
+  void clear() { tree_.clear(); }
+
+  /// Adds the item to the multimap, after any items with equivalent keys.
+  /// Returns an iterator to the item. Crashes if the item is already in a map.
+  iterator insert(T& item) {
+    return tree_.Insert(item, /*unique=*/false).first;
+  }
+
+  template <typename Iterator>
+  void insert(Iterator first, Iterator last) {
+    for (Iterator it = first; it != last; ++it) {
+      if constexpr (std::is_pointer_v<std::remove_reference_t<decltype(*it)>>) {
+        insert(**it);
+      } else {
+        insert(*it);
+      }
+    }
+  }
+
+  void insert(std::initializer_list<T*> items) {
+    insert(items.begin(), items.end());
+  }
+
+  /// Removes the item at `pos` from the multimap. Returns the item after it.
+  /// The item is not destructed.
+  iterator erase(iterator pos) { return tree_.erase(pos); }
+
+  /// Removes the item from the multimap, which must contain it.
+  iterator erase(T& item) { return tree_.erase(Tree::ToIterator(item)); }
+
+  /// Removes the items with the key. Returns the number of items removed.
+  size_t erase(const Key& key) { return tree_.erase(key); }
+
+  // Lookup
+
+  /// Returns the number of items with the key. This is O(log n + count).
+  size_t count(const Key& key) const {
+    auto [first, last] = equal_range(key);
+    return static_cast<size_t>(std::distance(first, last));
+  }
+
+  bool contains(const Key& key) const { return find(key) != end(); }
+
+  iterator find(const Key& key) { return tree_.find(key); }
+  const_iterator find(const Key& key) const { return tree_.find(key); }
+
+  std::pair<iterator, iterator> equal_range(const Key& key) {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  iterator lower_bound(const Key& key) { return tree_.lower_bound(key); }
+  const_iterator lower_bound(const Key& key) const {
+    return tree_.lower_bound(key);
+  }
+
+  iterator upper_bound(const Key& key) { return tree_.upper_bound(key); }
+  const_iterator upper_bound(const Key& key) const {
+    return tree_.upper_bound(key);
+  }
+
+ private:
+  // Check that T is an Item in a function, since the class T will not be fully
+  // defined when the IntrusiveMultiMap<Key, T> class is instantiated.
+  static constexpr void CheckItemType() {
+    static_assert(std::is_base_of_v<Item, T>,
+                  "IntrusiveMultiMap items must be derived from "
+                  "IntrusiveMultiMap<Key, T>::Item");
+  }
+
+  Tree tree_;
+};
+
+}  // namespace pw
@@ -0,0 +1,110 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+
+// A self-contained SHA-256 implementation. Blocks are compressed with the
+// SHA-NI instructions on x86-64 CPUs that support them, with the ARMv8
+// cryptography extension when compiled for it, and in portable C++ otherwise.
+//
+// This is the implementation of the `sha256_native` backend, but it can also
+// be used directly, for example for the multi-buffer API.
+namespace pw::crypto::sha256::native {
+
+inline constexpr size_t kBlockSizeBytes = 64;
+
+/// The state of a SHA-256 hash.
+struct Context {
+  uint32_t state[8];
+  uint64_t length;  // Total number of bytes hashed.
+  std::array<std::byte, kBlockSizeBytes> buffer;  // Incomplete block.
+};
+
+/// Starts a new hash.
+void Init(Context& ctx);
+
+/// Hashes the next bytes of the message.
+void Update(Context& ctx, ConstByteSpan data);
+
+/// Writes the digest to `out_digest`, which must be at least 32 bytes long.
+/// The context must be initialized again before it is reused.
+void Final(Context& ctx, ByteSpan out_digest);
+
+/// Returns the name of the block function in use: "sha-ni", "armv8-ce" or
+/// "portable".
+const char* Implementation();
+
+/// Hashes several independent messages in lockstep.
+///
+/// Each `Update()` takes the next chunk of every message. The blocks of the
+/// different messages are then compressed together: with SIMD instructions
+/// across the messages when there is no SHA-256 hardware support, or
+/// interleaved with it otherwise. The chunks of one call may have different
+/// sizes, and messages may be left empty.
+///
+/// @code{.cpp}
+///   native::MultiBuffer hasher;
+///   const ConstByteSpan chunks[] = {image_a_chunk, image_b_chunk};
+///   hasher.Update(chunks);
+///   // ...
+///   const ByteSpan digests[] = {digest_a, digest_b};
+///   hasher.Final(digests);
+/// @endcode
+class MultiBuffer {
+ public:
+  /// The maximum number of messages hashed together.
+  static constexpr size_t kLanes = 4;
+
+  MultiBuffer() { Reset(); }
+
+  /// Starts new hashes for all messages.
+  void Reset();
+
+  /// Hashes `data[i]` as the next chunk of message `i`. Returns:
+  ///
+  /// * @pw_status{OK} - The data was hashed.
+  /// * @pw_status{INVALID_ARGUMENT} - There are more than `kLanes` chunks.
+  Status Update(span<const ConstByteSpan> data);
+
+  /// Writes the digest of message `i` to `out_digests[i]`, which must be at
+  /// least 32 bytes long. `Reset()` must be called before the hasher is
+  /// reused. Returns:
+  ///
+  /// * @pw_status{OK} - The digests were written.
+  /// * @pw_status{INVALID_ARGUMENT} - There are more than `kLanes` digests, or
+  ///   a digest buffer is too small.
+  Status Final(span<const ByteSpan> out_digests);
+
+ private:
+  std::array<Context, kLanes> lanes_;
+};
+
+/// Hashes any number of complete messages, `kLanes` at a time, and writes the
+/// digest of `messages[i]` to `out_digests[i]`. Returns:
+///
+/// * @pw_status{OK} - The digests were written.
+/// * @pw_status{INVALID_ARGUMENT} - The number of messages and digests differ,
+///   or a digest buffer is too small.
+Status HashMultiple(span<const ConstByteSpan> messages,
+                    span<const ByteSpan> out_digests);
+
+}  // namespace pw::crypto::sha256::native
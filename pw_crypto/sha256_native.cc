@@ -0,0 +1,600 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_crypto/sha256_native.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_status/try.h"
+
+// The hardware block functions can be disabled by defining these to 0, which
+// is how the tests cover the portable code on any host.
+#ifndef PW_CRYPTO_SHA256_NATIVE_SHA_NI
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PW_CRYPTO_SHA256_NATIVE_SHA_NI 1
+#else
+#define PW_CRYPTO_SHA256_NATIVE_SHA_NI 0
+#endif  // defined(__x86_64__)
+#endif  // PW_CRYPTO_SHA256_NATIVE_SHA_NI
+
+#ifndef PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+#if defined(__aarch64__) && \
+    (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+#define PW_CRYPTO_SHA256_NATIVE_ARMV8_CE 1
+#else
+#define PW_CRYPTO_SHA256_NATIVE_ARMV8_CE 0
+#endif  // defined(__aarch64__)
+#endif  // PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+
+#if PW_CRYPTO_SHA256_NATIVE_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif  // PW_CRYPTO_SHA256_NATIVE_SHA_NI
+
+#if PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+#include <arm_neon.h>
+#endif  // PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+
+// Multi-buffer hashing compresses four messages at once in 128-bit vectors,
+// when the target has them.
+#if defined(__SSE2__) || defined(__ARM_NEON)
+#define PW_CRYPTO_SHA256_NATIVE_SIMD_LANES 1
+#else
+#define PW_CRYPTO_SHA256_NATIVE_SIMD_LANES 0
+#endif  // defined(__SSE2__) || defined(__ARM_NEON)
+
+namespace pw::crypto::sha256::native {
+namespace {
+
+constexpr uint32_t kInitialState[8] = {
+    0x6a09e667,
+    0xbb67ae85,
+    0x3c6ef372,
+    0xa54ff53a,
+    0x510e527f,
+    0x9b05688c,
+    0x1f83d9ab,
+    0x5be0cd19,
+};
+
+alignas(16) constexpr uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// Compresses `count` consecutive 64-byte blocks into `state`.
+using BlockFunction = void (*)(uint32_t* state,
+                               const std::byte* blocks,
+                               size_t count);
+
+uint32_t LoadBigEndian32(const std::byte* data) {
+  return static_cast<uint32_t>(data[0]) << 24 |
+         static_cast<uint32_t>(data[1]) << 16 |
+         static_cast<uint32_t>(data[2]) << 8 | static_cast<uint32_t>(data[3]);
+}
+
+void StoreBigEndian32(uint32_t value, std::byte* data) {
+  data[0] = static_cast<std::byte>(value >> 24);
+  data[1] = static_cast<std::byte>(value >> 16);
+  data[2] = static_cast<std::byte>(value >> 8);
+  data[3] = static_cast<std::byte>(value);
+}
+
+// Word is either uint32_t or a vector of uint32_t with one message per lane.
+template <typename Word>
+Word Rotr(Word x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+
+// One round, with the working variables passed rotated by the round number.
+template <typename Word>
+void Round(
+    Word a, Word b, Word c, Word& d, Word e, Word f, Word g, Word& h, Word kw) {
+  const Word t1 =
+      h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + (g ^ (e & (f ^ g))) + kw;
+  const Word t2 =
+      (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) | (c & (a | b)));
+  d += t1;
+  h = t1 + t2;
+}
+
+// Returns the round constant plus message word t. w holds the last 16 words
+// of the message schedule.
+template <typename Word>
+Word Schedule(Word* w, int t) {
+  if (t >= 16) {
+    const Word w15 = w[(t + 1) & 15];
+    const Word w2 = w[(t + 14) & 15];
+    const Word s0 = Rotr(w15, 7) ^ Rotr(w15, 18) ^ (w15 >> 3);
+    const Word s1 = Rotr(w2, 17) ^ Rotr(w2, 19) ^ (w2 >> 10);
+    w[t & 15] += s0 + s1 + w[(t + 9) & 15];
+  }
+  return w[t & 15] + kRoundConstants[t];
+}
+
+// Runs the 64 rounds over one block's message words, which are overwritten by
+// the message schedule.
+template <typename Word>
+void CompressWords(Word* state, Word* w) {
+  Word a = state[0];
+  Word b = state[1];
+  Word c = state[2];
+  Word d = state[3];
+  Word e = state[4];
+  Word f = state[5];
+  Word g = state[6];
+  Word h = state[7];
+
+  // Unrolled by 8 so the working variables never move.
+  for (int t = 0; t < 64; t += 8) {
+    Round(a, b, c, d, e, f, g, h, Schedule(w, t));
+    Round(h, a, b, c, d, e, f, g, Schedule(w, t + 1));
+    Round(g, h, a, b, c, d, e, f, Schedule(w, t + 2));
+    Round(f, g, h, a, b, c, d, e, Schedule(w, t + 3));
+    Round(e, f, g, h, a, b, c, d, Schedule(w, t + 4));
+    Round(d, e, f, g, h, a, b, c, Schedule(w, t + 5));
+    Round(c, d, e, f, g, h, a, b, Schedule(w, t + 6));
+    Round(b, c, d, e, f, g, h, a, Schedule(w, t + 7));
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+void CompressPortable(uint32_t* state, const std::byte* blocks, size_t count) {
+  for (; count > 0; --count, blocks += kBlockSizeBytes) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = LoadBigEndian32(blocks + 4 * i);
+    }
+    CompressWords(state, w);
+  }
+}
+
+#if PW_CRYPTO_SHA256_NATIVE_SHA_NI
+
+bool CpuHasShaNi() {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 ||
+      (ecx & bit_SSE4_1) == 0 || (ecx & bit_SSSE3) == 0) {
+    return false;
+  }
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+  return (ebx & bit_SHA) != 0;
+}
+
+#define PW_CRYPTO_SHA_NI_TARGET __attribute__((target("sha,sse4.1")))
+
+// Runs rounds 4 * i to 4 * i + 3 with the message words in msg.
+PW_CRYPTO_SHA_NI_TARGET inline void ShaNiRounds(__m128i& state0,
+                                                __m128i& state1,
+                                                __m128i msg,
+                                                int i) {
+  msg = _mm_add_epi32(
+      msg,
+      _mm_load_si128(
+          reinterpret_cast<const __m128i*>(&kRoundConstants[4 * i])));
+  state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+  msg = _mm_shuffle_epi32(msg, 0x0E);
+  state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+}
+
+// Returns the next four message words from the previous sixteen, oldest first.
+PW_CRYPTO_SHA_NI_TARGET inline __m128i ShaNiSchedule(__m128i w0,
+                                                     __m128i w4,
+                                                     __m128i w8,
+                                                     __m128i w12) {
+  __m128i msg = _mm_sha256msg1_epu32(w0, w4);
+  msg = _mm_add_epi32(msg, _mm_alignr_epi8(w12, w8, 4));
+  return _mm_sha256msg2_epu32(msg, w12);
+}
+
+PW_CRYPTO_SHA_NI_TARGET void CompressShaNi(uint32_t* state,
+                                           const std::byte* blocks,
+                                           size_t count) {
+  const __m128i kByteSwap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // The SHA-NI instructions keep the state as ABEF and CDGH.
+  __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+  __m128i state1 =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+  tmp = _mm_shuffle_epi32(tmp, 0xB1);                // CDAB
+  state1 = _mm_shuffle_epi32(state1, 0x1B);          // EFGH
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+  for (; count > 0; --count, blocks += kBlockSizeBytes) {
+    const __m128i abef = state0;
+    const __m128i cdgh = state1;
+    const __m128i* data = reinterpret_cast<const __m128i*>(blocks);
+
+    __m128i msg0 = _mm_shuffle_epi8(_mm_loadu_si128(data), kByteSwap);
+    __m128i msg1 = _mm_shuffle_epi8(_mm_loadu_si128(data + 1), kByteSwap);
+    __m128i msg2 = _mm_shuffle_epi8(_mm_loadu_si128(data + 2), kByteSwap);
+    __m128i msg3 = _mm_shuffle_epi8(_mm_loadu_si128(data + 3), kByteSwap);
+    ShaNiRounds(state0, state1, msg0, 0);
+    ShaNiRounds(state0, state1, msg1, 1);
+    ShaNiRounds(state0, state1, msg2, 2);
+    ShaNiRounds(state0, state1, msg3, 3);
+
+    for (int i = 4; i < 16; i += 4) {
+      msg0 = ShaNiSchedule(msg0, msg1, msg2, msg3);
+      ShaNiRounds(state0, state1, msg0, i);
+      msg1 = ShaNiSchedule(msg1, msg2, msg3, msg0);
+      ShaNiRounds(state0, state1, msg1, i + 1);
+      msg2 = ShaNiSchedule(msg2, msg3, msg0, msg1);
+      ShaNiRounds(state0, state1, msg2, i + 2);
+      msg3 = ShaNiSchedule(msg3, msg0, msg1, msg2);
+      ShaNiRounds(state0, state1, msg3, i + 3);
+    }
+
+    state0 = _mm_add_epi32(state0, abef);
+    state1 = _mm_add_epi32(state1, cdgh);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+  state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+  state1 = _mm_alignr_epi8(state1, tmp, 8);     // HGFE
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+#undef PW_CRYPTO_SHA_NI_TARGET
+
+#endif  // PW_CRYPTO_SHA256_NATIVE_SHA_NI
+
+#if PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+
+// Runs rounds 4 * i to 4 * i + 3 with the message words in msg.
+inline void Armv8Rounds(uint32x4_t& state0,
+                        uint32x4_t& state1,
+                        uint32x4_t msg,
+                        int i) {
+  msg = vaddq_u32(msg, vld1q_u32(&kRoundConstants[4 * i]));
+  const uint32x4_t previous_state0 = state0;
+  state0 = vsha256hq_u32(state0, state1, msg);
+  state1 = vsha256h2q_u32(state1, previous_state0, msg);
+}
+
+// Returns the next four message words from the previous sixteen, oldest first.
+inline uint32x4_t Armv8Schedule(uint32x4_t w0,
+                                uint32x4_t w4,
+                                uint32x4_t w8,
+                                uint32x4_t w12) {
+  return vsha256su1q_u32(vsha256su0q_u32(w0, w4), w8, w12);
+}
+
+uint32x4_t Armv8Load(const std::byte* data) {
+  return vreinterpretq_u32_u8(
+      vrev32q_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data))));
+}
+
+void CompressArmv8(uint32_t* state, const std::byte* blocks, size_t count) {
+  uint32x4_t state0 = vld1q_u32(&state[0]);  // ABCD
+  uint32x4_t state1 = vld1q_u32(&state[4]);  // EFGH
+
+  for (; count > 0; --count, blocks += kBlockSizeBytes) {
+    const uint32x4_t abcd = state0;
+    const uint32x4_t efgh = state1;
+
+    uint32x4_t msg0 = Armv8Load(blocks);
+    uint32x4_t msg1 = Armv8Load(blocks + 16);
+    uint32x4_t msg2 = Armv8Load(blocks + 32);
+    uint32x4_t msg3 = Armv8Load(blocks + 48);
+    Armv8Rounds(state0, state1, msg0, 0);
+    Armv8Rounds(state0, state1, msg1, 1);
+    Armv8Rounds(state0, state1, msg2, 2);
+    Armv8Rounds(state0, state1, msg3, 3);
+
+    for (int i = 4; i < 16; i += 4) {
+      msg0 = Armv8Schedule(msg0, msg1, msg2, msg3);
+      Armv8Rounds(state0, state1, msg0, i);
+      msg1 = Armv8Schedule(msg1, msg2, msg3, msg0);
+      Armv8Rounds(state0, state1, msg1, i + 1);
+      msg2 = Armv8Schedule(msg2, msg3, msg0, msg1);
+      Armv8Rounds(state0, state1, msg2, i + 2);
+      msg3 = Armv8Schedule(msg3, msg0, msg1, msg2);
+      Armv8Rounds(state0, state1, msg3, i + 3);
+    }
+
+    state0 = vaddq_u32(state0, abcd);
+    state1 = vaddq_u32(state1, efgh);
+  }
+
+  vst1q_u32(&state[0], state0);
+  vst1q_u32(&state[4], state1);
+}
+
+#endif  // PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+
+struct BlockFunctionInfo {
+  BlockFunction compress;
+  const char* name;
+  bool hardware;
+};
+
+BlockFunctionInfo SelectBlockFunction() {
+#if PW_CRYPTO_SHA256_NATIVE_SHA_NI
+  if (CpuHasShaNi()) {
+    return {CompressShaNi, "sha-ni", true};
+  }
+#endif  // PW_CRYPTO_SHA256_NATIVE_SHA_NI
+#if PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+  return {CompressArmv8, "armv8-ce", true};
+#else
+  return {CompressPortable, "portable", false};
+#endif  // PW_CRYPTO_SHA256_NATIVE_ARMV8_CE
+}
+
+const BlockFunctionInfo& BlockFunctionInUse() {
+  static const BlockFunctionInfo info = SelectBlockFunction();
+  return info;
+}
+
+void Compress(uint32_t* state, const std::byte* blocks, size_t count) {
+  BlockFunctionInUse().compress(state, blocks, count);
+}
+
+#if PW_CRYPTO_SHA256_NATIVE_SIMD_LANES
+
+using Lanes = uint32_t __attribute__((vector_size(16)));
+static_assert(sizeof(Lanes) / sizeof(uint32_t) == MultiBuffer::kLanes);
+
+// Compresses one block of each message, with the messages in vector lanes.
+// Unused lanes compress a block of zeros, and their results are discarded.
+void CompressLanes(uint32_t* const* states,
+                   const std::byte* const* blocks,
+                   size_t count) {
+  static constexpr std::byte kZeros[kBlockSizeBytes] = {};
+  const std::byte* lane_blocks[MultiBuffer::kLanes];
+  for (size_t lane = 0; lane < MultiBuffer::kLanes; ++lane) {
+    lane_blocks[lane] = lane < count ? blocks[lane] : kZeros;
+  }
+
+  Lanes state[8];
+  for (int i = 0; i < 8; ++i) {
+    for (size_t lane = 0; lane < MultiBuffer::kLanes; ++lane) {
+      state[i][lane] = lane < count ? states[lane][i] : 0;
+    }
+  }
+
+  Lanes w[16];
+  for (int i = 0; i < 16; ++i) {
+    for (size_t lane = 0; lane < MultiBuffer::kLanes; ++lane) {
+      w[i][lane] = LoadBigEndian32(lane_blocks[lane] + 4 * i);
+    }
+  }
+
+  CompressWords(state, w);
+
+  for (int i = 0; i < 8; ++i) {
+    for (size_t lane = 0; lane < count; ++lane) {
+      states[lane][i] = state[i][lane];
+    }
+  }
+}
+
+#endif  // PW_CRYPTO_SHA256_NATIVE_SIMD_LANES
+
+// Compresses one block of each of `count` messages.
+void CompressEach(uint32_t* const* states,
+                  const std::byte* const* blocks,
+                  size_t count) {
+#if PW_CRYPTO_SHA256_NATIVE_SIMD_LANES
+  // The hardware instructions are faster than four lanes of software rounds.
+  if (count > 1 && !BlockFunctionInUse().hardware) {
+    CompressLanes(states, blocks, count);
+    return;
+  }
+#endif  // PW_CRYPTO_SHA256_NATIVE_SIMD_LANES
+  for (size_t i = 0; i < count; ++i) {
+    Compress(states[i], blocks[i], 1);
+  }
+}
+
+}  // namespace
+
+void Init(Context& ctx) {
+  std::memcpy(ctx.state, kInitialState, sizeof(ctx.state));
+  ctx.length = 0;
+}
+
+void Update(Context& ctx, ConstByteSpan data) {
+  const size_t buffered = ctx.length % kBlockSizeBytes;
+  ctx.length += data.size();
+
+  if (buffered != 0u) {
+    const size_t size = std::min(kBlockSizeBytes - buffered, data.size());
+    std::memcpy(ctx.buffer.data() + buffered, data.data(), size);
+    data = data.subspan(size);
+    if (buffered + size < kBlockSizeBytes) {
+      return;
+    }
+    Compress(ctx.state, ctx.buffer.data(), 1);
+  }
+
+  const size_t blocks = data.size() / kBlockSizeBytes;
+  if (blocks != 0u) {
+    Compress(ctx.state, data.data(), blocks);
+    data = data.subspan(blocks * kBlockSizeBytes);
+  }
+  std::memcpy(ctx.buffer.data(), data.data(), data.size());
+}
+
+void Final(Context& ctx, ByteSpan out_digest) {
+  size_t buffered = ctx.length % kBlockSizeBytes;
+  const uint64_t bit_length = ctx.length * 8;
+
+  ctx.buffer[buffered++] = std::byte{0x80};
+  if (buffered > kBlockSizeBytes - sizeof(bit_length)) {
+    std::fill(ctx.buffer.begin() + buffered, ctx.buffer.end(), std::byte{0});
+    Compress(ctx.state, ctx.buffer.data(), 1);
+    buffered = 0;
+  }
+  std::fill(ctx.buffer.begin() + buffered,
+            ctx.buffer.end() - sizeof(bit_length),
+            std::byte{0});
+  StoreBigEndian32(static_cast<uint32_t>(bit_length >> 32),
+                   ctx.buffer.data() + kBlockSizeBytes - 8);
+  StoreBigEndian32(static_cast<uint32_t>(bit_length),
+                   ctx.buffer.data() + kBlockSizeBytes - 4);
+  Compress(ctx.state, ctx.buffer.data(), 1);
+
+  for (int i = 0; i < 8; ++i) {
+    StoreBigEndian32(ctx.state[i], out_digest.data() + 4 * i);
+  }
+}
+
+const char* Implementation() { return BlockFunctionInUse().name; }
+
+void MultiBuffer::Reset() {
+  for (Context& ctx : lanes_) {
+    Init(ctx);
+  }
+}
+
+Status MultiBuffer::Update(span<const ConstByteSpan> data) {
+  if (data.size() > kLanes) {
+    return Status::InvalidArgument();
+  }
+
+  // The blocks to compress for each message: a block completed in the
+  // context's buffer, if any, followed by whole blocks from the data.
+  struct Input {
+    const std::byte* buffered_block;
+    const std::byte* blocks;
+    size_t block_count;
+    ConstByteSpan rest;
+  };
+  std::array<Input, kLanes> inputs{};
+  size_t rounds = 0;
+
+  for (size_t lane = 0; lane < data.size(); ++lane) {
+    Context& ctx = lanes_[lane];
+    Input& input = inputs[lane];
+    ConstByteSpan chunk = data[lane];
+
+    const size_t buffered = ctx.length % kBlockSizeBytes;
+    ctx.length += chunk.size();
+    if (buffered != 0u) {
+      const size_t size = std::min(kBlockSizeBytes - buffered, chunk.size());
+      std::memcpy(ctx.buffer.data() + buffered, chunk.data(), size);
+      chunk = chunk.subspan(size);
+      if (buffered + size < kBlockSizeBytes) {
+        continue;
+      }
+      input.buffered_block = ctx.buffer.data();
+    }
+
+    input.blocks = chunk.data();
+    input.block_count = chunk.size() / kBlockSizeBytes;
+    input.rest = chunk.subspan(input.block_count * kBlockSizeBytes);
+    rounds = std::max(rounds,
+                      input.block_count + (input.buffered_block ? 1 : 0));
+  }
+
+  for (size_t round = 0; round < rounds; ++round) {
+    uint32_t* states[kLanes];
+    const std::byte* blocks[kLanes];
+    size_t count = 0;
+
+    for (size_t lane = 0; lane < data.size(); ++lane) {
+      const Input& input = inputs[lane];
+      const std::byte* block = nullptr;
+      size_t index = round;
+      if (input.buffered_block != nullptr) {
+        if (round == 0u) {
+          block = input.buffered_block;
+        } else {
+          index = round - 1;
+        }
+      }
+      if (block == nullptr && index < input.block_count) {
+        block = input.blocks + index * kBlockSizeBytes;
+      }
+      if (block != nullptr) {
+        states[count] = lanes_[lane].state;
+        blocks[count] = block;
+        count += 1;
+      }
+    }
+    CompressEach(states, blocks, count);
+  }
+
+  // The buffered blocks were compressed, so the rest can replace them.
+  for (size_t lane = 0; lane < data.size(); ++lane) {
+    const Input& input = inputs[lane];
+    if (input.blocks != nullptr) {
+      std::memcpy(
+          lanes_[lane].buffer.data(), input.rest.data(), input.rest.size());
+    }
+  }
+  return OkStatus();
+}
+
+Status MultiBuffer::Final(span<const ByteSpan> out_digests) {
+  if (out_digests.size() > kLanes) {
+    return Status::InvalidArgument();
+  }
+  for (ByteSpan digest : out_digests) {
+    if (digest.size() < sizeof(Context::state)) {
+      return Status::InvalidArgument();
+    }
+  }
+
+  for (size_t lane = 0; lane < out_digests.size(); ++lane) {
+    native::Final(lanes_[lane], out_digests[lane]);
+  }
+  return OkStatus();
+}
+
+Status HashMultiple(span<const ConstByteSpan> messages,
+                    span<const ByteSpan> out_digests) {
+  if (messages.size() != out_digests.size()) {
+    return Status::InvalidArgument();
+  }
+
+  MultiBuffer hasher;
+  while (!messages.empty()) {
+    const size_t count = std::min(messages.size(), MultiBuffer::kLanes);
+    hasher.Reset();
+    PW_TRY(hasher.Update(messages.first(count)));
+    PW_TRY(hasher.Final(out_digests.first(count)));
+    messages = messages.subspan(count);
+    out_digests = out_digests.subspan(count);
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::crypto::sha256::native
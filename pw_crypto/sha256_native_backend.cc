@@ -0,0 +1,37 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_crypto/sha256.h"
+#include "pw_crypto/sha256_native.h"
+#include "pw_status/status.h"
+
+namespace pw::crypto::sha256::backend {
+
+Status DoInit(NativeSha256Context& ctx) {
+  native::Init(ctx);
+  return OkStatus();
+}
+
+Status DoUpdate(NativeSha256Context& ctx, ConstByteSpan data) {
+  native::Update(ctx, data);
+  return OkStatus();
+}
+
+Status DoFinal(NativeSha256Context& ctx, ByteSpan out_digest) {
+  // The frontend checks the size of out_digest.
+  native::Final(ctx, out_digest);
+  return OkStatus();
+}
+
+}  // namespace pw::crypto::sha256::backend
@@ -0,0 +1,204 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_crypto/sha256_native.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw::crypto::sha256::native {
+namespace {
+
+#define AS_BYTES(s) as_bytes(span(s, sizeof(s) - 1))
+
+using Digest = std::array<std::byte, 32>;
+
+// Test vectors from FIPS 180-2, appendix B.
+#define SHA256_HASH_OF_ABC                                           \
+  "\xba\x78\x16\xbf\x8f\x01\xcf\xea\x41\x41\x40\xde\x5d\xae\x22\x23" \
+  "\xb0\x03\x61\xa3\x96\x17\x7a\x9c\xb4\x10\xff\x61\xf2\x00\x15\xad"
+
+#define TWO_BLOCK_MESSAGE \
+  "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+
+#define SHA256_HASH_OF_TWO_BLOCK_MESSAGE                             \
+  "\x24\x8d\x6a\x61\xd2\x06\x38\xb8\xe5\xc0\x26\x93\x0c\x3e\x60\x39" \
+  "\xa3\x3c\xe4\x59\x64\xff\x21\x67\xf6\xec\xed\xd4\x19\xdb\x06\xc1"
+
+#define SHA256_HASH_OF_MILLION_A                                     \
+  "\xcd\xc7\x6e\x5c\x99\x14\xfb\x92\x81\xa1\xc7\xe2\x84\xd7\x3e\x67" \
+  "\xf1\x80\x9a\x48\xa4\x97\x20\x0e\x04\x6d\x39\xcc\xc7\x11\x2c\xd0"
+
+Digest HashOne(ConstByteSpan message) {
+  Context ctx;
+  Init(ctx);
+  Update(ctx, message);
+  Digest digest;
+  Final(ctx, digest);
+  return digest;
+}
+
+// Fills a buffer with a pattern that differs between messages.
+template <size_t kSize>
+std::array<std::byte, kSize> MakeMessage(int seed) {
+  std::array<std::byte, kSize> message;
+  for (size_t i = 0; i < kSize; ++i) {
+    message[i] = static_cast<std::byte>(i * 13 + static_cast<size_t>(seed));
+  }
+  return message;
+}
+
+TEST(Sha256Native, ComputesTestVectors) {
+  Digest digest = HashOne(AS_BYTES("abc"));
+  EXPECT_EQ(0, std::memcmp(digest.data(), SHA256_HASH_OF_ABC, 32));
+
+  digest = HashOne(AS_BYTES(TWO_BLOCK_MESSAGE));
+  EXPECT_EQ(0,
+            std::memcmp(digest.data(), SHA256_HASH_OF_TWO_BLOCK_MESSAGE, 32));
+}
+
+TEST(Sha256Native, ComputesLongMessageInUnalignedChunks) {
+  std::array<std::byte, 1000> chunk;
+  chunk.fill(std::byte{'a'});
+
+  Context ctx;
+  Init(ctx);
+  // Chunks of 1, 2, ... 999 bytes, then the rest of the million bytes.
+  size_t total = 0;
+  for (size_t size = 1; size < chunk.size(); ++size) {
+    Update(ctx, span(chunk).first(size));
+    total += size;
+  }
+  for (; total < 1000000; total += chunk.size()) {
+    const size_t size = std::min(chunk.size(), 1000000 - total);
+    Update(ctx, span(chunk).first(size));
+  }
+
+  Digest digest;
+  Final(ctx, digest);
+  EXPECT_EQ(0, std::memcmp(digest.data(), SHA256_HASH_OF_MILLION_A, 32));
+}
+
+TEST(Sha256Native, ReportsImplementation) {
+  const char* name = Implementation();
+  EXPECT_TRUE(std::strcmp(name, "sha-ni") == 0 ||
+              std::strcmp(name, "armv8-ce") == 0 ||
+              std::strcmp(name, "portable") == 0);
+}
+
+TEST(Sha256MultiBuffer, MatchesSingleBufferForAllLengths) {
+  const auto data = MakeMessage<300>(0);
+
+  // Hash messages of every length up to 300 bytes, four at a time.
+  for (size_t length = 0; length + 3 < data.size(); length += 4) {
+    const ConstByteSpan messages[] = {
+        span(data).first(length),
+        span(data).first(length + 1),
+        span(data).first(length + 2),
+        span(data).first(length + 3),
+    };
+    Digest digests[MultiBuffer::kLanes];
+    const ByteSpan outputs[] = {digests[0], digests[1], digests[2], digests[3]};
+
+    MultiBuffer hasher;
+    ASSERT_EQ(OkStatus(), hasher.Update(messages));
+    ASSERT_EQ(OkStatus(), hasher.Final(outputs));
+
+    for (size_t i = 0; i < MultiBuffer::kLanes; ++i) {
+      EXPECT_EQ(HashOne(messages[i]), digests[i]) << "length " << length + i;
+    }
+  }
+}
+
+TEST(Sha256MultiBuffer, StreamsChunksOfDifferentSizes) {
+  const auto a = MakeMessage<1000>(1);
+  const auto b = MakeMessage<700>(2);
+  const auto c = MakeMessage<64>(3);
+
+  MultiBuffer hasher;
+  const size_t kChunkSizes[] = {1, 63, 64, 65, 127, 200, 500};
+  size_t offsets[3] = {};
+  for (size_t chunk_size : kChunkSizes) {
+    const ConstByteSpan chunks[] = {
+        span(a).subspan(offsets[0],
+                        std::min(chunk_size, a.size() - offsets[0])),
+        span(b).subspan(offsets[1],
+                        std::min(chunk_size / 2, b.size() - offsets[1])),
+        span(c).subspan(offsets[2],
+                        std::min(chunk_size, c.size() - offsets[2])),
+    };
+    ASSERT_EQ(OkStatus(), hasher.Update(chunks));
+    for (size_t i = 0; i < 3; ++i) {
+      offsets[i] += chunks[i].size();
+    }
+  }
+  const ConstByteSpan rest[] = {
+      span(a).subspan(offsets[0]),
+      span(b).subspan(offsets[1]),
+      span(c).subspan(offsets[2]),
+  };
+  ASSERT_EQ(OkStatus(), hasher.Update(rest));
+
+  Digest digests[3];
+  const ByteSpan outputs[] = {digests[0], digests[1], digests[2]};
+  ASSERT_EQ(OkStatus(), hasher.Final(outputs));
+  EXPECT_EQ(HashOne(a), digests[0]);
+  EXPECT_EQ(HashOne(b), digests[1]);
+  EXPECT_EQ(HashOne(c), digests[2]);
+}
+
+TEST(Sha256MultiBuffer, RejectsTooManyLanes) {
+  const ConstByteSpan chunks[MultiBuffer::kLanes + 1] = {};
+  Digest digests[MultiBuffer::kLanes + 1];
+  ByteSpan outputs[MultiBuffer::kLanes + 1];
+  for (size_t i = 0; i < std::size(outputs); ++i) {
+    outputs[i] = digests[i];
+  }
+
+  MultiBuffer hasher;
+  EXPECT_EQ(Status::InvalidArgument(), hasher.Update(chunks));
+  EXPECT_EQ(Status::InvalidArgument(), hasher.Final(outputs));
+}
+
+TEST(Sha256MultiBuffer, RejectsSmallDigestBuffer) {
+  std::array<std::byte, 31> digest;
+  const ByteSpan outputs[] = {digest};
+  MultiBuffer hasher;
+  EXPECT_EQ(Status::InvalidArgument(), hasher.Final(outputs));
+}
+
+TEST(Sha256HashMultiple, HashesMoreMessagesThanLanes) {
+  const auto data = MakeMessage<4096>(4);
+  ConstByteSpan messages[9];
+  Digest digests[9];
+  ByteSpan outputs[9];
+  for (size_t i = 0; i < std::size(messages); ++i) {
+    messages[i] = span(data).first(i * 500);
+    outputs[i] = digests[i];
+  }
+
+  ASSERT_EQ(OkStatus(), HashMultiple(messages, outputs));
+  for (size_t i = 0; i < std::size(messages); ++i) {
+    EXPECT_EQ(HashOne(messages[i]), digests[i]);
+  }
+
+  EXPECT_EQ(Status::InvalidArgument(),
+            HashMultiple(messages, span(outputs).first(8)));
+}
+
+}  // namespace
+}  // namespace pw::crypto::sha256::native
@@ -0,0 +1,69 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+
+#include "pw_crypto/sha256.h"
+#include "pw_crypto/sha256_native.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw::crypto::sha256 {
+namespace {
+
+// Each iteration hashes kMessages messages of kMessageSize bytes, so the
+// throughput in MB/s is (kMessages * kMessageSize) / (ns per iteration) * 1000.
+constexpr size_t kMessageSize = 16 * 1024;
+constexpr size_t kMessages = native::MultiBuffer::kLanes;
+
+std::array<std::array<std::byte, kMessageSize>, kMessages> messages;
+std::array<std::array<std::byte, kDigestSizeBytes>, kMessages> digests;
+
+// Hashes each message with the selected pw_crypto backend, such as mbedTLS.
+void HashWithBackend(perf_test::State& state) {
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < kMessages; ++i) {
+      Hash(messages[i], digests[i]).IgnoreError();
+    }
+  }
+}
+
+// Hashes each message in turn with the native implementation.
+void HashWithNative(perf_test::State& state) {
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < kMessages; ++i) {
+      native::Context ctx;
+      native::Init(ctx);
+      native::Update(ctx, messages[i]);
+      native::Final(ctx, digests[i]);
+    }
+  }
+}
+
+// Hashes the messages in lockstep with the native multi-buffer API.
+void HashWithNativeMultiBuffer(perf_test::State& state) {
+  const ConstByteSpan inputs[] = {
+      messages[0], messages[1], messages[2], messages[3]};
+  const ByteSpan outputs[] = {digests[0], digests[1], digests[2], digests[3]};
+  while (state.KeepRunning()) {
+    native::HashMultiple(inputs, outputs).IgnoreError();
+  }
+}
+
+PW_PERF_TEST(Sha256Backend4x16KiB, HashWithBackend);
+PW_PERF_TEST(Sha256Native4x16KiB, HashWithNative);
+PW_PERF_TEST(Sha256NativeMultiBuffer4x16KiB, HashWithNativeMultiBuffer);
+
+}  // namespace
+}  // namespace pw::crypto::sha256
@@ -0,0 +1,176 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Finds the characters in a block of JSON that the reader needs to know about.
+// The vector versions compare 16 characters at a time against each character
+// of interest and pack the results into one bit per character.
+
+#include "pw_json_private/classify.h"
+
+#if PW_JSON_SIMD
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif  // defined(__x86_64__)
+#else
+#include <array>
+#endif  // PW_JSON_SIMD
+
+namespace pw::json_impl {
+
+#if PW_JSON_SIMD && defined(__x86_64__)
+
+namespace {
+
+uint64_t ToBits(__m128i matches, int chunk) {
+  return uint64_t{static_cast<uint16_t>(_mm_movemask_epi8(matches))}
+         << (16 * chunk);
+}
+
+__m128i Equal(__m128i chars, char c) {
+  return _mm_cmpeq_epi8(chars, _mm_set1_epi8(c));
+}
+
+}  // namespace
+
+CharacterMasks ClassifyBlock(const char* block) {
+  CharacterMasks masks{};
+
+  for (int chunk = 0; chunk < 4; ++chunk) {
+    const __m128i chars = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(block + 16 * chunk));
+
+    // Setting bit 5 maps [ and ] to { and }, and no other characters to them.
+    const __m128i folded = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    const __m128i operators =
+        _mm_or_si128(_mm_or_si128(Equal(folded, '{'), Equal(folded, '}')),
+                     _mm_or_si128(Equal(chars, ':'), Equal(chars, ',')));
+    const __m128i whitespace =
+        _mm_or_si128(_mm_or_si128(Equal(chars, ' '), Equal(chars, '\t')),
+                     _mm_or_si128(Equal(chars, '\n'), Equal(chars, '\r')));
+    const __m128i controls = _mm_cmpeq_epi8(
+        _mm_min_epu8(chars, _mm_set1_epi8(0x1f)), chars);
+
+    masks.quotes |= ToBits(Equal(chars, '"'), chunk);
+    masks.backslashes |= ToBits(Equal(chars, '\\'), chunk);
+    masks.operators |= ToBits(operators, chunk);
+    masks.whitespace |= ToBits(whitespace, chunk);
+    masks.controls |= ToBits(controls, chunk);
+  }
+  return masks;
+}
+
+#elif PW_JSON_SIMD && defined(__aarch64__)
+
+namespace {
+
+// Packs four vectors of 0x00 or 0xff bytes into 64 bits.
+uint64_t ToBits(const uint8x16_t (&matches)[4]) {
+  const uint8x16_t weights = {1, 2, 4, 8, 16, 32, 64, 128,
+                              1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t sum0 = vpaddq_u8(vandq_u8(matches[0], weights),
+                              vandq_u8(matches[1], weights));
+  const uint8x16_t sum1 = vpaddq_u8(vandq_u8(matches[2], weights),
+                                    vandq_u8(matches[3], weights));
+  sum0 = vpaddq_u8(sum0, sum1);
+  sum0 = vpaddq_u8(sum0, sum0);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+uint8x16_t Equal(uint8x16_t chars, char c) {
+  return vceqq_u8(chars, vdupq_n_u8(static_cast<uint8_t>(c)));
+}
+
+}  // namespace
+
+CharacterMasks ClassifyBlock(const char* block) {
+  uint8x16_t quotes[4];
+  uint8x16_t backslashes[4];
+  uint8x16_t operators[4];
+  uint8x16_t whitespace[4];
+  uint8x16_t controls[4];
+
+  for (int chunk = 0; chunk < 4; ++chunk) {
+    const uint8x16_t chars =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(block + 16 * chunk));
+
+    // Setting bit 5 maps [ and ] to { and }, and no other characters to them.
+    const uint8x16_t folded = vorrq_u8(chars, vdupq_n_u8(0x20));
+    quotes[chunk] = Equal(chars, '"');
+    backslashes[chunk] = Equal(chars, '\\');
+    operators[chunk] =
+        vorrq_u8(vorrq_u8(Equal(folded, '{'), Equal(folded, '}')),
+                 vorrq_u8(Equal(chars, ':'), Equal(chars, ',')));
+    whitespace[chunk] =
+        vorrq_u8(vorrq_u8(Equal(chars, ' '), Equal(chars, '\t')),
+                 vorrq_u8(Equal(chars, '\n'), Equal(chars, '\r')));
+    controls[chunk] = vcleq_u8(chars, vdupq_n_u8(0x1f));
+  }
+
+  return CharacterMasks{ToBits(quotes),
+                        ToBits(backslashes),
+                        ToBits(operators),
+                        ToBits(whitespace),
+                        ToBits(controls)};
+}
+
+#else
+
+namespace {
+
+enum CharacterClass : uint8_t {
+  kQuote = 1 << 0,
+  kBackslash = 1 << 1,
+  kOperator = 1 << 2,
+  kWhitespace = 1 << 3,
+  kControl = 1 << 4,
+};
+
+constexpr std::array<uint8_t, 256> kClasses = [] {
+  std::array<uint8_t, 256> classes{};
+  for (size_t i = 0; i < 0x20; ++i) {
+    classes[i] = kControl;
+  }
+  classes['"'] = kQuote;
+  classes['\\'] = kBackslash;
+  for (char c : {'{', '}', '[', ']', ':', ','}) {
+    classes[static_cast<uint8_t>(c)] = kOperator;
+  }
+  classes[' '] = kWhitespace;
+  for (char c : {'\t', '\n', '\r'}) {
+    classes[static_cast<uint8_t>(c)] = kWhitespace | kControl;
+  }
+  return classes;
+}();
+
+}  // namespace
+
+CharacterMasks ClassifyBlock(const char* block) {
+  CharacterMasks masks{};
+
+  for (size_t i = 0; i < kBlockSize; ++i) {
+    const uint64_t c = kClasses[static_cast<uint8_t>(block[i])];
+    masks.quotes |= (c & 1) << i;
+    masks.backslashes |= ((c >> 1) & 1) << i;
+    masks.operators |= ((c >> 2) & 1) << i;
+    masks.whitespace |= ((c >> 3) & 1) << i;
+    masks.controls |= ((c >> 4) & 1) << i;
+  }
+  return masks;
+}
+
+#endif  // PW_JSON_SIMD && defined(__x86_64__)
+
+}  // namespace pw::json_impl
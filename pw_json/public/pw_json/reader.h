@@ -0,0 +1,263 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+/// @file pw_json/reader.h
+///
+/// `pw::JsonReader` is a pull parser for JSON in memory. Each call to `Next()`
+/// reads one token: the start or end of an array or object, an object key, or
+/// a value. Tokens refer to the original JSON, so reading never copies or
+/// allocates. The grammar is checked as the JSON is read, and `Next()` returns
+/// an error at the first problem.
+///
+/// The reader finds strings and structural characters 64 bytes at a time, in
+/// the style of simdjson, using SSE2 or NEON where available. Most of the JSON,
+/// including the contents of strings, is only examined by this scan.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_status/try.h"
+
+namespace pw {
+
+/// @defgroup pw_json_reader_api
+/// @{
+
+/// The kinds of tokens `JsonReader` reads.
+enum class JsonToken : uint8_t {
+  kObjectStart,  ///< `{`
+  kObjectEnd,    ///< `}`
+  kArrayStart,   ///< `[`
+  kArrayEnd,     ///< `]`
+  kKey,          ///< An object key, which is always followed by its value
+  kString,
+  kNumber,
+  kTrue,
+  kFalse,
+  kNull,
+};
+
+/// Reads a JSON value token by token. For example:
+///
+/// @code{.cpp}
+///   pw::JsonReader reader(R"({"id": 7, "tags": ["a", "b"]})");
+///   pw::Status status;
+///   while ((status = reader.Next()).ok()) {
+///     if (reader.token() == pw::JsonToken::kKey && reader.value() == "id") {
+///       PW_TRY(reader.Next());
+///       PW_TRY_ASSIGN(id, reader.ReadInteger<uint32_t>());
+///     }
+///   }
+///   if (!status.IsOutOfRange()) {
+///     return status;  // The JSON was malformed.
+///   }
+/// @endcode
+class JsonReader {
+ public:
+  /// Arrays and objects may be nested at most 64 levels deep.
+  static constexpr size_t kMaxDepth = 64;
+
+  /// Reads the JSON in `json`, which must outlive the reader.
+  constexpr explicit JsonReader(std::string_view json) : json_(json) {}
+
+  JsonReader(const JsonReader&) = delete;
+  JsonReader& operator=(const JsonReader&) = delete;
+
+  /// Reads the next token. After an error, every call returns the same error.
+  ///
+  /// @returns @rst
+  ///
+  /// .. pw-status-codes::
+  ///
+  ///    OK: A token was read.
+  ///
+  ///    OUT_OF_RANGE: The JSON value is complete and there are no more tokens.
+  ///
+  ///    DATA_LOSS: The JSON is malformed or ends early.
+  ///
+  ///    RESOURCE_EXHAUSTED: Arrays and objects are nested more than
+  ///    `kMaxDepth` levels deep.
+  ///
+  /// @endrst
+  Status Next();
+
+  /// The kind of the token that was read last.
+  JsonToken token() const { return token_; }
+
+  /// The text of the last token in the JSON. For keys and strings, this is the
+  /// text between the quotes, which still contains any escape sequences. For
+  /// numbers, `true`, `false`, and `null`, this is the text of the value. For
+  /// arrays and objects, this is the bracket or brace.
+  std::string_view value() const { return value_; }
+
+  /// True if the last key or string contains escape sequences, in which case
+  /// `ReadString` must be used to get its characters.
+  bool has_escapes() const { return has_escapes_; }
+
+  /// The number of arrays and objects that enclose the next token.
+  size_t depth() const { return depth_; }
+
+  /// The offset of the last token in the JSON, or of the error if `Next()`
+  /// failed with @pw_status{DATA_LOSS}.
+  size_t offset() const { return offset_; }
+
+  /// If the last token started an array or object, reads through its end.
+  /// Otherwise, does nothing. Returns the same errors as `Next()`, except that
+  /// @pw_status{OK} is returned at the end of the JSON.
+  Status Skip();
+
+  /// Copies the last key or string to `buffer` with escape sequences
+  /// replaced by the characters they represent. `\u` escapes are written as
+  /// UTF-8. The result is not null-terminated.
+  ///
+  /// @returns @rst
+  ///
+  /// .. pw-status-codes::
+  ///
+  ///    OK: The string was copied. Returns its size.
+  ///
+  ///    RESOURCE_EXHAUSTED: The string does not fit in the buffer. Returns
+  ///    the number of characters that were written.
+  ///
+  ///    DATA_LOSS: The string has a `\u` escape for half of a UTF-16
+  ///    surrogate pair without the other half.
+  ///
+  ///    FAILED_PRECONDITION: The last token is not a key or string.
+  ///
+  /// @endrst
+  StatusWithSize ReadString(span<char> buffer) const;
+
+  /// Reads the last token as an integer of type `T`.
+  ///
+  /// @returns @rst
+  ///
+  /// .. pw-status-codes::
+  ///
+  ///    OK: Returns the integer.
+  ///
+  ///    INVALID_ARGUMENT: The number has a fraction or exponent.
+  ///
+  ///    OUT_OF_RANGE: The number does not fit in `T`.
+  ///
+  ///    FAILED_PRECONDITION: The last token is not a number.
+  ///
+  /// @endrst
+  template <typename T>
+  Result<T> ReadInteger() const;
+
+ private:
+  // What Next() expects to read.
+  enum State : uint8_t {
+    kValue,       // Start of the JSON, after ':', or after ',' in an array
+    kValueOrEnd,  // After '['
+    kKey,         // After ',' in an object
+    kKeyOrEnd,    // After '{'
+    kColon,       // After a key
+    kCommaOrEnd,  // After a value in an array or object
+    kDone,        // After the top-level value
+  };
+
+  static constexpr size_t kNoPosition = std::numeric_limits<size_t>::max();
+
+  // Returns the position of the next structural character: an operator, a
+  // quote that starts or ends a string, or the first character of a number or
+  // literal. Returns kNoPosition at the end of the JSON or if scanning failed.
+  size_t NextStructural();
+
+  // Finds the structural characters in the next block.
+  void ScanBlock();
+
+  // Finds characters that are escaped by a backslash.
+  uint64_t FindEscaped(uint64_t backslashes);
+
+  Status ReadKey(size_t position);
+  Status ReadValue(size_t position);
+  Status ReadEnd(size_t position);
+  bool ReadQuoted(size_t position);
+  bool ReadAtom(size_t position);
+
+  void SetToken(JsonToken token, size_t position, std::string_view value) {
+    token_ = token;
+    offset_ = position;
+    value_ = value;
+  }
+
+  bool in_object() const {
+    return ((objects_ >> (depth_ - 1u)) & 1u) != 0u;
+  }
+
+  void EndValue() { state_ = depth_ == 0u ? kDone : kCommaOrEnd; }
+
+  Status Fail(size_t position);
+
+  Result<int64_t> ReadInt64() const;
+  Result<uint64_t> ReadUint64() const;
+
+  std::string_view json_;
+
+  // Scanner state. The carried values are from the end of the previous block.
+  size_t block_ = 0;          // Offset of the block structurals_ is from
+  size_t next_block_ = 0;     // Offset of the next block to scan
+  uint64_t structurals_ = 0;  // Unread structural characters in the block
+  uint64_t backslashes_ = 0;  // Backslashes in the block
+  uint64_t in_string_ = 0;    // All ones if the block ended inside a string
+  uint64_t escaped_ = 0;      // 1 if the block ended with an escape
+  uint64_t scalar_ = 0;       // 1 if the block ended inside a number/literal
+
+  // Parser state.
+  Status status_;
+  State state_ = kValue;
+  JsonToken token_ = JsonToken::kNull;
+  bool has_escapes_ = false;
+  uint8_t depth_ = 0;
+  uint64_t objects_ = 0;  // Bit i is set if depth i is an object
+  size_t offset_ = 0;
+  std::string_view value_;
+};
+
+/// @}
+
+template <typename T>
+Result<T> JsonReader::ReadInteger() const {
+  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                "ReadInteger requires an integer type");
+  if constexpr (std::is_signed_v<T>) {
+    PW_TRY_ASSIGN(const int64_t value, ReadInt64());
+    if constexpr (sizeof(T) < sizeof(int64_t)) {
+      if (value < std::numeric_limits<T>::min() ||
+          value > std::numeric_limits<T>::max()) {
+        return Status::OutOfRange();
+      }
+    }
+    return static_cast<T>(value);
+  } else {
+    PW_TRY_ASSIGN(const uint64_t value, ReadUint64());
+    if constexpr (sizeof(T) < sizeof(uint64_t)) {
+      if (value > std::numeric_limits<T>::max()) {
+        return Status::OutOfRange();
+      }
+    }
+    return static_cast<T>(value);
+  }
+}
+
+}  // namespace pw
@@ -0,0 +1,439 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+/// @file pw_json/stream_writer.h
+///
+/// `pw::JsonStreamWriter` serializes JSON to a `pw::stream::Writer` as it is
+/// built, so the size of the JSON is not limited by a buffer. Output is
+/// collected in a small buffer and written to the stream when the buffer fills.
+///
+/// `JsonStreamWriter` has the same `Add`, `Append`, and nesting functions as
+/// `pw::JsonBuilder` and produces the same JSON. Since data that was written
+/// to the stream cannot be changed, arrays and objects are closed as they are
+/// finished rather than on every update:
+///
+/// - Writing to an array or object closes any arrays or objects nested in it.
+///   The handles for those nested structures are invalidated; using them fails
+///   an assertion.
+/// - `Finish()` closes the remaining arrays and objects and flushes the buffer.
+///   The JSON is incomplete until `Finish()` is called.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "pw_assert/assert.h"
+#include "pw_json/builder.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw {
+namespace json_impl {
+
+// Identifies an open array or object in a JsonStreamWriter.
+struct StreamLevel {
+  uint8_t depth;  // Index of the structure; the top-level array or object is 0
+  uint16_t id;    // Distinguishes structures at the same depth
+};
+
+}  // namespace json_impl
+
+/// @defgroup pw_json_stream_writer_api
+/// @{
+
+class JsonStreamWriter;
+class JsonStreamObject;
+
+/// A JSON array that is being written by a `JsonStreamWriter`. Provides
+/// functions for appending values to the array.
+///
+/// A `JsonStreamArray` is invalidated when the array or object that encloses
+/// it is updated or when `JsonStreamWriter::Finish()` is called. Attempting to
+/// append to an invalidated array fails an assertion.
+class [[nodiscard]] JsonStreamArray {
+ public:
+  JsonStreamArray(const JsonStreamArray&) = delete;
+  JsonStreamArray& operator=(const JsonStreamArray&) = delete;
+
+  constexpr JsonStreamArray(JsonStreamArray&&) = default;
+  constexpr JsonStreamArray& operator=(JsonStreamArray&&) = default;
+
+  /// Appends a value to the array. Accepts the same types as
+  /// `JsonArray::Append`.
+  template <typename T>
+  JsonStreamArray& Append(const T& value);
+
+  /// Appends a nested array to this array.
+  JsonStreamArray AppendNestedArray();
+
+  /// Appends a nested object to this array.
+  JsonStreamObject AppendNestedObject();
+
+  /// Appends all elements from an iterable container. Unlike
+  /// `JsonArray::Extend`, elements that were written before an error are not
+  /// reverted.
+  template <typename Iterable>
+  JsonStreamArray& Extend(const Iterable& iterable);
+
+  /// Appends all elements from an array.
+  template <typename T, size_t kSize>
+  JsonStreamArray& Extend(const T (&iterable)[kSize]);
+
+  /// Returns the status of the `JsonStreamWriter`.
+  [[nodiscard]] bool ok() const;
+  Status status() const;
+
+ private:
+  friend class JsonStreamWriter;
+  friend class JsonStreamObject;
+
+  constexpr JsonStreamArray(JsonStreamWriter& writer,
+                            json_impl::StreamLevel level)
+      : writer_(&writer), level_(level) {}
+
+  JsonStreamWriter* writer_;
+  json_impl::StreamLevel level_;
+};
+
+/// A JSON object that is being written by a `JsonStreamWriter`. Provides
+/// functions for adding key-value pairs to the object.
+///
+/// A `JsonStreamObject` is invalidated when the array or object that encloses
+/// it is updated or when `JsonStreamWriter::Finish()` is called. Attempting to
+/// add to an invalidated object fails an assertion.
+class [[nodiscard]] JsonStreamObject {
+ public:
+  JsonStreamObject(const JsonStreamObject&) = delete;
+  JsonStreamObject& operator=(const JsonStreamObject&) = delete;
+
+  constexpr JsonStreamObject(JsonStreamObject&&) = default;
+  constexpr JsonStreamObject& operator=(JsonStreamObject&&) = default;
+
+  /// Adds a key-value pair to the object. Accepts the same types as
+  /// `JsonObject::Add`.
+  template <typename T>
+  JsonStreamObject& Add(std::string_view key, const T& value);
+
+  template <typename T>
+  JsonStreamObject& Add(std::nullptr_t, const T& value) = delete;
+
+  /// Adds a nested array to this object.
+  JsonStreamArray AddNestedArray(std::string_view key);
+
+  /// Adds a nested object to this object.
+  JsonStreamObject AddNestedObject(std::string_view key);
+
+  /// Returns the status of the `JsonStreamWriter`.
+  [[nodiscard]] bool ok() const;
+  Status status() const;
+
+ private:
+  friend class JsonStreamWriter;
+  friend class JsonStreamArray;
+
+  constexpr JsonStreamObject(JsonStreamWriter& writer,
+                             json_impl::StreamLevel level)
+      : writer_(&writer), level_(level) {}
+
+  JsonStreamWriter* writer_;
+  json_impl::StreamLevel level_;
+};
+
+/// Writes a single JSON value, array, or object to a `pw::stream::Writer`.
+/// Serialized JSON is collected in a caller-provided buffer, which is written
+/// to the stream when it fills and when `Finish()` is called. Larger buffers
+/// make fewer, larger stream writes.
+///
+/// If writing to the stream fails, the JSON written so far is incomplete, so
+/// all further output is discarded and the status holds the stream's error.
+class JsonStreamWriter {
+ public:
+  /// Arrays and objects may be nested at most 17 levels deep, as in
+  /// `JsonBuilder`.
+  static constexpr size_t kMaxDepth = 17;
+
+  /// Writes JSON to `writer`, using `buffer` to collect output between stream
+  /// writes. `buffer` must not be empty.
+  JsonStreamWriter(stream::Writer& writer, span<char> buffer);
+
+  JsonStreamWriter(const JsonStreamWriter&) = delete;
+  JsonStreamWriter& operator=(const JsonStreamWriter&) = delete;
+
+  /// True if @cpp_func{status} is @pw_status{OK}; no errors have occurred.
+  [[nodiscard]] bool ok() const { return status_.ok(); }
+
+  /// Returns the first error returned by the stream, or @pw_status{OK} if all
+  /// writes have succeeded. Since output is buffered, a failed write may not
+  /// be reported until the buffer is flushed.
+  Status status() const { return status_; }
+
+  /// Writes a single JSON value: a string, integer, float, boolean, `null`, or
+  /// serialized JSON from a `JsonBuilder`. Flushes the buffer and returns the
+  /// status.
+  ///
+  /// Only one of `SetValue`, `StartArray`, or `StartObject` may be called.
+  template <typename T>
+  Status SetValue(const T& value);
+
+  /// Starts the top-level JSON array. For example:
+  ///
+  /// @code{.cpp}
+  ///   writer.StartArray().Append("item1").Append(2).Extend({"3", "4", "5"});
+  ///   PW_TRY(writer.Finish());
+  /// @endcode
+  JsonStreamArray StartArray();
+
+  /// Starts the top-level JSON object. For example:
+  ///
+  /// @code{.cpp}
+  ///   JsonStreamObject object = writer.StartObject();
+  ///   object.Add("key1", 1).Add("key2", "val2");
+  ///   object.AddNestedArray("list").Append(1).Append(2);
+  ///   object.Add("another", "entry");
+  ///   PW_TRY(writer.Finish());
+  /// @endcode
+  JsonStreamObject StartObject();
+
+  /// Closes all open arrays and objects, writes any buffered output to the
+  /// stream, and returns the status.
+  ///
+  /// @returns @rst
+  ///
+  /// .. pw-status-codes::
+  ///
+  ///    OK: The JSON was written to the stream.
+  ///
+  ///    Other: The error returned by the first failed stream write.
+  ///
+  /// @endrst
+  Status Finish();
+
+ private:
+  friend class JsonStreamArray;
+  friend class JsonStreamObject;
+
+  enum Type : bool { kArray = false, kObject = true };
+
+  // Opens a top-level or nested array or object.
+  json_impl::StreamLevel Open(Type type);
+
+  // Closes arrays and objects until depth_ is `depth`.
+  void CloseTo(size_t depth);
+
+  // Checks that `level` is still open, closes structures nested in it, and
+  // writes the separator before a new item. Returns false if output is being
+  // discarded.
+  [[nodiscard]] bool StartItem(json_impl::StreamLevel level);
+
+  // Starts an item and writes the object key. Returns false if output is
+  // being discarded.
+  [[nodiscard]] bool StartEntry(json_impl::StreamLevel level,
+                                std::string_view key);
+
+  template <typename T>
+  void ArrayAppend(json_impl::StreamLevel level, const T& value) {
+    if (StartItem(level)) {
+      WriteValue(value);
+    }
+  }
+
+  template <typename T>
+  void ObjectAdd(json_impl::StreamLevel level,
+                 std::string_view key,
+                 const T& value) {
+    if (StartEntry(level, key)) {
+      WriteValue(value);
+    }
+  }
+
+  json_impl::StreamLevel ArrayAppendNested(json_impl::StreamLevel level,
+                                           Type type) {
+    static_cast<void>(StartItem(level));
+    return Open(type);
+  }
+
+  json_impl::StreamLevel ObjectAddNested(json_impl::StreamLevel level,
+                                         std::string_view key,
+                                         Type type) {
+    static_cast<void>(StartEntry(level, key));
+    return Open(type);
+  }
+
+  template <typename T>
+  void WriteValue(const T& value);
+
+  void WriteQuotedString(std::string_view value);
+  void WriteCharPointer(const char* value);
+  void WriteInteger(int64_t value);
+  void WriteInteger(uint64_t value);
+  void WriteFloat(float value);
+
+  template <typename T>
+  void WriteNumber(T value);
+
+  // Copies characters to the buffer, flushing as needed.
+  void Write(std::string_view data) {
+    if (data.size() <= remaining()) {
+      data.copy(buffer_.data() + buffered_, data.size());
+      buffered_ += data.size();
+    } else {
+      WriteLarge(data);
+    }
+  }
+
+  void Write(char c) {
+    if (buffered_ == buffer_.size()) {
+      Flush();
+    }
+    buffer_[buffered_++] = c;
+  }
+
+  // Writes data that does not fit in the remaining buffer space.
+  void WriteLarge(std::string_view data);
+
+  size_t remaining() const { return buffer_.size() - buffered_; }
+
+  // Writes the buffered characters to the stream.
+  void Flush();
+
+  // Writes to the stream unless an earlier write failed.
+  void WriteToStream(std::string_view data);
+
+  stream::Writer& writer_;
+  span<char> buffer_;
+  size_t buffered_ = 0;
+  Status status_;
+
+  bool started_ = false;
+  uint8_t depth_ = 0;          // Number of open arrays and objects
+  uint32_t types_ = 0;         // Bit i is set if level i is an object
+  uint32_t has_items_ = 0;     // Bit i is set if level i has an item
+  uint16_t next_id_ = 0;       // ID for the next array or object
+  uint16_t ids_[kMaxDepth]{};  // IDs of the open arrays and objects
+};
+
+/// A `JsonStreamWriter` with an integrated buffer of `kBufferSize` characters.
+template <size_t kBufferSize>
+class JsonStreamBuffer final : public JsonStreamWriter {
+ public:
+  static_assert(kBufferSize > 0u, "The buffer must not be empty");
+
+  explicit JsonStreamBuffer(stream::Writer& writer)
+      : JsonStreamWriter(writer, buffer_) {}
+
+ private:
+  char buffer_[kBufferSize];
+};
+
+/// @}
+
+// Template and inline function definitions.
+
+template <typename T>
+Status JsonStreamWriter::SetValue(const T& value) {
+  PW_ASSERT(!started_);  // The JSON was already started
+  started_ = true;
+  WriteValue(value);
+  Flush();
+  return status();
+}
+
+template <typename T>
+void JsonStreamWriter::WriteValue(const T& value) {
+  if constexpr (json_impl::kIsJson<T>) {  // serialized JsonBuilder JSON
+    Write(std::string_view(value));
+  } else if constexpr (std::is_null_pointer_v<T> ||  // nullptr & C strings
+                       std::is_same_v<T, char*> ||
+                       std::is_same_v<T, const char*>) {
+    WriteCharPointer(value);
+  } else if constexpr (std::is_convertible_v<T, std::string_view>) {  // strings
+    WriteQuotedString(value);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    WriteFloat(static_cast<float>(value));
+  } else if constexpr (std::is_same_v<T, bool>) {  // boolean
+    Write(value ? std::string_view("true") : std::string_view("false"));
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    WriteInteger(static_cast<int64_t>(value));
+  } else if constexpr (std::is_integral_v<T>) {
+    WriteInteger(static_cast<uint64_t>(value));
+  } else {
+    static_assert(json_impl::InvalidJsonType<T>(),
+                  "JSON values may only be numbers, strings, JSON arrays, JSON "
+                  "objects, or null");
+  }
+}
+
+template <typename T>
+JsonStreamArray& JsonStreamArray::Append(const T& value) {
+  writer_->ArrayAppend(level_, value);
+  return *this;
+}
+
+inline JsonStreamArray JsonStreamArray::AppendNestedArray() {
+  return JsonStreamArray(
+      *writer_, writer_->ArrayAppendNested(level_, JsonStreamWriter::kArray));
+}
+
+template <typename Iterable>
+JsonStreamArray& JsonStreamArray::Extend(const Iterable& iterable) {
+  for (const auto& value : iterable) {
+    Append(value);
+  }
+  return *this;
+}
+
+template <typename T, size_t kSize>
+JsonStreamArray& JsonStreamArray::Extend(const T (&iterable)[kSize]) {
+  for (const T& value : iterable) {
+    Append(value);
+  }
+  return *this;
+}
+
+inline bool JsonStreamArray::ok() const { return writer_->ok(); }
+
+inline Status JsonStreamArray::status() const { return writer_->status(); }
+
+template <typename T>
+JsonStreamObject& JsonStreamObject::Add(std::string_view key, const T& value) {
+  writer_->ObjectAdd(level_, key, value);
+  return *this;
+}
+
+inline JsonStreamArray JsonStreamObject::AddNestedArray(std::string_view key) {
+  return JsonStreamArray(*writer_,
+                         writer_->ObjectAddNested(
+                             level_, key, JsonStreamWriter::kArray));
+}
+
+inline JsonStreamObject JsonStreamObject::AddNestedObject(
+    std::string_view key) {
+  return JsonStreamObject(*writer_,
+                          writer_->ObjectAddNested(
+                              level_, key, JsonStreamWriter::kObject));
+}
+
+inline bool JsonStreamObject::ok() const { return writer_->ok(); }
+
+inline Status JsonStreamObject::status() const { return writer_->status(); }
+
+inline JsonStreamObject JsonStreamArray::AppendNestedObject() {
+  return JsonStreamObject(
+      *writer_, writer_->ArrayAppendNested(level_, JsonStreamWriter::kObject));
+}
+
+}  // namespace pw
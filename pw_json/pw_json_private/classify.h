@@ -0,0 +1,48 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Blocks are classified with SSE2 on x86-64 and with NEON on AArch64. Define
+// this to 0 to use only the portable code.
+#ifndef PW_JSON_SIMD
+#if (defined(__x86_64__) && defined(__SSE2__)) || \
+    (defined(__aarch64__) && defined(__ARM_NEON))
+#define PW_JSON_SIMD 1
+#else
+#define PW_JSON_SIMD 0
+#endif
+#endif  // PW_JSON_SIMD
+
+namespace pw::json_impl {
+
+// JsonReader scans its input in blocks of this many characters.
+inline constexpr size_t kBlockSize = 64;
+
+// Bitmasks of the characters in a block that matter to the JSON grammar. Bit i
+// corresponds to the character at index i.
+struct CharacterMasks {
+  uint64_t quotes;       // "
+  uint64_t backslashes;  // '\'
+  uint64_t operators;    // { } [ ] : ,
+  uint64_t whitespace;   // space, \t, \n, \r
+  uint64_t controls;     // 0x00 - 0x1f, which may not appear in strings
+};
+
+// Classifies the kBlockSize characters starting at `block`.
+CharacterMasks ClassifyBlock(const char* block);
+
+}  // namespace pw::json_impl
@@ -0,0 +1,557 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// JsonReader works in two layers, like simdjson's two stages. The scanner
+// classifies a 64-character block at a time into bitmasks and from them finds
+// the structural characters: operators outside of strings, the quotes around
+// strings, and the first character of each number or literal. Next() takes
+// one structural character at a time and checks it against the grammar.
+// Scanning is done one block ahead of the parser rather than for the whole
+// JSON, so no index of structural characters needs to be stored.
+
+#include "pw_json/reader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_json_private/classify.h"
+
+namespace pw {
+namespace {
+
+using json_impl::kBlockSize;
+
+size_t CountTrailingZeros(uint64_t bits) {
+  return static_cast<size_t>(__builtin_ctzll(bits));
+}
+
+// Sets each bit to the XOR of itself and all lower bits. For a mask of
+// quotes, this sets the bits from each opening quote up to its closing quote.
+constexpr uint64_t PrefixXor(uint64_t bits) {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+constexpr bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+constexpr uint8_t HexValue(char c) {
+  if (IsDigit(c)) {
+    return static_cast<uint8_t>(c - '0');
+  }
+  if (c >= 'a' && c <= 'f') {
+    return static_cast<uint8_t>(c - 'a' + 10);
+  }
+  if (c >= 'A' && c <= 'F') {
+    return static_cast<uint8_t>(c - 'A' + 10);
+  }
+  return 0xff;
+}
+
+// Characters that end a number or literal.
+constexpr bool IsDelimiter(char c) {
+  switch (c) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case ',':
+    case ':':
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+    case '"':
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Checks for -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+constexpr bool IsNumber(std::string_view text) {
+  size_t i = 0;
+  const auto digits = [&text, &i] {
+    const size_t start = i;
+    while (i < text.size() && IsDigit(text[i])) {
+      i += 1;
+    }
+    return i > start;
+  };
+
+  if (i < text.size() && text[i] == '-') {
+    i += 1;
+  }
+  if (i < text.size() && text[i] == '0') {
+    i += 1;
+  } else if (!digits()) {
+    return false;
+  }
+  if (i < text.size() && text[i] == '.') {
+    i += 1;
+    if (!digits()) {
+      return false;
+    }
+  }
+  if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+    i += 1;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+      i += 1;
+    }
+    if (!digits()) {
+      return false;
+    }
+  }
+  return i == text.size();
+}
+
+// Reads the 4 hex digits of a \u escape. Returns a value over 0xffff if they
+// are invalid.
+constexpr uint32_t ReadHex4(std::string_view text, size_t i) {
+  if (text.size() - i < 4) {
+    return 0x10000;
+  }
+  uint32_t value = 0;
+  for (size_t end = i + 4; i < end; ++i) {
+    const uint8_t digit = HexValue(text[i]);
+    if (digit > 0xf) {
+      return 0x10000;
+    }
+    value = (value << 4) | digit;
+  }
+  return value;
+}
+
+constexpr bool IsValidEscape(std::string_view text, size_t i) {
+  switch (text[i]) {
+    case '"':
+    case '\\':
+    case '/':
+    case 'b':
+    case 'f':
+    case 'n':
+    case 'r':
+    case 't':
+      return true;
+    case 'u':
+      return ReadHex4(text, i + 1) <= 0xffff;
+    default:
+      return false;
+  }
+}
+
+// Checks the escape sequences in a string. The scanner guarantees that every
+// backslash in a string is followed by another character.
+constexpr bool HasValidEscapes(std::string_view text) {
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\\') {
+      i += 1;
+      if (!IsValidEscape(text, i)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+constexpr char UnescapeCharacter(char c) {
+  switch (c) {
+    case 'b':
+      return '\b';
+    case 'f':
+      return '\f';
+    case 'n':
+      return '\n';
+    case 'r':
+      return '\r';
+    case 't':
+      return '\t';
+    default:
+      return c;  // " \ or /
+  }
+}
+
+// Writes a code point as UTF-8 and returns the number of bytes.
+size_t EncodeUtf8(uint32_t code_point, char* out) {
+  if (code_point < 0x80) {
+    out[0] = static_cast<char>(code_point);
+    return 1;
+  }
+  if (code_point < 0x800) {
+    out[0] = static_cast<char>(0xc0 | (code_point >> 6));
+    out[1] = static_cast<char>(0x80 | (code_point & 0x3f));
+    return 2;
+  }
+  if (code_point < 0x10000) {
+    out[0] = static_cast<char>(0xe0 | (code_point >> 12));
+    out[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+    out[2] = static_cast<char>(0x80 | (code_point & 0x3f));
+    return 3;
+  }
+  out[0] = static_cast<char>(0xf0 | (code_point >> 18));
+  out[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+  out[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+  out[3] = static_cast<char>(0x80 | (code_point & 0x3f));
+  return 4;
+}
+
+// Parses the digits of a number that has been checked with IsNumber.
+Result<uint64_t> ParseMagnitude(std::string_view digits) {
+  if (digits.find_first_of(".eE") != std::string_view::npos) {
+    return Status::InvalidArgument();
+  }
+  uint64_t value = 0;
+  for (char c : digits) {
+    const uint64_t digit = static_cast<uint64_t>(c - '0');
+    if (value > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+      return Status::OutOfRange();
+    }
+    value = value * 10 + digit;
+  }
+  return value;
+}
+
+}  // namespace
+
+Status JsonReader::Next() {
+  if (!status_.ok()) {
+    return status_;
+  }
+  size_t position = NextStructural();
+
+  switch (state_) {
+    case kDone:
+      if (position == kNoPosition) {
+        return status_.ok() ? Status::OutOfRange() : status_;
+      }
+      return Fail(position);  // There is more after the top-level value.
+    case kCommaOrEnd:
+      if (position == kNoPosition || json_[position] != ',') {
+        return ReadEnd(position);
+      }
+      state_ = in_object() ? kKey : kValue;
+      position = NextStructural();
+      break;
+    case kColon:
+      if (position == kNoPosition || json_[position] != ':') {
+        return Fail(position);
+      }
+      state_ = kValue;
+      position = NextStructural();
+      break;
+    case kValueOrEnd:
+    case kKeyOrEnd:
+      if (position != kNoPosition &&
+          (json_[position] == ']' || json_[position] == '}')) {
+        return ReadEnd(position);
+      }
+      state_ = state_ == kValueOrEnd ? kValue : kKey;
+      break;
+    case kValue:
+    case kKey:
+      break;
+  }
+
+  return state_ == kKey ? ReadKey(position) : ReadValue(position);
+}
+
+Status JsonReader::Skip() {
+  if (token_ != JsonToken::kObjectStart && token_ != JsonToken::kArrayStart) {
+    return status_;
+  }
+  const size_t depth = depth_ - 1u;
+  while (depth_ > depth) {
+    PW_TRY(Next());
+  }
+  return OkStatus();
+}
+
+StatusWithSize JsonReader::ReadString(span<char> buffer) const {
+  if (token_ != JsonToken::kKey && token_ != JsonToken::kString) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  if (!has_escapes_) {
+    const size_t size = std::min(value_.size(), buffer.size());
+    std::memcpy(buffer.data(), value_.data(), size);
+    return size == value_.size() ? StatusWithSize(size)
+                                 : StatusWithSize::ResourceExhausted(size);
+  }
+
+  size_t written = 0;
+  for (size_t i = 0; i < value_.size(); ++i) {
+    char utf8[4] = {value_[i]};
+    size_t size = 1;
+
+    if (value_[i] == '\\') {
+      i += 1;
+      if (value_[i] != 'u') {
+        utf8[0] = UnescapeCharacter(value_[i]);
+      } else {
+        uint32_t code_point = ReadHex4(value_, i + 1);
+        i += 4;
+        if (code_point >= 0xd800 && code_point <= 0xdbff) {
+          // A high surrogate must be followed by a low surrogate.
+          uint32_t low = 0;
+          if (i + 2 < value_.size() && value_[i + 1] == '\\' &&
+              value_[i + 2] == 'u') {
+            low = ReadHex4(value_, i + 3);
+          }
+          if (low < 0xdc00 || low > 0xdfff) {
+            return StatusWithSize::DataLoss(written);
+          }
+          code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+          i += 6;
+        } else if (code_point >= 0xdc00 && code_point <= 0xdfff) {
+          return StatusWithSize::DataLoss(written);
+        }
+        size = EncodeUtf8(code_point, utf8);
+      }
+    }
+
+    if (buffer.size() - written < size) {
+      return StatusWithSize::ResourceExhausted(written);
+    }
+    std::memcpy(buffer.data() + written, utf8, size);
+    written += size;
+  }
+  return StatusWithSize(written);
+}
+
+size_t JsonReader::NextStructural() {
+  while (structurals_ == 0u) {
+    if (next_block_ >= json_.size() || !status_.ok()) {
+      return kNoPosition;
+    }
+    ScanBlock();
+  }
+  if (!status_.ok()) {
+    return kNoPosition;
+  }
+  const size_t position = block_ + CountTrailingZeros(structurals_);
+  structurals_ &= structurals_ - 1;  // Clear the lowest bit.
+  return position;
+}
+
+void JsonReader::ScanBlock() {
+  const char* block = json_.data() + next_block_;
+  char padded[kBlockSize];
+  const size_t remaining = json_.size() - next_block_;
+  if (remaining < kBlockSize) {
+    std::memcpy(padded, block, remaining);
+    std::memset(padded + remaining, ' ', kBlockSize - remaining);
+    block = padded;
+  }
+
+  const json_impl::CharacterMasks masks = json_impl::ClassifyBlock(block);
+
+  // Quotes that aren't escaped start or end strings. The string bits include
+  // each opening quote but not the closing quote.
+  const uint64_t quotes = masks.quotes & ~FindEscaped(masks.backslashes);
+  const uint64_t in_string = PrefixXor(quotes) ^ in_string_;
+  in_string_ = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+  if ((masks.controls & in_string) != 0u) {
+    // Control characters must be escaped in strings.
+    status_ = Status::DataLoss();
+    offset_ = next_block_ + CountTrailingZeros(masks.controls & in_string);
+    return;
+  }
+
+  // Numbers and literals are runs of anything else outside of strings. Only
+  // the first character of each run is structural.
+  const uint64_t scalars =
+      ~(masks.operators | masks.whitespace | masks.quotes | in_string);
+  const uint64_t scalar_starts = scalars & ~((scalars << 1) | scalar_);
+  scalar_ = scalars >> 63;
+
+  structurals_ = (masks.operators & ~in_string) | quotes | scalar_starts;
+  backslashes_ = masks.backslashes;
+  block_ = next_block_;
+  next_block_ += kBlockSize;
+}
+
+uint64_t JsonReader::FindEscaped(uint64_t backslashes) {
+  uint64_t escaped = escaped_;
+  escaped_ = 0;
+
+  // Backslashes are uncommon, so handle them one at a time. A backslash
+  // escapes the next character unless it is escaped itself.
+  while (backslashes != 0u) {
+    const uint64_t backslash = backslashes & (~backslashes + 1);
+    backslashes ^= backslash;
+    if ((escaped & backslash) != 0u) {
+      continue;
+    }
+    if (backslash == uint64_t{1} << 63) {
+      escaped_ = 1;  // Escapes the first character of the next block.
+    } else {
+      escaped |= backslash << 1;
+    }
+  }
+  return escaped;
+}
+
+Status JsonReader::ReadKey(size_t position) {
+  if (position == kNoPosition || json_[position] != '"' ||
+      !ReadQuoted(position)) {
+    return Fail(position);
+  }
+  token_ = JsonToken::kKey;
+  state_ = kColon;
+  return OkStatus();
+}
+
+Status JsonReader::ReadValue(size_t position) {
+  if (position == kNoPosition) {
+    return Fail(position);
+  }
+
+  switch (json_[position]) {
+    case '{':
+    case '[': {
+      if (depth_ == kMaxDepth) {
+        status_ = Status::ResourceExhausted();
+        offset_ = position;
+        return status_;
+      }
+      const bool object = json_[position] == '{';
+      const uint64_t bit = uint64_t{1} << depth_;
+      objects_ = object ? (objects_ | bit) : (objects_ & ~bit);
+      depth_ += 1;
+      SetToken(object ? JsonToken::kObjectStart : JsonToken::kArrayStart,
+               position,
+               json_.substr(position, 1));
+      state_ = object ? kKeyOrEnd : kValueOrEnd;
+      return OkStatus();
+    }
+    case '"':
+      if (!ReadQuoted(position)) {
+        return Fail(position);
+      }
+      break;
+    case ']':
+    case '}':
+    case ',':
+    case ':':
+      return Fail(position);
+    default:
+      if (!ReadAtom(position)) {
+        return Fail(position);
+      }
+      break;
+  }
+  EndValue();
+  return OkStatus();
+}
+
+Status JsonReader::ReadEnd(size_t position) {
+  const bool object = in_object();
+  if (position == kNoPosition || json_[position] != (object ? '}' : ']')) {
+    return Fail(position);
+  }
+  depth_ -= 1;
+  SetToken(object ? JsonToken::kObjectEnd : JsonToken::kArrayEnd,
+           position,
+           json_.substr(position, 1));
+  EndValue();
+  return OkStatus();
+}
+
+bool JsonReader::ReadQuoted(size_t position) {
+  // Every unescaped quote is structural, so the next one ends the string.
+  const size_t end = NextStructural();
+  if (end == kNoPosition) {
+    return false;
+  }
+  SetToken(JsonToken::kString,
+           position,
+           json_.substr(position + 1, end - position - 1));
+
+  if (position >= block_) {  // The string is within the current block.
+    const uint64_t contents =
+        (uint64_t{1} << (end - block_)) - (uint64_t{2} << (position - block_));
+    has_escapes_ = (backslashes_ & contents) != 0u;
+  } else {
+    has_escapes_ = std::memchr(value_.data(), '\\', value_.size()) != nullptr;
+  }
+  return !has_escapes_ || HasValidEscapes(value_);
+}
+
+bool JsonReader::ReadAtom(size_t position) {
+  size_t end = position + 1;
+  while (end < json_.size() && !IsDelimiter(json_[end])) {
+    end += 1;
+  }
+  const std::string_view text = json_.substr(position, end - position);
+
+  JsonToken token;
+  if (text == "true") {
+    token = JsonToken::kTrue;
+  } else if (text == "false") {
+    token = JsonToken::kFalse;
+  } else if (text == "null") {
+    token = JsonToken::kNull;
+  } else if (IsNumber(text)) {
+    token = JsonToken::kNumber;
+  } else {
+    return false;
+  }
+  SetToken(token, position, text);
+  return true;
+}
+
+Status JsonReader::Fail(size_t position) {
+  if (!status_.ok()) {
+    return status_;  // Scanning failed.
+  }
+  status_ = Status::DataLoss();
+  offset_ = position == kNoPosition ? json_.size() : position;
+  return status_;
+}
+
+Result<int64_t> JsonReader::ReadInt64() const {
+  if (token_ != JsonToken::kNumber) {
+    return Status::FailedPrecondition();
+  }
+  const bool negative = value_[0] == '-';
+  PW_TRY_ASSIGN(const uint64_t magnitude,
+                ParseMagnitude(value_.substr(negative ? 1 : 0)));
+
+  constexpr uint64_t kMaxPositive = std::numeric_limits<int64_t>::max();
+  if (magnitude > kMaxPositive + (negative ? 1 : 0)) {
+    return Status::OutOfRange();
+  }
+  // Negate as unsigned so that the minimum int64_t does not overflow.
+  return static_cast<int64_t>(negative ? ~magnitude + 1 : magnitude);
+}
+
+Result<uint64_t> JsonReader::ReadUint64() const {
+  if (token_ != JsonToken::kNumber) {
+    return Status::FailedPrecondition();
+  }
+  const bool negative = value_[0] == '-';
+  PW_TRY_ASSIGN(const uint64_t magnitude,
+                ParseMagnitude(value_.substr(negative ? 1 : 0)));
+  if (negative && magnitude != 0u) {
+    return Status::OutOfRange();
+  }
+  return magnitude;
+}
+
+}  // namespace pw
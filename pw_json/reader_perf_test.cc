@@ -0,0 +1,93 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pw_assert/check.h"
+#include "pw_json/builder.h"
+#include "pw_json/reader.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw {
+namespace {
+
+// Telemetry like a gateway receives: 128 records of about 200 characters each,
+// about 27 KiB of JSON.
+constexpr size_t kRecords = 128;
+constexpr size_t kMaxJsonSize = 32768;
+
+JsonBuffer<kMaxJsonSize> json;
+
+std::string_view Telemetry() {
+  if (!json.IsObject() && !json.IsArray()) {
+    JsonArray& records = json.StartArray();
+    for (size_t i = 0; i < kRecords; ++i) {
+      const uint32_t seed = static_cast<uint32_t>(i * 2654435761u);
+      NestedJsonObject record = records.AppendNestedObject();
+      record.Add("device", "environment-sensor")
+          .Add("sequence", i)
+          .Add("timestamp_us", uint64_t{1700000000000000} + seed)
+          .Add("healthy", i % 7 != 0)
+          .Add("note", "calibrated \"in field\"\tby technician");
+      NestedJsonArray values = record.AddNestedArray("samples");
+      for (size_t sample = 0; sample < 8; ++sample) {
+        values.Append(static_cast<int32_t>(seed >> (sample * 3)) % 50000);
+      }
+    }
+    PW_CHECK_OK(json.status());
+  }
+  return json;
+}
+
+// Reads every token in the JSON.
+void ReadAllTokens(perf_test::State& state) {
+  const std::string_view telemetry = Telemetry();
+  while (state.KeepRunning()) {
+    JsonReader reader(telemetry);
+    Status status;
+    while ((status = reader.Next()).ok()) {
+    }
+    PW_CHECK(status.IsOutOfRange());
+  }
+}
+
+// Reads one field from each record and skips the rest of it.
+void ReadSequenceNumbers(perf_test::State& state) {
+  const std::string_view telemetry = Telemetry();
+  while (state.KeepRunning()) {
+    JsonReader reader(telemetry);
+    uint64_t sum = 0;
+    PW_CHECK_OK(reader.Next());  // [
+    while (reader.Next().ok() && reader.token() == JsonToken::kObjectStart) {
+      PW_CHECK_OK(reader.Next());
+      PW_CHECK_OK(reader.Next());
+      PW_CHECK_OK(reader.Next());
+      PW_CHECK_OK(reader.Next());
+      sum += reader.ReadInteger<uint32_t>().value_or(0);
+      while (reader.depth() > 1) {
+        PW_CHECK_OK(reader.Next());
+        PW_CHECK_OK(reader.Skip());
+      }
+    }
+    PW_CHECK_UINT_EQ(sum, kRecords * (kRecords - 1) / 2);
+  }
+}
+
+PW_PERF_TEST(Telemetry_ReadAllTokens, ReadAllTokens);
+PW_PERF_TEST(Telemetry_ReadSequenceNumbers, ReadSequenceNumbers);
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,444 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_json/reader.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#include "pw_json/builder.h"
+#include "pw_unit_test/framework.h"
+
+namespace {
+
+using namespace std::string_view_literals;
+
+using pw::JsonReader;
+using pw::JsonToken;
+
+struct Token {
+  JsonToken token;
+  std::string_view value;
+};
+
+// Reads all tokens and checks them against the expected tokens.
+template <size_t kSize>
+void ExpectTokens(std::string_view json, const Token (&expected)[kSize]) {
+  JsonReader reader(json);
+  for (const Token& token : expected) {
+    ASSERT_EQ(pw::OkStatus(), reader.Next());
+    EXPECT_EQ(token.token, reader.token());
+    EXPECT_EQ(token.value, reader.value());
+  }
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.Next());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.Next());
+}
+
+// Reads until an error and returns it.
+pw::Status ReadAll(std::string_view json) {
+  JsonReader reader(json);
+  pw::Status status;
+  while ((status = reader.Next()).ok()) {
+  }
+  return status;
+}
+
+TEST(JsonReader, Example) {
+  // DOCSTAG: [pw-json-reader-example]
+  pw::JsonReader reader(
+      R"({"name": "Crag", "skills": [20, 1], "items": {"misc": [null]}})");
+
+  uint32_t first_skill = 0;
+  pw::Status status;
+  while ((status = reader.Next()).ok()) {
+    if (reader.token() != pw::JsonToken::kKey) {
+      continue;
+    }
+    if (reader.value() == "skills") {
+      ASSERT_EQ(pw::OkStatus(), reader.Next());  // [
+      ASSERT_EQ(pw::OkStatus(), reader.Next());  // 20
+      first_skill = reader.ReadInteger<uint32_t>().value_or(0);
+    } else if (reader.value() == "items") {
+      ASSERT_EQ(pw::OkStatus(), reader.Next());  // {
+      ASSERT_EQ(pw::OkStatus(), reader.Skip());  // Skip the items object.
+    }
+  }
+  // OUT_OF_RANGE means the whole JSON was read.
+  EXPECT_EQ(pw::Status::OutOfRange(), status);
+  // DOCSTAG: [pw-json-reader-example]
+  EXPECT_EQ(first_skill, 20u);
+}
+
+TEST(JsonReader, SingleValues) {
+  ExpectTokens("0", {{JsonToken::kNumber, "0"}});
+  ExpectTokens(" -12.5e+3 ", {{JsonToken::kNumber, "-12.5e+3"}});
+  ExpectTokens("\ttrue\n", {{JsonToken::kTrue, "true"}});
+  ExpectTokens("false", {{JsonToken::kFalse, "false"}});
+  ExpectTokens("null", {{JsonToken::kNull, "null"}});
+  ExpectTokens(R"("")", {{JsonToken::kString, ""}});
+  ExpectTokens(R"( "hello" )", {{JsonToken::kString, "hello"}});
+}
+
+TEST(JsonReader, ArraysAndObjects) {
+  ExpectTokens("[]",
+               {{JsonToken::kArrayStart, "["}, {JsonToken::kArrayEnd, "]"}});
+  ExpectTokens("{ }",
+               {{JsonToken::kObjectStart, "{"}, {JsonToken::kObjectEnd, "}"}});
+  ExpectTokens(R"({"a": [1, {"b": null}, []], "c": {}})",
+               {{JsonToken::kObjectStart, "{"},
+                {JsonToken::kKey, "a"},
+                {JsonToken::kArrayStart, "["},
+                {JsonToken::kNumber, "1"},
+                {JsonToken::kObjectStart, "{"},
+                {JsonToken::kKey, "b"},
+                {JsonToken::kNull, "null"},
+                {JsonToken::kObjectEnd, "}"},
+                {JsonToken::kArrayStart, "["},
+                {JsonToken::kArrayEnd, "]"},
+                {JsonToken::kArrayEnd, "]"},
+                {JsonToken::kKey, "c"},
+                {JsonToken::kObjectStart, "{"},
+                {JsonToken::kObjectEnd, "}"},
+                {JsonToken::kObjectEnd, "}"}});
+}
+
+TEST(JsonReader, StructuralCharactersInStrings) {
+  ExpectTokens(R"(["{[:,]}", "\"]", "\\", "a\\\"b"])",
+               {{JsonToken::kArrayStart, "["},
+                {JsonToken::kString, "{[:,]}"},
+                {JsonToken::kString, R"(\"])"},
+                {JsonToken::kString, R"(\\)"},
+                {JsonToken::kString, R"(a\\\"b)"},
+                {JsonToken::kArrayEnd, "]"}});
+}
+
+TEST(JsonReader, DepthAndOffset) {
+  JsonReader reader(R"([{"a": 1}])");
+  EXPECT_EQ(reader.depth(), 0u);
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(reader.depth(), 1u);
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(reader.depth(), 2u);
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(reader.offset(), 2u);  // "a"
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(reader.offset(), 7u);  // 1
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(reader.depth(), 1u);
+}
+
+TEST(JsonReader, Skip) {
+  JsonReader reader(R"([{"a": [1, {"b": [[]]}]}, "after"])");
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  ASSERT_EQ(JsonToken::kObjectStart, reader.token());
+  ASSERT_EQ(pw::OkStatus(), reader.Skip());
+  EXPECT_EQ(JsonToken::kObjectEnd, reader.token());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(JsonToken::kString, reader.token());
+  EXPECT_EQ(pw::OkStatus(), reader.Skip());  // Does nothing
+  EXPECT_EQ("after"sv, reader.value());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(JsonToken::kArrayEnd, reader.token());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.Next());
+}
+
+TEST(JsonReader, Skip_Malformed) {
+  JsonReader reader(R"([{"a": [1 2]}])");
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::DataLoss(), reader.Skip());
+  EXPECT_EQ(reader.offset(), 10u);
+}
+
+TEST(JsonReader, ReadString) {
+  JsonReader reader(
+      R"(["plain", "\"\\\/\b\f\n\r\t", "\u0041\u00e9\u20ac\ud83d\ude00"])");
+  std::array<char, 16> buffer;
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::FailedPrecondition(),
+            reader.ReadString(buffer).status());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_FALSE(reader.has_escapes());
+  pw::StatusWithSize result = reader.ReadString(buffer);
+  ASSERT_EQ(pw::OkStatus(), result.status());
+  EXPECT_EQ(std::string_view(buffer.data(), result.size()), "plain");
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_TRUE(reader.has_escapes());
+  result = reader.ReadString(buffer);
+  ASSERT_EQ(pw::OkStatus(), result.status());
+  EXPECT_EQ(std::string_view(buffer.data(), result.size()), "\"\\/\b\f\n\r\t");
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  result = reader.ReadString(buffer);
+  ASSERT_EQ(pw::OkStatus(), result.status());
+  EXPECT_EQ(std::string_view(buffer.data(), result.size()),
+            "A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+}
+
+TEST(JsonReader, ReadString_BufferTooSmall) {
+  std::array<char, 4> buffer;
+
+  JsonReader plain(R"("abcdef")");
+  ASSERT_EQ(pw::OkStatus(), plain.Next());
+  pw::StatusWithSize result = plain.ReadString(buffer);
+  EXPECT_EQ(pw::Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(4u, result.size());
+
+  JsonReader escaped(R"("ab\u20ac")");
+  ASSERT_EQ(pw::OkStatus(), escaped.Next());
+  result = escaped.ReadString(buffer);
+  EXPECT_EQ(pw::Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(2u, result.size());
+}
+
+TEST(JsonReader, ReadString_UnpairedSurrogates) {
+  std::array<char, 16> buffer;
+  for (std::string_view json :
+       {R"("\ud83d")", R"("\ud83dx")", R"("\ude00")", R"("\ud83d\u0041")"}) {
+    JsonReader reader(json);
+    ASSERT_EQ(pw::OkStatus(), reader.Next());
+    EXPECT_EQ(pw::Status::DataLoss(), reader.ReadString(buffer).status())
+        << json;
+  }
+}
+
+TEST(JsonReader, ReadInteger) {
+  JsonReader reader(
+      "[0, -0, 255, 256, -128, -129, 9223372036854775807, "
+      "-9223372036854775808, 18446744073709551615, 18446744073709551616, 1.0, "
+      "1e2, \"1\"]");
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::FailedPrecondition(),
+            reader.ReadInteger<int>().status());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(0u, reader.ReadInteger<uint8_t>().value());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(0, reader.ReadInteger<int8_t>().value());
+  EXPECT_EQ(0u, reader.ReadInteger<uint8_t>().value());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(255u, reader.ReadInteger<uint8_t>().value());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.ReadInteger<int8_t>().status());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.ReadInteger<uint8_t>().status());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(-128, reader.ReadInteger<int8_t>().value());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.ReadInteger<uint64_t>().status());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.ReadInteger<int8_t>().status());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(),
+            reader.ReadInteger<int64_t>().value());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(),
+            reader.ReadInteger<int64_t>().value());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+            reader.ReadInteger<uint64_t>().value());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.ReadInteger<int64_t>().status());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::OutOfRange(), reader.ReadInteger<uint64_t>().status());
+
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::InvalidArgument(), reader.ReadInteger<int>().status());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::InvalidArgument(), reader.ReadInteger<int>().status());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::FailedPrecondition(),
+            reader.ReadInteger<int>().status());
+}
+
+TEST(JsonReader, MalformedJson) {
+  for (std::string_view json : {""sv,
+                                " "sv,
+                                "["sv,
+                                "]"sv,
+                                "[1,]"sv,
+                                "[,1]"sv,
+                                "[1 2]"sv,
+                                "[1}"sv,
+                                "{]"sv,
+                                "{}}"sv,
+                                R"({"a"})"sv,
+                                R"({"a":})"sv,
+                                R"({"a" 1})"sv,
+                                R"({"a": 1,})"sv,
+                                R"({1: 2})"sv,
+                                R"({"a": 1 "b": 2})"sv,
+                                "[1]x"sv,
+                                "1 2"sv,
+                                "tru"sv,
+                                "nul"sv,
+                                "truex"sv,
+                                "01"sv,
+                                "1."sv,
+                                ".5"sv,
+                                "-"sv,
+                                "1e"sv,
+                                "1e+"sv,
+                                "+1"sv,
+                                "0x10"sv,
+                                "\"abc"sv,
+                                "\"abc\\\""sv,
+                                "\"a\tb\""sv,
+                                "[\"a\nb\"]"sv,
+                                "\"\\x\""sv,
+                                "\"\\u12G4\""sv,
+                                "\"\\u12\""sv,
+                                "\\\"a\""sv,
+                                "[\"a\" \"b\"]"sv,
+                                "\"a\"\"b\""sv,
+                                "\x01"sv,
+                                "[1,\x01]"sv}) {
+    EXPECT_EQ(pw::Status::DataLoss(), ReadAll(json))
+        << "\"" << json.data() << "\"";
+  }
+}
+
+TEST(JsonReader, ErrorOffset) {
+  JsonReader reader("[true, fals]");
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  ASSERT_EQ(pw::OkStatus(), reader.Next());
+  EXPECT_EQ(pw::Status::DataLoss(), reader.Next());
+  EXPECT_EQ(reader.offset(), 7u);
+  EXPECT_EQ(pw::Status::DataLoss(), reader.Next());
+
+  EXPECT_EQ(pw::Status::DataLoss(), ReadAll("[1, 2"));
+}
+
+TEST(JsonReader, MaxDepth) {
+  std::array<char, 2 * JsonReader::kMaxDepth + 2> json;
+  const size_t depth = JsonReader::kMaxDepth;
+  std::memset(json.data(), '[', depth);
+  std::memset(json.data() + depth, ']', depth);
+  EXPECT_EQ(pw::Status::OutOfRange(),
+            ReadAll(std::string_view(json.data(), 2 * depth)));
+
+  std::memset(json.data(), '[', depth + 1);
+  std::memset(json.data() + depth + 1, ']', depth + 1);
+  EXPECT_EQ(pw::Status::ResourceExhausted(),
+            ReadAll(std::string_view(json.data(), 2 * depth + 2)));
+}
+
+// Moves the JSON through every position in a 64-character block, so strings,
+// escapes, and numbers cross block boundaries.
+TEST(JsonReader, BlockBoundaries) {
+  constexpr std::string_view kJson =
+      R"({"key": "a string with \"escaped\" quotes\\", "n": -1234567.5e-3,)"
+      R"( "list": [true, false, null, "\\\\\"", "\u00e9"], "last": 12})";
+  constexpr Token kTokens[] = {{JsonToken::kObjectStart, "{"},
+                               {JsonToken::kKey, "key"},
+                               {JsonToken::kString,
+                                R"(a string with \"escaped\" quotes\\)"},
+                               {JsonToken::kKey, "n"},
+                               {JsonToken::kNumber, "-1234567.5e-3"},
+                               {JsonToken::kKey, "list"},
+                               {JsonToken::kArrayStart, "["},
+                               {JsonToken::kTrue, "true"},
+                               {JsonToken::kFalse, "false"},
+                               {JsonToken::kNull, "null"},
+                               {JsonToken::kString, R"(\\\\\")"},
+                               {JsonToken::kString, R"(\u00e9)"},
+                               {JsonToken::kArrayEnd, "]"},
+                               {JsonToken::kKey, "last"},
+                               {JsonToken::kNumber, "12"},
+                               {JsonToken::kObjectEnd, "}"}};
+
+  std::array<char, 256> buffer;
+  for (size_t shift = 0; shift <= 2 * 64; ++shift) {
+    std::memset(buffer.data(), ' ', shift);
+    kJson.copy(buffer.data() + shift, kJson.size());
+    ExpectTokens(std::string_view(buffer.data(), shift + kJson.size()),
+                 kTokens);
+  }
+}
+
+// Builds pseudorandom JSON with JsonBuilder and checks that it reads back.
+class RandomJson {
+ public:
+  explicit RandomJson(uint32_t seed) : state_(seed) {}
+
+  uint32_t Next() {
+    state_ = state_ * 1664525u + 1013904223u;
+    return state_ >> 8;
+  }
+
+  // Fills `chars` with random characters, favoring ones that need escaping.
+  std::string_view String(char* chars, size_t max_size) {
+    const size_t size = Next() % max_size;
+    for (size_t i = 0; i < size; ++i) {
+      constexpr char kSpecial[] = {'"', '\\', '\n', '\x01', '{', ']', ','};
+      const uint32_t choice = Next() % 4;
+      chars[i] = choice == 0 ? kSpecial[Next() % sizeof(kSpecial)]
+                             : static_cast<char>(' ' + Next() % 95);
+    }
+    return std::string_view(chars, size);
+  }
+
+ private:
+  uint32_t state_;
+};
+
+TEST(JsonReader, ReadsJsonBuilderOutput) {
+  for (uint32_t seed = 1; seed <= 20; ++seed) {
+    RandomJson random(seed);
+    char chars[64][48];
+    std::string_view strings[64];
+    int64_t numbers[64];
+
+    pw::JsonBuffer<8192> json;
+    pw::JsonArray& array = json.StartArray();
+    for (size_t i = 0; i < 64; ++i) {
+      strings[i] = random.String(chars[i], sizeof(chars[i]));
+      numbers[i] = static_cast<int64_t>(random.Next()) - (1 << 23);
+      array.AppendNestedObject().Add(strings[i], numbers[i]);
+    }
+    ASSERT_EQ(pw::OkStatus(), json.status());
+
+    JsonReader reader(json);
+    ASSERT_EQ(pw::OkStatus(), reader.Next());
+    for (size_t i = 0; i < 64; ++i) {
+      ASSERT_EQ(pw::OkStatus(), reader.Next());
+      ASSERT_EQ(JsonToken::kObjectStart, reader.token());
+      ASSERT_EQ(pw::OkStatus(), reader.Next());
+      ASSERT_EQ(JsonToken::kKey, reader.token());
+
+      char key[48];
+      const pw::StatusWithSize result = reader.ReadString(key);
+      ASSERT_EQ(pw::OkStatus(), result.status());
+      EXPECT_EQ(std::string_view(key, result.size()), strings[i]);
+
+      ASSERT_EQ(pw::OkStatus(), reader.Next());
+      EXPECT_EQ(numbers[i], reader.ReadInteger<int64_t>().value());
+      ASSERT_EQ(pw::OkStatus(), reader.Next());
+      ASSERT_EQ(JsonToken::kObjectEnd, reader.token());
+    }
+    ASSERT_EQ(pw::OkStatus(), reader.Next());
+    EXPECT_EQ(JsonToken::kArrayEnd, reader.token());
+    EXPECT_EQ(pw::Status::OutOfRange(), reader.Next());
+  }
+}
+
+}  // namespace
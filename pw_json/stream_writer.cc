@@ -0,0 +1,221 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_json/stream_writer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "pw_string/type_to_string.h"
+
+namespace pw {
+namespace {
+
+// Large enough for any 64-bit integer or FloatAsIntToString output.
+constexpr size_t kNumberBufferSize = 24;
+
+StatusWithSize ToString(int64_t value, span<char> buffer) {
+  return string::IntToString(value, buffer);
+}
+
+StatusWithSize ToString(uint64_t value, span<char> buffer) {
+  return string::IntToString(value, buffer);
+}
+
+StatusWithSize ToString(float value, span<char> buffer) {
+  return string::FloatAsIntToString(value, buffer);
+}
+
+// Characters that are written without escaping, as in EscapedStringCopy.
+constexpr bool IsUnescaped(char c) {
+  return c >= ' ' && c <= '~' && c != '"' && c != '\\';
+}
+
+}  // namespace
+
+JsonStreamWriter::JsonStreamWriter(stream::Writer& writer, span<char> buffer)
+    : writer_(writer), buffer_(buffer) {
+  PW_ASSERT(!buffer.empty());  // The buffer must hold at least one character
+}
+
+JsonStreamArray JsonStreamWriter::StartArray() {
+  PW_ASSERT(!started_);  // The JSON was already started
+  started_ = true;
+  return JsonStreamArray(*this, Open(kArray));
+}
+
+JsonStreamObject JsonStreamWriter::StartObject() {
+  PW_ASSERT(!started_);  // The JSON was already started
+  started_ = true;
+  return JsonStreamObject(*this, Open(kObject));
+}
+
+Status JsonStreamWriter::Finish() {
+  CloseTo(0);
+  Flush();
+  return status();
+}
+
+json_impl::StreamLevel JsonStreamWriter::Open(Type type) {
+  PW_ASSERT(depth_ < kMaxDepth);  // Arrays or objects are nested too deeply
+  const uint8_t depth = depth_++;
+  const uint32_t bit = uint32_t{1} << depth;
+  types_ = type == kObject ? (types_ | bit) : (types_ & ~bit);
+  has_items_ &= ~bit;
+  ids_[depth] = next_id_++;
+
+  Write(type == kObject ? '{' : '[');
+  return {depth, ids_[depth]};
+}
+
+void JsonStreamWriter::CloseTo(size_t depth) {
+  while (depth_ > depth) {
+    depth_ -= 1;
+    Write((types_ & (uint32_t{1} << depth_)) != 0 ? '}' : ']');
+  }
+}
+
+bool JsonStreamWriter::StartItem(json_impl::StreamLevel level) {
+  PW_ASSERT(level.depth < depth_);           // Enclosing JSON has changed.
+  PW_ASSERT(ids_[level.depth] == level.id);  // Enclosing JSON has changed.
+  CloseTo(level.depth + 1u);
+
+  const uint32_t bit = uint32_t{1} << level.depth;
+  if ((has_items_ & bit) != 0) {
+    Write(", ");
+  }
+  has_items_ |= bit;
+  return ok();
+}
+
+bool JsonStreamWriter::StartEntry(json_impl::StreamLevel level,
+                                  std::string_view key) {
+  if (!StartItem(level)) {
+    return false;
+  }
+  WriteQuotedString(key);
+  Write(": ");
+  return true;
+}
+
+void JsonStreamWriter::WriteQuotedString(std::string_view value) {
+  // Escape directly into the buffer if the string fits.
+  constexpr size_t kQuotes = 2;
+  if (value.size() + kQuotes <= remaining()) {
+    char* const start = buffer_.data() + buffered_;
+    const int written = json_impl::EscapedStringCopy(
+        start + 1,
+        static_cast<int>(std::min<size_t>(remaining() - kQuotes, INT_MAX)),
+        value);
+    if (written >= 0) {
+      start[0] = '"';
+      start[written + 1] = '"';
+      buffered_ += static_cast<size_t>(written) + kQuotes;
+      return;
+    }
+  }
+
+  Write('"');
+
+  // Copy runs of characters that don't need escaping in one step.
+  size_t run_start = 0;
+  for (size_t i = 0; i < value.size(); ++i) {
+    const char c = value[i];
+    if (IsUnescaped(c)) {
+      continue;
+    }
+    Write(value.substr(run_start, i - run_start));
+    run_start = i + 1;
+
+    // Escape characters the same way as json_impl::EscapedStringCopy.
+    if (c >= '\b' && c <= '\r' && c != '\v') {
+      constexpr char kControlChars[] = {'b', 't', 'n', '?', 'f', 'r'};
+      Write('\\');
+      Write(kControlChars[c - '\b']);
+    } else if (c == '"' || c == '\\') {
+      Write('\\');
+      Write(c);
+    } else {
+      const uint8_t byte = static_cast<uint8_t>(c);
+      const char escaped[] = {'\\',
+                              'u',
+                              '0',  // Only handle ASCII for now
+                              '0',
+                              json_impl::NibbleToHex((byte >> 4) & 0x0f),
+                              json_impl::NibbleToHex(byte & 0x0f)};
+      Write(std::string_view(escaped, sizeof(escaped)));
+    }
+  }
+  Write(value.substr(run_start));
+
+  Write('"');
+}
+
+void JsonStreamWriter::WriteCharPointer(const char* value) {
+  if (value == nullptr) {
+    Write("null");
+  } else {
+    WriteQuotedString(value);
+  }
+}
+
+template <typename T>
+void JsonStreamWriter::WriteNumber(T value) {
+  // Write directly into the buffer if there is room for any number.
+  if (remaining() >= kNumberBufferSize) {
+    buffered_ += ToString(value, buffer_.subspan(buffered_)).size();
+    return;
+  }
+  char number[kNumberBufferSize];
+  Write(std::string_view(number, ToString(value, number).size()));
+}
+
+void JsonStreamWriter::WriteInteger(int64_t value) { WriteNumber(value); }
+
+void JsonStreamWriter::WriteInteger(uint64_t value) { WriteNumber(value); }
+
+void JsonStreamWriter::WriteFloat(float value) { WriteNumber(value); }
+
+void JsonStreamWriter::WriteLarge(std::string_view data) {
+  while (!data.empty()) {
+    if (buffered_ == buffer_.size()) {
+      Flush();
+    }
+    // Pass data that would fill the empty buffer directly to the stream.
+    if (buffered_ == 0u && data.size() >= buffer_.size()) {
+      WriteToStream(data);
+      return;
+    }
+    const size_t size = std::min(data.size(), remaining());
+    std::memcpy(buffer_.data() + buffered_, data.data(), size);
+    buffered_ += size;
+    data.remove_prefix(size);
+  }
+}
+
+void JsonStreamWriter::Flush() {
+  if (buffered_ != 0u) {
+    WriteToStream(std::string_view(buffer_.data(), buffered_));
+    buffered_ = 0;
+  }
+}
+
+void JsonStreamWriter::WriteToStream(std::string_view data) {
+  if (ok()) {
+    status_ = writer_.Write(data.data(), data.size());
+  }
+}
+
+}  // namespace pw
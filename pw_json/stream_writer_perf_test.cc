@@ -0,0 +1,87 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pw_json/builder.h"
+#include "pw_json/stream_writer.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_stream/null_stream.h"
+
+namespace pw {
+namespace {
+
+// Dumps a tree of metrics like the one pw_metric keeps: 8 groups of 32 metrics
+// each, about 5 KiB of JSON.
+constexpr size_t kGroups = 8;
+constexpr size_t kMetricsPerGroup = 32;
+constexpr size_t kMaxJsonSize = 8192;
+
+constexpr std::string_view kGroupNames[kGroups] = {
+    "bluetooth", "flash", "kvs", "rpc", "sensors", "system", "thread", "usb"};
+
+char metric_names[kMetricsPerGroup][16];
+
+void FillNames() {
+  for (size_t i = 0; i < kMetricsPerGroup; ++i) {
+    std::string_view("metric_count_00").copy(metric_names[i], 15);
+    metric_names[i][13] = static_cast<char>('0' + i / 10);
+    metric_names[i][14] = static_cast<char>('0' + i % 10);
+  }
+}
+
+template <typename Object>
+void DumpMetrics(Object& object) {
+  for (size_t group = 0; group < kGroups; ++group) {
+    auto nested = object.AddNestedObject(kGroupNames[group]);
+    for (size_t metric = 0; metric < kMetricsPerGroup; ++metric) {
+      nested.Add(metric_names[metric],
+                 static_cast<uint32_t>(group * 100003u + metric * 7919u));
+    }
+  }
+}
+
+// Builds the whole dump in a worst-case buffer, then writes it to a stream.
+void BuildThenWrite(perf_test::State& state) {
+  FillNames();
+  static JsonBuffer<kMaxJsonSize> json;
+  while (state.KeepRunning()) {
+    JsonObject& object = json.StartObject();
+    DumpMetrics(object);
+    PW_ASSERT(
+        stream::NullStream::Instance().Write(json.data(), json.size()).ok());
+  }
+}
+
+// Writes the dump to a stream through a small buffer.
+template <size_t kBufferSize>
+void StreamJson(perf_test::State& state) {
+  FillNames();
+  while (state.KeepRunning()) {
+    JsonStreamBuffer<kBufferSize> writer(stream::NullStream::Instance());
+    JsonStreamObject object = writer.StartObject();
+    DumpMetrics(object);
+    PW_ASSERT(writer.Finish().ok());
+  }
+}
+
+PW_PERF_TEST(MetricDump_JsonBuffer, BuildThenWrite);
+PW_PERF_TEST(MetricDump_Stream32, StreamJson<32>);
+PW_PERF_TEST(MetricDump_Stream128, StreamJson<128>);
+PW_PERF_TEST(MetricDump_Stream512, StreamJson<512>);
+
+}  // namespace
+}  // namespace pw
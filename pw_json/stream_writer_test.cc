@@ -0,0 +1,245 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_json/stream_writer.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+#include "pw_json/builder.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_unit_test/framework.h"
+
+namespace {
+
+using namespace std::string_view_literals;
+
+constexpr size_t kBufferSizes[] = {1, 2, 7, 16, 64, 1024};
+
+std::string_view Written(const pw::stream::MemoryWriter& writer) {
+  return std::string_view(reinterpret_cast<const char*>(writer.data()),
+                          writer.bytes_written());
+}
+
+// Builds the same object with a JsonBuilder and a JsonStreamWriter. The
+// functions have the same names, so one generic function fills both.
+template <typename Function>
+void ExpectSameAsBuilder(Function fill_object) {
+  pw::JsonBuffer<2048> builder;
+  fill_object(builder.StartObject());
+  ASSERT_EQ(pw::OkStatus(), builder.status());
+
+  for (size_t buffer_size : kBufferSizes) {
+    std::array<char, 1024> buffer;
+    pw::stream::MemoryWriterBuffer<2048> output;
+    pw::JsonStreamWriter writer(output, pw::span(buffer).first(buffer_size));
+
+    pw::JsonStreamObject object = writer.StartObject();
+    fill_object(object);
+    ASSERT_EQ(pw::OkStatus(), writer.Finish());
+    EXPECT_EQ(std::string_view(builder), Written(output))
+        << "Buffer size " << buffer_size;
+  }
+}
+
+template <typename T>
+std::string_view StreamValue(const T& value,
+                             pw::stream::MemoryWriter& output) {
+  pw::JsonStreamBuffer<8> writer(output);
+  EXPECT_EQ(pw::OkStatus(), writer.SetValue(value));
+  EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  return Written(output);
+}
+
+TEST(JsonStreamWriter, Example) {
+  pw::stream::MemoryWriterBuffer<256> output;
+
+  // DOCSTAG: [pw-json-stream-writer-example]
+  // Output is collected in a 32-character buffer and written to the stream in
+  // chunks, so the JSON can be larger than any buffer.
+  pw::JsonStreamBuffer<32> writer(output);
+  pw::JsonStreamObject object = writer.StartObject();
+  object.Add("name", "Crag").Add("job", "hacker");
+
+  pw::JsonStreamArray skills = object.AddNestedArray("skills");
+  skills.Append(20).Append(1);
+
+  // Adding to the object closes the nested "skills" array.
+  object.AddNestedObject("items").AddNestedArray("misc").Append(nullptr);
+
+  // Finish() closes the open arrays and objects and flushes the buffer.
+  pw::Status status = writer.Finish();
+  // DOCSTAG: [pw-json-stream-writer-example]
+
+  EXPECT_EQ(pw::OkStatus(), status);
+  EXPECT_EQ(Written(output),
+            R"({"name": "Crag", "job": "hacker", "skills": [20, 1],)"
+            R"( "items": {"misc": [null]}})"sv);
+}
+
+TEST(JsonStreamWriter, SetValue) {
+  pw::stream::MemoryWriterBuffer<64> output;
+
+  EXPECT_EQ(StreamValue(nullptr, output), "null");
+  output.clear();
+  EXPECT_EQ(StreamValue(static_cast<const char*>(nullptr), output), "null");
+  output.clear();
+  EXPECT_EQ(StreamValue(true, output), "true");
+  output.clear();
+  EXPECT_EQ(StreamValue(false, output), "false");
+  output.clear();
+  EXPECT_EQ(StreamValue(std::numeric_limits<int64_t>::min(), output),
+            "-9223372036854775808");
+  output.clear();
+  EXPECT_EQ(StreamValue(std::numeric_limits<uint64_t>::max(), output),
+            "18446744073709551615");
+  output.clear();
+  EXPECT_EQ(StreamValue(-4.9, output), "-5");
+  output.clear();
+  EXPECT_EQ(StreamValue("a \"quoted\"\tstring", output),
+            R"("a \"quoted\"\tstring")");
+  output.clear();
+  EXPECT_EQ(StreamValue(""sv, output), R"("")");
+}
+
+TEST(JsonStreamWriter, SetValue_SerializedJson) {
+  pw::JsonBuffer<32> json;
+  json.StartArray().Append(1).Append("two");
+
+  pw::stream::MemoryWriterBuffer<64> output;
+  EXPECT_EQ(StreamValue(json, output), R"([1, "two"])");
+}
+
+TEST(JsonStreamWriter, EmptyArrayAndObject) {
+  pw::stream::MemoryWriterBuffer<64> output;
+  {
+    pw::JsonStreamBuffer<4> writer(output);
+    static_cast<void>(writer.StartArray());
+    EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  }
+  EXPECT_EQ(Written(output), "[]");
+
+  output.clear();
+  {
+    pw::JsonStreamBuffer<4> writer(output);
+    pw::JsonStreamObject object = writer.StartObject();
+    static_cast<void>(object.AddNestedObject("empty"));
+    EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  }
+  EXPECT_EQ(Written(output), R"({"empty": {}})");
+}
+
+TEST(JsonStreamWriter, MatchesJsonBuilder) {
+  ExpectSameAsBuilder([](auto&& object) {
+    object.Add("bool", true)
+        .Add("int", -123)
+        .Add("unsigned", 456u)
+        .Add("float", 1.5f)
+        .Add("null", nullptr)
+        .Add("string", "hello\n\"world\"");
+
+    auto array = object.AddNestedArray("array");
+    array.Append(1).Append("two");
+    array.AppendNestedObject().Add("in", "array");
+    static_cast<void>(array.AppendNestedArray().AppendNestedArray());
+    array.Append(false);
+
+    auto nested = object.AddNestedObject("object");
+    nested.AddNestedObject("deeper").AddNestedObject("deepest").Add("x", 1);
+    nested.Add("after", "deeper");
+
+    object.Add("last", 0);
+  });
+}
+
+TEST(JsonStreamWriter, MatchesJsonBuilder_EscapedCharacters) {
+  ExpectSameAsBuilder([](auto&& object) {
+    char all_chars[256];
+    for (size_t i = 0; i < sizeof(all_chars); ++i) {
+      all_chars[i] = static_cast<char>(i);
+    }
+    const std::string_view value(all_chars, sizeof(all_chars));
+    object.Add(value.substr(0, 40), value.substr(40, 120));
+    object.AddNestedArray(value.substr(160)).Append(value.substr(200));
+  });
+}
+
+TEST(JsonStreamWriter, Extend) {
+  pw::stream::MemoryWriterBuffer<64> output;
+  pw::JsonStreamBuffer<4> writer(output);
+
+  const std::array<std::string_view, 2> strings = {"a", "b"};
+  writer.StartArray().Extend({1, 2, 3}).Extend(strings);
+  EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  EXPECT_EQ(Written(output), R"([1, 2, 3, "a", "b"])");
+}
+
+TEST(JsonStreamWriter, MaxNesting) {
+  pw::stream::MemoryWriterBuffer<64> output;
+  pw::JsonStreamBuffer<16> writer(output);
+
+  pw::JsonStreamArray array = writer.StartArray();
+  for (size_t i = 1; i < pw::JsonStreamWriter::kMaxDepth; ++i) {
+    array = array.AppendNestedArray();
+  }
+  array.Append(1);
+  EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  EXPECT_EQ(Written(output), "[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]");
+}
+
+TEST(JsonStreamWriter, BuffersUntilFull) {
+  pw::stream::MemoryWriterBuffer<64> output;
+  pw::JsonStreamBuffer<8> writer(output);
+
+  pw::JsonStreamArray array = writer.StartArray();
+  array.Append(1).Append(2).Append(3);  // [1, 2, 3 fills the buffer
+  EXPECT_EQ(output.bytes_written(), 0u);
+
+  array.Append(4);
+  EXPECT_EQ(Written(output), "[1, 2, 3");
+
+  EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  EXPECT_EQ(Written(output), "[1, 2, 3, 4]");
+}
+
+TEST(JsonStreamWriter, LongStringBypassesBuffer) {
+  pw::stream::MemoryWriterBuffer<64> output;
+  pw::JsonStreamBuffer<4> writer(output);
+
+  writer.StartArray().Append("abcdefghijklmnopqrstuvwxyz");
+  EXPECT_EQ(pw::OkStatus(), writer.Finish());
+  EXPECT_EQ(Written(output), R"(["abcdefghijklmnopqrstuvwxyz"])");
+}
+
+TEST(JsonStreamWriter, StreamError) {
+  pw::stream::MemoryWriterBuffer<6> output;
+  pw::JsonStreamBuffer<4> writer(output);
+
+  pw::JsonStreamArray array = writer.StartArray();
+  array.Append(1).Append(2).Append(3);  // Writes "[1, " to the stream
+  EXPECT_EQ(pw::OkStatus(), array.status());
+
+  array.Append(4);  // Writing "2, 3" to the stream fails
+  EXPECT_EQ(pw::Status::ResourceExhausted(), array.status());
+  EXPECT_FALSE(writer.ok());
+
+  // Output after the error is discarded.
+  array.Append(5);
+  EXPECT_EQ(pw::Status::ResourceExhausted(), writer.Finish());
+  EXPECT_EQ(Written(output), "[1, ");
+}
+
+}  // namespace
@@ -49,7 +49,12 @@ Status Entry::Read(FlashPartition& partition,
     return Status::DataLoss();
   }
 
+  bool batch = false;
   const EntryFormat* format = formats.Find(header.magic);
+  if (format == nullptr) {
+    format = formats.FindForBatch(header.magic);
+    batch = true;
+  }
   if (format == nullptr) {
     PW_LOG_ERROR("Found corrupt magic: %" PRIx32 " at address %u",
                  header.magic,
@@ -57,7 +62,7 @@ Status Entry::Read(FlashPartition& partition,
     return Status::DataLoss();
   }
 
-  *entry = Entry(&partition, address, *format, header);
+  *entry = Entry(&partition, address, *format, header, batch);
   return OkStatus();
 }
 
@@ -79,17 +84,19 @@ Entry::Entry(FlashPartition& partition,
              Key key,
              span<const byte> value,
              uint16_t value_size_bytes,
-             uint32_t transaction_id)
+             uint32_t transaction_id,
+             bool batch)
     : Entry(&partition,
             address,
             format,
-            {.magic = format.magic,
+            {.magic = batch ? BatchMagic(format.magic) : format.magic,
              .checksum = 0,
              .alignment_units =
                  alignment_bytes_to_units(partition.alignment_bytes()),
              .key_length_bytes = static_cast<uint8_t>(key.size()),
              .value_size_bytes = value_size_bytes,
-             .transaction_id = transaction_id}) {
+             .transaction_id = transaction_id},
+            batch) {
   if (checksum_algo_ != nullptr) {
     span<const byte> checksum = CalculateChecksum(key, value);
     std::memcpy(&header_.checksum,
@@ -106,10 +113,28 @@ StatusWithSize Entry::Write(Key key, span<const byte> value) const {
       {as_bytes(span(&header_, 1)), as_bytes(span(key)), value});
 }
 
+Status Entry::Write(AlignedWriter& writer,
+                    Key key,
+                    span<const byte> value) const {
+  PW_TRY(writer.Write(&header_, sizeof(header_)).status());
+  PW_TRY(writer.Write(as_bytes(span(key))).status());
+  PW_TRY(writer.Write(value).status());
+
+  constexpr byte padding[kMinAlignmentBytes - 1] = {};
+  size_t padding_to_add = Padding(content_size(), alignment_bytes());
+
+  while (padding_to_add != 0u) {
+    const size_t chunk_size = std::min(padding_to_add, sizeof(padding));
+    PW_TRY(writer.Write(padding, chunk_size).status());
+    padding_to_add -= chunk_size;
+  }
+  return OkStatus();
+}
+
 Status Entry::Update(const EntryFormat& new_format,
                      uint32_t new_transaction_id) {
   checksum_algo_ = new_format.checksum;
-  header_.magic = new_format.magic;
+  header_.magic = batch_ ? BatchMagic(new_format.magic) : new_format.magic;
   header_.alignment_units =
       alignment_bytes_to_units(partition_->alignment_bytes());
   header_.transaction_id = new_transaction_id;
@@ -82,4 +82,11 @@ Status FlashPartitionWithStats::Erase(Address address, size_t num_sectors) {
   return FlashPartition::Erase(address, num_sectors);
 }
 
+StatusWithSize FlashPartitionWithStats::Write(Address address,
+                                              span<const std::byte> data) {
+  write_count_ += 1;
+  bytes_written_ += data.size();
+  return FlashPartition::Write(address, data);
+}
+
 }  // namespace pw::kvs
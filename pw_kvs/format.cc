@@ -25,4 +25,13 @@ const EntryFormat* EntryFormats::Find(const uint32_t magic) const {
   return nullptr;
 }
 
+const EntryFormat* EntryFormats::FindForBatch(const uint32_t magic) const {
+  for (const EntryFormat& format : formats_) {
+    if (BatchMagic(format.magic) == magic) {
+      return &format;
+    }
+  }
+  return nullptr;
+}
+
 }  // namespace pw::kvs::internal
@@ -0,0 +1,377 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_LOG_MODULE_NAME "KVS"
+#define PW_LOG_LEVEL PW_KVS_LOG_LEVEL
+
+#include "pw_kvs/internal/index_checkpoint.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "pw_checksum/crc32.h"
+#include "pw_kvs/alignment.h"
+#include "pw_kvs_private/config.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pw::kvs::internal {
+namespace {
+
+using std::byte;
+
+constexpr uint32_t kMagic = 0x6b1c7e35;
+constexpr uint32_t kInvalidatedMarker = 0x3d9a0c51;
+
+constexpr size_t kBufferSize = std::max(kMaxFlashAlignment, size_t{64});
+
+// Reads a checkpoint's records in order through a small buffer, adding them to
+// the checkpoint's checksum.
+class RecordReader {
+ public:
+  RecordReader(FlashPartition& partition,
+               FlashPartition::Address address,
+               FlashPartition::Address end,
+               checksum::Crc32& crc)
+      : partition_(partition),
+        address_(address),
+        end_(end),
+        crc_(crc),
+        position_(0),
+        size_(0) {}
+
+  Status Read(void* data, size_t size) {
+    byte* out = static_cast<byte*>(data);
+    while (size > 0) {
+      if (position_ == size_) {
+        PW_TRY(Fill());
+      }
+      const size_t chunk = std::min(size, size_ - position_);
+      std::memcpy(out, &buffer_[position_], chunk);
+      crc_.Update(span(out, chunk));
+      position_ += chunk;
+      out += chunk;
+      size -= chunk;
+    }
+    return OkStatus();
+  }
+
+ private:
+  Status Fill() {
+    if (address_ >= end_) {
+      return Status::DataLoss();
+    }
+    size_ = std::min(sizeof(buffer_), size_t{end_ - address_});
+    PW_TRY(partition_.Read(address_, span(buffer_, size_)));
+    address_ += size_;
+    position_ = 0;
+    return OkStatus();
+  }
+
+  FlashPartition& partition_;
+  FlashPartition::Address address_;
+  const FlashPartition::Address end_;
+  checksum::Crc32& crc_;
+  size_t position_;
+  size_t size_;
+  byte buffer_[kBufferSize];
+};
+
+}  // namespace
+
+Status IndexCheckpoint::Load(EntryCache& entry_cache,
+                             Sectors& sectors,
+                             size_t sector_size_bytes) {
+  current_ = false;
+  PW_TRY(CheckPartition());
+
+  // Find the valid checkpoints, newest first. The newest slot overall is
+  // tracked even if it was invalidated, so writes keep alternating.
+  size_t candidates[kSlots];
+  Header headers[kSlots];
+  size_t candidate_count = 0;
+  for (size_t slot = 0; slot < kSlots; ++slot) {
+    Status status = ReadHeader(slot, headers[slot]);
+    if (status.IsNotFound()) {
+      continue;
+    }
+    PW_TRY(status);
+
+    if (headers[slot].sequence >= sequence_) {
+      sequence_ = headers[slot].sequence;
+      newest_slot_ = slot;
+    }
+
+    bool invalidated;
+    PW_TRY(IsInvalidated(slot, invalidated));
+    if (!invalidated) {
+      candidates[candidate_count++] = slot;
+    }
+  }
+  may_be_valid_ = candidate_count > 0;
+
+  std::sort(candidates, candidates + candidate_count, [&](size_t a, size_t b) {
+    return headers[a].sequence > headers[b].sequence;
+  });
+
+  // If the newest checkpoint is corrupt, the older one still describes the KVS
+  // at an earlier point, and entries written since then are read by Init.
+  Status status = Status::NotFound();
+  for (size_t i = 0; i < candidate_count; ++i) {
+    const size_t slot = candidates[i];
+    const Header& header = headers[slot];
+    status = LoadSlot(slot, header, entry_cache, sectors, sector_size_bytes);
+    if (status.ok()) {
+      transaction_id_ = header.transaction_id;
+      current_ = true;
+      PW_LOG_DEBUG("Loaded index checkpoint %u from slot %u",
+                   unsigned(header.sequence),
+                   unsigned(slot));
+      return OkStatus();
+    }
+    PW_LOG_WARN("Index checkpoint in slot %u could not be loaded (%s)",
+                unsigned(slot),
+                status.str());
+  }
+  return status;
+}
+
+Status IndexCheckpoint::LoadSlot(size_t slot,
+                                 const Header& header,
+                                 EntryCache& entry_cache,
+                                 Sectors& sectors,
+                                 size_t sector_size_bytes) const {
+  sectors.Reset();
+  entry_cache.Reset();
+
+  if (header.sector_count != sectors.size() ||
+      header.sector_size_bytes != sector_size_bytes ||
+      header.redundancy != entry_cache.redundancy()) {
+    return Status::FailedPrecondition();
+  }
+  if (header.entry_count > entry_cache.max_entries()) {
+    return Status::ResourceExhausted();
+  }
+
+  checksum::Crc32 crc;
+  crc.Update(as_bytes(span(&header, 1)).subspan(offsetof(Header, sequence)));
+  RecordReader reader(*partition_,
+                      RecordsAddress(slot),
+                      SlotAddress(slot) + slot_size_bytes(),
+                      crc);
+
+  for (SectorDescriptor& sector : sectors) {
+    SectorRecord record;
+    PW_TRY(reader.Read(&record, sizeof(record)));
+    if (size_t{record.writable_bytes} + record.valid_bytes >
+        sector_size_bytes) {
+      return Status::DataLoss();
+    }
+    sector.set_writable_bytes(record.writable_bytes);
+    sector.AddValidBytes(record.valid_bytes);
+  }
+
+  const Address kvs_size_bytes = header.sector_count * sector_size_bytes;
+  for (uint32_t i = 0; i < header.entry_count; ++i) {
+    EntryRecord record;
+    PW_TRY(reader.Read(&record, sizeof(record)));
+    if (record.address_count == 0 ||
+        record.address_count > entry_cache.redundancy() ||
+        record.transaction_id > header.transaction_id) {
+      return Status::DataLoss();
+    }
+
+    const KeyDescriptor descriptor = {
+        record.key_hash,
+        record.transaction_id,
+        record.state == 0 ? EntryState::kValid : EntryState::kDeleted,
+    };
+    EntryMetadata metadata;
+    for (size_t j = 0; j < record.address_count; ++j) {
+      Address address;
+      PW_TRY(reader.Read(&address, sizeof(address)));
+      if (address >= kvs_size_bytes) {
+        return Status::DataLoss();
+      }
+      if (j == 0) {
+        metadata = entry_cache.AddNew(descriptor, address);
+      } else {
+        metadata.AddNewAddress(address);
+      }
+    }
+  }
+
+  if (crc.value() != header.checksum) {
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
+Status IndexCheckpoint::Write(const EntryCache& entry_cache,
+                              const Sectors& sectors,
+                              size_t sector_size_bytes,
+                              uint32_t transaction_id) {
+  PW_TRY(CheckPartition());
+
+  size_t records_size = sectors.size() * sizeof(SectorRecord);
+  for (const SectorDescriptor& sector : sectors) {
+    if (sector.corrupt()) {
+      return Status::FailedPrecondition();
+    }
+  }
+  for (const EntryMetadata& metadata : entry_cache) {
+    records_size +=
+        sizeof(EntryRecord) + metadata.addresses().size() * sizeof(Address);
+  }
+  if (RecordsAddress(0) + records_size > slot_size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+
+  const size_t slot = (newest_slot_ + 1) % kSlots;
+  Header header = {
+      kMagic,
+      0,
+      sequence_ + 1,
+      transaction_id,
+      static_cast<uint32_t>(entry_cache.total_entries()),
+      static_cast<uint32_t>(sectors.size()),
+      static_cast<uint32_t>(sector_size_bytes),
+      static_cast<uint32_t>(entry_cache.redundancy()),
+  };
+
+  // The slot is erased, so it no longer holds the previous checkpoint written
+  // to it, whether or not this one completes.
+  sequence_ = header.sequence;
+  newest_slot_ = slot;
+  current_ = false;
+  const size_t slot_sectors =
+      slot_size_bytes() / partition_->sector_size_bytes();
+  PW_TRY(partition_->Erase(SlotAddress(slot), slot_sectors));
+
+  checksum::Crc32 crc;
+  crc.Update(as_bytes(span(&header, 1)).subspan(offsetof(Header, sequence)));
+
+  FlashPartition::Output output(*partition_, RecordsAddress(slot));
+  AlignedWriterBuffer<kBufferSize> writer(partition_->alignment_bytes(),
+                                          output);
+  auto write = [&crc, &writer](const void* data, size_t size) {
+    crc.Update(span(static_cast<const byte*>(data), size));
+    return writer.Write(data, size).status();
+  };
+
+  for (const SectorDescriptor& sector : sectors) {
+    const SectorRecord record = {
+        static_cast<uint16_t>(sector.writable_bytes()),
+        static_cast<uint16_t>(sector.valid_bytes()),
+    };
+    PW_TRY(write(&record, sizeof(record)));
+  }
+  for (const EntryMetadata& metadata : entry_cache) {
+    const EntryRecord record = {
+        metadata.hash(),
+        metadata.transaction_id(),
+        static_cast<uint8_t>(metadata.state() == EntryState::kValid ? 0 : 1),
+        static_cast<uint8_t>(metadata.addresses().size()),
+        0,
+    };
+    PW_TRY(write(&record, sizeof(record)));
+    PW_TRY(write(metadata.addresses().data(),
+                 metadata.addresses().size_bytes()));
+  }
+  PW_TRY(writer.Flush().status());
+
+  // Writing the header commits the checkpoint.
+  header.checksum = crc.value();
+  FlashPartition::Output header_output(*partition_, SlotAddress(slot));
+  PW_TRY(AlignedWrite<kBufferSize>(header_output,
+                                   partition_->alignment_bytes(),
+                                   {as_bytes(span(&header, 1))})
+             .status());
+
+  transaction_id_ = transaction_id;
+  current_ = true;
+  may_be_valid_ = true;
+  PW_LOG_DEBUG("Wrote index checkpoint %u to slot %u: %u entries, %u bytes",
+               unsigned(header.sequence),
+               unsigned(slot),
+               unsigned(header.entry_count),
+               unsigned(records_size));
+  return OkStatus();
+}
+
+Status IndexCheckpoint::Invalidate() {
+  current_ = false;
+  if (!may_be_valid_) {
+    return OkStatus();
+  }
+
+  for (size_t slot = 0; slot < kSlots; ++slot) {
+    Header header;
+    Status status = ReadHeader(slot, header);
+    if (status.IsNotFound()) {
+      continue;
+    }
+    PW_TRY(status);
+
+    bool invalidated;
+    PW_TRY(IsInvalidated(slot, invalidated));
+    if (!invalidated) {
+      FlashPartition::Output output(*partition_, MarkerAddress(slot));
+      PW_TRY(AlignedWrite<kBufferSize>(
+                 output,
+                 partition_->alignment_bytes(),
+                 {as_bytes(span(&kInvalidatedMarker, 1))})
+                 .status());
+    }
+  }
+
+  may_be_valid_ = false;
+  return OkStatus();
+}
+
+Status IndexCheckpoint::CheckPartition() const {
+  if (partition_ == nullptr || partition_->sector_count() < kSlots ||
+      partition_->alignment_bytes() > kBufferSize) {
+    return Status::FailedPrecondition();
+  }
+  return OkStatus();
+}
+
+Status IndexCheckpoint::ReadHeader(size_t slot, Header& header) const {
+  PW_TRY(partition_->Read(SlotAddress(slot), sizeof(header), &header));
+  if (header.magic != kMagic) {
+    return Status::NotFound();
+  }
+  return OkStatus();
+}
+
+Status IndexCheckpoint::IsInvalidated(size_t slot, bool& invalidated) const {
+  uint32_t marker;
+  PW_TRY(partition_->Read(MarkerAddress(slot), sizeof(marker), &marker));
+  invalidated = !partition_->AppearsErased(as_bytes(span(&marker, 1)));
+  return OkStatus();
+}
+
+IndexCheckpoint::Address IndexCheckpoint::MarkerAddress(size_t slot) const {
+  return SlotAddress(slot) +
+         AlignUp(sizeof(Header), partition_->alignment_bytes());
+}
+
+IndexCheckpoint::Address IndexCheckpoint::RecordsAddress(size_t slot) const {
+  return MarkerAddress(slot) +
+         AlignUp(sizeof(kInvalidatedMarker), partition_->alignment_bytes());
+}
+
+}  // namespace pw::kvs::internal
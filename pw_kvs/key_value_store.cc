@@ -32,6 +32,11 @@ namespace {
 
 using std::byte;
 
+// Buffer for writing batches. Larger than an Entry's write buffer, so that
+// the entries of a batch take fewer writes.
+constexpr size_t kBatchWriteBufferSize =
+    std::max(kMaxFlashAlignment, size_t{256});
+
 constexpr bool InvalidKey(Key key) {
   return key.empty() || (key.size() > internal::Entry::kMaxKeyLength);
 }
@@ -51,6 +56,7 @@ KeyValueStore::KeyValueStore(FlashPartition* partition,
       sectors_(sector_descriptor_list, *partition, temp_sectors_to_skip),
       entry_cache_(key_descriptor_list, addresses, redundancy),
       options_(options),
+      index_(options.index_partition),
       initialized_(InitializationState::kNotInitialized),
       error_detected_(false),
       internal_stats_({}),
@@ -92,7 +98,7 @@ Status KeyValueStore::Init() {
     return Status::FailedPrecondition();
   }
 
-  Status metadata_result = InitializeMetadata();
+  Status metadata_result = InitializeMetadata(/*use_index_checkpoint=*/true);
 
   if (!error_detected_) {
     initialized_ = InitializationState::kReady;
@@ -124,6 +130,8 @@ Status KeyValueStore::Init() {
     }
   }
 
+  CheckpointIndexIfNeeded(/*replace_outdated=*/true);
+
   PW_LOG_INFO(
       "KeyValueStore init complete: active keys %u, deleted keys %u, sectors "
       "%u, logical sector size %u bytes",
@@ -143,91 +151,43 @@ Status KeyValueStore::Init() {
   return OkStatus();
 }
 
-Status KeyValueStore::InitializeMetadata() {
-  const size_t sector_size_bytes = partition_.sector_size_bytes();
-
-  sectors_.Reset();
-  entry_cache_.Reset();
-
-  PW_LOG_DEBUG("First pass: Read all entries from all sectors");
-  Address sector_address = 0;
-
+Status KeyValueStore::InitializeMetadata(bool use_index_checkpoint) {
   size_t total_corrupt_bytes = 0;
   size_t corrupt_entries = 0;
-  bool empty_sector_found = false;
   size_t entry_copies_missing = 0;
 
-  for (SectorDescriptor& sector : sectors_) {
-    Address entry_address = sector_address;
-
-    size_t sector_corrupt_bytes = 0;
-
-    for (int num_entries_in_sector = 0; true; num_entries_in_sector++) {
-      PW_LOG_DEBUG("Load entry: sector=%u, entry#=%d, address=%u",
-                   unsigned(sector_address),
-                   num_entries_in_sector,
-                   unsigned(entry_address));
-
-      if (!sectors_.AddressInSector(sector, entry_address)) {
-        PW_LOG_DEBUG("Fell off end of sector; moving to the next sector");
-        break;
-      }
-
-      Address next_entry_address;
-      Status status = LoadEntry(entry_address, &next_entry_address);
-      if (status.IsNotFound()) {
-        PW_LOG_DEBUG(
-            "Hit un-written data in sector; moving to the next sector");
-        break;
-      } else if (!status.ok()) {
-        // The entry could not be read, indicating likely data corruption within
-        // the sector. Try to scan the remainder of the sector for other
-        // entries.
-
-        error_detected_ = true;
-        corrupt_entries++;
-
-        status = ScanForEntry(sector,
-                              entry_address + Entry::kMinAlignmentBytes,
-                              &next_entry_address);
-        if (!status.ok()) {
-          // No further entries in this sector. Mark the remaining bytes in the
-          // sector as corrupt (since we can't reliably know the size of the
-          // corrupt entry).
-          sector_corrupt_bytes +=
-              sector_size_bytes - (entry_address - sector_address);
-          break;
-        }
-
-        sector_corrupt_bytes += next_entry_address - entry_address;
-      }
-
-      // Entry loaded successfully; so get ready to load the next one.
-      entry_address = next_entry_address;
-
-      // Update of the number of writable bytes in this sector.
-      sector.set_writable_bytes(sector_size_bytes -
-                                (entry_address - sector_address));
+  bool index_loaded = use_index_checkpoint && LoadIndexCheckpoint();
+  if (index_loaded) {
+    PW_LOG_DEBUG("First pass: Read entries written after the index checkpoint");
+    Status status = LoadSectors(
+        /*after_checkpoint=*/true, total_corrupt_bytes, corrupt_entries);
+    if (!status.ok()) {
+      PW_LOG_WARN(
+          "Failed to load entries written after the index checkpoint (%s); "
+          "reading all entries",
+          status.str());
+      index_.set_outdated();
+      index_loaded = false;
     }
+  }
 
-    if (sector_corrupt_bytes > 0) {
-      // If the sector contains corrupt data, prevent any further entries from
-      // being written to it by indicating that it has no space. This should
-      // also make it a decent GC candidate. Valid keys in the sector are still
-      // readable as normal.
-      sector.mark_corrupt();
-      error_detected_ = true;
+  if (!index_loaded) {
+    sectors_.Reset();
+    entry_cache_.Reset();
 
-      PW_LOG_WARN("Sector %u contains %uB of corrupt data",
-                  sectors_.Index(sector),
-                  unsigned(sector_corrupt_bytes));
-    }
+    PW_LOG_DEBUG("First pass: Read all entries from all sectors");
+    // Errors are recorded in error_detected_.
+    LoadSectors(
+        /*after_checkpoint=*/false, total_corrupt_bytes, corrupt_entries)
+        .IgnoreError();
+  }
 
-    if (sector.Empty(sector_size_bytes)) {
+  bool empty_sector_found = false;
+  for (const SectorDescriptor& sector : sectors_) {
+    if (sector.Empty(partition_.sector_size_bytes())) {
       empty_sector_found = true;
+      break;
     }
-    sector_address += sector_size_bytes;
-    total_corrupt_bytes += sector_corrupt_bytes;
   }
 
   PW_LOG_DEBUG("Second pass: Count valid bytes in each sector");
@@ -236,7 +196,8 @@ Status KeyValueStore::InitializeMetadata() {
   // For every valid entry, for each address, count the valid bytes in that
   // sector. If the address fails to read, remove the address and mark the
   // sector as corrupt. Track which entry has the newest transaction ID for
-  // initializing last_new_sector_.
+  // initializing last_new_sector_. The valid bytes are loaded with an index
+  // checkpoint, so entries are not read again in that case.
   for (EntryMetadata& metadata : entry_cache_) {
     if (metadata.addresses().size() < redundancy()) {
       PW_LOG_DEBUG("Key 0x%08x missing copies, has %u, needs %u",
@@ -246,7 +207,7 @@ Status KeyValueStore::InitializeMetadata() {
       entry_copies_missing++;
     }
     size_t index = 0;
-    while (index < metadata.addresses().size()) {
+    while (!index_loaded && index < metadata.addresses().size()) {
       Address address = metadata.addresses()[index];
       Entry entry;
 
@@ -307,6 +268,134 @@ Status KeyValueStore::InitializeMetadata() {
   return OkStatus();
 }
 
+bool KeyValueStore::LoadIndexCheckpoint() {
+  if (!index_.enabled()) {
+    return false;
+  }
+
+  Status status = index_.Load(
+      entry_cache_, sectors_, partition_.sector_size_bytes());
+
+  // The checkpoint is only usable if it refers to the entries in this
+  // partition. Check that the newest entry it refers to was written with the
+  // expected transaction ID, since the partition may have been erased or
+  // rewritten since the checkpoint was written.
+  if (status.ok() && entry_cache_.total_entries() > 0) {
+    uint32_t newest_transaction_id = 0;
+    Address newest_address = 0;
+    for (const EntryMetadata& metadata : entry_cache_) {
+      if (metadata.IsNewerThan(newest_transaction_id)) {
+        newest_transaction_id = metadata.transaction_id();
+        newest_address = metadata.first_address();
+      }
+    }
+    Entry entry;
+    if (!Entry::Read(partition_, newest_address, formats_, &entry).ok() ||
+        entry.transaction_id() != newest_transaction_id) {
+      status = Status::DataLoss();
+    }
+  }
+
+  if (!status.ok()) {
+    if (!status.IsNotFound()) {
+      PW_LOG_WARN("Unable to use index checkpoint (%s); reading all entries",
+                  status.str());
+    }
+    index_.set_outdated();
+    return false;
+  }
+
+  PW_LOG_INFO("Loaded index checkpoint with %u entries at transaction %u",
+              unsigned(entry_cache_.total_entries()),
+              unsigned(index_.transaction_id()));
+  return true;
+}
+
+Status KeyValueStore::LoadSectors(bool after_checkpoint,
+                                  size_t& total_corrupt_bytes,
+                                  size_t& corrupt_entries) {
+  const size_t sector_size_bytes = partition_.sector_size_bytes();
+
+  for (SectorDescriptor& sector : sectors_) {
+    const Address sector_address = sectors_.BaseAddress(sector);
+    Address entry_address = after_checkpoint
+                                ? sectors_.NextWritableAddress(sector)
+                                : sector_address;
+
+    size_t sector_corrupt_bytes = 0;
+
+    for (int num_entries_in_sector = 0; true; num_entries_in_sector++) {
+      PW_LOG_DEBUG("Load entry: sector=%u, entry#=%d, address=%u",
+                   unsigned(sector_address),
+                   num_entries_in_sector,
+                   unsigned(entry_address));
+
+      if (!sectors_.AddressInSector(sector, entry_address)) {
+        PW_LOG_DEBUG("Fell off end of sector; moving to the next sector");
+        break;
+      }
+
+      Address next_entry_address;
+      Status status =
+          LoadEntry(entry_address, &next_entry_address, after_checkpoint);
+      if (status.IsNotFound()) {
+        PW_LOG_DEBUG(
+            "Hit un-written data in sector; moving to the next sector");
+        break;
+      } else if (!status.ok()) {
+        if (after_checkpoint) {
+          return status;
+        }
+
+        // The entry could not be read, indicating likely data corruption within
+        // the sector. Try to scan the remainder of the sector for other
+        // entries.
+
+        error_detected_ = true;
+        corrupt_entries++;
+
+        status = ScanForEntry(sector,
+                              entry_address + Entry::kMinAlignmentBytes,
+                              &next_entry_address);
+        if (!status.ok()) {
+          // No further entries in this sector. Mark the remaining bytes in the
+          // sector as corrupt (since we can't reliably know the size of the
+          // corrupt entry).
+          sector_corrupt_bytes +=
+              sector_size_bytes - (entry_address - sector_address);
+          break;
+        }
+
+        sector_corrupt_bytes += next_entry_address - entry_address;
+      }
+
+      // Entry loaded successfully; so get ready to load the next one.
+      entry_address = next_entry_address;
+
+      // Update of the number of writable bytes in this sector.
+      sector.set_writable_bytes(sector_size_bytes -
+                                (entry_address - sector_address));
+    }
+
+    if (sector_corrupt_bytes > 0) {
+      // If the sector contains corrupt data, prevent any further entries from
+      // being written to it by indicating that it has no space. This should
+      // also make it a decent GC candidate. Valid keys in the sector are still
+      // readable as normal.
+      sector.mark_corrupt();
+      error_detected_ = true;
+
+      PW_LOG_WARN("Sector %u contains %uB of corrupt data",
+                  sectors_.Index(sector),
+                  unsigned(sector_corrupt_bytes));
+    }
+
+    total_corrupt_bytes += sector_corrupt_bytes;
+  }
+
+  return OkStatus();
+}
+
 KeyValueStore::StorageStats KeyValueStore::GetStorageStats() const {
   StorageStats stats{};
   const size_t sector_size = partition_.sector_size_bytes();
@@ -361,10 +450,15 @@ bool KeyValueStore::CheckForErrors() {
 }
 
 Status KeyValueStore::LoadEntry(Address entry_address,
-                                Address* next_entry_address) {
+                                Address* next_entry_address,
+                                bool after_checkpoint) {
   Entry entry;
   PW_TRY(Entry::Read(partition_, entry_address, formats_, &entry));
 
+  if (entry.batch_marker()) {
+    return LoadBatch(entry, next_entry_address, after_checkpoint);
+  }
+
   // Read the key from flash & validate the entry (which reads the value).
   Entry::KeyBuffer key_buffer;
   PW_TRY_ASSIGN(size_t key_length, entry.ReadKey(key_buffer));
@@ -375,10 +469,108 @@ Status KeyValueStore::LoadEntry(Address entry_address,
   // A valid entry was found, so update the next entry address before doing any
   // of the checks that happen in AddNewOrUpdateExisting.
   *next_entry_address = entry.next_address();
+  return AddLoadedEntry(entry, key, after_checkpoint);
+}
+
+Status KeyValueStore::LoadBatch(const Entry& marker,
+                                Address* next_entry_address,
+                                bool after_checkpoint) {
+  PW_TRY(marker.VerifyChecksumInFlash());
+
+  uint32_t entry_count;
+  if (marker.value_size() != sizeof(entry_count)) {
+    return Status::DataLoss();
+  }
+  PW_TRY(marker.ReadValue(as_writable_bytes(span(&entry_count, 1))).status());
+
+  // A batch is written in one pass, so if it was interrupted, the entries
+  // before the interruption are intact. Check that all of them were written
+  // before loading any. The next entry is then loaded from the first missing
+  // one, which is either unwritten or corrupt.
+  const SectorDescriptor& sector = sectors_.FromAddress(marker.address());
+  Address address = marker.next_address();
+  Entry::KeyBuffer key_buffer;
+
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    Entry entry;
+    if (!sectors_.AddressInSector(sector, address) ||
+        !Entry::Read(partition_, address, formats_, &entry).ok() ||
+        !entry.batch() || entry.batch_marker() ||
+        entry.transaction_id() != marker.transaction_id() ||
+        !entry.ReadKey(key_buffer).ok() ||
+        !entry.VerifyChecksumInFlash().ok()) {
+      PW_LOG_WARN("Discarding incomplete batch of %u entries at address %u",
+                  unsigned(entry_count),
+                  unsigned(marker.address()));
+      *next_entry_address = address;
+      return OkStatus();
+    }
+    address = entry.next_address();
+  }
+
+  *next_entry_address = address;
+
+  address = marker.next_address();
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    Entry entry;
+    PW_TRY(Entry::Read(partition_, address, formats_, &entry));
+    PW_TRY_ASSIGN(size_t key_length, entry.ReadKey(key_buffer));
+    PW_TRY(AddLoadedEntry(
+        entry, Key(key_buffer.data(), key_length), after_checkpoint));
+    address = entry.next_address();
+  }
+  return OkStatus();
+}
+
+Status KeyValueStore::AddLoadedEntry(const Entry& entry,
+                                     Key key,
+                                     bool after_checkpoint) {
+  if (after_checkpoint) {
+    return AddEntryAfterCheckpoint(entry, key);
+  }
   return entry_cache_.AddNewOrUpdateExisting(
       entry.descriptor(key), entry.address(), partition_.sector_size_bytes());
 }
 
+Status KeyValueStore::AddEntryAfterCheckpoint(const Entry& entry, Key key) {
+  const KeyDescriptor descriptor = entry.descriptor(key);
+
+  // AddNewOrUpdateExisting matches entries by hash alone, so do the same here.
+  auto find = [this](uint32_t hash, EntryMetadata& metadata_out) {
+    for (EntryMetadata& metadata : entry_cache_) {
+      if (metadata.hash() == hash) {
+        metadata_out = metadata;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // A newer version of an entry replaces all copies of the older one, which no
+  // longer count as valid bytes.
+  EntryMetadata metadata;
+  if (find(descriptor.key_hash, metadata) &&
+      descriptor.transaction_id > metadata.transaction_id()) {
+    Entry prior_entry;
+    PW_TRY(Entry::Read(
+        partition_, metadata.first_address(), formats_, &prior_entry));
+    for (Address address : metadata.addresses()) {
+      sectors_.FromAddress(address).RemoveValidBytes(prior_entry.size());
+    }
+  }
+
+  PW_TRY(entry_cache_.AddNewOrUpdateExisting(
+      descriptor, entry.address(), partition_.sector_size_bytes()));
+
+  // The entry counts as valid bytes if it was added as the newest version or
+  // as a redundant copy, rather than ignored as stale or surplus.
+  if (find(descriptor.key_hash, metadata) &&
+      metadata.addresses().back() == entry.address()) {
+    sectors_.FromAddress(entry.address()).AddValidBytes(entry.size());
+  }
+  return OkStatus();
+}
+
 // Scans flash memory within a sector to find a KVS entry magic.
 Status KeyValueStore::ScanForEntry(const SectorDescriptor& sector,
                                    Address start_address,
@@ -487,6 +679,115 @@ Status KeyValueStore::PutBytes(Key key, span<const byte> value) {
   return status;
 }
 
+Status KeyValueStore::PutBatch(span<const KeyValue> batch) {
+  if (!initialized()) {
+    return Status::FailedPrecondition();
+  }
+
+  if (batch.empty()) {
+    return OkStatus();
+  }
+
+  // Check every entry before writing any, and find the space the batch needs.
+  const uint32_t entry_count = static_cast<uint32_t>(batch.size());
+  const size_t marker_size =
+      Entry::size(partition_, {}, as_bytes(span(&entry_count, 1)));
+  size_t batch_size = marker_size;
+  size_t new_keys = 0;
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const KeyValue& item = batch[i];
+    PW_TRY(CheckWriteOperation(item.key));
+
+    const uint32_t hash = internal::Hash(item.key);
+    for (size_t j = 0; j < i; ++j) {
+      if (internal::Hash(batch[j].key) == hash) {
+        PW_LOG_DEBUG("Key 0x%08x appears more than once in batch",
+                     unsigned(hash));
+        return Status::InvalidArgument();
+      }
+    }
+
+    EntryMetadata metadata;
+    Status status = FindEntry(item.key, &metadata);
+    if (status.IsNotFound()) {
+      new_keys += 1;
+    } else {
+      PW_TRY(status);
+    }
+
+    batch_size += Entry::size(partition_, item.key, item.value);
+  }
+
+  if (batch_size > partition_.sector_size_bytes()) {
+    PW_LOG_DEBUG("%u B batch of %u entries cannot fit in one sector",
+                 unsigned(batch_size),
+                 unsigned(entry_count));
+    return Status::InvalidArgument();
+  }
+
+  if (entry_cache_.total_entries() + new_keys > entry_cache_.max_entries()) {
+    PW_LOG_WARN(
+        "KVS full: trying to store %u new entries, but can't. Have %u entries",
+        unsigned(new_keys),
+        unsigned(entry_cache_.total_entries()));
+    return Status::ResourceExhausted();
+  }
+
+  // Find a sector for each copy of the batch. This may involve garbage
+  // collecting one or more sectors.
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+  PW_TRY(GetAddressesForWrite(reserved_addresses, batch_size));
+
+  // All entries in the batch share a transaction ID, which is burned even if
+  // the write fails, as in CreateEntry.
+  last_transaction_id_ += 1;
+  PW_TRY(AppendBatch(batch, reserved_addresses[0], batch_size));
+
+  // The batch is committed once its first copy is written, so update the key
+  // descriptors. Older entries for the keys, and their copies, become stale.
+  Address address = reserved_addresses[0] + marker_size;
+  for (const KeyValue& item : batch) {
+    const KeyDescriptor descriptor{internal::Hash(item.key),
+                                   last_transaction_id_,
+                                   EntryState::kValid};
+    EntryMetadata metadata;
+    if (FindEntry(item.key, &metadata).ok()) {
+      Entry prior_entry;
+      if (ReadEntry(metadata, prior_entry).ok()) {
+        for (Address prior_address : metadata.addresses()) {
+          sectors_.FromAddress(prior_address)
+              .RemoveValidBytes(prior_entry.size());
+        }
+      } else {
+        // The sector accounting is fixed when the metadata is reinitialized
+        // during maintenance.
+        error_detected_ = true;
+      }
+      metadata.Reset(descriptor, address);
+    } else {
+      entry_cache_.AddNew(descriptor, address);
+    }
+    address += Entry::size(partition_, item.key, item.value);
+  }
+
+  // Write the additional copies of the batch, if redundancy is greater than 1.
+  for (size_t i = 1; i < redundancy(); ++i) {
+    PW_TRY(AppendBatch(batch, reserved_addresses[i], batch_size));
+
+    address = reserved_addresses[i] + marker_size;
+    for (const KeyValue& item : batch) {
+      EntryMetadata metadata;
+      PW_TRY(FindEntry(item.key, &metadata));
+      metadata.AddNewAddress(address);
+      address += Entry::size(partition_, item.key, item.value);
+    }
+  }
+
+  CheckpointIndexIfNeeded(/*replace_outdated=*/false);
+  return OkStatus();
+}
+
 Status KeyValueStore::Delete(Key key) {
   PW_TRY(CheckWriteOperation(key));
 
@@ -746,6 +1047,8 @@ Status KeyValueStore::WriteEntry(Key key,
     PW_TRY(AppendEntry(entry, key, value));
     new_metadata.AddNewAddress(reserved_addresses[i]);
   }
+
+  CheckpointIndexIfNeeded(/*replace_outdated=*/false);
   return OkStatus();
 }
 
@@ -876,6 +1179,63 @@ Status KeyValueStore::AppendEntry(const Entry& entry,
   return OkStatus();
 }
 
+Status KeyValueStore::AppendBatch(span<const KeyValue> batch,
+                                  Address address,
+                                  size_t batch_size) {
+  SectorDescriptor& sector = sectors_.FromAddress(address);
+  const EntryFormat& format = formats_.primary();
+
+  // Stream the marker and entries through one buffer, so that consecutive
+  // entries are combined into fewer, larger flash writes.
+  const uint32_t entry_count = static_cast<uint32_t>(batch.size());
+  const Entry marker = Entry::BatchMarker(
+      partition_, address, format, entry_count, last_transaction_id_);
+  const size_t valid_bytes = batch_size - marker.size();
+
+  FlashPartition::Output output(partition_, address);
+  AlignedWriterBuffer<kBatchWriteBufferSize> writer(
+      partition_.alignment_bytes(), output);
+
+  Status status = marker.Write(writer, {}, as_bytes(span(&entry_count, 1)));
+  Address entry_address = marker.next_address();
+  for (size_t i = 0; status.ok() && i < batch.size(); ++i) {
+    const Entry entry = Entry::BatchValid(partition_,
+                                          entry_address,
+                                          format,
+                                          batch[i].key,
+                                          batch[i].value,
+                                          last_transaction_id_);
+    status = entry.Write(writer, batch[i].key, batch[i].value);
+    entry_address = entry.next_address();
+  }
+  const StatusWithSize result = writer.Flush();
+  if (status.ok()) {
+    status = result.status();
+  }
+
+  if (!status.ok()) {
+    PW_LOG_ERROR("Failed to write %u byte batch at %#x",
+                 unsigned(batch_size),
+                 unsigned(address));
+    return MarkSectorCorruptIfNotOk(status, &sector);
+  }
+
+  if (options_.verify_on_write) {
+    for (entry_address = address; entry_address < address + batch_size;) {
+      Entry entry;
+      PW_TRY(MarkSectorCorruptIfNotOk(
+          Entry::Read(partition_, entry_address, formats_, &entry), &sector));
+      PW_TRY(MarkSectorCorruptIfNotOk(entry.VerifyChecksumInFlash(), &sector));
+      entry_address = entry.next_address();
+    }
+  }
+
+  // The marker is only needed to load the batch, so it is not valid data.
+  sector.RemoveWritableBytes(batch_size);
+  sector.AddValidBytes(valid_bytes);
+  return OkStatus();
+}
+
 StatusWithSize KeyValueStore::CopyEntryToSector(Entry& entry,
                                                 SectorDescriptor* new_sector,
                                                 Address new_address) {
@@ -1010,6 +1370,7 @@ Status KeyValueStore::FullMaintenanceHelper(MaintenanceType maintenance_type) {
 #endif  // PW_KVS_REMOVE_DELETED_KEYS_IN_HEAVY_MAINTENANCE
 
   if (overall_status.ok()) {
+    CheckpointIndexIfNeeded(/*replace_outdated=*/true);
     PW_LOG_INFO("Full maintenance complete");
   } else {
     PW_LOG_ERROR("Full maintenance finished with some errors");
@@ -1017,6 +1378,35 @@ Status KeyValueStore::FullMaintenanceHelper(MaintenanceType maintenance_type) {
   return overall_status;
 }
 
+Status KeyValueStore::CheckpointIndex() {
+  if (!index_.enabled() || !initialized() || error_detected_) {
+    return Status::FailedPrecondition();
+  }
+  return index_.Write(entry_cache_,
+                      sectors_,
+                      partition_.sector_size_bytes(),
+                      last_transaction_id_);
+}
+
+void KeyValueStore::CheckpointIndexIfNeeded(bool replace_outdated) {
+  if (!index_.enabled() || !initialized() || error_detected_) {
+    return;
+  }
+
+  const bool outdated = replace_outdated && !index_.current();
+  const bool due = options_.index_checkpoint_interval != 0 &&
+                   last_transaction_id_ - index_.transaction_id() >=
+                       options_.index_checkpoint_interval;
+  if (!outdated && !due) {
+    return;
+  }
+
+  Status status = CheckpointIndex();
+  if (!status.ok()) {
+    PW_LOG_WARN("Failed to write index checkpoint: %s", status.str());
+  }
+}
+
 Status KeyValueStore::PartialMaintenance() {
   if (initialized_ == InitializationState::kNotInitialized) {
     return Status::FailedPrecondition();
@@ -1085,8 +1475,10 @@ Status KeyValueStore::GarbageCollectSector(
     return Status::Internal();
   }
 
-  // Step 2: Reinitialize the sector
+  // Step 2: Reinitialize the sector. Index checkpoints may refer to entries in
+  // it, so they can no longer be used.
   if (!sector_to_gc.Empty(partition_.sector_size_bytes())) {
+    PW_TRY(index_.Invalidate());
     sector_to_gc.mark_corrupt();
     internal_stats_.sector_erase_count++;
     PW_TRY(partition_.Erase(sectors_.BaseAddress(sector_to_gc), 1));
@@ -1103,8 +1495,12 @@ StatusWithSize KeyValueStore::UpdateEntriesToPrimaryFormat() {
   for (EntryMetadata& prior_metadata : entry_cache_) {
     Entry entry;
     PW_TRY_WITH_SIZE(ReadEntry(prior_metadata, entry));
-    if (formats_.primary().magic == entry.magic()) {
-      // Ignore entries that are already on the primary format.
+    const uint32_t primary_magic =
+        entry.batch() ? internal::BatchMagic(formats_.primary().magic)
+                      : formats_.primary().magic;
+    if (primary_magic == entry.magic()) {
+      // Ignore entries that are already on the primary format. Batch entries
+      // keep their batch magic, so older KVS versions never load them.
       continue;
     }
 
@@ -1113,7 +1509,7 @@ StatusWithSize KeyValueStore::UpdateEntriesToPrimaryFormat() {
         "[0x%08x]",
         unsigned(prior_metadata.hash()),
         unsigned(entry.magic()),
-        unsigned(formats_.primary().magic));
+        unsigned(primary_magic));
 
     entries_updated++;
 
@@ -1298,7 +1694,7 @@ Status KeyValueStore::Repair() {
   PW_LOG_INFO("Starting KVS repair");
 
   PW_LOG_DEBUG("Reinitialize KVS metadata");
-  InitializeMetadata()
+  InitializeMetadata(/*use_index_checkpoint=*/false)
       .IgnoreError();  // TODO: b/242598609 - Handle Status properly
 
   return FixErrors();
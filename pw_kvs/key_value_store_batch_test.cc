@@ -0,0 +1,293 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/flash_partition_with_stats.h"
+#include "pw_kvs/format.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kSectors = 6;
+constexpr size_t kSectorSize = 512;
+constexpr size_t kAlignment = 16;
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat = {.magic = 0x7d2e61a4, .checksum = &checksum};
+
+constexpr const char* kKeys[] = {
+    "key_0", "key_1", "key_2", "key_3", "key_4", "key_5", "key_6", "key_7"};
+constexpr size_t kKeyCount = std::size(kKeys);
+
+// Writes only the first write_budget bytes after set_write_budget is called,
+// as if power were lost once they were written.
+class PowerLossPartition : public FlashPartitionWithStatsBuffer<kSectors> {
+ public:
+  using FlashPartitionWithStatsBuffer::FlashPartitionWithStatsBuffer;
+  using FlashPartitionWithStats::Write;
+
+  StatusWithSize Write(Address address, span<const std::byte> data) override {
+    if (!budget_enabled_) {
+      return FlashPartitionWithStats::Write(address, data);
+    }
+    const size_t size = std::min(data.size(), write_budget_);
+    write_budget_ -= size;
+    if (size > 0u) {
+      StatusWithSize result =
+          FlashPartitionWithStats::Write(address, data.first(size));
+      if (!result.ok()) {
+        return result;
+      }
+    }
+    return size == data.size() ? StatusWithSize(size)
+                               : StatusWithSize::DataLoss(size);
+  }
+
+  void set_write_budget(size_t bytes) {
+    budget_enabled_ = true;
+    write_budget_ = bytes;
+  }
+
+  void clear_write_budget() { budget_enabled_ = false; }
+
+ private:
+  bool budget_enabled_ = false;
+  size_t write_budget_ = 0;
+};
+
+class KeyValueStoreBatchTest : public ::testing::Test {
+ protected:
+  KeyValueStoreBatchTest()
+      : flash_(kAlignment), partition_(&flash_, 0, kSectors, kAlignment) {}
+
+  // Creates a KVS as it would be on boot.
+  template <size_t kRedundancy = 1>
+  KeyValueStoreBuffer<kMaxEntries, kSectors, kRedundancy> CreateKvs() {
+    return KeyValueStoreBuffer<kMaxEntries, kSectors, kRedundancy>(&partition_,
+                                                                    kFormat);
+  }
+
+  // Fills a batch with every key, with values offset from the key's index.
+  void FillBatch(uint32_t value_offset) {
+    for (size_t i = 0; i < kKeyCount; ++i) {
+      values_[i] = static_cast<uint32_t>(i) + value_offset;
+      batch_[i] = {kKeys[i], as_bytes(span(&values_[i], 1))};
+    }
+  }
+
+  // Counts the 32 B entries in the partition with the given magic.
+  size_t CountEntries(uint32_t magic) {
+    size_t count = 0;
+    for (size_t address = 0; address < kSectors * kSectorSize; address += 32) {
+      uint32_t entry_magic = 0;
+      EXPECT_EQ(
+          OkStatus(),
+          partition_.Read(address, as_writable_bytes(span(&entry_magic, 1)))
+              .status());
+      if (entry_magic == magic) {
+        count += 1;
+      }
+    }
+    return count;
+  }
+
+  // Expects every key to have the value written by FillBatch.
+  static void ExpectValues(KeyValueStore& kvs, uint32_t value_offset) {
+    for (size_t i = 0; i < kKeyCount; ++i) {
+      uint32_t value = 0;
+      ASSERT_EQ(OkStatus(), kvs.Get(kKeys[i], &value));
+      EXPECT_EQ(value, i + value_offset);
+    }
+  }
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectors> flash_;
+  PowerLossPartition partition_;
+  std::array<uint32_t, kKeyCount> values_;
+  std::array<KeyValueStore::KeyValue, kKeyCount> batch_;
+};
+
+TEST_F(KeyValueStoreBatchTest, PutBatch_AddsAndUpdatesEntries) {
+  auto kvs = CreateKvs();
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Put(kKeys[0], uint32_t{1000}));
+
+  const uint32_t transaction_count = kvs.transaction_count();
+  FillBatch(100);
+  ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+
+  EXPECT_EQ(kvs.size(), kKeyCount);
+  EXPECT_EQ(kvs.transaction_count(), transaction_count + 1);
+  ExpectValues(kvs, 100);
+
+  auto next_boot = CreateKvs();
+  ASSERT_EQ(OkStatus(), next_boot.Init());
+  EXPECT_EQ(next_boot.size(), kKeyCount);
+  ExpectValues(next_boot, 100);
+}
+
+TEST_F(KeyValueStoreBatchTest, PutBatch_FewerWritesThanPuts) {
+  auto kvs = CreateKvs();
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  FillBatch(0);
+  partition_.ResetCounters();
+  for (const KeyValueStore::KeyValue& item : batch_) {
+    ASSERT_EQ(OkStatus(), kvs.Put(item.key, item.value));
+  }
+  const size_t put_writes = partition_.total_write_count();
+  const size_t put_bytes = partition_.total_bytes_written();
+
+  FillBatch(100);
+  partition_.ResetCounters();
+  ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+
+  // Each 32 B entry is one write when put separately. The batch adds a 32 B
+  // marker, and is written in 256 B chunks.
+  EXPECT_EQ(put_writes, kKeyCount);
+  EXPECT_EQ(partition_.total_write_count(), 2u);
+  EXPECT_EQ(partition_.total_bytes_written(), put_bytes + 32);
+}
+
+TEST_F(KeyValueStoreBatchTest, InterruptedBatch_LoadsAllOrNone) {
+  const size_t batch_bytes = (kKeyCount + 1) * 32;
+
+  for (size_t written = 0; written <= batch_bytes; written += kAlignment) {
+    ASSERT_EQ(OkStatus(), partition_.Erase());
+    {
+      auto kvs = CreateKvs();
+      ASSERT_EQ(OkStatus(), kvs.Init());
+      FillBatch(0);
+      ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+
+      FillBatch(100);
+      partition_.set_write_budget(written);
+      EXPECT_EQ(written == batch_bytes, kvs.PutBatch(batch_).ok());
+      partition_.clear_write_budget();
+    }
+
+    auto kvs = CreateKvs();
+    kvs.Init().IgnoreError();  // Torn entries are corrupt data.
+    ASSERT_EQ(kvs.size(), kKeyCount);
+    ExpectValues(kvs, written == batch_bytes ? 100 : 0);
+  }
+}
+
+TEST_F(KeyValueStoreBatchTest, Redundancy_WritesEveryCopy) {
+  {
+    auto kvs = CreateKvs<2>();
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    FillBatch(0);
+    ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+  }
+
+  // Init fails if a key is missing copies.
+  auto kvs = CreateKvs<2>();
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ExpectValues(kvs, 0);
+}
+
+TEST_F(KeyValueStoreBatchTest, RepeatedBatches_GarbageCollected) {
+  {
+    auto kvs = CreateKvs();
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    for (uint32_t i = 0; i < 20; ++i) {
+      FillBatch(i * 100);
+      ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+    }
+    EXPECT_GT(kvs.GetStorageStats().sector_erase_count, 0u);
+    ExpectValues(kvs, 1900);
+  }
+
+  auto kvs = CreateKvs();
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ExpectValues(kvs, 1900);
+}
+
+TEST_F(KeyValueStoreBatchTest, PutBatch_UsesBatchMagic) {
+  auto kvs = CreateKvs();
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  FillBatch(0);
+  ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+
+  // The marker and every entry have the batch magic. A KVS without batches
+  // looks up entries by the format's magic alone, so it finds no format for
+  // any of them and loads none.
+  const uint32_t batch_magic = internal::BatchMagic(kFormat.magic);
+  EXPECT_EQ(CountEntries(batch_magic), kKeyCount + 1);
+  EXPECT_EQ(CountEntries(kFormat.magic), 0u);
+  EXPECT_EQ(internal::EntryFormats(kFormat).Find(batch_magic), nullptr);
+
+  // Entries put separately keep the format's magic.
+  ASSERT_EQ(OkStatus(), kvs.Put(kKeys[0], uint32_t{1000}));
+  EXPECT_EQ(CountEntries(kFormat.magic), 1u);
+}
+
+TEST_F(KeyValueStoreBatchTest, UpdateToPrimaryFormat_KeepsBatchMagic) {
+  constexpr EntryFormat kNewFormat = {.magic = 0x0c83e2b1,
+                                      .checksum = &checksum};
+  {
+    auto kvs = CreateKvs();
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    FillBatch(0);
+    ASSERT_EQ(OkStatus(), kvs.PutBatch(batch_));
+  }
+
+  const EntryFormat formats[] = {kNewFormat, kFormat};
+  KeyValueStoreBuffer<kMaxEntries, kSectors, 1, 2> kvs(&partition_, formats);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ExpectValues(kvs, 0);
+  ASSERT_EQ(OkStatus(), kvs.FullMaintenance());
+  ExpectValues(kvs, 0);
+
+  // Each entry was rewritten with the new format's batch magic. The marker is
+  // not rewritten.
+  EXPECT_EQ(CountEntries(internal::BatchMagic(kNewFormat.magic)), kKeyCount);
+  EXPECT_EQ(CountEntries(kNewFormat.magic), 0u);
+}
+
+TEST_F(KeyValueStoreBatchTest, PutBatch_InvalidBatch) {
+  auto kvs = CreateKvs();
+  EXPECT_EQ(Status::FailedPrecondition(), kvs.PutBatch(batch_));
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  FillBatch(0);
+  batch_[3].key = batch_[1].key;
+  EXPECT_EQ(Status::InvalidArgument(), kvs.PutBatch(batch_));
+
+  batch_[3].key = "";
+  EXPECT_EQ(Status::InvalidArgument(), kvs.PutBatch(batch_));
+
+  std::array<std::byte, kSectorSize / 2> large_value{};
+  FillBatch(0);
+  batch_[0].value = large_value;
+  batch_[1].value = large_value;
+  EXPECT_EQ(Status::InvalidArgument(), kvs.PutBatch(batch_));
+
+  EXPECT_EQ(kvs.size(), 0u);
+  EXPECT_EQ(OkStatus(), kvs.PutBatch({}));
+}
+
+}  // namespace
+}  // namespace pw::kvs
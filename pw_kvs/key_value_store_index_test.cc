@@ -0,0 +1,272 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 64;
+constexpr size_t kKvsSectors = 6;
+constexpr size_t kIndexSectors = 2;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kKeys = 40;
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat = {.magic = 0x5f0e1b7a, .checksum = &checksum};
+
+// Counts the bytes read from the partition, to tell which entries Init read.
+class ReadCountingPartition : public FlashPartition {
+ public:
+  using FlashPartition::FlashPartition;
+  using FlashPartition::Read;
+
+  StatusWithSize Read(Address address, span<std::byte> output) override {
+    bytes_read_ += output.size();
+    return FlashPartition::Read(address, output);
+  }
+
+  size_t bytes_read() const { return bytes_read_; }
+  void reset_bytes_read() { bytes_read_ = 0; }
+
+ private:
+  size_t bytes_read_ = 0;
+};
+
+class KeyValueStoreIndexTest : public ::testing::Test {
+ protected:
+  KeyValueStoreIndexTest()
+      : flash_(16),
+        kvs_partition_(&flash_, 0, kKvsSectors),
+        index_partition_(&flash_, kKvsSectors, kIndexSectors) {}
+
+  // Creates a KVS as it would be on boot, with or without an index partition.
+  template <size_t kRedundancy = 1>
+  KeyValueStoreBuffer<kMaxEntries, kKvsSectors, kRedundancy> CreateKvs(
+      bool with_index) {
+    Options options;
+    options.index_partition = with_index ? &index_partition_ : nullptr;
+    options.index_checkpoint_interval = interval_;
+    return KeyValueStoreBuffer<kMaxEntries, kKvsSectors, kRedundancy>(
+        &kvs_partition_, kFormat, options);
+  }
+
+  // Returns the bytes of the KVS partition read by Init.
+  size_t InitBytesRead(KeyValueStore& kvs) {
+    kvs_partition_.reset_bytes_read();
+    EXPECT_EQ(OkStatus(), kvs.Init());
+    return kvs_partition_.bytes_read();
+  }
+
+  // Puts count keys starting from key first, with values offset from the
+  // key's index so that rewriting a key changes its value.
+  static void PutKeys(KeyValueStore& kvs,
+                      size_t first,
+                      size_t count,
+                      uint32_t value_offset = 0) {
+    for (size_t i = first; i < first + count; ++i) {
+      ASSERT_EQ(OkStatus(),
+                kvs.Put(Key(i), static_cast<uint32_t>(i) + value_offset));
+    }
+  }
+
+  static std::string Key(size_t i) { return "key_" + std::to_string(i); }
+
+  // Expects a KVS initialized from the index to match one initialized by
+  // reading every entry.
+  template <size_t kRedundancy = 1>
+  void ExpectMatchesFullScan(KeyValueStore& kvs) {
+    auto full_scan = CreateKvs<kRedundancy>(false);
+    ASSERT_EQ(OkStatus(), full_scan.Init());
+
+    EXPECT_EQ(kvs.size(), full_scan.size());
+    EXPECT_EQ(kvs.total_entries_with_deleted(),
+              full_scan.total_entries_with_deleted());
+    EXPECT_EQ(kvs.transaction_count(), full_scan.transaction_count());
+
+    const KeyValueStore::StorageStats stats = kvs.GetStorageStats();
+    const KeyValueStore::StorageStats expected = full_scan.GetStorageStats();
+    EXPECT_EQ(stats.in_use_bytes, expected.in_use_bytes);
+    EXPECT_EQ(stats.reclaimable_bytes, expected.reclaimable_bytes);
+    EXPECT_EQ(stats.writable_bytes, expected.writable_bytes);
+
+    for (const auto& item : full_scan) {
+      uint32_t expected_value = 0;
+      uint32_t value = 0;
+      ASSERT_EQ(OkStatus(), item.Get(&expected_value));
+      ASSERT_EQ(OkStatus(), kvs.Get(item.key(), &value));
+      EXPECT_EQ(value, expected_value);
+    }
+  }
+
+  FakeFlashMemoryBuffer<kSectorSize, kKvsSectors + kIndexSectors> flash_;
+  ReadCountingPartition kvs_partition_;
+  FlashPartition index_partition_;
+  uint32_t interval_ = 0;
+};
+
+TEST_F(KeyValueStoreIndexTest, Init_ReadsOnlyEntriesAfterCheckpoint) {
+  {
+    auto kvs = CreateKvs(true);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    PutKeys(kvs, 0, kKeys);
+    ASSERT_EQ(OkStatus(), kvs.CheckpointIndex());
+
+    ASSERT_EQ(OkStatus(), kvs.Put(Key(1), uint32_t{1000}));
+    ASSERT_EQ(OkStatus(), kvs.Delete(Key(2)));
+    ASSERT_EQ(OkStatus(), kvs.Put(Key(kKeys), static_cast<uint32_t>(kKeys)));
+  }
+
+  auto full_scan = CreateKvs(false);
+  const size_t full_scan_bytes = InitBytesRead(full_scan);
+
+  auto kvs = CreateKvs(true);
+  const size_t index_bytes = InitBytesRead(kvs);
+  EXPECT_LT(index_bytes * 4, full_scan_bytes);
+
+  EXPECT_EQ(kvs.size(), kKeys);
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs.Get(Key(1), &value));
+  EXPECT_EQ(value, 1000u);
+  EXPECT_EQ(Status::NotFound(), kvs.Get(Key(2), &value));
+  ASSERT_EQ(OkStatus(), kvs.Get(Key(kKeys), &value));
+  EXPECT_EQ(value, kKeys);
+
+  ExpectMatchesFullScan(kvs);
+}
+
+TEST_F(KeyValueStoreIndexTest, Init_WithoutCheckpoint_WritesOne) {
+  {
+    auto kvs = CreateKvs(false);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    PutKeys(kvs, 0, kKeys);
+  }
+
+  auto kvs = CreateKvs(true);
+  const size_t full_scan_bytes = InitBytesRead(kvs);
+
+  auto next_boot = CreateKvs(true);
+  EXPECT_LT(InitBytesRead(next_boot) * 4, full_scan_bytes);
+  ExpectMatchesFullScan(next_boot);
+}
+
+TEST_F(KeyValueStoreIndexTest, Put_WritesCheckpointsAtInterval) {
+  interval_ = 8;
+  {
+    auto kvs = CreateKvs(true);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    PutKeys(kvs, 0, kKeys);
+  }
+
+  auto full_scan = CreateKvs(false);
+  const size_t full_scan_bytes = InitBytesRead(full_scan);
+
+  auto kvs = CreateKvs(true);
+  EXPECT_LT(InitBytesRead(kvs) * 4, full_scan_bytes);
+  ExpectMatchesFullScan(kvs);
+}
+
+TEST_F(KeyValueStoreIndexTest, GarbageCollection_InvalidatesCheckpoint) {
+  {
+    auto kvs = CreateKvs(true);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    for (uint32_t i = 0; i < 3; ++i) {
+      PutKeys(kvs, 0, kKeys, i * 100);
+    }
+    ASSERT_EQ(OkStatus(), kvs.CheckpointIndex());
+    ASSERT_EQ(OkStatus(), kvs.PartialMaintenance());
+    ASSERT_GT(kvs.GetStorageStats().sector_erase_count, 0u);
+  }
+
+  auto full_scan = CreateKvs(false);
+  const size_t full_scan_bytes = InitBytesRead(full_scan);
+
+  auto kvs = CreateKvs(true);
+  EXPECT_EQ(InitBytesRead(kvs), full_scan_bytes);
+  ExpectMatchesFullScan(kvs);
+}
+
+TEST_F(KeyValueStoreIndexTest, CorruptCheckpoint_FallsBackToFullScan) {
+  {
+    auto kvs = CreateKvs(true);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    PutKeys(kvs, 0, kKeys);
+    ASSERT_EQ(OkStatus(), kvs.CheckpointIndex());
+  }
+
+  // Erase the empty checkpoint written by the first Init and corrupt a record
+  // in the one written after the puts.
+  ASSERT_EQ(OkStatus(), index_partition_.Erase(0, 1));
+  std::array<std::byte, kSectorSize> slot;
+  ASSERT_EQ(OkStatus(), index_partition_.Read(kSectorSize, slot).status());
+  slot[128] ^= std::byte{0x01};
+  ASSERT_EQ(OkStatus(), index_partition_.Erase(kSectorSize, 1));
+  ASSERT_EQ(OkStatus(), index_partition_.Write(kSectorSize, slot).status());
+
+  auto full_scan = CreateKvs(false);
+  const size_t full_scan_bytes = InitBytesRead(full_scan);
+
+  auto kvs = CreateKvs(true);
+  EXPECT_GE(InitBytesRead(kvs), full_scan_bytes);
+  ExpectMatchesFullScan(kvs);
+}
+
+TEST_F(KeyValueStoreIndexTest, ErasedKvs_CheckpointNotUsed) {
+  {
+    auto kvs = CreateKvs(true);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    PutKeys(kvs, 0, kKeys);
+    ASSERT_EQ(OkStatus(), kvs.CheckpointIndex());
+  }
+
+  ASSERT_EQ(OkStatus(), kvs_partition_.Erase());
+
+  auto kvs = CreateKvs(true);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  EXPECT_EQ(kvs.size(), 0u);
+  EXPECT_EQ(kvs.GetStorageStats().in_use_bytes, 0u);
+}
+
+TEST_F(KeyValueStoreIndexTest, Redundancy_CountsCopiesAfterCheckpoint) {
+  {
+    auto kvs = CreateKvs<2>(true);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    PutKeys(kvs, 0, kKeys / 2);
+    ASSERT_EQ(OkStatus(), kvs.CheckpointIndex());
+    PutKeys(kvs, kKeys / 4, kKeys / 2, 100);
+  }
+
+  auto kvs = CreateKvs<2>(true);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  EXPECT_EQ(kvs.size(), kKeys / 4 * 3);
+  ExpectMatchesFullScan<2>(kvs);
+}
+
+TEST_F(KeyValueStoreIndexTest, CheckpointIndex_NoIndexPartition) {
+  auto kvs = CreateKvs(false);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  EXPECT_EQ(Status::FailedPrecondition(), kvs.CheckpointIndex());
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,118 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures KeyValueStore::Init on KVSs of increasing size, with and without an
+// index checkpoint. Each KVS is filled to 60% of its capacity with 64-byte
+// values for up to 256 keys, so in the larger KVSs stale entries make up most
+// of the data a full scan reads. A checkpoint is written when the KVS is
+// filled, and then a few more entries are written, which Init reads after
+// loading it.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_assert/check.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 4 * 1024;
+constexpr size_t kIndexSectors = 4;
+constexpr size_t kMaxEntries = 256;
+constexpr size_t kMaxSectors = 128;
+constexpr size_t kFillPercentage = 60;
+constexpr size_t kEntriesAfterCheckpoint = 16;
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat = {.magic = 0x2e8c5a93, .checksum = &checksum};
+
+using Kvs = KeyValueStoreBuffer<kMaxEntries, kMaxSectors>;
+
+Options KvsOptions(FlashPartition* index_partition) {
+  Options options;
+  options.index_partition = index_partition;
+  options.index_checkpoint_interval = 0;
+  return options;
+}
+
+void PutEntries(Kvs& kvs, size_t count, uint32_t& next) {
+  std::array<std::byte, 64> value{};
+  for (size_t i = 0; i < count; ++i, ++next) {
+    StringBuffer<16> key;
+    key << "key_" << next % kMaxEntries;
+    value[0] = static_cast<std::byte>(next);
+    value[1] = static_cast<std::byte>(next >> 8);
+    PW_CHECK_OK(kvs.Put(key, value));
+  }
+}
+
+// Holds a KVS partition and an index partition of one flash memory.
+template <size_t kSectors>
+class FilledKvs {
+ public:
+  FilledKvs()
+      : kvs_partition_(&flash_, 0, kSectors),
+        index_partition_(&flash_, kSectors, kIndexSectors) {
+    Kvs kvs(&kvs_partition_, kFormat, KvsOptions(&index_partition_));
+    PW_CHECK_OK(kvs.Init());
+
+    uint32_t next = 0;
+    const size_t fill_bytes = kvs_partition_.size_bytes() * kFillPercentage /
+                              100;
+    while (kvs.GetStorageStats().in_use_bytes +
+               kvs.GetStorageStats().reclaimable_bytes <
+           fill_bytes) {
+      PutEntries(kvs, 1, next);
+    }
+    PW_CHECK_OK(kvs.CheckpointIndex());
+    PutEntries(kvs, kEntriesAfterCheckpoint, next);
+  }
+
+  void Init(perf_test::State& state, bool use_index) {
+    while (state.KeepRunning()) {
+      Kvs kvs(&kvs_partition_,
+              kFormat,
+              KvsOptions(use_index ? &index_partition_ : nullptr));
+      PW_CHECK_OK(kvs.Init());
+    }
+  }
+
+ private:
+  FakeFlashMemoryBuffer<kSectorSize, kSectors + kIndexSectors> flash_;
+  FlashPartition kvs_partition_;
+  FlashPartition index_partition_;
+};
+
+template <size_t kSectors>
+void Init(perf_test::State& state, bool use_index) {
+  static FilledKvs<kSectors> kvs;
+  kvs.Init(state, use_index);
+}
+
+PW_PERF_TEST(Init32KiB, Init<8>, false);
+PW_PERF_TEST(Init32KiBWithIndex, Init<8>, true);
+PW_PERF_TEST(Init128KiB, Init<32>, false);
+PW_PERF_TEST(Init128KiBWithIndex, Init<32>, true);
+PW_PERF_TEST(Init512KiB, Init<128>, false);
+PW_PERF_TEST(Init512KiBWithIndex, Init<128>, true);
+
+}  // namespace
+}  // namespace pw::kvs
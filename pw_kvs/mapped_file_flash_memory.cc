@@ -0,0 +1,234 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_LOG_MODULE_NAME "PW_FLASH"
+#define PW_LOG_LEVEL PW_KVS_LOG_LEVEL
+
+#include "pw_kvs/mapped_file_flash_memory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "pw_bytes/alignment.h"
+#include "pw_kvs_private/config.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+namespace pw::kvs {
+
+Status MappedFileFlashMemory::Open(const char* path) {
+  if (IsEnabled()) {
+    return Status::FailedPrecondition();
+  }
+
+  const int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    PW_LOG_ERROR("Failed to open %s: %s", path, std::strerror(errno));
+    return Status::Unavailable();
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    PW_LOG_ERROR("Failed to stat %s: %s", path, std::strerror(errno));
+    close(fd);
+    return Status::Unavailable();
+  }
+
+  const bool new_file = file_stat.st_size == 0;
+  if (!new_file && static_cast<size_t>(file_stat.st_size) != size_bytes()) {
+    PW_LOG_ERROR("%s is %u B, but the flash memory is %u B",
+                 path,
+                 unsigned(file_stat.st_size),
+                 unsigned(size_bytes()));
+    close(fd);
+    return Status::FailedPrecondition();
+  }
+
+  if (new_file && ftruncate(fd, static_cast<off_t>(size_bytes())) != 0) {
+    PW_LOG_ERROR("Failed to resize %s: %s", path, std::strerror(errno));
+    close(fd);
+    return Status::Unavailable();
+  }
+
+  void* mapping =
+      mmap(nullptr, size_bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    PW_LOG_ERROR("Failed to map %s: %s", path, std::strerror(errno));
+    close(fd);
+    return Status::Unavailable();
+  }
+
+  fd_ = fd;
+  mapping_ = static_cast<std::byte*>(mapping);
+  dirty_begin_ = 0;
+  dirty_end_ = 0;
+  dirty_bytes_ = 0;
+
+  if (new_file) {
+    return Erase(0, sector_count());
+  }
+  return OkStatus();
+}
+
+Status MappedFileFlashMemory::Close() {
+  if (!IsEnabled()) {
+    return OkStatus();
+  }
+
+  const Status status = Sync();
+  munmap(mapping_, size_bytes());
+  close(fd_);
+  mapping_ = nullptr;
+  fd_ = -1;
+  return status;
+}
+
+Status MappedFileFlashMemory::Sync() {
+  if (!IsEnabled()) {
+    return Status::FailedPrecondition();
+  }
+  if (dirty_begin_ == dirty_end_) {
+    return OkStatus();
+  }
+
+  // msync requires a page-aligned address. The mapping itself is page-aligned.
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t begin = AlignDown(dirty_begin_, page_size);
+
+  const int result = msync(mapping_ + begin, dirty_end_ - begin, MS_SYNC);
+  dirty_begin_ = 0;
+  dirty_end_ = 0;
+  dirty_bytes_ = 0;
+
+  if (result != 0) {
+    PW_LOG_ERROR("Failed to sync flash memory: %s", std::strerror(errno));
+    return Status::Internal();
+  }
+  return OkStatus();
+}
+
+Status MappedFileFlashMemory::Erase(Address address, size_t num_sectors) {
+  if (!IsEnabled()) {
+    return Status::FailedPrecondition();
+  }
+
+  if (address % sector_size_bytes() != 0) {
+    PW_LOG_ERROR(
+        "Attempted to erase sector at non-sector aligned boundary; address %x",
+        unsigned(address));
+    return Status::InvalidArgument();
+  }
+
+  const size_t sector_id = address / sector_size_bytes();
+  if (sector_id + num_sectors > sector_count()) {
+    PW_LOG_ERROR(
+        "Tried to erase a sector at an address past flash end; "
+        "address: %x, sector implied: %u",
+        unsigned(address),
+        unsigned(sector_id));
+    return Status::OutOfRange();
+  }
+
+  const size_t size = sector_size_bytes() * num_sectors;
+  std::memset(mapping_ + address, int(kErasedValue), size);
+  return MarkDirty(address, size);
+}
+
+StatusWithSize MappedFileFlashMemory::Read(Address address,
+                                           span<std::byte> output) {
+  if (!IsEnabled()) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  if (address + output.size() > size_bytes()) {
+    PW_LOG_ERROR("Read beyond end of memory; address %x, size %u B",
+                 unsigned(address),
+                 unsigned(output.size()));
+    return StatusWithSize::OutOfRange();
+  }
+
+  std::memcpy(output.data(), mapping_ + address, output.size());
+  return StatusWithSize(output.size());
+}
+
+StatusWithSize MappedFileFlashMemory::Write(Address address,
+                                            span<const std::byte> data) {
+  if (!IsEnabled()) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  if (address % alignment_bytes() != 0 ||
+      data.size() % alignment_bytes() != 0) {
+    PW_LOG_ERROR("Unaligned write; address %x, size %u B, alignment %u",
+                 unsigned(address),
+                 unsigned(data.size()),
+                 unsigned(alignment_bytes()));
+    return StatusWithSize::InvalidArgument();
+  }
+
+  if (address + data.size() > size_bytes()) {
+    PW_LOG_ERROR(
+        "Write beyond end of memory; address %x, size %u B, max address %x",
+        unsigned(address),
+        unsigned(data.size()),
+        unsigned(size_bytes()));
+    return StatusWithSize::OutOfRange();
+  }
+
+  // Check in erased state
+  const std::byte* const begin = mapping_ + address;
+  const std::byte* const end = begin + data.size();
+  if (std::find_if(begin, end, [](std::byte b) { return b != kErasedValue; }) !=
+      end) {
+    PW_LOG_ERROR("Writing to previously written address: %x",
+                 unsigned(address));
+    return StatusWithSize::Unknown();
+  }
+
+  std::memcpy(mapping_ + address, data.data(), data.size());
+  PW_TRY_WITH_SIZE(MarkDirty(address, data.size()));
+  return StatusWithSize(data.size());
+}
+
+std::byte* MappedFileFlashMemory::FlashAddressToMcuAddress(
+    Address address) const {
+  if (!IsEnabled() || address > size_bytes()) {
+    return nullptr;
+  }
+  return mapping_ + address;
+}
+
+Status MappedFileFlashMemory::MarkDirty(Address address, size_t size) {
+  if (dirty_begin_ == dirty_end_) {
+    dirty_begin_ = address;
+    dirty_end_ = address + size;
+  } else {
+    dirty_begin_ = std::min<size_t>(dirty_begin_, address);
+    dirty_end_ = std::max<size_t>(dirty_end_, address + size);
+  }
+  dirty_bytes_ += size;
+
+  if (sync_interval_bytes_ != 0u && dirty_bytes_ >= sync_interval_bytes_) {
+    return Sync();
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::kvs
@@ -0,0 +1,150 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares KeyValueStore Put and Get on a MappedFileFlashMemory with the same
+// operations on a FakeFlashMemoryBuffer. Each Put writes a 64-byte value for
+// one of 64 keys, so the KVS regularly garbage collects.
+
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+#include "pw_assert/check.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_kvs/mapped_file_flash_memory.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 4 * 1024;
+constexpr size_t kSectors = 8;
+constexpr size_t kAlignment = 16;
+constexpr size_t kKeys = 64;
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat = {.magic = 0x51c93e07, .checksum = &checksum};
+
+using Kvs = KeyValueStoreBuffer<kKeys, kSectors>;
+
+// A MappedFileFlashMemory backed by a temporary file.
+class TempFileFlash {
+ public:
+  explicit TempFileFlash(size_t sync_interval_bytes)
+      : flash_(kSectorSize, kSectors, kAlignment, sync_interval_bytes),
+        path_((std::filesystem::temp_directory_path() /
+               "pw_kvs_mapped_file_perf_XXXXXX")
+                  .string()) {
+    const int fd = mkstemp(path_.data());
+    PW_CHECK_INT_GE(fd, 0);
+    close(fd);
+    PW_CHECK_OK(flash_.Open(path_.c_str()));
+  }
+
+  ~TempFileFlash() {
+    flash_.Close().IgnoreError();
+    std::filesystem::remove(path_);
+  }
+
+  FlashMemory& flash() { return flash_; }
+
+ private:
+  MappedFileFlashMemory flash_;
+  std::string path_;
+};
+
+// Holds a KVS on a flash memory, with every key written once.
+class FilledKvs {
+ public:
+  explicit FilledKvs(FlashMemory& flash)
+      : partition_(&flash), kvs_(&partition_, kFormat) {
+    PW_CHECK_OK(kvs_.Init());
+    for (size_t i = 0; i < kKeys; ++i) {
+      Put();
+    }
+  }
+
+  void Put() {
+    StringBuffer<16> key;
+    key << "key_" << next_ % kKeys;
+    value_[0] = static_cast<std::byte>(next_);
+    PW_CHECK_OK(kvs_.Put(key, value_));
+    next_ += 1;
+  }
+
+  void Get() {
+    StringBuffer<16> key;
+    key << "key_" << next_ % kKeys;
+    PW_CHECK_OK(kvs_.Get(key, value_).status());
+    next_ += 1;
+  }
+
+ private:
+  FlashPartition partition_;
+  Kvs kvs_;
+  std::array<std::byte, 64> value_{};
+  uint32_t next_ = 0;
+};
+
+void Put(perf_test::State& state, FlashMemory& flash) {
+  FilledKvs kvs(flash);
+  while (state.KeepRunning()) {
+    kvs.Put();
+  }
+}
+
+void Get(perf_test::State& state, FlashMemory& flash) {
+  FilledKvs kvs(flash);
+  while (state.KeepRunning()) {
+    kvs.Get();
+  }
+}
+
+void PutFake(perf_test::State& state) {
+  FakeFlashMemoryBuffer<kSectorSize, kSectors> flash(kAlignment);
+  Put(state, flash);
+}
+
+void PutMapped(perf_test::State& state, size_t sync_interval_bytes) {
+  TempFileFlash flash(sync_interval_bytes);
+  Put(state, flash.flash());
+}
+
+void GetFake(perf_test::State& state) {
+  FakeFlashMemoryBuffer<kSectorSize, kSectors> flash(kAlignment);
+  Get(state, flash);
+}
+
+void GetMapped(perf_test::State& state) {
+  TempFileFlash flash(0);
+  Get(state, flash.flash());
+}
+
+PW_PERF_TEST(PutFakeFlash, PutFake);
+PW_PERF_TEST(PutMappedFile, PutMapped, 0);
+PW_PERF_TEST(PutMappedFileSyncEvery16KiB, PutMapped, 16 * 1024);
+PW_PERF_TEST(GetFakeFlash, GetFake);
+PW_PERF_TEST(GetMappedFile, GetMapped);
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,173 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/mapped_file_flash_memory.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat = {.magic = 0x3a6f91c2, .checksum = &checksum};
+
+class MappedFileFlashMemoryTest : public ::testing::Test {
+ protected:
+  MappedFileFlashMemoryTest()
+      : flash_(kSectorSize, kSectorCount, kAlignment),
+        path_((std::filesystem::temp_directory_path() /
+               "pw_kvs_mapped_file_XXXXXX")
+                  .string()) {
+    // Create an empty file with a unique name, which Open erases.
+    const int fd = mkstemp(path_.data());
+    EXPECT_GE(fd, 0);
+    close(fd);
+  }
+
+  ~MappedFileFlashMemoryTest() override {
+    EXPECT_EQ(OkStatus(), flash_.Close());
+    std::filesystem::remove(path_);
+  }
+
+  MappedFileFlashMemory flash_;
+  std::string path_;
+};
+
+TEST_F(MappedFileFlashMemoryTest, Open_NewFileIsErased) {
+  ASSERT_EQ(OkStatus(), flash_.Open(path_.c_str()));
+  EXPECT_TRUE(flash_.IsEnabled());
+  EXPECT_EQ(std::filesystem::file_size(path_), kSectorSize * kSectorCount);
+
+  std::array<std::byte, kSectorSize> buffer;
+  for (size_t i = 0; i < kSectorCount; ++i) {
+    ASSERT_EQ(OkStatus(), flash_.Read(i * kSectorSize, buffer).status());
+    for (std::byte b : buffer) {
+      ASSERT_EQ(b, MappedFileFlashMemory::kErasedValue);
+    }
+  }
+}
+
+TEST_F(MappedFileFlashMemoryTest, Write_OnlyToErasedAlignedMemory) {
+  ASSERT_EQ(OkStatus(), flash_.Open(path_.c_str()));
+
+  std::array<std::byte, kAlignment> data;
+  data.fill(std::byte{0x5a});
+  EXPECT_EQ(Status::InvalidArgument(), flash_.Write(8, data).status());
+  EXPECT_EQ(Status::InvalidArgument(),
+            flash_.Write(0, span(data).first(8)).status());
+  EXPECT_EQ(Status::OutOfRange(),
+            flash_.Write(kSectorSize * kSectorCount, data).status());
+
+  ASSERT_EQ(OkStatus(), flash_.Write(kSectorSize, data).status());
+  EXPECT_EQ(Status::Unknown(), flash_.Write(kSectorSize, data).status());
+
+  ASSERT_EQ(OkStatus(), flash_.Erase(kSectorSize, 1));
+  EXPECT_EQ(OkStatus(), flash_.Write(kSectorSize, data).status());
+  EXPECT_EQ(Status::InvalidArgument(), flash_.Erase(kSectorSize + 1, 1));
+  EXPECT_EQ(Status::OutOfRange(), flash_.Erase(kSectorSize, kSectorCount));
+}
+
+TEST_F(MappedFileFlashMemoryTest, Reopen_KeepsData) {
+  std::array<std::byte, 2 * kAlignment> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::byte>(i);
+  }
+
+  ASSERT_EQ(OkStatus(), flash_.Open(path_.c_str()));
+  ASSERT_EQ(OkStatus(), flash_.Write(kSectorSize + kAlignment, data).status());
+  ASSERT_EQ(OkStatus(), flash_.Close());
+  EXPECT_FALSE(flash_.IsEnabled());
+  EXPECT_EQ(flash_.FlashAddressToMcuAddress(0), nullptr);
+
+  ASSERT_EQ(OkStatus(), flash_.Open(path_.c_str()));
+  std::array<std::byte, 2 * kAlignment> read;
+  ASSERT_EQ(OkStatus(), flash_.Read(kSectorSize + kAlignment, read).status());
+  EXPECT_EQ(read, data);
+
+  const std::byte* mapped =
+      flash_.FlashAddressToMcuAddress(kSectorSize + kAlignment);
+  ASSERT_NE(mapped, nullptr);
+  EXPECT_EQ(std::memcmp(mapped, data.data(), data.size()), 0);
+}
+
+TEST_F(MappedFileFlashMemoryTest, Open_SizeMismatch) {
+  ASSERT_EQ(OkStatus(), flash_.Open(path_.c_str()));
+  EXPECT_EQ(Status::FailedPrecondition(), flash_.Open(path_.c_str()));
+  ASSERT_EQ(OkStatus(), flash_.Close());
+
+  MappedFileFlashMemory larger(kSectorSize, kSectorCount + 1, kAlignment);
+  EXPECT_EQ(Status::FailedPrecondition(), larger.Open(path_.c_str()));
+}
+
+TEST_F(MappedFileFlashMemoryTest, SyncInterval_SyncsChanges) {
+  MappedFileFlashMemory flash(kSectorSize, kSectorCount, kAlignment, 64);
+  ASSERT_EQ(OkStatus(), flash.Open(path_.c_str()));
+
+  std::array<std::byte, kAlignment> data{};
+  for (size_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(OkStatus(), flash.Write(i * kAlignment, data).status());
+  }
+  EXPECT_EQ(OkStatus(), flash.Sync());
+}
+
+TEST_F(MappedFileFlashMemoryTest, Closed_FailedPrecondition) {
+  std::array<std::byte, kAlignment> data{};
+  EXPECT_FALSE(flash_.IsEnabled());
+  EXPECT_EQ(Status::FailedPrecondition(), flash_.Enable());
+  EXPECT_EQ(Status::FailedPrecondition(), flash_.Read(0, data).status());
+  EXPECT_EQ(Status::FailedPrecondition(), flash_.Write(0, data).status());
+  EXPECT_EQ(Status::FailedPrecondition(), flash_.Erase(0, 1));
+  EXPECT_EQ(Status::FailedPrecondition(), flash_.Sync());
+}
+
+TEST_F(MappedFileFlashMemoryTest, KeyValueStore_PersistsAcrossOpen) {
+  ASSERT_EQ(OkStatus(), flash_.Open(path_.c_str()));
+  {
+    FlashPartition partition(&flash_);
+    KeyValueStoreBuffer<8, kSectorCount> kvs(&partition, kFormat);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    ASSERT_EQ(OkStatus(), kvs.Put("key", uint32_t{0x1234}));
+  }
+  ASSERT_EQ(OkStatus(), flash_.Close());
+
+  MappedFileFlashMemory reopened(kSectorSize, kSectorCount, kAlignment);
+  ASSERT_EQ(OkStatus(), reopened.Open(path_.c_str()));
+  FlashPartition partition(&reopened);
+  KeyValueStoreBuffer<8, kSectorCount> kvs(&partition, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs.Get("key", &value));
+  EXPECT_EQ(value, 0x1234u);
+}
+
+}  // namespace
+}  // namespace pw::kvs
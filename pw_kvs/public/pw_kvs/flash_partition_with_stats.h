@@ -35,9 +35,12 @@ class FlashPartitionWithStats : public FlashPartition {
   Status SaveStorageStats(const KeyValueStore& kvs, const char* label);
 
   using FlashPartition::Erase;
+  using FlashPartition::Write;
 
   Status Erase(Address address, size_t num_sectors) override;
 
+  StatusWithSize Write(Address address, span<const std::byte> data) override;
+
   span<size_t> sector_erase_counters() {
     return span(sector_counters_.data(), sector_counters_.size());
   }
@@ -67,7 +70,16 @@ class FlashPartitionWithStats : public FlashPartition {
         sector_counters_.begin(), sector_counters_.end(), 0ul);
   }
 
-  void ResetCounters() { sector_counters_.assign(sector_count(), 0); }
+  // Number of Write calls and bytes written. Unlike the erase counters, these
+  // are always recorded.
+  size_t total_write_count() const { return write_count_; }
+  size_t total_bytes_written() const { return bytes_written_; }
+
+  void ResetCounters() {
+    sector_counters_.assign(sector_count(), 0);
+    write_count_ = 0;
+    bytes_written_ = 0;
+  }
 
  protected:
   FlashPartitionWithStats(
@@ -88,6 +100,8 @@ class FlashPartitionWithStats : public FlashPartition {
 
  private:
   Vector<size_t>& sector_counters_;
+  size_t write_count_ = 0;
+  size_t bytes_written_ = 0;
 };
 
 template <size_t kMaxSectors>
@@ -81,6 +81,15 @@ struct EntryHeader {
 
 static_assert(sizeof(EntryHeader) == 16, "EntryHeader must not have padding");
 
+// Entries written by KeyValueStore::PutBatch() use a magic derived from their
+// format's magic. KVS versions without batches don't know this magic and treat
+// the entries as corrupt, so they load none of a batch rather than part of it.
+inline constexpr uint32_t kBatchMagicMask = 0x3b9f04d6;
+
+constexpr uint32_t BatchMagic(uint32_t magic) {
+  return magic ^ kBatchMagicMask;
+}
+
 // This class wraps EntryFormat instances to support having multiple
 // simultaneously supported formats.
 class EntryFormats {
@@ -93,10 +102,15 @@ class EntryFormats {
 
   const EntryFormat& primary() const { return formats_.front(); }
 
-  bool KnownMagic(uint32_t magic) const { return Find(magic) != nullptr; }
+  bool KnownMagic(uint32_t magic) const {
+    return Find(magic) != nullptr || FindForBatch(magic) != nullptr;
+  }
 
   const EntryFormat* Find(uint32_t magic) const;
 
+  // Finds the format of batch entries with the given magic.
+  const EntryFormat* FindForBatch(uint32_t magic) const;
+
  private:
   const span<const EntryFormat> formats_;
 };
@@ -87,6 +87,41 @@ class Entry {
                  transaction_id);
   }
 
+  // Creates the marker which precedes the entries of a batch. The entries have
+  // the marker's transaction ID. The marker has no key, and its value is the
+  // number of entries.
+  static Entry BatchMarker(FlashPartition& partition,
+                           Address address,
+                           const EntryFormat& format,
+                           const uint32_t& entry_count,
+                           uint32_t transaction_id) {
+    return Entry(partition,
+                 address,
+                 format,
+                 {},
+                 as_bytes(span(&entry_count, 1)),
+                 sizeof(entry_count),
+                 transaction_id,
+                 /*batch=*/true);
+  }
+
+  // Creates a new Entry for a valid entry in a batch.
+  static Entry BatchValid(FlashPartition& partition,
+                          Address address,
+                          const EntryFormat& format,
+                          Key key,
+                          span<const std::byte> value,
+                          uint32_t transaction_id) {
+    return Entry(partition,
+                 address,
+                 format,
+                 key,
+                 value,
+                 value.size(),
+                 transaction_id,
+                 /*batch=*/true);
+  }
+
   Entry() = default;
 
   KeyDescriptor descriptor(Key key) const { return descriptor(Hash(key)); }
@@ -99,6 +134,12 @@ class Entry {
 
   StatusWithSize Write(Key key, span<const std::byte> value) const;
 
+  // Writes this entry, including padding, to a writer positioned at the
+  // entry's address. Used to write several consecutive entries in one pass.
+  Status Write(AlignedWriter& writer,
+               Key key,
+               span<const std::byte> value) const;
+
   // Changes the format and transcation ID for this entry. In order to calculate
   // the new checksum, the entire entry is read into a small stack-allocated
   // buffer. The updated entry may be written to flash using the Copy function.
@@ -168,6 +209,13 @@ class Entry {
     return header_.value_size_bytes == kDeletedValueLength;
   }
 
+  // True if this entry was written by a batch, and so has its format's batch
+  // magic.
+  bool batch() const { return batch_; }
+
+  // True if this is the marker preceding the entries of a batch.
+  bool batch_marker() const { return batch_ && key_length() == 0u; }
+
   void DebugLog() const;
 
  private:
@@ -179,16 +227,19 @@ class Entry {
         Key key,
         span<const std::byte> value,
         uint16_t value_size_bytes,
-        uint32_t transaction_id);
+        uint32_t transaction_id,
+        bool batch = false);
 
   constexpr Entry(FlashPartition* partition,
                   Address address,
                   const EntryFormat& format,
-                  EntryHeader header)
+                  EntryHeader header,
+                  bool batch)
       : partition_(partition),
         address_(address),
         checksum_algo_(format.checksum),
-        header_(header) {}
+        header_(header),
+        batch_(batch) {}
 
   FlashPartition& partition() const { return *partition_; }
 
@@ -219,6 +270,7 @@ class Entry {
   Address address_;
   ChecksumAlgorithm* checksum_algo_;
   EntryHeader header_;
+  bool batch_ = false;
 };
 
 }  // namespace internal
@@ -0,0 +1,164 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file defines the in-flash format for checkpoints of a KVS's index.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/internal/entry_cache.h"
+#include "pw_kvs/internal/sectors.h"
+#include "pw_status/status.h"
+
+namespace pw {
+namespace kvs {
+namespace internal {
+
+// Stores checkpoints of a KVS's index in a dedicated flash partition. A
+// checkpoint holds the key descriptors and addresses of every entry, and the
+// writable and valid bytes of every sector. Loading one lets Init skip reading
+// the entries it describes; only entries appended to sectors afterwards need to
+// be read.
+//
+// The partition is split into two slots, which are written alternately, so an
+// interrupted write leaves the previous checkpoint intact. Each slot holds:
+//
+//   header | invalidation marker | sector records | entry records
+//
+// The header is written last, so a checkpoint is only found once it is
+// complete. It includes a CRC32 of the header and the records. The marker is
+// programmed before the KVS erases a sector, since the checkpoint may then
+// refer to entries that no longer exist.
+class IndexCheckpoint {
+ public:
+  using Address = FlashPartition::Address;
+
+  explicit constexpr IndexCheckpoint(FlashPartition* partition)
+      : partition_(partition),
+        sequence_(0),
+        transaction_id_(0),
+        newest_slot_(kSlots - 1),
+        current_(false),
+        may_be_valid_(false) {}
+
+  bool enabled() const { return partition_ != nullptr; }
+
+  // True if the newest checkpoint matches the KVS's index as of
+  // transaction_id(); that is, it was loaded by Init or written since.
+  bool current() const { return current_; }
+
+  // Indicates that the KVS's index was not loaded from the newest checkpoint.
+  // The checkpoint stays valid in flash.
+  void set_outdated() { current_ = false; }
+
+  // The KVS's last transaction ID when the newest checkpoint was written.
+  uint32_t transaction_id() const { return transaction_id_; }
+
+  // Resets the entry cache and sectors and loads the newest valid checkpoint
+  // into them. Returns flash partition Read errors or one of the following:
+  //
+  //                    OK: the checkpoint was loaded
+  //             NOT_FOUND: there is no valid checkpoint
+  //   FAILED_PRECONDITION: the checkpoint is for a KVS with different sectors
+  //                        or redundancy, or the partition is unusable
+  //    RESOURCE_EXHAUSTED: the checkpoint has more entries than the cache
+  //             DATA_LOSS: the checkpoint is corrupt
+  //
+  // The entry cache and sectors must be reset again if loading fails.
+  Status Load(EntryCache& entry_cache,
+              Sectors& sectors,
+              size_t sector_size_bytes);
+
+  // Writes a checkpoint of the entry cache and sectors to the older slot.
+  // Returns flash partition Erase and Write errors or one of the following:
+  //
+  //                    OK: the checkpoint was written
+  //   FAILED_PRECONDITION: a sector is corrupt, or the partition is unusable
+  //    RESOURCE_EXHAUSTED: the checkpoint does not fit in a slot
+  //
+  Status Write(const EntryCache& entry_cache,
+               const Sectors& sectors,
+               size_t sector_size_bytes,
+               uint32_t transaction_id);
+
+  // Marks all valid checkpoints so they are no longer loaded. Must be called
+  // before any sector of the KVS is erased.
+  Status Invalidate();
+
+ private:
+  static constexpr size_t kSlots = 2;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t checksum;  // CRC32 of the rest of the header and the records.
+    uint32_t sequence;  // Incremented for each checkpoint written.
+    uint32_t transaction_id;
+    uint32_t entry_count;
+    uint32_t sector_count;
+    uint32_t sector_size_bytes;
+    uint32_t redundancy;
+  };
+
+  struct SectorRecord {
+    uint16_t writable_bytes;
+    uint16_t valid_bytes;
+  };
+
+  // Followed by address_count addresses.
+  struct EntryRecord {
+    uint32_t key_hash;
+    uint32_t transaction_id;
+    uint8_t state;
+    uint8_t address_count;
+    uint16_t reserved;
+  };
+
+  Status CheckPartition() const;
+
+  // Reads a slot's header. Returns NOT_FOUND if it holds no checkpoint.
+  Status ReadHeader(size_t slot, Header& header) const;
+
+  Status IsInvalidated(size_t slot, bool& invalidated) const;
+
+  Status LoadSlot(size_t slot,
+                  const Header& header,
+                  EntryCache& entry_cache,
+                  Sectors& sectors,
+                  size_t sector_size_bytes) const;
+
+  size_t slot_size_bytes() const {
+    return partition_->sector_count() / kSlots *
+           partition_->sector_size_bytes();
+  }
+
+  Address SlotAddress(size_t slot) const { return slot * slot_size_bytes(); }
+
+  Address MarkerAddress(size_t slot) const;
+  Address RecordsAddress(size_t slot) const;
+
+  FlashPartition* const partition_;
+
+  uint32_t sequence_;  // Highest sequence number in either slot.
+  uint32_t transaction_id_;
+  size_t newest_slot_;
+
+  bool current_;
+  bool may_be_valid_;  // Either slot may hold a valid checkpoint.
+};
+
+}  // namespace internal
+}  // namespace kvs
+}  // namespace pw
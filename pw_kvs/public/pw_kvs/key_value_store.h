@@ -24,6 +24,7 @@
 #include "pw_kvs/format.h"
 #include "pw_kvs/internal/entry.h"
 #include "pw_kvs/internal/entry_cache.h"
+#include "pw_kvs/internal/index_checkpoint.h"
 #include "pw_kvs/internal/key_descriptor.h"
 #include "pw_kvs/internal/sectors.h"
 #include "pw_kvs/internal/span_traits.h"
@@ -78,6 +79,18 @@ struct Options {
 
   // Verify an in-flash entry's checksum after writing it.
   bool verify_on_write = true;
+
+  // Partition in which to store checkpoints of the KVS's index, or nullptr to
+  // disable them. With a checkpoint, Init only reads entries written after it
+  // rather than every entry in the KVS. The partition must not overlap the
+  // KVS's partition and must have at least two sectors. Half of it must fit the
+  // sector table and every entry's key descriptor and addresses.
+  FlashPartition* index_partition = nullptr;
+
+  // Number of transactions after which a write also writes a new checkpoint of
+  // the index. Checkpoints are also written by Init, if it could not use one,
+  // and by full maintenance. If 0, checkpoints are not written after writes.
+  uint32_t index_checkpoint_interval = 64;
 };
 
 /// Flash-backed persistent key-value store (KVS) with integrated
@@ -219,6 +232,45 @@ class KeyValueStore {
     return PutBytes(key, as_bytes(span<const T>(&value, 1)));
   }
 
+  /// A key and value to add or update with `PutBatch()`.
+  struct KeyValue {
+    Key key;
+    span<const std::byte> value;
+  };
+
+  /// Adds or updates several key-value entries atomically: if the write is
+  /// interrupted, the next `Init()` finds either all or none of them.
+  ///
+  /// The entries share one transaction ID and are written in one pass, after
+  /// a marker that records how many there are, to a single sector for each
+  /// redundant copy. Unlike `Put()`, entries are written even if their values
+  /// are unchanged.
+  ///
+  /// @param[in] batch The keys and values to store. Each key may only appear
+  /// once.
+  ///
+  /// @returns @rst
+  ///
+  /// .. pw-status-codes::
+  ///
+  ///    OK: The entries were successfully added or updated.
+  ///
+  ///    DATA_LOSS: Checksum validation failed after writing data.
+  ///
+  ///    RESOURCE_EXHAUSTED: Not enough space to add the entries.
+  ///
+  ///    ALREADY_EXISTS: The entries could not be added because a different
+  ///    key with the same hash as one of them is already in the KVS.
+  ///
+  ///    FAILED_PRECONDITION: The KVS is not initialized. Call ``Init()``
+  ///    before calling this method.
+  ///
+  ///    INVALID_ARGUMENT: A key is empty, too long, or appears more than
+  ///    once, or the entries do not fit in one sector together.
+  ///
+  /// @endrst
+  Status PutBatch(span<const KeyValue> batch);
+
   /// Removes a key-value entry from the KVS.
   ///
   /// @param[in] key - The name of the key-value entry to delete.
@@ -289,6 +341,25 @@ class KeyValueStore {
     return FullMaintenanceHelper(MaintenanceType::kRegular);
   }
 
+  /// Writes a checkpoint of the KVS's index to `Options::index_partition`, so
+  /// the next `Init()` only reads entries written after it. Checkpoints are
+  /// also written automatically, as configured in `Options`.
+  ///
+  /// @returns @rst
+  ///
+  /// .. pw-status-codes::
+  ///
+  ///    OK: The checkpoint was written.
+  ///
+  ///    FAILED_PRECONDITION: The KVS has no index partition, is not
+  ///    initialized, or has unrepaired errors.
+  ///
+  ///    RESOURCE_EXHAUSTED: The index does not fit in half of the index
+  ///    partition.
+  ///
+  /// @endrst
+  Status CheckpointIndex();
+
   /// Performs a portion of KVS maintenance. If configured for at least lazy
   /// recovery, will do any needed repairing of corruption. Does garbage
   /// collection of part of the KVS, typically a single sector or similar unit
@@ -491,8 +562,43 @@ class KeyValueStore {
         "as_writable_bytes(span(&value, 1)).");
   }
 
-  Status InitializeMetadata();
-  Status LoadEntry(Address entry_address, Address* next_entry_address);
+  Status InitializeMetadata(bool use_index_checkpoint);
+
+  // Loads the entry cache and sectors from the newest index checkpoint, and
+  // checks that the newest entry it refers to is in flash. Returns false if no
+  // checkpoint could be loaded.
+  bool LoadIndexCheckpoint();
+
+  // Loads the entries in every sector. If after_checkpoint is set, only the
+  // entries appended to sectors since the loaded index checkpoint are loaded,
+  // and the first error is returned instead of being recovered from.
+  Status LoadSectors(bool after_checkpoint,
+                     size_t& total_corrupt_bytes,
+                     size_t& corrupt_entries);
+  Status LoadEntry(Address entry_address,
+                   Address* next_entry_address,
+                   bool after_checkpoint);
+
+  // Adds an entry appended after the index checkpoint to the entry cache.
+  // Unlike a full scan, the valid bytes in each sector are already known, so
+  // they are updated for the entry and any older version of it.
+  Status AddEntryAfterCheckpoint(const Entry& entry, Key key);
+
+  // Loads the entries of a batch following its marker if all of them were
+  // written. Otherwise, sets next_entry_address to the first missing entry.
+  Status LoadBatch(const Entry& marker,
+                   Address* next_entry_address,
+                   bool after_checkpoint);
+
+  // Adds an entry read from flash to the entry cache.
+  Status AddLoadedEntry(const Entry& entry, Key key, bool after_checkpoint);
+
+  // Writes an index checkpoint if one is due after
+  // Options::index_checkpoint_interval transactions or, if replace_outdated is
+  // set, if the index was not loaded from or written to the newest checkpoint.
+  // Failures are logged, since the KVS remains usable without a checkpoint.
+  void CheckpointIndexIfNeeded(bool replace_outdated);
+
   Status ScanForEntry(const SectorDescriptor& sector,
                       Address start_address,
                       Address* next_entry_address);
@@ -581,6 +687,12 @@ class KeyValueStore {
 
   Status AppendEntry(const Entry& entry, Key key, span<const std::byte> value);
 
+  // Writes a batch's marker followed by its entries, which take batch_size
+  // bytes, at address with the last transaction ID.
+  Status AppendBatch(span<const KeyValue> batch,
+                     Address address,
+                     size_t batch_size);
+
   StatusWithSize CopyEntryToSector(Entry& entry,
                                    SectorDescriptor* new_sector,
                                    Address new_address);
@@ -653,6 +765,8 @@ class KeyValueStore {
 
   Options options_;
 
+  internal::IndexCheckpoint index_;
+
   // Threshold value for when to garbage collect all stale data. Above the
   // threshold, GC all reclaimable bytes regardless of if valid data is in
   // sector. Below the threshold, only GC sectors with reclaimable bytes and no
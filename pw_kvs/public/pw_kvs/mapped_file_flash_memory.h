@@ -0,0 +1,110 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+
+namespace pw::kvs {
+
+// A FlashMemory backed by a memory-mapped file, so that host-side users of a
+// KeyValueStore or BlobStore keep their data between runs. Requires POSIX.
+//
+// Like FakeFlashMemory, it mimics the behavior of flash: writes must be aligned
+// and may only write to erased bytes, and memory is erased in sectors. Reads
+// are copied directly from the mapping, which FlashAddressToMcuAddress exposes
+// for memory-mapped reads.
+//
+// Writes and erases only change the mapping. They are synced to the file
+// together, by Sync(), by Close(), or once sync_interval_bytes have been
+// changed since the last sync.
+class MappedFileFlashMemory : public FlashMemory {
+ public:
+  static constexpr size_t kDefaultAlignmentBytes = 1;
+
+  static constexpr std::byte kErasedValue = std::byte{0xff};
+
+  // Creates an unopened flash memory. With a sync_interval_bytes of 0, changes
+  // are only synced by Sync() and Close().
+  MappedFileFlashMemory(size_t sector_size,
+                        size_t sector_count,
+                        size_t alignment_bytes = kDefaultAlignmentBytes,
+                        size_t sync_interval_bytes = 0)
+      : FlashMemory(sector_size, sector_count, alignment_bytes),
+        sync_interval_bytes_(sync_interval_bytes) {}
+
+  MappedFileFlashMemory(const MappedFileFlashMemory&) = delete;
+  MappedFileFlashMemory& operator=(const MappedFileFlashMemory&) = delete;
+
+  ~MappedFileFlashMemory() override { Close().IgnoreError(); }
+
+  // Opens and maps the file at path, creating it if needed. An empty or new
+  // file is sized to the memory and erased. Returns:
+  //
+  // OK - the file was opened
+  // FAILED_PRECONDITION - the memory is already open, or the file's size does
+  //     not match the memory's
+  // UNAVAILABLE - the file could not be opened or mapped
+  Status Open(const char* path);
+
+  // Syncs and unmaps the file. Returns OK if the memory is not open.
+  Status Close();
+
+  // Writes all changes to the file. Returns:
+  //
+  // OK - success, or no changes to write
+  // FAILED_PRECONDITION - the memory is not open
+  // INTERNAL - the sync failed
+  Status Sync();
+
+  // The memory is enabled while it is open.
+  Status Enable() override {
+    return IsEnabled() ? OkStatus() : Status::FailedPrecondition();
+  }
+
+  Status Disable() override { return OkStatus(); }
+
+  bool IsEnabled() const override { return mapping_ != nullptr; }
+
+  // Erase num_sectors starting at a given address.
+  Status Erase(Address address, size_t num_sectors) override;
+
+  // Reads bytes from flash into buffer.
+  StatusWithSize Read(Address address, span<std::byte> output) override;
+
+  // Writes bytes to flash.
+  StatusWithSize Write(Address address, span<const std::byte> data) override;
+
+  std::byte* FlashAddressToMcuAddress(Address address) const override;
+
+ private:
+  size_t size_bytes() const { return sector_size_bytes() * sector_count(); }
+
+  // Records a change to the mapping, which is synced later.
+  Status MarkDirty(Address address, size_t size);
+
+  const size_t sync_interval_bytes_;
+
+  int fd_ = -1;
+  std::byte* mapping_ = nullptr;
+
+  // The range of the mapping changed since the last sync.
+  size_t dirty_begin_ = 0;
+  size_t dirty_end_ = 0;
+  size_t dirty_bytes_ = 0;
+};
+
+}  // namespace pw::kvs
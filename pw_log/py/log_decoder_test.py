@@ -23,6 +23,7 @@ from unittest import TestCase, main
 from pw_log.log_decoder import (
     Log,
     LogStreamDecoder,
+    decompress_log_entries,
     log_decoded_log,
     pw_status_code_to_name,
     timestamp_parser_ns_since_boot,
@@ -865,5 +866,130 @@ class TestLogStreamDecoderLogDropDetectionFunctionality(
         )
 
 
+class TestDecompressLogEntries(TestLogStreamDecoderBase):
+    """Tests expanding compressed log entries."""
+
+    def test_uncompressed_entries_unchanged(self):
+        log_entries = log_pb2.LogEntries(
+            first_entry_sequence_id=3,
+            entries=[_create_random_log_entry() for _ in range(3)],
+        )
+        self.assertIs(decompress_log_entries(log_entries), log_entries)
+
+    def test_expands_compressed_entries(self):
+        entries = [
+            log_pb2.LogEntry(
+                message=b'Temperature: 20',
+                line_level=Log.pack_line_level(12, logging.INFO),
+                timestamp=1000,
+                module=b'SNS',
+                file=b'sensors.cc',
+                thread=b'sensors',
+            ),
+            log_pb2.LogEntry(
+                message=b'Temperature: 21',
+                line_level=Log.pack_line_level(12, logging.INFO),
+                timestamp=1500,
+                module=b'SNS',
+                file=b'sensors.cc',
+                thread=b'sensors',
+            ),
+            log_pb2.LogEntry(
+                message=b'Humidity: 40%',
+                line_level=Log.pack_line_level(30, logging.WARNING),
+                timestamp=1200,
+                thread=b'sensors',
+            ),
+            log_pb2.LogEntry(message=b'oops', dropped=2),
+            log_pb2.LogEntry(
+                message=b'Temperature: 19',
+                line_level=Log.pack_line_level(12, logging.INFO),
+                timestamp=1600,
+                module=b'SNS',
+                file=b'sensors.cc',
+                thread=b'main',
+            ),
+        ]
+        compressed = log_pb2.LogEntries(
+            first_entry_sequence_id=5,
+            compressed_entries=[
+                log_pb2.CompressedLogEntry(
+                    entry=entries[0].SerializeToString()
+                ),
+                log_pb2.CompressedLogEntry(
+                    reference=1,
+                    shared_prefix=14,
+                    message=b'1',
+                    timestamp_delta=1500,
+                    thread=b'sensors',
+                ),
+                log_pb2.CompressedLogEntry(
+                    message=b'Humidity: 40%',
+                    line_level=Log.pack_line_level(30, logging.WARNING),
+                    timestamp_delta=-300,
+                ),
+                log_pb2.CompressedLogEntry(
+                    message=b'oops', dropped=2, thread=b''
+                ),
+                log_pb2.CompressedLogEntry(
+                    reference=2,
+                    shared_prefix=13,
+                    message=b'19',
+                    timestamp_delta=400,
+                    thread=b'main',
+                ),
+            ],
+        )
+
+        self.assertEqual(
+            decompress_log_entries(compressed),
+            log_pb2.LogEntries(first_entry_sequence_id=5, entries=entries),
+        )
+
+    def test_decoder_expands_compressed_entries(self):
+        entry = log_pb2.LogEntry(
+            message=b'Hello',
+            line_level=Log.pack_line_level(123, logging.INFO),
+            file=b'my/path/file.cc',
+        )
+        self.decoder.parse_log_entries_proto(
+            log_pb2.LogEntries(
+                compressed_entries=[
+                    log_pb2.CompressedLogEntry(
+                        entry=entry.SerializeToString()
+                    ),
+                    log_pb2.CompressedLogEntry(
+                        reference=1, shared_prefix=5, timestamp_delta=0
+                    ),
+                ]
+            )
+        )
+        expected_log = self.decoder.parse_log_entry_proto(entry)
+        self.assertEqual(self.captured_logs, [expected_log, expected_log])
+
+    def test_invalid_reference(self):
+        with self.assertRaises(ValueError):
+            decompress_log_entries(
+                log_pb2.LogEntries(
+                    compressed_entries=[
+                        log_pb2.CompressedLogEntry(reference=1),
+                    ]
+                )
+            )
+
+    def test_shared_bytes_longer_than_message(self):
+        with self.assertRaises(ValueError):
+            decompress_log_entries(
+                log_pb2.LogEntries(
+                    compressed_entries=[
+                        log_pb2.CompressedLogEntry(message=b'abc'),
+                        log_pb2.CompressedLogEntry(
+                            reference=1, shared_prefix=2, shared_suffix=2
+                        ),
+                    ]
+                )
+            )
+
+
 if __name__ == '__main__':
     main()
@@ -233,6 +233,84 @@ def timestamp_parser_ns_since_boot(timestamp: int) -> str:
     return str(datetime.timedelta(seconds=timestamp / 1e9))[:-3]
 
 
+def _wrap_int64(value: int) -> int:
+    return (value + 2**63) % 2**64 - 2**63
+
+
+def decompress_log_entries(
+    log_entries_proto: log_pb2.LogEntries,
+) -> log_pb2.LogEntries:
+    """Expands the compressed_entries in a LogEntries message.
+
+    See CompressedLogEntry in pw_log/log.proto.
+
+    Args:
+        log_entries_proto: A LogEntries message proto.
+    Returns:
+        The LogEntries message with compressed entries expanded into entries.
+        Messages without compressed entries are returned as is.
+    Raises:
+        ValueError: A compressed entry refers to data that doesn't exist.
+    """
+    if not log_entries_proto.compressed_entries:
+        return log_entries_proto
+
+    result = log_pb2.LogEntries()
+    result.CopyFrom(log_entries_proto)
+    del result.compressed_entries[:]
+
+    last_timestamp = 0
+    last_thread = b''
+    for compressed in log_entries_proto.compressed_entries:
+        if compressed.entry:
+            result.entries.append(log_pb2.LogEntry.FromString(compressed.entry))
+            continue
+
+        referenced = log_pb2.LogEntry()
+        if compressed.reference:
+            if compressed.reference > len(result.entries):
+                raise ValueError(
+                    f'Compressed log entry refers to entry '
+                    f'{compressed.reference}, but only '
+                    f'{len(result.entries)} entries precede it'
+                )
+            referenced = result.entries[compressed.reference - 1]
+
+        shared = compressed.shared_prefix + compressed.shared_suffix
+        if shared > len(referenced.message):
+            raise ValueError(
+                f'Compressed log entry shares {shared} bytes with a '
+                f'{len(referenced.message)}-byte message'
+            )
+        suffix_start = len(referenced.message) - compressed.shared_suffix
+
+        entry = log_pb2.LogEntry()
+        message = (
+            referenced.message[: compressed.shared_prefix]
+            + compressed.message
+            + referenced.message[suffix_start:]
+        )
+        if message:
+            entry.message = message
+        for field in ('line_level', 'flags', 'module', 'file'):
+            if compressed.HasField(field):
+                setattr(entry, field, getattr(compressed, field))
+            else:
+                setattr(entry, field, getattr(referenced, field))
+        if compressed.HasField('timestamp_delta'):
+            last_timestamp = _wrap_int64(
+                last_timestamp + compressed.timestamp_delta
+            )
+            entry.timestamp = last_timestamp
+        entry.dropped = compressed.dropped
+        if compressed.HasField('thread'):
+            last_thread = compressed.thread
+        entry.thread = last_thread
+        result.entries.append(entry)
+
+    return result
+
+
 class LogStreamDecoder:
     """Decodes an RPC stream of LogEntries packets.
 
@@ -276,6 +354,7 @@ class LogStreamDecoder:
         Returns:
             A Log object with the decoded log_entry_proto.
         """
+        log_entries_proto = decompress_log_entries(log_entries_proto)
         has_received_logs = self._expected_log_sequence_id > 0
         dropped_log_count = self._calculate_dropped_logs(log_entries_proto)
         if dropped_log_count > 0:
@@ -0,0 +1,684 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_rpc/log_compressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+#include "pw_assert/check.h"
+#include "pw_protobuf/config.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_status/try.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::log_rpc {
+namespace {
+
+namespace CompressedLogEntry = ::pw::log::pwpb::CompressedLogEntry;
+namespace LogEntries = ::pw::log::pwpb::LogEntries;
+namespace LogEntry = ::pw::log::pwpb::LogEntry;
+
+// The fields of a LogEntry that CompressedLogEntry can represent.
+struct EntryFields {
+  ConstByteSpan message;
+  ConstByteSpan module;
+  ConstByteSpan file;
+  ConstByteSpan thread;
+  uint32_t line_level = 0;
+  uint32_t flags = 0;
+  uint32_t dropped = 0;
+  int64_t timestamp = 0;
+  bool has_timestamp = false;
+};
+
+// Decodes an encoded LogEntry. Returns false if the entry is malformed, or if
+// it cannot be compressed without changing it: it has an empty message field,
+// a time_since_last_entry, or unknown fields.
+bool DecodeEntry(ConstByteSpan entry, EntryFields& fields) {
+  protobuf::Decoder decoder(entry);
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    switch (static_cast<LogEntry::Fields>(decoder.FieldNumber())) {
+      case LogEntry::Fields::kMessage:
+        status = decoder.ReadBytes(&fields.message);
+        if (fields.message.empty()) {
+          return false;
+        }
+        break;
+      case LogEntry::Fields::kLineLevel:
+        status = decoder.ReadUint32(&fields.line_level);
+        break;
+      case LogEntry::Fields::kFlags:
+        status = decoder.ReadUint32(&fields.flags);
+        break;
+      case LogEntry::Fields::kTimestamp:
+        status = decoder.ReadInt64(&fields.timestamp);
+        fields.has_timestamp = true;
+        break;
+      case LogEntry::Fields::kDropped:
+        status = decoder.ReadUint32(&fields.dropped);
+        break;
+      case LogEntry::Fields::kModule:
+        status = decoder.ReadBytes(&fields.module);
+        break;
+      case LogEntry::Fields::kFile:
+        status = decoder.ReadBytes(&fields.file);
+        break;
+      case LogEntry::Fields::kThread:
+        status = decoder.ReadBytes(&fields.thread);
+        break;
+      default:
+        return false;
+    }
+    if (!status.ok()) {
+      return false;
+    }
+  }
+  return status.IsOutOfRange();
+}
+
+bool Equal(ConstByteSpan a, ConstByteSpan b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+size_t SharedPrefix(ConstByteSpan a, ConstByteSpan b) {
+  const size_t size = std::min(a.size(), b.size());
+  return static_cast<size_t>(
+      std::mismatch(a.begin(), a.begin() + size, b.begin()).first - a.begin());
+}
+
+size_t SharedSuffix(ConstByteSpan a, ConstByteSpan b) {
+  const size_t size = std::min(a.size(), b.size());
+  return static_cast<size_t>(
+      std::mismatch(a.rbegin(), a.rbegin() + size, b.rbegin()).first -
+      a.rbegin());
+}
+
+// Whether sending the size of a shared prefix or suffix is smaller than
+// sending its bytes.
+constexpr bool SavesBytes(CompressedLogEntry::Fields field, size_t shared) {
+  return shared > protobuf::SizeOfFieldUint32(field, shared);
+}
+
+// The space needed in a LogEntries encoder to start a compressed entry.
+constexpr size_t kNestedEntryOverhead =
+    protobuf::TagSizeBytes(LogEntries::Fields::kCompressedEntries) +
+    protobuf::config::kMaxVarintSize;
+
+}  // namespace
+
+void LogCompressor::Reset() {
+  for (Slot& slot : slots_) {
+    slot.reference = 0;
+  }
+  entry_count_ = 0;
+  last_timestamp_ = 0;
+  last_thread_size_ = 0;
+}
+
+Status LogCompressor::Write(ConstByteSpan entry,
+                           LogEntries::MemoryEncoder& encoder,
+                           size_t reserved_size) {
+  EntryFields fields;
+  if (!DecodeEntry(entry, fields)) {
+    PW_TRY(WriteUncompressed(entry, encoder, reserved_size));
+    ++entry_count_;
+    return OkStatus();
+  }
+
+  // Find the last entry from the same log statement.
+  uint32_t key = 0;
+  Slot* slot = nullptr;
+  if (fields.message.size() >= sizeof(key)) {
+    std::memcpy(&key, fields.message.data(), sizeof(key));
+    slot = &slots_[((key * 0x9e3779b1u) >> 16) & (kSlotCount - 1)];
+  }
+  const Slot* reference =
+      slot != nullptr && slot->reference != 0 && slot->key == key ? slot
+                                                                  : nullptr;
+
+  // Find what differs from the referenced entry. Without a reference, every
+  // field that is not empty or zero is written.
+  size_t prefix = 0;
+  size_t suffix = 0;
+  bool write_line_level = fields.line_level != 0;
+  bool write_flags = fields.flags != 0;
+  bool write_module = !fields.module.empty();
+  bool write_file = !fields.file.empty();
+  if (reference != nullptr) {
+    const ConstByteSpan stored =
+        span(reference->data).first(reference->message_size);
+    prefix = SharedPrefix(fields.message, stored);
+    if (!SavesBytes(CompressedLogEntry::Fields::kSharedPrefix, prefix)) {
+      prefix = 0;
+    }
+    if (reference->message_complete) {
+      suffix = SharedSuffix(fields.message.subspan(prefix),
+                            stored.subspan(prefix));
+      if (!SavesBytes(CompressedLogEntry::Fields::kSharedSuffix, suffix)) {
+        suffix = 0;
+      }
+    }
+    write_line_level = fields.line_level != reference->line_level;
+    write_flags = fields.flags != reference->flags;
+
+    const size_t module_offset = reference->message_size;
+    write_module = reference->module_size == kNotStored ||
+                   !Equal(fields.module,
+                          span(reference->data)
+                              .subspan(module_offset, reference->module_size));
+    const size_t file_offset =
+        module_offset +
+        (reference->module_size == kNotStored ? 0 : reference->module_size);
+    write_file = reference->file_size == kNotStored ||
+                 !Equal(fields.file,
+                        span(reference->data)
+                            .subspan(file_offset, reference->file_size));
+  }
+  const ConstByteSpan message =
+      fields.message.subspan(prefix, fields.message.size() - prefix - suffix);
+  const bool write_thread = !IsLastThread(fields.thread);
+  // Timestamps may be in any order, so the difference wraps around.
+  const int64_t timestamp_delta =
+      static_cast<int64_t>(static_cast<uint64_t>(fields.timestamp) -
+                           static_cast<uint64_t>(last_timestamp_));
+
+  size_t size = 0;
+  if (reference != nullptr) {
+    size += protobuf::SizeOfFieldUint32(CompressedLogEntry::Fields::kReference,
+                                        reference->reference);
+  }
+  if (prefix != 0) {
+    size += protobuf::SizeOfFieldUint32(
+        CompressedLogEntry::Fields::kSharedPrefix, prefix);
+  }
+  if (suffix != 0) {
+    size += protobuf::SizeOfFieldUint32(
+        CompressedLogEntry::Fields::kSharedSuffix, suffix);
+  }
+  if (!message.empty()) {
+    size += protobuf::SizeOfFieldBytes(CompressedLogEntry::Fields::kMessage,
+                                       message.size());
+  }
+  if (write_line_level) {
+    size += protobuf::SizeOfFieldUint32(
+        CompressedLogEntry::Fields::kLineLevel, fields.line_level);
+  }
+  if (write_flags) {
+    size += protobuf::SizeOfFieldUint32(CompressedLogEntry::Fields::kFlags,
+                                        fields.flags);
+  }
+  if (fields.has_timestamp) {
+    size += protobuf::SizeOfFieldSint64(
+        CompressedLogEntry::Fields::kTimestampDelta, timestamp_delta);
+  }
+  if (fields.dropped != 0) {
+    size += protobuf::SizeOfFieldUint32(CompressedLogEntry::Fields::kDropped,
+                                        fields.dropped);
+  }
+  if (write_module) {
+    size += protobuf::SizeOfFieldBytes(CompressedLogEntry::Fields::kModule,
+                                       fields.module.size());
+  }
+  if (write_file) {
+    size += protobuf::SizeOfFieldBytes(CompressedLogEntry::Fields::kFile,
+                                       fields.file.size());
+  }
+  if (write_thread) {
+    size += protobuf::SizeOfFieldBytes(CompressedLogEntry::Fields::kThread,
+                                       fields.thread.size());
+  }
+
+  // Entries that don't repeat anything, such as the first entry, may be
+  // smaller as they are.
+  if (size >= protobuf::SizeOfFieldBytes(CompressedLogEntry::Fields::kEntry,
+                                         entry.size())) {
+    PW_TRY(WriteUncompressed(entry, encoder, reserved_size));
+    if (slot != nullptr) {
+      Remember(*slot,
+               key,
+               fields.message,
+               fields.line_level,
+               fields.flags,
+               fields.module,
+               fields.file);
+    }
+    ++entry_count_;
+    return OkStatus();
+  }
+
+  if (size + kNestedEntryOverhead + reserved_size >
+      encoder.ConservativeWriteLimit()) {
+    return Status::ResourceExhausted();
+  }
+
+  {
+    CompressedLogEntry::StreamEncoder compressed =
+        encoder.GetCompressedEntriesEncoder();
+    // The size was checked above, so writes can't fail.
+    if (reference != nullptr) {
+      compressed.WriteReference(reference->reference).IgnoreError();
+    }
+    if (prefix != 0) {
+      compressed.WriteSharedPrefix(static_cast<uint32_t>(prefix))
+          .IgnoreError();
+    }
+    if (suffix != 0) {
+      compressed.WriteSharedSuffix(static_cast<uint32_t>(suffix))
+          .IgnoreError();
+    }
+    if (!message.empty()) {
+      compressed.WriteMessage(message).IgnoreError();
+    }
+    if (write_line_level) {
+      compressed.WriteLineLevel(fields.line_level).IgnoreError();
+    }
+    if (write_flags) {
+      compressed.WriteFlags(fields.flags).IgnoreError();
+    }
+    if (fields.has_timestamp) {
+      compressed.WriteTimestampDelta(timestamp_delta).IgnoreError();
+    }
+    if (fields.dropped != 0) {
+      compressed.WriteDropped(fields.dropped).IgnoreError();
+    }
+    if (write_module) {
+      compressed.WriteModule(fields.module).IgnoreError();
+    }
+    if (write_file) {
+      compressed.WriteFile(fields.file).IgnoreError();
+    }
+    if (write_thread) {
+      compressed.WriteThread(fields.thread).IgnoreError();
+    }
+  }
+  PW_CHECK_OK(encoder.status());
+
+  if (slot != nullptr) {
+    Remember(*slot,
+             key,
+             fields.message,
+             fields.line_level,
+             fields.flags,
+             fields.module,
+             fields.file);
+  }
+  if (fields.has_timestamp) {
+    last_timestamp_ = fields.timestamp;
+  }
+  SetLastThread(fields.thread);
+  ++entry_count_;
+  return OkStatus();
+}
+
+Status LogCompressor::WriteUncompressed(ConstByteSpan entry,
+                                        LogEntries::MemoryEncoder& encoder,
+                                        size_t reserved_size) {
+  const size_t size = protobuf::SizeOfFieldBytes(
+      CompressedLogEntry::Fields::kEntry, entry.size());
+  if (size + kNestedEntryOverhead + reserved_size >
+      encoder.ConservativeWriteLimit()) {
+    return Status::ResourceExhausted();
+  }
+  {
+    CompressedLogEntry::StreamEncoder compressed =
+        encoder.GetCompressedEntriesEncoder();
+    compressed.WriteEntry(entry).IgnoreError();
+  }
+  PW_CHECK_OK(encoder.status());
+  return OkStatus();
+}
+
+void LogCompressor::Remember(Slot& slot,
+                             uint32_t key,
+                             ConstByteSpan message,
+                             uint32_t line_level,
+                             uint32_t flags,
+                             ConstByteSpan module,
+                             ConstByteSpan file) {
+  // References past the size of the field are not supported, which is more
+  // entries than fit in any practical LogEntries message.
+  if (entry_count_ >= std::numeric_limits<uint16_t>::max()) {
+    slot.reference = 0;
+    return;
+  }
+  slot.key = key;
+  slot.reference = static_cast<uint16_t>(entry_count_ + 1);
+  slot.line_level = line_level;
+  slot.flags = flags;
+
+  const size_t message_size = std::min(message.size(), kSlotSize);
+  std::memcpy(slot.data.data(), message.data(), message_size);
+  slot.message_size = static_cast<uint8_t>(message_size);
+  slot.message_complete = message_size == message.size();
+
+  size_t stored = message_size;
+  slot.module_size = kNotStored;
+  if (slot.message_complete && module.size() <= kSlotSize - stored) {
+    std::memcpy(slot.data.data() + stored, module.data(), module.size());
+    slot.module_size = static_cast<uint8_t>(module.size());
+    stored += module.size();
+  }
+  slot.file_size = kNotStored;
+  if (slot.message_complete && file.size() <= kSlotSize - stored) {
+    std::memcpy(slot.data.data() + stored, file.data(), file.size());
+    slot.file_size = static_cast<uint8_t>(file.size());
+  }
+}
+
+bool LogCompressor::IsLastThread(ConstByteSpan thread) const {
+  return last_thread_size_ != kNotStored &&
+         Equal(thread, span(last_thread_).first(last_thread_size_));
+}
+
+void LogCompressor::SetLastThread(ConstByteSpan thread) {
+  if (thread.size() > kSlotSize) {
+    last_thread_size_ = kNotStored;
+    return;
+  }
+  std::memcpy(last_thread_.data(), thread.data(), thread.size());
+  last_thread_size_ = static_cast<uint8_t>(thread.size());
+}
+
+namespace {
+
+// Expands compressed entries into LogEntry messages.
+class Decompressor {
+ public:
+  explicit Decompressor(ByteSpan buffer) : writer_(buffer) {}
+
+  Status CopyEntry(ConstByteSpan entry);
+  Status ExpandEntry(ConstByteSpan compressed);
+  Status WriteSequenceId(uint32_t sequence_id);
+
+  ConstByteSpan output() const { return writer_.WrittenData(); }
+
+ private:
+  // Finds an entry that was already written by its reference number.
+  Result<ConstByteSpan> FindEntry(uint32_t reference) const;
+
+  stream::MemoryWriter writer_;
+  uint32_t entry_count_ = 0;
+  int64_t last_timestamp_ = 0;
+  ConstByteSpan last_thread_;
+};
+
+Status Decompressor::CopyEntry(ConstByteSpan entry) {
+  PW_TRY(protobuf::WriteLengthDelimitedKeyAndLengthPrefix(
+      static_cast<uint32_t>(LogEntries::Fields::kEntries),
+      entry.size(),
+      writer_));
+  PW_TRY(writer_.Write(entry));
+  ++entry_count_;
+  return OkStatus();
+}
+
+Status Decompressor::WriteSequenceId(uint32_t sequence_id) {
+  PW_TRY(protobuf::WriteVarint(
+      protobuf::FieldKey(
+          static_cast<uint32_t>(LogEntries::Fields::kFirstEntrySequenceId),
+          protobuf::WireType::kVarint),
+      writer_));
+  return protobuf::WriteVarint(sequence_id, writer_);
+}
+
+Result<ConstByteSpan> Decompressor::FindEntry(uint32_t reference) const {
+  if (reference > entry_count_) {
+    return Status::DataLoss();
+  }
+  protobuf::Decoder decoder(writer_.WrittenData());
+  uint32_t count = 0;
+  while (decoder.Next().ok()) {
+    if (decoder.FieldNumber() ==
+            static_cast<uint32_t>(LogEntries::Fields::kEntries) &&
+        ++count == reference) {
+      ConstByteSpan entry;
+      PW_TRY(decoder.ReadBytes(&entry));
+      return entry;
+    }
+  }
+  return Status::DataLoss();
+}
+
+Status Decompressor::ExpandEntry(ConstByteSpan compressed) {
+  uint32_t reference = 0;
+  uint32_t prefix = 0;
+  uint32_t suffix = 0;
+  ConstByteSpan message;
+  std::optional<uint32_t> line_level;
+  std::optional<uint32_t> flags;
+  std::optional<int64_t> timestamp_delta;
+  uint32_t dropped = 0;
+  std::optional<ConstByteSpan> module;
+  std::optional<ConstByteSpan> file;
+  std::optional<ConstByteSpan> thread;
+  std::optional<ConstByteSpan> entry;
+
+  protobuf::Decoder decoder(compressed);
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    ConstByteSpan bytes;
+    uint32_t value = 0;
+    switch (static_cast<CompressedLogEntry::Fields>(decoder.FieldNumber())) {
+      case CompressedLogEntry::Fields::kReference:
+        status = decoder.ReadUint32(&reference);
+        break;
+      case CompressedLogEntry::Fields::kSharedPrefix:
+        status = decoder.ReadUint32(&prefix);
+        break;
+      case CompressedLogEntry::Fields::kSharedSuffix:
+        status = decoder.ReadUint32(&suffix);
+        break;
+      case CompressedLogEntry::Fields::kMessage:
+        status = decoder.ReadBytes(&message);
+        break;
+      case CompressedLogEntry::Fields::kLineLevel:
+        status = decoder.ReadUint32(&value);
+        line_level = value;
+        break;
+      case CompressedLogEntry::Fields::kFlags:
+        status = decoder.ReadUint32(&value);
+        flags = value;
+        break;
+      case CompressedLogEntry::Fields::kTimestampDelta: {
+        int64_t delta = 0;
+        status = decoder.ReadSint64(&delta);
+        timestamp_delta = delta;
+        break;
+      }
+      case CompressedLogEntry::Fields::kDropped:
+        status = decoder.ReadUint32(&dropped);
+        break;
+      case CompressedLogEntry::Fields::kModule:
+        status = decoder.ReadBytes(&bytes);
+        module = bytes;
+        break;
+      case CompressedLogEntry::Fields::kFile:
+        status = decoder.ReadBytes(&bytes);
+        file = bytes;
+        break;
+      case CompressedLogEntry::Fields::kThread:
+        status = decoder.ReadBytes(&bytes);
+        thread = bytes;
+        break;
+      case CompressedLogEntry::Fields::kEntry:
+        status = decoder.ReadBytes(&bytes);
+        entry = bytes;
+        break;
+    }
+    if (!status.ok()) {
+      return Status::DataLoss();
+    }
+  }
+  if (!status.IsOutOfRange()) {
+    return Status::DataLoss();
+  }
+
+  if (entry.has_value()) {
+    return CopyEntry(*entry);
+  }
+
+  // Fill in the fields that were omitted from the referenced entry.
+  EntryFields referenced;
+  if (reference != 0) {
+    PW_TRY_ASSIGN(const ConstByteSpan referenced_entry, FindEntry(reference));
+    DecodeEntry(referenced_entry, referenced);
+  }
+  if (size_t{prefix} + suffix > referenced.message.size()) {
+    return Status::DataLoss();
+  }
+  const ConstByteSpan message_prefix = referenced.message.first(prefix);
+  const ConstByteSpan message_suffix = referenced.message.last(suffix);
+  const size_t message_size =
+      message_prefix.size() + message.size() + message_suffix.size();
+  if (!line_level.has_value()) {
+    line_level = referenced.line_level;
+  }
+  if (!flags.has_value()) {
+    flags = referenced.flags;
+  }
+  if (!module.has_value()) {
+    module = referenced.module;
+  }
+  if (!file.has_value()) {
+    file = referenced.file;
+  }
+  if (thread.has_value()) {
+    last_thread_ = *thread;
+  }
+  if (timestamp_delta.has_value()) {
+    last_timestamp_ = static_cast<int64_t>(
+        static_cast<uint64_t>(last_timestamp_) +
+        static_cast<uint64_t>(*timestamp_delta));
+  }
+
+  // Write the LogEntry, omitting empty fields as a pw_log encoder would.
+  size_t size = 0;
+  if (message_size != 0) {
+    size += protobuf::SizeOfFieldBytes(LogEntry::Fields::kMessage,
+                                       message_size);
+  }
+  if (*line_level != 0) {
+    size +=
+        protobuf::SizeOfFieldUint32(LogEntry::Fields::kLineLevel, *line_level);
+  }
+  if (*flags != 0) {
+    size += protobuf::SizeOfFieldUint32(LogEntry::Fields::kFlags, *flags);
+  }
+  if (timestamp_delta.has_value()) {
+    size += protobuf::SizeOfFieldInt64(LogEntry::Fields::kTimestamp,
+                                       last_timestamp_);
+  }
+  if (dropped != 0) {
+    size += protobuf::SizeOfFieldUint32(LogEntry::Fields::kDropped, dropped);
+  }
+  if (!module->empty()) {
+    size += protobuf::SizeOfFieldBytes(LogEntry::Fields::kModule,
+                                       module->size());
+  }
+  if (!file->empty()) {
+    size += protobuf::SizeOfFieldBytes(LogEntry::Fields::kFile, file->size());
+  }
+  if (!last_thread_.empty()) {
+    size += protobuf::SizeOfFieldBytes(LogEntry::Fields::kThread,
+                                       last_thread_.size());
+  }
+
+  const auto write_varint = [this](LogEntry::Fields field, uint64_t value) {
+    PW_TRY(protobuf::WriteVarint(
+        protobuf::FieldKey(static_cast<uint32_t>(field),
+                           protobuf::WireType::kVarint),
+        writer_));
+    return protobuf::WriteVarint(value, writer_);
+  };
+  const auto write_bytes = [this](LogEntry::Fields field, ConstByteSpan value) {
+    PW_TRY(protobuf::WriteLengthDelimitedKeyAndLengthPrefix(
+        static_cast<uint32_t>(field), value.size(), writer_));
+    return writer_.Write(value);
+  };
+
+  PW_TRY(protobuf::WriteLengthDelimitedKeyAndLengthPrefix(
+      static_cast<uint32_t>(LogEntries::Fields::kEntries), size, writer_));
+  if (message_size != 0) {
+    PW_TRY(protobuf::WriteLengthDelimitedKeyAndLengthPrefix(
+        static_cast<uint32_t>(LogEntry::Fields::kMessage),
+        message_size,
+        writer_));
+    PW_TRY(writer_.Write(message_prefix));
+    PW_TRY(writer_.Write(message));
+    PW_TRY(writer_.Write(message_suffix));
+  }
+  if (*line_level != 0) {
+    PW_TRY(write_varint(LogEntry::Fields::kLineLevel, *line_level));
+  }
+  if (*flags != 0) {
+    PW_TRY(write_varint(LogEntry::Fields::kFlags, *flags));
+  }
+  if (timestamp_delta.has_value()) {
+    PW_TRY(write_varint(LogEntry::Fields::kTimestamp,
+                        static_cast<uint64_t>(last_timestamp_)));
+  }
+  if (dropped != 0) {
+    PW_TRY(write_varint(LogEntry::Fields::kDropped, dropped));
+  }
+  if (!module->empty()) {
+    PW_TRY(write_bytes(LogEntry::Fields::kModule, *module));
+  }
+  if (!file->empty()) {
+    PW_TRY(write_bytes(LogEntry::Fields::kFile, *file));
+  }
+  if (!last_thread_.empty()) {
+    PW_TRY(write_bytes(LogEntry::Fields::kThread, last_thread_));
+  }
+  ++entry_count_;
+  return OkStatus();
+}
+
+}  // namespace
+
+Result<ConstByteSpan> DecompressLogEntries(ConstByteSpan log_entries,
+                                           ByteSpan buffer) {
+  Decompressor decompressor(buffer);
+  protobuf::Decoder decoder(log_entries);
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    ConstByteSpan bytes;
+    uint32_t sequence_id = 0;
+    switch (static_cast<LogEntries::Fields>(decoder.FieldNumber())) {
+      case LogEntries::Fields::kEntries:
+        PW_TRY(decoder.ReadBytes(&bytes));
+        PW_TRY(decompressor.CopyEntry(bytes));
+        break;
+      case LogEntries::Fields::kFirstEntrySequenceId:
+        PW_TRY(decoder.ReadUint32(&sequence_id));
+        PW_TRY(decompressor.WriteSequenceId(sequence_id));
+        break;
+      case LogEntries::Fields::kCompressedEntries:
+        PW_TRY(decoder.ReadBytes(&bytes));
+        PW_TRY(decompressor.ExpandEntry(bytes));
+        break;
+    }
+  }
+  if (!status.IsOutOfRange()) {
+    return Status::DataLoss();
+  }
+  return decompressor.output();
+}
+
+}  // namespace pw::log_rpc
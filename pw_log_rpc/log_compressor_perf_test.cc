@@ -0,0 +1,145 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the cost of encoding a bundle of tokenized logs as regular and as
+// compressed entries, and of expanding the compressed entries. The size of
+// each encoding is logged once.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "pw_assert/check.h"
+#include "pw_bytes/endian.h"
+#include "pw_bytes/span.h"
+#include "pw_log/levels.h"
+#include "pw_log/log.h"
+#include "pw_log/proto/log.pwpb.h"
+#include "pw_log/proto_utils.h"
+#include "pw_log_rpc/log_compressor.h"
+#include "pw_log_tokenized/metadata.h"
+#include "pw_perf_test/perf_test.h"
+
+namespace pw::log_rpc {
+namespace {
+
+namespace LogEntries = ::pw::log::pwpb::LogEntries;
+
+constexpr size_t kLogsPerBundle = 32;
+constexpr size_t kStatementCount = 8;
+constexpr std::array<std::string_view, 3> kThreads = {"main", "net", "sensors"};
+
+// Encodes a tokenized log from one of a few log statements, with arguments
+// that change slowly, as in a typical log stream.
+ConstByteSpan EncodeSampleLog(size_t index, ByteSpan buffer) {
+  const size_t statement = (index * 5) % kStatementCount;
+  const uint32_t token = bytes::ConvertOrderTo(
+      endian::little, static_cast<uint32_t>(0x9e3779b1u * (statement + 1)));
+  std::array<uint8_t, 8> message = {};
+  std::memcpy(message.data(), &token, sizeof(token));
+  message[4] = static_cast<uint8_t>(index / kStatementCount);  // counter
+  message[5] = 0x64;                                           // constant
+  message[6] = static_cast<uint8_t>(2 * (index % 3));          // small value
+  message[7] = 0x01;                                           // constant
+
+  const log_tokenized::Metadata metadata(
+      PW_LOG_LEVEL_INFO, /*module=*/0x4c47, /*flags=*/0, 100 + 10 * statement);
+  const std::string_view thread = kThreads[(index / 4) % kThreads.size()];
+  const Result<ConstByteSpan> entry = log::EncodeTokenizedLog(
+      metadata,
+      message.data(),
+      message.size(),
+      /*ticks_since_epoch=*/1'000'000 + static_cast<int64_t>(index) * 997,
+      as_bytes(span(thread)),
+      buffer);
+  PW_CHECK_OK(entry.status());
+  return entry.value();
+}
+
+std::array<ConstByteSpan, kLogsPerBundle>& SampleLogs() {
+  static std::array<std::array<std::byte, 64>, kLogsPerBundle> buffers;
+  static std::array<ConstByteSpan, kLogsPerBundle> logs;
+  for (size_t i = 0; i < kLogsPerBundle; ++i) {
+    logs[i] = EncodeSampleLog(i, buffers[i]);
+  }
+  return logs;
+}
+
+ConstByteSpan EncodeUncompressed(span<const ConstByteSpan> logs,
+                                 ByteSpan buffer) {
+  LogEntries::MemoryEncoder encoder(buffer);
+  for (ConstByteSpan log : logs) {
+    PW_CHECK_OK(encoder.WriteBytes(
+        static_cast<uint32_t>(LogEntries::Fields::kEntries), log));
+  }
+  return encoder;
+}
+
+ConstByteSpan EncodeCompressed(LogCompressor& compressor,
+                               span<const ConstByteSpan> logs,
+                               ByteSpan buffer) {
+  LogEntries::MemoryEncoder encoder(buffer);
+  compressor.Reset();
+  for (ConstByteSpan log : logs) {
+    PW_CHECK_OK(compressor.Write(log, encoder));
+  }
+  return encoder;
+}
+
+void WriteEntries(perf_test::State& state) {
+  static std::array<std::byte, 2048> buffer;
+  const std::array<ConstByteSpan, kLogsPerBundle>& logs = SampleLogs();
+
+  PW_LOG_INFO("Regular entries: %u bytes for %u logs",
+              static_cast<unsigned>(EncodeUncompressed(logs, buffer).size()),
+              static_cast<unsigned>(kLogsPerBundle));
+  while (state.KeepRunning()) {
+    EncodeUncompressed(logs, buffer);
+  }
+}
+
+void WriteCompressedEntries(perf_test::State& state) {
+  static std::array<std::byte, 2048> buffer;
+  static LogCompressor compressor;
+  const std::array<ConstByteSpan, kLogsPerBundle>& logs = SampleLogs();
+
+  PW_LOG_INFO(
+      "Compressed entries: %u bytes for %u logs",
+      static_cast<unsigned>(EncodeCompressed(compressor, logs, buffer).size()),
+      static_cast<unsigned>(kLogsPerBundle));
+  while (state.KeepRunning()) {
+    EncodeCompressed(compressor, logs, buffer);
+  }
+}
+
+void DecompressEntries(perf_test::State& state) {
+  static std::array<std::byte, 2048> buffer;
+  static std::array<std::byte, 2048> output;
+  static LogCompressor compressor;
+  const ConstByteSpan compressed =
+      EncodeCompressed(compressor, SampleLogs(), buffer);
+
+  while (state.KeepRunning()) {
+    PW_CHECK_OK(DecompressLogEntries(compressed, output).status());
+  }
+}
+
+PW_PERF_TEST(Write32Logs, WriteEntries);
+PW_PERF_TEST(WriteCompressed32Logs, WriteCompressedEntries);
+PW_PERF_TEST(Decompress32Logs, DecompressEntries);
+
+}  // namespace
+}  // namespace pw::log_rpc
@@ -0,0 +1,451 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_rpc/log_compressor.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+#include "pw_assert/assert.h"
+#include "pw_bytes/array.h"
+#include "pw_bytes/span.h"
+#include "pw_log/levels.h"
+#include "pw_log/proto/log.pwpb.h"
+#include "pw_log/proto_utils.h"
+#include "pw_log_tokenized/metadata.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw::log_rpc {
+namespace {
+
+namespace CompressedLogEntry = ::pw::log::pwpb::CompressedLogEntry;
+namespace LogEntries = ::pw::log::pwpb::LogEntries;
+namespace LogEntry = ::pw::log::pwpb::LogEntry;
+using namespace std::literals::string_view_literals;
+
+// Tokenized messages: a 4-byte token followed by varint-encoded arguments.
+constexpr std::string_view kTokenA = "\x11\x22\x33\x44"sv;
+constexpr std::string_view kTokenB = "\x55\x66\x77\x88"sv;
+
+constexpr bool Equal(ConstByteSpan a, ConstByteSpan b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+class LogCompressorTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kMaxEntries = 16;
+  static constexpr size_t kMaxEntrySize = 160;
+
+  LogCompressorTest() : encoder_(log_entries_buffer_) {}
+
+  // Encodes a log, and adds it to the entries expected after decompression.
+  ConstByteSpan EncodeLog(std::string_view message,
+                          int64_t timestamp,
+                          std::string_view thread = "",
+                          std::string_view file = "",
+                          int line = 123,
+                          unsigned int flags = 0,
+                          std::string_view module = "") {
+    ByteSpan buffer = entry_buffers_[entry_count_];
+    Result<ConstByteSpan> entry = log::EncodeLog(PW_LOG_LEVEL_INFO,
+                                                 flags,
+                                                 module,
+                                                 thread,
+                                                 file,
+                                                 line,
+                                                 timestamp,
+                                                 message,
+                                                 buffer);
+    PW_ASSERT(entry.ok());
+    entries_[entry_count_++] = *entry;
+    return *entry;
+  }
+
+  // Adds an already encoded entry to the expected entries.
+  ConstByteSpan AddEncoded(ConstByteSpan entry) {
+    entries_[entry_count_++] = entry;
+    return entry;
+  }
+
+  Status WriteAll() {
+    for (size_t i = written_count_; i < entry_count_; ++i) {
+      if (Status status = compressor_.Write(entries_[i], encoder_);
+          !status.ok()) {
+        return status;
+      }
+      ++written_count_;
+    }
+    return OkStatus();
+  }
+
+  // Size of the written entries as a regular LogEntries message.
+  size_t UncompressedSize() const {
+    size_t size = 0;
+    for (size_t i = 0; i < written_count_; ++i) {
+      size += protobuf::SizeOfFieldBytes(LogEntries::Fields::kEntries,
+                                         entries_[i].size());
+    }
+    return size;
+  }
+
+  // Decompresses the encoded message and checks that it has the written
+  // entries.
+  void ExpectDecompressedEntries() {
+    ASSERT_EQ(encoder_.status(), OkStatus());
+    Result<ConstByteSpan> result =
+        DecompressLogEntries(ConstByteSpan(encoder_), decompress_buffer_);
+    ASSERT_EQ(result.status(), OkStatus());
+
+    protobuf::Decoder decoder(*result);
+    size_t count = 0;
+    while (decoder.Next().ok()) {
+      ASSERT_EQ(decoder.FieldNumber(),
+                static_cast<uint32_t>(LogEntries::Fields::kEntries));
+      ConstByteSpan entry;
+      ASSERT_EQ(decoder.ReadBytes(&entry), OkStatus());
+      ASSERT_LT(count, written_count_);
+      EXPECT_TRUE(Equal(entry, entries_[count])) << "Entry " << count;
+      ++count;
+    }
+    EXPECT_EQ(count, written_count_);
+  }
+
+  // Counts the compressed entries written as complete LogEntry messages.
+  size_t CountUncompressedEntries() const {
+    size_t count = 0;
+    protobuf::Decoder decoder{ConstByteSpan(encoder_)};
+    while (decoder.Next().ok()) {
+      ConstByteSpan compressed;
+      PW_ASSERT(decoder.ReadBytes(&compressed).ok());
+      protobuf::Decoder entry_decoder(compressed);
+      while (entry_decoder.Next().ok()) {
+        if (entry_decoder.FieldNumber() ==
+            static_cast<uint32_t>(CompressedLogEntry::Fields::kEntry)) {
+          ++count;
+        }
+      }
+    }
+    return count;
+  }
+
+  std::array<std::array<std::byte, kMaxEntrySize>, kMaxEntries>
+      entry_buffers_{};
+  std::array<ConstByteSpan, kMaxEntries> entries_{};
+  size_t entry_count_ = 0;
+  size_t written_count_ = 0;
+
+  LogCompressor compressor_;
+  std::array<std::byte, 1024> log_entries_buffer_{};
+  LogEntries::MemoryEncoder encoder_;
+  std::array<std::byte, 2048> decompress_buffer_{};
+};
+
+TEST_F(LogCompressorTest, SingleEntry) {
+  EncodeLog("Hello, world!", 1000, "main", "main.cc");
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+}
+
+TEST_F(LogCompressorTest, RepeatedTokenizedLogs) {
+  for (int i = 0; i < 10; ++i) {
+    const std::array<char, 7> message = {
+        kTokenA[0], kTokenA[1], kTokenA[2], kTokenA[3], 0x02,
+        static_cast<char>(i), 0x7f};
+    EncodeLog(std::string_view(message.data(), message.size()),
+              123456789 + i * 1000,
+              "sensors");
+  }
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+  EXPECT_EQ(CountUncompressedEntries(), 0u);
+  EXPECT_LT(encoder_.size(), UncompressedSize() * 6 / 10);
+}
+
+TEST_F(LogCompressorTest, InterleavedLogStatements) {
+  EncodeLog("\x11\x22\x33\x44\x01"sv, 10, "a");
+  EncodeLog("\x55\x66\x77\x88\x03"sv, 20, "b");
+  EncodeLog("\x11\x22\x33\x44\x02"sv, 30, "a");
+  EncodeLog("\x55\x66\x77\x88\x04"sv, 40, "b");
+  EncodeLog("\x11\x22\x33\x44\x01"sv, 50, "a");
+  EncodeLog("\x55\x66\x77\x88\x03"sv, 60, "b");
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+  EXPECT_LT(encoder_.size(), UncompressedSize());
+}
+
+TEST_F(LogCompressorTest, ChangedFieldsAreWritten) {
+  EncodeLog(kTokenA, 1, "thread", "file.cc", 100, 0, "MOD");
+  EncodeLog(kTokenA, 2, "thread", "file.cc", 100, 0, "MOD");
+  EncodeLog(kTokenA, 3, "other", "file.cc", 100, 0, "MOD");
+  EncodeLog(kTokenA, 4, "", "file.cc", 100, 0, "MOD");
+  EncodeLog(kTokenA, 5, "", "other.cc", 100, 0, "MOD");
+  EncodeLog(kTokenA, 6, "", "other.cc", 200, 0, "MOD");
+  EncodeLog(kTokenA, 7, "", "other.cc", 200, 0x3, "MOD");
+  EncodeLog(kTokenA, 8, "", "other.cc", 200, 0x3, "");
+  EncodeLog(kTokenA, 9, "", "", 200, 0x3, "");
+  EncodeLog(kTokenA, 10, "thread", "", 200, 0, "MOD");
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+}
+
+TEST_F(LogCompressorTest, TimestampsInAnyOrder) {
+  EncodeLog(kTokenA, 1'000'000'000'000);
+  EncodeLog(kTokenA, 0);
+  EncodeLog(kTokenA, -5);
+  EncodeLog(kTokenA, std::numeric_limits<int64_t>::max());
+  EncodeLog(kTokenA, std::numeric_limits<int64_t>::min());
+  EncodeLog(kTokenA, 7);
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+}
+
+TEST_F(LogCompressorTest, MessagesLongerThanSlot) {
+  constexpr std::string_view kLong =
+      "This message is longer than the compressor keeps for each log "
+      "statement, so only its start is shared";
+  static_assert(kLong.size() > cfg::kCompressorSlotSize);
+  EncodeLog(kLong, 1, "thread", "a_file_name_that_is_rather_long.cc");
+  EncodeLog(kLong, 2, "thread", "a_file_name_that_is_rather_long.cc");
+  EncodeLog("This message differs", 3);
+  EncodeLog("This message is short", 4);
+  EncodeLog("This message is short, too", 5);
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+}
+
+TEST_F(LogCompressorTest, MessagesShorterThanToken) {
+  EncodeLog("a", 1);
+  EncodeLog("a", 2);
+  EncodeLog("abc", 3);
+  EncodeLog("abc", 4);
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+}
+
+TEST_F(LogCompressorTest, DroppedEntries) {
+  EncodeLog(kTokenA, 1, "thread");
+
+  std::array<std::byte, 32> buffer;
+  LogEntry::MemoryEncoder entry(buffer);
+  entry.WriteMessage(as_bytes(span(std::string_view("dropped")))).IgnoreError();
+  entry.WriteDropped(10).IgnoreError();
+  ASSERT_EQ(entry.status(), OkStatus());
+  AddEncoded(entry);
+
+  EncodeLog(kTokenA, 2, "thread");
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+}
+
+TEST_F(LogCompressorTest, UnsupportedEntriesAreWrittenAsIs) {
+  EncodeLog(kTokenA, 1, "thread");
+
+  std::array<std::byte, 32> time_since_last_entry_buffer;
+  LogEntry::MemoryEncoder time_since_last_entry(time_since_last_entry_buffer);
+  time_since_last_entry.WriteMessage(as_bytes(span(kTokenA))).IgnoreError();
+  time_since_last_entry.WriteTimeSinceLastEntry(5).IgnoreError();
+  ASSERT_EQ(time_since_last_entry.status(), OkStatus());
+  AddEncoded(time_since_last_entry);
+
+  // An empty message field, which would be omitted when decompressed.
+  constexpr auto kEmptyMessage = bytes::Array<0x0a, 0x00, 0x10, 0x01>();
+  AddEncoded(kEmptyMessage);
+
+  constexpr auto kUnknownField = bytes::Array<0xf8, 0x01, 0x05>();
+  AddEncoded(kUnknownField);
+
+  EncodeLog(kTokenA, 2, "thread");
+  ASSERT_EQ(WriteAll(), OkStatus());
+  ExpectDecompressedEntries();
+  EXPECT_EQ(CountUncompressedEntries(), 3u);
+}
+
+TEST_F(LogCompressorTest, EntryThatDoesNotFit_WritesNothing) {
+  std::array<std::byte, 64> small_buffer;
+  LogEntries::MemoryEncoder small_encoder(small_buffer);
+
+  ConstByteSpan entry = EncodeLog("A log that takes up most of the buffer", 1);
+  EXPECT_EQ(compressor_.Write(entry, small_encoder, 32),
+            Status::ResourceExhausted());
+  EXPECT_EQ(small_encoder.size(), 0u);
+  ASSERT_EQ(compressor_.Write(entry, small_encoder), OkStatus());
+
+  size_t size;
+  Status status;
+  do {
+    size = small_encoder.size();
+    status = compressor_.Write(entry, small_encoder);
+  } while (status.ok());
+  EXPECT_EQ(status, Status::ResourceExhausted());
+  EXPECT_EQ(small_encoder.size(), size);
+  EXPECT_EQ(small_encoder.status(), OkStatus());
+}
+
+TEST_F(LogCompressorTest, ResetStartsNewMessage) {
+  EncodeLog(kTokenA, 1000, "thread", "file.cc");
+  EncodeLog(kTokenA, 2000, "thread", "file.cc");
+  ASSERT_EQ(WriteAll(), OkStatus());
+
+  // The same entries compress the same way in the next message.
+  const size_t first_size = encoder_.size();
+  std::array<std::byte, 128> next_buffer;
+  LogEntries::MemoryEncoder next_encoder(next_buffer);
+  compressor_.Reset();
+  ASSERT_EQ(compressor_.Write(entries_[0], next_encoder), OkStatus());
+  ASSERT_EQ(compressor_.Write(entries_[1], next_encoder), OkStatus());
+  ASSERT_EQ(next_encoder.size(), first_size);
+  EXPECT_TRUE(Equal(ConstByteSpan(encoder_), ConstByteSpan(next_encoder)));
+}
+
+TEST(DecompressLogEntries, UncompressedMessageIsUnchanged) {
+  std::array<std::byte, 64> entry_buffer;
+  Result<ConstByteSpan> entry = log::EncodeLog(PW_LOG_LEVEL_WARN,
+                                               0,
+                                               "",
+                                               "thread",
+                                               "file.cc",
+                                               12,
+                                               34,
+                                               "Hello",
+                                               entry_buffer);
+  ASSERT_EQ(entry.status(), OkStatus());
+
+  std::array<std::byte, 128> buffer;
+  LogEntries::MemoryEncoder encoder(buffer);
+  constexpr uint32_t kEntries =
+      static_cast<uint32_t>(LogEntries::Fields::kEntries);
+  encoder.WriteBytes(kEntries, *entry).IgnoreError();
+  encoder.WriteBytes(kEntries, *entry).IgnoreError();
+  encoder.WriteFirstEntrySequenceId(5).IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  std::array<std::byte, 128> output;
+  Result<ConstByteSpan> result = DecompressLogEntries(encoder, output);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_TRUE(Equal(*result, encoder));
+}
+
+TEST(DecompressLogEntries, SequenceIdIsKept) {
+  std::array<std::byte, 64> entry_buffer;
+  Result<ConstByteSpan> entry = log::EncodeLog(
+      PW_LOG_LEVEL_WARN, 0, "", "", "", 12, 34, "Hello", entry_buffer);
+  ASSERT_EQ(entry.status(), OkStatus());
+
+  LogCompressor compressor;
+  std::array<std::byte, 128> buffer;
+  LogEntries::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(compressor.Write(*entry, encoder), OkStatus());
+  ASSERT_EQ(compressor.Write(*entry, encoder), OkStatus());
+  encoder.WriteFirstEntrySequenceId(99).IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  std::array<std::byte, 128> output;
+  Result<ConstByteSpan> result = DecompressLogEntries(encoder, output);
+  ASSERT_EQ(result.status(), OkStatus());
+
+  std::array<ConstByteSpan, 2> entries;
+  size_t entry_count = 0;
+  uint32_t sequence_id = 0;
+  protobuf::Decoder decoder(*result);
+  while (decoder.Next().ok()) {
+    switch (static_cast<LogEntries::Fields>(decoder.FieldNumber())) {
+      case LogEntries::Fields::kEntries:
+        ASSERT_LT(entry_count, entries.size());
+        ASSERT_EQ(decoder.ReadBytes(&entries[entry_count++]), OkStatus());
+        break;
+      case LogEntries::Fields::kFirstEntrySequenceId:
+        ASSERT_EQ(decoder.ReadUint32(&sequence_id), OkStatus());
+        break;
+      case LogEntries::Fields::kCompressedEntries:
+        FAIL();
+    }
+  }
+  ASSERT_EQ(entry_count, 2u);
+  EXPECT_TRUE(Equal(entries[0], *entry));
+  EXPECT_TRUE(Equal(entries[1], *entry));
+  EXPECT_EQ(sequence_id, 99u);
+}
+
+TEST(DecompressLogEntries, ReferenceToLaterEntry_DataLoss) {
+  std::array<std::byte, 64> buffer;
+  LogEntries::MemoryEncoder encoder(buffer);
+  {
+    CompressedLogEntry::StreamEncoder entry =
+        encoder.GetCompressedEntriesEncoder();
+    entry.WriteReference(1).IgnoreError();
+    entry.WriteMessage(as_bytes(span(kTokenB))).IgnoreError();
+  }
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  std::array<std::byte, 64> output;
+  EXPECT_EQ(DecompressLogEntries(encoder, output).status(),
+            Status::DataLoss());
+}
+
+TEST(DecompressLogEntries, SharedBytesLongerThanMessage_DataLoss) {
+  std::array<std::byte, 64> buffer;
+  LogEntries::MemoryEncoder encoder(buffer);
+  {
+    CompressedLogEntry::StreamEncoder entry =
+        encoder.GetCompressedEntriesEncoder();
+    entry.WriteMessage(as_bytes(span(kTokenA))).IgnoreError();
+  }
+  {
+    CompressedLogEntry::StreamEncoder entry =
+        encoder.GetCompressedEntriesEncoder();
+    entry.WriteReference(1).IgnoreError();
+    entry.WriteSharedPrefix(3).IgnoreError();
+    entry.WriteSharedSuffix(2).IgnoreError();
+  }
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  std::array<std::byte, 64> output;
+  EXPECT_EQ(DecompressLogEntries(encoder, output).status(),
+            Status::DataLoss());
+}
+
+TEST(DecompressLogEntries, Malformed_DataLoss) {
+  constexpr auto kTruncated = bytes::Array<0x1a, 0x05, 0x22, 0x01>();
+  std::array<std::byte, 64> output;
+  EXPECT_EQ(DecompressLogEntries(kTruncated, output).status(),
+            Status::DataLoss());
+}
+
+TEST(DecompressLogEntries, BufferTooSmall_ResourceExhausted) {
+  std::array<std::byte, 64> entry_buffer;
+  Result<ConstByteSpan> entry = log::EncodeLog(
+      PW_LOG_LEVEL_WARN, 0, "", "", "", 12, 34, "Hello there", entry_buffer);
+  ASSERT_EQ(entry.status(), OkStatus());
+
+  LogCompressor compressor;
+  std::array<std::byte, 128> buffer;
+  LogEntries::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(compressor.Write(*entry, encoder), OkStatus());
+  ASSERT_EQ(compressor.Write(*entry, encoder), OkStatus());
+
+  std::array<std::byte, 30> output;
+  EXPECT_EQ(DecompressLogEntries(encoder, output).status(),
+            Status::ResourceExhausted());
+}
+
+}  // namespace
+}  // namespace pw::log_rpc
@@ -14,6 +14,8 @@
 
 #include "pw_log_rpc/log_filter.h"
 
+#include <algorithm>
+
 #include "pw_log/levels.h"
 #include "pw_protobuf/decoder.h"
 #include "pw_status/try.h"
@@ -51,9 +53,61 @@ bool IsRuleMet(const Filter::Rule& rule,
   return true;
 }
 
+// Log entry fields used by the rules, as bits of a mask.
+constexpr uint32_t kLevelField = 1 << 0;
+constexpr uint32_t kFlagsField = 1 << 1;
+constexpr uint32_t kModuleField = 1 << 2;
+constexpr uint32_t kThreadField = 1 << 3;
+constexpr uint32_t kAllFields =
+    kLevelField | kFlagsField | kModuleField | kThreadField;
+
 }  // namespace
 
 Status Filter::UpdateRulesFromProto(ConstByteSpan buffer) {
+  const Status status = DecodeRulesFromProto(buffer);
+  CompileRules();
+  return status;
+}
+
+void Filter::CompileRules() {
+  level_rules_ = {};
+  conditional_rules_ = 0;
+  flags_rules_ = 0;
+  module_rules_ = 0;
+  thread_rules_ = 0;
+  drop_rules_ = 0;
+  if (rules_.size() > kMaxCompiledRules) {
+    return;
+  }
+
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    const Rule& rule = rules_[i];
+    if (rule.action == Rule::Action::kInactive) {
+      continue;
+    }
+    const uint32_t rule_bit = uint32_t{1} << i;
+    for (size_t level = static_cast<size_t>(rule.level_greater_than_or_equal);
+         level < kLevelCount;
+         ++level) {
+      level_rules_[level] |= rule_bit;
+    }
+    if (rule.any_flags_set != 0) {
+      flags_rules_ |= rule_bit;
+    }
+    if (!rule.module_equals.empty()) {
+      module_rules_ |= rule_bit;
+    }
+    if (!rule.thread_equals.empty()) {
+      thread_rules_ |= rule_bit;
+    }
+    if (rule.action == Rule::Action::kDrop) {
+      drop_rules_ |= rule_bit;
+    }
+  }
+  conditional_rules_ = flags_rules_ | module_rules_ | thread_rules_;
+}
+
+Status Filter::DecodeRulesFromProto(ConstByteSpan buffer) {
   if (rules_.empty()) {
     return Status::FailedPrecondition();
   }
@@ -109,11 +163,15 @@ bool Filter::ShouldDropLog(ConstByteSpan entry) const {
   if (rules_.empty()) {
     return false;
   }
+  const bool compiled = rules_.size() <= kMaxCompiledRules;
 
   uint32_t log_level = 0;
   ConstByteSpan log_module;
   ConstByteSpan log_thread;
   uint32_t log_flags = 0;
+  // Stop decoding once the fields needed to decide the log are known.
+  uint32_t needed_fields = kAllFields;
+  uint32_t decoded_fields = 0;
   protobuf::Decoder decoder(entry);
   while (decoder.Next().ok()) {
     const auto field_num = static_cast<LogEntry::Fields>(decoder.FieldNumber());
@@ -122,18 +180,59 @@ bool Filter::ShouldDropLog(ConstByteSpan entry) const {
       if (decoder.ReadUint32(&log_level).ok()) {
         log_level &= PW_LOG_LEVEL_BITMASK;
       }
+      decoded_fields |= kLevelField;
+      if (compiled) {
+        // The log is decided by its level alone when the first rule met by
+        // level has no other conditions, or when no rule is met at all.
+        // Otherwise, only the rules before that one need other fields.
+        const uint32_t candidates = level_rules_[log_level];
+        const uint32_t decisive = candidates & ~conditional_rules_;
+        const uint32_t first_decisive = decisive & (~decisive + 1);
+        const uint32_t undecided =
+            candidates & conditional_rules_ & (first_decisive - 1);
+        if (undecided == 0) {
+          return (first_decisive & drop_rules_) != 0;
+        }
+        needed_fields = kLevelField;
+        needed_fields |= (undecided & flags_rules_) != 0 ? kFlagsField : 0;
+        needed_fields |= (undecided & module_rules_) != 0 ? kModuleField : 0;
+        needed_fields |= (undecided & thread_rules_) != 0 ? kThreadField : 0;
+      }
 
     } else if (field_num == LogEntry::Fields::kModule) {
       decoder.ReadBytes(&log_module).IgnoreError();
+      decoded_fields |= kModuleField;
 
     } else if (field_num == LogEntry::Fields::kFlags) {
       decoder.ReadUint32(&log_flags).IgnoreError();
+      decoded_fields |= kFlagsField;
 
     } else if (field_num == LogEntry::Fields::kThread) {
       decoder.ReadBytes(&log_thread).IgnoreError();
+      decoded_fields |= kThreadField;
+    }
+
+    if ((needed_fields & ~decoded_fields) == 0) {
+      break;
     }
   }
 
+  if (compiled) {
+    // Only check the rules met by level, in order.
+    uint32_t candidates = level_rules_[log_level];
+    for (size_t i = 0; candidates != 0; ++i, candidates >>= 1) {
+      if ((candidates & 1) == 0) {
+        continue;
+      }
+      const uint32_t rule_bit = uint32_t{1} << i;
+      if ((conditional_rules_ & rule_bit) == 0 ||
+          IsRuleMet(rules_[i], log_level, log_module, log_flags, log_thread)) {
+        return (drop_rules_ & rule_bit) != 0;
+      }
+    }
+    return false;
+  }
+
   // Follow the action of the first rule whose condition is met.
   for (const auto& rule : rules_) {
     if (rule.action == Filter::Rule::Action::kInactive) {
@@ -0,0 +1,206 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the cost of filtering logs: the time taken by Filter::ShouldDropLog
+// on its own, and the time taken by a set of filtered drains to flush a batch
+// of logs, which is the work done by RpcLogDrainThread on every wakeup.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_assert/check.h"
+#include "pw_bytes/span.h"
+#include "pw_log/levels.h"
+#include "pw_log/proto/log.raw_rpc.pb.h"
+#include "pw_log/proto_utils.h"
+#include "pw_log_rpc/log_filter.h"
+#include "pw_log_rpc/log_service.h"
+#include "pw_log_rpc/rpc_log_drain.h"
+#include "pw_log_rpc/rpc_log_drain_map.h"
+#include "pw_multisink/multisink.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/raw/server_reader_writer.h"
+#include "pw_rpc/server.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::log_rpc {
+namespace {
+
+constexpr size_t kDrainCount = 8;
+constexpr size_t kRulesPerFilter = 16;
+constexpr size_t kLogsPerFlush = 64;
+constexpr size_t kModuleCount = 8;
+constexpr std::array<std::string_view, kModuleCount> kModules = {
+    "NET", "BLE", "USB", "FS", "RPC", "PWR", "SNS", "UI"};
+constexpr std::array<int, 4> kLevels = {
+    PW_LOG_LEVEL_DEBUG, PW_LOG_LEVEL_INFO, PW_LOG_LEVEL_WARN, PW_LOG_LEVEL_ERROR};
+
+// Discards every packet, so only the drain's own work is measured.
+class NullChannelOutput : public rpc::ChannelOutput {
+ public:
+  NullChannelOutput() : rpc::ChannelOutput("NullChannelOutput") {}
+
+  Status Send(span<const std::byte>) override { return OkStatus(); }
+};
+
+// Populates a filter with rules typical of a device that keeps warnings and
+// errors, and keeps a few chatty modules at a lower level. The last rules drop
+// everything else.
+void PopulateRules(span<Filter::Rule> rules, size_t drain_index) {
+  using Level = log::pwpb::FilterRule::Level;
+  PW_CHECK_UINT_EQ(rules.size(), kRulesPerFilter);
+
+  rules[0].action = Filter::Rule::Action::kKeep;
+  rules[0].level_greater_than_or_equal = Level::ERROR_LEVEL;
+  for (size_t i = 1; i < kRulesPerFilter - 3; ++i) {
+    const std::string_view module =
+        kModules[(i + drain_index) % kModules.size()];
+    rules[i].action = (i % 3 == 0) ? Filter::Rule::Action::kDrop
+                                   : Filter::Rule::Action::kKeep;
+    rules[i].level_greater_than_or_equal =
+        (i % 2 == 0) ? Level::DEBUG_LEVEL : Level::INFO_LEVEL;
+    rules[i].any_flags_set = (i % 4 == 0) ? 0x1 : 0;
+    for (char c : module) {
+      rules[i].module_equals.push_back(static_cast<std::byte>(c));
+    }
+  }
+  rules[kRulesPerFilter - 3].action = Filter::Rule::Action::kKeep;
+  rules[kRulesPerFilter - 3].level_greater_than_or_equal = Level::WARN_LEVEL;
+  rules[kRulesPerFilter - 2].action = Filter::Rule::Action::kDrop;
+  rules[kRulesPerFilter - 2].any_flags_set = 0x2;
+  rules[kRulesPerFilter - 1].action = Filter::Rule::Action::kDrop;
+  rules[kRulesPerFilter - 1].level_greater_than_or_equal = Level::ANY_LEVEL;
+}
+
+// Encodes a log entry that varies in level, module and flags with its index.
+ConstByteSpan EncodeSampleLog(size_t index, ByteSpan buffer) {
+  const Result<ConstByteSpan> entry =
+      log::EncodeLog(kLevels[index % kLevels.size()],
+                     /*flags=*/index % 4,
+                     kModules[(index / kLevels.size()) % kModules.size()],
+                     /*thread_name=*/"worker",
+                     /*file_name=*/"pw_log_rpc/log_filter_perf_test.cc",
+                     /*line_number=*/static_cast<int>(index),
+                     /*ticks_since_epoch=*/static_cast<int64_t>(index),
+                     /*message=*/"Sample log message",
+                     buffer);
+  PW_CHECK_OK(entry.status());
+  return entry.value();
+}
+
+void ShouldDropLog(perf_test::State& state) {
+  static std::array<Filter::Rule, kRulesPerFilter> rules;
+  static std::array<std::array<std::byte, 128>, kLogsPerFlush> log_buffers;
+  static std::array<ConstByteSpan, kLogsPerFlush> logs;
+  PopulateRules(rules, 0);
+  Filter filter(as_bytes(span("filter")), rules);
+  for (size_t i = 0; i < kLogsPerFlush; ++i) {
+    logs[i] = EncodeSampleLog(i, log_buffers[i]);
+  }
+
+  size_t dropped = 0;
+  while (state.KeepRunning()) {
+    for (ConstByteSpan log : logs) {
+      dropped += filter.ShouldDropLog(log) ? 1 : 0;
+    }
+  }
+  PW_CHECK_UINT_NE(dropped, 0);
+}
+
+void FlushFilteredDrains(perf_test::State& state) {
+  static std::array<std::array<Filter::Rule, kRulesPerFilter>, kDrainCount>
+      rules;
+  static std::array<std::byte, 16 * 1024> multisink_buffer;
+  static std::array<std::array<std::byte, 128>, kLogsPerFlush> log_buffers;
+  static std::array<ConstByteSpan, kLogsPerFlush> logs;
+  static std::array<std::array<std::byte, 512>, kDrainCount> drain_buffers;
+  static std::array<std::byte, 512> encoding_buffer;
+
+  for (size_t i = 0; i < kDrainCount; ++i) {
+    PopulateRules(rules[i], i);
+  }
+  std::array<Filter, kDrainCount> filters = {
+      Filter(as_bytes(span("filter0")), rules[0]),
+      Filter(as_bytes(span("filter1")), rules[1]),
+      Filter(as_bytes(span("filter2")), rules[2]),
+      Filter(as_bytes(span("filter3")), rules[3]),
+      Filter(as_bytes(span("filter4")), rules[4]),
+      Filter(as_bytes(span("filter5")), rules[5]),
+      Filter(as_bytes(span("filter6")), rules[6]),
+      Filter(as_bytes(span("filter7")), rules[7]),
+  };
+
+  sync::Mutex mutex;
+  constexpr auto kErrorHandling =
+      RpcLogDrain::LogDrainErrorHandling::kIgnoreWriterErrors;
+  std::array<RpcLogDrain, kDrainCount> drains = {
+      RpcLogDrain(1, drain_buffers[0], mutex, kErrorHandling, &filters[0]),
+      RpcLogDrain(2, drain_buffers[1], mutex, kErrorHandling, &filters[1]),
+      RpcLogDrain(3, drain_buffers[2], mutex, kErrorHandling, &filters[2]),
+      RpcLogDrain(4, drain_buffers[3], mutex, kErrorHandling, &filters[3]),
+      RpcLogDrain(5, drain_buffers[4], mutex, kErrorHandling, &filters[4]),
+      RpcLogDrain(6, drain_buffers[5], mutex, kErrorHandling, &filters[5]),
+      RpcLogDrain(7, drain_buffers[6], mutex, kErrorHandling, &filters[6]),
+      RpcLogDrain(8, drain_buffers[7], mutex, kErrorHandling, &filters[7]),
+  };
+  RpcLogDrainMap drain_map(drains);
+  LogService log_service(drain_map);
+
+  NullChannelOutput output;
+  std::array<rpc::Channel, kDrainCount> channels = {
+      rpc::Channel::Create<1>(&output),
+      rpc::Channel::Create<2>(&output),
+      rpc::Channel::Create<3>(&output),
+      rpc::Channel::Create<4>(&output),
+      rpc::Channel::Create<5>(&output),
+      rpc::Channel::Create<6>(&output),
+      rpc::Channel::Create<7>(&output),
+      rpc::Channel::Create<8>(&output),
+  };
+  rpc::Server server(channels);
+
+  multisink::MultiSink multisink(multisink_buffer);
+  std::array<rpc::RawServerWriter, kDrainCount> writers;
+  for (size_t i = 0; i < kDrainCount; ++i) {
+    multisink.AttachDrain(drains[i]);
+    writers[i] = rpc::RawServerWriter::Open<log::pw_rpc::raw::Logs::Listen>(
+        server, drains[i].channel_id(), log_service);
+    PW_CHECK_OK(drains[i].Open(writers[i]));
+  }
+  for (size_t i = 0; i < kLogsPerFlush; ++i) {
+    logs[i] = EncodeSampleLog(i, log_buffers[i]);
+  }
+
+  while (state.KeepRunning()) {
+    for (ConstByteSpan log : logs) {
+      multisink.HandleEntry(log);
+    }
+    for (RpcLogDrain& drain : drains) {
+      PW_CHECK_OK(drain.Flush(encoding_buffer));
+    }
+  }
+
+  for (RpcLogDrain& drain : drains) {
+    PW_CHECK_OK(drain.Close());
+    multisink.DetachDrain(drain);
+  }
+}
+
+PW_PERF_TEST(ShouldDropLog64Logs16Rules, ShouldDropLog);
+PW_PERF_TEST(Flush64Logs8Drains16Rules, FlushFilteredDrains);
+
+}  // namespace
+}  // namespace pw::log_rpc
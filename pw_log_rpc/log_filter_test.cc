@@ -718,5 +718,111 @@ TEST(FilterTest, UpdateFilterWithLargeThreadNameFails) {
   EXPECT_EQ(filter.UpdateRulesFromProto(ConstByteSpan(encoder)),
             Status::InvalidArgument());
 }
+
+TEST(FilterTest, FilterLogsConditionalRuleBeforeLevelRule) {
+  constexpr uint32_t kOtherModule = 0x5678;
+  std::array<Filter::Rule, 2> rules{{
+      {
+          .action = Filter::Rule::Action::kDrop,
+          .level_greater_than_or_equal = FilterRule::Level::INFO_LEVEL,
+          .module_equals = {kSampleModuleLittleEndian.begin(),
+                            kSampleModuleLittleEndian.end()},
+      },
+      {
+          .action = Filter::Rule::Action::kKeep,
+          .level_greater_than_or_equal = FilterRule::Level::DEBUG_LEVEL,
+      },
+  }};
+  const std::array<std::byte, cfg::kMaxFilterIdBytes> filter_id{
+      std::byte(0xfe), std::byte(0xed), std::byte(0xba), std::byte(0xb1)};
+  const Filter filter(filter_id, rules);
+
+  std::array<std::byte, 50> buffer;
+  Result<ConstByteSpan> log_entry =
+      EncodeLogEntry<PW_LOG_LEVEL_INFO, kSampleModule, kSampleFlags>(
+          kSampleMessage, buffer, kSampleThread);
+  ASSERT_EQ(log_entry.status(), OkStatus());
+  EXPECT_TRUE(filter.ShouldDropLog(log_entry.value()));
+
+  log_entry = EncodeLogEntry<PW_LOG_LEVEL_INFO, kOtherModule, kSampleFlags>(
+      kSampleMessage, buffer, kSampleThread);
+  ASSERT_EQ(log_entry.status(), OkStatus());
+  EXPECT_FALSE(filter.ShouldDropLog(log_entry.value()));
+
+  // The module rule does not apply to debug logs.
+  log_entry = EncodeLogEntry<PW_LOG_LEVEL_DEBUG, kSampleModule, kSampleFlags>(
+      kSampleMessage, buffer, kSampleThread);
+  ASSERT_EQ(log_entry.status(), OkStatus());
+  EXPECT_FALSE(filter.ShouldDropLog(log_entry.value()));
+}
+
+TEST(FilterTest, FilterLogsAfterRulesChange) {
+  std::array<Filter::Rule, 1> rules{{
+      {
+          .action = Filter::Rule::Action::kKeep,
+          .level_greater_than_or_equal = FilterRule::Level::DEBUG_LEVEL,
+      },
+  }};
+  const std::array<std::byte, cfg::kMaxFilterIdBytes> filter_id{
+      std::byte(0xfe), std::byte(0xed), std::byte(0xba), std::byte(0xb1)};
+  Filter filter(filter_id, rules);
+
+  std::array<std::byte, 50> buffer;
+  const Result<ConstByteSpan> log_entry =
+      EncodeLogEntry<PW_LOG_LEVEL_WARN, kSampleModule, kSampleFlags>(
+          kSampleMessage, buffer, kSampleThread);
+  ASSERT_EQ(log_entry.status(), OkStatus());
+  EXPECT_FALSE(filter.ShouldDropLog(log_entry.value()));
+
+  // Rules updated from a proto are recompiled.
+  std::array<Filter::Rule, 1> drop_rules{{
+      {
+          .action = Filter::Rule::Action::kDrop,
+          .level_greater_than_or_equal = FilterRule::Level::WARN_LEVEL,
+      },
+  }};
+  const Filter drop_filter(filter_id, drop_rules);
+  std::byte proto_buffer[256];
+  const Result<ConstByteSpan> proto = EncodeFilter(drop_filter, proto_buffer);
+  ASSERT_EQ(proto.status(), OkStatus());
+  ASSERT_EQ(filter.UpdateRulesFromProto(proto.value()), OkStatus());
+  EXPECT_TRUE(filter.ShouldDropLog(log_entry.value()));
+
+  // Rules modified directly take effect once recompiled.
+  rules[0].action = Filter::Rule::Action::kKeep;
+  filter.CompileRules();
+  EXPECT_FALSE(filter.ShouldDropLog(log_entry.value()));
+
+  rules[0].action = Filter::Rule::Action::kDrop;
+  rules[0].level_greater_than_or_equal = FilterRule::Level::ERROR_LEVEL;
+  filter.CompileRules();
+  EXPECT_FALSE(filter.ShouldDropLog(log_entry.value()));
+
+  rules[0].level_greater_than_or_equal = FilterRule::Level::ANY_LEVEL;
+  rules[0].thread_equals.assign(kSampleThread.begin(), kSampleThread.end());
+  filter.CompileRules();
+  EXPECT_TRUE(filter.ShouldDropLog(log_entry.value()));
+
+  rules[0].thread_equals.assign({std::byte('x')});
+  filter.CompileRules();
+  EXPECT_FALSE(filter.ShouldDropLog(log_entry.value()));
+}
+
+TEST(FilterTest, FilterLogsWithMoreRulesThanCompiled) {
+  std::array<Filter::Rule, Filter::kMaxCompiledRules + 1> rules{};
+  rules.back().action = Filter::Rule::Action::kDrop;
+  rules.back().module_equals.assign(kSampleModuleLittleEndian.begin(),
+                                    kSampleModuleLittleEndian.end());
+  const std::array<std::byte, cfg::kMaxFilterIdBytes> filter_id{
+      std::byte(0xfe), std::byte(0xed), std::byte(0xba), std::byte(0xb1)};
+  const Filter filter(filter_id, rules);
+
+  std::array<std::byte, 50> buffer;
+  const Result<ConstByteSpan> log_entry =
+      EncodeLogEntry<PW_LOG_LEVEL_INFO, kSampleModule, kSampleFlags>(
+          kSampleMessage, buffer, kSampleThread);
+  ASSERT_EQ(log_entry.status(), OkStatus());
+  EXPECT_TRUE(filter.ShouldDropLog(log_entry.value()));
+}
 }  // namespace
 }  // namespace pw::log_rpc
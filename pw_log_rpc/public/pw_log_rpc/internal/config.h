@@ -41,6 +41,27 @@
 #define PW_LOG_RPC_CONFIG_MAX_FILTER_ID_SIZE 4
 #endif  // PW_LOG_RPC_CONFIG_MAX_FILTER_ID_SIZE
 
+// The maximum number of log entries a drain peeks from the MultiSink at once.
+// Each entry takes a span on the stack of the flushing thread. The number of
+// entries is also limited by the size of the drain's log entry buffer.
+#ifndef PW_LOG_RPC_CONFIG_MAX_ENTRIES_PER_PEEK
+#define PW_LOG_RPC_CONFIG_MAX_ENTRIES_PER_PEEK 8
+#endif  // PW_LOG_RPC_CONFIG_MAX_ENTRIES_PER_PEEK
+
+// The number of log statements a LogCompressor remembers while compressing a
+// LogEntries message. Entries are only compressed against the last entry from
+// the same statement. Must be a power of 2.
+#ifndef PW_LOG_RPC_CONFIG_COMPRESSOR_SLOTS
+#define PW_LOG_RPC_CONFIG_COMPRESSOR_SLOTS 8
+#endif  // PW_LOG_RPC_CONFIG_COMPRESSOR_SLOTS
+
+// The number of bytes of the message, module, and file a LogCompressor keeps
+// for each log statement, and of the last thread name. Fields beyond this size
+// are sent in full with every entry.
+#ifndef PW_LOG_RPC_CONFIG_COMPRESSOR_SLOT_SIZE
+#define PW_LOG_RPC_CONFIG_COMPRESSOR_SLOT_SIZE 32
+#endif  // PW_LOG_RPC_CONFIG_COMPRESSOR_SLOT_SIZE
+
 // The log level to use for this module. Logs below this level are omitted.
 #ifndef PW_LOG_RPC_CONFIG_LOG_LEVEL
 #define PW_LOG_RPC_CONFIG_LOG_LEVEL PW_LOG_LEVEL_INFO
@@ -91,4 +112,12 @@ inline constexpr size_t kMaxFilterIdBytes =
 
 inline constexpr size_t kMaxThreadNameBytes =
     PW_LOG_RPC_CONFIG_MAX_FILTER_RULE_THREAD_NAME_SIZE;
+
+inline constexpr size_t kMaxEntriesPerPeek =
+    PW_LOG_RPC_CONFIG_MAX_ENTRIES_PER_PEEK;
+
+inline constexpr size_t kCompressorSlots = PW_LOG_RPC_CONFIG_COMPRESSOR_SLOTS;
+
+inline constexpr size_t kCompressorSlotSize =
+    PW_LOG_RPC_CONFIG_COMPRESSOR_SLOT_SIZE;
 }  // namespace pw::log_rpc::cfg
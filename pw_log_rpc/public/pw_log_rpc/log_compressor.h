@@ -0,0 +1,129 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_log/proto/log.pwpb.h"
+#include "pw_log_rpc/internal/config.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+
+namespace pw::log_rpc {
+
+// Writes log::pwpb::LogEntry messages to a log::pwpb::LogEntries message as
+// compressed entries, which refer to the entries before them. Timestamps are
+// sent as deltas, and an entry from a log statement seen earlier in the
+// message only sends the parts of its message and fields that changed.
+//
+// Earlier entries are found with a small dictionary of recent log statements,
+// keyed by the first four bytes of the message, which is the token for
+// tokenized logs. Only the first PW_LOG_RPC_CONFIG_COMPRESSOR_SLOT_SIZE bytes
+// of each statement's fields are kept, so longer fields compress less.
+//
+// Each LogEntries message is compressed on its own, so Reset() must be called
+// before writing entries to a new message. Use DecompressLogEntries() to get
+// the original entries back.
+class LogCompressor {
+ public:
+  constexpr LogCompressor() = default;
+
+  // Not copyable.
+  LogCompressor(const LogCompressor&) = delete;
+  LogCompressor& operator=(const LogCompressor&) = delete;
+
+  // Forgets the entries written so far, to start a new LogEntries message.
+  void Reset();
+
+  // Writes an encoded LogEntry to the compressed_entries field of a
+  // LogEntries message. Leaves at least reserved_size bytes free in the
+  // encoder, for fields written after the entries.
+  //
+  // Entries that do not compress, or that use fields the compressed format
+  // does not have, are written unchanged in a CompressedLogEntry.
+  //
+  // Return values:
+  // OK - The entry was written.
+  // RESOURCE_EXHAUSTED - The entry does not fit. Nothing was written.
+  Status Write(ConstByteSpan entry,
+               log::pwpb::LogEntries::MemoryEncoder& encoder,
+               size_t reserved_size = 0);
+
+ private:
+  static constexpr size_t kSlotCount = cfg::kCompressorSlots;
+  static constexpr size_t kSlotSize = cfg::kCompressorSlotSize;
+  static constexpr uint8_t kNotStored = 0xff;
+
+  static_assert((kSlotCount & (kSlotCount - 1)) == 0,
+                "PW_LOG_RPC_CONFIG_COMPRESSOR_SLOTS must be a power of 2");
+  static_assert(kSlotSize < kNotStored,
+                "PW_LOG_RPC_CONFIG_COMPRESSOR_SLOT_SIZE must be less than 255");
+
+  // The fields of the last entry written for a log statement.
+  struct Slot {
+    // The first four bytes of the message.
+    uint32_t key = 0;
+    // One more than the entry's index in the LogEntries message; 0 if unused.
+    uint16_t reference = 0;
+    // The number of bytes of each field in data, or kNotStored for fields that
+    // did not fit. If the message did not fit, its first bytes are stored.
+    uint8_t message_size = 0;
+    bool message_complete = false;
+    uint8_t module_size = kNotStored;
+    uint8_t file_size = kNotStored;
+    uint32_t line_level = 0;
+    uint32_t flags = 0;
+    // The message, module, and file, in that order.
+    std::array<std::byte, kSlotSize> data{};
+  };
+
+  Status WriteUncompressed(ConstByteSpan entry,
+                           log::pwpb::LogEntries::MemoryEncoder& encoder,
+                           size_t reserved_size);
+
+  // Stores an entry's fields as the latest entry for its log statement.
+  void Remember(Slot& slot,
+                uint32_t key,
+                ConstByteSpan message,
+                uint32_t line_level,
+                uint32_t flags,
+                ConstByteSpan module,
+                ConstByteSpan file);
+
+  bool IsLastThread(ConstByteSpan thread) const;
+  void SetLastThread(ConstByteSpan thread);
+
+  std::array<Slot, kSlotCount> slots_{};
+  uint32_t entry_count_ = 0;
+  int64_t last_timestamp_ = 0;
+  // The last thread, or kNotStored if it was too long to store.
+  uint8_t last_thread_size_ = 0;
+  std::array<std::byte, kSlotSize> last_thread_{};
+};
+
+// Expands the compressed entries in an encoded LogEntries message, and writes
+// the message with only regular entries to buffer. Messages without compressed
+// entries are copied as is.
+//
+// Return values:
+// OK - Returns the encoded LogEntries message.
+// DATA_LOSS - The message or a compressed entry is malformed.
+// RESOURCE_EXHAUSTED - The buffer is too small.
+Result<ConstByteSpan> DecompressLogEntries(ConstByteSpan log_entries,
+                                           ByteSpan buffer);
+
+}  // namespace pw::log_rpc
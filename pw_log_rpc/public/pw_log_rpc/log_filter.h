@@ -14,12 +14,15 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 
 #include "pw_assert/assert.h"
 #include "pw_bytes/span.h"
 #include "pw_containers/vector.h"
+#include "pw_log/levels.h"
 #include "pw_log/proto/log.pwpb.h"
 #include "pw_log_rpc/internal/config.h"
 #include "pw_span/span.h"
@@ -29,8 +32,17 @@ namespace pw::log_rpc {
 
 // A Filter is a collection of rules used to check if a log entry can be kept
 // or dropped wherever the filter is placed in the log path.
+//
+// The rules are compiled into a table indexed by log level, so most log
+// entries are decided from their level alone, without decoding the rest of the
+// entry or evaluating every rule. The table is rebuilt when the rules are
+// updated through the filter; call CompileRules() after modifying them
+// directly.
 class Filter {
  public:
+  // Filters with more rules than this evaluate them one by one.
+  static constexpr size_t kMaxCompiledRules = 32;
+
   struct Rule {
     // Action to perform if the rule is met.
     enum class Action {
@@ -58,6 +70,7 @@ class Filter {
   Filter(span<const std::byte> id, span<Rule> rules) : rules_(rules) {
     PW_ASSERT(!id.empty());
     id_.assign(id.begin(), id.end());
+    CompileRules();
   }
 
   // Not copyable.
@@ -83,9 +96,31 @@ class Filter {
   // Forwarded errors from protobuff::decoder.
   Status UpdateRulesFromProto(ConstByteSpan buffer);
 
+  // Rebuilds the compiled form of the rules. Must be called after modifying
+  // the rules given to the constructor directly, before the filter is used
+  // again.
+  void CompileRules();
+
  private:
+  static constexpr size_t kLevelCount = PW_LOG_LEVEL_BITMASK + 1;
+
+  Status DecodeRulesFromProto(ConstByteSpan buffer);
+
   Vector<std::byte, cfg::kMaxFilterIdBytes> id_;
   span<Rule> rules_;
+
+  // Bitmasks of rules, where bit i corresponds to rules_[i]. They are only
+  // valid when rules_ has at most kMaxCompiledRules rules.
+  //
+  // The active rules whose level condition is met, for each log level.
+  std::array<uint32_t, kLevelCount> level_rules_{};
+  // Rules with a flags, module, or thread condition, and each of those.
+  uint32_t conditional_rules_ = 0;
+  uint32_t flags_rules_ = 0;
+  uint32_t module_rules_ = 0;
+  uint32_t thread_rules_ = 0;
+  // Rules with the kDrop action.
+  uint32_t drop_rules_ = 0;
 };
 
 }  // namespace pw::log_rpc
@@ -18,6 +18,7 @@
 #include <array>
 #include <cstdint>
 #include <limits>
+#include <mutex>
 #include <optional>
 #include <string_view>
 
@@ -27,6 +28,7 @@
 #include "pw_function/function.h"
 #include "pw_log/proto/log.pwpb.h"
 #include "pw_log_rpc/internal/config.h"
+#include "pw_log_rpc/log_compressor.h"
 #include "pw_log_rpc/log_filter.h"
 #include "pw_multisink/multisink.h"
 #include "pw_protobuf/serialized_size.h"
@@ -131,6 +133,7 @@ class RpcLogDrain : public multisink::MultiSink::Drain {
         drop_count_writer_error_(0),
         mutex_(mutex),
         filter_(filter),
+        compressor_(nullptr),
         sequence_id_(0),
         max_bundles_per_trickle_(max_bundles_per_trickle),
         trickle_delay_(trickle_delay),
@@ -194,6 +197,17 @@ class RpcLogDrain : public multisink::MultiSink::Drain {
     trickle_delay_ = trickle_delay;
   }
 
+  // Sends entries as compressed_entries, compressed with the provided
+  // compressor, or as regular entries if the compressor is null. Compression
+  // shrinks tokenized logs from repeated log statements by about half, but log
+  // listeners must expand the entries, for example with
+  // DecompressLogEntries(). The compressor must not be shared with other
+  // drains.
+  void set_compressor(LogCompressor* compressor) PW_LOCKS_EXCLUDED(mutex_) {
+    std::lock_guard lock(mutex_);
+    compressor_ = compressor;
+  }
+
   // Stores a function that is called when Open() is successful. Pass nulltpr to
   // clear it. This is useful in cases where the owner of the drain needs to be
   // notified that the drain was opened.
@@ -216,6 +230,14 @@ class RpcLogDrain : public multisink::MultiSink::Drain {
       log::pwpb::LogEntries::MemoryEncoder& encoder,
       uint32_t& packed_entry_count_out) PW_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Returns true if any log drops are waiting to be reported.
+  bool HasDropsToReport() const PW_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Adds a drop message for each drop count that is not zero. Overwrites the
+  // log_entry_buffer_.
+  void EncodeDropMessages(log::pwpb::LogEntries::MemoryEncoder& encoder)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   const uint32_t channel_id_;
   const LogDrainErrorHandling error_handling_;
   rpc::RawServerWriter server_writer_ PW_GUARDED_BY(mutex_);
@@ -227,6 +249,7 @@ class RpcLogDrain : public multisink::MultiSink::Drain {
   uint32_t drop_count_writer_error_ PW_GUARDED_BY(mutex_);
   sync::Mutex& mutex_;
   Filter* filter_;
+  LogCompressor* compressor_ PW_GUARDED_BY(mutex_);
   uint32_t sequence_id_;
   size_t max_bundles_per_trickle_;
   pw::chrono::SystemClock::duration trickle_delay_;
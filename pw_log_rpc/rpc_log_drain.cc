@@ -14,6 +14,8 @@
 
 #include "pw_log_rpc/rpc_log_drain.h"
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <mutex>
 #include <optional>
@@ -22,6 +24,8 @@
 #include "pw_assert/check.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_log/proto/log.pwpb.h"
+#include "pw_log_rpc/log_compressor.h"
+#include "pw_protobuf/serialized_size.h"
 #include "pw_result/result.h"
 #include "pw_rpc/raw/server_reader_writer.h"
 #include "pw_span/span.h"
@@ -31,12 +35,17 @@
 namespace pw::log_rpc {
 namespace {
 
+// Space to leave for the sequence ID when adding compressed entries.
+constexpr size_t kSequenceIdSize = protobuf::SizeOfFieldUint32(
+    log::pwpb::LogEntries::Fields::kFirstEntrySequenceId);
+
 // Creates an encoded drop message on the provided buffer and adds it to the
 // bulk log entries. Resets the drop count when successfull.
 void TryEncodeDropMessage(
     ByteSpan encoded_drop_message_buffer,
     std::string_view reason,
     uint32_t& drop_count,
+    LogCompressor* compressor,
     log::pwpb::LogEntries::MemoryEncoder& entries_encoder) {
   // Encode drop count and reason, if any, in log proto.
   log::pwpb::LogEntry::MemoryEncoder encoder(encoded_drop_message_buffer);
@@ -49,6 +58,13 @@ void TryEncodeDropMessage(
   }
   // Add encoded drop messsage if fits in buffer.
   ConstByteSpan drop_message(encoder);
+  if (compressor != nullptr) {
+    if (compressor->Write(drop_message, entries_encoder, kSequenceIdSize)
+            .ok()) {
+      drop_count = 0;
+    }
+    return;
+  }
   if (drop_message.size() + RpcLogDrain::kLogEntriesEncodeFrameSize <
       entries_encoder.ConservativeWriteLimit()) {
     PW_CHECK_OK(entries_encoder.WriteBytes(
@@ -125,6 +141,9 @@ RpcLogDrain::LogDrainState RpcLogDrain::SendLogs(size_t max_num_bundles,
       return LogDrainState::kCaughtUp;
     }
     log::pwpb::LogEntries::MemoryEncoder encoder(encoding_buffer);
+    if (compressor_ != nullptr) {
+      compressor_->Reset();
+    }
     uint32_t packed_entry_count = 0;
     log_sink_state = EncodeOutgoingPacket(encoder, packed_entry_count);
 
@@ -155,115 +174,156 @@ RpcLogDrain::LogDrainState RpcLogDrain::EncodeOutgoingPacket(
     log::pwpb::LogEntries::MemoryEncoder& encoder,
     uint32_t& packed_entry_count_out) {
   const size_t total_buffer_size = encoder.ConservativeWriteLimit();
+  std::array<ConstByteSpan, cfg::kMaxEntriesPerPeek> peeked_entries;
+  // The drops reported by earlier peeks at the same front entry, which were
+  // already added to the drop counts. Peeking again reports them again, though
+  // possibly as slow drain drops instead of ingress drops.
+  uint32_t counted_drop_count = 0;
+  // Whether drop messages were encoded ahead of the front entry.
+  bool drops_reported = false;
   do {
-    // Peek entry and get drop count from multisink.
+    // Peek a run of entries and get drop count from multisink.
     uint32_t drop_count = 0;
     uint32_t ingress_drop_count = 0;
-    Result<multisink::MultiSink::Drain::PeekedEntry> possible_entry =
-        PeekEntry(log_entry_buffer_, drop_count, ingress_drop_count);
-    drop_count_ingress_error_ += ingress_drop_count;
+    Result<multisink::MultiSink::Drain::PeekedEntries> possible_entries =
+        PeekEntries(log_entry_buffer_,
+                    peeked_entries,
+                    drop_count,
+                    ingress_drop_count);
 
-    // Check if the entry fits in the entry buffer.
-    if (possible_entry.status().IsResourceExhausted()) {
+    // Check if the front entry fits in the entry buffer.
+    if (possible_entries.status().IsResourceExhausted()) {
       ++drop_count_small_stack_buffer_;
       continue;
     }
 
+    // Stash multisink's reported drop counts that will be reported later with
+    // any other drop counts.
+    const uint32_t new_drop_count =
+        drop_count + ingress_drop_count - counted_drop_count;
+    const uint32_t new_ingress_drop_count =
+        std::min(ingress_drop_count, new_drop_count);
+    drop_count_ingress_error_ += new_ingress_drop_count;
+    drop_count_slow_drain_ += new_drop_count - new_ingress_drop_count;
+    counted_drop_count += new_drop_count;
+
     // Check if there are any entries left.
-    if (possible_entry.status().IsOutOfRange()) {
-      // Stash multisink's reported drop count that will be reported later with
-      // any other drop counts.
-      drop_count_slow_drain_ += drop_count;
+    if (possible_entries.status().IsOutOfRange()) {
       return LogDrainState::kCaughtUp;  // There are no more entries.
     }
 
     // At this point all expected errors have been handled.
-    PW_CHECK_OK(possible_entry.status());
-
-    // Check if the entry passes any set filter rules.
-    if (filter_ != nullptr &&
-        filter_->ShouldDropLog(possible_entry.value().entry())) {
-      // Add the drop count from the multisink peek, stored in `drop_count`, to
-      // the total drop count. Then drop the entry without counting it towards
-      // the total drop count. Drops will be reported later all together.
-      drop_count_slow_drain_ += drop_count;
-      PW_CHECK_OK(PopEntry(possible_entry.value()));
-      continue;
-    }
+    PW_CHECK_OK(possible_entries.status());
+    const multisink::MultiSink::Drain::PeekedEntries& entries =
+        possible_entries.value();
 
-    // Check if the entry fits in the encoder buffer by itself.
-    const size_t encoded_entry_size =
-        possible_entry.value().entry().size() + kLogEntriesEncodeFrameSize;
-    if (encoded_entry_size + kLogEntriesEncodeFrameSize > total_buffer_size) {
-      // Entry is larger than the entire available buffer.
-      ++drop_count_small_outbound_buffer_;
-      PW_CHECK_OK(PopEntry(possible_entry.value()));
-      continue;
-    }
+    size_t handled_count = 0;
+    for (; handled_count < entries.size(); ++handled_count) {
+      const ConstByteSpan entry = entries.entries()[handled_count];
 
-    // At this point, we have a valid entry that may fit in the encode buffer.
-    // Report any drop counts combined reusing the log_entry_buffer_ to encode a
-    // drop message.
-    drop_count_slow_drain_ += drop_count;
-    // Account for dropped entries too large for stack buffer, which PeekEntry()
-    // also reports.
-    drop_count_slow_drain_ -= drop_count_small_stack_buffer_;
-    bool log_entry_buffer_has_valid_entry = possible_entry.ok();
-    if (drop_count_slow_drain_ > 0) {
-      TryEncodeDropMessage(log_entry_buffer_,
-                           std::string_view(kSlowDrainErrorMessage),
-                           drop_count_slow_drain_,
-                           encoder);
-      log_entry_buffer_has_valid_entry = false;
-    }
-    if (drop_count_ingress_error_ > 0) {
-      TryEncodeDropMessage(log_entry_buffer_,
-                           std::string_view(kIngressErrorMessage),
-                           drop_count_ingress_error_,
-                           encoder);
-      log_entry_buffer_has_valid_entry = false;
-    }
-    if (drop_count_small_stack_buffer_ > 0) {
-      TryEncodeDropMessage(log_entry_buffer_,
-                           std::string_view(kSmallStackBufferErrorMessage),
-                           drop_count_small_stack_buffer_,
-                           encoder);
-      log_entry_buffer_has_valid_entry = false;
-    }
-    if (drop_count_small_outbound_buffer_ > 0) {
-      TryEncodeDropMessage(log_entry_buffer_,
-                           std::string_view(kSmallOutboundBufferErrorMessage),
-                           drop_count_small_outbound_buffer_,
-                           encoder);
-      log_entry_buffer_has_valid_entry = false;
-    }
-    if (drop_count_writer_error_ > 0) {
-      TryEncodeDropMessage(log_entry_buffer_,
-                           std::string_view(kWriterErrorMessage),
-                           drop_count_writer_error_,
-                           encoder);
-      log_entry_buffer_has_valid_entry = false;
-    }
-    if (possible_entry.ok() && !log_entry_buffer_has_valid_entry) {
-      PW_CHECK_OK(PeekEntry(log_entry_buffer_, drop_count, ingress_drop_count)
-                      .status());
-    }
+      // Check if the entry passes any set filter rules. Drop the entry without
+      // counting it towards the total drop count.
+      if (filter_ != nullptr && filter_->ShouldDropLog(entry)) {
+        continue;
+      }
+
+      // Check if the entry fits in the encoder buffer by itself.
+      const size_t encoded_entry_size =
+          entry.size() + kLogEntriesEncodeFrameSize;
+      if (encoded_entry_size + kLogEntriesEncodeFrameSize > total_buffer_size) {
+        // Entry is larger than the entire available buffer.
+        ++drop_count_small_outbound_buffer_;
+        continue;
+      }
 
-    // Check if the entry fits in the partially filled encoder buffer.
-    if (encoded_entry_size > encoder.ConservativeWriteLimit()) {
-      // Notify the caller there are more entries to send.
-      return LogDrainState::kMoreEntriesRemaining;
+      // At this point, we have a valid entry that may fit in the encode buffer.
+      // Report any drop counts combined first. The drop messages are encoded
+      // reusing the log_entry_buffer_, which holds the peeked entries, so stop
+      // after the handled entries and peek again once they are reported.
+      if (!drops_reported && HasDropsToReport()) {
+        if (handled_count == 0) {
+          EncodeDropMessages(encoder);
+          drops_reported = true;
+        }
+        break;
+      }
+
+      // Encode the entry if it fits in the partially filled encoder buffer.
+      // Otherwise, notify the caller there are more entries to send.
+      if (compressor_ != nullptr) {
+        if (!compressor_->Write(entry, encoder, kSequenceIdSize).ok()) {
+          PW_CHECK_OK(PopEntries(entries.first(handled_count)));
+          return LogDrainState::kMoreEntriesRemaining;
+        }
+      } else {
+        if (encoded_entry_size > encoder.ConservativeWriteLimit()) {
+          PW_CHECK_OK(PopEntries(entries.first(handled_count)));
+          return LogDrainState::kMoreEntriesRemaining;
+        }
+        PW_CHECK_OK(encoder.WriteBytes(
+            static_cast<uint32_t>(log::pwpb::LogEntries::Fields::kEntries),
+            entry));
+      }
+      ++packed_entry_count_out;
     }
 
-    // Encode the entry and remove it from multisink.
-    PW_CHECK_OK(encoder.WriteBytes(
-        static_cast<uint32_t>(log::pwpb::LogEntries::Fields::kEntries),
-        possible_entry.value().entry()));
-    PW_CHECK_OK(PopEntry(possible_entry.value()));
-    ++packed_entry_count_out;
+    // Remove the encoded and dropped entries from multisink.
+    if (handled_count > 0) {
+      PW_CHECK_OK(PopEntries(entries.first(handled_count)));
+      counted_drop_count = 0;
+      drops_reported = false;
+    }
   } while (true);
 }
 
+bool RpcLogDrain::HasDropsToReport() const {
+  return drop_count_slow_drain_ > 0 || drop_count_ingress_error_ > 0 ||
+         drop_count_small_stack_buffer_ > 0 ||
+         drop_count_small_outbound_buffer_ > 0 || drop_count_writer_error_ > 0;
+}
+
+void RpcLogDrain::EncodeDropMessages(
+    log::pwpb::LogEntries::MemoryEncoder& encoder) {
+  // Account for dropped entries too large for stack buffer, which
+  // PeekEntries() also reports.
+  drop_count_slow_drain_ -= drop_count_small_stack_buffer_;
+  if (drop_count_slow_drain_ > 0) {
+    TryEncodeDropMessage(log_entry_buffer_,
+                         std::string_view(kSlowDrainErrorMessage),
+                         drop_count_slow_drain_,
+                         compressor_,
+                         encoder);
+  }
+  if (drop_count_ingress_error_ > 0) {
+    TryEncodeDropMessage(log_entry_buffer_,
+                         std::string_view(kIngressErrorMessage),
+                         drop_count_ingress_error_,
+                         compressor_,
+                         encoder);
+  }
+  if (drop_count_small_stack_buffer_ > 0) {
+    TryEncodeDropMessage(log_entry_buffer_,
+                         std::string_view(kSmallStackBufferErrorMessage),
+                         drop_count_small_stack_buffer_,
+                         compressor_,
+                         encoder);
+  }
+  if (drop_count_small_outbound_buffer_ > 0) {
+    TryEncodeDropMessage(log_entry_buffer_,
+                         std::string_view(kSmallOutboundBufferErrorMessage),
+                         drop_count_small_outbound_buffer_,
+                         compressor_,
+                         encoder);
+  }
+  if (drop_count_writer_error_ > 0) {
+    TryEncodeDropMessage(log_entry_buffer_,
+                         std::string_view(kWriterErrorMessage),
+                         drop_count_writer_error_,
+                         compressor_,
+                         encoder);
+  }
+}
+
 Status RpcLogDrain::Close() {
   std::lock_guard lock(mutex_);
   return server_writer_.Finish();
@@ -22,6 +22,7 @@
 #include "pw_bytes/span.h"
 #include "pw_log/proto/log.pwpb.h"
 #include "pw_log/proto_utils.h"
+#include "pw_log_rpc/log_compressor.h"
 #include "pw_log_rpc/log_filter.h"
 #include "pw_log_rpc/log_service.h"
 #include "pw_log_rpc/rpc_log_drain_map.h"
@@ -356,6 +357,44 @@ TEST_F(TrickleTest, ManyLogsOverflowToNextPayload) {
   EXPECT_EQ(entries_count, 3u);
 }
 
+TEST_F(TrickleTest, CompressedEntriesAreFlushedToSinglePayload) {
+  LogCompressor compressor;
+  drains_[0].set_compressor(&compressor);
+  AttachDrain();
+  OpenWriter();
+
+  Vector<TestLogEntry, 3> kExpectedEntries{
+      BasicLog("Temperature: 20"),
+      BasicLog("Temperature: 21"),
+      BasicLog("Temperature: 19")};
+  AddLogEntries(kExpectedEntries);
+
+  ASSERT_TRUE(writer_.active());
+  EXPECT_EQ(drains_[0].Open(writer_), OkStatus());
+
+  std::optional<chrono::SystemClock::duration> min_delay =
+      drains_[0].Trickle(channel_encode_buffer_);
+  EXPECT_EQ(min_delay.has_value(), false);
+
+  rpc::PayloadsView payloads =
+      output_.payloads<log::pw_rpc::raw::Logs::Listen>(kDrainChannelId);
+  ASSERT_EQ(payloads.size(), 1u);
+
+  std::array<std::byte, kChannelEncodeBufferSize * 2> decompressed_buffer;
+  Result<ConstByteSpan> decompressed =
+      DecompressLogEntries(payloads[0], decompressed_buffer);
+  ASSERT_EQ(decompressed.status(), OkStatus());
+  EXPECT_LT(payloads[0].size(), decompressed->size());
+
+  uint32_t drop_count = 0;
+  size_t entries_count = 0;
+  protobuf::Decoder payload_decoder(*decompressed);
+  VerifyLogEntries(
+      payload_decoder, kExpectedEntries, 0, entries_count, drop_count);
+  EXPECT_EQ(drop_count, 0u);
+  EXPECT_EQ(entries_count, 3u);
+}
+
 TEST_F(TrickleTest, LimitedFlushOverflowsToNextPayload) {
   AttachDrain();
   OpenWriter();
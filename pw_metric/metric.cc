@@ -14,7 +14,11 @@
 
 #include "pw_metric/metric.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
 
 #include "pw_assert/check.h"
 #include "pw_log/log.h"
@@ -23,6 +27,13 @@
 #include "pw_tokenizer/base64.h"
 
 namespace pw::metric {
+namespace internal {
+
+std::atomic<uint32_t> current_generation{0};
+std::atomic<uint32_t> tree_version{0};
+
+}  // namespace internal
+
 namespace {
 
 template <typename T>
@@ -54,21 +65,27 @@ const char* Indent(int level) {
 // Enable easier registration when used as a member.
 Metric::Metric(Token name, float value, IntrusiveList<Metric>& metrics)
     : Metric(name, value) {
+  MarkChanged();
   metrics.push_front(*this);
+  internal::TreeChanged();
 }
 Metric::Metric(Token name, uint32_t value, IntrusiveList<Metric>& metrics)
     : Metric(name, value) {
+  MarkChanged();
   metrics.push_front(*this);
+  internal::TreeChanged();
 }
 
+// Values are read with relaxed atomic loads, which are plain loads, so that
+// reading an AtomicMetric while it is updated is not a data race.
 float Metric::as_float() const {
   PW_DCHECK(is_float());
-  return float_;
+  return atomic_as_float();
 }
 
 uint32_t Metric::as_int() const {
   PW_DCHECK(is_int());
-  return uint_;
+  return atomic_as_int();
 }
 
 void Metric::Increment(uint32_t amount) {
@@ -76,6 +93,7 @@ void Metric::Increment(uint32_t amount) {
   if (PW_ADD_OVERFLOW(uint_, amount, &uint_)) {
     uint_ = std::numeric_limits<uint32_t>::max();
   }
+  MarkChanged();
 }
 
 void Metric::Decrement(uint32_t amount) {
@@ -83,16 +101,19 @@ void Metric::Decrement(uint32_t amount) {
   if (PW_SUB_OVERFLOW(uint_, amount, &uint_)) {
     uint_ = 0;
   }
+  MarkChanged();
 }
 
 void Metric::SetInt(uint32_t value) {
   PW_DCHECK(is_int());
   uint_ = value;
+  MarkChanged();
 }
 
 void Metric::SetFloat(float value) {
   PW_DCHECK(is_float());
   float_ = value;
+  MarkChanged();
 }
 
 void Metric::Dump(int level) {
@@ -119,8 +140,43 @@ void Metric::Dump(IntrusiveList<Metric>& metrics, int level) {
   }
 }
 
+Histogram::Histogram(Token name,
+                     uint8_t sub_bucket_bits,
+                     span<std::atomic<uint32_t>> buckets,
+                     IntrusiveList<Histogram>& histograms)
+    : Histogram(name, sub_bucket_bits, buckets) {
+  MarkChanged();
+  histograms.push_front(*this);
+  internal::TreeChanged();
+}
+
+void Histogram::Dump(int level) {
+  Base64EncodedToken encoded_name(name());
+  const char* indent = Indent(level);
+  const char* bucket_indent = Indent(level + 1);
+  PW_LOG_INFO("%s \"%s\": {", indent, encoded_name.value());
+  for (size_t i = 0; i < bucket_count(); ++i) {
+    const uint32_t count = bucket(i);
+    if (count != 0) {
+      PW_LOG_INFO(
+          "%s \"%u\": %u,",
+          bucket_indent,
+          static_cast<unsigned int>(BucketLowerBound(i, sub_bucket_bits_)),
+          static_cast<unsigned int>(count));
+    }
+  }
+  PW_LOG_INFO("%s }", indent);
+}
+
+void Histogram::Dump(IntrusiveList<Histogram>& histograms, int level) {
+  for (auto& histogram : histograms) {
+    histogram.Dump(level);
+  }
+}
+
 Group::Group(Token name, IntrusiveList<Group>& groups) : name_(name) {
   groups.push_front(*this);
+  internal::TreeChanged();
 }
 
 void Group::Dump(int level) {
@@ -129,6 +185,7 @@ void Group::Dump(int level) {
   PW_LOG_INFO("%s \"%s\": {", indent, encoded_name.value());
   Group::Dump(children(), level + 1);
   Metric::Dump(metrics(), level + 1);
+  Histogram::Dump(histograms(), level + 1);
   PW_LOG_INFO("%s }", indent);
 }
 
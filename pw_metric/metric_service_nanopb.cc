@@ -16,6 +16,7 @@
 
 #include <cstring>
 
+#include "pb_encode.h"
 #include "pw_assert/check.h"
 #include "pw_containers/vector.h"
 #include "pw_metric/metric.h"
@@ -26,6 +27,63 @@
 namespace pw::metric {
 namespace {
 
+// Returns the next available Metric slot in a MetricResponse or WalkResponse.
+template <typename Response>
+pw_metric_proto_Metric& NextMetric(Response& response) {
+  // Nanopb doesn't offer an easy way to do bounds checking, so use span's
+  // type deduction magic to figure out the max size.
+  span<pw_metric_proto_Metric> metrics(response.metrics);
+  PW_CHECK_INT_LT(response.metrics_count, metrics.size());
+  return response.metrics[response.metrics_count];
+}
+
+void CopyPath(const Vector<Token>& path, pw_metric_proto_Metric& proto_metric) {
+  span<Token> proto_path(proto_metric.token_path);
+  PW_CHECK_INT_LE(path.size(), proto_path.size());
+  std::copy(path.begin(), path.end(), proto_path.begin());
+  proto_metric.token_path_count = path.size();
+}
+
+void CopyMetric(const Metric& metric,
+                const Vector<Token>& path,
+                pw_metric_proto_Metric& proto_metric) {
+  CopyPath(path, proto_metric);
+  if (metric.is_float()) {
+    proto_metric.value.as_float = metric.as_float();
+    proto_metric.which_value = pw_metric_proto_Metric_as_float_tag;
+  } else {
+    proto_metric.value.as_int = metric.as_int();
+    proto_metric.which_value = pw_metric_proto_Metric_as_int_tag;
+  }
+}
+
+// The bucket counts are read from the histogram when the response is encoded,
+// so the response must be sent while the histogram is alive.
+void CopyMetric(const Histogram& histogram,
+                const Vector<Token>& path,
+                pw_metric_proto_Metric& proto_metric) {
+  CopyPath(path, proto_metric);
+  proto_metric.which_value = pw_metric_proto_Metric_as_histogram_tag;
+
+  pw_metric_proto_Histogram& proto_histogram = proto_metric.value.as_histogram;
+  proto_histogram.sub_bucket_bits = histogram.sub_bucket_bits();
+  proto_histogram.bucket_counts.funcs.encode = +[](pb_ostream_t* stream,
+                                                   const pb_field_t* field,
+                                                   void* const* arg) -> bool {
+    // Note: nanopb passes the pointer to the bucket_counts.arg member as arg,
+    // not its contents.
+    const Histogram& h = *static_cast<const Histogram*>(*arg);
+    for (size_t i = 0; i < h.bucket_count(); ++i) {
+      if (!pb_encode_tag_for_field(stream, field) ||
+          !pb_encode_varint(stream, h.bucket(i))) {
+        return false;
+      }
+    }
+    return true;
+  };
+  proto_histogram.bucket_counts.arg = const_cast<Histogram*>(&histogram);
+}
+
 class NanopbMetricWriter : public virtual internal::MetricWriter {
  public:
   NanopbMetricWriter(
@@ -38,42 +96,30 @@ class NanopbMetricWriter : public virtual internal::MetricWriter {
   // on transport MTU, rather than having this as a static knob. For example,
   // some transports may be able to fit 30 metrics; others, only 5.
   Status Write(const Metric& metric, const Vector<Token>& path) override {
-    // Nanopb doesn't offer an easy way to do bounds checking, so use span's
-    // type deduction magic to figure out the max size.
-    span<pw_metric_proto_Metric> metrics(response_.metrics);
-    PW_CHECK_INT_LT(response_.metrics_count, metrics.size());
-
-    // Grab the next available Metric slot to write to in the response.
-    pw_metric_proto_Metric& proto_metric =
-        response_.metrics[response_.metrics_count];
-
-    // Copy the path.
-    span<Token> proto_path(proto_metric.token_path);
-    PW_CHECK_INT_LE(path.size(), proto_path.size());
-    std::copy(path.begin(), path.end(), proto_path.begin());
-    proto_metric.token_path_count = path.size();
-
-    // Copy the metric value.
-    if (metric.is_float()) {
-      proto_metric.value.as_float = metric.as_float();
-      proto_metric.which_value = pw_metric_proto_Metric_as_float_tag;
-    } else {
-      proto_metric.value.as_int = metric.as_int();
-      proto_metric.which_value = pw_metric_proto_Metric_as_int_tag;
-    }
+    CopyMetric(metric, path, NextMetric(response_));
 
     // Move write head to the next slot.
     response_.metrics_count++;
 
     // If the metric response object is full, send the response and reset.
     // TODO(keir): Support runtime batch sizes < max proto size.
-    if (response_.metrics_count == metrics.size()) {
+    if (response_.metrics_count == span(response_.metrics).size()) {
       Flush();
     }
 
     return OkStatus();
   }
 
+  Status Write(const Histogram& histogram, const Vector<Token>& path) override {
+    // Histograms are much larger than other metrics, so send each one in a
+    // response of its own.
+    Flush();
+    CopyMetric(histogram, path, NextMetric(response_));
+    response_.metrics_count++;
+    Flush();
+    return OkStatus();
+  }
+
   void Flush() {
     if (response_.metrics_count) {
       response_writer_.Write(response_)
@@ -88,6 +134,41 @@ class NanopbMetricWriter : public virtual internal::MetricWriter {
   MetricService::ServerWriter<pw_metric_proto_MetricResponse>& response_writer_;
 };
 
+// Writes a page of metrics to a WalkResponse. As in Get(), a histogram is only
+// written to an empty page, and ends it.
+class NanopbPagedMetricWriter : public internal::PagedMetricWriter {
+ public:
+  NanopbPagedMetricWriter(pw_metric_proto_WalkResponse& response,
+                          uint64_t cursor,
+                          uint32_t since_generation)
+      : PagedMetricWriter(cursor, since_generation), response_(response) {}
+
+ private:
+  Status WriteToPage(const Metric& metric, const Vector<Token>& path) override {
+    if (page_full_ ||
+        response_.metrics_count == span(response_.metrics).size()) {
+      return Status::ResourceExhausted();
+    }
+    CopyMetric(metric, path, NextMetric(response_));
+    response_.metrics_count++;
+    return OkStatus();
+  }
+
+  Status WriteToPage(const Histogram& histogram,
+                     const Vector<Token>& path) override {
+    if (response_.metrics_count != 0) {
+      return Status::ResourceExhausted();
+    }
+    CopyMetric(histogram, path, NextMetric(response_));
+    response_.metrics_count++;
+    page_full_ = true;
+    return OkStatus();
+  }
+
+  pw_metric_proto_WalkResponse& response_;
+  bool page_full_ = false;
+};
+
 }  // namespace
 
 void MetricService::Get(
@@ -109,4 +190,43 @@ void MetricService::Get(
   writer.Flush();
 }
 
+Status MetricService::Walk(const pw_metric_proto_WalkRequest& request,
+                           pw_metric_proto_WalkResponse& response) {
+  // Positions in the cursor are meaningless if the tree has changed since the
+  // walk started; the client must start over.
+  if (request.has_cursor &&
+      !internal::PagedMetricWriter::IsCurrent(request.cursor)) {
+    return Status::Aborted();
+  }
+
+  // Metrics that change from here on are stamped with the new generation, so
+  // a walk starting from it includes them.
+  if (!request.has_cursor) {
+    response.has_generation = true;
+    response.generation = AdvanceGeneration();
+  }
+
+  NanopbPagedMetricWriter writer(
+      response,
+      request.has_cursor ? request.cursor
+                         : internal::PagedMetricWriter::FirstCursor(),
+      request.has_since_generation ? request.since_generation : 0);
+  internal::MetricWalker walker(writer);
+  Status status = walker.Walk(metrics_);
+  if (status.ok()) {
+    status = walker.Walk(groups_);
+  }
+
+  if (status.ok()) {
+    response.which_next = pw_metric_proto_WalkResponse_done_tag;
+    response.next.done = true;
+  } else if (status.IsResourceExhausted()) {
+    response.which_next = pw_metric_proto_WalkResponse_cursor_tag;
+    response.next.cursor = writer.next_cursor().value();
+  } else {
+    return status;
+  }
+  return OkStatus();
+}
+
 }  // namespace pw::metric
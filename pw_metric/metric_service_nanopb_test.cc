@@ -202,5 +202,138 @@ TEST(MetricService, TokenPaths) {
   }
 }
 
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+TEST(MetricService, HistogramInOwnResponse) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1.0);
+
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC_HISTOGRAM(inner, latency, "latency", 8, 1);
+  latency.Record(3);
+  root.Add(inner);
+
+  // Run the RPC and ensure it completes.
+  MetricMethodContext context(root.metrics(), root.children());
+  context.call({});
+  EXPECT_TRUE(context.done());
+  EXPECT_EQ(OkStatus(), context.status());
+
+  // The histogram is sent after the scalar metric, in a response of its own.
+  ASSERT_EQ(2u, context.responses().size());
+  EXPECT_EQ(1, context.responses()[0].metrics_count);
+  ASSERT_EQ(1, context.responses()[1].metrics_count);
+
+  const pw_metric_proto_Metric& metric = context.responses()[1].metrics[0];
+  EXPECT_EQ(pw_metric_proto_Metric_as_histogram_tag, metric.which_value);
+  EXPECT_EQ(1u, metric.value.as_histogram.sub_bucket_bits);
+}
+
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+TEST(MetricService, WalkResumesFromCursor) {
+  // More metrics than fit in one WalkResponse.
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1.0);
+  PW_METRIC(root, b, "b", 1.0);
+  PW_METRIC(root, c, "c", 1.0);
+  PW_METRIC(root, d, "d", 1.0);
+  PW_METRIC(root, e, "e", 1.0);
+  PW_METRIC(root, f, "f", 1.0);
+
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC(inner, x, "x", 1.0);
+  PW_METRIC(inner, y, "y", 1.0);
+  PW_METRIC(inner, z, "z", 1.0);
+  PW_METRIC(inner, p, "p", 1.0);
+  PW_METRIC(inner, q, "q", 1.0);
+  PW_METRIC(inner, r, "r", 1.0);
+
+  root.Add(inner);
+
+  PW_NANOPB_TEST_METHOD_CONTEXT(MetricService, Walk)
+  context(root.metrics(), root.children());
+
+  ASSERT_EQ(OkStatus(), context.call({}));
+  pw_metric_proto_WalkResponse response = context.response();
+  EXPECT_TRUE(response.has_generation);
+  EXPECT_EQ(10, response.metrics_count);
+  ASSERT_EQ(pw_metric_proto_WalkResponse_cursor_tag, response.which_next);
+
+  pw_metric_proto_WalkRequest request = pw_metric_proto_WalkRequest_init_zero;
+  request.has_cursor = true;
+  request.cursor = response.next.cursor;
+  ASSERT_EQ(OkStatus(), context.call(request));
+  response = context.response();
+  EXPECT_FALSE(response.has_generation);
+  EXPECT_EQ(2, response.metrics_count);
+  ASSERT_EQ(pw_metric_proto_WalkResponse_done_tag, response.which_next);
+  EXPECT_TRUE(response.next.done);
+}
+
+TEST(MetricService, WalkAbortsIfTreeChanged) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1.0);
+  PW_METRIC(root, b, "b", 1.0);
+  PW_METRIC(root, c, "c", 1.0);
+  PW_METRIC(root, d, "d", 1.0);
+  PW_METRIC(root, e, "e", 1.0);
+  PW_METRIC(root, f, "f", 1.0);
+  PW_METRIC(root, g, "g", 1.0);
+  PW_METRIC(root, h, "h", 1.0);
+  PW_METRIC(root, i, "i", 1.0);
+  PW_METRIC(root, j, "j", 1.0);
+  PW_METRIC(root, k, "k", 1.0);
+
+  PW_NANOPB_TEST_METHOD_CONTEXT(MetricService, Walk)
+  context(root.metrics(), root.children());
+
+  ASSERT_EQ(OkStatus(), context.call({}));
+  pw_metric_proto_WalkResponse response = context.response();
+  ASSERT_EQ(pw_metric_proto_WalkResponse_cursor_tag, response.which_next);
+
+  // Adding a metric moves the others to later positions in the walk, so the
+  // cursor no longer identifies where the walk stopped.
+  PW_METRIC(root, added, "added", 1.0);
+
+  pw_metric_proto_WalkRequest request = pw_metric_proto_WalkRequest_init_zero;
+  request.has_cursor = true;
+  request.cursor = response.next.cursor;
+  EXPECT_EQ(Status::Aborted(), context.call(request));
+
+  // A restarted walk succeeds.
+  ASSERT_EQ(OkStatus(), context.call({}));
+  EXPECT_EQ(10, context.response().metrics_count);
+}
+
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+
+TEST(MetricService, WalkSinceGenerationReturnsChangedMetrics) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+
+  PW_NANOPB_TEST_METHOD_CONTEXT(MetricService, Walk)
+  context(root.metrics(), root.children());
+
+  ASSERT_EQ(OkStatus(), context.call({}));
+  pw_metric_proto_WalkResponse response = context.response();
+  EXPECT_EQ(2, response.metrics_count);
+  ASSERT_TRUE(response.has_generation);
+
+  pw_metric_proto_WalkRequest request = pw_metric_proto_WalkRequest_init_zero;
+  request.has_since_generation = true;
+  request.since_generation = response.generation;
+
+  b.Increment();
+  ASSERT_EQ(OkStatus(), context.call(request));
+  response = context.response();
+  ASSERT_EQ(1, response.metrics_count);
+  EXPECT_EQ(3u, response.metrics[0].value.as_int);
+  EXPECT_EQ(pw_metric_proto_WalkResponse_done_tag, response.which_next);
+}
+
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+
 }  // namespace
 }  // namespace pw::metric
@@ -14,6 +14,8 @@
 
 #include "pw_metric/metric_service_pwpb.h"
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 
 #include "pw_assert/check.h"
@@ -22,10 +24,15 @@
 #include "pw_metric_private/metric_walker.h"
 #include "pw_metric_proto/metric_service.pwpb.h"
 #include "pw_preprocessor/util.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_rpc/channel.h"
 #include "pw_rpc/raw/server_reader_writer.h"
 #include "pw_span/span.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 #include "pw_status/try.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_varint/varint.h"
 
 namespace pw::metric {
 
@@ -68,6 +75,31 @@ class PwpbMetricWriter : public virtual internal::MetricWriter {
     return OkStatus();
   }
 
+  Status Write(const Histogram& histogram, const Vector<Token>& path) override {
+    // Histograms are much larger than other metrics, so send each one in a
+    // response of its own.
+    PW_TRY(Flush());
+    {  // Scope to control proto_encoder lifetime.
+      proto::pwpb::Metric::StreamEncoder proto_encoder =
+          encoder_.GetMetricsEncoder();
+      PW_TRY(proto_encoder.WriteTokenPath(path));
+
+      // Snapshot the bucket counts, which may be updated concurrently.
+      std::array<uint32_t, Histogram::kMaxBuckets> bucket_counts;
+      for (size_t i = 0; i < histogram.bucket_count(); ++i) {
+        bucket_counts[i] = histogram.bucket(i);
+      }
+      proto::pwpb::Histogram::StreamEncoder histogram_encoder =
+          proto_encoder.GetAsHistogramEncoder();
+      PW_TRY(histogram_encoder.WriteSubBucketBits(histogram.sub_bucket_bits()));
+      PW_TRY(histogram_encoder.WriteBucketCounts(
+          span(bucket_counts).first(histogram.bucket_count())));
+    }
+
+    metrics_count++;
+    return Flush();
+  }
+
   Status Flush() {
     Status status;
     if (metrics_count) {
@@ -89,6 +121,136 @@ class PwpbMetricWriter : public virtual internal::MetricWriter {
   proto::pwpb::MetricRequest::MemoryEncoder encoder_;
   size_t metrics_count = 0;
 };
+
+// Writes a page of metrics to a WalkResponse, until the next metric might not
+// fit in the response buffer.
+class PwpbPagedMetricWriter : public internal::PagedMetricWriter {
+ public:
+  PwpbPagedMetricWriter(proto::pwpb::WalkResponse::MemoryEncoder& encoder,
+                        size_t buffer_size,
+                        uint64_t cursor,
+                        uint32_t since_generation)
+      : PagedMetricWriter(cursor, since_generation),
+        encoder_(encoder),
+        buffer_size_(buffer_size) {}
+
+ private:
+  using ResponseFields = proto::pwpb::WalkResponse::Fields;
+  using Fields = proto::pwpb::Metric::Fields;
+  using HistogramFields = proto::pwpb::Histogram::Fields;
+
+  // Space left for the field that ends the response.
+  static constexpr size_t kReservedSize =
+      std::max(protobuf::SizeOfFieldBool(ResponseFields::kDone),
+               protobuf::SizeOfFieldUint64(ResponseFields::kCursor));
+
+  Status WriteToPage(const Metric& metric, const Vector<Token>& path) override {
+    PW_TRY(CheckSpace(path, protobuf::SizeOfFieldUint32(Fields::kAsInt)));
+
+    proto::pwpb::Metric::StreamEncoder proto_encoder =
+        encoder_.GetMetricsEncoder();
+    PW_TRY(proto_encoder.WriteTokenPath(path));
+    if (metric.is_float()) {
+      return proto_encoder.WriteAsFloat(metric.as_float());
+    }
+    return proto_encoder.WriteAsInt(metric.as_int());
+  }
+
+  Status WriteToPage(const Histogram& histogram,
+                     const Vector<Token>& path) override {
+    const size_t bucket_counts_size = protobuf::SizeOfDelimitedField(
+        HistogramFields::kBucketCounts,
+        histogram.bucket_count() * protobuf::kMaxSizeBytesUint32);
+    PW_TRY(CheckSpace(path,
+                      protobuf::TagSizeBytes(Fields::kAsHistogram) +
+                          protobuf::kMaxSizeOfLength +
+                          protobuf::SizeOfFieldUint32(
+                              HistogramFields::kSubBucketBits) +
+                          bucket_counts_size));
+
+    proto::pwpb::Metric::StreamEncoder proto_encoder =
+        encoder_.GetMetricsEncoder();
+    PW_TRY(proto_encoder.WriteTokenPath(path));
+
+    std::array<uint32_t, Histogram::kMaxBuckets> bucket_counts;
+    for (size_t i = 0; i < histogram.bucket_count(); ++i) {
+      bucket_counts[i] = histogram.bucket(i);
+    }
+    proto::pwpb::Histogram::StreamEncoder histogram_encoder =
+        proto_encoder.GetAsHistogramEncoder();
+    PW_TRY(histogram_encoder.WriteSubBucketBits(histogram.sub_bucket_bits()));
+    return histogram_encoder.WriteBucketCounts(
+        span(bucket_counts).first(histogram.bucket_count()));
+  }
+
+  // Returns RESOURCE_EXHAUSTED if a metric with the given path and encoded
+  // value size might not fit. Nested encoders reserve the largest length
+  // prefix, so this assumes each length takes kMaxSizeOfLength bytes.
+  Status CheckSpace(const Vector<Token>& path, size_t value_size) const {
+    const size_t metric_size =
+        protobuf::TagSizeBytes(ResponseFields::kMetrics) +
+        protobuf::kMaxSizeOfLength +
+        protobuf::SizeOfDelimitedField(Fields::kTokenPath,
+                                       path.size() * sizeof(Token)) +
+        value_size;
+    if (encoder_.size() + metric_size + kReservedSize > buffer_size_) {
+      return Status::ResourceExhausted();
+    }
+    return OkStatus();
+  }
+
+  proto::pwpb::WalkResponse::MemoryEncoder& encoder_;
+  const size_t buffer_size_;
+};
+
+// Encodes one page of a walk over the metrics and groups.
+StatusWithSize EncodeWalkResponse(const IntrusiveList<Metric>& metrics,
+                                  const IntrusiveList<Group>& groups,
+                                  ConstByteSpan request,
+                                  ByteSpan response) {
+  stream::MemoryReader reader(request);
+  proto::pwpb::WalkRequest::StreamDecoder decoder(reader);
+  proto::pwpb::WalkRequest::Message walk_request;
+  PW_TRY_WITH_SIZE(decoder.Read(walk_request));
+
+  // Positions in the cursor are meaningless if the tree has changed since the
+  // walk started; the client must start over.
+  if (walk_request.cursor.has_value() &&
+      !internal::PagedMetricWriter::IsCurrent(*walk_request.cursor)) {
+    return StatusWithSize::Aborted();
+  }
+
+  proto::pwpb::WalkResponse::MemoryEncoder encoder(response);
+
+  // Metrics that change from here on are stamped with the new generation, so
+  // a walk starting from it includes them.
+  if (!walk_request.cursor.has_value()) {
+    PW_TRY_WITH_SIZE(encoder.WriteGeneration(AdvanceGeneration()));
+  }
+
+  PwpbPagedMetricWriter writer(encoder,
+                               response.size(),
+                               walk_request.cursor.value_or(
+                                   internal::PagedMetricWriter::FirstCursor()),
+                               walk_request.since_generation.value_or(0));
+  internal::MetricWalker walker(writer);
+  Status status = walker.Walk(metrics);
+  if (status.ok()) {
+    status = walker.Walk(groups);
+  }
+
+  if (status.ok()) {
+    PW_TRY_WITH_SIZE(encoder.WriteDone(true));
+  } else if (status.IsResourceExhausted() && writer.entries_written() > 0) {
+    PW_TRY_WITH_SIZE(encoder.WriteCursor(writer.next_cursor().value()));
+  } else {
+    // Either the walk failed, or the response buffer is too small for even a
+    // single metric.
+    return StatusWithSize(status, 0);
+  }
+  return StatusWithSize(encoder.size());
+}
+
 }  // namespace
 
 void MetricService::Get(ConstByteSpan /*request*/,
@@ -98,7 +260,13 @@ void MetricService::Get(ConstByteSpan /*request*/,
   constexpr size_t kSizeOfOneMetric =
       pw::metric::proto::pwpb::MetricResponse::kMaxEncodedSizeBytes +
       pw::metric::proto::pwpb::Metric::kMaxEncodedSizeBytes;
-  constexpr size_t kEncodeBufferSize = kMaxNumPackedEntries * kSizeOfOneMetric;
+  // The generated sizes count one element of each repeated field, so add room
+  // for the rest of the bucket counts.
+  constexpr size_t kSizeOfOneHistogram =
+      kSizeOfOneMetric +
+      Histogram::kMaxBuckets * varint::kMaxVarint32SizeBytes;
+  constexpr size_t kEncodeBufferSize =
+      std::max(kMaxNumPackedEntries * kSizeOfOneMetric, kSizeOfOneHistogram);
 
   std::array<std::byte, kEncodeBufferSize> encode_buffer;
 
@@ -120,4 +288,16 @@ void MetricService::Get(ConstByteSpan /*request*/,
   status.Update(writer.Flush());
   raw_response.Finish(status).IgnoreError();
 }
+
+void MetricService::Walk(ConstByteSpan request,
+                         rpc::RawUnaryResponder& responder) {
+  std::array<std::byte, rpc::MaxSafePayloadSize()> buffer;
+  const ByteSpan response =
+      span(buffer).first(std::min(buffer.size(), max_walk_response_size_));
+  const StatusWithSize result =
+      EncodeWalkResponse(metrics_, groups_, request, response);
+  responder.Finish(response.first(result.size()), result.status())
+      .IgnoreError();
+}
+
 }  // namespace pw::metric
@@ -14,6 +14,10 @@
 
 #include "pw_metric/metric_service_pwpb.h"
 
+#include <array>
+#include <optional>
+
+#include "pw_containers/vector.h"
 #include "pw_log/log.h"
 #include "pw_metric_proto/metric_service.pwpb.h"
 #include "pw_protobuf/decoder.h"
@@ -21,6 +25,7 @@
 #include "pw_rpc/raw/test_method_context.h"
 #include "pw_span/span.h"
 #include "pw_unit_test/framework.h"
+#include "pw_varint/varint.h"
 
 namespace pw::metric {
 namespace {
@@ -74,6 +79,109 @@ size_t GetMetricsSum(ConstByteSpan serialized_metric_buffer) {
   return metrics_sum;
 }
 
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+// Decodes the bucket counts of the histogram in a single-metric response.
+Vector<uint32_t, Histogram::kMaxBuckets> GetHistogramBuckets(
+    ConstByteSpan serialized_metric_buffer) {
+  Vector<uint32_t, Histogram::kMaxBuckets> buckets;
+  ConstByteSpan metric_buffer;
+  ConstByteSpan histogram_buffer;
+  ConstByteSpan packed_counts;
+
+  protobuf::Decoder response_decoder(serialized_metric_buffer);
+  while (response_decoder.Next().ok()) {
+    if (response_decoder.FieldNumber() ==
+        static_cast<uint32_t>(
+            pw::metric::proto::pwpb::MetricResponse::Fields::kMetrics)) {
+      EXPECT_EQ(OkStatus(), response_decoder.ReadBytes(&metric_buffer));
+    }
+  }
+  protobuf::Decoder metric_decoder(metric_buffer);
+  while (metric_decoder.Next().ok()) {
+    if (metric_decoder.FieldNumber() ==
+        static_cast<uint32_t>(
+            pw::metric::proto::pwpb::Metric::Fields::kAsHistogram)) {
+      EXPECT_EQ(OkStatus(), metric_decoder.ReadBytes(&histogram_buffer));
+    }
+  }
+  protobuf::Decoder histogram_decoder(histogram_buffer);
+  while (histogram_decoder.Next().ok()) {
+    if (histogram_decoder.FieldNumber() ==
+        static_cast<uint32_t>(
+            pw::metric::proto::pwpb::Histogram::Fields::kBucketCounts)) {
+      EXPECT_EQ(OkStatus(), histogram_decoder.ReadBytes(&packed_counts));
+    }
+  }
+  while (!packed_counts.empty()) {
+    uint64_t count;
+    const size_t bytes_read = varint::Decode(packed_counts, &count);
+    EXPECT_NE(bytes_read, 0u);
+    if (bytes_read == 0u) {
+      break;
+    }
+    buckets.push_back(static_cast<uint32_t>(count));
+    packed_counts = packed_counts.subspan(bytes_read);
+  }
+  return buckets;
+}
+
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+ConstByteSpan EncodeWalkRequest(ByteSpan buffer,
+                                std::optional<uint64_t> cursor,
+                                std::optional<uint32_t> since_generation) {
+  pw::metric::proto::pwpb::WalkRequest::MemoryEncoder encoder(buffer);
+  if (cursor.has_value()) {
+    EXPECT_EQ(OkStatus(), encoder.WriteCursor(*cursor));
+  }
+  if (since_generation.has_value()) {
+    EXPECT_EQ(OkStatus(), encoder.WriteSinceGeneration(*since_generation));
+  }
+  EXPECT_EQ(OkStatus(), encoder.status());
+  return ConstByteSpan(encoder);
+}
+
+struct WalkPage {
+  size_t num_metrics = 0;
+  size_t metrics_sum = 0;
+  std::optional<uint32_t> generation;
+  std::optional<uint64_t> cursor;
+  bool done = false;
+};
+
+WalkPage DecodeWalkPage(ConstByteSpan serialized_response) {
+  using Fields = pw::metric::proto::pwpb::WalkResponse::Fields;
+  WalkPage page;
+  protobuf::Decoder decoder(serialized_response);
+  while (decoder.Next().ok()) {
+    uint32_t value;
+    switch (static_cast<Fields>(decoder.FieldNumber())) {
+      case Fields::kMetrics: {
+        ConstByteSpan metric_buffer;
+        EXPECT_EQ(OkStatus(), decoder.ReadBytes(&metric_buffer));
+        page.num_metrics++;
+        page.metrics_sum += SumMetricInts(metric_buffer);
+        break;
+      }
+      case Fields::kGeneration:
+        EXPECT_EQ(OkStatus(), decoder.ReadUint32(&value));
+        page.generation = value;
+        break;
+      case Fields::kCursor: {
+        uint64_t cursor;
+        EXPECT_EQ(OkStatus(), decoder.ReadUint64(&cursor));
+        page.cursor = cursor;
+        break;
+      }
+      case Fields::kDone:
+        EXPECT_EQ(OkStatus(), decoder.ReadBool(&page.done));
+        break;
+    }
+  }
+  return page;
+}
+
 TEST(MetricService, EmptyGroupAndNoMetrics) {
   // Empty root group.
   PW_METRIC_GROUP(root, "/");
@@ -214,5 +322,187 @@ TEST(MetricService, NestedGroupsWithBatches) {
                 GetMetricsSum(ctx.responses()[3]));
 }
 
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+TEST(MetricService, HistogramInOwnResponse) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC_HISTOGRAM(inner, latency, "latency", 4, 0);
+  root.Add(inner);
+
+  latency.Record(0);
+  latency.Record(1);
+  latency.Record(5);
+  latency.Record(6);
+  latency.Record(100);
+
+  PW_RAW_TEST_METHOD_CONTEXT(MetricService, Get)
+  ctx{root.metrics(), root.children()};
+  ctx.call({});
+  EXPECT_TRUE(ctx.done());
+  EXPECT_EQ(OkStatus(), ctx.status());
+
+  // The scalar metrics are sent first, then the histogram on its own.
+  ASSERT_EQ(2u, ctx.responses().size());
+  EXPECT_EQ(2u, CountEncodedMetrics(ctx.responses()[0]));
+  EXPECT_EQ(3u, GetMetricsSum(ctx.responses()[0]));
+  EXPECT_EQ(1u, CountEncodedMetrics(ctx.responses()[1]));
+
+  const auto buckets = GetHistogramBuckets(ctx.responses()[1]);
+  ASSERT_EQ(4u, buckets.size());
+  EXPECT_EQ(1u, buckets[0]);
+  EXPECT_EQ(1u, buckets[1]);
+  EXPECT_EQ(0u, buckets[2]);
+  EXPECT_EQ(3u, buckets[3]);
+}
+
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+// Keep responses small enough for the test context's payload buffer.
+constexpr size_t kMaxWalkResponseSize = 128;
+
+// Calls Walk and returns the decoded response.
+template <typename Context>
+WalkPage CallWalk(Context& ctx,
+                  std::optional<uint64_t> cursor,
+                  std::optional<uint32_t> since_generation) {
+  std::array<std::byte, 24> request_buffer;
+  ctx.output().clear();
+  ctx.call(EncodeWalkRequest(request_buffer, cursor, since_generation));
+  EXPECT_EQ(OkStatus(), ctx.status());
+  EXPECT_LE(ctx.response().size(), kMaxWalkResponseSize);
+  return DecodeWalkPage(ctx.response());
+}
+
+TEST(MetricService, WalkEmptyGroupIsDone) {
+  PW_METRIC_GROUP(root, "/");
+
+  PW_RAW_TEST_METHOD_CONTEXT(MetricService, Walk)
+  ctx{root.metrics(), root.children(), kMaxWalkResponseSize};
+  const WalkPage page = CallWalk(ctx, std::nullopt, std::nullopt);
+  EXPECT_EQ(0u, page.num_metrics);
+  EXPECT_TRUE(page.generation.has_value());
+  EXPECT_FALSE(page.cursor.has_value());
+  EXPECT_TRUE(page.done);
+}
+
+TEST(MetricService, WalkResumesFromCursor) {
+  // More metrics than fit in one packet, split across groups.
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC_GROUP(inner_1, "inner1");
+  PW_METRIC_GROUP(inner_2, "inner2");
+  std::array<std::optional<TypedMetric<uint32_t>>, 60> metrics;
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    Group& group = (i % 3 == 0) ? root : (i % 3 == 1) ? inner_1 : inner_2;
+    metrics[i].emplace(
+        static_cast<Token>(i), static_cast<uint32_t>(i + 1), group.metrics());
+  }
+  root.Add(inner_1);
+  root.Add(inner_2);
+
+  PW_RAW_TEST_METHOD_CONTEXT(MetricService, Walk)
+  ctx{root.metrics(), root.children(), kMaxWalkResponseSize};
+  std::optional<uint64_t> cursor;
+  size_t num_pages = 0;
+  size_t num_metrics = 0;
+  size_t metrics_sum = 0;
+  while (true) {
+    const WalkPage page = CallWalk(ctx, cursor, std::nullopt);
+    // Only the first page starts a generation.
+    EXPECT_EQ(num_pages == 0, page.generation.has_value());
+    num_pages++;
+    num_metrics += page.num_metrics;
+    metrics_sum += page.metrics_sum;
+    if (page.done) {
+      break;
+    }
+    ASSERT_TRUE(page.cursor.has_value());
+    ASSERT_GT(page.num_metrics, 0u);
+    cursor = page.cursor;
+  }
+
+  EXPECT_GT(num_pages, 1u);
+  EXPECT_EQ(60u, num_metrics);
+  EXPECT_EQ(60u * 61u / 2u, metrics_sum);
+}
+
+TEST(MetricService, WalkAbortsIfTreeChanged) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC_GROUP(inner, "inner");
+  std::array<std::optional<TypedMetric<uint32_t>>, 20> metrics;
+  for (size_t i = 0; i < metrics.size(); ++i) {
+    metrics[i].emplace(
+        static_cast<Token>(i), static_cast<uint32_t>(i + 1), inner.metrics());
+  }
+  root.Add(inner);
+
+  PW_RAW_TEST_METHOD_CONTEXT(MetricService, Walk)
+  ctx{root.metrics(), root.children(), kMaxWalkResponseSize};
+  WalkPage page = CallWalk(ctx, std::nullopt, std::nullopt);
+  ASSERT_TRUE(page.cursor.has_value());
+  const uint64_t cursor = *page.cursor;
+
+  // Adding a metric moves the others to later positions in the walk, so the
+  // cursor no longer identifies where the walk stopped.
+  PW_METRIC(inner, added, "added", 1000u);
+
+  std::array<std::byte, 24> request_buffer;
+  ctx.output().clear();
+  ctx.call(EncodeWalkRequest(request_buffer, cursor, std::nullopt));
+  EXPECT_EQ(Status::Aborted(), ctx.status());
+
+  // A restarted walk returns every metric once.
+  size_t num_metrics = 0;
+  size_t metrics_sum = 0;
+  std::optional<uint64_t> next;
+  do {
+    page = CallWalk(ctx, next, std::nullopt);
+    num_metrics += page.num_metrics;
+    metrics_sum += page.metrics_sum;
+    next = page.cursor;
+  } while (!page.done);
+  EXPECT_EQ(21u, num_metrics);
+  EXPECT_EQ(20u * 21u / 2u + added.value(), metrics_sum);
+}
+
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE && PW_METRIC_CONFIG_TRACK_GENERATIONS
+
+TEST(MetricService, WalkSinceGenerationReturnsChangedMetrics) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC(inner, x, "x", 3u);
+  PW_METRIC_HISTOGRAM(inner, latency, "latency", 4, 0);
+  root.Add(inner);
+
+  PW_RAW_TEST_METHOD_CONTEXT(MetricService, Walk)
+  ctx{root.metrics(), root.children(), kMaxWalkResponseSize};
+  WalkPage page = CallWalk(ctx, std::nullopt, std::nullopt);
+  EXPECT_EQ(4u, page.num_metrics);
+  ASSERT_TRUE(page.generation.has_value());
+  const uint32_t generation = *page.generation;
+
+  // Nothing has changed since the first walk.
+  page = CallWalk(ctx, std::nullopt, generation);
+  EXPECT_EQ(0u, page.num_metrics);
+  EXPECT_TRUE(page.done);
+
+  b.Increment(10);
+  x.Set(4);
+  latency.Record(1);
+
+  page = CallWalk(ctx, std::nullopt, generation);
+  EXPECT_EQ(3u, page.num_metrics);
+  EXPECT_EQ(16u, page.metrics_sum);
+  EXPECT_TRUE(page.done);
+}
+
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE && PW_METRIC_CONFIG_TRACK_GENERATIONS
+
 }  // namespace
 }  // namespace pw::metric
@@ -14,6 +14,10 @@
 
 #include "pw_metric/metric.h"
 
+#include <array>
+#include <cstdint>
+#include <limits>
+
 #include "pw_log/log.h"
 #include "pw_unit_test/framework.h"
 
@@ -55,6 +59,69 @@ TEST(Metric, IntFromObject) {
   EXPECT_EQ(m.value(), 426u);
 }
 
+TEST(Metric, IntSaturates) {
+  TypedMetric<uint32_t> m(0x1234u, std::numeric_limits<uint32_t>::max() - 1);
+  m.Increment(5u);
+  EXPECT_EQ(m.value(), std::numeric_limits<uint32_t>::max());
+
+  m.Set(3u);
+  m.Decrement(5u);
+  EXPECT_EQ(m.value(), 0u);
+}
+
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+TEST(AtomicMetric, IntFromObject) {
+  AtomicMetric<uint32_t> m(0xf1223344, 10u);
+  EXPECT_EQ(m.name(), 0x71223344u);
+  EXPECT_TRUE(m.is_int());
+  EXPECT_EQ(m.value(), 10u);
+
+  m.Increment();
+  m.Increment(5u);
+  EXPECT_EQ(m.value(), 16u);
+
+  m.Decrement(6u);
+  EXPECT_EQ(m.value(), 10u);
+
+  m.Set(414u);
+  EXPECT_EQ(m.value(), 414u);
+}
+
+TEST(AtomicMetric, IntSaturates) {
+  AtomicMetric<uint32_t> m(0x1234u, std::numeric_limits<uint32_t>::max() - 1);
+  m.Increment(5u);
+  EXPECT_EQ(m.value(), std::numeric_limits<uint32_t>::max());
+
+  m.Set(3u);
+  m.Decrement(5u);
+  EXPECT_EQ(m.value(), 0u);
+}
+
+TEST(AtomicMetric, FloatFromObject) {
+  AtomicMetric<float> m(0xf1223344, 1.5f);
+  EXPECT_TRUE(m.is_float());
+  EXPECT_EQ(m.value(), 1.5f);
+
+  m.Set(55.1f);
+  EXPECT_EQ(m.value(), 55.1f);
+}
+
+TEST(AtomicMetric, GroupMacroInFunctionContext) {
+  PW_METRIC_GROUP(group, "atomic_subsystem");
+  PW_METRIC_ATOMIC(group, x, "x", 5555u);
+  PW_METRIC_ATOMIC(group, y, "y", 6.0f);
+
+  x.Increment(10);
+  y.Set(5.0f);
+
+  EXPECT_EQ(x.value(), 5565u);
+  EXPECT_EQ(y.value(), 5.0f);
+  EXPECT_EQ(group.metrics().size(), 2u);
+}
+
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
 TEST(m, IntFromMacroLocal) {
   PW_METRIC(m, "some_metric", 14u);
   EXPECT_TRUE(m.is_int());
@@ -85,6 +152,101 @@ TEST(Metric, GroupMacroInFunctionContext) {
   EXPECT_EQ(group.metrics().size(), 2u);
 }
 
+TEST(Histogram, BucketLowerBounds) {
+  constexpr std::array<uint32_t, 12> kExpected = {
+      0, 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48};
+  for (size_t i = 0; i < kExpected.size(); ++i) {
+    EXPECT_EQ(Histogram::BucketLowerBound(i, 1), kExpected[i]);
+  }
+}
+
+TEST(Histogram, BucketIndexMatchesLowerBounds) {
+  for (uint8_t sub_bucket_bits = 0; sub_bucket_bits < 5; ++sub_bucket_bits) {
+    for (size_t i = 0; i + 1 < Histogram::kMaxBuckets; ++i) {
+      const uint32_t lower = Histogram::BucketLowerBound(i, sub_bucket_bits);
+      const uint32_t next = Histogram::BucketLowerBound(i + 1, sub_bucket_bits);
+      ASSERT_LT(lower, next);
+      EXPECT_EQ(Histogram::BucketIndex(lower, sub_bucket_bits), i);
+      EXPECT_EQ(Histogram::BucketIndex(next - 1, sub_bucket_bits), i);
+    }
+  }
+  EXPECT_EQ(Histogram::BucketIndex(std::numeric_limits<uint32_t>::max(), 0),
+            32u);
+}
+
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+TEST(Histogram, RecordFromMacroInGroup) {
+  PW_METRIC_GROUP(group, "fancy_subsystem");
+  PW_METRIC_HISTOGRAM(group, latency, "latency", 8, 1);
+  EXPECT_EQ(group.histograms().size(), 1u);
+  EXPECT_EQ(latency.bucket_count(), 8u);
+  EXPECT_EQ(latency.sub_bucket_bits(), 1u);
+
+  latency.Record(0);
+  latency.Record(3);
+  latency.Record(4);
+  latency.Record(5);
+  latency.Record(7);
+  // Larger values are counted in the last bucket.
+  latency.Record(12);
+  latency.Record(100000);
+
+  constexpr std::array<uint32_t, 8> kExpected = {1, 0, 0, 1, 2, 1, 0, 2};
+  for (size_t i = 0; i < kExpected.size(); ++i) {
+    EXPECT_EQ(latency.bucket(i), kExpected[i]);
+  }
+
+  group.Dump();
+}
+
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+
+TEST(Histogram, GenerationTracksChanges) {
+  PW_METRIC_GROUP(group, "generations");
+  PW_METRIC_HISTOGRAM(group, histogram, "histogram", 4, 0);
+
+  // Registered histograms start in the current generation.
+  const uint32_t created = CurrentGeneration();
+  EXPECT_EQ(created, histogram.generation());
+
+  const uint32_t next = AdvanceGeneration();
+  histogram.Record(2);
+  EXPECT_EQ(next, histogram.generation());
+}
+
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+
+TEST(Metric, GenerationTracksChanges) {
+  PW_METRIC_GROUP(group, "generations");
+  PW_METRIC(group, counter, "counter", 0u);
+  PW_METRIC(group, ratio, "ratio", 0.5f);
+
+  // Registered metrics start in the current generation.
+  const uint32_t created = CurrentGeneration();
+  EXPECT_EQ(created, counter.generation());
+  EXPECT_EQ(created, ratio.generation());
+
+  const uint32_t next = AdvanceGeneration();
+  EXPECT_EQ(created + 1, next);
+  EXPECT_EQ(next, CurrentGeneration());
+
+  counter.Increment();
+  EXPECT_EQ(next, counter.generation());
+  EXPECT_EQ(created, ratio.generation());
+
+  AdvanceGeneration();
+  ratio.Set(0.25f);
+  EXPECT_EQ(next, counter.generation());
+  EXPECT_EQ(next + 1, ratio.generation());
+}
+
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+
 // The below are compile tests to ensure the macros work at global scope.
 
 // Case 1: No group specified.
@@ -96,6 +258,17 @@ PW_METRIC_GROUP(global_group, "a_global_group");
 PW_METRIC(global_group, global_z, "global_x", 5555u);
 PW_METRIC(global_group, global_w, "global_y", 6.0f);
 
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+PW_METRIC_HISTOGRAM(global_group, global_h, "global_h", 16, 2);
+
+// Case 3: Histogram without a group.
+PW_METRIC_HISTOGRAM(global_v, "global_v", 4, 0);
+
+// Case 4: Atomic metrics.
+PW_METRIC_ATOMIC(global_a, "global_a", 5555u);
+PW_METRIC_ATOMIC(global_group, global_b, "global_b", 6.0f);
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+
 // A fake object to illustrate the API and show nesting metrics.
 // This also tests creating metrics as members inside a class.
 class I2cBus {
@@ -0,0 +1,26 @@
+// Copyright 2026 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// PW_METRIC_CONFIG_TRACK_GENERATIONS controls whether metrics and histograms
+// record the generation in which they last changed, so MetricService.Walk can
+// return only the metrics that changed since an earlier walk. This adds 4 bytes
+// to every metric and histogram; a metric is 16 bytes on 32-bit platforms with
+// it, and 12 bytes without.
+//
+// If disabled, every metric reports the current generation as the one in which
+// it last changed, so incremental walks return every metric.
+#ifndef PW_METRIC_CONFIG_TRACK_GENERATIONS
+#define PW_METRIC_CONFIG_TRACK_GENERATIONS 1
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
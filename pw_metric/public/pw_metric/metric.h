@@ -14,11 +14,20 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <limits>
+#include <type_traits>
 
+#include "lib/stdcompat/bit.h"
 #include "pw_containers/intrusive_list.h"
+#include "pw_metric/config.h"
 #include "pw_preprocessor/arguments.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_span/span.h"
 #include "pw_tokenizer/tokenize.h"
 
 namespace pw::metric {
@@ -29,13 +38,88 @@ using tokenizer::Token;
 
 #define _PW_METRIC_TOKEN_MASK 0x7fffffff
 
+// 1 if the target has lock-free 32-bit atomics, including read-modify-write
+// operations, so AtomicMetric and Histogram are available; 0 otherwise (e.g.
+// on ARMv6-M). Code that must build for every target can check this.
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2
+#define PW_METRIC_ATOMICS_ARE_LOCK_FREE 1
+#else
+#define PW_METRIC_ATOMICS_ARE_LOCK_FREE 0
+#endif  // __GCC_ATOMIC_INT_LOCK_FREE == 2
+
+namespace internal {
+
+// The generation stamped on metrics and histograms when they change.
+extern std::atomic<uint32_t> current_generation;
+
+// Changes each time a metric, histogram, or group is added to a list, which
+// may move existing entries to other positions in walk order.
+extern std::atomic<uint32_t> tree_version;
+
+inline uint32_t TreeVersion() {
+  return tree_version.load(std::memory_order_relaxed);
+}
+
+// Like the tree itself, the version is not updated atomically, so adding to the
+// tree must be synchronized.
+inline void TreeChanged() {
+  tree_version.store(TreeVersion() + 1, std::memory_order_relaxed);
+}
+
+}  // namespace internal
+
+// Metrics and histograms record the generation in which they last changed.
+// Exporters start a new generation each time they take a snapshot, so a later
+// export can skip everything that has not changed since.
+//
+// Returns the current generation, which starts at 0.
+inline uint32_t CurrentGeneration() {
+  return internal::current_generation.load(std::memory_order_relaxed);
+}
+
+// Starts a new generation and returns it. Metrics changed after this call are
+// stamped with the returned generation or a later one.
+//
+// Must not be called concurrently with itself. This avoids an atomic
+// read-modify-write, which some targets (e.g. ARMv6-M) lack.
+inline uint32_t AdvanceGeneration() {
+  const uint32_t generation = CurrentGeneration() + 1;
+  internal::current_generation.store(generation, std::memory_order_relaxed);
+  return generation;
+}
+
+namespace internal {
+
+// See PW_METRIC_ATOMICS_ARE_LOCK_FREE.
+inline constexpr bool kLockFreeAtomics = PW_METRIC_ATOMICS_ARE_LOCK_FREE;
+static_assert(!kLockFreeAtomics || std::atomic<uint32_t>::is_always_lock_free);
+
+// Saturating atomic add. Results in the max value if the addition would
+// overflow.
+inline void SaturatingAdd(std::atomic<uint32_t>& counter, uint32_t amount) {
+  uint32_t value = counter.load(std::memory_order_relaxed);
+  uint32_t sum;
+  do {
+    if (PW_ADD_OVERFLOW(value, amount, &sum)) {
+      sum = std::numeric_limits<uint32_t>::max();
+    }
+  } while (!counter.compare_exchange_weak(
+      value, sum, std::memory_order_relaxed));
+}
+
+}  // namespace internal
+
 // An individual metric. There are only two supported types: uint32_t and
 // float. More complicated compound metrics can be built on these primitives.
 // See the documentation for a discussion for this design was selected.
 //
-// Size: 12 bytes / 96 bits - next, name, value.
+// Size: 16 bytes / 128 bits - next, name, value, generation. 12 bytes if
+// PW_METRIC_CONFIG_TRACK_GENERATIONS is disabled.
+//
+// Updates through TypedMetric are not atomic. AtomicMetric updates the same
+// value atomically, for metrics that are updated from multiple threads or from
+// interrupts.
 //
-// TODO(keir): Implement Set() and Increment() using atomics.
 // TODO(keir): Consider an alternative structure where metrics have pointers to
 // parent groups, which would enable (1) safe destruction and (2) safe static
 // initialization, but at the cost of an additional 4 bytes per metric and 4
@@ -50,6 +134,18 @@ class Metric : public IntrusiveList<Metric>::Item {
   float as_float() const;
   uint32_t as_int() const;
 
+  // Returns the generation in which the metric was last changed, or in which it
+  // was registered if it has not changed since. Statically constructed metrics
+  // start at generation 0. Always the current generation if
+  // PW_METRIC_CONFIG_TRACK_GENERATIONS is disabled.
+  uint32_t generation() const {
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+    return generation_.load(std::memory_order_relaxed);
+#else
+    return CurrentGeneration();
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+  }
+
   // Dump a metric or metrics to logs. Level determines the indentation
   // indent_level up to a maximum of 4. Example output:
   //
@@ -88,16 +184,75 @@ class Metric : public IntrusiveList<Metric>::Item {
 
   void SetFloat(float value);
 
+  // Atomic versions of the mutation methods, for AtomicMetric. They use relaxed
+  // memory ordering; a metric does not order other memory accesses. They are
+  // defined inline so they are only compiled for targets that use them.
+  void AtomicIncrement(uint32_t amount) {
+    uint32_t value = __atomic_load_n(&uint_, __ATOMIC_RELAXED);
+    uint32_t sum;
+    do {
+      if (PW_ADD_OVERFLOW(value, amount, &sum)) {
+        sum = std::numeric_limits<uint32_t>::max();
+      }
+    } while (!__atomic_compare_exchange_n(
+        &uint_, &value, sum, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    MarkChanged();
+  }
+
+  void AtomicDecrement(uint32_t amount) {
+    uint32_t value = __atomic_load_n(&uint_, __ATOMIC_RELAXED);
+    uint32_t difference;
+    do {
+      if (PW_SUB_OVERFLOW(value, amount, &difference)) {
+        difference = 0;
+      }
+    } while (!__atomic_compare_exchange_n(
+        &uint_, &value, difference, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    MarkChanged();
+  }
+
+  void AtomicSetInt(uint32_t value) {
+    __atomic_store_n(&uint_, value, __ATOMIC_RELAXED);
+    MarkChanged();
+  }
+
+  void AtomicSetFloat(float value) {
+    __atomic_store(&float_, &value, __ATOMIC_RELAXED);
+    MarkChanged();
+  }
+
+  uint32_t atomic_as_int() const {
+    return __atomic_load_n(&uint_, __ATOMIC_RELAXED);
+  }
+
+  float atomic_as_float() const {
+    float value;
+    __atomic_load(&float_, &value, __ATOMIC_RELAXED);
+    return value;
+  }
+
  private:
+  void MarkChanged() {
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+    generation_.store(CurrentGeneration(), std::memory_order_relaxed);
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+  }
+
   // The name of this metric as a token; from PW_TOKENIZE_STRING("my_metric").
   // Last bit of the token is used to store int or float; 0 == int, 1 == float.
   Token name_and_type_;
 
+  // AtomicMetric accesses these with the compiler's atomic builtins, as
+  // std::atomic_ref would, so plain metrics don't pay for atomics.
   union {
     float float_;
     uint32_t uint_;
   };
 
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+  std::atomic<uint32_t> generation_{0};
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+
   enum : uint32_t {
     kTokenMask = _PW_METRIC_TOKEN_MASK,  // 0x7fff'ffff
     kTypeMask = 0x8000'0000,
@@ -154,9 +309,216 @@ uint32_t as_int() const { return 0; }
 }
 ;
 
-// A metric tree; consisting of children groups and leaf metrics.
+// Metrics whose updates are atomic, so they can be updated from multiple
+// threads and from interrupts without a lock. They are Metrics, so they are
+// added to groups and exported like other metrics. Integer metrics saturate at
+// 0 and the maximum uint32_t value, like TypedMetric<uint32_t>.
 //
-// Size: 16 bytes/128 bits - next, name, metrics, children.
+// Only available on targets with lock-free 32-bit atomics. On other targets
+// (e.g. ARMv6-M), atomic read-modify-write operations require a libatomic, so
+// use TypedMetric and synchronize updates instead.
+template <typename T, bool kLockFree = internal::kLockFreeAtomics>
+class AtomicMetric {
+  static_assert(kLockFree,
+                "AtomicMetric requires lock-free 32-bit atomics; use "
+                "TypedMetric and synchronize updates instead");
+  static_assert(std::is_same_v<T, uint32_t> || std::is_same_v<T, float>,
+                "AtomicMetric only supports uint32_t and float");
+};
+
+// An atomic metric for floats. As with TypedMetric<float>, there is no
+// Increment().
+template <>
+class AtomicMetric<float, true> : public Metric {
+ public:
+  constexpr AtomicMetric(Token name, float value) : Metric(name, value) {}
+  AtomicMetric(Token name, float value, IntrusiveList<Metric>& metrics)
+      : Metric(name, value, metrics) {}
+
+  void Set(float value) { AtomicSetFloat(value); }
+  float value() const { return atomic_as_float(); }
+
+ private:
+  // Shadow these accessors to hide them on the typed version of Metric.
+  float as_float() const { return 0.0; }
+  uint32_t as_int() const { return 0; }
+};
+
+// An atomic metric for uint32_ts. Offers both Set() and Increment().
+template <>
+class AtomicMetric<uint32_t, true> : public Metric {
+ public:
+  constexpr AtomicMetric(Token name, uint32_t value) : Metric(name, value) {}
+  AtomicMetric(Token name, uint32_t value, IntrusiveList<Metric>& metrics)
+      : Metric(name, value, metrics) {}
+
+  void Increment(uint32_t amount = 1u) { AtomicIncrement(amount); }
+  void Decrement(uint32_t amount = 1u) { AtomicDecrement(amount); }
+  void Set(uint32_t value) { AtomicSetInt(value); }
+  uint32_t value() const { return atomic_as_int(); }
+
+ private:
+  // Shadow these accessors to hide them on the typed version of Metric.
+  float as_float() const { return 0.0; }
+  uint32_t as_int() const { return 0; }
+};
+
+// A histogram of uint32_t values, counted in fixed log-linear buckets. Values
+// below 2^sub_bucket_bits each have their own bucket. Above that, each power of
+// two is split into 2^sub_bucket_bits equally sized buckets, so the bucket
+// width is at most 1/2^sub_bucket_bits of the values it holds. The last bucket
+// also counts every value larger than its lower bound.
+//
+// For example, with sub_bucket_bits = 1 the buckets start at:
+//
+//   0, 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, ...
+//
+// Recording a value is a single atomic increment, so histograms can be updated
+// from hot paths, multiple threads, and interrupts without a lock. Percentiles
+// are computed off-device from the exported bucket counts. Like AtomicMetric,
+// histograms are only available on targets with lock-free 32-bit atomics.
+//
+// Declare histograms with PW_METRIC_HISTOGRAM, which creates a TypedHistogram
+// holding the buckets.
+//
+// Size: 24 bytes + 4 bytes per bucket - next, name, sub_bucket_bits, buckets,
+// generation. 4 bytes less if PW_METRIC_CONFIG_TRACK_GENERATIONS is disabled.
+class Histogram : public IntrusiveList<Histogram>::Item {
+ public:
+  // The maximum number of buckets in a histogram. Limited by the size of the
+  // histogram message exported by the metric service.
+  static constexpr size_t kMaxBuckets = 32;
+
+  // Returns the index of the bucket that counts the value, for a histogram
+  // with an unlimited number of buckets.
+  static constexpr size_t BucketIndex(uint32_t value, uint8_t sub_bucket_bits) {
+    const uint32_t linear_buckets = uint32_t{1} << sub_bucket_bits;
+    if (value < linear_buckets) {
+      return value;
+    }
+    const int shift =
+        static_cast<int>(cpp20::bit_width(value)) - 1 - sub_bucket_bits;
+    return (static_cast<size_t>(shift + 1) << sub_bucket_bits) +
+           ((value >> shift) - linear_buckets);
+  }
+
+  // Returns the smallest value counted in the bucket.
+  static constexpr uint32_t BucketLowerBound(size_t index,
+                                             uint8_t sub_bucket_bits) {
+    const uint32_t linear_buckets = uint32_t{1} << sub_bucket_bits;
+    if (index < linear_buckets) {
+      return static_cast<uint32_t>(index);
+    }
+    const size_t shift = (index >> sub_bucket_bits) - 1;
+    const uint32_t sub_bucket =
+        static_cast<uint32_t>(index) & (linear_buckets - 1);
+    return (linear_buckets + sub_bucket) << shift;
+  }
+
+  Token name() const { return name_; }
+  uint8_t sub_bucket_bits() const { return sub_bucket_bits_; }
+  size_t bucket_count() const { return buckets_.size(); }
+
+  // Returns the number of values counted in the bucket.
+  uint32_t bucket(size_t index) const {
+    return buckets_[index].load(std::memory_order_relaxed);
+  }
+
+  // Returns the generation in which a value was last recorded, or in which the
+  // histogram was registered if none has been recorded since. Always the
+  // current generation if PW_METRIC_CONFIG_TRACK_GENERATIONS is disabled.
+  uint32_t generation() const {
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+    return generation_.load(std::memory_order_relaxed);
+#else
+    return CurrentGeneration();
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+  }
+
+  // Counts the value in its bucket. Bucket counts saturate at the maximum
+  // uint32_t value. Defined inline so it is only compiled for targets that use
+  // it.
+  void Record(uint32_t value) {
+    const size_t index =
+        std::min(BucketIndex(value, sub_bucket_bits_), buckets_.size() - 1);
+    internal::SaturatingAdd(buckets_[index], 1);
+    MarkChanged();
+  }
+
+  // Dump a histogram or histograms to logs, listing the lower bound and count
+  // of each non-empty bucket. Example output:
+  //
+  //   "$X6ibyA==": {
+  //     "4": 2,
+  //     "12": 1,
+  //   }
+  void Dump(int indent_level = 0);
+  static void Dump(IntrusiveList<Histogram>& histograms, int indent_level = 0);
+
+  // Disallow copy and assign.
+  Histogram(Histogram const&) = delete;
+  void operator=(const Histogram&) = delete;
+
+ protected:
+  constexpr Histogram(Token name,
+                      uint8_t sub_bucket_bits,
+                      span<std::atomic<uint32_t>> buckets)
+      : name_(name), sub_bucket_bits_(sub_bucket_bits), buckets_(buckets) {}
+
+  Histogram(Token name,
+            uint8_t sub_bucket_bits,
+            span<std::atomic<uint32_t>> buckets,
+            IntrusiveList<Histogram>& histograms);
+
+ private:
+  void MarkChanged() {
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+    generation_.store(CurrentGeneration(), std::memory_order_relaxed);
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+  }
+
+  Token name_;
+  uint8_t sub_bucket_bits_;
+  span<std::atomic<uint32_t>> buckets_;
+#if PW_METRIC_CONFIG_TRACK_GENERATIONS
+  std::atomic<uint32_t> generation_{0};
+#endif  // PW_METRIC_CONFIG_TRACK_GENERATIONS
+};
+
+namespace internal {
+
+// Holds the buckets of a TypedHistogram, so they are constructed before the
+// Histogram base that refers to them.
+template <size_t kBucketCount>
+class HistogramStorage {
+ protected:
+  std::array<std::atomic<uint32_t>, kBucketCount> storage_{};
+};
+
+}  // namespace internal
+
+// A histogram with storage for its buckets.
+template <size_t kBucketCount,
+          uint8_t kSubBucketBits,
+          bool kLockFree = internal::kLockFreeAtomics>
+class TypedHistogram : private internal::HistogramStorage<kBucketCount>,
+                       public Histogram {
+ public:
+  static_assert(kLockFree,
+                "Histograms require lock-free 32-bit atomics; use TypedMetric "
+                "and synchronize updates instead");
+  static_assert(kBucketCount > 0 && kBucketCount <= kMaxBuckets);
+  static_assert(kSubBucketBits < 32);
+
+  TypedHistogram(Token name)
+      : Histogram(name, kSubBucketBits, this->storage_) {}
+  TypedHistogram(Token name, IntrusiveList<Histogram>& histograms)
+      : Histogram(name, kSubBucketBits, this->storage_, histograms) {}
+};
+
+// A metric tree; consisting of children groups, leaf metrics, and histograms.
+//
+// Size: 20 bytes/160 bits - next, name, metrics, histograms, children.
 class Group : public IntrusiveList<Group>::Item {
  public:
   constexpr Group(Token name) : name_(name) {}
@@ -164,13 +526,25 @@ class Group : public IntrusiveList<Group>::Item {
 
   Token name() const { return name_; }
 
-  void Add(Metric& metric) { metrics_.push_front(metric); }
-  void Add(Group& group) { children_.push_front(group); }
+  void Add(Metric& metric) {
+    metrics_.push_front(metric);
+    internal::TreeChanged();
+  }
+  void Add(Histogram& histogram) {
+    histograms_.push_front(histogram);
+    internal::TreeChanged();
+  }
+  void Add(Group& group) {
+    children_.push_front(group);
+    internal::TreeChanged();
+  }
 
   IntrusiveList<Metric>& metrics() { return metrics_; }
+  IntrusiveList<Histogram>& histograms() { return histograms_; }
   IntrusiveList<Group>& children() { return children_; }
 
   const IntrusiveList<Metric>& metrics() const { return metrics_; }
+  const IntrusiveList<Histogram>& histograms() const { return histograms_; }
   const IntrusiveList<Group>& children() const { return children_; }
 
   // Dump a metric group or groups to logs. Level determines the indentation
@@ -201,6 +575,7 @@ class Group : public IntrusiveList<Group>::Item {
   Token name_;
 
   IntrusiveList<Metric> metrics_;
+  IntrusiveList<Histogram> histograms_;
   IntrusiveList<Group> children_;
 };
 
@@ -280,6 +655,70 @@ class Group : public IntrusiveList<Group>::Item {
   static_def ::pw::metric::TypedMetric<_PW_METRIC_FLOAT_OR_UINT32(init)>      \
       variable_name = {variable_name##_token, init, group.metrics()}
 
+// Declare an atomic metric, optionally adding it to a group. Works like
+// PW_METRIC, but declares an AtomicMetric, whose updates are safe from multiple
+// threads and from interrupts. Use:
+//
+//   PW_METRIC_ATOMIC(variable_name, metric_name, value)
+//   PW_METRIC_ATOMIC(group, variable_name, metric_name, value)
+//
+#define PW_METRIC_ATOMIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_ATOMIC_, , __VA_ARGS__)
+#define PW_METRIC_ATOMIC_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_ATOMIC_, static, __VA_ARGS__)
+
+// Case: PW_METRIC_ATOMIC(name, initial_value)
+#define _PW_METRIC_ATOMIC_4(static_def, variable_name, metric_name, init)     \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::AtomicMetric<_PW_METRIC_FLOAT_OR_UINT32(init)>     \
+      variable_name = {variable_name##_token, init}
+
+// Case: PW_METRIC_ATOMIC(group, name, initial_value)
+#define _PW_METRIC_ATOMIC_5(                                                  \
+    static_def, group, variable_name, metric_name, init)                      \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_MASK("metrics", _PW_METRIC_TOKEN_MASK, metric_name); \
+  static_def ::pw::metric::AtomicMetric<_PW_METRIC_FLOAT_OR_UINT32(init)>     \
+      variable_name = {variable_name##_token, init, group.metrics()}
+
+// Declare a histogram, optionally adding it to a group. Use:
+//
+//   PW_METRIC_HISTOGRAM(variable_name, metric_name, buckets, sub_bucket_bits)
+//   PW_METRIC_HISTOGRAM(group, variable_name, metric_name, buckets,
+//                       sub_bucket_bits)
+//
+// - buckets is the number of buckets, up to Histogram::kMaxBuckets.
+// - sub_bucket_bits sets the resolution; see Histogram.
+//
+// Works in the same contexts as PW_METRIC. Example:
+//
+//   PW_METRIC_GROUP(my_group, "my_group_name_here");
+//   PW_METRIC_HISTOGRAM(my_group, latency_us_, "latency_us", 32, 1);
+//
+//   latency_us_.Record(elapsed_us);
+//
+#define PW_METRIC_HISTOGRAM(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_HISTOGRAM_, , __VA_ARGS__)
+#define PW_METRIC_HISTOGRAM_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_HISTOGRAM_, static, __VA_ARGS__)
+
+// Case: PW_METRIC_HISTOGRAM(name, buckets, sub_bucket_bits)
+#define _PW_METRIC_HISTOGRAM_5(                                      \
+    static_def, variable_name, metric_name, buckets, sub_bucket_bits) \
+  static constexpr uint32_t variable_name##_token =                  \
+      PW_TOKENIZE_STRING_DOMAIN("metrics", metric_name);             \
+  static_def ::pw::metric::TypedHistogram<buckets, sub_bucket_bits>  \
+      variable_name = {variable_name##_token}
+
+// Case: PW_METRIC_HISTOGRAM(group, name, buckets, sub_bucket_bits)
+#define _PW_METRIC_HISTOGRAM_6(                                             \
+    static_def, group, variable_name, metric_name, buckets, sub_bucket_bits) \
+  static constexpr uint32_t variable_name##_token =                         \
+      PW_TOKENIZE_STRING_DOMAIN("metrics", metric_name);                    \
+  static_def ::pw::metric::TypedHistogram<buckets, sub_bucket_bits>         \
+      variable_name = {variable_name##_token, group.histograms()}
+
 // Define a metric group. Works like PW_METRIC, and works in the same contexts.
 //
 // Example:
@@ -28,9 +28,11 @@ namespace pw::metric {
 // of subgroups. In the future, filtering will be supported.
 //
 // An important limitation of the current implementation is that the Get()
-// method is blocking, and sends all metrics at once (though batched). In the
-// future, we may switch to offering an async version where the Get() method
-// returns immediately, and someone else is responsible for pumping the queue.
+// method is blocking, and sends all metrics at once (though batched). Walk()
+// avoids this by returning one packet of metrics per call; the client resumes
+// the walk with the returned cursor, and may ask for only the metrics that
+// changed since an earlier walk. A walk fails with ABORTED if the metric tree
+// changed since it started, and must be restarted.
 class MetricService final
     : public proto::pw_rpc::nanopb::MetricService::Service<MetricService> {
  public:
@@ -41,6 +43,9 @@ class MetricService final
   void Get(const pw_metric_proto_MetricRequest& request,
            ServerWriter<pw_metric_proto_MetricResponse>& response);
 
+  Status Walk(const pw_metric_proto_WalkRequest& request,
+              pw_metric_proto_WalkResponse& response);
+
  private:
   const IntrusiveList<Metric>& metrics_;
   const IntrusiveList<Group>& groups_;
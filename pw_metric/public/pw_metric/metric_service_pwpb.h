@@ -19,6 +19,7 @@
 #include "pw_containers/intrusive_list.h"
 #include "pw_metric/metric.h"
 #include "pw_metric_proto/metric_service.raw_rpc.pb.h"
+#include "pw_rpc/channel.h"
 #include "pw_rpc/raw/server_reader_writer.h"
 #include "pw_span/span.h"
 
@@ -30,21 +31,31 @@ namespace pw::metric {
 // of subgroups. In the future, filtering will be supported.
 //
 // An important limitation of the current implementation is that the Get()
-// method is blocking, and sends all metrics at once (though batched). In the
-// future, we may switch to offering an async version where the Get() method
-// returns immediately, and someone else is responsible for pumping the queue.
+// method is blocking, and sends all metrics at once (though batched). Walk()
+// avoids this by returning one packet of metrics per call; the client resumes
+// the walk with the returned cursor, and may ask for only the metrics that
+// changed since an earlier walk. A walk fails with ABORTED if the metric tree
+// changed since it started, and must be restarted.
 class MetricService final
     : public proto::pw_rpc::raw::MetricService::Service<MetricService> {
  public:
+  // Walk() responses are limited to max_walk_response_size bytes, or the RPC
+  // payload size if that is smaller. Lower it for transports with a small MTU.
   MetricService(const IntrusiveList<Metric>& metrics,
-                const IntrusiveList<Group>& groups)
-      : metrics_(metrics), groups_(groups) {}
+                const IntrusiveList<Group>& groups,
+                size_t max_walk_response_size = rpc::MaxSafePayloadSize())
+      : metrics_(metrics),
+        groups_(groups),
+        max_walk_response_size_(max_walk_response_size) {}
 
   void Get(ConstByteSpan request, rpc::RawServerWriter& response);
 
+  void Walk(ConstByteSpan request, rpc::RawUnaryResponder& responder);
+
  private:
   const IntrusiveList<Metric>& metrics_;
   const IntrusiveList<Group>& groups_;
+  const size_t max_walk_response_size_;
 };
 
 }  // namespace pw::metric
@@ -13,6 +13,9 @@
 // the License.
 #pragma once
 
+#include <cstdint>
+#include <optional>
+
 #include "pw_assert/check.h"
 #include "pw_containers/intrusive_list.h"
 #include "pw_containers/vector.h"
@@ -26,6 +29,91 @@ class MetricWriter {
  public:
   virtual ~MetricWriter() = default;
   virtual Status Write(const Metric& metric, const Vector<Token>& path) = 0;
+  virtual Status Write(const Histogram& histogram,
+                       const Vector<Token>& path) = 0;
+};
+
+// A MetricWriter that writes one page of a paginated walk. Metrics and
+// histograms are numbered by their position in the walk. The page starts at the
+// position given by the cursor, skips entries that have not changed since a
+// generation, and ends when the derived writer runs out of space.
+//
+// Adding to the tree moves entries to other positions, so a cursor also holds
+// the tree version from when its walk started. A walk can only be continued
+// from a cursor whose tree version is current; otherwise it must be restarted.
+class PagedMetricWriter : public MetricWriter {
+ public:
+  // Returns the cursor that starts a walk of the tree as it is now.
+  static uint64_t FirstCursor() { return uint64_t{TreeVersion()} << 32; }
+
+  // Returns whether a walk can be continued from the cursor, i.e. whether the
+  // tree has not changed since the walk started.
+  static bool IsCurrent(uint64_t cursor) {
+    return static_cast<uint32_t>(cursor >> 32) == TreeVersion();
+  }
+
+  PagedMetricWriter(uint64_t cursor, uint32_t since_generation)
+      : tree_version_(cursor & ~uint64_t{0xffff'ffff}),
+        cursor_(static_cast<uint32_t>(cursor)),
+        since_generation_(since_generation) {}
+
+  Status Write(const Metric& metric, const Vector<Token>& path) final {
+    return WriteEntry(metric, path);
+  }
+
+  Status Write(const Histogram& histogram, const Vector<Token>& path) final {
+    return WriteEntry(histogram, path);
+  }
+
+  // Returns the cursor to resume the walk from if the page filled up, or
+  // std::nullopt if the walk reached the end of the tree.
+  std::optional<uint64_t> next_cursor() const {
+    if (!next_position_.has_value()) {
+      return std::nullopt;
+    }
+    return tree_version_ | *next_position_;
+  }
+
+  // Returns the number of entries written to the page.
+  size_t entries_written() const { return entries_written_; }
+
+ protected:
+  // Writes an entry to the page.
+  //
+  // Return values:
+  //
+  //   OK - The entry was written.
+  //   RESOURCE_EXHAUSTED - The page is full; the entry was not written. Ends
+  //       the page and the walk.
+  //
+  virtual Status WriteToPage(const Metric& metric,
+                             const Vector<Token>& path) = 0;
+  virtual Status WriteToPage(const Histogram& histogram,
+                             const Vector<Token>& path) = 0;
+
+ private:
+  template <typename Entry>
+  Status WriteEntry(const Entry& entry, const Vector<Token>& path) {
+    if (position_ >= cursor_ && entry.generation() >= since_generation_) {
+      if (Status status = WriteToPage(entry, path); !status.ok()) {
+        if (status.IsResourceExhausted()) {
+          next_position_ = position_;
+        }
+        return status;
+      }
+      entries_written_ += 1;
+    }
+    position_ += 1;
+    return OkStatus();
+  }
+
+  // The tree version, in the upper half of the cursor.
+  const uint64_t tree_version_;
+  const uint32_t cursor_;
+  const uint32_t since_generation_;
+  uint32_t position_ = 0;
+  size_t entries_written_ = 0;
+  std::optional<uint32_t> next_position_;
 };
 
 // Walk a metric tree recursively; passing metrics with their path (names) to a
@@ -42,6 +130,14 @@ class MetricWalker {
     return OkStatus();
   }
 
+  Status Walk(const IntrusiveList<Histogram>& histograms) {
+    for (const auto& h : histograms) {
+      ScopedName scoped_name(h.name(), *this);
+      PW_TRY(writer_.Write(h, path_));
+    }
+    return OkStatus();
+  }
+
   Status Walk(const IntrusiveList<Group>& groups) {
     for (const auto& g : groups) {
       PW_TRY(Walk(g));
@@ -53,6 +149,7 @@ class MetricWalker {
     ScopedName scoped_name(group.name(), *this);
     PW_TRY(Walk(group.children()));
     PW_TRY(Walk(group.metrics()));
+    PW_TRY(Walk(group.histograms()));
     return OkStatus();
   }
 
@@ -14,7 +14,11 @@
 # the License.
 """Tests for retreiving and parsing metrics."""
 from unittest import TestCase, mock, main
-from pw_metric.metric_parser import parse_metrics
+from pw_metric.metric_parser import (
+    bucket_lower_bound,
+    parse_metrics,
+    walk_metrics,
+)
 
 from pw_metric_proto import metric_service_pb2
 from pw_status import Status
@@ -26,6 +30,7 @@ DATABASE = tokens.Database(
         tokens.TokenizedStringEntry(0x03796798, "min_queue_remaining"),
         tokens.TokenizedStringEntry(0x22198280, "total_created"),
         tokens.TokenizedStringEntry(0x534A42F4, "max_queue_used"),
+        tokens.TokenizedStringEntry(0x5A3C2E1F, "flush_latency_us"),
         tokens.TokenizedStringEntry(0x5D087463, "pw::work_queue::WorkQueue"),
         tokens.TokenizedStringEntry(0xA7C43965, "log"),
     ]
@@ -292,6 +297,126 @@ class TestParseMetrics(TestCase):
         parse_metrics(self.rpcs, self.detokenize, self.rpc_timeout_s)
         self.assertRaises(ValueError, msg='Expected Value Error.')
 
+    def test_bucket_lower_bound(self) -> None:
+        """Tests bucket bounds match the device's bucketing."""
+        self.assertEqual(
+            [0, 1, 2, 4, 8, 16],
+            [bucket_lower_bound(i, 0) for i in range(6)],
+        )
+        self.assertEqual(
+            [0, 1, 2, 3, 4, 6, 8, 12, 16],
+            [bucket_lower_bound(i, 1) for i in range(9)],
+        )
+
+    def test_histogram(self) -> None:
+        """Tests a histogram is summarized with percentiles."""
+        histogram_metric = [
+            metric_service_pb2.Metric(
+                token_path=[self.log, 0x5A3C2E1F],
+                string_path='N/A',
+                as_histogram=metric_service_pb2.Histogram(
+                    sub_bucket_bits=0,
+                    bucket_counts=[0, 50, 40, 0, 9, 1],
+                ),
+            ),
+        ]
+        self.rpcs.pw.metric.proto.MetricService.Get.return_value.responses = [
+            metric_service_pb2.MetricResponse(metrics=histogram_metric),
+        ]
+        self.assertEqual(
+            {
+                'log': {
+                    'flush_latency_us': {
+                        'count': 100,
+                        'buckets': {'1': 50, '2': 40, '8': 9, '16': 1},
+                        'p50': 1,
+                        'p90': 2,
+                        'p99': 8,
+                    },
+                },
+            },
+            parse_metrics(self.rpcs, self.detokenize, self.rpc_timeout_s),
+            msg='Histogram summaries are not equal.',
+        )
+
+    def test_walk_metrics(self) -> None:
+        """Tests a walk is resumed from the cursor until it is done."""
+        walk = self.rpcs.pw.metric.proto.MetricService.Walk
+        walk.side_effect = [
+            (
+                Status.OK,
+                metric_service_pb2.WalkResponse(
+                    metrics=self.metric[:1], generation=7, cursor=1
+                ),
+            ),
+            (
+                Status.OK,
+                metric_service_pb2.WalkResponse(
+                    metrics=self.metric[1:], done=True
+                ),
+            ),
+        ]
+        self.assertEqual(
+            (
+                {
+                    'log': {
+                        'total_created': 3.0,
+                        'total_dropped': 4.0,
+                    },
+                },
+                7,
+            ),
+            walk_metrics(
+                self.rpcs,
+                self.detokenize,
+                self.rpc_timeout_s,
+                since_generation=5,
+            ),
+        )
+        walk.assert_any_call(pw_rpc_timeout_s=1, since_generation=5)
+        walk.assert_any_call(pw_rpc_timeout_s=1, cursor=1, since_generation=5)
+
+    def test_walk_metrics_restarts_if_aborted(self) -> None:
+        """Tests a walk is restarted if the metric tree changed."""
+        walk = self.rpcs.pw.metric.proto.MetricService.Walk
+        walk.side_effect = [
+            (
+                Status.OK,
+                metric_service_pb2.WalkResponse(
+                    metrics=self.metric[:1], generation=7, cursor=1
+                ),
+            ),
+            (Status.ABORTED, None),
+            (
+                Status.OK,
+                metric_service_pb2.WalkResponse(
+                    metrics=self.metric, generation=8, done=True
+                ),
+            ),
+        ]
+        self.assertEqual(
+            (
+                {
+                    'log': {
+                        'total_created': 3.0,
+                        'total_dropped': 4.0,
+                    },
+                },
+                8,
+            ),
+            walk_metrics(self.rpcs, self.detokenize, self.rpc_timeout_s),
+        )
+        self.assertEqual(3, walk.call_count)
+
+    def test_walk_metrics_bad_status(self) -> None:
+        """Tests a failed walk returns no generation."""
+        walk = self.rpcs.pw.metric.proto.MetricService.Walk
+        walk.return_value = (Status.ABORTED, None)
+        self.assertEqual(
+            ({}, None),
+            walk_metrics(self.rpcs, self.detokenize, self.rpc_timeout_s),
+        )
+
 
 if __name__ == '__main__':
     main()
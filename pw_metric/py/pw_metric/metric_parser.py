@@ -14,12 +14,18 @@
 """Tools to retrieve and parse metrics."""
 from collections import defaultdict
 import json
+import math
 import logging
 from typing import Any
+from pw_status import Status
 from pw_tokenizer import detokenize
 
 _LOG = logging.getLogger(__name__)
 
+# How many times to restart a walk that was aborted because the metric tree
+# changed while it was in progress.
+_MAX_WALK_RESTARTS = 3
+
 
 def _tree():
     """Creates a key based on given input."""
@@ -41,6 +47,79 @@ def _insert(metrics, path_names, value):
             metrics[path_name] = value
 
 
+def bucket_lower_bound(index: int, sub_bucket_bits: int) -> int:
+    """Returns the smallest value counted in a histogram bucket.
+
+    Matches pw::metric::Histogram::BucketLowerBound().
+    """
+    linear_buckets = 1 << sub_bucket_bits
+    if index < linear_buckets:
+        return index
+    shift = (index >> sub_bucket_bits) - 1
+    sub_bucket = index & (linear_buckets - 1)
+    return (linear_buckets + sub_bucket) << shift
+
+
+def _histogram_percentile(
+    lower_bounds: list[int], counts: list[int], percentile: float
+) -> int:
+    """Returns the lower bound of the bucket holding the given percentile."""
+    rank = max(1, math.ceil(sum(counts) * percentile / 100))
+    seen = 0
+    for lower_bound, count in zip(lower_bounds, counts):
+        seen += count
+        if seen >= rank:
+            return lower_bound
+    return lower_bounds[-1]
+
+
+def parse_histogram(histogram) -> dict[str, Any]:
+    """Summarizes a Histogram proto as a count, percentiles and buckets.
+
+    Percentiles are reported as the lower bound of the bucket they fall in.
+    """
+    counts = list(histogram.bucket_counts)
+    lower_bounds = [
+        bucket_lower_bound(i, histogram.sub_bucket_bits)
+        for i in range(len(counts))
+    ]
+    summary: dict[str, Any] = {
+        'count': sum(counts),
+        'buckets': {
+            str(lower_bound): count
+            for lower_bound, count in zip(lower_bounds, counts)
+            if count
+        },
+    }
+    if summary['count']:
+        for percentile in (50, 90, 99):
+            summary[f'p{percentile}'] = _histogram_percentile(
+                lower_bounds, counts, percentile
+            )
+    return summary
+
+
+def _insert_metric(metrics, detokenizer: detokenize.Detokenizer, metric):
+    """Detokenizes a metric's path and inserts its value in the tree."""
+    path_names = []
+    for path in metric.token_path:
+        path_name = str(
+            detokenize.DetokenizedString(
+                path, detokenizer.lookup(path), b'', False
+            )
+        ).strip('"')
+        path_names.append(path_name)
+    value: Any
+    if metric.HasField('as_histogram'):
+        value = parse_histogram(metric.as_histogram)
+    elif metric.HasField('as_float'):
+        value = metric.as_float
+    else:
+        value = metric.as_int
+    # inserting path_names into metrics.
+    _insert(metrics, path_names, value)
+
+
 def parse_metrics(
     rpcs: Any,
     detokenizer: detokenize.Detokenizer | None,
@@ -61,20 +140,62 @@ def parse_metrics(
         return metrics
     for metric_response in stream_response.responses:
         for metric in metric_response.metrics:
-            path_names = []
-            for path in metric.token_path:
-                path_name = str(
-                    detokenize.DetokenizedString(
-                        path, detokenizer.lookup(path), b'', False
-                    )
-                ).strip('"')
-                path_names.append(path_name)
-            value = (
-                metric.as_float
-                if metric.HasField('as_float')
-                else metric.as_int
-            )
-            # inserting path_names into metrics.
-            _insert(metrics, path_names, value)
+            _insert_metric(metrics, detokenizer, metric)
     # Converts default dict objects into standard dictionaries.
     return json.loads(json.dumps(metrics))
+
+
+def walk_metrics(
+    rpcs: Any,
+    detokenizer: detokenize.Detokenizer | None,
+    timeout_s: float | None,
+    since_generation: int | None = None,
+) -> tuple[dict, int | None]:
+    """Retrieves metrics one page at a time with MetricService.Walk.
+
+    Returns the metrics and the generation the walk started. Pass the
+    generation as since_generation to a later call to retrieve only the
+    metrics that changed since this one. The generation is None if the walk
+    failed.
+
+    If metrics are added to the device's metric tree during the walk, the
+    device aborts it, and the walk is restarted from the beginning.
+    """
+    metrics: defaultdict = _tree()
+    if not detokenizer:
+        _LOG.error('No metrics token database set.')
+        return metrics, None
+    walk = rpcs.pw.metric.proto.MetricService.Walk
+    generation = None
+    cursor = None
+    restarts = 0
+    while True:
+        request: dict[str, int] = {}
+        if cursor is not None:
+            request['cursor'] = cursor
+        if since_generation is not None:
+            request['since_generation'] = since_generation
+        status, response = walk(pw_rpc_timeout_s=timeout_s, **request)
+        if (
+            status is Status.ABORTED
+            and cursor is not None
+            and restarts < _MAX_WALK_RESTARTS
+        ):
+            _LOG.debug('Metric tree changed during the walk; restarting')
+            restarts += 1
+            metrics = _tree()
+            generation = None
+            cursor = None
+            continue
+        if not status.ok():
+            _LOG.error('Unexpected status %s', status)
+            return json.loads(json.dumps(metrics)), None
+        if response.HasField('generation'):
+            generation = response.generation
+        for metric in response.metrics:
+            _insert_metric(metrics, detokenizer, metric)
+        if not response.HasField('cursor'):
+            break
+        cursor = response.cursor
+    # Converts default dict objects into standard dictionaries.
+    return json.loads(json.dumps(metrics)), generation
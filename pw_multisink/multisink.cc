@@ -30,10 +30,43 @@ namespace multisink {
 void MultiSink::HandleEntry(ConstByteSpan entry) {
   std::lock_guard lock(lock_);
   const Status push_back_status = ring_buffer_.PushBack(entry, sequence_id_++);
-  PW_DCHECK_OK(push_back_status);
+  if (push_back_status.IsResourceExhausted()) {
+    // The space is held by outstanding reservations.
+    total_ingress_drops_++;
+  } else {
+    PW_DCHECK_OK(push_back_status);
+  }
   NotifyListeners();
 }
 
+Status MultiSink::Reserve(Reservation& reservation, size_t size_bytes) {
+  std::lock_guard lock(lock_);
+  const Status status = ring_buffer_.Reserve(
+      reservation.reservation_, size_bytes, sequence_id_);
+  if (status.IsInvalidArgument()) {
+    return status;
+  }
+  if (!status.ok()) {
+    // Let drains know that an entry was lost before it made it into the ring
+    // buffer.
+    sequence_id_++;
+    total_ingress_drops_++;
+    NotifyListeners();
+    return status;
+  }
+  reservation.sequence_id_ = sequence_id_++;
+  reservations_.push_back(reservation);
+  return OkStatus();
+}
+
+Status MultiSink::Commit(Reservation& reservation) {
+  std::lock_guard lock(lock_);
+  PW_TRY(ring_buffer_.Commit(reservation.reservation_));
+  reservations_.remove(reservation);
+  NotifyListeners();
+  return OkStatus();
+}
+
 void MultiSink::HandleDropped(uint32_t drop_count) {
   std::lock_guard lock(lock_);
   // Updating the sequence ID helps identify where the ingress drop happend when
@@ -96,7 +129,7 @@ Result<ConstByteSpan> MultiSink::PeekOrPopEntry(
   if (peek_status.IsOutOfRange()) {
     // If the drain has caught up, report the last handled sequence ID so that
     // it can still process any dropped entries.
-    entry_sequence_id_out = sequence_id_ - 1;
+    entry_sequence_id_out = CaughtUpSequenceId();
   } else if (!peek_status.ok()) {
     // Discard the entry if the result isn't OK or OUT_OF_RANGE and exit, as the
     // entry_sequence_id_out cannot be used for computation. Later invocations
@@ -105,6 +138,128 @@ Result<ConstByteSpan> MultiSink::PeekOrPopEntry(
     return peek_status;
   }
 
+  GetDropCounts(drain,
+                entry_sequence_id_out,
+                peek_status.ok(),
+                drain_drop_count_out,
+                ingress_drop_count_out);
+
+  // The Peek above may have failed due to OutOfRange, now that we've set the
+  // drop count see if we should return before attempting to pop.
+  if (peek_status.IsOutOfRange()) {
+    // No more entries, update the drain.
+    drain.last_handled_sequence_id_ = entry_sequence_id_out;
+    return peek_status;
+  }
+  if (request == Request::kPop) {
+    PW_CHECK(drain.reader_.PopFront().ok());
+    drain.last_handled_sequence_id_ = entry_sequence_id_out;
+  }
+  return as_bytes(buffer.first(bytes_read));
+}
+
+Result<MultiSink::Drain::PeekedEntries> MultiSink::PeekEntries(
+    Drain& drain,
+    ByteSpan buffer,
+    span<ConstByteSpan> entries_out,
+    uint32_t& drain_drop_count_out,
+    uint32_t& ingress_drop_count_out) {
+  size_t entry_count = 0;
+  size_t bytes_read = 0;
+  drain_drop_count_out = 0;
+  ingress_drop_count_out = 0;
+
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, this);
+
+  const Status peek_status = drain.reader_.PeekFrontEntries(
+      buffer, entries_out.size(), entry_count, bytes_read);
+  if (peek_status.IsOutOfRange()) {
+    const uint32_t sequence_id = CaughtUpSequenceId();
+    GetDropCounts(drain,
+                  sequence_id,
+                  false,
+                  drain_drop_count_out,
+                  ingress_drop_count_out);
+    drain.last_handled_sequence_id_ = sequence_id;
+    return peek_status;
+  }
+  if (peek_status.IsResourceExhausted()) {
+    // Discard the entry that doesn't fit, as PeekEntry() does. Later
+    // invocations will calculate the drop count.
+    PW_CHECK(drain.reader_.PopFront().ok());
+    return peek_status;
+  }
+  PW_TRY(peek_status);
+
+  // Split the copied entries, ending the run at the first gap in sequence IDs.
+  ConstByteSpan remaining = buffer.first(bytes_read);
+  uint32_t first_sequence_id = 0;
+  size_t run_length = 0;
+  for (; run_length < entry_count; ++run_length) {
+    size_t entry_bytes = 0;
+    const Result<ring_buffer::PrefixedEntryRingBufferMulti::Entry> entry =
+        ring_buffer_.DecodeEntry(remaining, entry_bytes);
+    PW_CHECK_OK(entry.status());
+    if (run_length == 0) {
+      first_sequence_id = entry->preamble;
+    } else if (entry->preamble !=
+               first_sequence_id + static_cast<uint32_t>(run_length)) {
+      break;
+    }
+    entries_out[run_length] = entry->buffer;
+    remaining = remaining.subspan(entry_bytes);
+  }
+
+  GetDropCounts(drain,
+                first_sequence_id,
+                true,
+                drain_drop_count_out,
+                ingress_drop_count_out);
+  return Drain::PeekedEntries(entries_out.first(run_length),
+                              first_sequence_id);
+}
+
+Status MultiSink::PopEntries(Drain& drain,
+                             const Drain::PeekedEntries& entries) {
+  if (entries.empty()) {
+    return OkStatus();
+  }
+
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, this);
+
+  // Ignore the call if the entries have been handled already.
+  if (entries.last_sequence_id() == drain.last_handled_sequence_id_) {
+    return OkStatus();
+  }
+
+  uint32_t next_entry_sequence_id;
+  Status peek_status = drain.reader_.PeekFrontPreamble(next_entry_sequence_id);
+  if (!peek_status.ok()) {
+    // Ignore errors if the multisink is empty.
+    if (peek_status.IsOutOfRange()) {
+      return OkStatus();
+    }
+    return peek_status;
+  }
+  // If the multisink advanced since PeekEntries() was called, some of the
+  // entries may have been dropped already. The rest are still at the front.
+  const uint32_t dropped_entries =
+      next_entry_sequence_id - entries.first_sequence_id();
+  if (dropped_entries < entries.size()) {
+    PW_CHECK_OK(
+        drain.reader_.PopFrontEntries(entries.size() - dropped_entries));
+  }
+  drain.last_handled_sequence_id_ = entries.last_sequence_id();
+  return OkStatus();
+}
+
+void MultiSink::GetDropCounts(Drain& drain,
+                              uint32_t entry_sequence_id,
+                              bool entry_available,
+                              uint32_t& drain_drop_count_out,
+                              uint32_t& ingress_drop_count_out) {
   // Compute the drop count delta by comparing this entry's sequence ID with the
   // last sequence ID this drain successfully read.
   //
@@ -112,9 +267,8 @@ Result<ConstByteSpan> MultiSink::PeekOrPopEntry(
   // current and last sequence IDs. Consecutive successful reads will always
   // differ by one at least, so it is subtracted out. If the read was not
   // successful, the difference is not adjusted.
-  drain_drop_count_out = entry_sequence_id_out -
-                         drain.last_handled_sequence_id_ -
-                         (peek_status.ok() ? 1 : 0);
+  drain_drop_count_out = entry_sequence_id - drain.last_handled_sequence_id_ -
+                         (entry_available ? 1 : 0);
 
   // Only report the ingress drop count when the drain catches up to where the
   // drop happened, accounting only for the drops found and no more, as
@@ -131,19 +285,13 @@ Result<ConstByteSpan> MultiSink::PeekOrPopEntry(
             ? total_ingress_drops_ - ingress_drop_count_out
             : total_ingress_drops_;
   }
+}
 
-  // The Peek above may have failed due to OutOfRange, now that we've set the
-  // drop count see if we should return before attempting to pop.
-  if (peek_status.IsOutOfRange()) {
-    // No more entries, update the drain.
-    drain.last_handled_sequence_id_ = entry_sequence_id_out;
-    return peek_status;
-  }
-  if (request == Request::kPop) {
-    PW_CHECK(drain.reader_.PopFront().ok());
-    drain.last_handled_sequence_id_ = entry_sequence_id_out;
-  }
-  return as_bytes(buffer.first(bytes_read));
+uint32_t MultiSink::CaughtUpSequenceId() {
+  // Entries that are reserved but not yet committed have not been handled, so
+  // stop short of the oldest outstanding reservation.
+  return reservations_.empty() ? sequence_id_ - 1
+                               : reservations_.front().sequence_id_ - 1;
 }
 
 void MultiSink::AttachDrain(Drain& drain) {
@@ -261,5 +409,28 @@ Result<ConstByteSpan> MultiSink::Drain::PopEntry(
                                     entry_sequence_id_out);
 }
 
+Result<MultiSink::Drain::PeekedEntries> MultiSink::Drain::PeekEntries(
+    ByteSpan buffer,
+    span<ConstByteSpan> entries_out,
+    uint32_t& drain_drop_count_out,
+    uint32_t& ingress_drop_count_out) {
+  PW_DCHECK_NOTNULL(multisink_);
+  if (entries_out.empty()) {
+    drain_drop_count_out = 0;
+    ingress_drop_count_out = 0;
+    return Status::InvalidArgument();
+  }
+  return multisink_->PeekEntries(*this,
+                                 buffer,
+                                 entries_out,
+                                 drain_drop_count_out,
+                                 ingress_drop_count_out);
+}
+
+Status MultiSink::Drain::PopEntries(const PeekedEntries& entries) {
+  PW_DCHECK_NOTNULL(multisink_);
+  return multisink_->PopEntries(*this, entries);
+}
+
 }  // namespace multisink
 }  // namespace pw
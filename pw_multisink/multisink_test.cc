@@ -214,6 +214,62 @@ TEST_F(MultiSinkTest, MultipleDrain) {
   VerifyPopEntry(drains_[1], std::nullopt, 0u, 0u);
 }
 
+TEST_F(MultiSinkTest, ReserveAndCommit) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachListener(listeners_[0]);
+  ExpectNotificationCount(listeners_[0], 1u);
+
+  MultiSink::Reservation reservation;
+  ASSERT_EQ(multisink_.Reserve(reservation, sizeof(kMessage)), OkStatus());
+  EXPECT_EQ(reservation.size_bytes(), sizeof(kMessage));
+  ExpectNotificationCount(listeners_[0], 0u);
+  VerifyPopEntry(drains_[0], std::nullopt, 0u, 0u);
+
+  ASSERT_EQ(reservation.Write(span(kMessage).first(1)), OkStatus());
+  EXPECT_EQ(multisink_.Commit(reservation), Status::FailedPrecondition());
+  ExpectNotificationCount(listeners_[0], 0u);
+  ASSERT_EQ(reservation.Write(span(kMessage).subspan(1)), OkStatus());
+  ASSERT_EQ(multisink_.Commit(reservation), OkStatus());
+  EXPECT_EQ(multisink_.Commit(reservation), Status::InvalidArgument());
+  ExpectNotificationCount(listeners_[0], 1u);
+  VerifyPopEntry(drains_[0], kMessage, 0u, 0u);
+  VerifyPopEntry(drains_[0], std::nullopt, 0u, 0u);
+}
+
+TEST_F(MultiSinkTest, CommitOutOfOrder) {
+  multisink_.AttachDrain(drains_[0]);
+
+  MultiSink::Reservation first;
+  MultiSink::Reservation second;
+  ASSERT_EQ(multisink_.Reserve(first, sizeof(kMessage)), OkStatus());
+  ASSERT_EQ(multisink_.Reserve(second, sizeof(kMessageOther)), OkStatus());
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kMessage);
+
+  // Nothing, including drops after the outstanding reservations, is reported
+  // until the first reservation is committed.
+  ASSERT_EQ(second.Write(kMessageOther), OkStatus());
+  ASSERT_EQ(multisink_.Commit(second), OkStatus());
+  VerifyPopEntry(drains_[0], std::nullopt, 0u, 0u);
+
+  ASSERT_EQ(first.Write(kMessage), OkStatus());
+  ASSERT_EQ(multisink_.Commit(first), OkStatus());
+  VerifyPopEntry(drains_[0], kMessage, 0u, 0u);
+  VerifyPopEntry(drains_[0], kMessageOther, 0u, 0u);
+  VerifyPopEntry(drains_[0], kMessage, 0u, 1u);
+  VerifyPopEntry(drains_[0], std::nullopt, 0u, 0u);
+}
+
+TEST_F(MultiSinkTest, ReserveTooLarge) {
+  multisink_.AttachDrain(drains_[0]);
+
+  MultiSink::Reservation reservation;
+  EXPECT_EQ(multisink_.Reserve(reservation, kBufferSize + 1),
+            Status::OutOfRange());
+  EXPECT_EQ(multisink_.Commit(reservation), Status::InvalidArgument());
+  VerifyPopEntry(drains_[0], std::nullopt, 0u, 1u);
+}
+
 TEST_F(MultiSinkTest, LateDrainRegistration) {
   // Drains attached after entries are pushed should still observe those entries
   // if they have not been evicted from the ring buffer.
@@ -491,6 +547,144 @@ TEST_F(MultiSinkTest, PeekReportsSlowDrainDropCount) {
                    0);
 }
 
+TEST_F(MultiSinkTest, PeekAndPopEntries) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessageOther);
+  multisink_.HandleEntry(kMessage);
+
+  uint32_t drop_count = 0;
+  uint32_t ingress_drop_count = 0;
+  std::array<ConstByteSpan, 8> entries;
+  auto peek_result = drains_[0].PeekEntries(
+      entry_buffer_, entries, drop_count, ingress_drop_count);
+  ASSERT_EQ(peek_result.status(), OkStatus());
+  EXPECT_EQ(drop_count, 0u);
+  EXPECT_EQ(ingress_drop_count, 0u);
+  ASSERT_EQ(peek_result.value().size(), 3u);
+  const ConstByteSpan expected_messages[] = {kMessage, kMessageOther, kMessage};
+  for (size_t i = 0; i < 3; ++i) {
+    const ConstByteSpan entry = peek_result.value().entries()[i];
+    ASSERT_EQ(entry.size_bytes(), expected_messages[i].size_bytes());
+    EXPECT_EQ(std::memcmp(entry.data(),
+                          expected_messages[i].data(),
+                          entry.size_bytes()),
+              0);
+  }
+
+  // The run is limited by the number of entries requested.
+  auto limited_peek_result =
+      drains_[0].PeekEntries(entry_buffer_,
+                             span(entries).first(2),
+                             drop_count,
+                             ingress_drop_count);
+  ASSERT_EQ(limited_peek_result.status(), OkStatus());
+  EXPECT_EQ(limited_peek_result.value().size(), 2u);
+  EXPECT_EQ(drains_[0]
+                .PeekEntries(entry_buffer_,
+                             span<ConstByteSpan>(),
+                             drop_count,
+                             ingress_drop_count)
+                .status(),
+            Status::InvalidArgument());
+
+  // Popping only some of the entries leaves the rest in the drain.
+  ASSERT_EQ(drains_[0].PopEntries(peek_result.value().first(1)), OkStatus());
+  VerifyPopEntry(drains_[0], kMessageOther, 0, 0);
+  // Popping entries that were already handled must not trigger errors.
+  ASSERT_EQ(drains_[0].PopEntries(peek_result.value()), OkStatus());
+  ASSERT_EQ(drains_[0].PopEntries(peek_result.value()), OkStatus());
+  VerifyPopEntry(drains_[0], std::nullopt, 0, 0);
+}
+
+TEST_F(MultiSinkTest, PeekEntriesStopsAtIngressDrops) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessage);
+  const uint32_t ingress_drops = 3;
+  multisink_.HandleDropped(ingress_drops);
+  multisink_.HandleEntry(kMessageOther);
+
+  uint32_t drop_count = 0;
+  uint32_t ingress_drop_count = 0;
+  std::array<ConstByteSpan, 8> entries;
+  auto peek_result = drains_[0].PeekEntries(
+      entry_buffer_, entries, drop_count, ingress_drop_count);
+  ASSERT_EQ(peek_result.status(), OkStatus());
+  EXPECT_EQ(peek_result.value().size(), 2u);
+  EXPECT_EQ(drop_count, 0u);
+  EXPECT_EQ(ingress_drop_count, 0u);
+  ASSERT_EQ(drains_[0].PopEntries(peek_result.value()), OkStatus());
+
+  // The drops are reported along with the run that follows them.
+  peek_result = drains_[0].PeekEntries(
+      entry_buffer_, entries, drop_count, ingress_drop_count);
+  ASSERT_EQ(peek_result.status(), OkStatus());
+  ASSERT_EQ(peek_result.value().size(), 1u);
+  EXPECT_EQ(drop_count, 0u);
+  EXPECT_EQ(ingress_drop_count, ingress_drops);
+  ASSERT_EQ(drains_[0].PopEntries(peek_result.value()), OkStatus());
+
+  peek_result = drains_[0].PeekEntries(
+      entry_buffer_, entries, drop_count, ingress_drop_count);
+  EXPECT_EQ(peek_result.status(), Status::OutOfRange());
+}
+
+TEST_F(MultiSinkTest, PeekEntriesTooSmallBuffer) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessageOther);
+
+  uint32_t drop_count = 0;
+  uint32_t ingress_drop_count = 0;
+  std::array<ConstByteSpan, 8> entries;
+  std::array<std::byte, sizeof(kMessage)> small_buffer;
+  auto peek_result = drains_[0].PeekEntries(
+      small_buffer, entries, drop_count, ingress_drop_count);
+  EXPECT_EQ(peek_result.status(), Status::ResourceExhausted());
+
+  // The entry that did not fit was discarded and is reported as dropped.
+  peek_result = drains_[0].PeekEntries(
+      entry_buffer_, entries, drop_count, ingress_drop_count);
+  ASSERT_EQ(peek_result.status(), OkStatus());
+  EXPECT_EQ(peek_result.value().size(), 1u);
+  EXPECT_EQ(drop_count, 1u);
+}
+
+TEST(MultiSinkPeekEntries, PopEntriesAfterSlowDrainDrops) {
+  // Fits two 4-byte entries with their sequence ID and size preambles.
+  std::array<std::byte, 12> buffer;
+  MultiSink multisink(buffer);
+  Drain drain;
+  multisink.AttachDrain(drain);
+
+  const std::byte message[] = {
+      std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+  multisink.HandleEntry(message);
+  multisink.HandleEntry(message);
+
+  uint32_t drop_count = 0;
+  uint32_t ingress_drop_count = 0;
+  std::array<std::byte, 32> entry_buffer;
+  std::array<ConstByteSpan, 8> entries;
+  auto peek_result =
+      drain.PeekEntries(entry_buffer, entries, drop_count, ingress_drop_count);
+  ASSERT_EQ(peek_result.status(), OkStatus());
+  ASSERT_EQ(peek_result.value().size(), 2u);
+
+  // Push out the first peeked entry. Popping the run must only pop the peeked
+  // entry that is still in the multisink.
+  multisink.HandleEntry(message);
+  ASSERT_EQ(drain.PopEntries(peek_result.value()), OkStatus());
+
+  peek_result =
+      drain.PeekEntries(entry_buffer, entries, drop_count, ingress_drop_count);
+  ASSERT_EQ(peek_result.status(), OkStatus());
+  EXPECT_EQ(peek_result.value().size(), 1u);
+  EXPECT_EQ(drop_count, 0u);
+  EXPECT_EQ(ingress_drop_count, 0u);
+}
+
 TEST_F(MultiSinkTest, IngressDropCountOverflow) {
   multisink_.AttachDrain(drains_[0]);
 
@@ -0,0 +1,139 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the throughput of several writer threads pushing entries into a
+// shared multisink while a drain empties it, comparing HandleEntry(), which
+// copies each entry while holding the multisink lock, with Reserve(), Write()
+// and Commit(), which copy outside of it.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_assert/assert.h"
+#include "pw_multisink/multisink.h"
+#include "pw_multisink/test_thread.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_thread/thread.h"
+#include "pw_thread/yield.h"
+
+namespace pw::multisink {
+namespace {
+
+constexpr size_t kWriterCount = 4;
+constexpr size_t kEntriesPerWriter = 256;
+constexpr size_t kBufferSize = 16 * 1024;
+
+enum class WriteMode { kHandleEntry, kReserve };
+
+class WriterThread : public thread::ThreadCore {
+ public:
+  WriterThread(MultiSink& multisink, WriteMode mode, ConstByteSpan entry)
+      : multisink_(multisink), mode_(mode), entry_(entry) {}
+
+  void Run() override {
+    for (size_t i = 0; i < kEntriesPerWriter; ++i) {
+      if (mode_ == WriteMode::kHandleEntry) {
+        multisink_.HandleEntry(entry_);
+        continue;
+      }
+      MultiSink::Reservation reservation;
+      if (multisink_.Reserve(reservation, entry_.size()).ok()) {
+        PW_ASSERT(reservation.Write(entry_).ok());
+        PW_ASSERT(multisink_.Commit(reservation).ok());
+      }
+    }
+  }
+
+ private:
+  MultiSink& multisink_;
+  const WriteMode mode_;
+  const ConstByteSpan entry_;
+};
+
+class ReaderThread : public thread::ThreadCore {
+ public:
+  ReaderThread(MultiSink& multisink) : multisink_(multisink) {}
+
+  void Stop() { stop_.store(true); }
+
+  void Run() override {
+    multisink_.AttachDrain(drain_);
+    while (true) {
+      // Read the flag before popping, so entries pushed before Stop() are
+      // always drained.
+      const bool stop = stop_.load();
+      uint32_t drop_count = 0;
+      uint32_t ingress_drop_count = 0;
+      const Result<ConstByteSpan> entry =
+          drain_.PopEntry(buffer_, drop_count, ingress_drop_count);
+      if (entry.status().IsOutOfRange()) {
+        if (stop) {
+          break;
+        }
+        this_thread::yield();
+      }
+    }
+    multisink_.DetachDrain(drain_);
+  }
+
+ private:
+  MultiSink& multisink_;
+  MultiSink::Drain drain_;
+  std::array<std::byte, 512> buffer_;
+  std::atomic<bool> stop_ = false;
+};
+
+void WriteFromThreads(perf_test::State& state,
+                      WriteMode mode,
+                      size_t entry_size) {
+  static std::array<std::byte, kBufferSize> buffer;
+  static std::array<std::byte, 512> entry;
+  PW_ASSERT(entry_size <= entry.size());
+
+  while (state.KeepRunning()) {
+    MultiSink multisink(buffer);
+    ReaderThread reader_core(multisink);
+    thread::Thread reader(test::MultiSinkTestThreadOptions(), reader_core);
+
+    std::array<WriterThread, kWriterCount> writer_cores = {
+        WriterThread(multisink, mode, span(entry).first(entry_size)),
+        WriterThread(multisink, mode, span(entry).first(entry_size)),
+        WriterThread(multisink, mode, span(entry).first(entry_size)),
+        WriterThread(multisink, mode, span(entry).first(entry_size)),
+    };
+    std::array<thread::Thread, kWriterCount> writers;
+    for (size_t i = 0; i < kWriterCount; ++i) {
+      writers[i] =
+          thread::Thread(test::MultiSinkTestThreadOptions(), writer_cores[i]);
+    }
+    for (thread::Thread& writer : writers) {
+      writer.join();
+    }
+    reader_core.Stop();
+    reader.join();
+  }
+}
+
+PW_PERF_TEST(HandleEntry32Bytes, WriteFromThreads, WriteMode::kHandleEntry, 32);
+PW_PERF_TEST(Reserve32Bytes, WriteFromThreads, WriteMode::kReserve, 32);
+PW_PERF_TEST(HandleEntry256Bytes,
+             WriteFromThreads,
+             WriteMode::kHandleEntry,
+             256);
+PW_PERF_TEST(Reserve256Bytes, WriteFromThreads, WriteMode::kReserve, 256);
+
+}  // namespace
+}  // namespace pw::multisink
@@ -184,6 +184,36 @@ class LogWriterThread : public thread::ThreadCore {
   const MessageSpan& message_stack_;
 };
 
+// Adds the provided messages to the shared multisink through reservations,
+// copying each message in two parts to widen the window in which other writers
+// run between reserving and committing.
+class ReservingLogWriterThread : public thread::ThreadCore {
+ public:
+  ReservingLogWriterThread(MultiSink& multisink,
+                           const MessageSpan& message_stack)
+      : multisink_(multisink), message_stack_(message_stack) {}
+
+  void Run() override {
+    for (const auto& message : message_stack_) {
+      ConstByteSpan entry = as_bytes(span(std::string_view(message)));
+      MultiSink::Reservation reservation;
+      if (!multisink_.Reserve(reservation, entry.size()).ok()) {
+        continue;
+      }
+      const size_t split = entry.size() / 2;
+      PW_ASSERT(reservation.Write(entry.first(split)).ok());
+      pw::this_thread::yield();
+      PW_ASSERT(reservation.Write(entry.subspan(split)).ok());
+      PW_ASSERT(multisink_.Commit(reservation).ok());
+      pw::this_thread::yield();
+    }
+  }
+
+ private:
+  MultiSink& multisink_;
+  const MessageSpan& message_stack_;
+};
+
 class MultiSinkTest : public ::testing::Test {
  protected:
   MultiSinkTest() : buffer_{}, multisink_(buffer_) {}
@@ -335,6 +365,48 @@ TEST_F(MultiSinkTest, MultipleWritersMultipleReaders) {
             expected_message_and_drop_count - drop_count);
 }
 
+TEST_F(MultiSinkTest, MultipleReservingWritersMultipleReaders) {
+  const uint32_t log_count = 65;
+  const uint32_t drop_count = 7;
+  const uint32_t expected_message_and_drop_count = 3 * log_count + drop_count;
+  const auto message_stack = MessagePool::Instance().GetMessages(log_count);
+
+  // Start reader threads.
+  LogPopReaderThread reader_thread_core1(multisink_,
+                                         expected_message_and_drop_count);
+  thread::Thread reader_thread1(test::MultiSinkTestThreadOptions(),
+                                reader_thread_core1);
+  LogPeekAndCommitReaderThread reader_thread_core2(
+      multisink_, expected_message_and_drop_count);
+  thread::Thread reader_thread2(test::MultiSinkTestThreadOptions(),
+                                reader_thread_core2);
+  // Start writer threads, mixing reserving writers with HandleEntry().
+  ReservingLogWriterThread writer_thread_core1(multisink_, message_stack);
+  thread::Thread writer_thread1(test::MultiSinkTestThreadOptions(),
+                                writer_thread_core1);
+  ReservingLogWriterThread writer_thread_core2(multisink_, message_stack);
+  thread::Thread writer_thread2(test::MultiSinkTestThreadOptions(),
+                                writer_thread_core2);
+  LogWriterThread writer_thread_core3(multisink_, message_stack);
+  thread::Thread writer_thread3(test::MultiSinkTestThreadOptions(),
+                                writer_thread_core3);
+
+  // Wait for writer threads to end.
+  writer_thread1.join();
+  writer_thread2.join();
+  writer_thread3.join();
+  multisink_.HandleDropped(drop_count);
+  reader_thread1.join();
+  reader_thread2.join();
+
+  EXPECT_EQ(reader_thread_core1.drop_count(), drop_count);
+  EXPECT_EQ(reader_thread_core2.drop_count(), drop_count);
+  EXPECT_EQ(reader_thread_core1.received_messages().size(),
+            expected_message_and_drop_count - drop_count);
+  EXPECT_EQ(reader_thread_core2.received_messages().size(),
+            expected_message_and_drop_count - drop_count);
+}
+
 TEST_F(MultiSinkTest, OverflowMultisink) {
   // Expect the multisink to overflow and readers to not fail when poping, or
   // peeking and commiting entries.
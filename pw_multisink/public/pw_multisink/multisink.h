@@ -36,6 +36,36 @@ namespace multisink {
 // PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled.
 class MultiSink {
  public:
+  // Space for an entry claimed with MultiSink::Reserve(). The entry's data is
+  // written with Write() without holding the multisink lock, and handed to
+  // drains with MultiSink::Commit().
+  class Reservation : public IntrusiveList<Reservation>::Item {
+   public:
+    constexpr Reservation() : sequence_id_(0) {}
+
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    // Copies data into the reserved entry, continuing from where the previous
+    // call to Write() left off. This does not acquire the multisink lock.
+    //
+    // Return values:
+    // OK - Data successfully written to the reservation.
+    // FAILED_PRECONDITION - The reservation is not active.
+    // RESOURCE_EXHAUSTED - The data does not fit in the remaining reserved
+    // space. Nothing was written.
+    Status Write(ConstByteSpan data) { return reservation_.Write(data); }
+
+    // Size of the reserved entry.
+    size_t size_bytes() const { return reservation_.size_bytes(); }
+
+   private:
+    friend MultiSink;
+
+    ring_buffer::PrefixedEntryRingBufferMulti::Reservation reservation_;
+    uint32_t sequence_id_;
+  };
+
   // An asynchronous reader which is attached to a MultiSink via AttachDrain.
   // Each Drain holds a PrefixedEntryRingBufferMulti::Reader and abstracts away
   // entry sequence information for clients when popping.
@@ -61,6 +91,39 @@ class MultiSink {
       const uint32_t sequence_id_;
     };
 
+    // Holds the context for a run of entries peeked with `PeekEntries`, that
+    // the user may pass to `PopEntries` to advance the drain past them.
+    class PeekedEntries {
+     public:
+      // Provides access to the peeked entries' data, oldest first.
+      span<const ConstByteSpan> entries() const { return entries_; }
+
+      size_t size() const { return entries_.size(); }
+      bool empty() const { return entries_.empty(); }
+
+      // Returns the oldest `count` entries of the run, for use when only some
+      // of the peeked entries were handled.
+      PeekedEntries first(size_t count) const {
+        return PeekedEntries(entries_.first(count), first_sequence_id_);
+      }
+
+     private:
+      friend MultiSink;
+      friend MultiSink::Drain;
+
+      constexpr PeekedEntries(span<const ConstByteSpan> entries,
+                              uint32_t first_sequence_id)
+          : entries_(entries), first_sequence_id_(first_sequence_id) {}
+
+      uint32_t first_sequence_id() const { return first_sequence_id_; }
+      uint32_t last_sequence_id() const {
+        return first_sequence_id_ + static_cast<uint32_t>(size()) - 1;
+      }
+
+      span<const ConstByteSpan> entries_;
+      uint32_t first_sequence_id_;
+    };
+
     constexpr Drain()
         : last_handled_sequence_id_(0),
           last_peek_sequence_id_(0),
@@ -198,6 +261,57 @@ class MultiSink {
                                   uint32_t& ingress_drop_count_out)
         PW_LOCKS_EXCLUDED(multisink_->lock_);
 
+    // Batched version of `PeekEntry`. Copies a run of the next available
+    // entries into `buffer` while taking the multisink lock once, and stores
+    // a view of each of them in `entries_out`. The number of entries is
+    // limited by the sizes of `buffer` and `entries_out`, and the run ends
+    // before any gap in the entries, such as ingress drops, so the reported
+    // drop counts always precede the first entry of the run. The drop counts
+    // follow the same logic as `PeekEntry`. The user must call `PopEntries`
+    // with the entries that were used successfully.
+    //
+    // Example Usage:
+    //
+    //  std::array<ConstByteSpan, 8> entries;
+    //  const Result<PeekedEntries> peek_result =
+    //      drain.PeekEntries(buffer, entries, drop_count, ingress_drop_count);
+    //  if (!peek_result.ok()) {
+    //    return peek_result.status();
+    //  }
+    //  for (ConstByteSpan entry : peek_result.value().entries()) {
+    //    PW_TRY(UserSendFunction(entry));
+    //  }
+    //  PW_CHECK_OK(drain.PopEntries(peek_result.value()));
+    //
+    // Precondition: the buffer data must not be corrupt, otherwise there will
+    // be a crash.
+    //
+    // Return values:
+    // OK - At least one entry was successfully read from the multisink.
+    // OUT_OF_RANGE - No entries were available.
+    // FAILED_PRECONDITION - The drain must be attached to a sink.
+    // INVALID_ARGUMENT - `entries_out` is empty.
+    // RESOURCE_EXHAUSTED - The provided buffer was not large enough to store
+    // the next available entry, which was discarded.
+    Result<PeekedEntries> PeekEntries(ByteSpan buffer,
+                                      span<ConstByteSpan> entries_out,
+                                      uint32_t& drain_drop_count_out,
+                                      uint32_t& ingress_drop_count_out)
+        PW_LOCKS_EXCLUDED(multisink_->lock_);
+
+    // Removes the previously peeked run of entries from the multisink while
+    // taking the multisink lock once. Entries that the multisink dropped
+    // since they were peeked are skipped.
+    //
+    // Precondition: the buffer data must not be corrupt, otherwise there will
+    // be a crash.
+    //
+    // Return values:
+    // OK - the entries were removed from the multisink successfully.
+    // FAILED_PRECONDITION - The drain must be attached to a sink.
+    Status PopEntries(const PeekedEntries& entries)
+        PW_LOCKS_EXCLUDED(multisink_->lock_);
+
     // Drains are not copyable or movable.
     Drain(const Drain&) = delete;
     Drain& operator=(const Drain&) = delete;
@@ -352,6 +466,42 @@ class MultiSink {
   // Precondition: entry.size() <= `ring_buffer_` size
   void HandleEntry(ConstByteSpan entry) PW_LOCKS_EXCLUDED(lock_);
 
+  // Claims space for an entry of `size_bytes` that is filled in with
+  // Reservation::Write() and then handed to drains with Commit(). Only the
+  // reservation and commit bookkeeping hold the multisink lock, so producers
+  // copying or encoding large entries do not serialize each other or stall
+  // drains while doing so.
+  //
+  // Entries are handed to drains in the order they were reserved, regardless
+  // of the order in which they are committed. Every successful reservation
+  // must be committed; an outstanding reservation keeps all later entries from
+  // being read.
+  //
+  // As with HandleEntry, the sequence ID of the multisink always increments.
+  // If the space needed is held by other outstanding reservations, the entry
+  // is reported to drains as an ingress drop.
+  //
+  // Precondition: If PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled, this
+  // function must not be called from an interrupt context.
+  //
+  // Return values:
+  // OK - The space was reserved.
+  // INVALID_ARGUMENT - The reservation is already active.
+  // OUT_OF_RANGE - The entry is larger than the multisink.
+  // RESOURCE_EXHAUSTED - Outstanding reservations hold the space needed.
+  Status Reserve(Reservation& reservation, size_t size_bytes)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Hands a reserved entry to the drains and notifies listeners. The
+  // reservation may be reused once this returns OK.
+  //
+  // Return values:
+  // OK - The entry was committed.
+  // INVALID_ARGUMENT - The reservation is not active in this multisink.
+  // FAILED_PRECONDITION - Not all of the reserved entry was written. The
+  // reservation remains active, and can be committed once it is filled.
+  Status Commit(Reservation& reservation) PW_LOCKS_EXCLUDED(lock_);
+
   // Notifies the multisink of messages dropped before ingress. The writer
   // may use this to signal to readers that an entry (or entries) failed
   // before being sent to the multisink (e.g. the writer failed to encode
@@ -435,12 +585,40 @@ class MultiSink {
                                        uint32_t& entry_sequence_id_out)
       PW_LOCKS_EXCLUDED(lock_);
 
+  // Copies a run of entries from the provided drain, without removing them
+  // from the multisink. See `Drain::PeekEntries`.
+  Result<Drain::PeekedEntries> PeekEntries(Drain& drain,
+                                           ByteSpan buffer,
+                                           span<ConstByteSpan> entries_out,
+                                           uint32_t& drain_drop_count_out,
+                                           uint32_t& ingress_drop_count_out)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Removes the previously peeked run of entries from the front of the
+  // multisink.
+  Status PopEntries(Drain& drain, const Drain::PeekedEntries& entries)
+      PW_LOCKS_EXCLUDED(lock_);
+
  private:
+  // Computes the drops the drain has not handled yet, given the sequence ID of
+  // the entry it is about to read, or of the last entry handled by the sink
+  // when `entry_available` is false.
+  void GetDropCounts(Drain& drain,
+                     uint32_t entry_sequence_id,
+                     bool entry_available,
+                     uint32_t& drain_drop_count_out,
+                     uint32_t& ingress_drop_count_out)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the sequence ID to report once a drain has caught up.
+  uint32_t CaughtUpSequenceId() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Notifies attached listeners of new entries or an updated drop count.
   void NotifyListeners() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   LockType lock_;
   IntrusiveList<Listener> listeners_ PW_GUARDED_BY(lock_);
+  IntrusiveList<Reservation> reservations_ PW_GUARDED_BY(lock_);
   ring_buffer::PrefixedEntryRingBufferMulti ring_buffer_ PW_GUARDED_BY(lock_);
   Drain oldest_entry_drain_ PW_GUARDED_BY(lock_);
   uint32_t sequence_id_ PW_GUARDED_BY(lock_);
@@ -933,6 +933,7 @@ def pw_transfer_integration_test(ctx: PresubmitContext) -> None:
         '//pw_transfer/integration_test:multi_transfer_test',
         '//pw_transfer/integration_test:expected_errors_test',
         '//pw_transfer/integration_test:legacy_binaries_test',
+        '//pw_transfer/integration_test:selective_ack_test',
         '--test_output=errors',
     )
 
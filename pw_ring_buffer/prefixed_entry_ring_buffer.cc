@@ -28,12 +28,19 @@ namespace ring_buffer {
 using std::byte;
 using Entry = PrefixedEntryRingBufferMulti::Entry;
 using Reader = PrefixedEntryRingBufferMulti::Reader;
+using Reservation = PrefixedEntryRingBufferMulti::Reservation;
 using iterator = PrefixedEntryRingBufferMulti::iterator;
 
 void PrefixedEntryRingBufferMulti::Clear() {
-  write_idx_ = 0;
+  // Outstanding reservations still own the space past the publish index, so
+  // only the published entries can be dropped.
+  if (reservations_.empty()) {
+    write_idx_ = 0;
+    publish_idx_ = 0;
+    unpublished_bytes_ = 0;
+  }
   for (Reader& reader : readers_) {
-    reader.read_idx_ = 0;
+    reader.read_idx_ = publish_idx_;
     reader.entry_count_ = 0;
   }
 }
@@ -44,6 +51,9 @@ Status PrefixedEntryRingBufferMulti::SetBuffer(span<byte> buffer) {
       (buffer.size_bytes() > kMaxBufferBytes)) {
     return Status::InvalidArgument();
   }
+  if (!reservations_.empty()) {
+    return Status::FailedPrecondition();
+  }
 
   buffer_ = buffer.data();
   buffer_bytes_ = buffer.size_bytes();
@@ -59,7 +69,7 @@ Status PrefixedEntryRingBufferMulti::AttachReader(Reader& reader) {
   reader.buffer_ = this;
 
   if (readers_.empty()) {
-    reader.read_idx_ = write_idx_;
+    reader.read_idx_ = publish_idx_;
     reader.entry_count_ = 0;
   } else {
     const Reader& slowest_reader = GetSlowestReader();
@@ -86,9 +96,39 @@ Status PrefixedEntryRingBufferMulti::InternalPushBack(
     span<const byte> data,
     uint32_t user_preamble_data,
     bool pop_front_if_needed) {
+  size_t data_idx;
+  size_t entry_bytes;
+  PW_TRY(InternalReserve(data.size_bytes(),
+                         user_preamble_data,
+                         pop_front_if_needed,
+                         data_idx,
+                         entry_bytes));
+  RawWriteAt(data_idx, data);
+
+  if (reservations_.empty()) {
+    Publish(1, entry_bytes);
+  } else {
+    // The entry was written behind an outstanding reservation, so it is
+    // published along with the last one.
+    Reservation& last = reservations_.back();
+    last.trailing_entry_count_++;
+    last.trailing_bytes_ += entry_bytes;
+  }
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::InternalReserve(
+    size_t data_size_bytes,
+    uint32_t user_preamble_data,
+    bool pop_front_if_needed,
+    size_t& data_idx_out,
+    size_t& entry_bytes_out) {
   if (buffer_ == nullptr) {
     return Status::FailedPrecondition();
   }
+  if (data_size_bytes > std::numeric_limits<uint32_t>::max()) {
+    return Status::OutOfRange();
+  }
 
   // Prepare a single buffer that can hold both the user preamble and entry
   // length.
@@ -99,18 +139,23 @@ Status PrefixedEntryRingBufferMulti::InternalPushBack(
         varint::Encode<uint32_t>(user_preamble_data, preamble_buf);
   }
   size_t length_bytes =
-      varint::Encode<uint32_t>(static_cast<uint32_t>(data.size_bytes()),
+      varint::Encode<uint32_t>(static_cast<uint32_t>(data_size_bytes),
                                span(preamble_buf).subspan(user_preamble_bytes));
   size_t total_write_bytes =
-      user_preamble_bytes + length_bytes + data.size_bytes();
+      user_preamble_bytes + length_bytes + data_size_bytes;
   if (buffer_bytes_ < total_write_bytes) {
     return Status::OutOfRange();
   }
 
   if (pop_front_if_needed) {
     // PushBack() case: evict items as needed.
-    // Drop old entries until we have space for the new entry.
+    // Drop old entries until we have space for the new entry. Only published
+    // entries can be evicted, so give up if the remaining space is held by
+    // outstanding reservations.
     while (RawAvailableBytes() < total_write_bytes) {
+      if (readers_.empty() || GetSlowestReader().entry_count_ == 0) {
+        return Status::ResourceExhausted();
+      }
       InternalPopFrontAll();
     }
   } else if (RawAvailableBytes() < total_write_bytes) {
@@ -118,14 +163,77 @@ Status PrefixedEntryRingBufferMulti::InternalPushBack(
     return Status::ResourceExhausted();
   }
 
-  // Write the new entry into the ring buffer.
+  // Write the preamble and claim the space for the data.
   RawWrite(span(preamble_buf, user_preamble_bytes + length_bytes));
-  RawWrite(data);
+  data_idx_out = write_idx_;
+  write_idx_ = IncrementIndex(write_idx_, data_size_bytes);
+  unpublished_bytes_ += total_write_bytes;
+  entry_bytes_out = total_write_bytes;
+  return OkStatus();
+}
+
+void PrefixedEntryRingBufferMulti::Publish(size_t entry_count,
+                                           size_t entry_bytes) {
+  publish_idx_ = IncrementIndex(publish_idx_, entry_bytes);
+  unpublished_bytes_ -= entry_bytes;
 
   // Update all readers of the new count.
   for (Reader& reader : readers_) {
-    reader.entry_count_++;
+    reader.entry_count_ += entry_count;
+  }
+}
+
+Status PrefixedEntryRingBufferMulti::Reserve(Reservation& reservation,
+                                             size_t data_size_bytes,
+                                             uint32_t user_preamble_data) {
+  if (reservation.buffer_ != nullptr) {
+    return Status::InvalidArgument();
+  }
+  PW_TRY(InternalReserve(data_size_bytes,
+                         user_preamble_data,
+                         /*pop_front_if_needed=*/true,
+                         reservation.data_idx_,
+                         reservation.entry_bytes_));
+  reservation.buffer_ = this;
+  reservation.data_bytes_ = data_size_bytes;
+  reservation.written_bytes_ = 0;
+  reservation.trailing_entry_count_ = 0;
+  reservation.trailing_bytes_ = 0;
+  reservations_.push_back(reservation);
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::Commit(Reservation& reservation) {
+  if (reservation.buffer_ != this) {
+    return Status::InvalidArgument();
+  }
+  // Publishing a partly written entry would expose stale buffer contents.
+  if (reservation.remaining_bytes() != 0) {
+    return Status::FailedPrecondition();
+  }
+  reservation.buffer_ = nullptr;
+
+  const size_t entry_count = 1 + reservation.trailing_entry_count_;
+  const size_t entry_bytes =
+      reservation.entry_bytes_ + reservation.trailing_bytes_;
+
+  if (&reservations_.front() == &reservation) {
+    reservations_.pop_front();
+    Publish(entry_count, entry_bytes);
+    return OkStatus();
+  }
+
+  // An earlier reservation is still outstanding. Hand this entry and the ones
+  // waiting on it over to the preceding reservation, so they are published
+  // when it is committed.
+  auto previous = reservations_.begin();
+  auto current = reservations_.begin();
+  for (++current; &(*current) != &reservation; ++current) {
+    previous = current;
   }
+  previous->trailing_entry_count_ += entry_count;
+  previous->trailing_bytes_ += entry_bytes;
+  reservations_.erase_after(previous);
   return OkStatus();
 }
 
@@ -277,6 +385,18 @@ Status PrefixedEntryRingBufferMulti::InternalDering(Reader& dering_reader) {
   }
   write_idx_ -= dering_reader.read_idx_;
 
+  if (publish_idx_ < dering_reader.read_idx_) {
+    publish_idx_ += buffer_bytes_;
+  }
+  publish_idx_ -= dering_reader.read_idx_;
+
+  for (Reservation& reservation : reservations_) {
+    if (reservation.data_idx_ < dering_reader.read_idx_) {
+      reservation.data_idx_ += buffer_bytes_;
+    }
+    reservation.data_idx_ -= dering_reader.read_idx_;
+  }
+
   for (Reader& reader : readers_) {
     if (&reader == &dering_reader) {
       continue;
@@ -308,6 +428,62 @@ Status PrefixedEntryRingBufferMulti::InternalPopFront(Reader& reader) {
   return OkStatus();
 }
 
+Status PrefixedEntryRingBufferMulti::InternalPeekFrontEntries(
+    const Reader& reader,
+    span<byte> data,
+    size_t max_entries,
+    size_t& entry_count_out,
+    size_t& bytes_read_out) const {
+  entry_count_out = 0;
+  bytes_read_out = 0;
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (max_entries == 0) {
+    return Status::InvalidArgument();
+  }
+  if (reader.entry_count_ == 0) {
+    return Status::OutOfRange();
+  }
+
+  // Walk the entry headers to find how many whole entries fit, then copy them
+  // all at once.
+  max_entries = std::min(max_entries, reader.entry_count_);
+  size_t read_idx = reader.read_idx_;
+  while (entry_count_out < max_entries) {
+    Result<EntryInfo> info = RawFrontEntryInfo(read_idx);
+    PW_CHECK_OK(info.status());
+    const size_t entry_bytes =
+        info.value().preamble_bytes + info.value().data_bytes;
+    if (entry_bytes > data.size_bytes() - bytes_read_out) {
+      break;
+    }
+    bytes_read_out += entry_bytes;
+    read_idx = IncrementIndex(read_idx, entry_bytes);
+    entry_count_out++;
+  }
+  if (entry_count_out == 0) {
+    return Status::ResourceExhausted();
+  }
+
+  RawRead(data.data(), reader.read_idx_, bytes_read_out);
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::InternalPopFrontEntries(Reader& reader,
+                                                             size_t count) {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (count > reader.entry_count_) {
+    return Status::OutOfRange();
+  }
+  for (; count > 0; --count) {
+    PW_CHECK_OK(InternalPopFront(reader));
+  }
+  return OkStatus();
+}
+
 size_t PrefixedEntryRingBufferMulti::InternalFrontEntryDataSizeBytes(
     const Reader& reader) const {
   if (reader.entry_count_ == 0) {
@@ -366,13 +542,45 @@ PrefixedEntryRingBufferMulti::RawFrontEntryInfo(size_t source_idx) const {
   return info;
 }
 
+Result<Entry> PrefixedEntryRingBufferMulti::DecodeEntry(
+    span<const byte> entries, size_t& entry_bytes_out) const {
+  entry_bytes_out = 0;
+
+  size_t user_preamble_bytes = 0;
+  uint64_t user_preamble_data = 0;
+  if (user_preamble_) {
+    user_preamble_bytes = varint::Decode(entries, &user_preamble_data);
+    if (user_preamble_bytes == 0u) {
+      return Status::DataLoss();
+    }
+  }
+
+  uint64_t data_bytes;
+  const size_t length_bytes =
+      varint::Decode(entries.subspan(user_preamble_bytes), &data_bytes);
+  if (length_bytes == 0u) {
+    return Status::DataLoss();
+  }
+
+  const size_t preamble_bytes = user_preamble_bytes + length_bytes;
+  if (data_bytes > entries.size_bytes() - preamble_bytes) {
+    return Status::DataLoss();
+  }
+  const size_t data_size = static_cast<size_t>(data_bytes);
+  entry_bytes_out = preamble_bytes + data_size;
+  return Entry{
+      .buffer = entries.subspan(preamble_bytes, data_size),
+      .preamble = static_cast<uint32_t>(user_preamble_data),
+  };
+}
+
 // Comparisons ordered for more probable early exits, assuming the reader is
 // not far behind the writer compared to the size of the ring.
 size_t PrefixedEntryRingBufferMulti::RawAvailableBytes() const {
   // Compute slowest reader. If no readers exist, the entire buffer can be
-  // written.
+  // written, except for the space held by outstanding reservations.
   if (readers_.empty()) {
-    return buffer_bytes_;
+    return buffer_bytes_ - unpublished_bytes_;
   }
 
   size_t read_idx = GetSlowestReader().read_idx_;
@@ -385,6 +593,9 @@ size_t PrefixedEntryRingBufferMulti::RawAvailableBytes() const {
     return read_idx - write_idx_;
   }
   // Case: Matched read and write heads; empty or full.
+  if (unpublished_bytes_ != 0) {
+    return 0;
+  }
   for (const Reader& reader : readers_) {
     if (reader.read_idx_ == read_idx && reader.entry_count_ != 0) {
       return 0;
@@ -394,21 +605,26 @@ size_t PrefixedEntryRingBufferMulti::RawAvailableBytes() const {
 }
 
 void PrefixedEntryRingBufferMulti::RawWrite(span<const std::byte> source) {
+  RawWriteAt(write_idx_, source);
+  write_idx_ = IncrementIndex(write_idx_, source.size());
+}
+
+void PrefixedEntryRingBufferMulti::RawWriteAt(size_t destination_idx,
+                                              span<const std::byte> source) {
   if (source.size_bytes() == 0) {
     return;
   }
 
   // Write until the end of the source or the backing buffer.
-  size_t bytes_until_wrap = buffer_bytes_ - write_idx_;
+  size_t bytes_until_wrap = buffer_bytes_ - destination_idx;
   size_t bytes_to_copy = std::min(source.size(), bytes_until_wrap);
-  memcpy(buffer_ + write_idx_, source.data(), bytes_to_copy);
+  memcpy(buffer_ + destination_idx, source.data(), bytes_to_copy);
 
   // If there wasn't space in the backing buffer, wrap to the front.
   if (bytes_to_copy < source.size()) {
     memcpy(
         buffer_, source.data() + bytes_to_copy, source.size() - bytes_to_copy);
   }
-  write_idx_ = IncrementIndex(write_idx_, source.size());
 }
 
 void PrefixedEntryRingBufferMulti::RawRead(byte* destination,
@@ -449,14 +665,29 @@ Status PrefixedEntryRingBufferMulti::Reader::PeekFrontWithPreamble(
       *this, GetOutput(data, &entry_bytes_read_out), false, &user_preamble_out);
 }
 
+Status PrefixedEntryRingBufferMulti::Reservation::Write(
+    span<const byte> data) {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (data.size_bytes() > remaining_bytes()) {
+    return Status::ResourceExhausted();
+  }
+  buffer_->RawWriteAt(buffer_->IncrementIndex(data_idx_, written_bytes_),
+                      data);
+  written_bytes_ += data.size_bytes();
+  return OkStatus();
+}
+
 size_t PrefixedEntryRingBufferMulti::Reader::EntriesSize() const {
+  const size_t publish_idx = buffer_->publish_idx_;
   // Case: Not wrapped.
-  if (read_idx_ < buffer_->write_idx_) {
-    return buffer_->write_idx_ - read_idx_;
+  if (read_idx_ < publish_idx) {
+    return publish_idx - read_idx_;
   }
   // Case: Wrapped.
-  if (read_idx_ > buffer_->write_idx_) {
-    return buffer_->buffer_bytes_ - (read_idx_ - buffer_->write_idx_);
+  if (read_idx_ > publish_idx) {
+    return buffer_->buffer_bytes_ - (read_idx_ - publish_idx);
   }
 
   // No entries remaining.
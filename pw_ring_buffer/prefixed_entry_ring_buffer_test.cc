@@ -938,6 +938,231 @@ TEST(PrefixedEntryRingBufferMulti, IteratorBufferCorruption) {
   EXPECT_EQ(validated_entries, valid_entries);
 }
 
+TEST(PrefixedEntryRingBufferMulti, ReserveAndCommit) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reservation reservation;
+  ASSERT_EQ(ring.Reserve(reservation, sizeof(uint32_t), 7u), OkStatus());
+  EXPECT_EQ(reservation.size_bytes(), sizeof(uint32_t));
+  EXPECT_EQ(ring.Reserve(reservation, sizeof(uint32_t)),
+            Status::InvalidArgument());
+
+  // The entry isn't visible until it is committed.
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  EXPECT_EQ(ring.EntriesSize(), 0u);
+
+  const uint32_t value = 0x12345678;
+  ASSERT_EQ(reservation.Write(as_bytes(span(&value, 1)).first(2)), OkStatus());
+  ASSERT_EQ(reservation.Write(as_bytes(span(&value, 1)).subspan(2)),
+            OkStatus());
+  EXPECT_EQ(reservation.remaining_bytes(), 0u);
+  EXPECT_EQ(reservation.Write(as_bytes(span(&value, 1))),
+            Status::ResourceExhausted());
+
+  ASSERT_EQ(ring.Commit(reservation), OkStatus());
+  EXPECT_EQ(ring.Commit(reservation), Status::InvalidArgument());
+  EXPECT_EQ(reservation.Write(as_bytes(span(&value, 1))),
+            Status::FailedPrecondition());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+
+  uint32_t user_preamble = 0;
+  EXPECT_EQ(PeekFront<uint32_t>(ring, &user_preamble), value);
+  EXPECT_EQ(user_preamble, 7u);
+}
+
+TEST(PrefixedEntryRingBufferMulti, CommitRejectsPartlyWrittenReservation) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reservation reservation;
+  ASSERT_EQ(ring.Reserve(reservation, sizeof(uint32_t)), OkStatus());
+  EXPECT_EQ(ring.Commit(reservation), Status::FailedPrecondition());
+
+  const uint32_t value = 0x12345678;
+  ASSERT_EQ(reservation.Write(as_bytes(span(&value, 1)).first(3)), OkStatus());
+  EXPECT_EQ(ring.Commit(reservation), Status::FailedPrecondition());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+
+  // The reservation stays active, so it can be completed and committed.
+  ASSERT_EQ(reservation.Write(as_bytes(span(&value, 1)).subspan(3)),
+            OkStatus());
+  ASSERT_EQ(ring.Commit(reservation), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+  EXPECT_EQ(PeekFront<uint32_t>(ring), value);
+}
+
+TEST(PrefixedEntryRingBufferMulti, CommitPublishesInReservationOrder) {
+  PrefixedEntryRingBufferMulti ring(true);
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  PrefixedEntryRingBufferMulti::Reader reader;
+  ASSERT_EQ(ring.AttachReader(reader), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reservation first;
+  PrefixedEntryRingBufferMulti::Reservation second;
+  PrefixedEntryRingBufferMulti::Reservation third;
+  ASSERT_EQ(ring.Reserve(first, sizeof(size_t), 1u), OkStatus());
+  ASSERT_EQ(ring.Reserve(second, sizeof(size_t), 2u), OkStatus());
+  ASSERT_EQ(PushBack<size_t>(ring, 3u, 3u), OkStatus());
+  ASSERT_EQ(ring.Reserve(third, sizeof(size_t), 4u), OkStatus());
+
+  // Commit out of order; nothing is published until the first reservation is
+  // committed.
+  const size_t values[] = {1u, 2u, 4u};
+  ASSERT_EQ(third.Write(as_bytes(span(&values[2], 1))), OkStatus());
+  ASSERT_EQ(ring.Commit(third), OkStatus());
+  ASSERT_EQ(second.Write(as_bytes(span(&values[1], 1))), OkStatus());
+  ASSERT_EQ(ring.Commit(second), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), 0u);
+
+  ASSERT_EQ(first.Write(as_bytes(span(&values[0], 1))), OkStatus());
+  ASSERT_EQ(ring.Commit(first), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), 4u);
+
+  for (uint32_t expected = 1u; expected <= 4u; ++expected) {
+    uint32_t user_preamble = 0;
+    EXPECT_EQ(PeekFront<size_t>(reader, &user_preamble), expected);
+    EXPECT_EQ(user_preamble, expected);
+    ASSERT_EQ(reader.PopFront(), OkStatus());
+  }
+  EXPECT_EQ(reader.PopFront(), Status::OutOfRange());
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReserveDoesNotEvictReservations) {
+  PrefixedEntryRingBufferMulti ring;
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  PrefixedEntryRingBufferMulti::Reader reader;
+  ASSERT_EQ(ring.AttachReader(reader), OkStatus());
+
+  // Fill the buffer with published entries, then hold half of it with an
+  // outstanding reservation.
+  const size_t entry_size = sizeof(size_t) + 1;
+  const size_t max_entries = kTestBufferSize / entry_size;
+  for (size_t i = 0; i < max_entries; ++i) {
+    ASSERT_EQ(PushBack<size_t>(ring, i), OkStatus());
+  }
+  PrefixedEntryRingBufferMulti::Reservation reservation;
+  const size_t reserved_entries = max_entries / 2;
+  const size_t reserved_bytes = reserved_entries * entry_size - 1;
+  ASSERT_EQ(ring.Reserve(reservation, reserved_bytes), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), max_entries - reserved_entries);
+
+  // Pushing evicts published entries until only the reservation is left.
+  for (size_t i = 0; i < max_entries - reserved_entries; ++i) {
+    ASSERT_EQ(PushBack<size_t>(ring, i), OkStatus());
+  }
+  EXPECT_EQ(reader.EntryCount(), 0u);
+  EXPECT_EQ(PushBack<size_t>(ring, 0u), Status::ResourceExhausted());
+
+  // Committing publishes the reservation and the entries queued behind it.
+  std::array<byte, kTestBufferSize> data{};
+  ASSERT_EQ(reservation.Write(span(data).first(reserved_bytes)), OkStatus());
+  ASSERT_EQ(ring.Commit(reservation), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), max_entries - reserved_entries + 1);
+  ASSERT_EQ(PushBack<size_t>(ring, 0u), OkStatus());
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReservationSurvivesDering) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Move the read index away from the start of the buffer.
+  ASSERT_EQ(PushBack<size_t>(ring, 0u), OkStatus());
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reservation reservation;
+  ASSERT_EQ(ring.Reserve(reservation, sizeof(size_t)), OkStatus());
+  ASSERT_EQ(ring.Dering(), OkStatus());
+
+  const size_t value = 42u;
+  ASSERT_EQ(reservation.Write(as_bytes(span(&value, 1))), OkStatus());
+  ASSERT_EQ(ring.Commit(reservation), OkStatus());
+  EXPECT_EQ(PeekFront<size_t>(ring), value);
+}
+
+TEST(PrefixedEntryRingBufferMulti, PeekAndPopFrontEntries) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Each entry takes a preamble byte, a size byte and the data.
+  constexpr size_t kEntryBytes = sizeof(size_t) + 2;
+  std::array<byte, kEntryBytes * 8> entries;
+  size_t entry_count = 0;
+  size_t bytes_read = 0;
+  EXPECT_EQ(ring.PeekFrontEntries(entries, 8, entry_count, bytes_read),
+            Status::OutOfRange());
+
+  // Wrap the entries around the end of the buffer.
+  for (size_t i = 0; i < 16; ++i) {
+    ASSERT_EQ(PushBack<size_t>(ring, i, static_cast<uint32_t>(i)), OkStatus());
+  }
+  ASSERT_EQ(ring.PopFrontEntries(10), OkStatus());
+  for (size_t i = 16; i < 20; ++i) {
+    ASSERT_EQ(PushBack<size_t>(ring, i, static_cast<uint32_t>(i)), OkStatus());
+  }
+  ASSERT_EQ(ring.EntryCount(), 10u);
+
+  ASSERT_EQ(ring.PeekFrontEntries(entries, 16, entry_count, bytes_read),
+            OkStatus());
+  EXPECT_EQ(entry_count, 8u);
+  EXPECT_EQ(bytes_read, entry_count * kEntryBytes);
+  span<const byte> remaining = span(entries).first(bytes_read);
+  for (size_t i = 10; i < 18; ++i) {
+    size_t entry_bytes = 0;
+    const Result<PrefixedEntryRingBufferMulti::Entry> entry =
+        ring.DecodeEntry(remaining, entry_bytes);
+    ASSERT_EQ(entry.status(), OkStatus());
+    EXPECT_EQ(entry_bytes, kEntryBytes);
+    EXPECT_EQ(entry->preamble, i);
+    EXPECT_EQ(GetEntry<size_t>(entry->buffer), i);
+    remaining = remaining.subspan(entry_bytes);
+  }
+  EXPECT_TRUE(remaining.empty());
+  EXPECT_EQ(ring.EntryCount(), 10u);
+
+  // The entry count is limited to the requested maximum.
+  ASSERT_EQ(ring.PeekFrontEntries(entries, 2, entry_count, bytes_read),
+            OkStatus());
+  EXPECT_EQ(entry_count, 2u);
+  EXPECT_EQ(bytes_read, 2 * kEntryBytes);
+  EXPECT_EQ(ring.PeekFrontEntries(entries, 0, entry_count, bytes_read),
+            Status::InvalidArgument());
+  const span<byte> too_small = span(entries).first(kEntryBytes - 1);
+  EXPECT_EQ(ring.PeekFrontEntries(too_small, 8, entry_count, bytes_read),
+            Status::ResourceExhausted());
+  EXPECT_EQ(entry_count, 0u);
+  EXPECT_EQ(bytes_read, 0u);
+
+  EXPECT_EQ(ring.PopFrontEntries(11), Status::OutOfRange());
+  ASSERT_EQ(ring.PopFrontEntries(9), OkStatus());
+  EXPECT_EQ(PeekFront<size_t>(ring), 19u);
+}
+
+TEST(PrefixedEntryRingBufferMulti, DecodeTruncatedEntry) {
+  PrefixedEntryRingBuffer ring(true);
+  byte test_buffer[kTestBufferSize];
+  ASSERT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+  ASSERT_EQ(PushBack<size_t>(ring, 1u, 1u), OkStatus());
+
+  std::array<byte, sizeof(size_t) + 2> entry;
+  size_t entry_count = 0;
+  size_t bytes_read = 0;
+  ASSERT_EQ(ring.PeekFrontEntries(entry, 1, entry_count, bytes_read),
+            OkStatus());
+  size_t entry_bytes = 0;
+  EXPECT_EQ(ring.DecodeEntry(span(entry).first(bytes_read - 1), entry_bytes)
+                .status(),
+            Status::DataLoss());
+  EXPECT_EQ(ring.DecodeEntry(span<const byte>(), entry_bytes).status(),
+            Status::DataLoss());
+}
+
 }  // namespace
 }  // namespace ring_buffer
 }  // namespace pw
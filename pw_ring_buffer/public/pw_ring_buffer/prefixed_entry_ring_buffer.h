@@ -132,6 +132,44 @@ class PrefixedEntryRingBufferMulti {
     // OUT_OF_RANGE - No entries in ring buffer to pop.
     Status PopFront() { return buffer_->InternalPopFront(*this); }
 
+    // Copies as many of the oldest entries as fit in the provided destination
+    // span, up to `max_entries`, without popping them. Entries are copied
+    // whole, including their preambles, as a single contiguous run of at most
+    // two copies around the wrap point. Use DecodeEntry() to walk the copied
+    // entries.
+    //
+    // Precondition: the buffer data must not be corrupt, otherwise there will
+    // be a crash.
+    //
+    // Return values:
+    // OK - At least one entry was successfully read from the ring buffer.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // INVALID_ARGUMENT - `max_entries` is zero.
+    // OUT_OF_RANGE - No entries in ring buffer to read.
+    // RESOURCE_EXHAUSTED - Destination data span was smaller than the front
+    // entry. Nothing was copied.
+    Status PeekFrontEntries(span<std::byte> data,
+                            size_t max_entries,
+                            size_t& entry_count_out,
+                            size_t& bytes_read_out) const {
+      return buffer_->InternalPeekFrontEntries(
+          *this, data, max_entries, entry_count_out, bytes_read_out);
+    }
+
+    // Pop and discard the `count` oldest entries from the ring buffer.
+    //
+    // Precondition: the buffer data must not be corrupt, otherwise there will
+    // be a crash.
+    //
+    // Return values:
+    // OK - Entries successfully popped from the ring buffer.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // OUT_OF_RANGE - Fewer than `count` entries in ring buffer. Nothing was
+    // popped.
+    Status PopFrontEntries(size_t count) {
+      return buffer_->InternalPopFrontEntries(*this, count);
+    }
+
     // Get the size in bytes of the next chunk, not including preamble, to be
     // read.
     //
@@ -179,6 +217,68 @@ class PrefixedEntryRingBufferMulti {
     size_t entry_count_;
   };
 
+  // Space for a single entry claimed via Reserve(). The entry's preamble is
+  // written when the space is reserved; the data is filled in afterwards with
+  // Write() and becomes visible to readers once Commit() is called. All of the
+  // reserved data must be written before the entry can be committed.
+  //
+  // Write() only touches the reserved region of the buffer, so it may be
+  // called without holding the lock that serializes other operations on the
+  // ring buffer. This lets several producers copy their data concurrently
+  // while only the Reserve() and Commit() bookkeeping is serialized.
+  //
+  // Reservations are published to readers in the order they were reserved. An
+  // entry committed while an earlier reservation is still outstanding becomes
+  // readable as soon as the earlier one is committed. Every reservation must
+  // eventually be committed; an outstanding reservation holds its space and
+  // blocks the publication of all later entries.
+  class Reservation : public IntrusiveList<Reservation>::Item {
+   public:
+    constexpr Reservation()
+        : buffer_(nullptr),
+          data_idx_(0),
+          data_bytes_(0),
+          written_bytes_(0),
+          entry_bytes_(0),
+          trailing_entry_count_(0),
+          trailing_bytes_(0) {}
+
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    // Copies data into the reserved entry, continuing from where the previous
+    // call to Write() left off.
+    //
+    // Return values:
+    // OK - Data successfully written to the reservation.
+    // FAILED_PRECONDITION - The reservation is not active.
+    // RESOURCE_EXHAUSTED - The data does not fit in the remaining reserved
+    // space. Nothing was written.
+    Status Write(span<const std::byte> data);
+
+    // Size of the entry's data chunk, as requested in Reserve().
+    size_t size_bytes() const { return data_bytes_; }
+
+    // Number of data bytes that have not been written yet.
+    size_t remaining_bytes() const { return data_bytes_ - written_bytes_; }
+
+   private:
+    friend PrefixedEntryRingBufferMulti;
+
+    PrefixedEntryRingBufferMulti* buffer_;
+    size_t data_idx_;
+    size_t data_bytes_;
+    size_t written_bytes_;
+
+    // Size of the entry including its preamble.
+    size_t entry_bytes_;
+
+    // Entries that were committed after this reservation was made and are
+    // waiting for it to be committed before they can be published.
+    size_t trailing_entry_count_;
+    size_t trailing_bytes_;
+  };
+
   // An entry returned by the iterator containing the byte span of the entry
   // and preamble data (if the ring buffer was configured with a preamble).
   struct Entry {
@@ -262,6 +362,8 @@ class PrefixedEntryRingBufferMulti {
       : buffer_(nullptr),
         buffer_bytes_(0),
         write_idx_(0),
+        publish_idx_(0),
+        unpublished_bytes_(0),
         user_preamble_(user_preamble) {}
 
   // Set the raw buffer to be used by the ring buffer.
@@ -269,6 +371,7 @@ class PrefixedEntryRingBufferMulti {
   // Return values:
   // OK - successfully set the raw buffer.
   // INVALID_ARGUMENT - Argument was nullptr, size zero, or too large.
+  // FAILED_PRECONDITION - There are outstanding reservations.
   Status SetBuffer(span<std::byte> buffer);
 
   // Determines if the ring buffer has corrupted entries.
@@ -301,7 +404,8 @@ class PrefixedEntryRingBufferMulti {
   // buffer.
   Status DetachReader(Reader& reader);
 
-  // Removes all data from the ring buffer.
+  // Removes all data from the ring buffer. Space held by outstanding
+  // reservations is kept so they can still be committed.
   void Clear();
 
   // Write a chunk of data to the ring buffer. If available space is less than
@@ -353,6 +457,47 @@ class PrefixedEntryRingBufferMulti {
     return TryPushBack(data, static_cast<uint32_t>(user_preamble_data));
   }
 
+  // Reserve space for an entry with a data chunk of `data_size_bytes`, to be
+  // filled with Reservation::Write() and published with Commit(). As with
+  // PushBack(), the oldest entries are popped if needed to make space, but
+  // space held by other outstanding reservations is never reclaimed.
+  //
+  // Preamble argument is a caller-provided value prepended to the front of the
+  // entry. It is only used if user_preamble was set at class construction
+  // time.
+  //
+  // Return values:
+  // OK - Space successfully reserved.
+  // INVALID_ARGUMENT - The reservation is already active.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - Size of data is greater than buffer size.
+  // RESOURCE_EXHAUSTED - Outstanding reservations hold the space needed.
+  Status Reserve(Reservation& reservation,
+                 size_t data_size_bytes,
+                 uint32_t user_preamble_data = 0);
+
+  // Publishes a reserved entry to readers, along with any entries committed
+  // after it that were waiting for it. If an earlier reservation is still
+  // outstanding, the entry is published once that reservation is committed.
+  // The reservation is inactive and may be reused once this returns OK.
+  //
+  // Return values:
+  // OK - The entry was committed.
+  // INVALID_ARGUMENT - The reservation is not active in this ring buffer.
+  // FAILED_PRECONDITION - Not all of the reserved data was written. The
+  // reservation remains active, and can be committed once it is filled.
+  Status Commit(Reservation& reservation);
+
+  // Decodes the first of the entries copied out by Reader::PeekFrontEntries().
+  // The size of the whole entry, including its preamble, is written to
+  // `entry_bytes_out`; the next entry starts right after it.
+  //
+  // Return values:
+  // OK - The entry was successfully decoded.
+  // DATA_LOSS - The entry's preamble is corrupt or its data is truncated.
+  Result<Entry> DecodeEntry(span<const std::byte> entries,
+                            size_t& entry_bytes_out) const;
+
   // Get the size in bytes of all the current entries in the ring buffer,
   // including preamble and data chunk.
   size_t TotalUsedBytes() const { return buffer_bytes_ - RawAvailableBytes(); }
@@ -365,6 +510,9 @@ class PrefixedEntryRingBufferMulti {
   // newest entry at the highest address. If no readers are attached, the buffer
   // is deringed at the current write index.
   //
+  // Outstanding reservations are moved along with the data, so this must not
+  // run concurrently with Reservation::Write().
+  //
   // Return values:
   // OK - Buffer data successfully deringed.
   // FAILED_PRECONDITION - Buffer not initialized.
@@ -411,6 +559,18 @@ class PrefixedEntryRingBufferMulti {
   // OUT_OF_RANGE - No entries in ring buffer to pop.
   Status InternalPopFront(Reader& reader);
 
+  // Copy the oldest entries, including their preambles, that fit in `data`.
+  // See Reader::PeekFrontEntries().
+  Status InternalPeekFrontEntries(const Reader& reader,
+                                  span<std::byte> data,
+                                  size_t max_entries,
+                                  size_t& entry_count_out,
+                                  size_t& bytes_read_out) const;
+
+  // Pop and discard the `count` oldest entries from the ring buffer. See
+  // Reader::PopFrontEntries().
+  Status InternalPopFrontEntries(Reader& reader, size_t count);
+
   // Get the size in bytes of the next chunk, not including preamble, to be
   // read.
   size_t InternalFrontEntryDataSizeBytes(const Reader& reader) const;
@@ -449,6 +609,19 @@ class PrefixedEntryRingBufferMulti {
                           uint32_t user_preamble_data,
                           bool pop_front_if_needed);
 
+  // Makes space for a new entry, writes its preamble and advances the write
+  // index past the entry's data chunk. The location of the data chunk and the
+  // total entry size are returned through the output arguments.
+  Status InternalReserve(size_t data_size_bytes,
+                         uint32_t user_preamble_data,
+                         bool pop_front_if_needed,
+                         size_t& data_idx_out,
+                         size_t& entry_bytes_out);
+
+  // Makes `entry_count` entries totalling `entry_bytes` following the publish
+  // index visible to all readers.
+  void Publish(size_t entry_count, size_t entry_bytes);
+
   // Internal function to pop all of the slowest readers. This function may pop
   // multiple readers if multiple are slow.
   //
@@ -490,6 +663,10 @@ class PrefixedEntryRingBufferMulti {
   // of the ring buffer. This is basic, raw operation with no safety checks.
   void RawWrite(span<const std::byte> source);
 
+  // Same as RawWrite, but writes at the given index and does not move the
+  // write index.
+  void RawWriteAt(size_t destination_idx, span<const std::byte> source);
+
   // Do the basic read of the specified number of bytes starting at the given
   // index of the ring buffer to the destination, handing any wrap-around of
   // the ring buffer. This is basic, raw operation with no safety checks.
@@ -503,11 +680,20 @@ class PrefixedEntryRingBufferMulti {
   size_t buffer_bytes_;
 
   size_t write_idx_;
+
+  // End of the entries that are visible to readers. Entries between this and
+  // the write index have been reserved, but are not published yet.
+  size_t publish_idx_;
+  size_t unpublished_bytes_;
+
   const bool user_preamble_;
 
   // List of attached readers.
   IntrusiveList<Reader> readers_;
 
+  // Outstanding reservations, in the order they were made.
+  IntrusiveList<Reservation> reservations_;
+
   // Maximum bufer size allowed. Restricted to this to allow index aliasing to
   // not overflow.
   static constexpr size_t kMaxBufferBytes =
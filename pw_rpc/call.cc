@@ -238,6 +238,30 @@ Status Call::WriteLocked(ConstByteSpan payload) {
                     payload);
 }
 
+Status Call::WriteEncoded(
+    size_t max_payload_size,
+    const Function<StatusWithSize(ByteSpan)>& encode_payload) {
+  RpcLockGuard lock;
+  if (!active_locked()) {
+    return Status::FailedPrecondition();
+  }
+
+#if PW_RPC_DYNAMIC_ALLOCATION
+  ByteSpan buffer = encoding_buffer.AllocatePayloadBuffer(max_payload_size);
+#else
+  static_cast<void>(max_payload_size);
+  ByteSpan buffer = encoding_buffer.AllocatePayloadBuffer();
+#endif  // PW_RPC_DYNAMIC_ALLOCATION
+
+  const StatusWithSize encoded = encode_payload(buffer);
+  if (!encoded.ok()) {
+    encoding_buffer.ReleaseIfAllocated();
+    return encoded.status();
+  }
+
+  return WriteLocked(buffer.first(encoded.size()));
+}
+
 // This definition is in the .cc file because the Endpoint class is not defined
 // in the Call header, due to circular dependencies between the two.
 void Call::CloseAndMarkForCleanup(Status error) {
@@ -257,6 +257,12 @@ class Call : public IntrusiveList<Call>::Item, private rpc::Writer {
   Status WriteLocked(ConstByteSpan payload)
       PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock());
 
+  // Encodes a payload directly into the encoding buffer and sends it in either
+  // a server or client stream packet.
+  Status WriteEncoded(size_t max_payload_size,
+                      const Function<StatusWithSize(ByteSpan)>& encode_payload)
+      PW_LOCKS_EXCLUDED(rpc_lock());
+
   // Sends the initial request for a client call. If the request fails, the call
   // is closed.
   void SendInitialClientRequest(ConstByteSpan payload)
@@ -621,4 +627,11 @@ inline Status Writer::Write(ConstByteSpan payload) {
   return static_cast<internal::Call*>(this)->Write(payload);
 }
 
+inline Status Writer::WriteEncoded(
+    size_t max_payload_size,
+    const Function<StatusWithSize(ByteSpan)>& encode_payload) {
+  return static_cast<internal::Call*>(this)->WriteEncoded(max_payload_size,
+                                                          encode_payload);
+}
+
 }  // namespace pw::rpc
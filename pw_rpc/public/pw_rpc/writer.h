@@ -16,8 +16,10 @@
 #include <cstdint>
 
 #include "pw_bytes/span.h"
+#include "pw_function/function.h"
 #include "pw_rpc/internal/lock.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 
 namespace pw::rpc {
 namespace internal {
@@ -40,6 +42,21 @@ class Writer {
 
   Status Write(ConstByteSpan payload) PW_LOCKS_EXCLUDED(internal::rpc_lock());
 
+  // Encodes a payload directly into pw_rpc's encoding buffer and sends it.
+  // This avoids copying payloads which would otherwise be encoded into a
+  // separate buffer before being written.
+  //
+  // encode_payload is called with the buffer into which to encode the payload
+  // and returns the encoded size. The buffer holds at least max_payload_size
+  // bytes if that fits in the encoding buffer. encode_payload is called while
+  // the RPC lock is held, so it must not block or call into pw_rpc.
+  //
+  // Returns the status from encode_payload if it fails, or the result of the
+  // write otherwise.
+  Status WriteEncoded(size_t max_payload_size,
+                      const Function<StatusWithSize(ByteSpan)>& encode_payload)
+      PW_LOCKS_EXCLUDED(internal::rpc_lock());
+
  private:
   // Only allow Call to inherit from Writer. This guarantees that Writers can
   // always safely downcast to Call.
@@ -14,6 +14,7 @@
 
 #include "pw_rpc/raw/server_reader_writer.h"
 
+#include <cstring>
 #include <optional>
 
 #include "pw_rpc/internal/lock.h"
@@ -558,4 +559,56 @@ TEST(RawServerReaderWriter, UsableAsWriter) {
       kWriterData);
 }
 
+TEST(RawServerWriter, WriteEncoded_EncodesIntoPayloadBuffer) {
+  ReaderWriterTestContext ctx;
+  RawServerWriter call =
+      RawServerWriter::Open<TestService::TestServerStreamRpc>(
+          ctx.server, ctx.channel.id(), ctx.service);
+
+  EXPECT_EQ(OkStatus(),
+            call.as_writer().WriteEncoded(
+                sizeof(kWriterData), [](ByteSpan buffer) {
+                  if (buffer.size() < sizeof(kWriterData)) {
+                    return StatusWithSize::ResourceExhausted();
+                  }
+                  std::memcpy(buffer.data(), kWriterData, sizeof(kWriterData));
+                  return StatusWithSize(sizeof(kWriterData));
+                }));
+
+  EXPECT_STREQ(reinterpret_cast<const char*>(
+                   ctx.output.payloads<TestService::TestServerStreamRpc>()
+                       .back()
+                       .data()),
+               kWriterData);
+}
+
+TEST(RawServerWriter, WriteEncoded_EncodeFailure_SendsNothing) {
+  ReaderWriterTestContext ctx;
+  RawServerWriter call =
+      RawServerWriter::Open<TestService::TestServerStreamRpc>(
+          ctx.server, ctx.channel.id(), ctx.service);
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            call.as_writer().WriteEncoded(
+                sizeof(kWriterData), [](ByteSpan) {
+                  return StatusWithSize::ResourceExhausted();
+                }));
+
+  EXPECT_EQ(ctx.output.total_packets(), 0u);
+  EXPECT_TRUE(call.active());
+}
+
+TEST(RawServerWriter, WriteEncoded_Closed_FailsWithoutEncoding) {
+  RawServerWriter call;
+
+  bool encode_called = false;
+  EXPECT_EQ(Status::FailedPrecondition(),
+            call.as_writer().WriteEncoded(
+                sizeof(kWriterData), [&encode_called](ByteSpan) {
+                  encode_called = true;
+                  return StatusWithSize(0);
+                }));
+  EXPECT_FALSE(encode_called);
+}
+
 }  // namespace pw::rpc
@@ -0,0 +1,255 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_LOG_MODULE_NAME "PWSU"
+#define PW_LOG_LEVEL PW_LOG_LEVEL_WARN
+
+#include "pw_software_update/bundle_payload_hasher.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "pw_log/log.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_software_update/update_bundle.pwpb.h"
+
+namespace pw::software_update {
+namespace {
+
+constexpr uint32_t kTargetPayloadsField =
+    static_cast<uint32_t>(UpdateBundle::Fields::kTargetPayloads);
+
+// Field number of the value in a map entry.
+constexpr uint32_t kMapEntryValueField = 2;
+
+// A varint is at most 10 bytes, so its last byte starts at bit 63.
+constexpr unsigned kMaxVarintShift = 63;
+
+}  // namespace
+
+void BundlePayloadHasher::Reset() {
+  digest_count_ = 0;
+  status_ = OkStatus();
+  state_ = State::kTag;
+  offset_ = 0;
+  varint_ = 0;
+  varint_shift_ = 0;
+  field_number_ = 0;
+  in_payload_entry_ = false;
+  entry_end_ = 0;
+  remaining_ = 0;
+  payload_offset_ = 0;
+}
+
+Status BundlePayloadHasher::DoWrite(ConstByteSpan data) {
+  if (output_ != nullptr) {
+    if (Status status = output_->Write(data); !status.ok()) {
+      // The output may be missing some of the hashed data, so none of the
+      // digests can be trusted to match it.
+      status_ = status;
+      digest_count_ = 0;
+      return status;
+    }
+  }
+
+  // Hashing errors are reported through status() rather than failing the
+  // write. Payloads that were not hashed are verified by reading them.
+  Update(data).IgnoreError();
+  return OkStatus();
+}
+
+Status BundlePayloadHasher::Update(ConstByteSpan data) {
+  while (!data.empty() && status_.ok()) {
+    if (state_ == State::kSkip || state_ == State::kPayload) {
+      const size_t size = std::min(remaining_, data.size());
+      if (state_ == State::kPayload) {
+        sha256_.Update(data.first(size));
+      }
+      data = data.subspan(size);
+      offset_ += size;
+      remaining_ -= size;
+      if (remaining_ == 0u) {
+        if (state_ == State::kPayload) {
+          FinishPayload();
+        }
+        FinishField();
+      }
+      continue;
+    }
+
+    const std::byte b = data.front();
+    data = data.subspan(1);
+    offset_ += 1;
+
+    if (!ReadVarintByte(b)) {
+      continue;
+    }
+
+    switch (state_) {
+      case State::kTag:
+        HandleTag();
+        break;
+      case State::kLength:
+        HandleLength();
+        break;
+      case State::kVarint:
+        varint_ = 0;
+        varint_shift_ = 0;
+        FinishField();
+        break;
+      case State::kSkip:
+      case State::kPayload:
+        break;
+    }
+  }
+  return status_;
+}
+
+Result<ConstByteSpan> BundlePayloadHasher::GetDigest(size_t offset,
+                                                     size_t size) const {
+  for (size_t i = 0; i < digest_count_; ++i) {
+    if (digests_[i].offset == offset && digests_[i].size == size) {
+      return ConstByteSpan(digests_[i].sha256);
+    }
+  }
+  return Status::NotFound();
+}
+
+bool BundlePayloadHasher::ReadVarintByte(std::byte b) {
+  if (varint_shift_ > kMaxVarintShift) {
+    SetError(Status::DataLoss());
+    return false;
+  }
+
+  varint_ |= static_cast<uint64_t>(b & std::byte{0x7f}) << varint_shift_;
+  varint_shift_ += 7;
+  return (b & std::byte{0x80}) == std::byte{0};
+}
+
+void BundlePayloadHasher::HandleTag() {
+  const uint64_t key = varint_;
+  varint_ = 0;
+  varint_shift_ = 0;
+
+  if (!protobuf::FieldKey::IsValidKey(key)) {
+    SetError(Status::DataLoss());
+    return;
+  }
+
+  const protobuf::FieldKey field(static_cast<uint32_t>(key));
+  field_number_ = field.field_number();
+
+  switch (field.wire_type()) {
+    case protobuf::WireType::kVarint:
+      state_ = State::kVarint;
+      break;
+    case protobuf::WireType::kFixed64:
+      state_ = State::kSkip;
+      remaining_ = sizeof(uint64_t);
+      break;
+    case protobuf::WireType::kFixed32:
+      state_ = State::kSkip;
+      remaining_ = sizeof(uint32_t);
+      break;
+    case protobuf::WireType::kDelimited:
+      state_ = State::kLength;
+      break;
+    default:
+      SetError(Status::DataLoss());
+      break;
+  }
+}
+
+void BundlePayloadHasher::HandleLength() {
+  const uint64_t length = varint_;
+  varint_ = 0;
+  varint_shift_ = 0;
+
+  if (length > std::numeric_limits<size_t>::max() - offset_) {
+    SetError(Status::DataLoss());
+    return;
+  }
+  const size_t size = static_cast<size_t>(length);
+  if (in_payload_entry_ && offset_ + size > entry_end_) {
+    SetError(Status::DataLoss());
+    return;
+  }
+
+  if (!in_payload_entry_ && field_number_ == kTargetPayloadsField) {
+    // Parse the map entry's fields rather than skipping it.
+    in_payload_entry_ = true;
+    entry_end_ = offset_ + size;
+    state_ = State::kTag;
+    FinishField();
+    return;
+  }
+
+  remaining_ = size;
+  if (in_payload_entry_ && field_number_ == kMapEntryValueField) {
+    state_ = State::kPayload;
+    payload_offset_ = offset_;
+    sha256_ = crypto::sha256::Sha256();
+  } else {
+    state_ = State::kSkip;
+  }
+
+  if (remaining_ == 0u) {
+    if (state_ == State::kPayload) {
+      FinishPayload();
+    }
+    FinishField();
+  }
+}
+
+void BundlePayloadHasher::FinishPayload() {
+  if (digest_count_ == digests_.size()) {
+    PW_LOG_WARN("Too many target payloads to hash; the rest will be read");
+    SetError(Status::ResourceExhausted());
+    return;
+  }
+
+  PayloadDigest& digest = digests_[digest_count_];
+  if (!sha256_.Final(digest.sha256).ok()) {
+    SetError(Status::Internal());
+    return;
+  }
+  digest.offset = payload_offset_;
+  digest.size = offset_ - payload_offset_;
+  digest_count_ += 1;
+}
+
+void BundlePayloadHasher::FinishField() {
+  if (!status_.ok()) {
+    return;
+  }
+
+  state_ = State::kTag;
+  if (!in_payload_entry_) {
+    return;
+  }
+
+  if (offset_ == entry_end_) {
+    in_payload_entry_ = false;
+  } else if (offset_ > entry_end_) {
+    SetError(Status::DataLoss());
+  }
+}
+
+void BundlePayloadHasher::SetError(Status status) {
+  if (status_.ok()) {
+    status_ = status;
+  }
+}
+
+}  // namespace pw::software_update
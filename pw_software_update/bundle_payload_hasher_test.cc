@@ -0,0 +1,184 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_software_update/bundle_payload_hasher.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "pw_crypto/sha256.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_protobuf/message.h"
+#include "pw_software_update/update_bundle.pwpb.h"
+#include "pw_stream/interval_reader.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw::software_update {
+namespace {
+
+constexpr uint32_t kSnapshotMetadata =
+    static_cast<uint32_t>(UpdateBundle::Fields::kSnapshotMetadata);
+constexpr uint32_t kTargetPayloads =
+    static_cast<uint32_t>(UpdateBundle::Fields::kTargetPayloads);
+constexpr uint32_t kKey = 1;
+constexpr uint32_t kValue = 2;
+
+constexpr std::string_view kNames[] = {"file_a", "file_b", "file_c"};
+
+class BundlePayloadHasherTest : public ::testing::Test {
+ protected:
+  BundlePayloadHasherTest() {
+    for (size_t i = 0; i < payloads_.size(); ++i) {
+      for (size_t j = 0; j < payloads_[i].size(); ++j) {
+        payloads_[i][j] = static_cast<std::byte>(i * 31 + j);
+      }
+    }
+  }
+
+  // Encodes a bundle with metadata and unknown fields around each payload.
+  ConstByteSpan EncodeBundle(bool value_before_key = false) {
+    protobuf::MemoryEncoder encoder(bundle_buffer_);
+    EXPECT_EQ(OkStatus(), encoder.WriteBytes(kSnapshotMetadata, payloads_[0]));
+    for (size_t i = 0; i < payloads_.size(); ++i) {
+      EXPECT_EQ(OkStatus(), encoder.WriteFixed64(15, 0x1234));
+      protobuf::StreamEncoder entry = encoder.GetNestedEncoder(kTargetPayloads);
+      if (value_before_key) {
+        EXPECT_EQ(OkStatus(), entry.WriteBytes(kValue, payloads_[i]));
+        EXPECT_EQ(OkStatus(), entry.WriteUint32(7, 300));
+        EXPECT_EQ(OkStatus(), entry.WriteString(kKey, kNames[i]));
+      } else {
+        EXPECT_EQ(OkStatus(), entry.WriteString(kKey, kNames[i]));
+        EXPECT_EQ(OkStatus(), entry.WriteUint32(7, 300));
+        EXPECT_EQ(OkStatus(), entry.WriteBytes(kValue, payloads_[i]));
+      }
+    }
+    EXPECT_EQ(OkStatus(), encoder.status());
+    return ConstByteSpan(encoder);
+  }
+
+  // Expects the hasher's digest of each payload to be its SHA-256 digest.
+  void ExpectDigests(ConstByteSpan bundle,
+                     const BundlePayloadHasher& hasher,
+                     size_t count = std::size(kNames)) {
+    stream::MemoryReader reader(bundle);
+    protobuf::Message message(reader, bundle.size());
+    protobuf::StringToBytesMap payloads =
+        message.AsStringToBytesMap(kTargetPayloads);
+
+    for (size_t i = 0; i < std::size(kNames); ++i) {
+      stream::IntervalReader payload = payloads[kNames[i]].GetBytesReader();
+      ASSERT_TRUE(payload.ok());
+      Result<ConstByteSpan> digest =
+          hasher.GetDigest(payload.start(), payload.interval_size());
+      if (i >= count) {
+        EXPECT_EQ(Status::NotFound(), digest.status());
+        continue;
+      }
+      ASSERT_EQ(OkStatus(), digest.status());
+
+      std::array<std::byte, crypto::sha256::kDigestSizeBytes> expected;
+      ASSERT_EQ(OkStatus(), crypto::sha256::Hash(payloads_[i], expected));
+      EXPECT_EQ(0, std::memcmp(digest->data(), expected.data(), 32));
+    }
+  }
+
+  std::array<std::array<std::byte, 200>, std::size(kNames)> payloads_;
+  std::array<std::byte, 1024> bundle_buffer_;
+};
+
+TEST_F(BundlePayloadHasherTest, Update_HashesEachPayload) {
+  ConstByteSpan bundle = EncodeBundle();
+  BundlePayloadHasherBuffer<4> hasher;
+  EXPECT_EQ(OkStatus(), hasher.Update(bundle));
+  EXPECT_EQ(hasher.digest_count(), std::size(kNames));
+  EXPECT_EQ(hasher.bytes_parsed(), bundle.size());
+  ExpectDigests(bundle, hasher);
+
+  EXPECT_EQ(Status::NotFound(), hasher.GetDigest(0, bundle.size()).status());
+}
+
+TEST_F(BundlePayloadHasherTest, Update_OneByteAtATime) {
+  ConstByteSpan bundle = EncodeBundle();
+  BundlePayloadHasherBuffer<4> hasher;
+  for (size_t i = 0; i < bundle.size(); ++i) {
+    ASSERT_EQ(OkStatus(), hasher.Update(bundle.subspan(i, 1)));
+  }
+  ExpectDigests(bundle, hasher);
+}
+
+TEST_F(BundlePayloadHasherTest, Update_ValueBeforeKey) {
+  ConstByteSpan bundle = EncodeBundle(/*value_before_key=*/true);
+  BundlePayloadHasherBuffer<4> hasher;
+  EXPECT_EQ(OkStatus(), hasher.Update(bundle));
+  ExpectDigests(bundle, hasher);
+}
+
+TEST_F(BundlePayloadHasherTest, Update_TooManyPayloads) {
+  ConstByteSpan bundle = EncodeBundle();
+  BundlePayloadHasherBuffer<2> hasher;
+  EXPECT_EQ(Status::ResourceExhausted(), hasher.Update(bundle));
+  EXPECT_EQ(hasher.digest_count(), 2u);
+  ExpectDigests(bundle, hasher, 2);
+}
+
+TEST_F(BundlePayloadHasherTest, Update_MalformedBundle) {
+  BundlePayloadHasherBuffer<4> hasher;
+  // Field 1 with the deprecated start group wire type.
+  constexpr std::byte kBadTag[] = {std::byte{0x0b}};
+  EXPECT_EQ(Status::DataLoss(), hasher.Update(kBadTag));
+
+  // A payload that extends past the end of its map entry.
+  hasher.Reset();
+  constexpr std::byte kOverflow[] = {
+      std::byte{0x22}, std::byte{0x02}, std::byte{0x12}, std::byte{0x05}};
+  EXPECT_EQ(Status::DataLoss(), hasher.Update(kOverflow));
+  EXPECT_EQ(hasher.digest_count(), 0u);
+
+  hasher.Reset();
+  ConstByteSpan bundle = EncodeBundle();
+  EXPECT_EQ(OkStatus(), hasher.Update(bundle));
+  ExpectDigests(bundle, hasher);
+}
+
+TEST_F(BundlePayloadHasherTest, Write_ForwardsToOutput) {
+  ConstByteSpan bundle = EncodeBundle();
+  stream::MemoryWriterBuffer<1024> output;
+  BundlePayloadHasherBuffer<4> hasher(output);
+
+  ASSERT_EQ(OkStatus(), hasher.Write(bundle.first(100)));
+  ASSERT_EQ(OkStatus(), hasher.Write(bundle.subspan(100)));
+  EXPECT_EQ(OkStatus(), hasher.status());
+  ASSERT_EQ(output.bytes_written(), bundle.size());
+  EXPECT_EQ(0, std::memcmp(output.data(), bundle.data(), bundle.size()));
+  ExpectDigests(bundle, hasher);
+}
+
+TEST_F(BundlePayloadHasherTest, Write_OutputErrorDiscardsDigests) {
+  ConstByteSpan bundle = EncodeBundle();
+  stream::MemoryWriterBuffer<512> output;
+  BundlePayloadHasherBuffer<4> hasher(output);
+
+  ASSERT_EQ(OkStatus(), hasher.Write(bundle.first(500)));
+  EXPECT_GT(hasher.digest_count(), 0u);
+  EXPECT_EQ(Status::ResourceExhausted(), hasher.Write(bundle.subspan(500)));
+  EXPECT_EQ(Status::ResourceExhausted(), hasher.status());
+  ExpectDigests(bundle, hasher, 0);
+}
+
+}  // namespace
+}  // namespace pw::software_update
@@ -14,6 +14,8 @@
 #pragma once
 
 #include "pw_blob_store/blob_store.h"
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
 #include "pw_software_update/openable_reader.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
@@ -29,6 +31,9 @@ class BlobStoreOpenableReader final : public OpenableReader {
   Status Close() override { return blob_reader_.Close(); }
   bool IsOpen() override { return blob_reader_.IsOpen(); }
   stream::SeekableReader& reader() override { return blob_reader_; }
+  Result<ConstByteSpan> GetMemoryMappedData() override {
+    return blob_reader_.GetMemoryMappedBlob();
+  }
 
  private:
   blob_store::BlobStore& blob_store_;
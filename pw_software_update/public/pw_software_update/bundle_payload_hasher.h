@@ -0,0 +1,145 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_crypto/sha256.h"
+#include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::software_update {
+
+// Hashes the target payloads of an update bundle while the bundle is written,
+// such as by the bundle's transfer handler. UpdateBundleAccessor uses the
+// digests to verify in-bundle payloads, rather than reading each payload back
+// and hashing it once the transfer completes.
+//
+// The hasher parses the serialized UpdateBundle as it arrives. It must see
+// every byte of the bundle exactly once, in order, starting from offset 0.
+// When constructed with an output writer, the hasher forwards each write to
+// it and only hashes the data once it is written. If a write fails, the output
+// no longer matches the digests, so they are discarded.
+class BundlePayloadHasher : public stream::NonSeekableWriter {
+ public:
+  struct PayloadDigest {
+    size_t offset;  // Offset of the payload bytes in the bundle.
+    size_t size;
+    std::array<std::byte, crypto::sha256::kDigestSizeBytes> sha256;
+  };
+
+  // Hashes the bundle without writing it anywhere.
+  explicit BundlePayloadHasher(span<PayloadDigest> digests)
+      : BundlePayloadHasher(nullptr, digests) {}
+
+  // Hashes the bundle as it is written to output.
+  BundlePayloadHasher(stream::Writer& output, span<PayloadDigest> digests)
+      : BundlePayloadHasher(&output, digests) {}
+
+  // Discards all digests, to start hashing a new bundle.
+  void Reset();
+
+  // Hashes the next bytes of the bundle. Returns the hasher's status.
+  Status Update(ConstByteSpan data);
+
+  // Returns the SHA-256 digest of the bundle bytes in [offset, offset + size),
+  // if they are a target payload. Returns:
+  //
+  // OK - the digest of the payload
+  // NOT_FOUND - no payload with the given offset and size was hashed, or a
+  //     write to the output failed
+  Result<ConstByteSpan> GetDigest(size_t offset, size_t size) const;
+
+  // Returns:
+  //
+  // OK - all payloads so far were hashed
+  // RESOURCE_EXHAUSTED - there were more payloads than digests; only the
+  //     first payloads were hashed
+  // DATA_LOSS - the bundle is malformed; payloads after the error were not
+  //     hashed
+  // Any error from writing to the output
+  Status status() const { return status_; }
+
+  // The number of bundle bytes parsed.
+  size_t bytes_parsed() const { return offset_; }
+
+  size_t digest_count() const { return digest_count_; }
+
+ private:
+  enum class State {
+    kTag,      // Reading a field's tag.
+    kLength,   // Reading a length-delimited field's length.
+    kVarint,   // Skipping a varint field.
+    kSkip,     // Skipping the rest of a field.
+    kPayload,  // Hashing the rest of a target payload.
+  };
+
+  BundlePayloadHasher(stream::Writer* output, span<PayloadDigest> digests)
+      : output_(output), digests_(digests) {
+    Reset();
+  }
+
+  Status DoWrite(ConstByteSpan data) override;
+
+  // Consumes one byte of a varint. Returns true once the varint is complete.
+  bool ReadVarintByte(std::byte b);
+
+  void HandleTag();
+  void HandleLength();
+  void FinishPayload();
+
+  // Called when a field ends, to close the map entry that contained it.
+  void FinishField();
+
+  void SetError(Status status);
+
+  stream::Writer* const output_;
+  const span<PayloadDigest> digests_;
+  size_t digest_count_;
+  Status status_;
+
+  State state_;
+  size_t offset_;  // Bundle bytes consumed.
+
+  uint64_t varint_;
+  unsigned varint_shift_;
+  uint32_t field_number_;
+
+  bool in_payload_entry_;
+  size_t entry_end_;
+  size_t remaining_;  // Bytes left in a skipped field or payload.
+
+  size_t payload_offset_;
+  crypto::sha256::Sha256 sha256_;
+};
+
+template <size_t kMaxPayloads>
+class BundlePayloadHasherBuffer : public BundlePayloadHasher {
+ public:
+  BundlePayloadHasherBuffer() : BundlePayloadHasher(digests_) {}
+
+  explicit BundlePayloadHasherBuffer(stream::Writer& output)
+      : BundlePayloadHasher(output, digests_) {}
+
+ private:
+  std::array<PayloadDigest, kMaxPayloads> digests_;
+};
+
+}  // namespace pw::software_update
@@ -17,6 +17,7 @@
 #include <string_view>
 
 #include "pw_result/result.h"
+#include "pw_software_update/bundle_payload_hasher.h"
 #include "pw_software_update/manifest_accessor.h"
 #include "pw_software_update/update_bundle_accessor.h"
 #include "pw_status/status.h"
@@ -56,6 +57,19 @@ class BundledUpdateBackend {
   // either BeforeUpdateAbort() or BeforeBundleVerify().
   virtual void DisableBundleTransferHandler() = 0;
 
+  // Optionally returns a hasher that the bundle transfer handler wrote the
+  // bundle through, with the digests of its target payloads. In-bundle target
+  // payloads are then verified against these digests, rather than by reading
+  // and hashing each payload after the transfer. Payloads without a digest are
+  // still read and hashed.
+  //
+  // The hasher must have seen the whole bundle that is being verified. Its
+  // digests are ignored unless its status is OK and it parsed as many bytes as
+  // the stored bundle holds.
+  virtual const BundlePayloadHasher* GetBundlePayloadHasher() {
+    return nullptr;
+  }
+
   // Perform any product-specific abort tasks before marking the update as
   // aborted in bundled updater.  This should set any downstream state to a
   // default no-update-pending state.
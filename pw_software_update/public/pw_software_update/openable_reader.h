@@ -13,6 +13,9 @@
 // the License.
 #pragma once
 
+#include "pw_bytes/span.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
 #include "pw_stream/stream.h"
 
 namespace pw::software_update {
@@ -29,6 +32,14 @@ class OpenableReader {
   // successful call to Open, before the matching call to Close.
   virtual stream::SeekableReader& reader() = 0;
 
+  // Returns all of the reader's data, if it is stored in directly addressable
+  // memory such as memory-mapped flash, so that it can be accessed without
+  // copying. Must only be called after a successful call to Open, before the
+  // matching call to Close. Returns UNIMPLEMENTED if the data is not mapped.
+  virtual Result<ConstByteSpan> GetMemoryMappedData() {
+    return Status::Unimplemented();
+  }
+
   virtual ~OpenableReader() = default;
 };
 
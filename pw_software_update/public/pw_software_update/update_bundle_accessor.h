@@ -150,6 +150,8 @@ class UpdateBundleAccessor {
   OpenableReader& update_reader_;
   BundledUpdateBackend& backend_;
   protobuf::Message bundle_;
+  // Size of the opened bundle in bytes.
+  size_t bundle_size_ = 0;
   // The current, cached, trusted `SignedRootMetadata{}`.
   protobuf::Message trusted_root_;
   bool self_verification_;
@@ -232,6 +234,13 @@ class UpdateBundleAccessor {
                                      protobuf::Bytes expected_sha256,
                                      stream::IntervalReader payload_reader);
 
+  // Computes the SHA-256 digest of an in-bundle target payload. Uses the
+  // backend's BundlePayloadHasher digest if the hasher parsed the whole bundle
+  // without error, or the memory-mapped bundle when available, and otherwise
+  // reads the payload.
+  Status HashInBundleTargetPayload(stream::IntervalReader& payload_reader,
+                                   ByteSpan out_digest);
+
   // For a target with no corresponding payload in the bundle, verify
   // its on-device payload bytes measures up to the expected length and sha256
   // hash.
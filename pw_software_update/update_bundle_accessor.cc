@@ -26,6 +26,7 @@
 #include "pw_log/log.h"
 #include "pw_protobuf/message.h"
 #include "pw_result/result.h"
+#include "pw_software_update/bundle_payload_hasher.h"
 #include "pw_software_update/config.h"
 #include "pw_software_update/manifest_accessor.h"
 #include "pw_software_update/update_bundle.pwpb.h"
@@ -351,8 +352,8 @@ Status UpdateBundleAccessor::Close() {
 
 Status UpdateBundleAccessor::DoOpen() {
   PW_TRY(update_reader_.Open());
-  bundle_ = protobuf::Message(update_reader_.reader(),
-                              update_reader_.reader().ConservativeReadLimit());
+  bundle_size_ = update_reader_.reader().ConservativeReadLimit();
+  bundle_ = protobuf::Message(update_reader_.reader(), bundle_size_);
   if (!bundle_.ok()) {
     update_reader_.Close().IgnoreError();
     return bundle_.status();
@@ -804,7 +805,7 @@ Status UpdateBundleAccessor::VerifyInBundleTargetPayload(
   }
 
   std::byte actual_sha256[crypto::sha256::kDigestSizeBytes] = {};
-  PW_TRY(crypto::sha256::Hash(payload_reader, actual_sha256));
+  PW_TRY(HashInBundleTargetPayload(payload_reader, actual_sha256));
   Result<bool> hash_equal = expected_sha256.Equal(actual_sha256);
   PW_TRY(hash_equal.status());
   if (!hash_equal.value()) {
@@ -824,4 +825,34 @@ ManifestAccessor UpdateBundleAccessor::GetManifest() {
   return ManifestAccessor::FromBundle(bundle_);
 }
 
+Status UpdateBundleAccessor::HashInBundleTargetPayload(
+    stream::IntervalReader& payload_reader, ByteSpan out_digest) {
+  if (&payload_reader.source_reader() == &update_reader_.reader()) {
+    // Use the digest taken while the bundle was transferred, if there is one.
+    // Digests are only trusted if the hasher parsed exactly the stored bundle
+    // without error; otherwise it may have seen another or a partial bundle.
+    if (const BundlePayloadHasher* hasher = backend_.GetBundlePayloadHasher();
+        hasher != nullptr && hasher->status().ok() &&
+        hasher->bytes_parsed() == bundle_size_) {
+      Result<ConstByteSpan> digest = hasher->GetDigest(
+          payload_reader.start(), payload_reader.interval_size());
+      if (digest.ok()) {
+        std::memcpy(out_digest.data(), digest->data(), digest->size());
+        return OkStatus();
+      }
+    }
+
+    // Hash the payload in place rather than copying it through the reader.
+    Result<ConstByteSpan> bundle_data = update_reader_.GetMemoryMappedData();
+    if (bundle_data.ok() && payload_reader.end() <= bundle_data->size()) {
+      return crypto::sha256::Hash(
+          bundle_data->subspan(payload_reader.start(),
+                               payload_reader.interval_size()),
+          out_digest);
+    }
+  }
+
+  return crypto::sha256::Hash(payload_reader, out_digest);
+}
+
 }  // namespace pw::software_update
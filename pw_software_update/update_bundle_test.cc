@@ -12,13 +12,16 @@
 // License for the specific language governing permissions and limitations under
 // the License.
 
+#include <algorithm>
 #include <array>
 
 #include "pw_blob_store/blob_store.h"
 #include "pw_kvs/fake_flash_memory.h"
 #include "pw_kvs/test_key_value_store.h"
 #include "pw_software_update/blob_store_openable_reader.h"
+#include "pw_software_update/bundle_payload_hasher.h"
 #include "pw_software_update/bundled_update_backend.h"
+#include "pw_software_update/openable_reader.h"
 #include "pw_software_update/update_bundle_accessor.h"
 #include "pw_stream/memory_stream.h"
 #include "pw_unit_test/framework.h"
@@ -36,6 +39,7 @@ constexpr size_t kSectorSize = 2048;
 constexpr size_t kSectorCount = 2;
 constexpr size_t kMetadataBufferSize =
     blob_store::BlobStore::BlobWriter::RequiredMetadataBufferSize(0);
+constexpr size_t kMaxPayloads = 4;
 
 class TestBundledUpdateBackend final : public BundledUpdateBackend {
  public:
@@ -107,6 +111,14 @@ class TestBundledUpdateBackend final : public BundledUpdateBackend {
     return manifest_writer_;
   }
 
+  void SetBundlePayloadHasher(const BundlePayloadHasher* hasher) {
+    bundle_payload_hasher_ = hasher;
+  }
+
+  const BundlePayloadHasher* GetBundlePayloadHasher() override {
+    return bundle_payload_hasher_;
+  }
+
   Status SafelyPersistRootMetadata(
       [[maybe_unused]] stream::IntervalReader root_metadata) override {
     new_root_persisted_ = true;
@@ -120,6 +132,7 @@ class TestBundledUpdateBackend final : public BundledUpdateBackend {
   stream::IntervalReader trusted_root_reader_;
   stream::MemoryReader manifest_reader_;
   stream::Writer* manifest_writer_ = nullptr;
+  const BundlePayloadHasher* bundle_payload_hasher_ = nullptr;
   bool before_manifest_read_called_ = false;
   bool before_manifest_write_called_ = false;
   bool after_manifest_write_called_ = false;
@@ -130,6 +143,43 @@ class TestBundledUpdateBackend final : public BundledUpdateBackend {
   stream::MemoryReader trusted_root_memory_reader_;
 };
 
+// Reads a bundle through a BlobStoreOpenableReader without exposing its
+// memory-mapped data, as a bundle stored in unmapped flash would be.
+class UnmappedOpenableReader final : public OpenableReader {
+ public:
+  explicit UnmappedOpenableReader(OpenableReader& reader) : reader_(reader) {}
+
+  Status Open() override { return reader_.Open(); }
+  Status Close() override { return reader_.Close(); }
+  bool IsOpen() override { return reader_.IsOpen(); }
+  stream::SeekableReader& reader() override { return reader_.reader(); }
+
+ private:
+  OpenableReader& reader_;
+};
+
+// Hashes a copy of a bundle in which the first target payload is corrupted, so
+// that the hasher's digest for it does not match the bundle. If complete is
+// false, only hashes the bundle up to the end of the first payload.
+void HashCorruptedBundle(ConstByteSpan bundle,
+                         bool complete,
+                         BundlePayloadHasher& hasher) {
+  std::array<BundlePayloadHasher::PayloadDigest, kMaxPayloads> digests;
+  BundlePayloadHasher payload_finder(digests);
+  ASSERT_OK(payload_finder.Update(bundle));
+  ASSERT_GE(payload_finder.digest_count(), 2u);
+
+  std::array<std::byte, kSectorSize * kSectorCount> corrupted;
+  ASSERT_LE(bundle.size(), corrupted.size());
+  std::copy(bundle.begin(), bundle.end(), corrupted.begin());
+  corrupted[digests[0].offset] ^= std::byte{0x01};
+
+  const size_t size =
+      complete ? bundle.size() : digests[0].offset + digests[0].size;
+  hasher.Reset();
+  hasher.Update(span(corrupted).first(size)).IgnoreError();
+}
+
 class UpdateBundleTest : public testing::Test {
  public:
   UpdateBundleTest()
@@ -444,6 +494,94 @@ TEST_F(UpdateBundleTest, OpenAndVerifyFailsOnMismatchedTargetHashFile1) {
   CheckOpenAndVerifyFail(update_bundle, true);
 }
 
+TEST_F(UpdateBundleTest, OpenAndVerifySucceedsWithUnmappedBundle) {
+  backend().SetTrustedRoot(kDevSignedRoot);
+  backend().SetCurrentManifest(kTestBundleManifest);
+  StageTestBundle(kTestProdBundle);
+  UnmappedOpenableReader unmapped_reader(blob_reader());
+  UpdateBundleAccessor update_bundle(unmapped_reader, backend());
+
+  ASSERT_OK(update_bundle.OpenAndVerify());
+  ASSERT_OK(update_bundle.Close());
+}
+
+TEST_F(UpdateBundleTest, OpenAndVerifyFailsOnUnmappedMismatchedHash) {
+  backend().SetTrustedRoot(kDevSignedRoot);
+  backend().SetCurrentManifest(kTestBundleManifest);
+  StageTestBundle(kTestBundleMismatchedTargetHashFile0);
+  UnmappedOpenableReader unmapped_reader(blob_reader());
+  UpdateBundleAccessor update_bundle(unmapped_reader, backend());
+  CheckOpenAndVerifyFail(update_bundle, true);
+}
+
+TEST_F(UpdateBundleTest, OpenAndVerifySucceedsWithPayloadDigests) {
+  backend().SetTrustedRoot(kDevSignedRoot);
+  backend().SetCurrentManifest(kTestBundleManifest);
+  StageTestBundle(kTestProdBundle);
+
+  BundlePayloadHasherBuffer<kMaxPayloads> hasher;
+  ASSERT_OK(hasher.Update(kTestProdBundle));
+  ASSERT_GE(hasher.digest_count(), 2u);
+  backend().SetBundlePayloadHasher(&hasher);
+
+  UpdateBundleAccessor update_bundle(blob_reader(), backend());
+  ASSERT_OK(update_bundle.OpenAndVerify());
+  ASSERT_OK(update_bundle.Close());
+}
+
+TEST_F(UpdateBundleTest, OpenAndVerifyFailsOnMismatchedPayloadDigest) {
+  backend().SetTrustedRoot(kDevSignedRoot);
+  backend().SetCurrentManifest(kTestBundleManifest);
+  StageTestBundle(kTestProdBundle);
+
+  // The hasher parsed a whole bundle of the right size, so its digests are
+  // trusted, and the bad digest fails verification.
+  BundlePayloadHasherBuffer<kMaxPayloads> hasher;
+  HashCorruptedBundle(kTestProdBundle, /*complete=*/true, hasher);
+  ASSERT_OK(hasher.status());
+  ASSERT_EQ(hasher.bytes_parsed(), sizeof(kTestProdBundle));
+  backend().SetBundlePayloadHasher(&hasher);
+
+  UpdateBundleAccessor update_bundle(blob_reader(), backend());
+  CheckOpenAndVerifyFail(update_bundle, true);
+}
+
+TEST_F(UpdateBundleTest, OpenAndVerifyIgnoresStalePayloadDigests) {
+  backend().SetTrustedRoot(kDevSignedRoot);
+  backend().SetCurrentManifest(kTestBundleManifest);
+  StageTestBundle(kTestProdBundle);
+
+  // The hasher only saw part of a bundle, so its bad digest is not used and
+  // the payloads are hashed from the stored bundle.
+  BundlePayloadHasherBuffer<kMaxPayloads> hasher;
+  HashCorruptedBundle(kTestProdBundle, /*complete=*/false, hasher);
+  ASSERT_OK(hasher.status());
+  ASSERT_EQ(hasher.digest_count(), 1u);
+  backend().SetBundlePayloadHasher(&hasher);
+
+  UpdateBundleAccessor update_bundle(blob_reader(), backend());
+  ASSERT_OK(update_bundle.OpenAndVerify());
+  ASSERT_OK(update_bundle.Close());
+}
+
+TEST_F(UpdateBundleTest, OpenAndVerifyIgnoresPayloadDigestsAfterHasherError) {
+  backend().SetTrustedRoot(kDevSignedRoot);
+  backend().SetCurrentManifest(kTestBundleManifest);
+  StageTestBundle(kTestProdBundle);
+
+  // The hasher ran out of digests after the first payload, so its bad digest
+  // is not used.
+  BundlePayloadHasherBuffer<1> hasher;
+  HashCorruptedBundle(kTestProdBundle, /*complete=*/true, hasher);
+  ASSERT_EQ(hasher.status(), Status::ResourceExhausted());
+  ASSERT_EQ(hasher.digest_count(), 1u);
+  backend().SetBundlePayloadHasher(&hasher);
+
+  UpdateBundleAccessor update_bundle(blob_reader(), backend());
+  ASSERT_OK(update_bundle.OpenAndVerify());
+  ASSERT_OK(update_bundle.Close());
+}
+
 TEST_F(UpdateBundleTest, OpenAndVerifyFailsOnMissingTargetHashFile0) {
   backend().SetTrustedRoot(kDevSignedRoot);
   backend().SetCurrentManifest(kTestBundleManifest);
@@ -0,0 +1,179 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+/// @file pw_string/format_string.h
+///
+/// @brief `pw::string::FormatString` is a format string for
+/// `pw::StringBuilder::Print` that is parsed and checked against its argument
+/// types when it is constructed.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include "pw_assert/assert.h"
+#include "pw_polyfill/language_feature_macros.h"
+
+namespace pw {
+
+class StringBuilder;
+
+namespace string {
+namespace internal {
+
+enum class FormatStyle : uint8_t {
+  kDefault,  // {}
+  kHex,      // {:x} or {:0Nx}
+};
+
+// A replacement field and the literal text before it.
+struct FormatField {
+  uint16_t literal_begin = 0;
+  uint16_t literal_size = 0;
+  FormatStyle style = FormatStyle::kDefault;
+  uint8_t width = 0;
+};
+
+template <typename T>
+inline constexpr bool kHexFormattable =
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>;
+
+template <typename T>
+struct TypeIdentity {
+  using type = T;
+};
+
+// Keeps a type from being deduced from an argument, like std::type_identity_t.
+template <typename T>
+using NonDeduced = typename TypeIdentity<T>::type;
+
+}  // namespace internal
+
+/// A format string for `pw::StringBuilder::Print`, with one replacement field
+/// for each type in `Args`. The string is parsed when the `FormatString` is
+/// constructed, which happens at compile time in C++20. An invalid string or a
+/// field that does not suit its argument's type fails to compile. In C++17, the
+/// string is parsed at runtime and errors trigger an assertion.
+///
+/// Format strings use a subset of the `std::format` syntax:
+///
+/// - `{}` writes the argument as `pw::StringBuilder`'s `<<` operator does,
+///   including for custom types with `operator<<` or `ToString` overloads.
+/// - `{:x}` writes an integer or enum in lowercase hexadecimal. `{:0Nx}`, such
+///   as `{:08x}`, pads it with zeros to at least `N` digits. Signed values are
+///   written as the unsigned value of the same size, as in `printf`.
+/// - `{{` and `}}` write `{` and `}`.
+///
+/// Fields are always used in order; indices and other options are not
+/// supported.
+template <typename... Args>
+class FormatString {
+ public:
+  template <typename T,
+            typename = std::enable_if_t<
+                std::is_convertible_v<const T&, std::string_view>>>
+  PW_CONSTEVAL FormatString(const T& format) : format_(format) {
+    Parse();
+  }
+
+ private:
+  friend class ::pw::StringBuilder;
+
+  static constexpr size_t kFields = sizeof...(Args);
+
+  // Whether each argument supports {:x}, with a trailing entry so the array is
+  // never empty.
+  static constexpr bool kHexArgs[] = {
+      internal::kHexFormattable<std::remove_cv_t<Args>>..., false};
+
+  constexpr void Parse() {
+    PW_ASSERT(format_.size() <= UINT16_MAX);  // Format string is too long
+
+    size_t literal_begin = 0;
+    size_t field = 0;
+
+    for (size_t i = 0; i < format_.size(); ++i) {
+      if (format_[i] == '}') {
+        // A '}' outside a field must be escaped as "}}".
+        PW_ASSERT(i + 1 < format_.size() && format_[i + 1] == '}');
+        escaped_braces_ = true;
+        i += 1;
+        continue;
+      }
+      if (format_[i] != '{') {
+        continue;
+      }
+      if (i + 1 < format_.size() && format_[i + 1] == '{') {
+        escaped_braces_ = true;
+        i += 1;
+        continue;
+      }
+
+      PW_ASSERT(field < kFields);  // More fields than arguments
+      internal::FormatField& current = fields_[field];
+      current.literal_begin = static_cast<uint16_t>(literal_begin);
+      current.literal_size = static_cast<uint16_t>(i - literal_begin);
+
+      i += 1;
+      if (i < format_.size() && format_[i] == ':') {
+        i = ParseSpec(i + 1, current);
+        PW_ASSERT(kHexArgs[field]);  // {:x} requires an integer or enum
+      }
+      PW_ASSERT(i < format_.size() && format_[i] == '}');  // Unclosed field
+
+      literal_begin = i + 1;
+      field += 1;
+    }
+
+    PW_ASSERT(field == kFields);  // Fewer fields than arguments
+    tail_begin_ = static_cast<uint16_t>(literal_begin);
+  }
+
+  // Parses "x" or "0Nx" and returns the index after it.
+  constexpr size_t ParseSpec(size_t i, internal::FormatField& field) {
+    if (i < format_.size() && format_[i] == '0') {
+      i += 1;
+      size_t width = 0;
+      while (i < format_.size() && format_[i] >= '0' && format_[i] <= '9') {
+        width = width * 10 + static_cast<size_t>(format_[i] - '0');
+        i += 1;
+      }
+      PW_ASSERT(width > 0u && width <= 16u);  // Invalid width
+      field.width = static_cast<uint8_t>(width);
+    }
+    PW_ASSERT(i < format_.size() && format_[i] == 'x');  // Unsupported spec
+    field.style = internal::FormatStyle::kHex;
+    return i + 1;
+  }
+
+  constexpr std::string_view literal(size_t field) const {
+    return format_.substr(fields_[field].literal_begin,
+                          fields_[field].literal_size);
+  }
+
+  constexpr std::string_view tail() const {
+    return format_.substr(tail_begin_);
+  }
+
+  std::string_view format_;
+  std::array<internal::FormatField, kFields> fields_{};
+  uint16_t tail_begin_ = 0;
+  bool escaped_braces_ = false;
+};
+
+}  // namespace string
+}  // namespace pw
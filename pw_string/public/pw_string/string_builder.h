@@ -30,6 +30,7 @@
 #include "pw_span/span.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
+#include "pw_string/format_string.h"
 #include "pw_string/string.h"
 #include "pw_string/to_string.h"
 
@@ -271,6 +272,26 @@ class StringBuilder {
   PW_PRINTF_FORMAT(2, 0)
   StringBuilder& FormatVaList(const char* format, va_list args);
 
+  /// Appends arguments formatted with a `pw::string::FormatString`, which uses
+  /// a subset of the `std::format` syntax. For example:
+  ///
+  /// @code
+  ///   sb.Print("{}: wrote {} bytes at 0x{:08x}", name, size, address);
+  /// @endcode
+  ///
+  /// Unlike `Format`, the format string is parsed and checked against the
+  /// argument types at compile time in C++20, and arguments are written with
+  /// the `pw::ToString` conversions used by `<<` instead of `std::vsnprintf`.
+  /// If the output does not fit, it is truncated and the status is set to
+  /// `RESOURCE_EXHAUSTED`.
+  template <typename... Args>
+  StringBuilder& Print(
+      string::FormatString<string::internal::NonDeduced<Args>...> format,
+      const Args&... args) {
+    PrintFields(format, std::index_sequence_for<Args...>(), args...);
+    return *this;
+  }
+
   /// Sets the size of the `StringBuilder`. This function only truncates; if
   /// `new_size > size()`, it sets status to `OUT_OF_RANGE` and does nothing.
   void resize(size_t new_size);
@@ -294,6 +315,48 @@ class StringBuilder {
 
   void WriteBytes(span<const std::byte> data);
 
+  template <typename... Args, size_t... kIndices>
+  void PrintFields(const string::FormatString<Args...>& format,
+                   std::index_sequence<kIndices...>,
+                   const Args&... args) {
+    (PrintField(format.literal(kIndices),
+                format.fields_[kIndices],
+                format.escaped_braces_,
+                args),
+     ...);
+    AppendFormatLiteral(format.tail(), format.escaped_braces_);
+  }
+
+  template <typename T>
+  void PrintField(std::string_view literal,
+                  string::internal::FormatField field,
+                  bool escaped_braces,
+                  const T& value) {
+    AppendFormatLiteral(literal, escaped_braces);
+    if constexpr (string::internal::kHexFormattable<T>) {
+      if (field.style == string::internal::FormatStyle::kHex) {
+        AppendHex(AsUnsigned(value), field.width);
+        return;
+      }
+    }
+    *this << value;
+  }
+
+  template <typename T>
+  static constexpr uint64_t AsUnsigned(T value) {
+    if constexpr (std::is_enum_v<T>) {
+      return AsUnsigned(static_cast<std::underlying_type_t<T>>(value));
+    } else {
+      return static_cast<std::make_unsigned_t<T>>(value);
+    }
+  }
+
+  // Appends literal text from a FormatString, replacing "{{" and "}}" with "{"
+  // and "}" if the string has any.
+  void AppendFormatLiteral(std::string_view literal, bool escaped_braces);
+
+  void AppendHex(uint64_t value, uint_fast8_t min_width);
+
   size_t ResizeAndTerminate(size_t chars_to_append);
 
   void HandleStatusWithSize(StatusWithSize written);
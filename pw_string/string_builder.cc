@@ -102,6 +102,30 @@ StringBuilder& StringBuilder::FormatVaList(const char* format, va_list args) {
   return *this;
 }
 
+void StringBuilder::AppendFormatLiteral(std::string_view literal,
+                                        bool escaped_braces) {
+  if (!escaped_braces) {
+    append(literal);
+    return;
+  }
+  // Each brace in literal text is the first of a pair. Append it and skip the
+  // second.
+  while (!literal.empty()) {
+    const size_t brace = literal.find_first_of("{}");
+    if (brace == std::string_view::npos) {
+      append(literal);
+      return;
+    }
+    append(literal.data(), brace + 1);
+    literal.remove_prefix(brace + 2);
+  }
+}
+
+void StringBuilder::AppendHex(uint64_t value, uint_fast8_t min_width) {
+  HandleStatusWithSize(
+      string::IntToHexString(value, buffer_.subspan(size()), min_width));
+}
+
 void StringBuilder::WriteBytes(span<const std::byte> data) {
   if (size() + data.size() * 2 > max_size()) {
     SetErrorStatus(Status::ResourceExhausted());
@@ -0,0 +1,91 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares StringBuilder::Print with the printf-style StringBuilder::Format for
+// patterns common in log messages.
+
+#include <cstdint>
+
+#include "pw_perf_test/perf_test.h"
+#include "pw_string/string_builder.h"
+
+namespace pw {
+namespace {
+
+constexpr const char* kModule = "pw_kvs";
+
+// Keep the arguments opaque to the optimizer.
+volatile int status_code = -5;
+volatile uint32_t address = 0x1f00;
+volatile uint32_t size = 4096;
+
+void FormatStringAndInt(perf_test::State& state) {
+  StringBuffer<64> sb;
+  while (state.KeepRunning()) {
+    sb.clear();
+    sb.Format("%s: %d", kModule, status_code);
+  }
+}
+
+void PrintStringAndInt(perf_test::State& state) {
+  StringBuffer<64> sb;
+  while (state.KeepRunning()) {
+    sb.clear();
+    sb.Print("{}: {}", kModule, status_code);
+  }
+}
+
+void FormatIntegers(perf_test::State& state) {
+  StringBuffer<64> sb;
+  while (state.KeepRunning()) {
+    sb.clear();
+    sb.Format("read %u of %u bytes, status %d", size / 2, size, status_code);
+  }
+}
+
+void PrintIntegers(perf_test::State& state) {
+  StringBuffer<64> sb;
+  while (state.KeepRunning()) {
+    sb.clear();
+    sb.Print("read {} of {} bytes, status {}", size / 2, size, status_code);
+  }
+}
+
+void FormatHexAddress(perf_test::State& state) {
+  StringBuffer<64> sb;
+  while (state.KeepRunning()) {
+    sb.clear();
+    sb.Format("[%s] wrote %u bytes at 0x%08x", kModule, size, address);
+  }
+}
+
+void PrintHexAddress(perf_test::State& state) {
+  StringBuffer<64> sb;
+  while (state.KeepRunning()) {
+    sb.clear();
+    sb.Print("[{}] wrote {} bytes at 0x{:08x}", kModule, size, address);
+  }
+}
+
+PW_PERF_TEST(FormatStringAndInt, FormatStringAndInt);
+PW_PERF_TEST(PrintStringAndInt, PrintStringAndInt);
+
+PW_PERF_TEST(FormatIntegers, FormatIntegers);
+PW_PERF_TEST(PrintIntegers, PrintIntegers);
+
+PW_PERF_TEST(FormatHexAddress, FormatHexAddress);
+PW_PERF_TEST(PrintHexAddress, PrintHexAddress);
+
+}  // namespace
+}  // namespace pw
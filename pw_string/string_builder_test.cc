@@ -20,6 +20,8 @@
 #include <cstring>
 #include <string_view>
 
+#include "pw_compilation_testing/negative_compilation.h"
+#include "pw_polyfill/standard.h"
 #include "pw_span/span.h"
 #include "pw_string/format.h"
 #include "pw_unit_test/framework.h"
@@ -310,6 +312,119 @@ TEST(StringBuilder, Format_ExhaustBuffer) {
   EXPECT_EQ(Status::ResourceExhausted(), sb.status());
 }
 
+TEST(StringBuilder, Print_NoFields) {
+  StringBuffer<16> sb;
+  EXPECT_TRUE(sb.Print("no fields").ok());
+  EXPECT_STREQ("no fields", sb.data());
+}
+
+TEST(StringBuilder, Print_Empty) {
+  StringBuffer<16> sb;
+  EXPECT_TRUE(sb.Print("").ok());
+  EXPECT_STREQ("", sb.data());
+}
+
+TEST(StringBuilder, Print_MultipleTypes) {
+  constexpr const char* kName = "flash";
+  StringBuffer<64> sb;
+  sb.Print("{}: {} {} {} {}!", kName, -12, 34u, true, 'c');
+  EXPECT_TRUE(sb.ok());
+  EXPECT_STREQ("flash: -12 34 true c!", sb.data());
+}
+
+TEST(StringBuilder, Print_MatchesFormat) {
+  constexpr std::string_view kModule = "pw_kvs";
+  StringBuffer<64> expected;
+  expected.Format("[%s] key %u at 0x%08x: %d", "kvs", 42u, 0x1f00u, -5);
+
+  StringBuffer<64> sb;
+  sb.Print("[{}] key {} at 0x{:08x}: {}", kModule.substr(3), 42u, 0x1f00u, -5);
+  EXPECT_EQ(expected.view(), sb.view());
+}
+
+TEST(StringBuilder, Print_FieldsAtEnds) {
+  StringBuffer<16> sb;
+  sb.Print("{}-{}", 1, 2);
+  EXPECT_STREQ("1-2", sb.data());
+}
+
+TEST(StringBuilder, Print_AppendsToContents) {
+  StringBuffer<16> sb;
+  sb << "a";
+  sb.Print("{}", 'b').Print("{}", "c");
+  EXPECT_STREQ("abc", sb.data());
+}
+
+TEST(StringBuilder, Print_Hex) {
+  enum class Register : uint8_t { kControl = 0xc2 };
+
+  StringBuffer<64> sb;
+  sb.Print("{:x} {:04x} {:x} {:x} {:016x}",
+           0xABCDu,
+           0x1a,
+           Register::kControl,
+           int8_t{-1},
+           uint64_t{0xffffffffffffffff});
+  EXPECT_STREQ("abcd 001a c2 ff ffffffffffffffff", sb.data());
+}
+
+TEST(StringBuilder, Print_EscapedBraces) {
+  StringBuffer<32> sb;
+  sb.Print("{{}} {{{}}} }}{{", 5);
+  EXPECT_STREQ("{} {5} }{", sb.data());
+}
+
+TEST(StringBuilder, Print_CustomType) {
+  CustomType custom;
+  StringBuffer<64> sb;
+  sb.Print("<{}>", custom);
+  EXPECT_STREQ("<This is a CustomType>", sb.data());
+}
+
+TEST(StringBuilder, Print_StatusAndNullPointer) {
+  StringBuffer<32> sb;
+  sb.Print("{} {}", Status::NotFound(), nullptr);
+  EXPECT_STREQ("NOT_FOUND (null)", sb.data());
+}
+
+TEST(StringBuilder, Print_ExhaustBuffer) {
+  StringBuffer<8> sb;
+  EXPECT_EQ(Status::ResourceExhausted(),
+            sb.Print("{}{}", "abcde", 123).status());
+  EXPECT_STREQ("abcde", sb.data());
+}
+
+TEST(StringBuilder, Print_ExhaustBufferInLiteral) {
+  StringBuffer<8> sb;
+  EXPECT_EQ(Status::ResourceExhausted(),
+            sb.Print("{}: {{too long}}", 1).status());
+  EXPECT_STREQ("1: {too", sb.data());
+}
+
+#if PW_CXX_STANDARD_IS_SUPPORTED(20)
+#if PW_NC_TEST(Print_TooFewArguments)
+PW_NC_EXPECT("PW_ASSERT\(field < kFields\)");
+[[maybe_unused]] void ShouldAssert(StringBuilder& sb) { sb.Print("{} {}", 1); }
+#elif PW_NC_TEST(Print_TooManyArguments)
+PW_NC_EXPECT("PW_ASSERT\(field == kFields\)");
+[[maybe_unused]] void ShouldAssert(StringBuilder& sb) { sb.Print("{}", 1, 2); }
+#elif PW_NC_TEST(Print_UnclosedField)
+PW_NC_EXPECT("PW_ASSERT\(i < format_.size\(\) && format_\[i\] == '}'\)");
+[[maybe_unused]] void ShouldAssert(StringBuilder& sb) { sb.Print("{", 1); }
+#elif PW_NC_TEST(Print_UnescapedClosingBrace)
+PW_NC_EXPECT("format_\[i \+ 1\] == '}'");
+[[maybe_unused]] void ShouldAssert(StringBuilder& sb) { sb.Print("}"); }
+#elif PW_NC_TEST(Print_UnsupportedSpec)
+PW_NC_EXPECT("format_\[i\] == 'x'");
+[[maybe_unused]] void ShouldAssert(StringBuilder& sb) { sb.Print("{:d}", 1); }
+#elif PW_NC_TEST(Print_HexString)
+PW_NC_EXPECT("PW_ASSERT\(kHexArgs\[field\]\)");
+[[maybe_unused]] void ShouldAssert(StringBuilder& sb) {
+  sb.Print("{:x}", "string");
+}
+#endif  // PW_NC_TEST
+#endif  // PW_CXX_STANDARD_IS_SUPPORTED(20)
+
 TEST(StringBuilder, StreamOutput_MultipleTypes) {
   constexpr const char* kExpected = "This is -1true example\n of this";
   constexpr const char* kExample = "example";
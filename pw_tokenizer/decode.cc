@@ -338,6 +338,7 @@ FormatString::FormatString(const char* format) {
 
 DecodedFormatString FormatString::Format(span<const uint8_t> arguments) const {
   std::vector<DecodedArg> results;
+  results.reserve(segments_.size());
   bool skip = false;
 
   for (const auto& segment : segments_) {
@@ -357,4 +358,11 @@ DecodedFormatString FormatString::Format(span<const uint8_t> arguments) const {
   return DecodedFormatString(std::move(results), arguments.size());
 }
 
+bool FormatString::has_arguments() const {
+  return std::any_of(
+      segments_.begin(), segments_.end(), [](const StringSegment& segment) {
+        return segment.is_argument();
+      });
+}
+
 }  // namespace pw::tokenizer
@@ -238,5 +238,13 @@ TEST_F(DecodedFormatStringTest, DecodingErrors_TwoArgs_IsZero) {
   EXPECT_EQ(0u, two_args_.Format("\x02\x02").decoding_errors());
 }
 
+TEST_F(DecodedFormatStringTest, HasArguments_PercentIsNotAnArgument) {
+  EXPECT_FALSE(no_args_.has_arguments());
+  EXPECT_TRUE(one_arg_.has_arguments());
+  EXPECT_TRUE(two_args_.has_arguments());
+  EXPECT_FALSE(FormatString("").has_arguments());
+  EXPECT_FALSE(FormatString("%%").has_arguments());
+}
+
 }  // namespace
 }  // namespace pw::tokenizer
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -85,8 +86,17 @@ class NestedMessageDetokenizer {
 
  private:
   void HandleEndOfMessage() {
-    if (auto result = detokenizer_.DetokenizeBase64Message(message_buffer_);
-        result.ok()) {
+    binary_buffer_.assign(message_buffer_);
+    binary_buffer_.resize(PrefixedBase64DecodeInPlace(binary_buffer_));
+
+    if (const std::optional<std::string_view> text =
+            detokenizer_.DetokenizeWithoutArguments(
+                as_bytes(span(binary_buffer_)));
+        text.has_value()) {
+      output_ += *text;
+      output_changed_ = true;
+    } else if (auto result = detokenizer_.Detokenize(binary_buffer_);
+               result.ok()) {
       output_ += result.BestString();
       output_changed_ = true;
     } else {
@@ -98,6 +108,7 @@ class NestedMessageDetokenizer {
   const Detokenizer& detokenizer_;
   std::string output_;
   std::string message_buffer_;
+  std::string binary_buffer_;  // Reused to decode each Base64 message.
 
   enum : uint8_t { kNonMessage, kMessage } state_ = kNonMessage;
   bool output_changed_ = false;
@@ -170,17 +181,26 @@ DetokenizedString::DetokenizedString(
     const span<const TokenizedStringEntry>& entries,
     const span<const std::byte>& arguments)
     : token_(token), has_token_(true) {
+  const span<const uint8_t> encoded_args(
+      reinterpret_cast<const uint8_t*>(arguments.data()), arguments.size());
+
+  // Without collisions, there are no results to rank.
+  if (entries.size() == 1u) {
+    matches_.push_back(entries[0].first.Format(encoded_args));
+    return;
+  }
+
   std::vector<DecodingResult> results;
+  results.reserve(entries.size());
 
   for (const auto& [format, date_removed] : entries) {
-    results.push_back(DecodingResult{
-        format.Format(span(reinterpret_cast<const uint8_t*>(arguments.data()),
-                           arguments.size())),
-        date_removed});
+    results.push_back(
+        DecodingResult{format.Format(encoded_args), date_removed});
   }
 
   std::sort(results.begin(), results.end(), IsBetterResult);
 
+  matches_.reserve(results.size());
   for (auto& result : results) {
     matches_.push_back(std::move(result.first));
   }
@@ -202,6 +222,24 @@ Detokenizer::Detokenizer(const TokenDatabase& database) {
   for (const auto& entry : database) {
     database_[entry.token].emplace_back(entry.string, entry.date_removed);
   }
+  FormatStringsWithoutArguments();
+}
+
+Detokenizer::Detokenizer(
+    std::unordered_map<uint32_t, std::vector<TokenizedStringEntry>>&&
+        database)
+    : database_(std::move(database)) {
+  FormatStringsWithoutArguments();
+}
+
+void Detokenizer::FormatStringsWithoutArguments() {
+  for (const auto& [token, entries] : database_) {
+    // Collisions are left to Detokenize, which ranks the possible results.
+    if (entries.size() == 1u && !entries[0].first.has_arguments()) {
+      strings_without_arguments_.emplace(
+          token, entries[0].first.Format(span<const uint8_t>()).value());
+    }
+  }
 }
 
 Result<Detokenizer> Detokenizer::FromElfSection(
@@ -254,6 +292,21 @@ DetokenizedString Detokenizer::Detokenize(
                                      : encoded.subspan(sizeof(token)));
 }
 
+std::optional<std::string_view> Detokenizer::DetokenizeWithoutArguments(
+    const span<const std::byte>& encoded) const {
+  if (encoded.size() != sizeof(uint32_t)) {
+    return std::nullopt;
+  }
+  const uint32_t token =
+      bytes::ReadInOrder<uint32_t>(endian::little, encoded.data());
+
+  const auto result = strings_without_arguments_.find(token);
+  if (result == strings_without_arguments_.end()) {
+    return std::nullopt;
+  }
+  return result->second;
+}
+
 DetokenizedString Detokenizer::DetokenizeBase64Message(
     std::string_view text) const {
   std::string buffer(text);
@@ -282,6 +335,14 @@ std::string Detokenizer::DetokenizeText(std::string_view text,
 
 std::string Detokenizer::DecodeOptionallyTokenizedData(
     const ConstByteSpan& optionally_tokenized_data) {
+  // Messages without arguments are known to be tokenized; only check them for
+  // nested tokens.
+  if (const std::optional<std::string_view> text =
+          DetokenizeWithoutArguments(optionally_tokenized_data);
+      text.has_value()) {
+    return DetokenizeText(*text);
+  }
+
   // Try detokenizing as binary using the best result if available, else use
   // the input data as a string.
   const auto result = Detokenize(optionally_tokenized_data);
@@ -0,0 +1,218 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures detokenizing a stream of log messages from a small database. As in
+// a typical log, a large share of the messages have no arguments.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "pw_assert/check.h"
+#include "pw_perf_test/perf_test.h"
+#include "pw_tokenizer/base64.h"
+#include "pw_tokenizer/detokenize.h"
+#include "pw_varint/varint.h"
+
+namespace pw::tokenizer {
+namespace {
+
+constexpr std::array<std::string_view, 16> kFormatStrings = {
+    "Boot complete",
+    "Entering low power mode",
+    "WiFi scan complete",
+    "Button pressed",
+    "Watchdog fed",
+    "Flash write finished",
+    "Display on",
+    "Battery level %d%%",
+    "Sensor %u reading: %d mC",
+    "Connected to %s",
+    "Received %u bytes from 0x%08x",
+    "Task %s took %u ms",
+    "Retrying in %d s (attempt %u/%u)",
+    "Unexpected event %x in state %s",
+    "Free heap: %u bytes",
+    "Link quality %d dBm",
+};
+
+constexpr size_t kMessageCount = 64;
+
+constexpr uint32_t TokenFor(size_t index) {
+  return 0x9e3779b1u * static_cast<uint32_t>(index + 1);
+}
+
+Detokenizer& TestDetokenizer() {
+  static Detokenizer detokenizer([] {
+    std::unordered_map<uint32_t, std::vector<TokenizedStringEntry>> database;
+    for (size_t i = 0; i < kFormatStrings.size(); ++i) {
+      database[TokenFor(i)].emplace_back(
+          std::string(kFormatStrings[i]).c_str(),
+          TokenDatabase::kDateRemovedNever);
+    }
+    return database;
+  }());
+  return detokenizer;
+}
+
+void AppendInteger(std::string& message, int64_t value) {
+  std::array<std::byte, varint::kMaxVarint64SizeBytes> buffer;
+  const size_t size = varint::Encode(value, buffer);
+  message.append(reinterpret_cast<const char*>(buffer.data()), size);
+}
+
+void AppendString(std::string& message, std::string_view value) {
+  message.push_back(static_cast<char>(value.size()));
+  message.append(value);
+}
+
+// Encodes a message for one of the format strings. Messages without arguments
+// are picked most often, followed by the ones with a few integers.
+std::string EncodeMessage(size_t index) {
+  static constexpr std::array<uint8_t, 16> kPattern = {
+      0, 1, 7, 2, 8, 3, 4, 14, 0, 9, 5, 10, 6, 15, 8, 11};
+  static constexpr std::array<std::string_view, 3> kNames = {
+      "main", "net", "sensors"};
+
+  const size_t format = (index % 4 == 3) ? 12 + index % 2
+                                         : kPattern[index % kPattern.size()];
+  const int64_t value = static_cast<int64_t>(index * 37 % 1000);
+
+  std::string message(4, '\0');
+  const uint32_t token = TokenFor(format);
+  for (size_t i = 0; i < sizeof(token); ++i) {
+    message[i] = static_cast<char>(token >> (8 * i));
+  }
+
+  switch (format) {
+    case 7:
+    case 14:
+    case 15:
+      AppendInteger(message, value - 500);
+      break;
+    case 8:
+    case 10:
+      AppendInteger(message, value % 8);
+      AppendInteger(message, value * 1000);
+      break;
+    case 9:
+      AppendString(message, "access-point-1");
+      break;
+    case 11:
+      AppendString(message, kNames[index % kNames.size()]);
+      AppendInteger(message, value);
+      break;
+    case 12:
+      AppendInteger(message, value % 10);
+      AppendInteger(message, 2);
+      AppendInteger(message, 5);
+      break;
+    case 13:
+      AppendInteger(message, 0x2a);
+      AppendString(message, kNames[index % kNames.size()]);
+      break;
+    default:
+      break;
+  }
+  return message;
+}
+
+const std::array<std::string, kMessageCount>& BinaryMessages() {
+  static const std::array<std::string, kMessageCount> messages = [] {
+    std::array<std::string, kMessageCount> result;
+    for (size_t i = 0; i < kMessageCount; ++i) {
+      result[i] = EncodeMessage(i);
+    }
+    return result;
+  }();
+  return messages;
+}
+
+// Log lines as a host tool sees them, with the tokenized message in Base64.
+const std::array<std::string, kMessageCount>& TextLines() {
+  static const std::array<std::string, kMessageCount> lines = [] {
+    std::array<std::string, kMessageCount> result;
+    for (size_t i = 0; i < kMessageCount; ++i) {
+      const std::string& binary = BinaryMessages()[i];
+      std::vector<char> base64(Base64EncodedBufferSize(binary.size()));
+      const size_t size =
+          PrefixedBase64Encode(as_bytes(span(binary)), span(base64));
+      result[i] = "INF 00:00:12.345 main ";
+      result[i].append(base64.data(), size);
+    }
+    return result;
+  }();
+  return lines;
+}
+
+void DetokenizeBinary(perf_test::State& state) {
+  const Detokenizer& detokenizer = TestDetokenizer();
+  const auto& messages = BinaryMessages();
+  size_t total_size = 0;
+
+  while (state.KeepRunning()) {
+    for (const std::string& message : messages) {
+      total_size += detokenizer.Detokenize(message).BestString().size();
+    }
+  }
+  PW_CHECK_UINT_NE(total_size, 0u);
+}
+
+// Detokenizes messages without arguments with the fast path, as a log viewer
+// would, and the rest normally.
+void DetokenizeBinaryWithoutArguments(perf_test::State& state) {
+  const Detokenizer& detokenizer = TestDetokenizer();
+  const auto& messages = BinaryMessages();
+  size_t total_size = 0;
+
+  while (state.KeepRunning()) {
+    for (const std::string& message : messages) {
+      const span<const std::byte> encoded = as_bytes(span(message));
+      if (const std::optional<std::string_view> text =
+              detokenizer.DetokenizeWithoutArguments(encoded);
+          text.has_value()) {
+        total_size += text->size();
+      } else {
+        total_size += detokenizer.Detokenize(encoded).BestString().size();
+      }
+    }
+  }
+  PW_CHECK_UINT_NE(total_size, 0u);
+}
+
+void DetokenizeBase64Text(perf_test::State& state) {
+  const Detokenizer& detokenizer = TestDetokenizer();
+  const auto& lines = TextLines();
+  size_t total_size = 0;
+
+  while (state.KeepRunning()) {
+    for (const std::string& line : lines) {
+      total_size += detokenizer.DetokenizeText(line).size();
+    }
+  }
+  PW_CHECK_UINT_NE(total_size, 0u);
+}
+
+PW_PERF_TEST(Detokenize64BinaryMessages, DetokenizeBinary);
+PW_PERF_TEST(Detokenize64BinaryMessagesWithFastPath,
+             DetokenizeBinaryWithoutArguments);
+PW_PERF_TEST(Detokenize64Base64Lines, DetokenizeBase64Text);
+
+}  // namespace
+}  // namespace pw::tokenizer
@@ -72,6 +72,36 @@ TEST_F(Detokenize, NoFormatting) {
   EXPECT_EQ(detok_.Detokenize("\xff\xee\xee\xdd"sv).BestString(), "FOUR");
 }
 
+TEST_F(Detokenize, WithoutArguments_MatchesDetokenize) {
+  for (std::string_view data :
+       {"\1\0\0\0"sv, "\5\0\0\0"sv, "\xff\x00\x00\x00"sv,
+        "\xff\xee\xee\xdd"sv, "\xee\xee\xee\xee"sv}) {
+    const auto result = detok_.DetokenizeWithoutArguments(as_bytes(span(data)));
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(*result, detok_.Detokenize(data).BestString());
+  }
+}
+
+TEST_F(Detokenize, WithoutArguments_NestedMessagesAreNotExpanded) {
+  EXPECT_EQ(detok_.DetokenizeWithoutArguments(
+                as_bytes(span("\xee\xee\xee\xee"sv))),
+            "$AQAAAA==");
+}
+
+TEST_F(Detokenize, WithoutArguments_UnknownToken) {
+  EXPECT_FALSE(
+      detok_.DetokenizeWithoutArguments(as_bytes(span("\0\0\0\0"sv))));
+  EXPECT_FALSE(
+      detok_.DetokenizeWithoutArguments(as_bytes(span("\2\0\0\0"sv))));
+}
+
+TEST_F(Detokenize, WithoutArguments_NotOnlyAToken) {
+  EXPECT_FALSE(detok_.DetokenizeWithoutArguments(span<const std::byte>()));
+  EXPECT_FALSE(detok_.DetokenizeWithoutArguments(as_bytes(span("\1\0"sv))));
+  EXPECT_FALSE(
+      detok_.DetokenizeWithoutArguments(as_bytes(span("\1\0\0\0\0"sv))));
+}
+
 TEST_F(Detokenize, FromElfSection) {
   // Create a detokenizer from an ELF file with only the pw_tokenizer sections.
   // See py/detokenize_test.py.
@@ -238,6 +268,16 @@ TEST_F(DetokenizeWithArgs, Empty) {
   EXPECT_EQ(detok_.Detokenize("\x00\x00\x00\x00"sv).BestString(), "");
 }
 
+TEST_F(DetokenizeWithArgs, WithoutArguments_OnlyEmptyString) {
+  EXPECT_EQ(
+      detok_.DetokenizeWithoutArguments(as_bytes(span("\x00\x00\x00\x00"sv))),
+      "");
+  EXPECT_FALSE(detok_.DetokenizeWithoutArguments(
+      as_bytes(span("\x0A\x0B\x0C\x0D"sv))));
+  EXPECT_FALSE(detok_.DetokenizeWithoutArguments(
+      as_bytes(span("\xDD\xDD\xDD\xDD"sv))));
+}
+
 TEST_F(DetokenizeWithArgs, Successful) {
   // Run through test cases, but don't include cases that use %hhu or %llu since
   // these are not currently supported in arm-none-eabi-gcc.
@@ -322,6 +362,15 @@ class DetokenizeWithCollisions : public ::testing::Test {
   Detokenizer detok_;
 };
 
+TEST_F(DetokenizeWithCollisions, WithoutArguments_CollisionsAreNotCached) {
+  EXPECT_FALSE(
+      detok_.DetokenizeWithoutArguments(as_bytes(span("\0\0\0\0"sv))));
+  EXPECT_FALSE(
+      detok_.DetokenizeWithoutArguments(as_bytes(span("\xAA\xAA\xAA\xAA"sv))));
+  EXPECT_EQ(detok_.Detokenize("\xAA\xAA\xAA\xAA"sv).BestString(),
+            "This one is present");
+}
+
 TEST_F(DetokenizeWithCollisions, Collision_AlwaysPreferSuccessfulDecode) {
   for (auto [data, expected] :
        TestCases(Case{"\0\0\0\0"sv, "This string is present"},
@@ -26,7 +26,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -89,8 +91,7 @@ class Detokenizer {
   /// Constructs a detokenizer by directly passing the parsed database.
   explicit Detokenizer(
       std::unordered_map<uint32_t, std::vector<TokenizedStringEntry>>&&
-          database)
-      : database_(std::move(database)) {}
+          database);
 
   /// Constructs a detokenizer from the `.pw_tokenizer.entries` section of an
   /// ELF binary.
@@ -120,6 +121,24 @@ class Detokenizer {
     return Detokenize(span(static_cast<const std::byte*>(encoded), size_bytes));
   }
 
+  /// Returns the detokenized string for a message from a format string with no
+  /// arguments, such as `"Boot complete"`. These strings are formatted once
+  /// when the `Detokenizer` is constructed, so this is much faster than
+  /// `Detokenize` and does not allocate. The `string_view` is valid for the
+  /// lifetime of the `Detokenizer`.
+  ///
+  /// Returns `std::nullopt` if the message is not exactly a token, or if the
+  /// token is unknown, collides with other strings, or has arguments. Call
+  /// `Detokenize` for these messages.
+  std::optional<std::string_view> DetokenizeWithoutArguments(
+      const span<const std::byte>& encoded) const;
+
+  /// Overload of `DetokenizeWithoutArguments` for `span<const uint8_t>`.
+  std::optional<std::string_view> DetokenizeWithoutArguments(
+      const span<const uint8_t>& encoded) const {
+    return DetokenizeWithoutArguments(as_bytes(encoded));
+  }
+
   /// Decodes and detokenizes a Base64-encoded message. Returns a
   /// `DetokenizedString` that stores all possible detokenized string results.
   DetokenizedString DetokenizeBase64Message(std::string_view text) const;
@@ -164,7 +183,15 @@ class Detokenizer {
       const span<const std::byte>& optionally_tokenized_data);
 
  private:
+  // Formats the strings without arguments for DetokenizeWithoutArguments.
+  void FormatStringsWithoutArguments();
+
   std::unordered_map<uint32_t, std::vector<TokenizedStringEntry>> database_;
+
+  // Formatted strings for tokens with one entry that takes no arguments. Log
+  // messages without arguments are common, and these are detokenized without
+  // decoding or allocating.
+  std::unordered_map<uint32_t, std::string> strings_without_arguments_;
 };
 
 /// @}
@@ -140,6 +140,10 @@ class StringSegment {
 
   bool empty() const { return text_.empty(); }
 
+  // True if this is a conversion specifier that consumes an argument. False for
+  // literals and %%.
+  bool is_argument() const { return type_ != kLiteral && type_ != kPercent; }
+
   const std::string& text() const { return text_; }
 
  private:
@@ -237,6 +241,10 @@ class FormatString {
                        arguments.size()));
   }
 
+  // True if the format string has conversion specifiers that take arguments.
+  // A format string without arguments always formats to the same string.
+  bool has_arguments() const;
+
  private:
   std::vector<StringSegment> segments_;
 };
@@ -0,0 +1,108 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/internal/bandwidth_estimator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace pw::transfer::internal {
+namespace {
+
+constexpr uint64_t kMicrosecondsPerSecond = 1'000'000;
+
+uint32_t Saturate(uint64_t value) {
+  return static_cast<uint32_t>(
+      std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+}  // namespace
+
+void BandwidthEstimator::OnParametersSent(chrono::SystemClock::time_point now,
+                                          uint32_t end_offset,
+                                          uint32_t window_size,
+                                          bool restart_round) {
+  max_window_size_ = std::max(max_window_size_, window_size);
+
+  if (round_in_progress_ && !restart_round) {
+    return;
+  }
+
+  round_start_ = now;
+  round_start_delivered_ = delivered_;
+  round_end_offset_ = end_offset;
+  round_in_progress_ = true;
+}
+
+void BandwidthEstimator::OnDataReceived(chrono::SystemClock::time_point now,
+                                        uint32_t offset,
+                                        size_t size) {
+  delivered_ += size;
+
+  if (!round_in_progress_ || offset < round_end_offset_) {
+    return;
+  }
+
+  round_in_progress_ = false;
+
+  const int64_t elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - round_start_)
+          .count();
+  if (elapsed_us <= 0) {
+    return;
+  }
+
+  const uint32_t rtt_us = Saturate(static_cast<uint64_t>(elapsed_us));
+  if (min_rtt_us_ == 0 || rtt_us < min_rtt_us_) {
+    min_rtt_us_ = rtt_us;
+  }
+
+  // Smooth the RTT as TCP does, with a gain of 1/8.
+  smoothed_rtt_us_ = smoothed_rtt_us_ == 0
+                         ? rtt_us
+                         : smoothed_rtt_us_ - smoothed_rtt_us_ / 8 + rtt_us / 8;
+
+  // Data received before the transmitter saw the parameters also counts
+  // towards the round, as it was in flight during it.
+  const uint64_t round_bytes = delivered_ - round_start_delivered_;
+  UpdateBandwidth(Saturate(round_bytes * kMicrosecondsPerSecond /
+                           static_cast<uint64_t>(elapsed_us)));
+}
+
+void BandwidthEstimator::UpdateBandwidth(uint32_t sample) {
+  // Windowed maximum filter: keep the largest sample until it is older than
+  // the filter length, then fall back to the latest one.
+  bandwidth_age_ += 1;
+  if (sample >= bandwidth_ || bandwidth_age_ > kBandwidthFilterRounds) {
+    bandwidth_ = sample;
+    bandwidth_age_ = 0;
+  }
+
+  // The link is considered full once the estimate fails to grow by 25%.
+  if (static_cast<uint64_t>(bandwidth_) * 4 >=
+      static_cast<uint64_t>(plateau_bandwidth_) * 5) {
+    plateau_bandwidth_ = bandwidth_;
+    plateau_rounds_ = 0;
+  } else {
+    plateau_rounds_ += 1;
+  }
+}
+
+uint32_t BandwidthEstimator::BandwidthDelayProduct() const {
+  return Saturate(static_cast<uint64_t>(bandwidth_) * min_rtt_us_ /
+                  kMicrosecondsPerSecond);
+}
+
+}  // namespace pw::transfer::internal
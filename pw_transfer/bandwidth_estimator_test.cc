@@ -0,0 +1,148 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/internal/bandwidth_estimator.h"
+
+#include <chrono>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw::transfer::internal {
+namespace {
+
+chrono::SystemClock::time_point At(uint32_t microseconds) {
+  return chrono::SystemClock::time_point() +
+         chrono::SystemClock::for_at_least(
+             std::chrono::microseconds(microseconds));
+}
+
+class BandwidthEstimatorTest : public ::testing::Test {
+ protected:
+  // Runs a round starting at start_us, in which `bytes` arrive as a single
+  // chunk after rtt_us.
+  void RunRound(uint32_t start_us, uint32_t rtt_us, uint32_t bytes) {
+    estimator_.OnParametersSent(At(start_us), offset_, bytes, false);
+    estimator_.OnDataReceived(At(start_us + rtt_us), offset_, bytes);
+    offset_ += bytes;
+  }
+
+  BandwidthEstimator estimator_;
+  uint32_t offset_ = 0;
+};
+
+TEST_F(BandwidthEstimatorTest, NoEstimateBeforeRoundCompletes) {
+  EXPECT_FALSE(estimator_.has_estimate());
+
+  estimator_.OnParametersSent(At(0), 100, 100, false);
+  estimator_.OnDataReceived(At(1000), 0, 50);
+  estimator_.OnDataReceived(At(2000), 50, 50);
+
+  EXPECT_FALSE(estimator_.has_estimate());
+  EXPECT_EQ(estimator_.min_rtt_us(), 0u);
+  EXPECT_EQ(estimator_.bandwidth_bytes_per_second(), 0u);
+}
+
+TEST_F(BandwidthEstimatorTest, RoundMeasuresRttAndDeliveryRate) {
+  estimator_.OnParametersSent(At(0), 1000, 2000, false);
+  for (uint32_t offset = 0; offset < 1000; offset += 100) {
+    estimator_.OnDataReceived(At(1000 + offset), offset, 100);
+  }
+  estimator_.OnDataReceived(At(20000), 1000, 100);
+
+  ASSERT_TRUE(estimator_.has_estimate());
+  EXPECT_EQ(estimator_.min_rtt_us(), 20000u);
+  EXPECT_EQ(estimator_.smoothed_rtt_us(), 20000u);
+  // All 1100 bytes were in flight during the 20 ms round.
+  EXPECT_EQ(estimator_.bandwidth_bytes_per_second(), 55000u);
+  EXPECT_EQ(estimator_.BandwidthDelayProduct(), 1100u);
+  EXPECT_EQ(estimator_.max_window_size(), 2000u);
+}
+
+TEST_F(BandwidthEstimatorTest, MinRttKeepsSmallestSample) {
+  RunRound(0, 10000, 1000);
+  RunRound(10000, 5000, 1000);
+  RunRound(15000, 40000, 1000);
+
+  EXPECT_EQ(estimator_.min_rtt_us(), 5000u);
+  EXPECT_GT(estimator_.smoothed_rtt_us(), 5000u);
+  EXPECT_LT(estimator_.smoothed_rtt_us(), 40000u);
+}
+
+TEST_F(BandwidthEstimatorTest, RoundInProgress_NotRestartedByExtension) {
+  estimator_.OnParametersSent(At(0), 100, 100, false);
+  estimator_.OnParametersSent(At(5000), 200, 200, false);
+  estimator_.OnDataReceived(At(10000), 100, 100);
+
+  EXPECT_EQ(estimator_.min_rtt_us(), 10000u);
+  EXPECT_EQ(estimator_.max_window_size(), 200u);
+}
+
+TEST_F(BandwidthEstimatorTest, RoundInProgress_Restarted) {
+  estimator_.OnParametersSent(At(0), 100, 100, false);
+  estimator_.OnParametersSent(At(5000), 50, 100, true);
+
+  estimator_.OnDataReceived(At(10000), 50, 100);
+  EXPECT_EQ(estimator_.min_rtt_us(), 5000u);
+}
+
+TEST_F(BandwidthEstimatorTest, BandwidthFilter_KeepsMaximum) {
+  RunRound(0, 1000, 1000);  // 1 MB/s
+  RunRound(1000, 1000, 500);
+  RunRound(2000, 1000, 250);
+
+  EXPECT_EQ(estimator_.bandwidth_bytes_per_second(), 1'000'000u);
+}
+
+TEST_F(BandwidthEstimatorTest, BandwidthFilter_MaximumExpires) {
+  RunRound(0, 1000, 1000);
+  uint32_t now = 1000;
+  for (uint32_t i = 0; i < BandwidthEstimator::kBandwidthFilterRounds; ++i) {
+    RunRound(now, 1000, 500);
+    now += 1000;
+  }
+  EXPECT_EQ(estimator_.bandwidth_bytes_per_second(), 1'000'000u);
+
+  RunRound(now, 1000, 500);
+  EXPECT_EQ(estimator_.bandwidth_bytes_per_second(), 500'000u);
+}
+
+TEST_F(BandwidthEstimatorTest, Plateau_AfterRoundsWithoutGrowth) {
+  uint32_t now = 0;
+  for (uint32_t bytes = 1000; bytes <= 8000; bytes *= 2) {
+    RunRound(now, 1000, bytes);
+    now += 1000;
+    EXPECT_FALSE(estimator_.bandwidth_plateaued());
+  }
+
+  for (uint32_t i = 0; i < BandwidthEstimator::kPlateauRounds - 1; ++i) {
+    RunRound(now, 1000, 9000);
+    now += 1000;
+    EXPECT_FALSE(estimator_.bandwidth_plateaued());
+  }
+
+  RunRound(now, 1000, 9000);
+  EXPECT_TRUE(estimator_.bandwidth_plateaued());
+}
+
+TEST_F(BandwidthEstimatorTest, Reset_ClearsEstimates) {
+  RunRound(0, 1000, 1000);
+  ASSERT_TRUE(estimator_.has_estimate());
+
+  estimator_.Reset();
+  EXPECT_FALSE(estimator_.has_estimate());
+  EXPECT_EQ(estimator_.max_window_size(), 0u);
+}
+
+}  // namespace
+}  // namespace pw::transfer::internal
@@ -77,6 +77,39 @@ Result<Chunk::Identifier> Chunk::ExtractIdentifier(ConstByteSpan message) {
   return Status::DataLoss();
 }
 
+namespace {
+
+Result<Chunk::Range> ParseRange(ConstByteSpan message) {
+  protobuf::Decoder decoder(message);
+  Chunk::Range range{0, 0};
+  Status status;
+
+  while ((status = decoder.Next()).ok()) {
+    switch (static_cast<ProtoChunk::Range::Fields>(decoder.FieldNumber())) {
+      case ProtoChunk::Range::Fields::kStartOffset:
+        PW_TRY(decoder.ReadUint32(&range.start));
+        break;
+      case ProtoChunk::Range::Fields::kEndOffset:
+        PW_TRY(decoder.ReadUint32(&range.end));
+        break;
+    }
+  }
+
+  if (!status.IsOutOfRange() || range.end <= range.start) {
+    return Status::DataLoss();
+  }
+  return range;
+}
+
+size_t RangeEncodedSize(const Chunk::Range& range) {
+  return protobuf::SizeOfVarintField(ProtoChunk::Range::Fields::kStartOffset,
+                                     range.start) +
+         protobuf::SizeOfVarintField(ProtoChunk::Range::Fields::kEndOffset,
+                                     range.end);
+}
+
+}  // namespace
+
 Result<Chunk> Chunk::Parse(ConstByteSpan message) {
   protobuf::Decoder decoder(message);
   Status status;
@@ -193,6 +226,14 @@ Result<Chunk> Chunk::Parse(ConstByteSpan message) {
         chunk.set_initial_offset(value);
         break;
 
+      case ProtoChunk::Fields::kReceivedRanges: {
+        ConstByteSpan range_message;
+        PW_TRY(decoder.ReadBytes(&range_message));
+        PW_TRY_ASSIGN(const Range range, ParseRange(range_message));
+        chunk.add_received_range(range.start, range.end);
+        break;
+      }
+
         // Silently ignore any unrecognized fields.
     }
   }
@@ -306,6 +347,13 @@ Result<ConstByteSpan> Chunk::Encode(ByteSpan buffer) const {
     encoder.WriteStatus(status_.value().code()).IgnoreError();
   }
 
+  for (const Range& range : received_ranges()) {
+    ProtoChunk::Range::StreamEncoder range_encoder =
+        encoder.GetReceivedRangesEncoder();
+    range_encoder.WriteStartOffset(range.start).IgnoreError();
+    range_encoder.WriteEndOffset(range.end).IgnoreError();
+  }
+
   PW_TRY(encoder.status());
   return ConstByteSpan(encoder);
 }
@@ -392,6 +440,11 @@ size_t Chunk::EncodedSize() const {
                                         status_.value().code());
   }
 
+  for (const Range& range : received_ranges()) {
+    size += protobuf::SizeOfDelimitedField(ProtoChunk::Fields::kReceivedRanges,
+                                           RangeEncodedSize(range));
+  }
+
   return size;
 }
 
@@ -62,5 +62,35 @@ TEST(Chunk, EncodedSizeMatchesBuffer) {
   EXPECT_EQ(chunk.EncodedSize(), result->size_bytes());
 }
 
+TEST(Chunk, ReceivedRangesRoundTrip) {
+  Chunk chunk(ProtocolVersion::kVersionTwo, Chunk::Type::kParametersRetransmit);
+  chunk.set_session_id(42)
+      .set_offset(16)
+      .set_window_end_offset(1024)
+      .add_received_range(32, 64)
+      .add_received_range(200, 300);
+
+  std::array<std::byte, 64> buffer;
+  auto result = chunk.Encode(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(chunk.EncodedSize(), result->size_bytes());
+
+  auto parsed = Chunk::Parse(*result);
+  ASSERT_EQ(parsed.status(), OkStatus());
+  ASSERT_EQ(parsed->received_ranges().size(), 2u);
+  EXPECT_EQ(parsed->received_ranges()[0].start, 32u);
+  EXPECT_EQ(parsed->received_ranges()[0].end, 64u);
+  EXPECT_EQ(parsed->received_ranges()[1].start, 200u);
+  EXPECT_EQ(parsed->received_ranges()[1].end, 300u);
+}
+
+TEST(Chunk, ReceivedRangesBeyondMaximumAreDropped) {
+  Chunk chunk(ProtocolVersion::kVersionTwo, Chunk::Type::kParametersRetransmit);
+  for (uint32_t i = 0; i < cfg::kMaxSelectiveAckRanges + 1; ++i) {
+    chunk.add_received_range(10 * (i + 1), 10 * (i + 1) + 5);
+  }
+  EXPECT_EQ(chunk.received_ranges().size(), cfg::kMaxSelectiveAckRanges);
+}
+
 }  // namespace
 }  // namespace pw::transfer::internal
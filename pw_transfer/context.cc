@@ -17,6 +17,7 @@
 
 #include "pw_transfer/internal/context.h"
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 
@@ -25,6 +26,7 @@
 #include "pw_log/log.h"
 #include "pw_log/rate_limited.h"
 #include "pw_protobuf/serialized_size.h"
+#include "pw_status/try.h"
 #include "pw_transfer/internal/config.h"
 #include "pw_transfer/transfer.pwpb.h"
 #include "pw_transfer/transfer_thread.h"
@@ -210,13 +212,31 @@ void Context::UpdateTransferParameters(TransmitAction action) {
         break;
 
       case TransmitAction::kExtend:
+        // With an adaptive window, slow start ends once the link's bandwidth
+        // stops growing, rather than only on packet loss.
+        if (max_parameters_->adaptive_window() &&
+            transmit_phase_ == TransmitPhase::kSlowStart &&
+            bandwidth_estimator_.bandwidth_plateaued()) {
+          transmit_phase_ = TransmitPhase::kCongestionAvoidance;
+        }
+
         // Window was received successfully without packet loss and should grow.
-        // Double the window size during slow start, or increase it by a single
-        // chunk in congestion avoidance.
-        if (transmit_phase_ == TransmitPhase::kCongestionAvoidance) {
-          window_size_multiplier_ += 1;
-        } else {
+        // Double the window size during slow start. In congestion avoidance,
+        // size it to a multiple of the bandwidth-delay product if it is being
+        // adapted, or increase it by a single chunk otherwise.
+        if (transmit_phase_ == TransmitPhase::kSlowStart) {
           window_size_multiplier_ *= 2;
+        } else if (max_parameters_->adaptive_window() &&
+                   bandwidth_estimator_.has_estimate()) {
+          const uint64_t target =
+              static_cast<uint64_t>(
+                  bandwidth_estimator_.BandwidthDelayProduct()) *
+              kAdaptiveWindowGain;
+          window_size_multiplier_ = static_cast<uint32_t>(std::max<uint64_t>(
+              (target + max_chunk_size_bytes_ - 1) / max_chunk_size_bytes_,
+              1));
+        } else {
+          window_size_multiplier_ += 1;
         }
 
         // The window size can never exceed the user-specified maximum bytes. If
@@ -249,6 +269,7 @@ void Context::UpdateTransferParameters(TransmitAction action) {
 
   window_size_ = window_size;
   window_end_offset_ = offset_ + window_size;
+  ClipReceivedRanges();
 }
 
 void Context::SetTransferParameters(Chunk& parameters) {
@@ -256,11 +277,37 @@ void Context::SetTransferParameters(Chunk& parameters) {
       .set_max_chunk_size_bytes(max_chunk_size_bytes_)
       .set_min_delay_microseconds(kDefaultChunkDelayMicroseconds)
       .set_offset(offset_);
+
+  // Report data received out of order, as long as it fits in the encode
+  // buffer. Encoding a nested message temporarily reserves space for a
+  // maximum-size length prefix.
+  const size_t max_size =
+      thread_->encode_buffer().size() - varint::kMaxVarint64SizeBytes;
+  for (size_t i = 0; i < num_received_ranges_; ++i) {
+    Chunk with_range = parameters;
+    with_range.add_received_range(received_ranges_[i].start,
+                                  received_ranges_[i].end);
+    if (with_range.EncodedSize() > max_size) {
+      break;
+    }
+    parameters = with_range;
+  }
 }
 
 void Context::UpdateAndSendTransferParameters(TransmitAction action) {
+  // Only an extension allows data beyond the current window to be sent.
+  // Otherwise, the transmitter responds by sending from the current offset.
+  const uint32_t response_offset =
+      action == TransmitAction::kExtend ? window_end_offset_ : offset_;
+
   UpdateTransferParameters(action);
 
+  bandwidth_estimator_.OnParametersSent(
+      chrono::SystemClock::now(),
+      response_offset,
+      window_size_,
+      /*restart_round=*/action != TransmitAction::kExtend);
+
   return SendTransferParameters(action);
 }
 
@@ -397,6 +444,7 @@ void Context::Initialize(const NewTransferEvent& new_transfer) {
 
   last_chunk_sent_ = Chunk::Type::kStart;
   last_chunk_offset_ = 0;
+  num_received_ranges_ = 0;
   chunk_timeout_ = new_transfer.timeout;
   initial_chunk_timeout_ = new_transfer.initial_timeout;
   interchunk_delay_ = chrono::SystemClock::for_at_least(
@@ -405,6 +453,7 @@ void Context::Initialize(const NewTransferEvent& new_transfer) {
   log_chunks_before_rate_limit_ = log_chunks_before_rate_limit_cfg_;
 
   transfer_rate_.Reset();
+  bandwidth_estimator_.Reset();
 }
 
 void Context::HandleChunkEvent(const ChunkEvent& event) {
@@ -651,6 +700,22 @@ void Context::HandleTransferParametersUpdate(const Chunk& chunk) {
     }
 
     offset_ = chunk.offset();
+  } else if (chunk.offset() > offset_ && SeekReader(chunk.offset()).ok()) {
+    // The receiver already holds everything before its offset, having stored
+    // some of it out of order. Skip ahead instead of resending that data.
+    offset_ = chunk.offset();
+  }
+
+  // Each parameters chunk replaces any previously acknowledged ranges. Ignore
+  // ranges which are out of order or already behind the transmit offset.
+  num_received_ranges_ = 0;
+  uint32_t previous_end = offset_;
+  for (const Chunk::Range& range : chunk.received_ranges()) {
+    if (range.start > previous_end &&
+        num_received_ranges_ < received_ranges_.size()) {
+      received_ranges_[num_received_ranges_++] = range;
+      previous_end = range.end;
+    }
   }
 
   window_end_offset_ = chunk.window_end_offset();
@@ -690,6 +755,20 @@ void Context::HandleTransferParametersUpdate(const Chunk& chunk) {
 }
 
 void Context::TransmitNextChunk(bool retransmit_requested) {
+  const uint32_t offset_before_skip = offset_;
+  SkipReceivedRanges();
+
+  if (offset_ != offset_before_skip && offset_ >= window_end_offset_ &&
+      offset_ < TransferSizeBytes()) {
+    // The rest of the window was acknowledged by the receiver. Wait for it to
+    // send new parameters.
+    PW_LOG_DEBUG("Transfer %u: remainder of window already received",
+                 id_for_log());
+    set_transfer_state(TransferState::kWaiting);
+    SetTimeout(chunk_timeout_);
+    return;
+  }
+
   Chunk chunk(configured_protocol_version_, Chunk::Type::kData);
   chunk.set_session_id(session_id_);
   chunk.set_offset(offset_);
@@ -706,19 +785,36 @@ void Context::TransmitNextChunk(bool retransmit_requested) {
   }
 
   ByteSpan buffer = thread_->encode_buffer();
-  Result<ByteSpan> data;
+  const ConstByteSpan contiguous_data = ContiguousData();
+  Result<ConstByteSpan> data;
 
   if (offset_ < total_size) {
-    // Read the next chunk of data into the encode buffer.
     ByteSpan data_buffer = buffer.subspan(reserved_size);
     size_t max_bytes_to_send =
         std::min(window_end_offset_ - offset_, max_chunk_size_bytes_);
 
+    // Stop at the next range the receiver already holds.
+    if (num_received_ranges_ > 0) {
+      max_bytes_to_send = std::min<size_t>(
+          max_bytes_to_send, received_ranges_[0].start - offset_);
+    }
+
     if (max_bytes_to_send < data_buffer.size()) {
       data_buffer = data_buffer.first(max_bytes_to_send);
     }
 
-    data = reader().Read(data_buffer);
+    if (contiguous_data.empty()) {
+      // Read the next chunk of data into the encode buffer.
+      data = reader().Read(data_buffer);
+    } else if (offset_ < contiguous_data.size()) {
+      // Reference the data in place. Chunks are limited to the same size as
+      // when reading into the encode buffer.
+      data = contiguous_data.subspan(
+          offset_,
+          std::min(data_buffer.size(), contiguous_data.size() - offset_));
+    } else {
+      data = Status::OutOfRange();
+    }
   } else {
     // The user-specified resource size has been reached: respect it.
     data = Status::OutOfRange();
@@ -769,15 +865,28 @@ void Context::TransmitNextChunk(bool retransmit_requested) {
     return;
   }
 
-  Result<ConstByteSpan> encoded_chunk = chunk.Encode(buffer);
-  if (!encoded_chunk.ok()) {
-    PW_LOG_ERROR("Transfer %u failed to encode transmit chunk",
-                 static_cast<unsigned>(session_id_));
-    TerminateTransfer(Status::Internal());
-    return;
+  Status status;
+  if (contiguous_data.empty()) {
+    Result<ConstByteSpan> encoded_chunk = chunk.Encode(buffer);
+    if (!encoded_chunk.ok()) {
+      PW_LOG_ERROR("Transfer %u failed to encode transmit chunk",
+                   static_cast<unsigned>(session_id_));
+      TerminateTransfer(Status::Internal());
+      return;
+    }
+    status = rpc_writer_->Write(*encoded_chunk);
+  } else {
+    // Encode the chunk straight from the resource into the RPC payload, so its
+    // data is copied only once.
+    status = rpc_writer_->WriteEncoded(
+        buffer.size(), [&chunk](ByteSpan payload_buffer) {
+          Result<ConstByteSpan> encoded_chunk = chunk.Encode(payload_buffer);
+          return encoded_chunk.ok() ? StatusWithSize(encoded_chunk->size())
+                                    : StatusWithSize(encoded_chunk.status(), 0);
+        });
   }
 
-  if (const Status status = rpc_writer_->Write(*encoded_chunk); !status.ok()) {
+  if (!status.ok()) {
     PW_LOG_ERROR("Transfer %u failed to send transmit chunk, status %u",
                  static_cast<unsigned>(session_id_),
                  status.code());
@@ -837,6 +946,19 @@ void Context::HandleReceiveChunk(const Chunk& chunk) {
 
     case TransferState::kRecovery:
       if (chunk.offset() != offset_) {
+        if (max_parameters_->selective_ack()) {
+          // Keep the rest of the window as it arrives, so that only the
+          // missing data has to be retransmitted.
+          if (IsDuplicateData(chunk)) {
+            SetTimeout(chunk_timeout_);
+            return;
+          }
+          StoreOutOfOrderData(chunk);
+          if (DataTransferComplete()) {
+            return;
+          }
+        }
+
         if (last_chunk_offset_ == chunk.offset()) {
           PW_LOG_DEBUG(
               "Transfer %u received repeated offset %u; retry detected, "
@@ -881,6 +1003,19 @@ void Context::HandleReceiveChunk(const Chunk& chunk) {
 
 void Context::HandleReceivedData(const Chunk& chunk) {
   if (chunk.offset() != offset_) {
+    if (max_parameters_->selective_ack()) {
+      if (IsDuplicateData(chunk)) {
+        // Data which was already received is sent again when the transmitter
+        // ignores or does not know about selective acknowledgements.
+        SetTimeout(chunk_timeout_);
+        return;
+      }
+      StoreOutOfOrderData(chunk);
+      if (DataTransferComplete()) {
+        return;
+      }
+    }
+
     // Bad offset; reset window size to send another parameters chunk.
     PW_LOG_DEBUG(
         "Transfer %u expected offset %u, received %u; entering recovery "
@@ -922,25 +1057,24 @@ void Context::HandleReceivedData(const Chunk& chunk) {
   // Update the last offset seen so that retries can be detected.
   last_chunk_offset_ = chunk.offset();
 
-  // Write staged data from the buffer to the stream.
-  if (chunk.has_payload()) {
-    if (Status status = writer().Write(chunk.payload()); !status.ok()) {
-      PW_LOG_ERROR(
-          "Transfer %u write of %u B chunk failed with status %u; aborting "
-          "with DATA_LOSS",
-          static_cast<unsigned>(session_id_),
-          static_cast<unsigned>(chunk.payload().size()),
-          status.code());
-      TerminateTransfer(Status::DataLoss());
-      return;
-    }
+  // Write staged data from the buffer to the stream. This updates offset_.
+  if (Status status = WriteReceivedData(chunk.payload()); !status.ok()) {
+    PW_LOG_ERROR(
+        "Transfer %u write of %u B chunk failed with status %u; aborting "
+        "with DATA_LOSS",
+        static_cast<unsigned>(session_id_),
+        static_cast<unsigned>(chunk.payload().size()),
+        status.code());
+    TerminateTransfer(Status::DataLoss());
+    return;
+  }
 
+  if (chunk.has_payload()) {
     transfer_rate_.Update(chunk.payload().size());
+    bandwidth_estimator_.OnDataReceived(
+        chrono::SystemClock::now(), chunk.offset(), chunk.payload().size());
   }
 
-  // Update the transfer state.
-  offset_ += chunk.payload().size();
-
   // When the client sets remaining_bytes to 0, it indicates completion of the
   // transfer. Acknowledge the completion through a status chunk and clean up.
   if (chunk.IsFinalTransmitChunk()) {
@@ -1001,6 +1135,205 @@ void Context::HandleReceivedData(const Chunk& chunk) {
   }
 }
 
+Status Context::WriteReceivedData(ConstByteSpan data) {
+  const uint32_t data_offset = offset_;
+  const uint32_t data_end = offset_ + data.size();
+
+  while (true) {
+    // Move past data which was already written out of order.
+    while (num_received_ranges_ > 0 && received_ranges_[0].start <= offset_) {
+      const uint32_t range_end = received_ranges_[0].end;
+      PopReceivedRange();
+
+      if (range_end > offset_) {
+        PW_TRY(writer().Seek(static_cast<ptrdiff_t>(range_end - offset_),
+                             stream::Stream::kCurrent));
+        offset_ = range_end;
+      }
+    }
+
+    if (offset_ >= data_end) {
+      return OkStatus();
+    }
+
+    ConstByteSpan pending = data.subspan(offset_ - data_offset);
+    if (num_received_ranges_ > 0) {
+      pending = pending.first(std::min<size_t>(
+          pending.size(), received_ranges_[0].start - offset_));
+    }
+
+    PW_TRY(writer().Write(pending));
+    offset_ += pending.size();
+  }
+}
+
+bool Context::IsDuplicateData(const Chunk& chunk) const {
+  if (!chunk.has_payload()) {
+    return false;
+  }
+
+  const uint32_t start = chunk.offset();
+  const uint32_t end = start + chunk.payload().size();
+
+  if (end <= offset_) {
+    return true;
+  }
+
+  for (size_t i = 0; i < num_received_ranges_; ++i) {
+    if (received_ranges_[i].start <= start && end <= received_ranges_[i].end) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Context::StoreOutOfOrderData(const Chunk& chunk) {
+  if ((flags_ & kFlagsWriterNotSeekable) == kFlagsWriterNotSeekable) {
+    return false;
+  }
+
+  const uint32_t start = chunk.offset();
+  const uint32_t end = start + chunk.payload().size();
+
+  // The final chunk is only accepted in order, as it completes the transfer.
+  if (start <= offset_ || !chunk.has_payload() ||
+      chunk.IsFinalTransmitChunk() || end > window_end_offset_) {
+    return false;
+  }
+
+  // Find the ranges which the new data extends, if any. Data which partially
+  // overlaps an existing range is dropped and recovered by retransmission.
+  size_t insert_at = num_received_ranges_;
+  size_t extends_left = num_received_ranges_;
+  size_t extends_right = num_received_ranges_;
+
+  for (size_t i = 0; i < num_received_ranges_; ++i) {
+    const Chunk::Range& range = received_ranges_[i];
+    if (range.start < end && start < range.end) {
+      return false;
+    }
+    if (range.end == start) {
+      extends_left = i;
+    }
+    if (range.start == end) {
+      extends_right = i;
+    }
+    if (insert_at == num_received_ranges_ && range.start > start) {
+      insert_at = i;
+    }
+  }
+
+  const bool new_range = extends_left == num_received_ranges_ &&
+                         extends_right == num_received_ranges_;
+  if (new_range && num_received_ranges_ == received_ranges_.size()) {
+    return false;
+  }
+
+  // Write the data at its position, then return to offset_ for in-order data.
+  if (!writer()
+           .Seek(static_cast<ptrdiff_t>(start - offset_),
+                 stream::Stream::kCurrent)
+           .ok()) {
+    PW_LOG_DEBUG("Transfer %u: writer cannot seek; disabling selective ACK",
+                 id_for_log());
+    flags_ |= kFlagsWriterNotSeekable;
+    return false;
+  }
+
+  if (Status status = writer().Write(chunk.payload()); !status.ok()) {
+    PW_LOG_ERROR(
+        "Transfer %u out-of-order write at offset %u failed with status %u; "
+        "aborting with DATA_LOSS",
+        id_for_log(),
+        static_cast<unsigned>(start),
+        status.code());
+    TerminateTransfer(Status::DataLoss());
+    return false;
+  }
+
+  if (!writer()
+           .Seek(-static_cast<ptrdiff_t>(end - offset_),
+                 stream::Stream::kCurrent)
+           .ok()) {
+    PW_LOG_ERROR("Transfer %u failed to seek writer back to offset %u",
+                 id_for_log(),
+                 static_cast<unsigned>(offset_));
+    TerminateTransfer(Status::DataLoss());
+    return false;
+  }
+
+  if (new_range) {
+    std::copy_backward(received_ranges_.begin() + insert_at,
+                       received_ranges_.begin() + num_received_ranges_,
+                       received_ranges_.begin() + num_received_ranges_ + 1);
+    received_ranges_[insert_at] = Chunk::Range{start, end};
+    num_received_ranges_ += 1;
+  } else if (extends_left == num_received_ranges_) {
+    received_ranges_[extends_right].start = start;
+  } else {
+    received_ranges_[extends_left].end = end;
+
+    if (extends_right != num_received_ranges_) {
+      // The data filled the gap between two ranges; merge them.
+      received_ranges_[extends_left].end = received_ranges_[extends_right].end;
+      std::copy(received_ranges_.begin() + extends_right + 1,
+                received_ranges_.begin() + num_received_ranges_,
+                received_ranges_.begin() + extends_right);
+      num_received_ranges_ -= 1;
+    }
+  }
+
+  PW_LOG_DEBUG("Transfer %u stored out-of-order data at offset %u size %u",
+               id_for_log(),
+               static_cast<unsigned>(start),
+               static_cast<unsigned>(chunk.payload().size()));
+  transfer_rate_.Update(chunk.payload().size());
+  return true;
+}
+
+void Context::ClipReceivedRanges() {
+  while (num_received_ranges_ > 0 &&
+         received_ranges_[num_received_ranges_ - 1].start >=
+             window_end_offset_) {
+    num_received_ranges_ -= 1;
+  }
+
+  if (num_received_ranges_ > 0) {
+    Chunk::Range& last = received_ranges_[num_received_ranges_ - 1];
+    last.end = std::min(last.end, window_end_offset_);
+  }
+}
+
+void Context::SkipReceivedRanges() {
+  while (num_received_ranges_ > 0 && received_ranges_[0].start <= offset_) {
+    const uint32_t range_end = received_ranges_[0].end;
+    PopReceivedRange();
+
+    if (range_end <= offset_) {
+      continue;
+    }
+
+    if (!SeekReader(range_end).ok()) {
+      // Without seeking, the acknowledged data must be read and sent anyway.
+      num_received_ranges_ = 0;
+      return;
+    }
+
+    PW_LOG_DEBUG("Transfer %u skipping acknowledged data from %u to %u",
+                 id_for_log(),
+                 static_cast<unsigned>(offset_),
+                 static_cast<unsigned>(range_end));
+    offset_ = range_end;
+  }
+}
+
+void Context::PopReceivedRange() {
+  std::copy(received_ranges_.begin() + 1,
+            received_ranges_.begin() + num_received_ranges_,
+            received_ranges_.begin());
+  num_received_ranges_ -= 1;
+}
+
 void Context::HandleTerminatingChunk(const Chunk& chunk) {
   switch (chunk.type()) {
     case Chunk::Type::kCompletion:
@@ -1094,6 +1427,12 @@ void Context::Finish(Status status) {
   status.Update(FinalCleanup(status));
   status_ = status;
 
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+  if (type() == TransferType::kReceive && bandwidth_estimator_.has_estimate()) {
+    thread_->RecordReceiveStatistics(bandwidth_estimator_);
+  }
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
   SetTimeout(kFinalChunkAckTimeout);
 }
 
@@ -0,0 +1,343 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares write transfers with and without adaptive window sizing over a
+// simulated high-latency link.
+//
+// A transfer client and service run in one process, connected by a simulated
+// link in each direction. A link serializes packets at a fixed rate, delays
+// them by a fixed latency, and drops packets which arrive while its queue is
+// full, like a bottleneck router.
+//
+// Usage:
+//
+//   adaptive_window_benchmark [latency_ms] [rate_kB_per_s] [bytes]
+//
+// The transmitter paces chunks at the minimum delay requested by the receiver,
+// so the link rate must be below the resulting rate to be the bottleneck.
+//
+// Results are logged per configuration: throughput, data packets dropped by
+// the link, and the link estimates the receiving transfer thread recorded in
+// its metrics. The estimates are only recorded when
+// PW_TRANSFER_CONFIG_RECEIVE_METRICS is enabled, and are logged as 0 otherwise.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pw_assert/check.h"
+#include "pw_function/function.h"
+#include "pw_log/log.h"
+#include "pw_metric/metric.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/server.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_stream/null_stream.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/thread.h"
+#include "pw_thread/thread_core.h"
+#include "pw_thread_stl/options.h"
+#include "pw_tokenizer/tokenize.h"
+#include "pw_transfer/client.h"
+#include "pw_transfer/internal/config.h"
+#include "pw_transfer/handler.h"
+#include "pw_transfer/transfer.h"
+#include "pw_transfer/transfer_thread.h"
+
+namespace pw::transfer {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kChannelId = 1;
+constexpr uint32_t kResourceId = 1;
+constexpr size_t kChunkBufferSize = rpc::MaxSafePayloadSize();
+constexpr uint32_t kMaxWindowSizeBytes = 256 * 1024;
+
+// The link's queue holds this many bytes beyond those being transmitted.
+constexpr size_t kQueueSizeBytes = 16 * 1024;
+
+thread::Options& ThreadOptions() {
+  static thread::stl::Options options;
+  return options;
+}
+
+struct LinkConfig {
+  Clock::duration latency;
+  uint32_t bytes_per_second;
+};
+
+// One direction of a simulated link. Packets are delivered to the destination
+// from the link's thread once they have been serialized and propagated.
+class SimulatedLink final : public rpc::ChannelOutput,
+                            public thread::ThreadCore {
+ public:
+  SimulatedLink(const char* name, const LinkConfig& config)
+      : rpc::ChannelOutput(name), config_(config) {}
+
+  void set_destination(Function<void(ConstByteSpan)>&& destination) {
+    destination_ = std::move(destination);
+  }
+
+  Status Send(span<const std::byte> packet) override {
+    std::lock_guard lock(mutex_);
+    const Clock::time_point now = Clock::now();
+
+    // Bytes still waiting to be serialized when this packet arrives.
+    const Clock::duration backlog =
+        std::max(Clock::duration::zero(), transmitter_free_ - now);
+    if (BytesFor(backlog) > kQueueSizeBytes) {
+      drops_ += 1;
+      return OkStatus();  // Lost on the link, not a send failure.
+    }
+
+    transmitter_free_ = std::max(transmitter_free_, now) + TimeFor(packet);
+    packets_.push_back(
+        {transmitter_free_ + config_.latency, {packet.begin(), packet.end()}});
+    packet_available_.notify_one();
+    return OkStatus();
+  }
+
+  void Stop() {
+    std::lock_guard lock(mutex_);
+    stopped_ = true;
+    packet_available_.notify_one();
+  }
+
+  size_t drops() const { return drops_; }
+
+ private:
+  struct Packet {
+    Clock::time_point delivery_time;
+    std::vector<std::byte> data;
+  };
+
+  Clock::duration TimeFor(span<const std::byte> packet) const {
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(packet.size()) /
+                                      config_.bytes_per_second));
+  }
+
+  size_t BytesFor(Clock::duration duration) const {
+    return static_cast<size_t>(
+        std::chrono::duration<double>(duration).count() *
+        config_.bytes_per_second);
+  }
+
+  void Run() override {
+    while (true) {
+      Packet packet;
+      {
+        std::unique_lock lock(mutex_);
+        packet_available_.wait(
+            lock, [this] { return stopped_ || !packets_.empty(); });
+        if (stopped_) {
+          return;
+        }
+        packet = std::move(packets_.front());
+        packets_.pop_front();
+      }
+      std::this_thread::sleep_until(packet.delivery_time);
+      destination_(packet.data);
+    }
+  }
+
+  const LinkConfig config_;
+  Function<void(ConstByteSpan)> destination_;
+  std::mutex mutex_;
+  std::condition_variable packet_available_;
+  std::deque<Packet> packets_;
+  Clock::time_point transmitter_free_;
+  size_t drops_ = 0;
+  bool stopped_ = false;
+};
+
+class DiscardHandler final : public WriteOnlyHandler {
+ public:
+  DiscardHandler() : WriteOnlyHandler(kResourceId, sink_) {}
+
+  size_t bytes_written() const { return sink_.bytes_written(); }
+
+ private:
+  stream::CountingNullStream sink_;
+};
+
+struct TransferThreadWithBuffers {
+  TransferThreadWithBuffers() : transfer_thread(chunk_buffer, encode_buffer) {
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+    transfer_thread.AddMetricsTo(metrics);
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+  }
+
+  std::array<std::byte, kChunkBufferSize> chunk_buffer;
+  std::array<std::byte, kChunkBufferSize> encode_buffer;
+  PW_METRIC_GROUP(metrics, "transfer_thread");
+  Thread<1, 1> transfer_thread;
+};
+
+#define METRIC_TOKEN(name) \
+  PW_TOKENIZE_STRING_MASK_EXPR("metrics", _PW_METRIC_TOKEN_MASK, name)
+
+uint32_t MetricValue(const metric::Group& group, metric::Token name) {
+  for (const metric::Metric& metric : group.metrics()) {
+    if (metric.name() == name) {
+      return metric.as_int();
+    }
+  }
+  return 0;
+}
+
+struct Result {
+  double kb_per_second;
+  size_t data_drops;
+  uint32_t min_rtt_us;
+  uint32_t bandwidth_bytes_per_second;
+  uint32_t max_window_size;
+};
+
+// Runs one write transfer of payload over the link and returns its results.
+Result Measure(const LinkConfig& config,
+               bool adaptive_window,
+               ConstByteSpan payload) {
+  SimulatedLink to_server("to_server", config);
+  SimulatedLink to_client("to_client", config);
+  rpc::Channel server_channels[] = {
+      rpc::Channel::Create<kChannelId>(&to_client)};
+  rpc::Channel client_channels[] = {
+      rpc::Channel::Create<kChannelId>(&to_server)};
+  rpc::Server server(server_channels);
+  rpc::Client rpc_client(client_channels);
+  to_server.set_destination([&server](ConstByteSpan packet) {
+    server.ProcessPacket(packet).IgnoreError();
+  });
+  to_client.set_destination([&rpc_client](ConstByteSpan packet) {
+    rpc_client.ProcessPacket(packet).IgnoreError();
+  });
+
+  TransferThreadWithBuffers server_thread;
+  TransferThreadWithBuffers client_thread;
+
+  TransferService service(server_thread.transfer_thread, kMaxWindowSizeBytes);
+  service.set_adaptive_window(adaptive_window);
+  server.RegisterService(service);
+
+  std::vector<std::unique_ptr<thread::Thread>> threads;
+  auto start_thread = [&threads](thread::ThreadCore& core) {
+    threads.push_back(std::make_unique<thread::Thread>(ThreadOptions(), core));
+  };
+  start_thread(to_server);
+  start_thread(to_client);
+  start_thread(server_thread.transfer_thread);
+  start_thread(client_thread.transfer_thread);
+
+  // Registration waits for the transfer thread, so it must be running.
+  DiscardHandler handler;
+  service.RegisterHandler(handler);
+
+  Client client(rpc_client,
+                kChannelId,
+                client_thread.transfer_thread,
+                kMaxWindowSizeBytes);
+
+  stream::MemoryReader reader(payload);
+  struct {
+    sync::BinarySemaphore done;
+    Status status;
+  } completion;
+
+  const Clock::time_point start = Clock::now();
+  PW_CHECK_OK(client
+                  .Write(kResourceId,
+                         reader,
+                         [&completion](Status status) {
+                           completion.status = status;
+                           completion.done.release();
+                         })
+                  .status());
+  completion.done.acquire();
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  PW_CHECK_OK(completion.status);
+  PW_CHECK_UINT_EQ(handler.bytes_written(), payload.size());
+
+  service.UnregisterHandler(handler);
+  server.UnregisterService(service);
+
+  const metric::Group& metrics = server_thread.metrics;
+  const Result measured = {
+      static_cast<double>(payload.size()) / elapsed.count() / 1e3,
+      to_server.drops(),
+      MetricValue(metrics, METRIC_TOKEN("last_min_rtt_us")),
+      MetricValue(metrics, METRIC_TOKEN("last_bandwidth_bytes_per_second")),
+      MetricValue(metrics, METRIC_TOKEN("last_max_window_size")),
+  };
+
+  client_thread.transfer_thread.Terminate();
+  server_thread.transfer_thread.Terminate();
+  to_server.Stop();
+  to_client.Stop();
+  for (const auto& thread : threads) {
+    thread->join();
+  }
+
+  return measured;
+}
+
+}  // namespace
+}  // namespace pw::transfer
+
+int main(int argc, char* argv[]) {
+  const unsigned latency_ms =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50;
+  const unsigned rate_kb_per_second =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+  const size_t bytes =
+      argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 512 * 1024;
+
+  const pw::transfer::LinkConfig config = {
+      std::chrono::milliseconds(latency_ms), rate_kb_per_second * 1000};
+
+  std::vector<std::byte> payload(bytes);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(i);
+  }
+
+  PW_LOG_INFO("Write transfer of %u bytes, %u ms one-way latency, %u kB/s",
+              static_cast<unsigned>(bytes),
+              latency_ms,
+              rate_kb_per_second);
+  for (bool adaptive_window : {false, true}) {
+    const pw::transfer::Result result =
+        pw::transfer::Measure(config, adaptive_window, payload);
+    PW_LOG_INFO(
+        "  %-8s window: %8.2f kB/s  drops: %5u  min RTT: %6u us  "
+        "bandwidth: %8u B/s  max window: %6u B",
+        adaptive_window ? "adaptive" : "default",
+        result.kb_per_second,
+        static_cast<unsigned>(result.data_drops),
+        static_cast<unsigned>(result.min_rtt_us),
+        static_cast<unsigned>(result.bandwidth_bytes_per_second),
+        static_cast<unsigned>(result.max_window_size));
+  }
+  return 0;
+}
@@ -98,6 +98,7 @@ pw::Status PerformTransferActions(const pw::transfer::ClientConfig& config) {
 
   client.set_max_retries(config.max_retries());
   client.set_max_lifetime_retries(config.max_lifetime_retries());
+  client.set_selective_ack(config.selective_ack());
 
   Status status = pw::OkStatus();
   for (int i = 0; i < num_actions; i++) {
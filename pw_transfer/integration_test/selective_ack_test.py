@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# Copyright 2024 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""pw_transfer selective acknowledgement tests over a lossy, reordering link.
+
+Runs C++ transfers through a proxy which drops and transposes packets at a
+range of rates, with and without selective acknowledgement, and logs the
+goodput of each configuration when the test class finishes.
+
+Usage:
+
+   bazel run pw_transfer/integration_test:selective_ack_test
+
+Command-line arguments must be provided after a double-dash:
+
+   bazel run pw_transfer/integration_test:selective_ack_test -- \
+       --server-port 3318
+
+Which tests to run can be specified as command-line arguments:
+
+  bazel run pw_transfer/integration_test:selective_ack_test -- \
+      SelectiveAckIntegrationTest.test_lossy_client_write_0_05_sack
+
+"""
+
+import itertools
+import logging
+import random
+import sys
+import time
+
+from google.protobuf import text_format
+from parameterized import parameterized
+
+from pigweed.pw_transfer.integration_test import config_pb2
+from pigweed.pw_transfer.integration_test import test_fixture
+from test_fixture import TransferIntegrationTestHarness, TransferConfig
+
+_LOG = logging.getLogger('pw_transfer_selective_ack_test')
+_LOG.level = logging.INFO
+_LOG.addHandler(logging.StreamHandler(sys.stdout))
+
+_LOSS_RATES = (0.0, 0.01, 0.05, 0.1)
+_SELECTIVE_ACK = (False, True)
+_PAYLOAD_SIZE = 64 * 1024
+
+
+def _name_func(testcase_func, _, param):
+    loss_rate, selective_ack = param.args
+    loss = f'{loss_rate:.2f}'.replace('.', '_')
+    mode = 'sack' if selective_ack else 'go_back_n'
+    return f'{testcase_func.__name__}_{loss}_{mode}'
+
+
+def _lossy_proxy_config(loss_rate: float) -> config_pb2.ProxyConfig:
+    """Drops packets at loss_rate and transposes a few in both directions."""
+    return text_format.Parse(
+        f"""
+            client_filter_stack: [
+                {{ hdlc_packetizer: {{}} }},
+                {{ data_dropper: {{rate: {loss_rate}, seed: 1649963713563718435}} }},
+                {{ data_transposer: {{rate: 0.02, timeout: 0.5, seed: 1649963713563718437}} }}
+            ]
+
+            server_filter_stack: [
+                {{ hdlc_packetizer: {{}} }},
+                {{ data_dropper: {{rate: {loss_rate}, seed: 1649963713563718436}} }},
+                {{ data_transposer: {{rate: 0.02, timeout: 0.5, seed: 1649963713563718438}} }}
+        ]""",
+        config_pb2.ProxyConfig(),
+    )
+
+
+class SelectiveAckIntegrationTest(test_fixture.TransferIntegrationTest):
+    # Each set of transfer tests uses a different client/server port pair to
+    # allow tests to be run in parallel.
+    HARNESS_CONFIG = TransferIntegrationTestHarness.Config(
+        server_port=3318, client_port=3319
+    )
+
+    # Goodput in bytes/s, keyed by (direction, loss rate, selective ACK).
+    _goodput: dict[tuple[str, float, bool], float] = {}
+
+    @classmethod
+    def tearDownClass(cls):
+        lines = ['Goodput by loss rate (bytes/s):']
+        lines.append(
+            f'  {"direction":<10}{"loss":>6}{"go-back-N":>14}{"SACK":>14}'
+        )
+        for direction, loss_rate in itertools.product(
+            ('write', 'read'), _LOSS_RATES
+        ):
+            go_back_n = cls._goodput.get((direction, loss_rate, False))
+            sack = cls._goodput.get((direction, loss_rate, True))
+            if go_back_n is None and sack is None:
+                continue
+            lines.append(
+                f'  {direction:<10}{loss_rate:>6.2f}'
+                f'{go_back_n or 0:>14.0f}{sack or 0:>14.0f}'
+            )
+        _LOG.info('\n'.join(lines))
+
+    def _config(self, loss_rate: float, selective_ack: bool) -> TransferConfig:
+        config = TransferConfig(
+            self.default_server_config(),
+            self.default_client_config(),
+            _lossy_proxy_config(loss_rate),
+        )
+        config.server.selective_ack = selective_ack
+        config.client.selective_ack = selective_ack
+        return config
+
+    @parameterized.expand(
+        itertools.product(_LOSS_RATES, _SELECTIVE_ACK), name_func=_name_func
+    )
+    def test_lossy_client_write(self, loss_rate, selective_ack):
+        payload = random.Random(1603798506).randbytes(_PAYLOAD_SIZE)
+        config = self._config(loss_rate, selective_ack)
+
+        start = time.monotonic()
+        self.do_single_write(
+            'cpp', config, 7, payload, permanent_resource_id=True
+        )
+        elapsed = time.monotonic() - start
+
+        self._goodput[('write', loss_rate, selective_ack)] = (
+            len(payload) / elapsed
+        )
+
+    @parameterized.expand(
+        itertools.product(_LOSS_RATES, _SELECTIVE_ACK), name_func=_name_func
+    )
+    def test_lossy_client_read(self, loss_rate, selective_ack):
+        payload = random.Random(1603798507).randbytes(_PAYLOAD_SIZE)
+        config = self._config(loss_rate, selective_ack)
+
+        start = time.monotonic()
+        self.do_single_read(
+            'cpp', config, 7, payload, permanent_resource_id=True
+        )
+        elapsed = time.monotonic() - start
+
+        self._goodput[('read', loss_rate, selective_ack)] = (
+            len(payload) / elapsed
+        )
+
+
+if __name__ == '__main__':
+    test_fixture.run_tests_for(SelectiveAckIntegrationTest)
@@ -186,6 +186,7 @@ void RunServer(int socket_port, ServerConfig config) {
       std::chrono::seconds(config.chunk_timeout_seconds()),
       config.transfer_service_retries(),
       config.extend_window_divisor());
+  transfer_service.set_selective_ack(config.selective_ack());
 
   rpc::system_server::set_socket_port(socket_port);
 
@@ -0,0 +1,296 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Measures the aggregate throughput of a ShardedTransferService as the number
+// of concurrent write transfers and the number of shards vary.
+//
+// A transfer client and the service run in one process, connected by an
+// in-memory loopback. Each direction of the loopback delivers packets from its
+// own thread, so transfer threads never process their peer's packets on their
+// own stack. Transferred data is discarded by the server's handlers.
+//
+// Usage:
+//
+//   sharded_benchmark [max_shards] [bytes_per_transfer]
+//
+// Results are logged as a table of MB/s by shard count and session count.
+// Shards only run in parallel when they have cores to run on, so run this on a
+// machine with at least `max_shards` cores; a warning is logged otherwise.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pw_assert/check.h"
+#include "pw_function/function.h"
+#include "pw_log/log.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/server.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_stream/null_stream.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/thread.h"
+#include "pw_thread/thread_core.h"
+#include "pw_thread_stl/options.h"
+#include "pw_transfer/client.h"
+#include "pw_transfer/handler.h"
+#include "pw_transfer/sharded_transfer_service.h"
+#include "pw_transfer/transfer_thread.h"
+
+namespace pw::transfer {
+namespace {
+
+constexpr uint32_t kChannelId = 1;
+constexpr size_t kMaxSessions = 64;
+constexpr size_t kSessionCounts[] = {1, 4, 16, 64};
+constexpr size_t kMaxWindowSizeBytes = 16384;
+constexpr size_t kChunkBufferSize = rpc::MaxSafePayloadSize();
+
+thread::Options& ThreadOptions() {
+  static thread::stl::Options options;
+  return options;
+}
+
+// One direction of the loopback. Packets sent through the output are copied
+// into a queue and passed to the destination from the loopback's thread.
+class Loopback final : public rpc::ChannelOutput, public thread::ThreadCore {
+ public:
+  explicit Loopback(const char* name) : rpc::ChannelOutput(name) {}
+
+  void set_destination(Function<void(ConstByteSpan)>&& destination) {
+    destination_ = std::move(destination);
+  }
+
+  Status Send(span<const std::byte> packet) override {
+    std::lock_guard lock(mutex_);
+    packets_.emplace_back(packet.begin(), packet.end());
+    packet_available_.notify_one();
+    return OkStatus();
+  }
+
+  void Stop() {
+    std::lock_guard lock(mutex_);
+    stopped_ = true;
+    packet_available_.notify_one();
+  }
+
+ private:
+  void Run() override {
+    while (true) {
+      std::vector<std::byte> packet;
+      {
+        std::unique_lock lock(mutex_);
+        packet_available_.wait(
+            lock, [this] { return stopped_ || !packets_.empty(); });
+        if (stopped_) {
+          return;
+        }
+        packet = std::move(packets_.front());
+        packets_.pop_front();
+      }
+      destination_(packet);
+    }
+  }
+
+  Function<void(ConstByteSpan)> destination_;
+  std::mutex mutex_;
+  std::condition_variable packet_available_;
+  std::deque<std::vector<std::byte>> packets_;
+  bool stopped_ = false;
+};
+
+struct ServerShard {
+  ServerShard() : transfer_thread(chunk_buffer, encode_buffer) {}
+
+  std::array<std::byte, kChunkBufferSize> chunk_buffer;
+  std::array<std::byte, kChunkBufferSize> encode_buffer;
+  Thread<0, kMaxSessions> transfer_thread;
+};
+
+struct ClientThread {
+  ClientThread() : transfer_thread(chunk_buffer, encode_buffer) {}
+
+  std::array<std::byte, kChunkBufferSize> chunk_buffer;
+  std::array<std::byte, kChunkBufferSize> encode_buffer;
+  Thread<kMaxSessions, 0> transfer_thread;
+};
+
+class DiscardHandler final : public WriteOnlyHandler {
+ public:
+  explicit DiscardHandler(uint32_t resource_id)
+      : WriteOnlyHandler(resource_id, sink_) {}
+
+  size_t bytes_written() const { return sink_.bytes_written(); }
+
+ private:
+  stream::CountingNullStream sink_;
+};
+
+struct Completions {
+  std::atomic<size_t> remaining;
+  std::atomic<bool> failed;
+  sync::BinarySemaphore done;
+};
+
+// Runs `sessions` concurrent write transfers of `payload` against a service
+// with `shard_count` shards, returning the aggregate throughput in MB/s.
+double Measure(size_t shard_count, size_t sessions, ConstByteSpan payload) {
+  Loopback to_server("to_server");
+  Loopback to_client("to_client");
+  rpc::Channel server_channels[] = {
+      rpc::Channel::Create<kChannelId>(&to_client)};
+  rpc::Channel client_channels[] = {
+      rpc::Channel::Create<kChannelId>(&to_server)};
+  rpc::Server server(server_channels);
+  rpc::Client rpc_client(client_channels);
+  to_server.set_destination([&server](ConstByteSpan packet) {
+    server.ProcessPacket(packet).IgnoreError();
+  });
+  to_client.set_destination([&rpc_client](ConstByteSpan packet) {
+    rpc_client.ProcessPacket(packet).IgnoreError();
+  });
+
+  std::vector<std::unique_ptr<ServerShard>> shards;
+  std::vector<TransferThread*> shard_threads;
+  for (size_t i = 0; i < shard_count; ++i) {
+    shards.push_back(std::make_unique<ServerShard>());
+    shard_threads.push_back(&shards.back()->transfer_thread);
+  }
+  ClientThread client_thread;
+
+  ShardedTransferService service(shard_threads, kMaxWindowSizeBytes);
+  server.RegisterService(service);
+
+  std::vector<std::unique_ptr<DiscardHandler>> handlers;
+  for (size_t i = 0; i < sessions; ++i) {
+    handlers.push_back(
+        std::make_unique<DiscardHandler>(static_cast<uint32_t>(i + 1)));
+    service.RegisterHandler(*handlers.back());
+  }
+
+  std::vector<std::unique_ptr<thread::Thread>> threads;
+  auto start_thread = [&threads](thread::ThreadCore& core) {
+    threads.push_back(std::make_unique<thread::Thread>(ThreadOptions(), core));
+  };
+  start_thread(to_server);
+  start_thread(to_client);
+  start_thread(client_thread.transfer_thread);
+  for (TransferThread* shard : shard_threads) {
+    start_thread(*shard);
+  }
+
+  Client client(rpc_client,
+                kChannelId,
+                client_thread.transfer_thread,
+                kMaxWindowSizeBytes);
+
+  std::vector<std::unique_ptr<stream::MemoryReader>> readers;
+  for (size_t i = 0; i < sessions; ++i) {
+    readers.push_back(std::make_unique<stream::MemoryReader>(payload));
+  }
+  Completions completions;
+  completions.remaining = sessions;
+  completions.failed = false;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < sessions; ++i) {
+    Result<Client::Handle> handle =
+        client.Write(static_cast<uint32_t>(i + 1),
+                     *readers[i],
+                     [&completions](Status status) {
+                       if (!status.ok()) {
+                         completions.failed = true;
+                       }
+                       if (--completions.remaining == 0) {
+                         completions.done.release();
+                       }
+                     });
+    PW_CHECK_OK(handle.status());
+  }
+  completions.done.acquire();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  PW_CHECK(!completions.failed, "A transfer failed");
+  for (const auto& handler : handlers) {
+    PW_CHECK_UINT_EQ(handler->bytes_written(), payload.size());
+  }
+
+  // Handlers are unregistered while the shards are running, since doing so
+  // waits for each shard to process a removal event.
+  for (const auto& handler : handlers) {
+    service.UnregisterHandler(*handler);
+  }
+  server.UnregisterService(service);
+
+  client_thread.transfer_thread.Terminate();
+  for (TransferThread* shard : shard_threads) {
+    shard->Terminate();
+  }
+  to_server.Stop();
+  to_client.Stop();
+  for (const auto& thread : threads) {
+    thread->join();
+  }
+
+  return static_cast<double>(sessions * payload.size()) / elapsed.count() /
+         1e6;
+}
+
+}  // namespace
+}  // namespace pw::transfer
+
+int main(int argc, char* argv[]) {
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  const size_t max_shards =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : cores;
+  const size_t bytes_per_transfer =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256 * 1024;
+
+  std::vector<std::byte> payload(bytes_per_transfer);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<std::byte>(i);
+  }
+
+  PW_LOG_INFO("Aggregate write throughput (MB/s), %u bytes per transfer, "
+              "%u cores",
+              static_cast<unsigned>(bytes_per_transfer),
+              static_cast<unsigned>(cores));
+  if (max_shards > cores) {
+    PW_LOG_WARN("Only %u cores are available; results for more shards do not "
+                "measure parallel scaling",
+                static_cast<unsigned>(cores));
+  }
+  for (size_t shards = 1; shards <= max_shards; shards *= 2) {
+    for (size_t sessions : pw::transfer::kSessionCounts) {
+      const double mb_per_second =
+          pw::transfer::Measure(shards, sessions, payload);
+      PW_LOG_INFO("  shards: %2u  sessions: %2u  %8.2f MB/s",
+                  static_cast<unsigned>(shards),
+                  static_cast<unsigned>(sessions),
+                  mb_per_second);
+    }
+  }
+  return 0;
+}
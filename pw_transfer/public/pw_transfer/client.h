@@ -170,6 +170,21 @@ class Client {
     return OkStatus();
   }
 
+  // Enables selective acknowledgement in read transfers. Data which arrives out
+  // of order is written directly to its position in the output writer, and the
+  // server is told which ranges it can skip when retransmitting. Requires
+  // writers which support seeking relative to their current position.
+  constexpr void set_selective_ack(bool selective_ack) {
+    max_parameters_.set_selective_ack(selective_ack);
+  }
+
+  // Enables adaptive window sizing in read transfers. After slow start, the
+  // receive window is sized from the measured bandwidth-delay product of the
+  // link rather than grown by one chunk per window.
+  constexpr void set_adaptive_window(bool adaptive_window) {
+    max_parameters_.set_adaptive_window(adaptive_window);
+  }
+
   constexpr Status set_max_retries(uint32_t max_retries) {
     if (max_retries < 1 || max_retries > max_lifetime_retries_) {
       return Status::InvalidArgument();
@@ -16,6 +16,7 @@
 #include <limits>
 
 #include "pw_assert/assert.h"
+#include "pw_bytes/span.h"
 #include "pw_containers/intrusive_list.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
@@ -93,6 +94,16 @@ class Handler : public IntrusiveList<Handler>::Item {
     return std::numeric_limits<size_t>::max();
   }
 
+  /// The resource's data, if it is stored in contiguous, directly addressable
+  /// memory such as a RAM buffer or memory-mapped flash. Returns an empty span
+  /// otherwise, which is the default.
+  ///
+  /// Read transfers of resources with contiguous data encode chunks directly
+  /// from it rather than reading them through the handler's reader, avoiding
+  /// intermediate copies. The data must begin at offset 0 of the resource and
+  /// remain valid from a successful `PrepareRead()` until `FinalizeRead()`.
+  virtual ConstByteSpan ContiguousData() const { return {}; }
+
   // GetStatus() is called to Transfer.GetResourceStatus RPC. The application
   // layer invoking transfers should define the contents of these status
   // variables for proper interpretation.
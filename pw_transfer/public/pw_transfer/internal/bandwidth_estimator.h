@@ -0,0 +1,114 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+
+namespace pw::transfer::internal {
+
+// Estimates the round-trip time and bottleneck bandwidth of a receive transfer
+// from the timing of its transfer parameters and the data sent in response.
+//
+// Measurements are taken in rounds. A round starts when the receiver sends
+// transfer parameters, and ends when the first data the transmitter could only
+// send in response to them arrives. Each round yields an RTT sample and a
+// delivery rate sample: the bytes received during the round divided by its
+// duration.
+//
+// As in BBR, the bandwidth-delay product is estimated from the minimum RTT and
+// the maximum delivery rate over recent rounds. Bandwidth is considered to have
+// plateaued once a round fails to grow it by at least 25%.
+class BandwidthEstimator {
+ public:
+  // Number of rounds over which the maximum delivery rate is taken.
+  static constexpr uint32_t kBandwidthFilterRounds = 10;
+
+  // Number of rounds without significant bandwidth growth after which the
+  // bandwidth has plateaued. The receive window doubles each round during slow
+  // start, so every additional round doubles the data queued on the link.
+  static constexpr uint32_t kPlateauRounds = 1;
+
+  constexpr BandwidthEstimator()
+      : round_start_(),
+        round_start_delivered_(0),
+        round_end_offset_(0),
+        round_in_progress_(false),
+        delivered_(0),
+        min_rtt_us_(0),
+        smoothed_rtt_us_(0),
+        bandwidth_(0),
+        bandwidth_age_(0),
+        plateau_bandwidth_(0),
+        plateau_rounds_(0),
+        max_window_size_(0) {}
+
+  void Reset() { *this = BandwidthEstimator(); }
+
+  // Called when the receiver sends transfer parameters. The transmitter may
+  // only send data at or past end_offset in response to them. A restarted
+  // round discards the round in progress, e.g. after data was lost.
+  void OnParametersSent(chrono::SystemClock::time_point now,
+                        uint32_t end_offset,
+                        uint32_t window_size,
+                        bool restart_round);
+
+  // Called for each chunk of data received in order.
+  void OnDataReceived(chrono::SystemClock::time_point now,
+                      uint32_t offset,
+                      size_t size);
+
+  // True once a round has completed with a nonzero delivery rate.
+  bool has_estimate() const { return bandwidth_ != 0 && min_rtt_us_ != 0; }
+
+  // True if the bandwidth estimate has stopped growing.
+  bool bandwidth_plateaued() const {
+    return plateau_rounds_ >= kPlateauRounds;
+  }
+
+  uint32_t min_rtt_us() const { return min_rtt_us_; }
+  uint32_t smoothed_rtt_us() const { return smoothed_rtt_us_; }
+  uint32_t bandwidth_bytes_per_second() const { return bandwidth_; }
+
+  // The largest window advertised by the receiver.
+  uint32_t max_window_size() const { return max_window_size_; }
+
+  // The estimated number of bytes in flight needed to keep the link busy.
+  uint32_t BandwidthDelayProduct() const;
+
+ private:
+  void UpdateBandwidth(uint32_t sample);
+
+  chrono::SystemClock::time_point round_start_;
+  uint64_t round_start_delivered_;
+  uint32_t round_end_offset_;
+  bool round_in_progress_;
+
+  uint64_t delivered_;
+
+  uint32_t min_rtt_us_;
+  uint32_t smoothed_rtt_us_;
+
+  uint32_t bandwidth_;
+  uint32_t bandwidth_age_;
+
+  uint32_t plateau_bandwidth_;
+  uint32_t plateau_rounds_;
+
+  uint32_t max_window_size_;
+};
+
+}  // namespace pw::transfer::internal
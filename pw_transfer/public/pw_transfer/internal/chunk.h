@@ -13,11 +13,14 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <optional>
 
 #include "pw_bytes/span.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_result/result.h"
+#include "pw_span/span.h"
+#include "pw_transfer/internal/config.h"
 #include "pw_transfer/internal/protocol.h"
 #include "pw_transfer/transfer.pwpb.h"
 
@@ -61,6 +64,13 @@ class Chunk {
     uint32_t value_;
   };
 
+  // A contiguous range of transfer data, [start, end), held by a receiver
+  // beyond its current offset.
+  struct Range {
+    uint32_t start;
+    uint32_t end;
+  };
+
   // Partially decodes a transfer chunk to find its transfer context identifier.
   // Depending on the protocol version and type of chunk, this may be one of
   // several proto fields.
@@ -150,6 +160,16 @@ class Chunk {
     return *this;
   }
 
+  // Appends a selectively acknowledged range. Ranges must be added in order.
+  // Selective acknowledgements are advisory, so any ranges beyond
+  // cfg::kMaxSelectiveAckRanges are silently dropped.
+  constexpr Chunk& add_received_range(uint32_t start, uint32_t end) {
+    if (num_received_ranges_ < received_ranges_.size()) {
+      received_ranges_[num_received_ranges_++] = Range{start, end};
+    }
+    return *this;
+  }
+
   // TODO(frolv): For some reason, the compiler complains if this setter is
   // marked constexpr. Leaving it off for now, but this should be investigated
   // and fixed.
@@ -196,6 +216,10 @@ class Chunk {
     return remaining_bytes_;
   }
 
+  constexpr span<const Range> received_ranges() const {
+    return span(received_ranges_.data(), num_received_ranges_);
+  }
+
   constexpr ProtocolVersion protocol_version() const {
     return protocol_version_;
   }
@@ -279,7 +303,9 @@ class Chunk {
         remaining_bytes_(std::nullopt),
         status_(std::nullopt),
         type_(type),
-        protocol_version_(version) {}
+        protocol_version_(version),
+        received_ranges_{},
+        num_received_ranges_(0) {}
 
   constexpr Chunk() : Chunk(ProtocolVersion::kUnknown, std::nullopt) {}
 
@@ -308,6 +334,8 @@ class Chunk {
   std::optional<Status> status_;
   std::optional<Type> type_;
   ProtocolVersion protocol_version_;
+  std::array<Range, cfg::kMaxSelectiveAckRanges> received_ranges_;
+  uint8_t num_received_ranges_;
 };
 
 }  // namespace pw::transfer::internal
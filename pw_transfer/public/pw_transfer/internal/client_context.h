@@ -47,6 +47,9 @@ class ClientContext final : public Context {
   // needs to be shifted back for the initial offset.
   Status SeekReader(uint32_t offset) override;
 
+  // Client transfers always read through their stream.
+  ConstByteSpan ContiguousData() const override { return {}; }
+
   // Transfer clients assign a unique handle_id to all active transfer sessions.
   // Unlike session or transfer IDs, this value is local to the client, not
   // requiring any coordination with the transfer server, allowing users of the
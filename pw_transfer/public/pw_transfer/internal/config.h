@@ -17,6 +17,7 @@
 
 #include <chrono>
 #include <cinttypes>
+#include <cstddef>
 #include <limits>
 
 #include "pw_chrono/system_clock.h"
@@ -167,6 +168,36 @@ static_assert(PW_TRANSFER_DEFAULT_INITIAL_TIMEOUT_MS > 0);
 
 static_assert(PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR > 1);
 
+// The maximum number of out-of-order ranges a receive transfer tracks when
+// selective acknowledgement is enabled. Each range costs 8 bytes in every
+// transfer context and every parsed chunk. Out-of-order data which would need
+// an additional range is dropped and recovered by retransmission.
+#ifndef PW_TRANSFER_CONFIG_MAX_SELECTIVE_ACK_RANGES
+#define PW_TRANSFER_CONFIG_MAX_SELECTIVE_ACK_RANGES 4
+#endif  // PW_TRANSFER_CONFIG_MAX_SELECTIVE_ACK_RANGES
+
+static_assert(PW_TRANSFER_CONFIG_MAX_SELECTIVE_ACK_RANGES > 0 &&
+              PW_TRANSFER_CONFIG_MAX_SELECTIVE_ACK_RANGES <= 255);
+
+// The number of buckets into which registered transfer handlers are hashed by
+// resource ID. Each bucket costs one pointer in every transfer thread and
+// sharded transfer service. Services with many handlers can raise this to keep
+// handler lookups short.
+#ifndef PW_TRANSFER_CONFIG_HANDLER_REGISTRY_BUCKETS
+#define PW_TRANSFER_CONFIG_HANDLER_REGISTRY_BUCKETS 8
+#endif  // PW_TRANSFER_CONFIG_HANDLER_REGISTRY_BUCKETS
+
+static_assert(PW_TRANSFER_CONFIG_HANDLER_REGISTRY_BUCKETS > 0);
+
+// Whether each transfer thread records the link estimates of the receive
+// transfers it completes in metrics. Recording them requires pw_metric, which
+// must be added to the dependencies of the module configuration, and costs
+// about 64 bytes per transfer thread, plus about 216 bytes for histograms on
+// targets with lock-free atomics.
+#ifndef PW_TRANSFER_CONFIG_RECEIVE_METRICS
+#define PW_TRANSFER_CONFIG_RECEIVE_METRICS 0
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
 // Number of chunks to send repetitative logs at full rate before reducing to
 // rate_limit. Retransmit parameter chunks will restart at this chunk count
 // limit.
@@ -211,6 +242,12 @@ inline constexpr chrono::SystemClock::duration kDefaultInitialChunkTimeout =
 inline constexpr uint32_t kDefaultExtendWindowDivisor =
     PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR;
 
+inline constexpr size_t kMaxSelectiveAckRanges =
+    PW_TRANSFER_CONFIG_MAX_SELECTIVE_ACK_RANGES;
+
+inline constexpr size_t kHandlerRegistryBuckets =
+    PW_TRANSFER_CONFIG_HANDLER_REGISTRY_BUCKETS;
+
 inline constexpr uint16_t kLogDefaultChunksBeforeRateLimit =
     PW_TRANSFER_LOG_DEFAULT_CHUNKS_BEFORE_RATE_LIMIT;
 inline constexpr chrono::SystemClock::duration kLogDefaultRateLimit =
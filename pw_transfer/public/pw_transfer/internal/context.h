@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <cinttypes>
 #include <cstddef>
 #include <limits>
@@ -23,6 +24,7 @@
 #include "pw_rpc/writer.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
+#include "pw_transfer/internal/bandwidth_estimator.h"
 #include "pw_transfer/internal/chunk.h"
 #include "pw_transfer/internal/config.h"
 #include "pw_transfer/internal/event.h"
@@ -40,7 +42,9 @@ class TransferParameters {
                                uint32_t extend_window_divisor)
       : max_window_size_bytes_(max_window_size_bytes),
         max_chunk_size_bytes_(max_chunk_size_bytes),
-        extend_window_divisor_(extend_window_divisor) {
+        extend_window_divisor_(extend_window_divisor),
+        selective_ack_(false),
+        adaptive_window_(false) {
     PW_ASSERT(max_window_size_bytes > 0);
     PW_ASSERT(max_chunk_size_bytes > 0);
     PW_ASSERT(extend_window_divisor > 1);
@@ -68,10 +72,26 @@ class TransferParameters {
     extend_window_divisor_ = extend_window_divisor;
   }
 
+  // Whether receive transfers keep data which arrives out of order and report
+  // it to the transmitter through selective acknowledgements.
+  constexpr bool selective_ack() const { return selective_ack_; }
+  constexpr void set_selective_ack(bool selective_ack) {
+    selective_ack_ = selective_ack;
+  }
+
+  // Whether receive transfers size their window from the measured
+  // bandwidth-delay product once slow start ends.
+  constexpr bool adaptive_window() const { return adaptive_window_; }
+  constexpr void set_adaptive_window(bool adaptive_window) {
+    adaptive_window_ = adaptive_window;
+  }
+
  private:
   uint32_t max_window_size_bytes_;
   uint32_t max_chunk_size_bytes_;
   uint32_t extend_window_divisor_;
+  bool selective_ack_;
+  bool adaptive_window_;
 };
 
 // Information about a single transfer.
@@ -142,6 +162,8 @@ class Context {
         thread_(nullptr),
         last_chunk_sent_(Chunk::Type::kData),
         last_chunk_offset_(0),
+        received_ranges_{},
+        num_received_ranges_(0),
         chunk_timeout_(chrono::SystemClock::duration::zero()),
         initial_chunk_timeout_(chrono::SystemClock::duration::zero()),
         interchunk_delay_(chrono::SystemClock::for_at_least(
@@ -286,6 +308,11 @@ class Context {
   // seek method.
   virtual Status SeekReader(uint32_t offset) = 0;
 
+  // Returns the data of a transmit transfer's source if it is stored in
+  // contiguous memory, in which case chunks are encoded directly from it
+  // instead of being read from the reader. Returns an empty span otherwise.
+  virtual ConstByteSpan ContiguousData() const = 0;
+
   // Processes a chunk in either a transfer or receive transfer.
   void HandleChunkEvent(const ChunkEvent& event);
 
@@ -309,6 +336,33 @@ class Context {
   // Processes a data chunk in a received while in the kWaiting state.
   void HandleReceivedData(const Chunk& chunk);
 
+  // Writes in-order data at offset_, skipping over ranges which were already
+  // received out of order. Advances offset_ past the data and any ranges
+  // contiguous with it.
+  Status WriteReceivedData(ConstByteSpan data);
+
+  // In a receive transfer with selective acknowledgement enabled, attempts to
+  // store a chunk which arrived ahead of offset_ directly at its position in
+  // the writer. Returns true if the chunk's data is now held by the receiver.
+  // Terminates the transfer if the writer fails partway through.
+  bool StoreOutOfOrderData(const Chunk& chunk);
+
+  // Returns true if data in a receive transfer's chunk was already received,
+  // either in order or as one of the received_ranges_.
+  bool IsDuplicateData(const Chunk& chunk) const;
+
+  // Drops received ranges which extend past the current window, so that the
+  // receiver never skips beyond data the transmitter has been allowed to send.
+  void ClipReceivedRanges();
+
+  // In a transmit transfer, moves offset_ past any data which the receiver has
+  // selectively acknowledged. If the reader cannot seek, the acknowledged
+  // ranges are discarded and their data is sent again.
+  void SkipReceivedRanges();
+
+  // Removes the first entry of received_ranges_.
+  void PopReceivedRange();
+
   // Sends the first chunk in a legacy transmit transfer.
   void SendInitialLegacyTransmitChunk();
 
@@ -372,9 +426,17 @@ class Context {
   static constexpr uint8_t kFlagsType = 1 << 0;
   static constexpr uint8_t kFlagsDataSent = 1 << 1;
   static constexpr uint8_t kFlagsContactMade = 1 << 2;
+  static constexpr uint8_t kFlagsWriterNotSeekable = 1 << 3;
 
   static constexpr uint32_t kDefaultChunkDelayMicroseconds = 2000;
 
+  // Multiple of the bandwidth-delay product used as the window size when it is
+  // adapted. The window is only extended once a portion of it has been
+  // received, so less than all of it is in flight at any time; the headroom
+  // keeps the link busy between extensions and lets the estimate grow if it
+  // was limited by the window.
+  static constexpr uint32_t kAdaptiveWindowGain = 3;
+
   // How long to wait for the other side to ACK a final transfer chunk before
   // resetting the context so that it can be reused. During this time, the
   // status chunk will be re-sent for every non-ACK chunk received,
@@ -427,6 +489,12 @@ class Context {
     uint32_t last_chunk_offset_;  // Used in states kWaiting and kRecovery.
   };
 
+  // Selective acknowledgement state. In a receive transfer, the sorted ranges
+  // beyond offset_ which were written out of order. In a transmit transfer,
+  // the ranges most recently acknowledged by the receiver.
+  std::array<Chunk::Range, cfg::kMaxSelectiveAckRanges> received_ranges_;
+  uint8_t num_received_ranges_;
+
   // How long to wait for a chunk from the other end.
   chrono::SystemClock::duration chunk_timeout_;
 
@@ -449,6 +517,9 @@ class Context {
   uint16_t log_chunks_before_rate_limit_;
 
   RateEstimate transfer_rate_;
+
+  // Link estimates for receive transfers.
+  BandwidthEstimator bandwidth_estimator_;
 };
 
 }  // namespace pw::transfer::internal
@@ -0,0 +1,64 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "pw_containers/intrusive_list.h"
+#include "pw_transfer/handler.h"
+#include "pw_transfer/internal/config.h"
+
+namespace pw::transfer::internal {
+
+// Set of registered transfer handlers, indexed by resource ID.
+//
+// Handlers are hashed into a fixed number of intrusive lists so that a lookup
+// only walks the handlers which share a bucket, rather than every handler
+// registered with a service. No memory is allocated.
+//
+// The registry is not synchronized; its owner is responsible for locking.
+class HandlerRegistry {
+ public:
+  HandlerRegistry() = default;
+
+  HandlerRegistry(const HandlerRegistry&) = delete;
+  HandlerRegistry& operator=(const HandlerRegistry&) = delete;
+
+  void Add(Handler& handler) { bucket(handler.id()).push_front(handler); }
+
+  // Returns true if the handler was registered.
+  bool Remove(const Handler& handler) {
+    return bucket(handler.id()).remove(handler);
+  }
+
+  // Returns the handler for a resource ID, or nullptr if none is registered.
+  Handler* Find(uint32_t resource_id) {
+    for (Handler& handler : bucket(resource_id)) {
+      if (handler.id() == resource_id) {
+        return &handler;
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  IntrusiveList<Handler>& bucket(uint32_t resource_id) {
+    return buckets_[resource_id % buckets_.size()];
+  }
+
+  std::array<IntrusiveList<Handler>, cfg::kHandlerRegistryBuckets> buckets_;
+};
+
+}  // namespace pw::transfer::internal
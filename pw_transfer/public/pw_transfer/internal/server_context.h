@@ -50,6 +50,10 @@ class ServerContext final : public Context {
   // offset
   Status SeekReader(uint32_t offset) override;
 
+  ConstByteSpan ContiguousData() const override {
+    return handler_->ContiguousData();
+  }
+
   Handler* handler_;
 };
 
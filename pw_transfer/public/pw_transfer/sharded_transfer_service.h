@@ -0,0 +1,181 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/raw/server_reader_writer.h"
+#include "pw_span/span.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_transfer/handler.h"
+#include "pw_transfer/internal/config.h"
+#include "pw_transfer/internal/context.h"
+#include "pw_transfer/internal/event.h"
+#include "pw_transfer/internal/handler_registry.h"
+#include "pw_transfer/transfer.raw_rpc.pb.h"
+#include "pw_transfer/transfer_thread.h"
+
+namespace pw::transfer {
+
+/// A transfer service which spreads its transfers across several transfer
+/// threads.
+///
+/// `TransferService` runs every transfer on a single `TransferThread`, so a
+/// server handling many concurrent transfers is limited to a single core. A
+/// `ShardedTransferService` instead assigns each transfer to one of a set of
+/// transfer threads, its shards, by session ID. All chunks for a session are
+/// processed on the same shard, so transfers themselves remain
+/// single-threaded, while transfers in different sessions run in parallel.
+///
+/// Handlers are registered with the service rather than with its shards. A
+/// handler may be used by transfers on any shard, so handlers which may be
+/// transferred in several sessions at once must tolerate being called from
+/// multiple threads.
+///
+/// The service owns its RPC streams and shares them between the shards, so a
+/// shard's server side must not be used by any other transfer service. Shards
+/// may still run transfer clients.
+class ShardedTransferService
+    : public pw_rpc::raw::Transfer::Service<ShardedTransferService> {
+ public:
+  /// Initializes a sharded transfer service. Each shard's server context
+  /// capacity limits the number of concurrent transfers assigned to it.
+  ///
+  /// The shards must outlive the service, and the `shards` span must remain
+  /// valid for the service's lifetime.
+  ShardedTransferService(
+      span<TransferThread* const> shards,
+      uint32_t max_window_size_bytes,
+      chrono::SystemClock::duration chunk_timeout = cfg::kDefaultServerTimeout,
+      uint8_t max_retries = cfg::kDefaultMaxServerRetries,
+      uint32_t extend_window_divisor = cfg::kDefaultExtendWindowDivisor,
+      uint32_t max_lifetime_retries = cfg::kDefaultMaxLifetimeRetries);
+
+  ShardedTransferService(const ShardedTransferService&) = delete;
+  ShardedTransferService(ShardedTransferService&&) = delete;
+
+  ShardedTransferService& operator=(const ShardedTransferService&) = delete;
+  ShardedTransferService& operator=(ShardedTransferService&&) = delete;
+
+  void Read(RawServerReaderWriter& reader_writer) {
+    SetStream(internal::TransferType::kTransmit, reader_writer);
+  }
+
+  void Write(RawServerReaderWriter& reader_writer) {
+    SetStream(internal::TransferType::kReceive, reader_writer);
+  }
+
+  /// Reports a resource's status. Unlike `TransferService`, the handler's
+  /// `GetStatus()` is called directly from the RPC thread.
+  void GetResourceStatus(ConstByteSpan request,
+                         rpc::RawUnaryResponder& responder);
+
+  void RegisterHandler(Handler& handler) PW_LOCKS_EXCLUDED(handlers_mutex_);
+
+  /// Unregisters a handler, terminating any transfers using it. Blocks until
+  /// every shard has terminated its transfers.
+  void UnregisterHandler(Handler& handler)
+      PW_LOCKS_EXCLUDED(unregister_mutex_, handlers_mutex_);
+
+  constexpr void set_max_window_size_bytes(uint32_t max_window_size_bytes) {
+    max_parameters_.set_max_window_size_bytes(max_window_size_bytes);
+  }
+
+  // Sets the maximum size for the data in a pw_transfer chunk. Note that the
+  // max chunk size must always fit within every shard's chunk buffer.
+  constexpr void set_max_chunk_size_bytes(uint32_t max_chunk_size_bytes) {
+    max_parameters_.set_max_chunk_size_bytes(max_chunk_size_bytes);
+  }
+
+  constexpr void set_chunk_timeout(
+      chrono::SystemClock::duration chunk_timeout) {
+    chunk_timeout_ = chunk_timeout;
+  }
+
+  constexpr void set_max_retries(uint8_t max_retries) {
+    max_retries_ = max_retries;
+  }
+
+  constexpr Status set_extend_window_divisor(uint32_t extend_window_divisor) {
+    if (extend_window_divisor <= 1) {
+      return Status::InvalidArgument();
+    }
+
+    max_parameters_.set_extend_window_divisor(extend_window_divisor);
+    return OkStatus();
+  }
+
+  // Enables selective acknowledgement in write transfers. See
+  // TransferService::set_selective_ack().
+  constexpr void set_selective_ack(bool selective_ack) {
+    max_parameters_.set_selective_ack(selective_ack);
+  }
+
+  // Enables adaptive window sizing in write transfers. See
+  // TransferService::set_adaptive_window().
+  constexpr void set_adaptive_window(bool adaptive_window) {
+    max_parameters_.set_adaptive_window(adaptive_window);
+  }
+
+ private:
+  // Returns the shard which runs the transfer with the given session ID.
+  TransferThread& shard_for(uint32_t session_id) const {
+    return *shards_[session_id % shards_.size()];
+  }
+
+  void SetStream(internal::TransferType type,
+                 RawServerReaderWriter& reader_writer);
+
+  void HandleChunk(ConstByteSpan message, internal::TransferType type);
+
+  // Looks up the handler for a new transfer, and counts the transfer as
+  // starting until FinishStart() is called with the returned epoch.
+  Handler* BeginStart(uint32_t resource_id, size_t& epoch)
+      PW_LOCKS_EXCLUDED(handlers_mutex_);
+  void FinishStart(size_t epoch) PW_LOCKS_EXCLUDED(handlers_mutex_);
+
+  span<TransferThread* const> shards_;
+
+  internal::TransferParameters max_parameters_;
+  chrono::SystemClock::duration chunk_timeout_;
+  uint8_t max_retries_;
+  uint32_t max_lifetime_retries_;
+
+  // Streams shared by all shards. Only replaced from the RPC thread, after
+  // every shard has terminated the transfers running on them.
+  rpc::RawServerReaderWriter read_stream_;
+  rpc::RawServerReaderWriter write_stream_;
+
+  // Serializes UnregisterHandler() calls, which wait on starts_finished_.
+  sync::Mutex unregister_mutex_ PW_ACQUIRED_BEFORE(handlers_mutex_);
+
+  sync::Mutex handlers_mutex_;
+  internal::HandlerRegistry handlers_ PW_GUARDED_BY(handlers_mutex_);
+
+  // Counts of transfers which looked up their handler and are being queued on
+  // a shard without the lock held, by the epoch in which they started.
+  // UnregisterHandler() starts a new epoch and waits for the transfers of the
+  // previous one to be queued, so transfers starting meanwhile don't delay it.
+  std::array<size_t, 2> starts_in_progress_ PW_GUARDED_BY(handlers_mutex_) = {};
+  size_t start_epoch_ PW_GUARDED_BY(handlers_mutex_) = 0;
+  bool unregister_waiting_ PW_GUARDED_BY(handlers_mutex_) = false;
+  sync::BinarySemaphore starts_finished_;
+};
+
+}  // namespace pw::transfer
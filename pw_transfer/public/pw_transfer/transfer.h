@@ -123,6 +123,23 @@ class TransferService : public pw_rpc::raw::Transfer::Service<TransferService> {
     return OkStatus();
   }
 
+  // Enables selective acknowledgement in write transfers. Data which arrives
+  // out of order is written directly to its position in the handler's writer,
+  // and the client is told which ranges it can skip when retransmitting.
+  // Requires writers which support seeking relative to their current
+  // position; transfers to other writers continue to recover by resending all
+  // data following a gap.
+  constexpr void set_selective_ack(bool selective_ack) {
+    max_parameters_.set_selective_ack(selective_ack);
+  }
+
+  // Enables adaptive window sizing in write transfers. After slow start, the
+  // receive window is sized from the measured bandwidth-delay product of the
+  // link rather than grown by one chunk per window.
+  constexpr void set_adaptive_window(bool adaptive_window) {
+    max_parameters_.set_adaptive_window(adaptive_window);
+  }
+
  private:
   void HandleChunk(ConstByteSpan message, internal::TransferType type);
   void ResourceStatusCallback(Status status,
@@ -27,13 +27,20 @@
 #include "pw_thread/thread_core.h"
 #include "pw_transfer/handler.h"
 #include "pw_transfer/internal/client_context.h"
+#include "pw_transfer/internal/config.h"
 #include "pw_transfer/internal/context.h"
 #include "pw_transfer/internal/event.h"
+#include "pw_transfer/internal/handler_registry.h"
 #include "pw_transfer/internal/server_context.h"
 
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+#include "pw_metric/metric.h"
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
 namespace pw::transfer {
 
 class Client;
+class ShardedTransferService;
 
 namespace internal {
 
@@ -74,7 +81,8 @@ class TransferThread : public thread::ThreadCore {
                   initial_timeout,
                   max_retries,
                   max_lifetime_retries,
-                  initial_offset);
+                  initial_offset,
+                  /*handler=*/nullptr);
   }
 
   void StartServerTransfer(TransferType type,
@@ -100,7 +108,8 @@ class TransferThread : public thread::ThreadCore {
                   timeout,
                   max_retries,
                   max_lifetime_retries,
-                  initial_offset);
+                  initial_offset,
+                  /*handler=*/nullptr);
   }
 
   void ProcessClientChunk(ConstByteSpan chunk) {
@@ -235,6 +244,13 @@ class TransferThread : public thread::ThreadCore {
 
   size_t max_chunk_size() const { return chunk_buffer_.size(); }
 
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+  // Adds the statistics of the receive transfers run on this thread to a
+  // metric group. Give each thread its own group, so that their statistics
+  // can be told apart. Must be called at most once.
+  void AddMetricsTo(metric::Group& group);
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
   // For testing only: terminates the transfer thread with a kTerminate event.
   void Terminate();
 
@@ -260,6 +276,7 @@ class TransferThread : public thread::ThreadCore {
 
  private:
   friend class transfer::Client;
+  friend class transfer::ShardedTransferService;
   friend class Context;
 
   // Maximum amount of time between transfer thread runs.
@@ -268,6 +285,11 @@ class TransferThread : public thread::ThreadCore {
 
   void UpdateClientTransfer(uint32_t handle_id, size_t transfer_size_bytes);
 
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+  // Records the link estimates of a completed receive transfer.
+  void RecordReceiveStatistics(const BandwidthEstimator& estimator);
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
   // Finds an active server or client transfer, matching against its legacy ID.
   template <typename T>
   static Context* FindActiveTransferByLegacyId(const span<T>& transfers,
@@ -337,15 +359,43 @@ class TransferThread : public thread::ThreadCore {
       case TransferStream::kClientWrite:
         return client_write_stream_.as_writer();
       case TransferStream::kServerRead:
-        return server_read_stream_.as_writer();
+        return server_read_writer();
       case TransferStream::kServerWrite:
-        return server_write_stream_.as_writer();
+        return server_write_writer();
     }
     // An unknown TransferStream value was passed, which means this function
     // was passed an invalid enum value.
     PW_ASSERT(false);
   }
 
+  rpc::Writer& server_read_writer() {
+    return shared_server_read_stream_ != nullptr
+               ? *shared_server_read_stream_
+               : server_read_stream_.as_writer();
+  }
+
+  rpc::Writer& server_write_writer() {
+    return shared_server_write_stream_ != nullptr
+               ? *shared_server_write_stream_
+               : server_write_stream_.as_writer();
+  }
+
+  // Directs server transfers to send chunks through RPC streams owned by a
+  // ShardedTransferService, which shares them between several transfer
+  // threads. Must be called before any server transfer is started.
+  void UseSharedServerStreams(rpc::Writer& read_stream,
+                              rpc::Writer& write_stream) {
+    shared_server_read_stream_ = &read_stream;
+    shared_server_write_stream_ = &write_stream;
+  }
+
+  // Terminates all server transfers of a type, as though their stream had been
+  // replaced. Used when the shared server streams are replaced.
+  void TerminateServerTransfers(TransferType type) {
+    SetStream(type == TransferType::kTransmit ? TransferStream::kServerRead
+                                              : TransferStream::kServerWrite);
+  }
+
   // Returns the earliest timeout among all active transfers, up to kMaxTimeout.
   chrono::SystemClock::time_point GetNextTransferTimeout() const;
 
@@ -364,7 +414,8 @@ class TransferThread : public thread::ThreadCore {
                      chrono::SystemClock::duration initial_timeout,
                      uint8_t max_retries,
                      uint32_t max_lifetime_retries,
-                     uint32_t initial_offset);
+                     uint32_t initial_offset,
+                     Handler* handler);
 
   void ProcessChunk(EventType type, ConstByteSpan chunk);
 
@@ -407,6 +458,11 @@ class TransferThread : public thread::ThreadCore {
   rpc::RawServerReaderWriter staged_server_stream_;
   Function<void(ConstByteSpan)> staged_server_on_next_;
 
+  // Streams owned by a ShardedTransferService, used instead of the server
+  // streams above when set.
+  rpc::Writer* shared_server_read_stream_ = nullptr;
+  rpc::Writer* shared_server_write_stream_ = nullptr;
+
   span<ClientContext> client_transfers_;
   span<ServerContext> server_transfers_;
 
@@ -418,7 +474,7 @@ class TransferThread : public thread::ThreadCore {
   uint32_t next_session_id_;
 
   // All registered transfer handlers.
-  IntrusiveList<Handler> handlers_;
+  HandlerRegistry handlers_;
 
   // Buffer in which chunk data is staged for CHUNK events.
   ByteSpan chunk_buffer_;
@@ -428,6 +484,24 @@ class TransferThread : public thread::ThreadCore {
   ByteSpan encode_buffer_;
 
   ResourceStatusCallback resource_status_callback_ = nullptr;
+
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+  // Only updated by the transfer thread.
+  PW_METRIC(receive_transfers_, "receive_transfers", 0u);
+  PW_METRIC(last_min_rtt_us_, "last_min_rtt_us", 0u);
+  PW_METRIC(last_bandwidth_bytes_per_second_,
+            "last_bandwidth_bytes_per_second",
+            0u);
+  PW_METRIC(last_max_window_size_, "last_max_window_size", 0u);
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+  // Power-of-two buckets, covering RTTs up to 4 s and rates up to 1 GiB/s.
+  PW_METRIC_HISTOGRAM(min_rtt_us_, "min_rtt_us", 23, 0);
+  PW_METRIC_HISTOGRAM(bandwidth_bytes_per_second_,
+                      "bandwidth_bytes_per_second",
+                      31,
+                      0);
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
 };
 
 }  // namespace internal
@@ -56,6 +56,11 @@ Status ServerContext::FinalCleanup(const Status status) {
 }
 
 Status ServerContext::SeekReader(uint32_t offset) {
+  // Chunks of contiguous resources are not read through the reader, so only
+  // the offset is checked.
+  if (const ConstByteSpan data = ContiguousData(); !data.empty()) {
+    return offset <= data.size() ? OkStatus() : Status::OutOfRange();
+  }
   return reader().Seek(offset);
 }
 
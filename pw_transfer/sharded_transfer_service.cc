@@ -0,0 +1,260 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_LOG_MODULE_NAME "TRN"
+#define PW_LOG_LEVEL PW_TRANSFER_CONFIG_LOG_LEVEL
+
+#include "pw_transfer/sharded_transfer_service.h"
+
+#include <array>
+#include <mutex>
+
+#include "pw_assert/check.h"
+#include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_transfer/internal/chunk.h"
+#include "pw_transfer/transfer.pwpb.h"
+
+namespace pw::transfer {
+namespace {
+
+// Chunks are staged in each shard's chunk buffer, so the maximum chunk size is
+// limited by the smallest of them.
+size_t MaxChunkSize(span<TransferThread* const> shards) {
+  size_t max_chunk_size = 0;
+  for (const TransferThread* shard : shards) {
+    if (max_chunk_size == 0 || shard->max_chunk_size() < max_chunk_size) {
+      max_chunk_size = shard->max_chunk_size();
+    }
+  }
+  return max_chunk_size;
+}
+
+}  // namespace
+
+ShardedTransferService::ShardedTransferService(
+    span<TransferThread* const> shards,
+    uint32_t max_window_size_bytes,
+    chrono::SystemClock::duration chunk_timeout,
+    uint8_t max_retries,
+    uint32_t extend_window_divisor,
+    uint32_t max_lifetime_retries)
+    : shards_(shards),
+      max_parameters_(
+          max_window_size_bytes, MaxChunkSize(shards), extend_window_divisor),
+      chunk_timeout_(chunk_timeout),
+      max_retries_(max_retries),
+      max_lifetime_retries_(max_lifetime_retries) {
+  PW_CHECK(!shards_.empty(), "A sharded transfer service requires a shard");
+
+  for (TransferThread* shard : shards_) {
+    shard->UseSharedServerStreams(read_stream_.as_writer(),
+                                  write_stream_.as_writer());
+  }
+}
+
+void ShardedTransferService::RegisterHandler(Handler& handler) {
+  std::lock_guard lock(handlers_mutex_);
+  handlers_.Add(handler);
+}
+
+void ShardedTransferService::UnregisterHandler(Handler& handler) {
+  std::lock_guard unregister_lock(unregister_mutex_);
+
+  bool wait_for_starts;
+  {
+    std::lock_guard lock(handlers_mutex_);
+    handlers_.Remove(handler);
+    wait_for_starts = starts_in_progress_[start_epoch_] > 0;
+    unregister_waiting_ = wait_for_starts;
+    start_epoch_ ^= 1;
+  }
+
+  // Transfers which found the handler before it was removed may not be queued
+  // on their shards yet. Wait for them, so they are queued before the shards'
+  // removal events and terminated by them. No transfer can find the handler
+  // from here on.
+  if (wait_for_starts) {
+    starts_finished_.acquire();
+  }
+
+  for (TransferThread* shard : shards_) {
+    shard->RemoveTransferHandler(handler);
+  }
+}
+
+Handler* ShardedTransferService::BeginStart(uint32_t resource_id,
+                                            size_t& epoch) {
+  std::lock_guard lock(handlers_mutex_);
+  epoch = start_epoch_;
+  starts_in_progress_[epoch] += 1;
+  return handlers_.Find(resource_id);
+}
+
+void ShardedTransferService::FinishStart(size_t epoch) {
+  std::lock_guard lock(handlers_mutex_);
+  starts_in_progress_[epoch] -= 1;
+  // Only an UnregisterHandler() that ended this epoch waits for it.
+  if (epoch != start_epoch_ && starts_in_progress_[epoch] == 0 &&
+      unregister_waiting_) {
+    unregister_waiting_ = false;
+    starts_finished_.release();
+  }
+}
+
+void ShardedTransferService::SetStream(internal::TransferType type,
+                                       RawServerReaderWriter& reader_writer) {
+  rpc::RawServerReaderWriter& stream =
+      type == internal::TransferType::kTransmit ? read_stream_ : write_stream_;
+
+  // Stop accepting chunks from the old stream and terminate its transfers on
+  // every shard before replacing it, so no shard sends on the new stream on
+  // behalf of an old transfer.
+  stream.set_on_next(nullptr);
+  for (TransferThread* shard : shards_) {
+    shard->TerminateServerTransfers(type);
+  }
+  for (TransferThread* shard : shards_) {
+    shard->WaitUntilEventIsProcessed();
+  }
+
+  stream = std::move(reader_writer);
+  if (type == internal::TransferType::kTransmit) {
+    stream.set_on_next([this](ConstByteSpan message) {
+      HandleChunk(message, internal::TransferType::kTransmit);
+    });
+  } else {
+    stream.set_on_next([this](ConstByteSpan message) {
+      HandleChunk(message, internal::TransferType::kReceive);
+    });
+  }
+}
+
+void ShardedTransferService::HandleChunk(ConstByteSpan message,
+                                         internal::TransferType type) {
+  Result<internal::Chunk> chunk = internal::Chunk::Parse(message);
+  if (!chunk.ok()) {
+    PW_LOG_ERROR("Failed to decode transfer chunk: %d", chunk.status().code());
+    return;
+  }
+
+  if (!chunk->IsInitialChunk()) {
+    shard_for(chunk->session_id()).ProcessServerChunk(message);
+    return;
+  }
+
+  uint32_t resource_id =
+      chunk->is_legacy() ? chunk->session_id() : chunk->resource_id().value();
+
+  uint32_t session_id;
+  if (chunk->is_legacy()) {
+    session_id = chunk->session_id();
+  } else if (chunk->desired_session_id().has_value()) {
+    session_id = chunk->desired_session_id().value();
+  } else {
+    // Non-legacy start chunks are required to use desired_session_id.
+    shard_for(chunk->session_id())
+        .SendServerStatus(type,
+                          chunk->session_id(),
+                          chunk->protocol_version(),
+                          Status::DataLoss());
+    return;
+  }
+
+  uint32_t initial_offset = chunk->is_legacy() ? 0 : chunk->initial_offset();
+
+  // Queuing the transfer may block until the shard finishes its current event,
+  // so the handler is looked up under the lock but the transfer is queued
+  // without it. The transfer counts as starting until it is queued, so that a
+  // concurrent UnregisterHandler() waits for it and then terminates it. If no
+  // handler is registered, the shard responds with NOT_FOUND.
+  size_t epoch;
+  Handler* handler = BeginStart(resource_id, epoch);
+  shard_for(session_id)
+      .StartTransfer(type,
+                     chunk->protocol_version(),
+                     session_id,
+                     resource_id,
+                     /*handle_id=*/0,
+                     message,
+                     /*stream=*/nullptr,
+                     max_parameters_,
+                     /*on_completion=*/nullptr,
+                     chunk_timeout_,
+                     chunk_timeout_,
+                     max_retries_,
+                     max_lifetime_retries_,
+                     initial_offset,
+                     handler);
+  FinishStart(epoch);
+}
+
+void ShardedTransferService::GetResourceStatus(
+    ConstByteSpan request, rpc::RawUnaryResponder& responder) {
+  uint32_t resource_id = 0;
+  Status status;
+
+  protobuf::Decoder decoder(request);
+  if (status = decoder.Next(); status.ok()) {
+    if (static_cast<pwpb::ResourceStatusRequest::Fields>(
+            decoder.FieldNumber()) !=
+            pwpb::ResourceStatusRequest::Fields::kResourceId ||
+        !decoder.ReadUint32(&resource_id).ok()) {
+      responder.Finish({}, Status::DataLoss()).IgnoreError();
+      return;
+    }
+  } else if (!status.IsOutOfRange()) {
+    responder.Finish({}, Status::DataLoss()).IgnoreError();
+    return;
+  }
+
+  std::array<std::byte, pwpb::ResourceStatus::kMaxEncodedSizeBytes> buffer = {};
+  pwpb::ResourceStatus::MemoryEncoder encoder(buffer);
+  encoder.WriteResourceId(resource_id).IgnoreError();
+
+  uint64_t readable_offset = 0;
+  uint64_t writeable_offset = 0;
+  uint64_t read_checksum = 0;
+  uint64_t write_checksum = 0;
+  {
+    std::lock_guard lock(handlers_mutex_);
+    Handler* handler = handlers_.Find(resource_id);
+    status = handler != nullptr
+                 ? handler->GetStatus(readable_offset,
+                                      writeable_offset,
+                                      read_checksum,
+                                      write_checksum)
+                 : Status::NotFound();
+  }
+
+  encoder.WriteStatus(status.code()).IgnoreError();
+  if (!status.ok()) {
+    responder.Finish(ConstByteSpan(encoder), status).IgnoreError();
+    return;
+  }
+
+  encoder.WriteReadableOffset(readable_offset).IgnoreError();
+  encoder.WriteReadChecksum(read_checksum).IgnoreError();
+  encoder.WriteWriteableOffset(writeable_offset).IgnoreError();
+  encoder.WriteWriteChecksum(write_checksum).IgnoreError();
+
+  if (!encoder.status().ok()) {
+    responder.Finish(ConstByteSpan(encoder), encoder.status()).IgnoreError();
+    return;
+  }
+
+  responder.Finish(ConstByteSpan(encoder), status).IgnoreError();
+}
+
+}  // namespace pw::transfer
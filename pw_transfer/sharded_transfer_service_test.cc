@@ -0,0 +1,261 @@
+// Copyright 2024 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_transfer/sharded_transfer_service.h"
+
+#include <array>
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "pw_bytes/array.h"
+#include "pw_rpc/raw/test_method_context.h"
+#include "pw_rpc/test_helpers.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/sleep.h"
+#include "pw_thread/thread.h"
+#include "pw_thread_stl/options.h"
+#include "pw_transfer/handler.h"
+#include "pw_transfer_private/chunk_testing.h"
+#include "pw_unit_test/framework.h"
+
+namespace pw::transfer::test {
+namespace {
+
+using internal::Chunk;
+
+// TODO(frolv): Have a generic way to obtain a thread for testing on any system.
+thread::Options& TransferThreadOptions() {
+  static thread::stl::Options options;
+  return options;
+}
+
+class SimpleReadTransfer final : public ReadOnlyHandler {
+ public:
+  SimpleReadTransfer(uint32_t resource_id, ConstByteSpan data)
+      : ReadOnlyHandler(resource_id),
+        prepare_read_called(false),
+        finalize_read_called(false),
+        finalize_read_status(Status::Unknown()),
+        reader_(data) {}
+
+  Status PrepareRead() final {
+    PW_CHECK_OK(reader_.Seek(0));
+    set_reader(reader_);
+    prepare_read_called = true;
+    return OkStatus();
+  }
+
+  void FinalizeRead(Status status) final {
+    finalize_read_called = true;
+    finalize_read_status = status;
+  }
+
+  bool prepare_read_called;
+  bool finalize_read_called;
+  Status finalize_read_status;
+
+ private:
+  stream::MemoryReader reader_;
+};
+
+// A handler whose PrepareRead() blocks until released, keeping its shard busy.
+class BlockingReadTransfer final : public ReadOnlyHandler {
+ public:
+  BlockingReadTransfer(uint32_t resource_id) : ReadOnlyHandler(resource_id) {}
+
+  Status PrepareRead() final {
+    preparing.release();
+    proceed.acquire();
+    return Status::Unavailable();
+  }
+
+  sync::BinarySemaphore preparing;
+  sync::BinarySemaphore proceed;
+};
+
+constexpr auto kData = bytes::Initialized<32>([](size_t i) { return i; });
+
+// Runs a sharded service over two shards, each of which has room for a single
+// server transfer. Legacy transfers use their resource ID as their session ID,
+// so resource 4 runs on shard 0 and resource 3 on shard 1.
+class ShardedTransferServiceTest : public ::testing::Test {
+ protected:
+  ShardedTransferServiceTest()
+      : handler_3_(3, kData),
+        handler_4_(4, kData),
+        shard_0_(chunk_buffer_0_, encode_buffer_0_),
+        shard_1_(chunk_buffer_1_, encode_buffer_1_),
+        shards_{&shard_0_, &shard_1_},
+        system_thread_0_(TransferThreadOptions(), shard_0_),
+        system_thread_1_(TransferThreadOptions(), shard_1_),
+        ctx_(span(shards_),
+             64,
+             // Use a long timeout to avoid accidentally triggering timeouts.
+             std::chrono::minutes(1)) {
+    ctx_.service().RegisterHandler(handler_3_);
+    ctx_.service().RegisterHandler(handler_4_);
+
+    ctx_.call();  // Open the read stream
+  }
+
+  ~ShardedTransferServiceTest() override {
+    shard_0_.Terminate();
+    shard_1_.Terminate();
+    system_thread_0_.join();
+    system_thread_1_.join();
+  }
+
+  void WaitForShards() {
+    shard_0_.WaitUntilEventIsProcessed();
+    shard_1_.WaitUntilEventIsProcessed();
+  }
+
+  SimpleReadTransfer handler_3_;
+  SimpleReadTransfer handler_4_;
+
+  std::array<std::byte, 64> chunk_buffer_0_;
+  std::array<std::byte, 64> encode_buffer_0_;
+  std::array<std::byte, 64> chunk_buffer_1_;
+  std::array<std::byte, 64> encode_buffer_1_;
+
+  Thread<0, 1> shard_0_;
+  Thread<0, 1> shard_1_;
+  std::array<TransferThread*, 2> shards_;
+  thread::Thread system_thread_0_;
+  thread::Thread system_thread_1_;
+  PW_RAW_TEST_METHOD_CONTEXT(ShardedTransferService, Read, 8) ctx_;
+};
+
+Chunk ReadStartChunk(uint32_t resource_id, uint32_t window_end_offset) {
+  return Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart)
+      .set_session_id(resource_id)
+      .set_window_end_offset(window_end_offset)
+      .set_offset(0);
+}
+
+TEST_F(ShardedTransferServiceTest, ConcurrentTransfersRunOnSeparateShards) {
+  rpc::test::WaitForPackets(ctx_.output(), 4, [this] {
+    ctx_.SendClientStream(EncodeChunk(ReadStartChunk(3, 64)));
+    ctx_.SendClientStream(EncodeChunk(ReadStartChunk(4, 64)));
+    WaitForShards();
+  });
+
+  // Each shard has a single context, so both transfers starting shows that
+  // they were assigned to different shards.
+  EXPECT_TRUE(handler_3_.prepare_read_called);
+  EXPECT_TRUE(handler_4_.prepare_read_called);
+
+  ASSERT_EQ(ctx_.total_responses(), 4u);
+  for (ConstByteSpan response : ctx_.responses()) {
+    Chunk chunk = DecodeChunk(response);
+    if (!chunk.has_payload()) {
+      continue;
+    }
+    EXPECT_TRUE(chunk.session_id() == 3u || chunk.session_id() == 4u);
+    ASSERT_EQ(chunk.payload().size(), kData.size());
+    EXPECT_EQ(std::memcmp(chunk.payload().data(), kData.data(), kData.size()),
+              0);
+  }
+
+  ctx_.SendClientStream(
+      EncodeChunk(Chunk::Final(ProtocolVersion::kLegacy, 3, OkStatus())));
+  ctx_.SendClientStream(
+      EncodeChunk(Chunk::Final(ProtocolVersion::kLegacy, 4, OkStatus())));
+  WaitForShards();
+
+  EXPECT_TRUE(handler_3_.finalize_read_called);
+  EXPECT_EQ(handler_3_.finalize_read_status, OkStatus());
+  EXPECT_TRUE(handler_4_.finalize_read_called);
+  EXPECT_EQ(handler_4_.finalize_read_status, OkStatus());
+}
+
+TEST_F(ShardedTransferServiceTest, UnknownResource_RespondsNotFound) {
+  ctx_.SendClientStream(EncodeChunk(ReadStartChunk(11, 64)));
+  WaitForShards();
+
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.session_id(), 11u);
+  ASSERT_TRUE(chunk.status().has_value());
+  EXPECT_EQ(chunk.status().value(), Status::NotFound());
+}
+
+TEST_F(ShardedTransferServiceTest, UnregisterHandler_TerminatesTransfer) {
+  ctx_.SendClientStream(EncodeChunk(ReadStartChunk(3, 16)));
+  WaitForShards();
+
+  EXPECT_TRUE(handler_3_.prepare_read_called);
+  EXPECT_FALSE(handler_3_.finalize_read_called);
+
+  ctx_.service().UnregisterHandler(handler_3_);
+
+  EXPECT_TRUE(handler_3_.finalize_read_called);
+  EXPECT_EQ(handler_3_.finalize_read_status, Status::Aborted());
+
+  ctx_.SendClientStream(EncodeChunk(ReadStartChunk(3, 16)));
+  WaitForShards();
+
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  ASSERT_TRUE(chunk.status().has_value());
+  EXPECT_EQ(chunk.status().value(), Status::NotFound());
+}
+
+TEST_F(ShardedTransferServiceTest, BlockedStart_DoesNotBlockRegistration) {
+  BlockingReadTransfer blocking_handler(6);  // Runs on shard 0.
+  ctx_.service().RegisterHandler(blocking_handler);
+
+  ctx_.SendClientStream(EncodeChunk(ReadStartChunk(6, 16)));
+  blocking_handler.preparing.acquire();
+
+  // Shard 0 is busy, so queuing another transfer on it blocks.
+  thread::Thread start_thread(TransferThreadOptions(), [this] {
+    ctx_.SendClientStream(EncodeChunk(ReadStartChunk(4, 16)));
+  });
+  this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // The handler lock is not held while the start is blocked, so registering a
+  // handler doesn't wait for it.
+  SimpleReadTransfer handler_5(5, kData);
+  ctx_.service().RegisterHandler(handler_5);
+
+  blocking_handler.proceed.release();
+  start_thread.join();
+  WaitForShards();
+
+  // The blocked start was queued once shard 0 was free.
+  EXPECT_TRUE(handler_4_.prepare_read_called);
+
+  ctx_.service().UnregisterHandler(handler_5);
+  ctx_.service().UnregisterHandler(blocking_handler);
+}
+
+TEST_F(ShardedTransferServiceTest, SetStream_TerminatesTransfersOnAllShards) {
+  ctx_.SendClientStream(EncodeChunk(ReadStartChunk(3, 16)));
+  ctx_.SendClientStream(EncodeChunk(ReadStartChunk(4, 16)));
+  WaitForShards();
+
+  EXPECT_TRUE(handler_3_.prepare_read_called);
+  EXPECT_TRUE(handler_4_.prepare_read_called);
+
+  ctx_.call();  // Reopen the read stream
+
+  EXPECT_TRUE(handler_3_.finalize_read_called);
+  EXPECT_EQ(handler_3_.finalize_read_status, Status::Aborted());
+  EXPECT_TRUE(handler_4_.finalize_read_called);
+  EXPECT_EQ(handler_4_.finalize_read_status, Status::Aborted());
+}
+
+}  // namespace
+}  // namespace pw::transfer::test
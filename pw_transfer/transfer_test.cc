@@ -78,6 +78,8 @@ class SimpleReadTransfer : public ReadOnlyHandler {
         finalize_read_called(false),
         finalize_read_status(Status::Unknown()),
         resource_size_(std::numeric_limits<size_t>::max()),
+        data_(data),
+        contiguous_(false),
         reader_(data) {}
 
   Status PrepareRead() final {
@@ -99,9 +101,14 @@ class SimpleReadTransfer : public ReadOnlyHandler {
 
   size_t ResourceSize() const final { return resource_size_; }
 
+  ConstByteSpan ContiguousData() const final {
+    return contiguous_ ? data_ : ConstByteSpan();
+  }
+
   void set_resource_size(size_t resource_size) {
     resource_size_ = resource_size;
   }
+  void set_contiguous(bool contiguous) { contiguous_ = contiguous; }
   void set_seek_status(Status status) { reader_.seek_status = status; }
   void set_read_status(Status status) { reader_.read_status = status; }
 
@@ -112,6 +119,8 @@ class SimpleReadTransfer : public ReadOnlyHandler {
   size_t resource_size_;
 
  private:
+  ConstByteSpan data_;
+  bool contiguous_;
   TestMemoryReader reader_;
 };
 
@@ -324,6 +333,38 @@ TEST_F(ReadTransfer, OutOfOrder_SeekingSupported) {
       span(&kData[17], kData.data() + kData.size()), chunk.payload()));
 }
 
+TEST_F(ReadTransfer, SelectiveAck_SkipsReceivedRanges) {
+  rpc::test::WaitForPackets(ctx_.output(), 3, [this] {
+    ctx_.SendClientStream(
+        EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart)
+                        .set_session_id(3)
+                        .set_window_end_offset(16)
+                        .set_offset(0)));
+    transfer_thread_.WaitUntilEventIsProcessed();
+
+    // Request a retransmit from offset 4, reporting that 8-16 was received.
+    ctx_.SendClientStream(EncodeChunk(
+        Chunk(ProtocolVersion::kLegacy, Chunk::Type::kParametersRetransmit)
+            .set_session_id(3)
+            .set_window_end_offset(32)
+            .set_offset(4)
+            .add_received_range(8, 16)));
+    transfer_thread_.WaitUntilEventIsProcessed();
+  });
+
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+
+  Chunk chunk = DecodeChunk(ctx_.responses()[1]);
+  EXPECT_EQ(chunk.offset(), 4u);
+  EXPECT_TRUE(
+      pw::containers::Equal(span(kData).subspan(4, 4), chunk.payload()));
+
+  chunk = DecodeChunk(ctx_.responses()[2]);
+  EXPECT_EQ(chunk.offset(), 16u);
+  EXPECT_TRUE(
+      pw::containers::Equal(span(kData).subspan(16, 16), chunk.payload()));
+}
+
 TEST_F(ReadTransfer, OutOfOrder_SeekingNotSupported_EndsWithUnimplemented) {
   handler_.set_seek_status(Status::Unimplemented());
 
@@ -346,6 +387,71 @@ TEST_F(ReadTransfer, OutOfOrder_SeekingNotSupported_EndsWithUnimplemented) {
   EXPECT_EQ(chunk.status().value(), Status::Unimplemented());
 }
 
+TEST_F(ReadTransfer, ContiguousData_SendsWithoutReading) {
+  handler_.set_contiguous(true);
+  handler_.set_read_status(Status::Internal());
+
+  rpc::test::WaitForPackets(ctx_.output(), 2, [this] {
+    ctx_.SendClientStream(
+        EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart)
+                        .set_session_id(3)
+                        .set_window_end_offset(64)
+                        .set_offset(0)));
+
+    transfer_thread_.WaitUntilEventIsProcessed();
+  });
+
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk c0 = DecodeChunk(ctx_.responses()[0]);
+  Chunk c1 = DecodeChunk(ctx_.responses()[1]);
+
+  EXPECT_EQ(c0.session_id(), 3u);
+  EXPECT_EQ(c0.offset(), 0u);
+  EXPECT_TRUE(pw::containers::Equal(kData, c0.payload()));
+
+  EXPECT_EQ(c1.session_id(), 3u);
+  EXPECT_FALSE(c1.has_payload());
+  ASSERT_TRUE(c1.remaining_bytes().has_value());
+  EXPECT_EQ(c1.remaining_bytes().value(), 0u);
+
+  ctx_.SendClientStream(
+      EncodeChunk(Chunk::Final(ProtocolVersion::kLegacy, 3, OkStatus())));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  EXPECT_TRUE(handler_.finalize_read_called);
+  EXPECT_EQ(handler_.finalize_read_status, OkStatus());
+}
+
+TEST_F(ReadTransfer, ContiguousData_RetransmitsWithoutSeeking) {
+  handler_.set_contiguous(true);
+  handler_.set_seek_status(Status::Unimplemented());
+
+  rpc::test::WaitForPackets(ctx_.output(), 2, [this] {
+    ctx_.SendClientStream(
+        EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart)
+                        .set_session_id(3)
+                        .set_window_end_offset(16)
+                        .set_offset(0)));
+
+    transfer_thread_.WaitUntilEventIsProcessed();
+
+    ctx_.SendClientStream(EncodeChunk(
+        Chunk(ProtocolVersion::kLegacy, Chunk::Type::kParametersRetransmit)
+            .set_session_id(3)
+            .set_window_end_offset(10)
+            .set_offset(2)));
+
+    transfer_thread_.WaitUntilEventIsProcessed();
+  });
+
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses()[1]);
+  EXPECT_EQ(chunk.offset(), 2u);
+  EXPECT_TRUE(
+      pw::containers::Equal(span(kData).subspan(2, 8), chunk.payload()));
+  EXPECT_FALSE(handler_.finalize_read_called);
+}
+
 TEST_F(ReadTransfer, MaxChunkSize_Client) {
   rpc::test::WaitForPackets(ctx_.output(), 5, [this] {
     ctx_.SendClientStream(
@@ -510,6 +616,31 @@ TEST_F(ReadTransferMaxChunkSize8, MaxChunkSize_Server) {
   EXPECT_EQ(handler_.finalize_read_status, OkStatus());
 }
 
+TEST_F(ReadTransferMaxChunkSize8, ContiguousData_LimitedByChunkBuffer) {
+  handler_.set_contiguous(true);
+
+  rpc::test::WaitForPackets(ctx_.output(), 5, [this] {
+    ctx_.SendClientStream(
+        EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart)
+                        .set_session_id(3)
+                        .set_window_end_offset(64)
+                        .set_offset(0)));
+  });
+
+  ASSERT_EQ(ctx_.total_responses(), 5u);
+  for (size_t i = 0; i < 4; ++i) {
+    Chunk chunk = DecodeChunk(ctx_.responses()[i]);
+    EXPECT_EQ(chunk.offset(), i * 8);
+    EXPECT_TRUE(
+        pw::containers::Equal(span(kData).subspan(i * 8, 8), chunk.payload()));
+  }
+
+  Chunk last = DecodeChunk(ctx_.responses()[4]);
+  EXPECT_FALSE(last.has_payload());
+  ASSERT_TRUE(last.remaining_bytes().has_value());
+  EXPECT_EQ(last.remaining_bytes().value(), 0u);
+}
+
 TEST_F(ReadTransfer, ClientError) {
   ctx_.SendClientStream(
       EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart)
@@ -1434,6 +1565,100 @@ TEST_F(WriteTransfer, ResendParametersIfSentRepeatedChunkDuringRecovery) {
   EXPECT_EQ(handler_.finalize_write_status, OkStatus());
 }
 
+TEST_F(WriteTransfer, SelectiveAck_StoresOutOfOrderData) {
+  ctx_.service().set_selective_ack(true);
+
+  ctx_.SendClientStream(EncodeChunk(
+      Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart).set_session_id(7)));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+
+  constexpr span data(kData);
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(0)
+                      .set_payload(data.first(8))));
+
+  // Drop offset 8 and send the following chunk.
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(16)
+                      .set_payload(data.subspan(16, 8))));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  // The receiver asks for the gap and reports the data it already holds.
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.type(), Chunk::Type::kParametersRetransmit);
+  EXPECT_EQ(chunk.offset(), 8u);
+  ASSERT_EQ(chunk.received_ranges().size(), 1u);
+  EXPECT_EQ(chunk.received_ranges()[0].start, 16u);
+  EXPECT_EQ(chunk.received_ranges()[0].end, 24u);
+
+  // Data still in flight from the original window is kept as well.
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(24)
+                      .set_payload(data.subspan(24, 4))));
+  transfer_thread_.WaitUntilEventIsProcessed();
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+
+  // Filling the gap advances past all of the stored data.
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(8)
+                      .set_payload(data.subspan(8, 8))));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  // A duplicate of stored data is ignored.
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(16)
+                      .set_payload(data.subspan(16, 8))));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(28)
+                      .set_payload(data.subspan(28))
+                      .set_remaining_bytes(0)));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  chunk = DecodeChunk(ctx_.responses().back());
+  ASSERT_TRUE(chunk.status().has_value());
+  EXPECT_EQ(chunk.status().value(), OkStatus());
+
+  EXPECT_TRUE(handler_.finalize_write_called);
+  EXPECT_EQ(handler_.finalize_write_status, OkStatus());
+  EXPECT_EQ(std::memcmp(buffer.data(), kData.data(), kData.size()), 0);
+}
+
+TEST_F(WriteTransfer, SelectiveAck_DisabledByDefault) {
+  ctx_.SendClientStream(EncodeChunk(
+      Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart).set_session_id(7)));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  constexpr span data(kData);
+  ctx_.SendClientStream<64>(
+      EncodeChunk(Chunk(ProtocolVersion::kLegacy, Chunk::Type::kData)
+                      .set_session_id(7)
+                      .set_offset(16)
+                      .set_payload(data.subspan(16, 8))));
+  transfer_thread_.WaitUntilEventIsProcessed();
+
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.offset(), 0u);
+  EXPECT_TRUE(chunk.received_ranges().empty());
+}
+
 TEST_F(WriteTransfer, ResendsStatusIfClientRetriesAfterStatusChunk) {
   ctx_.SendClientStream(EncodeChunk(
       Chunk(ProtocolVersion::kLegacy, Chunk::Type::kStart).set_session_id(7)));
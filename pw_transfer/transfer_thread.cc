@@ -116,7 +116,8 @@ void TransferThread::StartTransfer(
     chrono::SystemClock::duration initial_timeout,
     uint8_t max_retries,
     uint32_t max_lifetime_retries,
-    uint32_t initial_offset) {
+    uint32_t initial_offset,
+    Handler* handler) {
   // Block until the last event has been processed.
   next_event_ownership_.acquire();
 
@@ -157,8 +158,8 @@ void TransferThread::StartTransfer(
   staged_on_completion_ = std::move(on_completion);
 
   // The transfer is initialized with either a stream (client-side) or a handler
-  // (server-side). If no stream is provided, try to find a registered handler
-  // with the specified ID.
+  // (server-side). If neither a stream nor a handler is provided, try to find a
+  // registered handler with the specified ID.
   if (is_client_transfer) {
     next_event_.new_transfer.stream = stream;
     next_event_.new_transfer.rpc_writer =
@@ -166,15 +167,14 @@ void TransferThread::StartTransfer(
                                           : client_read_stream_)
              .as_writer();
   } else {
-    auto handler = std::find_if(handlers_.begin(),
-                                handlers_.end(),
-                                [&](auto& h) { return h.id() == resource_id; });
-    if (handler != handlers_.end()) {
-      next_event_.new_transfer.handler = &*handler;
+    if (handler == nullptr) {
+      handler = handlers_.Find(resource_id);
+    }
+    if (handler != nullptr) {
+      next_event_.new_transfer.handler = handler;
       next_event_.new_transfer.rpc_writer =
-          &(type == TransferType::kTransmit ? server_read_stream_
-                                            : server_write_stream_)
-               .as_writer();
+          &(type == TransferType::kTransmit ? server_read_writer()
+                                            : server_write_writer());
     } else {
       // No handler exists for the transfer: return a NOT_FOUND.
       next_event_.type = EventType::kSendStatusChunk;
@@ -282,6 +282,33 @@ void TransferThread::UpdateClientTransfer(uint32_t handle_id,
   event_notification_.release();
 }
 
+#if PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
+void TransferThread::AddMetricsTo(metric::Group& group) {
+  group.Add(receive_transfers_);
+  group.Add(last_min_rtt_us_);
+  group.Add(last_bandwidth_bytes_per_second_);
+  group.Add(last_max_window_size_);
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+  group.Add(min_rtt_us_);
+  group.Add(bandwidth_bytes_per_second_);
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+}
+
+void TransferThread::RecordReceiveStatistics(
+    const BandwidthEstimator& estimator) {
+  receive_transfers_.Increment();
+  last_min_rtt_us_.Set(estimator.min_rtt_us());
+  last_bandwidth_bytes_per_second_.Set(estimator.bandwidth_bytes_per_second());
+  last_max_window_size_.Set(estimator.max_window_size());
+#if PW_METRIC_ATOMICS_ARE_LOCK_FREE
+  min_rtt_us_.Record(estimator.min_rtt_us());
+  bandwidth_bytes_per_second_.Record(estimator.bandwidth_bytes_per_second());
+#endif  // PW_METRIC_ATOMICS_ARE_LOCK_FREE
+}
+
+#endif  // PW_TRANSFER_CONFIG_RECEIVE_METRICS
+
 void TransferThread::TransferHandlerEvent(EventType type, Handler& handler) {
   // Block until the last event has been processed.
   next_event_ownership_.acquire();
@@ -339,7 +366,7 @@ void TransferThread::HandleEvent(const internal::Event& event) {
       break;
 
     case EventType::kAddTransferHandler:
-      handlers_.push_front(*event.add_transfer_handler);
+      handlers_.Add(*event.add_transfer_handler);
       return;
 
     case EventType::kRemoveTransferHandler:
@@ -357,7 +384,7 @@ void TransferThread::HandleEvent(const internal::Event& event) {
           });
         }
       }
-      handlers_.remove(*event.remove_transfer_handler);
+      handlers_.Remove(*event.remove_transfer_handler);
       return;
 
     case EventType::kSetStream:
@@ -548,16 +575,20 @@ void TransferThread::HandleSetStreamEvent(TransferStream stream) {
                          TransferType::kTransmit,
                          EventType::kServerEndTransfer,
                          Status::Aborted());
-      server_read_stream_ = std::move(staged_server_stream_);
-      server_read_stream_.set_on_next(std::move(staged_server_on_next_));
+      if (shared_server_read_stream_ == nullptr) {
+        server_read_stream_ = std::move(staged_server_stream_);
+        server_read_stream_.set_on_next(std::move(staged_server_on_next_));
+      }
       break;
     case TransferStream::kServerWrite:
       TerminateTransfers(server_transfers_,
                          TransferType::kReceive,
                          EventType::kServerEndTransfer,
                          Status::Aborted());
-      server_write_stream_ = std::move(staged_server_stream_);
-      server_write_stream_.set_on_next(std::move(staged_server_on_next_));
+      if (shared_server_write_stream_ == nullptr) {
+        server_write_stream_ = std::move(staged_server_stream_);
+        server_write_stream_.set_on_next(std::move(staged_server_on_next_));
+      }
       break;
   }
 }
@@ -583,13 +614,11 @@ void TransferThread::EnqueueResourceEvent(uint32_t resource_id,
 void TransferThread::GetResourceState(uint32_t resource_id) {
   PW_ASSERT(resource_status_callback_ != nullptr);
 
-  auto handler = std::find_if(handlers_.begin(), handlers_.end(), [&](auto& h) {
-    return h.id() == resource_id;
-  });
+  Handler* handler = handlers_.Find(resource_id);
   internal::ResourceStatus stats;
   stats.resource_id = resource_id;
 
-  if (handler != handlers_.end()) {
+  if (handler != nullptr) {
     Status status = handler->GetStatus(stats.readable_offset,
                                        stats.writeable_offset,
                                        stats.read_checksum,